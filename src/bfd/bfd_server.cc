@@ -263,7 +263,7 @@ ResultCode Server::SessionManager::ConfigureSession(const SessionKey &key,
 
     *assignedDiscriminator = GenerateUniqueDiscriminator();
     session = new Session(*assignedDiscriminator, key, evm_, config,
-                          communicator);
+                          communicator, &timer_wheel_);
 
     by_discriminator_[*assignedDiscriminator] = session;
     by_key_[key] = session;
@@ -296,6 +296,11 @@ Discriminator Server::SessionManager::GenerateUniqueDiscriminator() {
     return generator.Next();
 }
 
+Server::SessionManager::SessionManager(EventManager *evm)
+    : evm_(evm),
+      timer_wheel_(evm, TaskScheduler::GetInstance()->GetTaskId("BFD"), 0) {
+}
+
 Server::SessionManager::~SessionManager() {
     for (DiscriminatorSessionMap::iterator it = by_discriminator_.begin();
          it != by_discriminator_.end(); ++it) {
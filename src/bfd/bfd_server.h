@@ -7,10 +7,12 @@
 
 #include "base/queue_task.h"
 #include "bfd/bfd_common.h"
+#include "bfd/bfd_timer_wheel.h"
 
 #include <map>
 #include <set>
 #include <boost/asio.hpp>
+#include <boost/unordered_map.hpp>
 #include <boost/asio/ip/address.hpp>
 #include <boost/scoped_ptr.hpp>
 
@@ -58,12 +60,15 @@ class Server {
     void DeleteSession(const SessionKey &key);
     void DeleteClientSessions();
     Sessions *GetSessions() { return &sessions_; }
+    const TimerWheel *timer_wheel() const {
+        return session_manager_.timer_wheel();
+    }
     WorkQueue<Event *> *event_queue() { return event_queue_.get(); }
 
  private:
     class SessionManager : boost::noncopyable {
      public:
-        explicit SessionManager(EventManager *evm) : evm_(evm) {}
+        explicit SessionManager(EventManager *evm);
         ~SessionManager();
 
         ResultCode ConfigureSession(const SessionKey &key,
@@ -77,15 +82,19 @@ class Server {
         Session *SessionByDiscriminator(Discriminator discriminator);
         Session *SessionByKey(const SessionKey &key);
         Session *SessionByKey(const SessionKey &key) const;
+        const TimerWheel *timer_wheel() const { return &timer_wheel_; }
 
      private:
-        typedef std::map<Discriminator, Session *> DiscriminatorSessionMap;
+        typedef boost::unordered_map<Discriminator, Session *>
+            DiscriminatorSessionMap;
         typedef std::map<SessionKey, Session *> KeySessionMap;
         typedef std::map<Session *, unsigned int> RefcountMap;
 
         Discriminator GenerateUniqueDiscriminator();
 
         EventManager *evm_;
+        // Drives the timers of all sessions
+        TimerWheel timer_wheel_;
         DiscriminatorSessionMap by_discriminator_;
         KeySessionMap by_key_;
         RefcountMap refcounts_;
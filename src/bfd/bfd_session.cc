@@ -19,13 +19,15 @@ namespace BFD {
 Session::Session(Discriminator localDiscriminator,
         const SessionKey &key,
         EventManager *evm,
-        const SessionConfig &config, Connection *communicator) :
+        const SessionConfig &config, Connection *communicator,
+        TimerWheel *timer_wheel) :
         localDiscriminator_(localDiscriminator),
         key_(key),
-        sendTimer_(TimerManager::CreateTimer(*evm->io_service(),
-            "BFD TX", TaskScheduler::GetInstance()->GetTaskId("BFD"), 0)),
-        recvTimer_(TimerManager::CreateTimer(*evm->io_service(),
-            "BFD RX", TaskScheduler::GetInstance()->GetTaskId("BFD"), 0)),
+        own_timer_wheel_(timer_wheel ? NULL : new TimerWheel(evm,
+            TaskScheduler::GetInstance()->GetTaskId("BFD"), 0)),
+        timer_wheel_(timer_wheel ? timer_wheel : own_timer_wheel_.get()),
+        sendTimer_(boost::bind(&Session::SendTimerExpired, this)),
+        recvTimer_(boost::bind(&Session::RecvTimerCallback, this)),
         currentConfig_(config),
         nextConfig_(config),
         sm_(CreateStateMachine(evm, this)),
@@ -48,18 +50,18 @@ uint16_t Session::GetRandomLocalPort() const {
 
 Session::~Session() {
     Stop();
+    timer_wheel_->Cancel(&sendTimer_);
+    timer_wheel_->Cancel(&recvTimer_);
 }
 
-bool Session::SendTimerExpired() {
+void Session::SendTimerExpired() {
     ControlPacket packet;
 
     stats_.send_timer_expired_count++;
     PreparePacket(nextConfig_, &packet);
     SendPacket(&packet);
 
-    // Workaround: Timer code isn't re-entrant
-    this->sendTimer_->Reschedule(tx_interval().total_milliseconds());
-    return true;
+    timer_wheel_->Schedule(&sendTimer_, tx_interval().total_milliseconds());
 }
 
 bool Session::RecvTimerExpired() {
@@ -70,6 +72,10 @@ bool Session::RecvTimerExpired() {
     return false;
 }
 
+void Session::RecvTimerCallback() {
+    RecvTimerExpired();
+}
+
 std::string Session::toString() const {
     std::ostringstream out;
     out << "SessionKey: " << key_.to_string() << "\n";
@@ -96,25 +102,20 @@ void Session::ScheduleSendTimer() {
     // get the elapsed time only if the bfd session timer is running,
     // otherwise program the config send timer value
     if (started_ == true) {
-        elapsed_time_ms = sendTimer_->GetElapsedTime();
-        sendTimer_->Cancel();
-        if (elapsed_time_ms < 0) {
-            remaining_time_ms = 0;
-        } else {
-            remaining_time_ms = ti.total_milliseconds() - elapsed_time_ms;
-        }
+        elapsed_time_ms =
+            TimerWheel::NowMsec() - sendTimer_.start_time();
+        timer_wheel_->Cancel(&sendTimer_);
+        remaining_time_ms = ti.total_milliseconds() - elapsed_time_ms;
     } else {
         // timer not yet started, program with config value
         remaining_time_ms = ti.total_milliseconds();
     }
 
     if (remaining_time_ms > 0) {
-        sendTimer_->Start(remaining_time_ms,
-                boost::bind(&Session::SendTimerExpired, this));
+        timer_wheel_->Schedule(&sendTimer_, remaining_time_ms);
     } else {
         // fire the timer now!
-        sendTimer_->Start(0,
-                boost::bind(&Session::SendTimerExpired, this));
+        timer_wheel_->Schedule(&sendTimer_, 0);
     }
     if (started_ != true) {
         started_ = true;
@@ -124,9 +125,7 @@ void Session::ScheduleSendTimer() {
 void Session::ScheduleRecvDeadlineTimer() {
     TimeInterval ti = detection_time();
 
-    recvTimer_->Cancel();
-    recvTimer_->Start(ti.total_milliseconds(),
-                      boost::bind(&Session::RecvTimerExpired, this));
+    timer_wheel_->Schedule(&recvTimer_, ti.total_milliseconds());
 }
 
 BFDState Session::local_state_non_locking() const {
@@ -262,8 +261,8 @@ const SessionKey &Session::key() const {
 
 void Session::Stop() {
     if (stopped_ == false) {
-        TimerManager::DeleteTimer(sendTimer_);
-        TimerManager::DeleteTimer(recvTimer_);
+        timer_wheel_->Cancel(&sendTimer_);
+        timer_wheel_->Cancel(&recvTimer_);
         stopped_ = true;
         started_ = false;
         sm_->SetCallback(boost::optional<ChangeCb>());
@@ -14,6 +14,7 @@
 #include <boost/asio/ip/address.hpp>
 
 #include "base/timer.h"
+#include "bfd/bfd_timer_wheel.h"
 #include "io/event_manager.h"
 
 namespace BFD {
@@ -49,11 +50,13 @@ struct BFDStats {
     uint32_t send_timer_expired_count;
 };
 
+// Transmit and detection timers of the session are entries in the
+// TimerWheel of the Server. A session created without a wheel owns one.
 class Session {
  public:
     Session(Discriminator localDiscriminator, const SessionKey &key,
             EventManager *evm, const SessionConfig &config,
-            Connection *communicator);
+            Connection *communicator, TimerWheel *timer_wheel = NULL);
     virtual ~Session();
 
     void Stop();
@@ -86,7 +89,8 @@ class Session {
  private:
     typedef std::map<ClientId, ChangeCb> Callbacks;
 
-    bool SendTimerExpired();
+    void SendTimerExpired();
+    void RecvTimerCallback();
     void ScheduleSendTimer();
     void ScheduleRecvDeadlineTimer();
     void PreparePacket(const SessionConfig &config, ControlPacket *packet);
@@ -99,8 +103,10 @@ class Session {
 
     Discriminator            localDiscriminator_;
     SessionKey               key_;
-    Timer                    *sendTimer_;
-    Timer                    *recvTimer_;
+    boost::scoped_ptr<TimerWheel> own_timer_wheel_;
+    TimerWheel               *timer_wheel_;
+    TimerWheel::Entry        sendTimer_;
+    TimerWheel::Entry        recvTimer_;
     SessionConfig            currentConfig_;
     SessionConfig            nextConfig_;
     BFDRemoteSessionState    remoteSession_;
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include "bfd/bfd_timer_wheel.h"
+
+#include <algorithm>
+#include <boost/bind.hpp>
+
+#include "base/time_util.h"
+#include "io/event_manager.h"
+
+namespace BFD {
+
+TimerWheel::Entry::Entry(Callback cb)
+    : cb_(cb), start_time_(0), expiry_tick_(0) {
+}
+
+TimerWheel::Entry::~Entry() {
+    assert(!scheduled());
+}
+
+TimerWheel::TimerWheel(EventManager *evm, int task_id, int task_instance)
+    : timer_(TimerManager::CreateTimer(*evm->io_service(), "BFD Timer Wheel",
+                                       task_id, task_instance)),
+      running_(false), current_tick_(NowMsec() / kTickMsec), size_(0),
+      tick_count_(0), expired_count_(0) {
+}
+
+TimerWheel::~TimerWheel() {
+    TimerManager::DeleteTimer(timer_);
+    for (size_t i = 0; i < kSlots; ++i) {
+        level0_[i].clear();
+        level1_[i].clear();
+    }
+    overflow_.clear();
+}
+
+uint64_t TimerWheel::NowMsec() {
+    return ClockMonotonicUsec() / 1000;
+}
+
+void TimerWheel::Schedule(Entry *entry, int time) {
+    if (entry->scheduled()) {
+        Cancel(entry);
+    }
+
+    uint64_t now = NowMsec();
+    // Catch up with the clock when idle, no tick needs to be processed
+    if (size_ == 0 && !running_) {
+        current_tick_ = now / kTickMsec;
+    }
+    entry->start_time_ = now;
+    entry->expiry_tick_ =
+        (now + std::max(time, 0) + kTickMsec - 1) / kTickMsec;
+    if (entry->expiry_tick_ <= current_tick_) {
+        entry->expiry_tick_ = current_tick_ + 1;
+    }
+    Insert(entry);
+    size_++;
+    StartTimer();
+}
+
+void TimerWheel::Cancel(Entry *entry) {
+    if (!entry->scheduled())
+        return;
+    entry->node_.unlink();
+    size_--;
+}
+
+// Place the entry in a slot based on the ticks left till its expiry. An
+// entry in the second level is in the slot of its expiry tick shifted by
+// kSlotBits; the slot is cascaded when the first level wraps at that tick.
+void TimerWheel::Insert(Entry *entry) {
+    uint64_t delta = entry->expiry_tick_ - current_tick_;
+    if (delta < kSlots) {
+        level0_[entry->expiry_tick_ & (kSlots - 1)].push_back(*entry);
+    } else if (delta < kSlots * kSlots) {
+        level1_[(entry->expiry_tick_ >> kSlotBits) & (kSlots - 1)].push_back(
+            *entry);
+    } else {
+        overflow_.push_back(*entry);
+    }
+}
+
+void TimerWheel::Cascade(EntryList *list) {
+    EntryList entries;
+    entries.swap(*list);
+    while (!entries.empty()) {
+        Entry &entry = entries.front();
+        entries.pop_front();
+        Insert(&entry);
+    }
+}
+
+// The Timer is restarted by the return value of TimerExpired while it runs
+void TimerWheel::StartTimer() {
+    if (size_ && !running_) {
+        running_ = true;
+        timer_->Start(kTickMsec, boost::bind(&TimerWheel::TimerExpired, this));
+    }
+}
+
+// Process all ticks elapsed since the last run. Callbacks may schedule or
+// cancel any entry, including the ones in the slot being processed.
+bool TimerWheel::TimerExpired() {
+    uint64_t now_tick = NowMsec() / kTickMsec;
+    while (current_tick_ < now_tick) {
+        current_tick_++;
+        tick_count_++;
+        if ((current_tick_ & (kSlots * kSlots - 1)) == 0) {
+            Cascade(&overflow_);
+        }
+        if ((current_tick_ & (kSlots - 1)) == 0) {
+            Cascade(&level1_[(current_tick_ >> kSlotBits) & (kSlots - 1)]);
+        }
+
+        EntryList &slot = level0_[current_tick_ & (kSlots - 1)];
+        while (!slot.empty()) {
+            Entry &entry = slot.front();
+            slot.pop_front();
+            size_--;
+            expired_count_++;
+            entry.cb_();
+        }
+    }
+
+    // Keep ticking while entries are scheduled
+    running_ = (size_ != 0);
+    return running_;
+}
+
+}  // namespace BFD
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#ifndef SRC_BFD_BFD_TIMER_WHEEL_H_
+#define SRC_BFD_BFD_TIMER_WHEEL_H_
+
+#include <boost/function.hpp>
+#include <boost/intrusive/list.hpp>
+#include <boost/noncopyable.hpp>
+
+#include "base/timer.h"
+
+class EventManager;
+
+namespace BFD {
+
+// Hierarchical timing wheel driving the transmit and detection timers of
+// all BFD sessions of a Server.
+//
+// A Timer per session was rescheduled on every transmitted and received
+// packet. The wheel runs a single Timer that ticks every kTickMsec while any
+// entry is scheduled. Entries expiring within kSlots ticks are kept in the
+// slots of the first level, entries expiring within kSlots * kSlots ticks
+// in the slots of the second level and the rest in an overflow list. Slots
+// of the second level are cascaded into the first level when it wraps, and
+// the overflow list when the second level wraps. Scheduling and cancelling
+// are O(1), and entries expiring in the same tick are processed in one run
+// of the Timer, hence the control packets of sessions due in the same tick
+// are transmitted as a batch.
+//
+// Expiry is rounded up to the tick; an entry never expires early. The tick
+// is derived from the monotonic clock, so ticks missed due to a delayed
+// Timer are caught up on the next run.
+//
+// All methods must be called from the task the wheel runs in.
+class TimerWheel : boost::noncopyable {
+ public:
+    static const int kTickMsec = 5;
+    static const size_t kSlotBits = 8;
+    static const size_t kSlots = 1 << kSlotBits;
+
+    class Entry : boost::noncopyable {
+     public:
+        typedef boost::function<void(void)> Callback;
+
+        explicit Entry(Callback cb);
+        ~Entry();
+
+        bool scheduled() const { return node_.is_linked(); }
+        // Time in msec when the entry was last scheduled
+        uint64_t start_time() const { return start_time_; }
+
+     private:
+        friend class TimerWheel;
+
+        boost::intrusive::list_member_hook<
+            boost::intrusive::link_mode<boost::intrusive::auto_unlink> > node_;
+        Callback cb_;
+        uint64_t start_time_;
+        uint64_t expiry_tick_;
+    };
+
+    TimerWheel(EventManager *evm, int task_id, int task_instance);
+    ~TimerWheel();
+
+    // Schedule the entry to expire after time msec, rescheduling if needed
+    void Schedule(Entry *entry, int time);
+    void Cancel(Entry *entry);
+
+    // Monotonic time in msec
+    static uint64_t NowMsec();
+
+    size_t size() const { return size_; }
+    uint64_t tick_count() const { return tick_count_; }
+    uint64_t expired_count() const { return expired_count_; }
+
+ private:
+    typedef boost::intrusive::list_member_hook<
+        boost::intrusive::link_mode<boost::intrusive::auto_unlink> > EntryHook;
+    typedef boost::intrusive::member_hook<Entry, EntryHook, &Entry::node_>
+        EntryNode;
+    typedef boost::intrusive::list<Entry, EntryNode,
+        boost::intrusive::constant_time_size<false> > EntryList;
+
+    void Insert(Entry *entry);
+    void Cascade(EntryList *list);
+    void StartTimer();
+    bool TimerExpired();
+
+    Timer *timer_;
+    bool running_;
+    uint64_t current_tick_;
+    EntryList level0_[kSlots];
+    EntryList level1_[kSlots];
+    EntryList overflow_;
+    size_t size_;
+    uint64_t tick_count_;
+    uint64_t expired_count_;
+};
+
+}  // namespace BFD
+
+#endif  // SRC_BFD_BFD_TIMER_WHEEL_H_
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include "base/regex.h"
+typedef contrail::regex regex_t;
+
+#include "bfd/bfd_timer_wheel.h"
+#include "bfd/test/bfd_test_utils.h"
+
+#include <boost/bind.hpp>
+#include <testing/gunit.h>
+
+#include "base/logging.h"
+#include "base/test/task_test_util.h"
+
+using namespace BFD;
+
+class TimerWheelTest : public ::testing::Test {
+ protected:
+    static const int kEntryCount = 5;
+
+    TimerWheelTest()
+        : wheel_(&evm_, TaskScheduler::GetInstance()->GetTaskId("BFD"), 0) {
+        for (int i = 0; i < kEntryCount; ++i) {
+            entries_[i] = new TimerWheel::Entry(
+                boost::bind(&TimerWheelTest::Expired, this, i));
+            due_time_[i] = 0;
+            fire_time_[i] = 0;
+        }
+        fire_count_ = 0;
+    }
+
+    ~TimerWheelTest() {
+        task_util::TaskFire(boost::bind(&TimerWheelTest::CancelAll, this),
+                            "BFD");
+        for (int i = 0; i < kEntryCount; ++i) {
+            delete entries_[i];
+        }
+    }
+
+    void Expired(int index) {
+        fire_time_[index] = TimerWheel::NowMsec();
+        fire_count_++;
+    }
+
+    void ScheduleCb(int index, int time) {
+        due_time_[index] = TimerWheel::NowMsec() + time;
+        wheel_.Schedule(entries_[index], time);
+    }
+
+    void Schedule(int index, int time) {
+        task_util::TaskFire(boost::bind(&TimerWheelTest::ScheduleCb, this,
+                                        index, time), "BFD");
+    }
+
+    void CancelCb(int index) {
+        wheel_.Cancel(entries_[index]);
+    }
+
+    void Cancel(int index) {
+        task_util::TaskFire(boost::bind(&TimerWheelTest::CancelCb, this,
+                                        index), "BFD");
+    }
+
+    void CancelAll() {
+        for (int i = 0; i < kEntryCount; ++i) {
+            wheel_.Cancel(entries_[i]);
+        }
+    }
+
+    EventManager evm_;
+    TimerWheel wheel_;
+    TimerWheel::Entry *entries_[kEntryCount];
+    uint64_t due_time_[kEntryCount];
+    uint64_t fire_time_[kEntryCount];
+    tbb::atomic<int> fire_count_;
+};
+
+// Entries in both levels of the wheel expire, none of them early
+TEST_F(TimerWheelTest, Expiry) {
+    EventManagerThread thread(&evm_);
+
+    Schedule(0, 0);
+    Schedule(1, 20);
+    Schedule(2, 100);
+    Schedule(3, TimerWheel::kSlots * TimerWheel::kTickMsec + 200);
+    Schedule(4, 30);
+    TASK_UTIL_EXPECT_EQ(kEntryCount, fire_count_);
+    EXPECT_EQ(0U, wheel_.size());
+    for (int i = 0; i < kEntryCount; ++i) {
+        EXPECT_GE(fire_time_[i], due_time_[i]);
+    }
+    EXPECT_LT(fire_time_[4], fire_time_[2]);
+    EXPECT_LT(fire_time_[2], fire_time_[3]);
+}
+
+// Rescheduled and cancelled entries don't expire at the earlier time
+TEST_F(TimerWheelTest, RescheduleAndCancel) {
+    EventManagerThread thread(&evm_);
+
+    Schedule(0, 50);
+    Schedule(1, 50);
+    Schedule(2, 100);
+    Schedule(0, 300);
+    Cancel(1);
+    TASK_UTIL_EXPECT_EQ(2, fire_count_);
+    EXPECT_EQ(0U, fire_time_[1]);
+    EXPECT_GE(fire_time_[0], due_time_[0]);
+    EXPECT_LT(fire_time_[2], fire_time_[0]);
+    EXPECT_EQ(0U, wheel_.size());
+}
+
+int main(int argc, char **argv) {
+    LoggingInit();
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -5,6 +5,7 @@
 
 #include "base/regex.h"
 #include "bfd/bfd_server.h"
+#include "bfd/bfd_session.h"
 #include "bfd/bfd_udp_connection.h"
 #include "bfd/bfd_control_packet.h"
 
@@ -16,6 +17,7 @@ typedef contrail::regex regex_t;
 #include <testing/gunit.h>
 #include "test/task_test_util.h"
 #include "base/logging.h"
+#include "base/time_util.h"
 
 
 using namespace BFD;
@@ -39,7 +41,21 @@ class BFDTest : public ::testing::Test {
         LOG(INFO, p2->toString());
         cmpResult = (*p1 == *p2);
     }
+
+    void CountPacket(boost::asio::ip::udp::endpoint remote_endpoint,
+                     const boost::asio::const_buffer &recv_buffer,
+                     std::size_t bytes_transferred,
+                     const boost::system::error_code &error) {
+        if (!error && bytes_transferred == (std::size_t)kMinimalPacketLength)
+            rxCount++;
+        delete[] boost::asio::buffer_cast<const uint8_t *>(recv_buffer);
+    }
+
+    static void StateChange(const SessionKey &key, const BFDState &state) {
+    }
+
     boost::optional<bool> cmpResult;
+    tbb::atomic<uint32_t> rxCount;
 };
 
 
@@ -86,6 +102,50 @@ TEST_F(BFDTest, UDPConnection) {
 }
 
 
+// Scale benchmark: control packets of many sessions driven by the timer
+// wheel of a Server are sent through a loopback UDPConnectionManager. The
+// sessions stay down and transmit once every 750-1000 msec.
+TEST_F(BFDTest, SessionScale) {
+    const uint32_t kSessionCount = 4000;
+    const int port1 = 10011;
+    const int port2 = 10012;
+
+    EventManager em;
+    UDPConnectionManager communicationManager1(&em, port1, port2);
+    Server server1(&em, &communicationManager1);
+    UDPConnectionManager communicationManager2(&em, port2, port1);
+    rxCount = 0;
+    communicationManager2.RegisterCallback(
+        boost::bind(&BFDTest::CountPacket, this, _1, _2, _3, _4));
+    EventManagerThread evmThread(&em);
+
+    SessionConfig config;
+    config.desiredMinTxInterval = boost::posix_time::milliseconds(100);
+    config.requiredMinRxInterval = boost::posix_time::milliseconds(100);
+    config.detectionTimeMultiplier = 3;
+    for (uint32_t i = 0; i < kSessionCount; ++i) {
+        boost::asio::ip::address_v4 addr(0x7F000000 + 0x10000 + i);
+        server1.AddSession(SessionKey(addr, SessionIndex(), port2), config,
+                           &BFDTest::StateChange);
+    }
+    TASK_UTIL_EXPECT_TRUE(server1.event_queue()->IsQueueEmpty());
+
+    uint64_t start = ClockMonotonicUsec();
+    uint64_t ticks = server1.timer_wheel()->tick_count();
+    TASK_UTIL_EXPECT_TRUE(rxCount >= 3 * kSessionCount);
+    uint64_t elapsed = ClockMonotonicUsec() - start;
+    LOG(INFO, "BFD sessions: " << kSessionCount << ", packets: " << rxCount
+        << ", msec: " << elapsed / 1000 << ", pps: "
+        << (rxCount * 1000000ULL) / (elapsed ? elapsed : 1)
+        << ", wheel ticks: " << server1.timer_wheel()->tick_count() - ticks);
+
+    server1.DeleteClientSessions();
+    TASK_UTIL_EXPECT_TRUE(server1.event_queue()->IsQueueEmpty());
+    task_util::WaitForIdle();
+    TASK_UTIL_EXPECT_EQ(0U, server1.timer_wheel()->size());
+    server1.event_queue()->Shutdown();
+}
+
 int main(int argc, char **argv) {
     LoggingInit();
     ::testing::InitGoogleTest(&argc, argv);
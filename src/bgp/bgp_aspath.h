@@ -129,7 +129,13 @@ public:
 
     friend std::size_t hash_value(const AsPath &as_path) {
         size_t hash = 0;
-        boost::hash_combine(hash, as_path.path().ToString());
+        for (std::vector<AsPathSpec::PathSegment *>::const_iterator it =
+             as_path.path().path_segments.begin();
+             it != as_path.path().path_segments.end(); ++it) {
+            boost::hash_combine(hash, (*it)->path_segment_type);
+            boost::hash_range(hash, (*it)->path_segment.begin(),
+                              (*it)->path_segment.end());
+        }
         return hash;
     }
 
@@ -287,7 +293,13 @@ public:
 
     friend std::size_t hash_value(const AsPath4Byte &as_path) {
         size_t hash = 0;
-        boost::hash_combine(hash, as_path.path().ToString());
+        for (std::vector<AsPath4ByteSpec::PathSegment *>::const_iterator it =
+             as_path.path().path_segments.begin();
+             it != as_path.path().path_segments.end(); ++it) {
+            boost::hash_combine(hash, (*it)->path_segment_type);
+            boost::hash_range(hash, (*it)->path_segment.begin(),
+                              (*it)->path_segment.end());
+        }
         return hash;
     }
 
@@ -445,7 +457,13 @@ public:
 
     friend std::size_t hash_value(As4Path const &as_path) {
         size_t hash = 0;
-        boost::hash_combine(hash, as_path.path().ToString());
+        for (std::vector<As4PathSpec::PathSegment *>::const_iterator it =
+             as_path.path().path_segments.begin();
+             it != as_path.path().path_segments.end(); ++it) {
+            boost::hash_combine(hash, (*it)->path_segment_type);
+            boost::hash_range(hash, (*it)->path_segment.begin(),
+                              (*it)->path_segment.end());
+        }
         return hash;
     }
 
@@ -1190,41 +1190,50 @@ int BgpAttr::CompareTo(const BgpAttr &rhs) const {
     return 0;
 }
 
+static void HashIpAddress(size_t *hash, const IpAddress &address) {
+    if (address.is_v4()) {
+        boost::hash_combine(*hash, address.to_v4().to_ulong());
+    } else {
+        Ip6Address::bytes_type bytes = address.to_v6().to_bytes();
+        boost::hash_range(*hash, bytes.begin(), bytes.end());
+    }
+}
+
+//
+// Hash the fields compared in BgpAttr::CompareTo. Other attributes are
+// interned in their own databases and compared by pointer, so their
+// pointers are hashed instead of their contents.
+//
 std::size_t hash_value(BgpAttr const &attr) {
     size_t hash = 0;
 
     boost::hash_combine(hash, attr.origin_);
-    boost::hash_combine(hash, attr.nexthop_.to_string());
+    HashIpAddress(&hash, attr.nexthop_);
     boost::hash_combine(hash, attr.med_);
     boost::hash_combine(hash, attr.local_pref_);
     boost::hash_combine(hash, attr.atomic_aggregate_);
     boost::hash_combine(hash, attr.aggregator_as_num_);
-    boost::hash_combine(hash, attr.aggregator_address_.to_string());
-    boost::hash_combine(hash, attr.originator_id_.to_string());
+    HashIpAddress(&hash, attr.aggregator_address_);
+    boost::hash_combine(hash, attr.originator_id_.to_ulong());
     boost::hash_combine(hash, attr.params_);
-    boost::hash_combine(hash, attr.source_rd_.ToString());
-    boost::hash_combine(hash, attr.esi_.ToString());
-
-    if (attr.label_block_) {
-        boost::hash_combine(hash, attr.label_block_->first());
-        boost::hash_combine(hash, attr.label_block_->last());
-    }
-
-    if (attr.olist_) {
-        boost::hash_range(hash, attr.olist_->elements().begin(),
-                          attr.olist_->elements().end());
-    }
-    if (attr.leaf_olist_) {
-        boost::hash_range(hash, attr.leaf_olist_->elements().begin(),
-                          attr.leaf_olist_->elements().end());
-    }
-
-    if (attr.as_path_) boost::hash_combine(hash, *attr.as_path_);
-    if (attr.aspath_4byte_) boost::hash_combine(hash, *attr.aspath_4byte_);
-    if (attr.as4_path_) boost::hash_combine(hash, *attr.as4_path_);
-    if (attr.community_) boost::hash_combine(hash, *attr.community_);
-    if (attr.ext_community_) boost::hash_combine(hash, *attr.ext_community_);
-    if (attr.origin_vn_path_) boost::hash_combine(hash, *attr.origin_vn_path_);
+    boost::hash_range(hash, attr.source_rd_.GetData(),
+                      attr.source_rd_.GetData() + RouteDistinguisher::kSize);
+    boost::hash_range(hash, attr.esi_.GetData(),
+                      attr.esi_.GetData() + EthernetSegmentId::kSize);
+
+    boost::hash_combine(hash, attr.pmsi_tunnel_.get());
+    boost::hash_combine(hash, attr.edge_discovery_.get());
+    boost::hash_combine(hash, attr.edge_forwarding_.get());
+    boost::hash_combine(hash, attr.label_block_.get());
+    boost::hash_combine(hash, attr.olist_.get());
+    boost::hash_combine(hash, attr.leaf_olist_.get());
+    boost::hash_combine(hash, attr.as_path_.get());
+    boost::hash_combine(hash, attr.aspath_4byte_.get());
+    boost::hash_combine(hash, attr.as4_path_.get());
+    boost::hash_combine(hash, attr.cluster_list_.get());
+    boost::hash_combine(hash, attr.community_.get());
+    boost::hash_combine(hash, attr.ext_community_.get());
+    boost::hash_combine(hash, attr.origin_vn_path_.get());
     if (!attr.sub_protocol_.empty()) {
         boost::hash_combine(hash, attr.sub_protocol_);
     }
@@ -1233,119 +1242,228 @@ std::size_t hash_value(BgpAttr const &attr) {
 }
 
 BgpAttrDB::BgpAttrDB(BgpServer *server) : server_(server) {
+    clone_count_ = 0;
 }
 
 // Return a clone of attribute with updated aspath.
 BgpAttrPtr BgpAttrDB::ReplaceAsPathAndLocate(const BgpAttr *attr,
                                              AsPathPtr aspath) {
-    BgpAttr *clone = new BgpAttr(*attr);
-    clone->set_as_path(aspath);
-    return Locate(clone);
+    BgpAttrBuilder builder(this, attr);
+    builder.set_as_path(aspath);
+    return builder.Locate();
 }
 
 // Return a clone of attribute with updated community.
 BgpAttrPtr BgpAttrDB::ReplaceCommunityAndLocate(const BgpAttr *attr,
                                                 CommunityPtr community) {
-    BgpAttr *clone = new BgpAttr(*attr);
-    clone->set_community(community);
-    return Locate(clone);
+    BgpAttrBuilder builder(this, attr);
+    builder.set_community(community);
+    return builder.Locate();
 }
 
 //Return a clone of attribute with updated origin
 BgpAttrPtr BgpAttrDB::ReplaceOriginAndLocate(const BgpAttr *attr,
                                              BgpAttrOrigin::OriginType origin) {
-    BgpAttr *clone = new BgpAttr(*attr);
-    clone->set_origin(origin);
-    return Locate(clone);
+    BgpAttrBuilder builder(this, attr);
+    builder.set_origin(origin);
+    return builder.Locate();
 }
 
 // Return a clone of attribute with updated extended community.
 BgpAttrPtr BgpAttrDB::ReplaceExtCommunityAndLocate(const BgpAttr *attr,
                                                    ExtCommunityPtr extcomm) {
-    BgpAttr *clone = new BgpAttr(*attr);
-    clone->set_ext_community(extcomm);
-    return Locate(clone);
+    BgpAttrBuilder builder(this, attr);
+    builder.set_ext_community(extcomm);
+    return builder.Locate();
 }
 
 // Return a clone of attribute with updated origin vn path.
 BgpAttrPtr BgpAttrDB::ReplaceOriginVnPathAndLocate(const BgpAttr *attr,
                                                    OriginVnPathPtr ovnpath) {
-    BgpAttr *clone = new BgpAttr(*attr);
-    clone->set_origin_vn_path(ovnpath);
-    return Locate(clone);
+    BgpAttrBuilder builder(this, attr);
+    builder.set_origin_vn_path(ovnpath);
+    return builder.Locate();
 }
 
 // Return a clone of attribute with updated local preference.
 BgpAttrPtr BgpAttrDB::ReplaceLocalPreferenceAndLocate(const BgpAttr *attr,
                                                       uint32_t local_pref) {
-    BgpAttr *clone = new BgpAttr(*attr);
-    clone->set_local_pref(local_pref);
-    return Locate(clone);
+    BgpAttrBuilder builder(this, attr);
+    builder.set_local_pref(local_pref);
+    return builder.Locate();
 }
 
 // Return a clone of attribute with updated originator id.
 BgpAttrPtr BgpAttrDB::ReplaceOriginatorIdAndLocate(const BgpAttr *attr,
                                                    Ip4Address originator_id) {
-    BgpAttr *clone = new BgpAttr(*attr);
-    clone->set_originator_id(originator_id);
-    return Locate(clone);
+    BgpAttrBuilder builder(this, attr);
+    builder.set_originator_id(originator_id);
+    return builder.Locate();
 }
 
 // Return a clone of attribute with updated source rd.
 BgpAttrPtr BgpAttrDB::ReplaceSourceRdAndLocate(const BgpAttr *attr,
     const RouteDistinguisher &source_rd) {
-    BgpAttr *clone = new BgpAttr(*attr);
-    clone->set_source_rd(source_rd);
-    return Locate(clone);
+    BgpAttrBuilder builder(this, attr);
+    builder.set_source_rd(source_rd);
+    return builder.Locate();
 }
 
 // Return a clone of attribute with updated esi.
 BgpAttrPtr BgpAttrDB::ReplaceEsiAndLocate(const BgpAttr *attr,
                                           const EthernetSegmentId &esi) {
-    BgpAttr *clone = new BgpAttr(*attr);
-    clone->set_esi(esi);
-    return Locate(clone);
+    BgpAttrBuilder builder(this, attr);
+    builder.set_esi(esi);
+    return builder.Locate();
 }
 
 // Return a clone of attribute with updated olist.
 BgpAttrPtr BgpAttrDB::ReplaceOListAndLocate(const BgpAttr *attr,
     const BgpOListSpec *olist_spec) {
     assert(olist_spec->subcode == BgpAttribute::OList);
-    BgpAttr *clone = new BgpAttr(*attr);
-    clone->set_olist(olist_spec);
-    return Locate(clone);
+    BgpAttrBuilder builder(this, attr);
+    builder.set_olist(olist_spec);
+    return builder.Locate();
 }
 
 // Return a clone of attribute with updated leaf olist.
 BgpAttrPtr BgpAttrDB::ReplaceLeafOListAndLocate(const BgpAttr *attr,
     const BgpOListSpec *leaf_olist_spec) {
     assert(leaf_olist_spec->subcode == BgpAttribute::LeafOList);
-    BgpAttr *clone = new BgpAttr(*attr);
-    clone->set_leaf_olist(leaf_olist_spec);
-    return Locate(clone);
+    BgpAttrBuilder builder(this, attr);
+    builder.set_leaf_olist(leaf_olist_spec);
+    return builder.Locate();
 }
 
 // Return a clone of attribute with updated sub-protocol.
 BgpAttrPtr BgpAttrDB::ReplaceSubProtocolAndLocate(const BgpAttr *attr,
     const string &sbp) {
-    BgpAttr *clone = new BgpAttr(*attr);
-    clone->set_sub_protocol(sbp);
-    return Locate(clone);
+    BgpAttrBuilder builder(this, attr);
+    builder.set_sub_protocol(sbp);
+    return builder.Locate();
 }
 
 
 // Return a clone of attribute with updated pmsi tunnel.
 BgpAttrPtr BgpAttrDB::ReplacePmsiTunnelAndLocate(const BgpAttr *attr,
     const PmsiTunnelSpec *pmsi_spec) {
-    BgpAttr *clone = new BgpAttr(*attr);
-    clone->set_pmsi_tunnel(pmsi_spec);
-    return Locate(clone);
+    BgpAttrBuilder builder(this, attr);
+    builder.set_pmsi_tunnel(pmsi_spec);
+    return builder.Locate();
 }
 
 // Return a clone of attribute with updated nexthop.
 BgpAttrPtr BgpAttrDB::ReplaceNexthopAndLocate(const BgpAttr *attr,
     const IpAddress &addr) {
-    BgpAttr *clone = new BgpAttr(*attr);
-    clone->set_nexthop(addr);
-    return Locate(clone);
+    BgpAttrBuilder builder(this, attr);
+    builder.set_nexthop(addr);
+    return builder.Locate();
+}
+
+BgpAttrBuilder::BgpAttrBuilder(BgpAttrDB *attr_db, const BgpAttr *attr)
+    : attr_db_(attr_db), attr_(attr) {
+}
+
+BgpAttrBuilder::~BgpAttrBuilder() {
+}
+
+BgpAttr *BgpAttrBuilder::Clone() {
+    if (!clone_.get()) {
+        clone_.reset(new BgpAttr(*attr_));
+        attr_db_->clone_count_++;
+    }
+    return clone_.get();
+}
+
+BgpAttrPtr BgpAttrBuilder::Locate() {
+    if (clone_.get())
+        attr_ = attr_db_->Locate(clone_.release());
+    return attr_;
+}
+
+void BgpAttrBuilder::Reset(const BgpAttr *attr) {
+    clone_.reset();
+    attr_ = attr;
+}
+
+//
+// Setters for fields held by value compare against the current value, and
+// those for interned fields compare pointers, so that a modification which
+// leaves the attribute unchanged does not copy it. Fields set from a spec
+// are located in their own database by BgpAttr and always copy.
+//
+void BgpAttrBuilder::set_origin(BgpAttrOrigin::OriginType origin) {
+    if (get()->origin() != origin)
+        Clone()->set_origin(origin);
+}
+
+void BgpAttrBuilder::set_nexthop(const IpAddress &nexthop) {
+    if (get()->nexthop() != nexthop)
+        Clone()->set_nexthop(nexthop);
+}
+
+void BgpAttrBuilder::set_med(uint32_t med) {
+    if (get()->med() != med)
+        Clone()->set_med(med);
+}
+
+void BgpAttrBuilder::set_local_pref(uint32_t local_pref) {
+    if (get()->local_pref() != local_pref)
+        Clone()->set_local_pref(local_pref);
+}
+
+void BgpAttrBuilder::set_originator_id(Ip4Address originator_id) {
+    if (get()->originator_id() != originator_id)
+        Clone()->set_originator_id(originator_id);
+}
+
+void BgpAttrBuilder::set_source_rd(const RouteDistinguisher &source_rd) {
+    if (!(get()->source_rd() == source_rd))
+        Clone()->set_source_rd(source_rd);
+}
+
+void BgpAttrBuilder::set_esi(const EthernetSegmentId &esi) {
+    if (get()->esi() != esi)
+        Clone()->set_esi(esi);
+}
+
+void BgpAttrBuilder::set_as_path(AsPathPtr aspath) {
+    if (get()->as_path() != aspath.get())
+        Clone()->set_as_path(aspath);
+}
+
+void BgpAttrBuilder::set_aspath_4byte(const AsPath4ByteSpec *spec) {
+    Clone()->set_aspath_4byte(spec);
+}
+
+void BgpAttrBuilder::set_community(CommunityPtr community) {
+    if (get()->community() != community.get())
+        Clone()->set_community(community);
+}
+
+void BgpAttrBuilder::set_ext_community(ExtCommunityPtr extcomm) {
+    if (get()->ext_community() != extcomm.get())
+        Clone()->set_ext_community(extcomm);
+}
+
+void BgpAttrBuilder::set_origin_vn_path(OriginVnPathPtr ovnpath) {
+    if (get()->origin_vn_path() != ovnpath.get())
+        Clone()->set_origin_vn_path(ovnpath);
+}
+
+void BgpAttrBuilder::set_pmsi_tunnel(const PmsiTunnelSpec *pmsi_spec) {
+    Clone()->set_pmsi_tunnel(pmsi_spec);
+}
+
+void BgpAttrBuilder::set_olist(const BgpOListSpec *olist_spec) {
+    Clone()->set_olist(olist_spec);
+}
+
+void BgpAttrBuilder::set_leaf_olist(const BgpOListSpec *leaf_olist_spec) {
+    Clone()->set_leaf_olist(leaf_olist_spec);
+}
+
+void BgpAttrBuilder::set_sub_protocol(const string &sub_protocol) {
+    if (get()->sub_protocol() != sub_protocol)
+        Clone()->set_sub_protocol(sub_protocol);
 }
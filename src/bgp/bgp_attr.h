@@ -8,6 +8,7 @@
 #include <boost/intrusive_ptr.hpp>
 #include <tbb/atomic.h>
 
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
@@ -194,7 +195,10 @@ public:
     size_t size() const { return spec_.cluster_list.size(); }
 
     friend std::size_t hash_value(const ClusterList &cluster_list) {
+        const std::vector<uint32_t> &list =
+            cluster_list.cluster_list().cluster_list;
         size_t hash = 0;
+        boost::hash_range(hash, list.begin(), list.end());
         return hash;
     }
 
@@ -338,8 +342,13 @@ public:
     uint32_t GetLabel(const ExtCommunity *ext) const;
 
     friend std::size_t hash_value(const PmsiTunnel &pmsi_tunnel) {
+        const PmsiTunnelSpec &spec = pmsi_tunnel.pmsi_tunnel();
         size_t hash = 0;
-        boost::hash_combine(hash, pmsi_tunnel.pmsi_tunnel().ToString());
+        boost::hash_combine(hash, spec.tunnel_flags);
+        boost::hash_combine(hash, spec.tunnel_type);
+        boost::hash_combine(hash, spec.label);
+        boost::hash_range(hash, spec.identifier.begin(),
+                          spec.identifier.end());
         return hash;
     }
 
@@ -433,9 +442,16 @@ public:
 
     const EdgeDiscoverySpec &edge_discovery() const { return edspec_; }
 
+    // Hash the sorted edge list, which is what CompareTo looks at.
     friend std::size_t hash_value(const EdgeDiscovery &edge_discovery) {
         size_t hash = 0;
-        boost::hash_combine(hash, edge_discovery.edge_discovery().ToString());
+        for (EdgeList::const_iterator it = edge_discovery.edge_list.begin();
+             it != edge_discovery.edge_list.end(); ++it) {
+            const Edge *edge = *it;
+            boost::hash_combine(hash, edge->address.to_ulong());
+            boost::hash_combine(hash, edge->label_block->first());
+            boost::hash_combine(hash, edge->label_block->last());
+        }
         return hash;
     }
 
@@ -540,9 +556,17 @@ public:
 
     const EdgeForwardingSpec &edge_forwarding() const { return efspec_; }
 
+    // Hash the sorted edge list, which is what CompareTo looks at.
     friend std::size_t hash_value(const EdgeForwarding &edge_forwarding) {
         size_t hash = 0;
-        boost::hash_combine(hash, edge_forwarding.edge_forwarding().ToString());
+        for (EdgeList::const_iterator it = edge_forwarding.edge_list.begin();
+             it != edge_forwarding.edge_list.end(); ++it) {
+            const Edge *edge = *it;
+            boost::hash_combine(hash, edge->inbound_address.to_ulong());
+            boost::hash_combine(hash, edge->outbound_address.to_ulong());
+            boost::hash_combine(hash, edge->inbound_label);
+            boost::hash_combine(hash, edge->outbound_label);
+        }
         return hash;
     }
 
@@ -667,9 +691,17 @@ public:
 
     const BgpOListSpec &olist() const { return olist_spec_; }
 
+    // Hash the sorted elements, which is what CompareTo looks at.
     friend std::size_t hash_value(const BgpOList &olist) {
         size_t hash = 0;
-        boost::hash_combine(hash, olist.olist().ToString());
+        boost::hash_combine(hash, olist.olist().subcode);
+        for (Elements::const_iterator it = olist.elements_.begin();
+             it != olist.elements_.end(); ++it) {
+            const BgpOListElem *elem = *it;
+            boost::hash_combine(hash, elem->address.to_ulong());
+            boost::hash_combine(hash, elem->label);
+            boost::hash_range(hash, elem->encap.begin(), elem->encap.end());
+        }
         return hash;
     }
 
@@ -987,8 +1019,77 @@ public:
     BgpServer *server() { return server_; }
     const BgpServer *server() const { return server_; }
 
+    // Number of attributes copied in order to be modified.
+    uint64_t clone_count() const { return clone_count_; }
+
 private:
+    friend class BgpAttrBuilder;
+
     BgpServer *server_;
+    tbb::atomic<uint64_t> clone_count_;
+};
+
+//
+// Applies a set of modifications to an interned BgpAttr and interns the
+// result once.
+//
+// The attribute is copied on the first modification that changes a field,
+// and all further modifications are made to the copy. Locate interns the
+// copy, or returns the original attribute without touching the database if
+// nothing was changed. This avoids allocating and interning an intermediate
+// attribute for every field, as happens when Replace...AndLocate methods of
+// BgpAttrDB are chained.
+//
+// The attribute passed to the constructor must be interned in attr_db.
+//
+class BgpAttrBuilder {
+public:
+    BgpAttrBuilder(BgpAttrDB *attr_db, const BgpAttr *attr);
+    ~BgpAttrBuilder();
+
+    void set_origin(BgpAttrOrigin::OriginType origin);
+    void set_nexthop(const IpAddress &nexthop);
+    void set_med(uint32_t med);
+    void set_local_pref(uint32_t local_pref);
+    void set_originator_id(Ip4Address originator_id);
+    void set_source_rd(const RouteDistinguisher &source_rd);
+    void set_esi(const EthernetSegmentId &esi);
+    void set_as_path(AsPathPtr aspath);
+    void set_aspath_4byte(const AsPath4ByteSpec *spec);
+    void set_community(CommunityPtr community);
+    void set_ext_community(ExtCommunityPtr extcomm);
+    void set_origin_vn_path(OriginVnPathPtr ovnpath);
+    void set_pmsi_tunnel(const PmsiTunnelSpec *pmsi_spec);
+    void set_olist(const BgpOListSpec *olist_spec);
+    void set_leaf_olist(const BgpOListSpec *leaf_olist_spec);
+    void set_sub_protocol(const std::string &sub_protocol);
+
+    // Attribute with the modifications made so far.
+    const BgpAttr *get() const {
+        return clone_.get() ? clone_.get() : attr_.get();
+    }
+
+    // Modifiable copy of the attribute, for changes without a setter.
+    BgpAttr *attr() { return Clone(); }
+
+    bool modified() const { return clone_.get() != NULL; }
+    BgpAttrDB *attr_db() { return attr_db_; }
+
+    // Intern the modified attribute. The builder may be used for further
+    // modifications of the returned attribute.
+    BgpAttrPtr Locate();
+
+    // Discard the modifications and continue from an interned attribute.
+    void Reset(const BgpAttr *attr);
+
+private:
+    BgpAttr *Clone();
+
+    BgpAttrDB *attr_db_;
+    BgpAttrPtr attr_;
+    std::auto_ptr<BgpAttr> clone_;
+
+    DISALLOW_COPY_AND_ASSIGN(BgpAttrBuilder);
 };
 
 #endif  // SRC_BGP_BGP_ATTR_H_
@@ -106,41 +106,86 @@ struct BgpProtoPrefix : public ParseObject {
     uint8_t type;
 };
 
+//
+// Counters maintained by BgpPathAttributeDB for each partition. They are
+// updated with the partition mutex held.
+//
+struct BgpPathAttributeDBStats {
+    BgpPathAttributeDBStats()
+        : lookups(0), hits(0), inserts(0), retries(0), deletes(0),
+          contentions(0) {
+    }
+
+    void Add(const BgpPathAttributeDBStats &rhs) {
+        lookups += rhs.lookups;
+        hits += rhs.hits;
+        inserts += rhs.inserts;
+        retries += rhs.retries;
+        deletes += rhs.deletes;
+        contentions += rhs.contentions;
+    }
+
+    uint64_t lookups;       // Locate requests
+    uint64_t hits;          // Locate requests satisfied by existing entry
+    uint64_t inserts;       // Locate requests that added a new entry
+    uint64_t retries;       // Existing entry found while being deleted
+    uint64_t deletes;
+    uint64_t contentions;   // Partition mutex was held by another thread
+};
+
 //
 // Base class to manage BGP Path Attributes database. This class provides
 // thread safe access to the data base.
 //
-// Lock contention can be tuned by varying the hash table size passed to the
-// constructor.
+// The database is split into partitions, each with its own set and mutex.
+// An attribute is assigned to a partition based on the hash of its contents,
+// so lock contention can be tuned by varying the number of partitions passed
+// to the constructor. The default can be overridden with the environment
+// variable BGP_PATH_ATTRIBUTE_DB_HASH_SIZE.
 //
 // Attribute contents must be hashable via hash_value() and hashed using
-// boost::hash_combine() to partition the attribute database.
+// boost::hash_combine() to partition the attribute database. hash_value()
+// must be consistent with TypeCompare and should hash the fields directly
+// rather than a string representation, since it is computed on every Locate.
 //
 template <class Type, class TypePtr, class TypeSpec, typename TypeCompare,
           class TypeDB>
 class BgpPathAttributeDB {
 public:
+    static const size_t kDefaultHashSize = 32;
+
     explicit BgpPathAttributeDB(int hash_size = GetHashSize())
         : hash_size_(hash_size),
-          set_(new Set[hash_size]),
-          mutex_(new tbb::mutex[hash_size]) {
+          partitions_(new Partition[hash_size]) {
     }
 
     size_t Size() {
         size_t size = 0;
 
         for (size_t i = 0; i < hash_size_; i++) {
-            tbb::mutex::scoped_lock lock(mutex_[i]);
-            size += set_[i].size();
+            tbb::mutex::scoped_lock lock(partitions_[i].mutex);
+            size += partitions_[i].set.size();
         }
         return size;
     }
 
+    size_t hash_size() const { return hash_size_; }
+
+    // Accumulate counters of all partitions.
+    void GetStats(BgpPathAttributeDBStats *stats) const {
+        for (size_t i = 0; i < hash_size_; i++) {
+            tbb::mutex::scoped_lock lock(partitions_[i].mutex);
+            stats->Add(partitions_[i].stats);
+        }
+    }
+
     void Delete(Type *attr) {
-        size_t hash = HashCompute(attr);
+        Partition *partition = &partitions_[HashCompute(attr)];
 
-        tbb::mutex::scoped_lock lock(mutex_[hash]);
-        assert(set_[hash].erase(attr));
+        tbb::mutex::scoped_lock lock;
+        Lock(&lock, partition);
+        assert(partition->set.erase(attr));
+        partition->stats.deletes++;
     }
 
     // Locate passed in attribute in the data base based on the attr ptr.
@@ -155,6 +200,14 @@ public:
     }
 
 private:
+    typedef std::set<Type *, TypeCompare> Set;
+
+    struct Partition {
+        tbb::mutex mutex;
+        Set set;
+        BgpPathAttributeDBStats stats;
+    };
+
     const size_t HashCompute(Type *attr) const {
         if (hash_size_ <= 1) return 0;
 
@@ -165,10 +218,17 @@ private:
 
     static size_t GetHashSize() {
         char *str = getenv("BGP_PATH_ATTRIBUTE_DB_HASH_SIZE");
+        if (!str) return kDefaultHashSize;
+        size_t hash_size = strtoul(str, NULL, 0);
+        return hash_size ? hash_size : 1;
+    }
 
-        // Use just one bucket for now.
-        if (!str) return 1;
-        return strtoul(str, NULL, 0);
+    // Acquire the partition mutex, noting if it had to be waited for.
+    static void Lock(tbb::mutex::scoped_lock *lock, Partition *partition) {
+        if (lock->try_acquire(partition->mutex))
+            return;
+        lock->acquire(partition->mutex);
+        partition->stats.contentions++;
     }
 
     // This template safely retrieves an attribute entry from its data base.
@@ -178,14 +238,16 @@ private:
     // existing entry is returned.
     TypePtr LocateInternal(Type *attr) {
         // Hash attribute contents to to avoid potential mutex contention.
-        size_t hash = HashCompute(attr);
+        Partition *partition = &partitions_[HashCompute(attr)];
         while (true) {
             // Grab mutex to keep db access thread safe.
-            tbb::mutex::scoped_lock lock(mutex_[hash]);
+            tbb::mutex::scoped_lock lock;
+            Lock(&lock, partition);
+            partition->stats.lookups++;
             std::pair<typename Set::iterator, bool> ret;
 
             // Try to insert the passed entry into the database.
-            ret = set_[hash].insert(attr);
+            ret = partition->set.insert(attr);
 
             // Take a reference to prevent this entry from getting deleted.
             // Counter is automatically incremented, hence we get thread safety
@@ -194,6 +256,8 @@ private:
 
             // Check if passed in entry did get into the data base.
             if (ret.second) {
+                partition->stats.inserts++;
+
                 // Take intrusive pointer, thereby incrementing the refcount.
                 TypePtr ptr = TypePtr(*ret.first);
 
@@ -212,6 +276,8 @@ private:
             // cases, we retry inserting the passed attribute pointer into the
             // data base.
             if (prev > 0) {
+                partition->stats.hits++;
+
                 // Free passed in attribute, as it is already in the database.
                 delete attr;
 
@@ -227,6 +293,7 @@ private:
             // Decrement the counter bumped up above as we can't use this entry
             // which is about to be deleted. Instead, retry inserting the passed
             // entry again, into the database.
+            partition->stats.retries++;
             intrusive_ptr_del_ref(*ret.first);
         }
 
@@ -234,10 +301,13 @@ private:
         return NULL;
     }
 
-    typedef std::set<Type *, TypeCompare> Set;
     size_t hash_size_;
-    boost::scoped_array<Set> set_;
-    boost::scoped_array<tbb::mutex> mutex_;
+    boost::scoped_array<Partition> partitions_;
 };
 
+template <class Type, class TypePtr, class TypeSpec, typename TypeCompare,
+          class TypeDB>
+const size_t BgpPathAttributeDB<Type, TypePtr, TypeSpec, TypeCompare,
+                                TypeDB>::kDefaultHashSize;
+
 #endif  // SRC_BGP_BGP_ATTR_BASE_H_
@@ -360,8 +360,10 @@ UpdateInfo *EvpnLocalMcastNode::GetUpdateInfo(EvpnRoute *route) {
 
     // Add BgpOList and leaf BgpOList to RibOutAttr for broadcast MAC route.
     BgpAttrDB *attr_db = partition_->server()->attr_db();
-    BgpAttrPtr attr = attr_db->ReplaceOListAndLocate(attr_.get(), &olist_spec);
-    attr = attr_db->ReplaceLeafOListAndLocate(attr.get(), &leaf_olist_spec);
+    BgpAttrBuilder builder(attr_db, attr_.get());
+    builder.set_olist(&olist_spec);
+    builder.set_leaf_olist(&leaf_olist_spec);
+    BgpAttrPtr attr = builder.Locate();
 
     UpdateInfo *uinfo = new UpdateInfo;
     uinfo->roattr =
@@ -6,8 +6,11 @@
 
 #include <boost/foreach.hpp>
 
+#include <algorithm>
+
 #include "base/task_annotations.h"
 #include "base/task_trigger.h"
+#include "base/time_util.h"
 #include "bgp/bgp_export.h"
 #include "bgp/bgp_log.h"
 #include "bgp/bgp_peer_types.h"
@@ -15,6 +18,8 @@
 #include "bgp/bgp_server.h"
 #include "bgp/bgp_update_sender.h"
 #include "bgp/routing-instance/routing_instance.h"
+#include "db/db.h"
+#include "db/db_table_walk_mgr.h"
 
 using std::list;
 using std::make_pair;
@@ -129,6 +134,7 @@ void BgpMembershipManager::Register(IPeer *peer, BgpTable *table,
     total_jobs_count_++;
     prs->set_ribin_registered(true);
     prs->set_action(RIBOUT_ADD);
+    prs->set_register_time(UTCTimestampUsec());
     Event *event = new Event(REGISTER_RIB, peer, table, policy, instance_id);
     EnqueueEvent(event);
 }
@@ -965,7 +971,10 @@ BgpMembershipManager::PeerRibState::PeerRibState(BgpMembershipManager *manager,
       ribin_registered_(false),
       ribout_registered_(false),
       instance_id_(-1),
-      subscription_gen_id_(0) {
+      subscription_gen_id_(0),
+      register_time_(0),
+      first_route_latency_(0),
+      join_latency_(0) {
 }
 
 //
@@ -1068,6 +1077,55 @@ void BgpMembershipManager::PeerRibState::FillMembershipInfo(
     smpi->set_ribout_registered(ribout_registered_);
     smpi->set_instance_id(instance_id_);
     smpi->set_generation_id(subscription_gen_id_);
+    smpi->set_first_route_latency_usecs(first_route_latency_);
+    smpi->set_join_latency_usecs(join_latency_);
+}
+
+//
+// Note the latency to the first route and to completion of the join for
+// the register request.
+// Times are ignored if they precede the register time, which happens when
+// the clock is stepped back.
+//
+void BgpMembershipManager::PeerRibState::SetJoinLatency(
+    uint64_t first_route_time, uint64_t join_time) {
+    first_route_latency_ = first_route_time > register_time_ ?
+        first_route_time - register_time_ : 0;
+    join_latency_ = join_time > register_time_ ?
+        join_time - register_time_ : 0;
+}
+
+//
+// Constructor.
+//
+BgpMembershipManager::Walker::TableWalk::TableWalk(RibState *rs)
+    : rs(rs), ribout_state_list_size(0) {
+    first_entry_time = 0;
+}
+
+//
+// Destructor.
+//
+BgpMembershipManager::Walker::TableWalk::~TableWalk() {
+    assert(walk_ref == NULL);
+    STLDeleteElements(&ribout_state_map);
+}
+
+//
+// Find or create the RibOutState for given RibOut.
+//
+BgpMembershipManager::Walker::RibOutState *
+BgpMembershipManager::Walker::TableWalk::LocateRibOutState(RibOut *ribout) {
+    RibOutStateMap::iterator loc = ribout_state_map.find(ribout);
+    if (loc == ribout_state_map.end()) {
+        RibOutState *ros = new RibOutState(ribout);
+        ribout_state_map.insert(make_pair(ribout, ros));
+        ribout_state_list.push_back(ros);
+        ribout_state_list_size++;
+        return ros;
+    } else {
+        return loc->second;
+    }
 }
 
 //
@@ -1079,11 +1137,7 @@ BgpMembershipManager::Walker::Walker(BgpMembershipManager *manager)
           boost::bind(&BgpMembershipManager::Walker::WalkTrigger, this),
           TaskScheduler::GetInstance()->GetTaskId("bgp::PeerMembership"), 0)),
       postpone_walk_(false),
-      walk_started_(false),
-      walk_completed_(false),
-      rs_(NULL),
-      rib_state_list_size_(0),
-      ribout_state_list_size_(0) {
+      rib_state_list_size_(0) {
 }
 
 //
@@ -1093,17 +1147,14 @@ BgpMembershipManager::Walker::~Walker() {
     assert(rib_state_set_.empty());
     assert(rib_state_list_.empty());
     assert(!postpone_walk_);
-    assert(!rs_);
-    assert(walk_ref_ == NULL);
-    assert(peer_rib_list_.empty());
-    assert(peer_list_.empty());
-    assert(ribout_state_map_.empty());
-    assert(ribout_state_list_.empty());
+    assert(table_walk_map_.empty());
+    assert(walk_done_list_.empty());
 }
 
 //
 // Add the given RibState to the RibStateList if it's not already present.
-// Trigger processing of the RibStateList if a walk is not already in progress.
+// Trigger processing of the RibStateList. A RibState for a BgpTable that's
+// being walked stays on the list till the walk is finished.
 //
 void BgpMembershipManager::Walker::Enqueue(RibState *rs) {
     if (rib_state_set_.find(rs) != rib_state_set_.end())
@@ -1111,7 +1162,7 @@ void BgpMembershipManager::Walker::Enqueue(RibState *rs) {
     rib_state_set_.insert(rs);
     rib_state_list_.push_back(rs);
     rib_state_list_size_++;
-    if (!walk_started_)
+    if (table_walk_map_.size() < GetMaxConcurrentWalks())
         trigger_->Set();
 }
 
@@ -1119,36 +1170,24 @@ void BgpMembershipManager::Walker::Enqueue(RibState *rs) {
 // Return true if the Walk does not have any pending items.
 //
 bool BgpMembershipManager::Walker::IsQueueEmpty() const {
-    return (rib_state_list_.empty() && !trigger_->IsSet() && !rs_);
-}
-
-//
-// Find or create the RibOutState for given RibOut.
-//
-BgpMembershipManager::Walker::RibOutState *
-BgpMembershipManager::Walker::LocateRibOutState(RibOut *ribout) {
-    RibOutStateMap::iterator loc = ribout_state_map_.find(ribout);
-    if (loc == ribout_state_map_.end()) {
-        RibOutState *ros = new RibOutState(ribout);
-        ribout_state_map_.insert(make_pair(ribout, ros));
-        ribout_state_list_.push_back(ros);
-        ribout_state_list_size_++;
-        return ros;
-    } else {
-        return loc->second;
-    }
+    return (rib_state_list_.empty() && !trigger_->IsSet() &&
+        table_walk_map_.empty());
 }
 
 //
 // Process table walk callback from DB infrastructure.
 //
-bool BgpMembershipManager::Walker::WalkCallback(DBTablePartBase *tpart,
-    DBEntryBase *db_entry) {
+bool BgpMembershipManager::Walker::WalkCallback(TableWalk *walk,
+    DBTablePartBase *tpart, DBEntryBase *db_entry) {
     CHECK_CONCURRENCY("db::DBTable");
 
+    // Note the time at which the first route is exported to joining peers.
+    if (walk->first_entry_time == 0)
+        walk->first_entry_time.compare_and_swap(UTCTimestampUsec(), 0);
+
     // Walk all RibOutStates and handle join/leave processing.
-    for (RibOutStateList::iterator it = ribout_state_list_.begin();
-         it != ribout_state_list_.end(); ++it) {
+    for (RibOutStateList::iterator it = walk->ribout_state_list.begin();
+         it != walk->ribout_state_list.end(); ++it) {
         RibOutState *ros = *it;
         RibOut *ribout = ros->ribout();
         ribout->bgp_export()->Join(tpart, ros->join_bitset(), db_entry);
@@ -1156,7 +1195,7 @@ bool BgpMembershipManager::Walker::WalkCallback(DBTablePartBase *tpart,
     }
 
     // Bail if there's no peers that need RibIn processing.
-    if (peer_list_.empty())
+    if (walk->peer_list.empty())
         return true;
 
     // Walk through all eligible paths and notify the source peer if needed.
@@ -1182,13 +1221,13 @@ bool BgpMembershipManager::Walker::WalkCallback(DBTablePartBase *tpart,
             continue;
 
         // Skip if there's no walk requested for this IPeer.
-        if (!peer || peer_list_.find(peer) == peer_list_.end())
+        if (!peer || walk->peer_list.find(peer) == walk->peer_list.end())
             continue;
 
         notify |= peer->MembershipPathCallback(tpart, route, path);
     }
 
-    rs_->table()->InputCommonPostProcess(tpart, route, notify);
+    walk->rs->table()->InputCommonPostProcess(tpart, route, notify);
     return true;
 }
 
@@ -1197,64 +1236,84 @@ bool BgpMembershipManager::Walker::WalkCallback(DBTablePartBase *tpart,
 // Just note that the walk has completed and trigger processing from the
 // bgp::PeerMembership task.
 //
-void BgpMembershipManager::Walker::WalkDoneCallback(DBTableBase *table_base) {
+void BgpMembershipManager::Walker::WalkDoneCallback(TableWalk *walk,
+    DBTableBase *table_base) {
     CHECK_CONCURRENCY("db::Walker");
-    assert(rs_->table() == table_base);
-    walk_completed_ = true;
+    assert(walk->rs->table() == table_base);
+    tbb::mutex::scoped_lock lock(walk_done_mutex_);
+    walk_done_list_.push_back(walk);
     trigger_->Set();
 }
 
 //
-// Start a walk for the BgpTable corresponding to the next RibState in the
-// RibStateList.
+// Get the maximum number of ongoing table walks.
+//
+size_t BgpMembershipManager::Walker::GetMaxConcurrentWalks() const {
+    DBTableWalkMgr *walk_mgr = manager_->server()->database()->GetWalkMgr();
+    return std::max(walk_mgr->max_concurrent_walks(), 1U);
+}
+
+//
+// Start walks for RibStates in the RibStateList till the maximum number of
+// ongoing table walks is reached. Skip RibStates for BgpTables that are
+// already being walked.
 //
 void BgpMembershipManager::Walker::WalkStart() {
     CHECK_CONCURRENCY("bgp::PeerMembership");
 
-    assert(walk_ref_ == NULL);
-    assert(!rs_);
-    assert(peer_rib_list_.empty());
-    assert(peer_list_.empty());
-    assert(ribout_state_map_.empty());
-    assert(ribout_state_list_.empty());
     assert(rib_state_list_size_ == rib_state_set_.size());
+    size_t max_walks = GetMaxConcurrentWalks();
+    for (RibStateList::iterator it = rib_state_list_.begin(), next = it;
+         it != rib_state_list_.end() && table_walk_map_.size() < max_walks;
+         it = next) {
+        ++next;
+        RibState *rs = *it;
+        if (table_walk_map_.find(rs) != table_walk_map_.end())
+            continue;
 
-    // Bail if the list if empty.
-    if (rib_state_list_.empty())
-        return;
+        // Remove the RibState from the RibStateList.
+        rib_state_list_.erase(it);
+        rib_state_list_size_--;
+        assert(rib_state_set_.erase(rs) == 1);
+        WalkStart(rs);
+    }
+}
 
-    // Get and remove the first RibState from the RibStateList.
-    rs_ = rib_state_list_.front();
-    rib_state_list_.pop_front();
-    rib_state_list_size_--;
-    assert(rib_state_set_.erase(rs_) == 1);
+//
+// Start a walk for the BgpTable corresponding to the given RibState.
+//
+void BgpMembershipManager::Walker::WalkStart(RibState *rs) {
+    CHECK_CONCURRENCY("bgp::PeerMembership");
+
+    TableWalk *walk = new TableWalk(rs);
+    assert(table_walk_map_.insert(make_pair(rs, walk)).second);
 
     // Process all pending PeerRibStates for chosen RibState.
     // Insert the PeerRibStates into PeerRibList for post processing when
     // table walk is complete.
-    for (RibState::iterator it = rs_->begin(); it != rs_->end(); ++it) {
+    for (RibState::iterator it = rs->begin(); it != rs->end(); ++it) {
         PeerRibState *prs = *it;
-        peer_rib_list_.insert(prs);
+        walk->peer_rib_list.insert(prs);
 
         // Update PeerList for RIBIN actions and RibOutStateMap for RIBOUT
         // actions.
         switch (prs->action()) {
         case RIBOUT_ADD: {
-            RibOutState *ros = LocateRibOutState(prs->ribout());
+            RibOutState *ros = walk->LocateRibOutState(prs->ribout());
             ros->JoinPeer(prs->ribout_index());
             break;
         }
         case RIBIN_DELETE:
         case RIBIN_WALK: {
             IPeer *peer = prs->peer_state()->peer();
-            peer_list_.insert(peer);
+            walk->peer_list.insert(peer);
             break;
         }
         case RIBIN_WALK_RIBOUT_DELETE:
         case RIBIN_DELETE_RIBOUT_DELETE: {
             IPeer *peer = prs->peer_state()->peer();
-            peer_list_.insert(peer);
-            RibOutState *ros = LocateRibOutState(prs->ribout());
+            walk->peer_list.insert(peer);
+            RibOutState *ros = walk->LocateRibOutState(prs->ribout());
             ros->LeavePeer(prs->ribout_index());
             break;
         }
@@ -1268,44 +1327,53 @@ void BgpMembershipManager::Walker::WalkStart() {
     // Clear the pending PeerRibStates in the RibState.
     // This allows the RibState to accumulate new PeerRibStates for a future
     // walk of it's BgpTable.
-    rs_->ClearPeerRibStateList();
-
-    // Start the walk.
-    rs_->increment_walk_count();
-    BgpTable *table = rs_->table();
-    walk_ref_ = table->AllocWalker(
-        boost::bind(&BgpMembershipManager::Walker::WalkCallback, this, _1, _2),
-        boost::bind(&BgpMembershipManager::Walker::WalkDoneCallback, this, _2));
-    walk_started_ = true;
+    rs->ClearPeerRibStateList();
+
+    // Start the walk. Peers wait for this walk before routes are advertised
+    // to them, so it's queued ahead of other table walks.
+    rs->increment_walk_count();
+    BgpTable *table = rs->table();
+    walk->walk_ref = table->AllocWalker(
+        boost::bind(&BgpMembershipManager::Walker::WalkCallback,
+            this, walk, _1, _2),
+        boost::bind(&BgpMembershipManager::Walker::WalkDoneCallback,
+            this, walk, _2),
+        DBTable::WALK_PRIORITY_HIGH);
     if (!postpone_walk_)
-        table->WalkTable(walk_ref_);
+        table->WalkTable(walk->walk_ref);
 }
 
 //
-// Finish processing of the walk of BgpTable for current RibState.
+// Finish processing of the walk of BgpTable for given TableWalk.
 //
 // The walk complete notification is handled by WalkDoneCallback but all the
 // book-keeping and triggering of Events is handled by this method since it
 // needs to happen in bgp::PeerMembership task.
 //
-void BgpMembershipManager::Walker::WalkFinish() {
+void BgpMembershipManager::Walker::WalkFinish(TableWalk *walk) {
     CHECK_CONCURRENCY("bgp::PeerMembership");
 
-    assert(walk_ref_ != NULL);
-    assert(rs_);
-    assert(!peer_rib_list_.empty());
-    assert(!peer_list_.empty() || !ribout_state_map_.empty());
-    assert(rib_state_list_size_ == rib_state_set_.size());
-    assert(ribout_state_list_size_ == ribout_state_map_.size());
-
-    BgpTable *table = rs_->table();
-    for (PeerRibList::iterator it = peer_rib_list_.begin();
-         it != peer_rib_list_.end(); ++it) {
+    assert(walk->walk_ref != NULL);
+    assert(!walk->peer_rib_list.empty());
+    assert(!walk->peer_list.empty() || !walk->ribout_state_map.empty());
+    assert(walk->ribout_state_list_size == walk->ribout_state_map.size());
+
+    // The first route time is the finish time if the table was empty.
+    uint64_t finish_time = UTCTimestampUsec();
+    uint64_t first_route_time = walk->first_entry_time;
+    if (!first_route_time)
+        first_route_time = finish_time;
+
+    RibState *rs = walk->rs;
+    BgpTable *table = rs->table();
+    for (PeerRibList::iterator it = walk->peer_rib_list.begin();
+         it != walk->peer_rib_list.end(); ++it) {
         PeerRibState *prs = *it;
         IPeer *peer = prs->peer_state()->peer();
 
         switch (prs->action()) {
         case RIBOUT_ADD:
+            prs->SetJoinLatency(first_route_time, finish_time);
             manager_->TriggerRegisterRibCompleteEvent(peer, table);
             break;
         case RIBIN_DELETE:
@@ -1322,33 +1390,28 @@ void BgpMembershipManager::Walker::WalkFinish() {
         }
     }
 
-    table->ReleaseWalker(walk_ref_);
-    rs_ = NULL;
-    peer_rib_list_.clear();
-    peer_list_.clear();
-    ribout_state_list_.clear();
-    ribout_state_list_size_ = 0;
-    STLDeleteElements(&ribout_state_map_);
-
-    walk_started_ = false;
-    walk_completed_ = false;
+    table->ReleaseWalker(walk->walk_ref);
+    assert(table_walk_map_.erase(rs) == 1);
+    delete walk;
 }
 
 //
 // Handler for TaskTrigger.
-// Start a new walk or finish processing for the current walk and start a new
-// one.
+// Finish processing for completed walks and start new ones.
 //
 bool BgpMembershipManager::Walker::WalkTrigger() {
     CHECK_CONCURRENCY("bgp::PeerMembership");
 
-    if (!walk_started_) {
-        assert(!walk_completed_);
-        WalkStart();
-    } else if (walk_completed_) {
-        WalkFinish();
-        WalkStart();
+    TableWalkList walk_done_list;
+    {
+        tbb::mutex::scoped_lock lock(walk_done_mutex_);
+        walk_done_list.swap(walk_done_list_);
+    }
+    for (TableWalkList::iterator it = walk_done_list.begin();
+         it != walk_done_list.end(); ++it) {
+        WalkFinish(*it);
     }
+    WalkStart();
     return true;
 }
 
@@ -1366,24 +1429,63 @@ void BgpMembershipManager::Walker::SetQueueDisable(bool value) {
 }
 
 //
-// Force the Walker to trigger walks that are postponed.
+// Get the total number of IPeers for RibIn processing in ongoing walks.
+// Testing only.
+//
+size_t BgpMembershipManager::Walker::GetPeerListSize() const {
+    size_t size = 0;
+    for (TableWalkMap::const_iterator it = table_walk_map_.begin();
+         it != table_walk_map_.end(); ++it) {
+        size += it->second->peer_list.size();
+    }
+    return size;
+}
+
+//
+// Get the total number of PeerRibStates in ongoing walks.
+// Testing only.
+//
+size_t BgpMembershipManager::Walker::GetPeerRibListSize() const {
+    size_t size = 0;
+    for (TableWalkMap::const_iterator it = table_walk_map_.begin();
+         it != table_walk_map_.end(); ++it) {
+        size += it->second->peer_rib_list.size();
+    }
+    return size;
+}
+
+//
+// Get the total number of RibOutStates in ongoing walks.
+// Testing only.
+//
+size_t BgpMembershipManager::Walker::GetRibOutStateListSize() const {
+    size_t size = 0;
+    for (TableWalkMap::const_iterator it = table_walk_map_.begin();
+         it != table_walk_map_.end(); ++it) {
+        size += it->second->ribout_state_list_size;
+    }
+    return size;
+}
+
+//
+// Force the Walker to postpone walks that are started from now onwards.
 // Testing only.
 //
 void BgpMembershipManager::Walker::PostponeWalk() {
-    assert(!walk_started_);
-    assert(walk_ref_ == NULL);
+    assert(table_walk_map_.empty());
     postpone_walk_ = true;
 }
 
 //
-// Tell the DBTableWalkMgr to resume walk that was postponed previously.
+// Tell the DBTableWalkMgr to resume walks that were postponed previously.
 // Testing only.
 //
 void BgpMembershipManager::Walker::ResumeWalk() {
-    assert(walk_started_);
-    assert(!walk_completed_);
-    assert(walk_ref_ != NULL);
+    assert(!table_walk_map_.empty());
     postpone_walk_ = false;
-    BgpTable *table = rs_->table();
-    table->WalkTable(walk_ref_);
+    for (TableWalkMap::iterator it = table_walk_map_.begin();
+         it != table_walk_map_.end(); ++it) {
+        TableWalk *walk = it->second;
+        walk->rs->table()->WalkTable(walk->walk_ref);
+    }
 }
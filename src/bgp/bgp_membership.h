@@ -8,6 +8,7 @@
 #include <boost/dynamic_bitset.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <tbb/atomic.h>
+#include <tbb/mutex.h>
 #include <tbb/spin_rw_mutex.h>
 
 #include <list>
@@ -375,6 +376,11 @@ public:
     void set_subscription_gen_id(uint64_t subscription_gen_id) {
         subscription_gen_id_ = subscription_gen_id;
     }
+    uint64_t register_time() const { return register_time_; }
+    void set_register_time(uint64_t time) { register_time_ = time; }
+    uint64_t first_route_latency() const { return first_route_latency_; }
+    uint64_t join_latency() const { return join_latency_; }
+    void SetJoinLatency(uint64_t first_route_time, uint64_t join_time);
 
 private:
     BgpMembershipManager *manager_;
@@ -387,6 +393,9 @@ private:
     bool ribout_registered_;
     int instance_id_;
     uint64_t subscription_gen_id_;
+    uint64_t register_time_;
+    uint64_t first_route_latency_;
+    uint64_t join_latency_;
 
     DISALLOW_COPY_AND_ASSIGN(PeerRibState);
 };
@@ -394,12 +403,20 @@ private:
 //
 // This class is responsible for efficient implementation of BgpTable walks
 // for the BgpMembershipManager. It accepts walk requests for any number of
-// RibStates and triggers table walks one at a time. It has a maximum of one
-// ongoing table walk at any given time.
+// RibStates and triggers table walks for them. Walks of different BgpTables
+// are independent of each other, so the Walker runs them concurrently. The
+// number of ongoing table walks is limited to the maximum number of
+// concurrent walks in the DBTableWalkMgr. Starting more walks than that
+// would only queue them in the DBTableWalkMgr, while keeping the RibStates
+// in the RibStateList allows them to accumulate more PeerRibStates till a
+// walk can actually be run. There's a maximum of one ongoing walk for any
+// given BgpTable.
 //
 // The RibStateList contains all RibStates for which walks have not yet been
-// started. The Walker removes the first RibState from the list and starts a
-// table walk for it.
+// started. The Walker removes the first RibState whose BgpTable is not being
+// walked from the list and starts a table walk for it. A RibState that is
+// enqueued while a walk for it's BgpTable is in progress stays on the list
+// till that walk finishes.
 //
 // The RibStateSet is used to prevent duplicates in the RibStateList. Using
 // just the RibStateSet to maintain the pending RibStates would have caused
@@ -413,35 +430,42 @@ private:
 // There's no issues with concurrent access in the former case. In the latter
 // case, access is serialized because of the mutex in BgpMembershipManager.
 //
-// The Walker creates temporary internal state when it starts a table walk so
-// that walk callbacks for each DBEntry can be handled with minimal processing
-// overhead. Details on this temporary state are as follows:
+// The Walker creates a TableWalk when it starts a table walk so that walk
+// callbacks for each DBEntry can be handled with minimal processing overhead.
+// The TableWalkMap contains the TableWalks for all ongoing walks, keyed by
+// RibState. Details on a TableWalk are as follows:
 //
-// - walk_ref_ is the walker for the current walk
-// - rs_ is the RibState for which the walk was started
-// - peer_rib_list_ is the list of PeerRibStates for the current RibState
-//   that have a pending action. The pending list in RibState is logically
-//   moved to this field. This allows the RibState to accumulate a new set
-//   of pending PeerRibStates that can be serviced in a subsequent walk.
-//   The peer_rib_list_ is used to create and enqueue events when the table
+// - walk_ref is the walker for the walk
+// - rs is the RibState for which the walk was started
+// - peer_rib_list is the list of PeerRibStates for the RibState that have
+//   a pending action. The pending list in RibState is logically moved to
+//   this field. This allows the RibState to accumulate a new set of pending
+//   PeerRibStates that can be serviced in a subsequent walk.
+//   The peer_rib_list is used to create and enqueue events when the table
 //   walk finishes.
-// - peer_list_ is the list of IPeers to be notified about BgpPaths added
+// - peer_list is the list of IPeers to be notified about BgpPaths added
 //   by them for RibIn processing.
-// - ribout_state_map_ is a map of RibOutStates that need to be processed
+// - ribout_state_map is a map of RibOutStates that need to be processed
 //   for each route.
-// - ribout_state_list_ is a list of same RibOutStates as ribout_state_map_.
-//   It allows simpler traversal compared to the ribout_state_map_ when each
+// - ribout_state_list is a list of same RibOutStates as ribout_state_map.
+//   It allows simpler traversal compared to the ribout_state_map when each
 //   DBEntry is processed.
+// - first_entry_time is the time at which the first DBEntry was processed.
+//   It's used to compute the latency to the first route for PeerRibStates
+//   with a RIBOUT_ADD action.
 //
 // A RibOutState is created for each unique RibOut in the PeerRibStates in
-// peer_rib_list_. It's join and leave bitsets are based on the action in
-// the PeerRibStates.
+// peer_rib_list. It's join and leave bitsets are based on the action in
+// the PeerRibStates. Hence joins of all peers in the same RibOut are handled
+// with a single call to BgpExport::Join for each DBEntry.
 //
 // A TaskTrigger that runs in context of bgp::PeerMembership task is used to
 // handle start and finish of table walks. This avoids concurrency issues in
 // accessing/clearing the pending list in the RibState. Note that TaskTrigger
 // in this class and the WorkQueue in BgpMembershipManager both use instance
-// id of 0, so they can't run concurrently.
+// id of 0, so they can't run concurrently. Walk done callbacks for different
+// tables can run concurrently, so TableWalks that are done are added to the
+// TableWalkList under the mutex.
 //
 class BgpMembershipManager::Walker {
 public:
@@ -483,19 +507,44 @@ private:
     typedef std::list<RibOutState *> RibOutStateList;
     typedef std::set<const IPeer *> PeerList;
 
-    RibOutState *LocateRibOutState(RibOut *ribout);
-    bool WalkCallback(DBTablePartBase *tpart, DBEntryBase *db_entry);
-    void WalkDoneCallback(DBTableBase *table);
+    struct TableWalk {
+        explicit TableWalk(RibState *rs);
+        ~TableWalk();
+
+        RibOutState *LocateRibOutState(RibOut *ribout);
+
+        DBTable::DBTableWalkRef walk_ref;
+        RibState *rs;
+        PeerRibList peer_rib_list;
+        PeerList peer_list;
+        RibOutStateMap ribout_state_map;
+        RibOutStateList ribout_state_list;
+        size_t ribout_state_list_size;
+        tbb::atomic<uint64_t> first_entry_time;
+
+    private:
+        DISALLOW_COPY_AND_ASSIGN(TableWalk);
+    };
+
+    typedef std::map<RibState *, TableWalk *> TableWalkMap;
+    typedef std::vector<TableWalk *> TableWalkList;
+
+    bool WalkCallback(TableWalk *walk, DBTablePartBase *tpart,
+        DBEntryBase *db_entry);
+    void WalkDoneCallback(TableWalk *walk, DBTableBase *table);
+    size_t GetMaxConcurrentWalks() const;
     void WalkStart();
-    void WalkFinish();
+    void WalkStart(RibState *rs);
+    void WalkFinish(TableWalk *walk);
     bool WalkTrigger();
 
     // Testing only.
     void SetQueueDisable(bool value);
     size_t GetQueueSize() const { return rib_state_list_size_; }
-    size_t GetPeerListSize() const { return peer_list_.size(); }
-    size_t GetPeerRibListSize() const { return peer_rib_list_.size(); }
-    size_t GetRibOutStateListSize() const { return ribout_state_list_size_; }
+    size_t GetWalkCount() const { return table_walk_map_.size(); }
+    size_t GetPeerListSize() const;
+    size_t GetPeerRibListSize() const;
+    size_t GetRibOutStateListSize() const;
     void PostponeWalk();
     void ResumeWalk();
 
@@ -505,16 +554,10 @@ private:
     boost::scoped_ptr<TaskTrigger> trigger_;
 
     bool postpone_walk_;
-    bool walk_started_;
-    bool walk_completed_;
-    DBTable::DBTableWalkRef walk_ref_;
-    RibState *rs_;
-    PeerRibList peer_rib_list_;
-    PeerList peer_list_;
-    RibOutStateMap ribout_state_map_;
-    RibOutStateList ribout_state_list_;
+    TableWalkMap table_walk_map_;
+    tbb::mutex walk_done_mutex_;
+    TableWalkList walk_done_list_;
     size_t rib_state_list_size_;
-    size_t ribout_state_list_size_;
 
     DISALLOW_COPY_AND_ASSIGN(Walker);
 };
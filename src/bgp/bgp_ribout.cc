@@ -573,6 +573,8 @@ void RibOut::FillStatisticsInfo(vector<ShowRibOutStatistics> *sros_list) const {
         sros.set_marker_splits(stats.marker_split_count_);
         sros.set_marker_merges(stats.marker_merge_count_);
         sros.set_marker_moves(stats.marker_move_count_);
+        sros.set_cache_hits(stats.cache_hit_count_);
+        sros.set_cache_misses(stats.cache_miss_count_);
         sros_list->push_back(sros);
     }
 }
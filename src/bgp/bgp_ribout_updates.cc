@@ -12,6 +12,7 @@
 #include "bgp/bgp_peer_types.h"
 #include "bgp/bgp_ribout.h"
 #include "bgp/bgp_route.h"
+#include "bgp/bgp_table.h"
 #include "bgp/bgp_update_queue.h"
 #include "bgp/bgp_update_monitor.h"
 #include "bgp/bgp_update_sender.h"
@@ -140,6 +141,11 @@ bool RibOutUpdates::DequeueCommon(UpdateQueue *queue, UpdateMarker *marker,
     // other than the ones in the given UpdateMarker.
     bool cache_routes = queue->marker_count() != 0;
 
+    // Share encoded routes with other RibOuts for the table, if any.
+    MessageCache *message_cache = NULL;
+    if (ribout_->table()->ribout_map().size() > 1)
+        message_cache = ribout_->sender()->message_cache(index_);
+
     // Go through all UpdateInfo elements for the RouteUpdate.
     int queue_id = rt_update->queue_id();
     RibPeerSet rt_blocked;
@@ -173,6 +179,7 @@ bool RibOutUpdates::DequeueCommon(UpdateQueue *queue, UpdateMarker *marker,
         stats_[queue_id].messages_built_count_++;
         Message *message = GetMessage();
         assert(message);
+        message->set_cache(message_cache);
         bool msg_built = message->Start(
             ribout_, cache_routes, &uinfo->roattr, rt_update->route());
         if (msg_built) {
@@ -180,6 +187,9 @@ bool RibOutUpdates::DequeueCommon(UpdateQueue *queue, UpdateMarker *marker,
             message->Finish();
             UpdateSend(queue_id, message, msgset, &msg_blocked);
         }
+        stats_[queue_id].cache_hit_count_ += message->num_cache_hits();
+        stats_[queue_id].cache_miss_count_ += message->num_cache_misses();
+        message->set_cache(NULL);
 
         // Reset bits in the UpdateInfo.  Note that this has already been done
         // via UpdatePack for all the other UpdateInfo elements that we packed
@@ -694,4 +704,6 @@ void RibOutUpdates::AddStatisticsInfo(int queue_id, Stats *stats) const {
     stats->marker_split_count_   += stats_[queue_id].marker_split_count_;
     stats->marker_merge_count_   += stats_[queue_id].marker_merge_count_;
     stats->marker_move_count_    += stats_[queue_id].marker_move_count_;
+    stats->cache_hit_count_      += stats_[queue_id].cache_hit_count_;
+    stats->cache_miss_count_     += stats_[queue_id].cache_miss_count_;
 }
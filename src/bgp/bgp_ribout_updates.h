@@ -59,6 +59,8 @@ public:
         uint64_t marker_split_count_;
         uint64_t marker_merge_count_;
         uint64_t marker_move_count_;
+        uint64_t cache_hit_count_;
+        uint64_t cache_miss_count_;
     };
 
     RibOutUpdates(RibOut *ribout, int index);
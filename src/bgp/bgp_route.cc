@@ -87,12 +87,15 @@ void BgpRoute::InsertPath(BgpPath *path) {
         } else {
             IPeer *peer = path->GetPeer();
             if (peer) {
-                // Take snapshot of original attribute
-                BgpAttr *out_attr = new BgpAttr(*(path->GetOriginalAttr()));
-                peer->ProcessPathTunnelEncapsulation(path, out_attr,
-                    table->server()->extcomm_db(), table);
-                BgpAttrPtr modified_attr =
-                    table->server()->attr_db()->Locate(out_attr);
+                // Take snapshot of original attribute, copied only if the
+                // peer has a default tunnel encapsulation for the family
+                BgpAttrBuilder builder(table->server()->attr_db(),
+                                       path->GetOriginalAttr());
+                if (!peer->GetDefaultTunnelEncap(table->family()).empty()) {
+                    peer->ProcessPathTunnelEncapsulation(path, builder.attr(),
+                        table->server()->extcomm_db(), table);
+                }
+                BgpAttrPtr modified_attr = builder.Locate();
                 // Update the path with new set of attributes
                 path->SetAttr(modified_attr, path->GetOriginalAttr());
             }
@@ -8,16 +8,21 @@
 #include <boost/foreach.hpp>
 #include <sandesh/request_pipeline.h>
 
+#include "bgp/bgp_aspath.h"
+#include "bgp/bgp_attr.h"
 #include "bgp/bgp_multicast.h"
 #include "bgp/bgp_mvpn.h"
+#include "bgp/bgp_origin_vn_path.h"
 #include "bgp/bgp_peer.h"
 #include "bgp/bgp_peer_internal_types.h"
 #include "bgp/bgp_server.h"
 #include "bgp/bgp_session_manager.h"
+#include "bgp/community.h"
 #include "bgp/ermvpn/ermvpn_table.h"
 #include "bgp/inet/inet_table.h"
 #include "bgp/mvpn/mvpn_table.h"
 #include "bgp/routing-instance/peer_manager.h"
+#include "bgp/routing-instance/routepath_replicator.h"
 #include "bgp/routing-instance/routing_instance.h"
 
 using boost::assign::list_of;
@@ -608,6 +613,24 @@ void ShowRouteVrfReq::HandleRequest() const {
 
 class ShowBgpServerHandler {
 public:
+    template <typename AttributeDB>
+    static void FillAttributeDBStats(const string &name, AttributeDB *db,
+                                     vector<ShowPathAttributeDBStats> *list) {
+        BgpPathAttributeDBStats stats;
+        db->GetStats(&stats);
+        ShowPathAttributeDBStats sdbs;
+        sdbs.set_name(name);
+        sdbs.set_size(db->Size());
+        sdbs.set_partitions(db->hash_size());
+        sdbs.set_lookups(stats.lookups);
+        sdbs.set_hits(stats.hits);
+        sdbs.set_inserts(stats.inserts);
+        sdbs.set_retries(stats.retries);
+        sdbs.set_deletes(stats.deletes);
+        sdbs.set_contentions(stats.contentions);
+        list->push_back(sdbs);
+    }
+
     static bool CallbackS1(const Sandesh *sr,
             const RequestPipeline::PipeSpec ps, int stage, int instNum,
             RequestPipeline::InstData *data) {
@@ -624,6 +647,44 @@ public:
         bsc->bgp_server->session_manager()->GetTxSocketStats(&peer_socket_stats);
         resp->set_tx_socket_stats(peer_socket_stats);
 
+        BgpServer *server = bsc->bgp_server;
+        vector<ShowPathAttributeDBStats> db_stats;
+        FillAttributeDBStats("attr", server->attr_db(), &db_stats);
+        db_stats.back().set_clones(server->attr_db()->clone_count());
+        FillAttributeDBStats("aspath", server->aspath_db(), &db_stats);
+        FillAttributeDBStats("aspath-4byte", server->aspath_4byte_db(),
+                             &db_stats);
+        FillAttributeDBStats("as4path", server->as4path_db(), &db_stats);
+        FillAttributeDBStats("cluster-list", server->cluster_list_db(),
+                             &db_stats);
+        FillAttributeDBStats("community", server->comm_db(), &db_stats);
+        FillAttributeDBStats("ext-community", server->extcomm_db(),
+                             &db_stats);
+        FillAttributeDBStats("origin-vn-path", server->ovnpath_db(),
+                             &db_stats);
+        FillAttributeDBStats("olist", server->olist_db(), &db_stats);
+        FillAttributeDBStats("pmsi-tunnel", server->pmsi_tunnel_db(),
+                             &db_stats);
+        FillAttributeDBStats("edge-discovery", server->edge_discovery_db(),
+                             &db_stats);
+        FillAttributeDBStats("edge-forwarding", server->edge_forwarding_db(),
+                             &db_stats);
+        resp->set_attribute_db_stats(db_stats);
+
+        vector<ShowReplicatorStats> replicator_stats;
+        Address::Family families[] = {
+            Address::INETVPN, Address::INET6VPN, Address::EVPN,
+            Address::ERMVPN, Address::MVPN
+        };
+        BOOST_FOREACH(Address::Family family, families) {
+            const RoutePathReplicator *replicator = server->replicator(family);
+            ShowReplicatorStats srs;
+            srs.set_family(Address::FamilyToString(family));
+            srs.set_replicated_paths(replicator->replicated_path_count());
+            replicator_stats.push_back(srs);
+        }
+        resp->set_replicator_stats(replicator_stats);
+
         resp->set_context(req->context());
         resp->Response();
         return true;
@@ -37,6 +37,11 @@ static void FillRouteTableSummaryInfo(ShowRouteTableSummary *srts,
     srts->set_actual_walks(table->walk_count());
     srts->set_walk_completes(table->walk_complete_count());
     srts->set_walk_cancels(table->walk_cancel_count());
+    srts->set_walk_entries_visited(table->walk_entries_visited());
+    srts->set_last_walk_wait_usecs(table->last_walk_wait_time());
+    srts->set_max_walk_wait_usecs(table->max_walk_wait_time());
+    srts->set_last_walk_duration_usecs(table->last_walk_duration());
+    srts->set_max_walk_duration_usecs(table->max_walk_duration());
     size_t markers = 0;
     srts->set_pending_updates(table->GetPendingRiboutsCount(&markers));
     srts->set_markers(markers);
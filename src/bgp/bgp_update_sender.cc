@@ -382,6 +382,8 @@ public:
     virtual bool Run() {
         CHECK_CONCURRENCY("bgp::SendUpdate");
 
+        MessageCache *message_cache = partition_->message_cache();
+        message_cache->Enable();
         while (true) {
             auto_ptr<WorkBase> wentry = partition_->WorkDequeue();
             if (!wentry.get())
@@ -401,6 +403,7 @@ public:
             }
             }
         }
+        message_cache->Clear();
 
         return true;
     }
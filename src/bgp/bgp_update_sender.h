@@ -12,6 +12,7 @@
 #include "base/bitset.h"
 #include "base/index_map.h"
 #include "base/queue_task.h"
+#include "bgp/message_cache.h"
 
 class BgpServer;
 class BgpUpdateSender;
@@ -39,6 +40,10 @@ class RibPeerSet;
 // to a tail dequeue for a (RibOut, QueueId) or a WorkPeer which corresponds
 // to a peer dequeue.
 //
+// A BgpSenderPartition also has a MessageCache to share encoded routes among
+// all RibOuts. The cache is used only while the Worker runs, since routes in
+// the partition can't change during that time.
+//
 // A mutex is used to control access to the WorkQueue between producers that
 // need to enqueue WorkBase entries and the Worker which dequeues the entries
 // and processes them. The producers are the BgpExport class which creates a
@@ -64,6 +69,7 @@ public:
 
     int task_id() const;
     int index() const { return index_; }
+    MessageCache *message_cache() { return &message_cache_; }
 
     // For unit testing.
     void set_disabled(bool disabled);
@@ -141,6 +147,7 @@ private:
     Worker *worker_task_;
     PeerStateMap peer_state_imap_;
     RibStateMap rib_state_imap_;
+    MessageCache message_cache_;
 
     DISALLOW_COPY_AND_ASSIGN(BgpSenderPartition);
 };
@@ -172,6 +179,10 @@ public:
     int task_id() const { return task_id_; }
     bool CheckInvariants() const;
 
+    MessageCache *message_cache(int index) {
+        return partitions_[index]->message_cache();
+    }
+
     // For unit testing.
     void DisableProcessing();
     void EnableProcessing();
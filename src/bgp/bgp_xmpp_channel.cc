@@ -19,6 +19,7 @@
 #include "bgp/bgp_membership.h"
 #include "bgp/bgp_server.h"
 #include "bgp/bgp_update_sender.h"
+#include "bgp/bgp_xmpp_item_decoder.h"
 #include "bgp/bgp_xmpp_peer_close.h"
 #include "bgp/inet/inet_table.h"
 #include "bgp/inet6/inet6_table.h"
@@ -59,11 +60,6 @@ using autogen::MvpnItemType;
 using autogen::MvpnNextHopType;
 using autogen::MvpnTunnelEncapsulationListType;
 
-using autogen::ItemType;
-using autogen::NextHopListType;
-using autogen::SecurityGroupListType;
-using autogen::CommunityTagListType;
-using autogen::TunnelEncapsulationListType;
 using autogen::TagListType;
 
 using boost::assign::list_of;
@@ -82,6 +78,10 @@ using std::set;
 using std::string;
 using std::vector;
 
+typedef BgpXmppInetItem::NextHopList InetNextHopList;
+typedef BgpXmppInetItem::StringList InetStringList;
+typedef BgpXmppInetItem::IntList InetIntList;
+
 //
 // Calculate med from local preference.
 // Should move agent definitions to a common location and use those here
@@ -623,6 +623,11 @@ TcpSession::Endpoint BgpXmppChannel::endpoint() const {
 
 bool BgpXmppChannel::XmppDecodeAddress(int af, const string &address,
                                        IpAddress *addrp, bool zero_ok) {
+    return XmppDecodeAddress(af, address.c_str(), addrp, zero_ok);
+}
+
+bool BgpXmppChannel::XmppDecodeAddress(int af, const char *address,
+                                       IpAddress *addrp, bool zero_ok) {
     if (af != BgpAf::IPv4 && af != BgpAf::IPv6 && af != BgpAf::L2Vpn)
         return false;
 
@@ -1138,10 +1143,8 @@ bool BgpXmppChannel::ProcessMvpnItem(string vrf_name,
 
 bool BgpXmppChannel::ProcessItem(string vrf_name,
     const pugi::xml_node &node, bool add_change, int primary_instance_id) {
-    ItemType item;
-    item.Clear();
-
-    if (!item.XmlParse(node)) {
+    BgpXmppInetItem item;
+    if (!item.Decode(node)) {
         BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name, BGP_LOG_FLAG_ALL,
             "Invalid inet route message received");
         return false;
@@ -1161,15 +1164,16 @@ bool BgpXmppChannel::ProcessItem(string vrf_name,
             " for inet route " << item.entry.nlri.address);
         return false;
     }
-    error_code error;
-    Ip4Prefix inet_prefix =
-        Ip4Prefix::FromString(item.entry.nlri.address, &error);
-    if (error) {
+    Ip4Address inet_addr;
+    int inet_prefixlen;
+    if (!item.DecodePrefix(&inet_addr, &inet_prefixlen)) {
         BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name, BGP_LOG_FLAG_ALL,
             "Bad inet route " << item.entry.nlri.address);
         return false;
     }
 
+    Ip4Prefix inet_prefix(inet_addr, inet_prefixlen);
+
     if (add_change && item.entry.next_hops.next_hop.empty()) {
         BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name, BGP_LOG_FLAG_ALL,
             "Missing next-hops for inet route " << inet_prefix.ToString());
@@ -1206,7 +1210,7 @@ bool BgpXmppChannel::ProcessItem(string vrf_name,
         req.oper = DBRequest::DB_ENTRY_ADD_CHANGE;
         BgpAttrSpec attrs;
 
-        const NextHopListType &inh_list = item.entry.next_hops;
+        const InetNextHopList &inh_list = item.entry.next_hops;
 
         // Agents should send only one next-hop in the item.
         if (inh_list.next_hop.size() != 1) {
@@ -1217,7 +1221,7 @@ bool BgpXmppChannel::ProcessItem(string vrf_name,
             return false;
         }
 
-        NextHopListType::const_iterator nit = inh_list.begin();
+        InetNextHopList::const_iterator nit = inh_list.begin();
 
         IpAddress nhop_address(Ip4Address(0));
         if (!XmppDecodeAddress(nit->af, nit->address, &nhop_address)) {
@@ -1253,7 +1257,7 @@ bool BgpXmppChannel::ProcessItem(string vrf_name,
         // Process tunnel encapsulation list.
         bool no_tunnel_encap = true;
         bool no_valid_tunnel_encap = true;
-        for (TunnelEncapsulationListType::const_iterator eit =
+        for (InetStringList::const_iterator eit =
             nit->tunnel_encapsulation_list.begin();
             eit != nit->tunnel_encapsulation_list.end(); ++eit) {
             no_tunnel_encap = false;
@@ -1276,7 +1280,7 @@ bool BgpXmppChannel::ProcessItem(string vrf_name,
 
         // Process tag list.
         uint16_t tag_index = 0;
-        for (TagListType::const_iterator tit = nit->tag_list.begin();
+        for (InetIntList::const_iterator tit = nit->tag_list.begin();
             tit != nit->tag_list.end(); ++tit) {
             if (bgp_server_->autonomous_system() <= 0xFFFF) {
                 Tag tag(bgp_server_->autonomous_system(), *tit);
@@ -1303,8 +1307,8 @@ bool BgpXmppChannel::ProcessItem(string vrf_name,
             attrs.push_back(&med);
 
         // Process community tags.
-        const CommunityTagListType &ict_list = item.entry.community_tag_list;
-        for (CommunityTagListType::const_iterator cit = ict_list.begin();
+        const InetStringList &ict_list = item.entry.community_tag_list;
+        for (InetStringList::const_iterator cit = ict_list.begin();
             cit != ict_list.end(); ++cit) {
             error_code error;
             uint32_t rt_community =
@@ -1335,8 +1339,8 @@ bool BgpXmppChannel::ProcessItem(string vrf_name,
 
         // Process security group list.
         uint16_t sg_index = 0;
-        const SecurityGroupListType &isg_list = item.entry.security_group_list;
-        for (SecurityGroupListType::const_iterator sit = isg_list.begin();
+        const InetIntList &isg_list = item.entry.security_group_list;
+        for (InetIntList::const_iterator sit = isg_list.begin();
             sit != isg_list.end(); ++sit) {
             if (bgp_server_->autonomous_system() <= 0xFFFF) {
                 SecurityGroup sg(bgp_server_->autonomous_system(), *sit);
@@ -1411,10 +1415,8 @@ bool BgpXmppChannel::ProcessItem(string vrf_name,
 
 bool BgpXmppChannel::ProcessInet6Item(string vrf_name,
     const pugi::xml_node &node, bool add_change) {
-    ItemType item;
-    item.Clear();
-
-    if (!item.XmlParse(node)) {
+    BgpXmppInetItem item;
+    if (!item.Decode(node)) {
         error_stats().incr_inet6_rx_bad_xml_token_count();
         BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name, BGP_LOG_FLAG_ALL,
             "Invalid inet6 route message received");
@@ -1437,16 +1439,17 @@ bool BgpXmppChannel::ProcessInet6Item(string vrf_name,
         return false;
     }
 
-    error_code error;
-    Inet6Prefix inet6_prefix =
-        Inet6Prefix::FromString(item.entry.nlri.address, &error);
-    if (error) {
+    Ip6Address inet6_addr;
+    int inet6_prefixlen;
+    if (!item.DecodePrefix(&inet6_addr, &inet6_prefixlen)) {
         error_stats().incr_inet6_rx_bad_prefix_count();
         BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name, BGP_LOG_FLAG_ALL,
             "Bad inet6 route " << item.entry.nlri.address);
         return false;
     }
 
+    Inet6Prefix inet6_prefix(inet6_addr, inet6_prefixlen);
+
     if (add_change && item.entry.next_hops.next_hop.empty()) {
         BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name, BGP_LOG_FLAG_ALL,
             "Missing next-hops for inet6 route " << inet6_prefix.ToString());
@@ -1491,7 +1494,7 @@ bool BgpXmppChannel::ProcessInet6Item(string vrf_name,
             req.oper = DBRequest::DB_ENTRY_ADD_CHANGE;
             BgpAttrSpec attrs;
 
-            const NextHopListType &inh_list = item.entry.next_hops;
+            const InetNextHopList &inh_list = item.entry.next_hops;
 
             // Agents should send only one next-hop in the item.
             if (inh_list.next_hop.size() != 1) {
@@ -1502,7 +1505,7 @@ bool BgpXmppChannel::ProcessInet6Item(string vrf_name,
                 return false;
             }
 
-            NextHopListType::const_iterator nit = inh_list.begin();
+            InetNextHopList::const_iterator nit = inh_list.begin();
 
             IpAddress nhop_address(Ip4Address(0));
             if (!XmppDecodeAddress(nit->af, nit->address, &nhop_address)) {
@@ -1524,9 +1527,10 @@ bool BgpXmppChannel::ProcessInet6Item(string vrf_name,
                 }
                 if (!nit->vni)
                     continue;
-                if (nit->mac.empty())
+                if (!*nit->mac)
                     continue;
 
+                error_code error;
                 MacAddress mac_addr =
                     MacAddress::FromString(nit->mac, &error);
                 if (error) {
@@ -1559,7 +1563,7 @@ bool BgpXmppChannel::ProcessInet6Item(string vrf_name,
             // Process tunnel encapsulation list.
             bool no_tunnel_encap = true;
             bool no_valid_tunnel_encap = true;
-            for (TunnelEncapsulationListType::const_iterator eit =
+            for (InetStringList::const_iterator eit =
                 nit->tunnel_encapsulation_list.begin();
                 eit != nit->tunnel_encapsulation_list.end(); ++eit) {
                 no_tunnel_encap = false;
@@ -1586,7 +1590,7 @@ bool BgpXmppChannel::ProcessInet6Item(string vrf_name,
 
             // Process tag list.
             uint16_t tag_index = 0;
-            for (TagListType::const_iterator tit = nit->tag_list.begin();
+            for (InetIntList::const_iterator tit = nit->tag_list.begin();
                 tit != nit->tag_list.end(); ++tit) {
                 if (bgp_server_->autonomous_system() <= 0xFFFF) {
                     Tag tag(bgp_server_->autonomous_system(), *tit);
@@ -1614,9 +1618,9 @@ bool BgpXmppChannel::ProcessInet6Item(string vrf_name,
                 attrs.push_back(&med);
 
             // Process community tags.
-            const CommunityTagListType &ict_list =
+            const InetStringList &ict_list =
                 item.entry.community_tag_list;
-            for (CommunityTagListType::const_iterator cit = ict_list.begin();
+            for (InetStringList::const_iterator cit = ict_list.begin();
                 cit != ict_list.end(); ++cit) {
                 error_code error;
                 uint32_t rt_community =
@@ -1645,10 +1649,10 @@ bool BgpXmppChannel::ProcessInet6Item(string vrf_name,
             }
 
             // Process security group list.
-            const SecurityGroupListType &isg_list =
+            const InetIntList &isg_list =
                 item.entry.security_group_list;
             uint16_t sg_index = 0;
-            for (SecurityGroupListType::const_iterator sit = isg_list.begin();
+            for (InetIntList::const_iterator sit = isg_list.begin();
                 sit != isg_list.end(); ++sit) {
                 if (bgp_server_->autonomous_system() <= 0xFFFF) {
                     SecurityGroup sg(bgp_server_->autonomous_system(), *sit);
@@ -327,6 +327,8 @@ private:
     void DequeueRequest(const std::string &table_name, DBRequest *request);
     bool XmppDecodeAddress(int af, const std::string &address,
                            IpAddress *addrp, bool zero_ok = false);
+    bool XmppDecodeAddress(int af, const char *address,
+                           IpAddress *addrp, bool zero_ok = false);
     bool ResumeClose();
     void FlushDeferQ(std::string vrf_name);
     void FlushDeferQ(std::string vrf_name, std::string table_name);
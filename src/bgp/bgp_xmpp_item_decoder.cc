@@ -0,0 +1,284 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include "bgp/bgp_xmpp_item_decoder.h"
+
+#include <arpa/inet.h>
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "xml/xml_pugi.h"
+
+using pugi::xml_attribute;
+using pugi::xml_node;
+
+//
+// Numeric parsing follows the generated code: leading whitespace and an
+// empty value are accepted, trailing characters other than whitespace are
+// not.
+//
+static bool IsTrailingSpace(const char *endp) {
+    while (isspace(*endp))
+        endp++;
+    return *endp == '\0';
+}
+
+static bool ParseUnsigned(const char *str, uint32_t *valuep) {
+    char *endp;
+    errno = 0;
+    unsigned long value = strtoul(str, &endp, 10);
+    if (errno || value > UINT_MAX || !IsTrailingSpace(endp))
+        return false;
+    *valuep = value;
+    return true;
+}
+
+static bool ParseInteger(const char *str, int *valuep) {
+    char *endp;
+    errno = 0;
+    long value = strtol(str, &endp, 10);
+    if (errno || value > INT_MAX || value < INT_MIN || !IsTrailingSpace(endp))
+        return false;
+    *valuep = value;
+    return true;
+}
+
+static bool ParseBoolean(const char *str) {
+    return strcmp(str, "true") == 0 || strcmp(str, "1") == 0;
+}
+
+static inline bool NodeIs(const xml_node &node, const char *name) {
+    return strcmp(node.name(), name) == 0;
+}
+
+//
+// Split address/prefixlen and convert the address part with inet_pton. The
+// address is copied to a small buffer on the stack to terminate it.
+//
+static bool ParsePrefix(const char *str, int family, int max_prefixlen,
+                        void *addr, int *prefixlen) {
+    const char *slash = strchr(str, '/');
+    if (!slash)
+        return false;
+
+    char buf[INET6_ADDRSTRLEN];
+    size_t len = slash - str;
+    if (len == 0 || len >= sizeof(buf))
+        return false;
+    memcpy(buf, str, len);
+    buf[len] = '\0';
+
+    const char *plen = slash + 1;
+    if (*plen == '\0')
+        return false;
+    int value = 0;
+    for (; *plen != '\0'; ++plen) {
+        if (!isdigit(*plen))
+            return false;
+        value = value * 10 + (*plen - '0');
+        if (value > max_prefixlen)
+            return false;
+    }
+
+    if (inet_pton(family, buf, addr) != 1)
+        return false;
+    *prefixlen = value;
+    return true;
+}
+
+BgpXmppInetItem::NextHop::NextHop()
+    : af(0), address(""), mac(""), label(0), vni(0) {
+}
+
+BgpXmppInetItem::BgpXmppInetItem() {
+    Clear();
+}
+
+void BgpXmppInetItem::Clear() {
+    entry.nlri.af = 0;
+    entry.nlri.safi = 0;
+    entry.nlri.address = "";
+    entry.next_hops.next_hop.clear();
+    entry.version = 0;
+    entry.virtual_network = "";
+    entry.sequence_number = 0;
+    entry.security_group_list.clear();
+    entry.community_tag_list.clear();
+    entry.local_preference = 0;
+    entry.med = 0;
+    entry.mobility.seqno = 0;
+    entry.mobility.sticky = false;
+    entry.load_balance.Clear();
+    entry.sub_protocol = "";
+}
+
+bool BgpXmppInetItem::Decode(const xml_node &node) {
+    for (xml_node child = node.first_child(); child;
+         child = child.next_sibling()) {
+        if (NodeIs(child, "entry") && !DecodeEntry(child))
+            return false;
+    }
+    return true;
+}
+
+bool BgpXmppInetItem::DecodeNlri(const xml_node &node) {
+    for (xml_node child = node.first_child(); child;
+         child = child.next_sibling()) {
+        if (NodeIs(child, "af")) {
+            if (!ParseInteger(child.child_value(), &entry.nlri.af))
+                return false;
+        } else if (NodeIs(child, "safi")) {
+            if (!ParseInteger(child.child_value(), &entry.nlri.safi))
+                return false;
+        } else if (NodeIs(child, "address")) {
+            entry.nlri.address = child.child_value();
+        }
+    }
+    return true;
+}
+
+bool BgpXmppInetItem::DecodeNextHop(const xml_node &node, NextHop *nexthop) {
+    for (xml_node child = node.first_child(); child;
+         child = child.next_sibling()) {
+        if (NodeIs(child, "af")) {
+            if (!ParseInteger(child.child_value(), &nexthop->af))
+                return false;
+        } else if (NodeIs(child, "address")) {
+            nexthop->address = child.child_value();
+        } else if (NodeIs(child, "mac")) {
+            nexthop->mac = child.child_value();
+        } else if (NodeIs(child, "label")) {
+            if (!ParseUnsigned(child.child_value(), &nexthop->label))
+                return false;
+        } else if (NodeIs(child, "vni")) {
+            if (!ParseUnsigned(child.child_value(), &nexthop->vni))
+                return false;
+        } else if (NodeIs(child, "tunnel-encapsulation-list")) {
+            for (xml_node encap = child.first_child(); encap;
+                 encap = encap.next_sibling()) {
+                if (!NodeIs(encap, "tunnel-encapsulation"))
+                    continue;
+                nexthop->tunnel_encapsulation_list.push_back(
+                    encap.child_value());
+            }
+        } else if (NodeIs(child, "tag-list")) {
+            for (xml_node tag = child.first_child(); tag;
+                 tag = tag.next_sibling()) {
+                if (!NodeIs(tag, "tag"))
+                    continue;
+                int value;
+                if (!ParseInteger(tag.child_value(), &value))
+                    return false;
+                nexthop->tag_list.push_back(value);
+            }
+        }
+    }
+    return true;
+}
+
+// Accept mobility fields either as attributes or as child elements.
+bool BgpXmppInetItem::DecodeMobility(const xml_node &node) {
+    const char *seqno = NULL;
+    const char *sticky = NULL;
+    if (xml_attribute attr = node.attribute("seqno"))
+        seqno = attr.value();
+    if (xml_attribute attr = node.attribute("sticky"))
+        sticky = attr.value();
+    if (!seqno && node.child("seqno"))
+        seqno = node.child_value("seqno");
+    if (!sticky && node.child("sticky"))
+        sticky = node.child_value("sticky");
+
+    if (seqno && !ParseUnsigned(seqno, &entry.mobility.seqno))
+        return false;
+    if (sticky)
+        entry.mobility.sticky = ParseBoolean(sticky);
+    return true;
+}
+
+bool BgpXmppInetItem::DecodeEntry(const xml_node &node) {
+    for (xml_node child = node.first_child(); child;
+         child = child.next_sibling()) {
+        if (NodeIs(child, "nlri")) {
+            if (!DecodeNlri(child))
+                return false;
+        } else if (NodeIs(child, "next-hops")) {
+            for (xml_node nh = child.first_child(); nh;
+                 nh = nh.next_sibling()) {
+                if (!NodeIs(nh, "next-hop"))
+                    continue;
+                entry.next_hops.next_hop.push_back(NextHop());
+                if (!DecodeNextHop(nh, &entry.next_hops.next_hop.back()))
+                    return false;
+            }
+        } else if (NodeIs(child, "version")) {
+            if (!ParseInteger(child.child_value(), &entry.version))
+                return false;
+        } else if (NodeIs(child, "virtual-network")) {
+            entry.virtual_network = child.child_value();
+        } else if (NodeIs(child, "sequence-number")) {
+            if (!ParseUnsigned(child.child_value(), &entry.sequence_number))
+                return false;
+        } else if (NodeIs(child, "security-group-list")) {
+            for (xml_node sg = child.first_child(); sg;
+                 sg = sg.next_sibling()) {
+                if (!NodeIs(sg, "security-group"))
+                    continue;
+                int value;
+                if (!ParseInteger(sg.child_value(), &value))
+                    return false;
+                entry.security_group_list.push_back(value);
+            }
+        } else if (NodeIs(child, "community-tag-list")) {
+            for (xml_node tag = child.first_child(); tag;
+                 tag = tag.next_sibling()) {
+                if (!NodeIs(tag, "community-tag"))
+                    continue;
+                entry.community_tag_list.push_back(tag.child_value());
+            }
+        } else if (NodeIs(child, "local-preference")) {
+            if (!ParseUnsigned(child.child_value(), &entry.local_preference))
+                return false;
+        } else if (NodeIs(child, "med")) {
+            if (!ParseUnsigned(child.child_value(), &entry.med))
+                return false;
+        } else if (NodeIs(child, "mobility")) {
+            if (!DecodeMobility(child))
+                return false;
+        } else if (NodeIs(child, "load-balance")) {
+            // Rarely present, leave it to the generated parser.
+            if (!entry.load_balance.XmlParse(child))
+                return false;
+        } else if (NodeIs(child, "sub-protocol")) {
+            entry.sub_protocol = child.child_value();
+        }
+    }
+    return true;
+}
+
+bool BgpXmppInetItem::DecodePrefix(Ip4Address *addr, int *prefixlen) const {
+    struct in_addr in;
+    if (!ParsePrefix(entry.nlri.address, AF_INET,
+                     Address::kMaxV4PrefixLen, &in, prefixlen)) {
+        return false;
+    }
+    // Clear the host bits, as Ip4Prefix::FromString does.
+    *addr = Address::GetIp4SubnetAddress(Ip4Address(ntohl(in.s_addr)),
+                                         *prefixlen);
+    return true;
+}
+
+bool BgpXmppInetItem::DecodePrefix(Ip6Address *addr, int *prefixlen) const {
+    Ip6Address::bytes_type bytes;
+    if (!ParsePrefix(entry.nlri.address, AF_INET6,
+                     Address::kMaxV6PrefixLen, bytes.data(), prefixlen)) {
+        return false;
+    }
+    // Clear the host bits, as Inet6Prefix::FromString does.
+    *addr = Address::GetIp6SubnetAddress(Ip6Address(bytes), *prefixlen);
+    return true;
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#ifndef SRC_BGP_BGP_XMPP_ITEM_DECODER_H_
+#define SRC_BGP_BGP_XMPP_ITEM_DECODER_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "base/util.h"
+#include "net/address.h"
+#include "schema/xmpp_unicast_types.h"
+
+namespace pugi {
+class xml_node;
+}
+
+//
+// Decoder for inet and inet6 route items received from agents.
+//
+// The generated autogen::ItemType parser copies every element of the item
+// into a std::string and converts numeric fields from those copies, after
+// which BgpXmppChannel parses the prefix string one more time. This decoder
+// walks the item node once and stores numeric fields directly. String fields
+// are kept as pointers into the XML document, so the decoded item is valid
+// only as long as the document that holds the node.
+//
+// The member layout mirrors autogen::ItemType so that the processing code
+// in BgpXmppChannel reads the same for both. Elements that are not used by
+// the control-node are validated where the generated parser validates them
+// and otherwise skipped.
+//
+class BgpXmppInetItem {
+public:
+    typedef std::vector<const char *> StringList;
+    typedef std::vector<int> IntList;
+
+    struct Nlri {
+        int af;
+        int safi;
+        const char *address;
+    };
+
+    struct NextHop {
+        NextHop();
+
+        int af;
+        const char *address;
+        const char *mac;
+        uint32_t label;
+        uint32_t vni;
+        StringList tunnel_encapsulation_list;
+        IntList tag_list;
+    };
+
+    struct NextHopList {
+        typedef std::vector<NextHop>::const_iterator const_iterator;
+
+        const_iterator begin() const { return next_hop.begin(); }
+        const_iterator end() const { return next_hop.end(); }
+
+        std::vector<NextHop> next_hop;
+    };
+
+    struct Mobility {
+        uint32_t seqno;
+        bool sticky;
+    };
+
+    struct Entry {
+        Nlri nlri;
+        NextHopList next_hops;
+        int version;
+        const char *virtual_network;
+        uint32_t sequence_number;
+        IntList security_group_list;
+        StringList community_tag_list;
+        uint32_t local_preference;
+        uint32_t med;
+        Mobility mobility;
+        autogen::LoadBalanceType load_balance;
+        const char *sub_protocol;
+    };
+
+    BgpXmppInetItem();
+
+    void Clear();
+
+    // Decode the item node. Returns false if a field is missing its value
+    // or does not have the expected type.
+    bool Decode(const pugi::xml_node &node);
+
+    // Parse the nlri address in the form address/prefixlen. The prefix is
+    // taken from the document without an intermediate string copy, and the
+    // host bits of the address are cleared.
+    bool DecodePrefix(Ip4Address *addr, int *prefixlen) const;
+    bool DecodePrefix(Ip6Address *addr, int *prefixlen) const;
+
+    Entry entry;
+
+private:
+    bool DecodeEntry(const pugi::xml_node &node);
+    bool DecodeNlri(const pugi::xml_node &node);
+    bool DecodeNextHop(const pugi::xml_node &node, NextHop *nexthop);
+    bool DecodeMobility(const pugi::xml_node &node);
+
+    DISALLOW_COPY_AND_ASSIGN(BgpXmppInetItem);
+};
+
+#endif  // SRC_BGP_BGP_XMPP_ITEM_DECODER_H_
@@ -94,14 +94,14 @@ BgpRoute *InetTable::RouteReplicate(BgpServer *server,
         dest_route->ClearDelete();
     }
 
-    BgpAttrDB *attr_db = server->attr_db();
-    BgpAttrPtr new_attr = attr_db->ReplaceExtCommunityAndLocate(path->GetAttr(),
-                                                                community);
+    BgpAttrBuilder builder(server->attr_db(), path->GetAttr());
+    builder.set_ext_community(community);
 
     // Set the RD attr if route is replicated from vpn table
     if (!inet) {
-        new_attr = attr_db->ReplaceSourceRdAndLocate(new_attr.get(), rd);
+        builder.set_source_rd(rd);
     }
+    BgpAttrPtr new_attr = builder.Locate();
 
     // Check whether there's already a path with the given peer and path id.
     BgpPath *dest_path = dest_route->FindSecondaryPath(src_rt,
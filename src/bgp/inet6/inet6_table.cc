@@ -88,13 +88,13 @@ BgpRoute *Inet6Table::RouteReplicate(BgpServer *server, BgpTable *src_table,
     }
 
     // Replace the extended community with the one provided.
-    BgpAttrDB *attr_db = server->attr_db();
-    BgpAttrPtr new_attr = attr_db->ReplaceExtCommunityAndLocate(path->GetAttr(),
-                                                                community);
+    BgpAttrBuilder builder(server->attr_db(), path->GetAttr());
+    builder.set_ext_community(community);
 
     if (!source) {
-        new_attr = attr_db->ReplaceSourceRdAndLocate(new_attr.get(), rd);
+        builder.set_source_rd(rd);
     }
+    BgpAttrPtr new_attr = builder.Locate();
 
     // Check whether there's already a path with the given peer and path id.
     BgpPath *dest_path =
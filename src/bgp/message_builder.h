@@ -14,12 +14,15 @@ class BgpRoute;
 class BgpTable;
 class BgpXmppMessageBuilder;
 class IPeerUpdate;
+class MessageCache;
 class RibOutAttr;
 class RibOut;
 
 class Message {
 public:
-    Message() : num_reach_route_(0), num_unreach_route_(0) { }
+    Message()
+        : num_reach_route_(0), num_unreach_route_(0),
+          cache_(NULL), num_cache_hit_(0), num_cache_miss_(0) { }
     virtual ~Message() { }
     virtual bool Start(const RibOut *ribout, bool cache_routes,
         const RibOutAttr *roattr, const BgpRoute *route) = 0;
@@ -30,13 +33,23 @@ public:
     uint64_t num_reach_routes() const { return num_reach_route_; }
     uint64_t num_unreach_routes() const { return num_unreach_route_; }
 
+    // Cache of encoded routes shared with other RibOuts, if any.
+    void set_cache(MessageCache *cache) { cache_ = cache; }
+    uint64_t num_cache_hits() const { return num_cache_hit_; }
+    uint64_t num_cache_misses() const { return num_cache_miss_; }
+
 protected:
     uint64_t num_reach_route_;
     uint64_t num_unreach_route_;
+    MessageCache *cache_;
+    uint64_t num_cache_hit_;
+    uint64_t num_cache_miss_;
 
     virtual void Reset() {
         num_reach_route_ =  0;
         num_unreach_route_ = 0;
+        num_cache_hit_ = 0;
+        num_cache_miss_ = 0;
     }
 
 private:
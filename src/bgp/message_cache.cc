@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include "bgp/message_cache.h"
+
+#include <boost/functional/hash.hpp>
+
+using std::string;
+
+MessageCache::MessageCache()
+    : enabled_(false), hit_count_(0), miss_count_(0) {
+}
+
+MessageCache::~MessageCache() {
+}
+
+//
+// The RibOutAttr fields that differ most between routes are the BgpAttr
+// and the labels. The nexthops are compared by Key::operator==.
+//
+size_t MessageCache::KeyHash::Hash(const BgpRoute *route,
+    const RibOutAttr *roattr, RibExportPolicy::Encoding encoding) {
+    size_t hash = 0;
+    boost::hash_combine(hash, route);
+    boost::hash_combine(hash, roattr->attr());
+    boost::hash_combine(hash, roattr->label());
+    boost::hash_combine(hash, roattr->l3_label());
+    boost::hash_combine(hash, roattr->nexthop_list().size());
+    boost::hash_combine(hash, static_cast<int>(encoding));
+    return hash;
+}
+
+void MessageCache::Clear() {
+    enabled_ = false;
+    cache_.clear();
+}
+
+const string *MessageCache::Find(const BgpRoute *route,
+    const RibOutAttr *roattr, RibExportPolicy::Encoding encoding) {
+    if (!enabled_)
+        return NULL;
+    CacheMap::const_iterator it = cache_.find(
+        LookupKey(route, roattr, encoding), KeyHash(), KeyEqual());
+    if (it == cache_.end()) {
+        miss_count_++;
+        return NULL;
+    }
+    hit_count_++;
+    return &it->second;
+}
+
+void MessageCache::Add(const BgpRoute *route, const RibOutAttr *roattr,
+    RibExportPolicy::Encoding encoding, const string &repr, size_t pos) {
+    if (!enabled_ || cache_.size() >= kMaxEntries)
+        return;
+    string &value = cache_[Key(route, *roattr, encoding)];
+    value.assign(repr, pos, string::npos);
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#ifndef SRC_BGP_MESSAGE_CACHE_H_
+#define SRC_BGP_MESSAGE_CACHE_H_
+
+#include <boost/unordered_map.hpp>
+
+#include <string>
+
+#include "bgp/bgp_rib_policy.h"
+#include "bgp/bgp_ribout.h"
+
+class BgpRoute;
+
+//
+// This class caches the encoded representation of a route for a given
+// RibOutAttr and encoding. It's shared by all RibOuts in a partition of
+// the BgpUpdateSender, so that a route advertised with the same RibOutAttr
+// to peers in different RibOuts (e.g. xmpp agents with different export
+// policies in the same VRF) is encoded only once.
+//
+// Entries are keyed by content i.e. the RibOutAttr is compared rather than
+// the pointer to the RibOutAttr in the UpdateInfo of a RibOut. The key has
+// a reference to the BgpAttr, but the BgpRoute is stored as a raw pointer.
+// Hence the cache is enabled only for the duration of a run of the sender
+// partition, during which the routes in the partition can't be modified
+// or deleted, and cleared at the end of the run.
+//
+// The number of entries is bounded, encodings are not cached when the cache
+// is full.
+//
+class MessageCache {
+public:
+    static const size_t kMaxEntries = 16 * 1024;
+
+    MessageCache();
+    ~MessageCache();
+
+    // Enable lookups and additions till the next Clear.
+    void Enable() { enabled_ = true; }
+    bool enabled() const { return enabled_; }
+
+    // Remove all entries and disable the cache.
+    void Clear();
+
+    // Return the cached encoding, or NULL if none.
+    const std::string *Find(const BgpRoute *route, const RibOutAttr *roattr,
+        RibExportPolicy::Encoding encoding);
+
+    // Add the substring of repr starting at pos as the encoding.
+    void Add(const BgpRoute *route, const RibOutAttr *roattr,
+        RibExportPolicy::Encoding encoding, const std::string &repr,
+        size_t pos = 0);
+
+    size_t size() const { return cache_.size(); }
+    uint64_t hit_count() const { return hit_count_; }
+    uint64_t miss_count() const { return miss_count_; }
+
+private:
+    struct Key {
+        Key(const BgpRoute *route, const RibOutAttr &roattr,
+            RibExportPolicy::Encoding encoding)
+            : route(route), roattr(roattr), encoding(encoding) {
+        }
+        bool operator==(const Key &rhs) const {
+            return route == rhs.route && encoding == rhs.encoding &&
+                roattr == rhs.roattr;
+        }
+
+        const BgpRoute *route;
+        RibOutAttr roattr;
+        RibExportPolicy::Encoding encoding;
+    };
+
+    // Used to look up without copying the RibOutAttr.
+    struct LookupKey {
+        LookupKey(const BgpRoute *route, const RibOutAttr *roattr,
+            RibExportPolicy::Encoding encoding)
+            : route(route), roattr(roattr), encoding(encoding) {
+        }
+
+        const BgpRoute *route;
+        const RibOutAttr *roattr;
+        RibExportPolicy::Encoding encoding;
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key &key) const {
+            return Hash(key.route, &key.roattr, key.encoding);
+        }
+        size_t operator()(const LookupKey &key) const {
+            return Hash(key.route, key.roattr, key.encoding);
+        }
+        static size_t Hash(const BgpRoute *route, const RibOutAttr *roattr,
+            RibExportPolicy::Encoding encoding);
+    };
+
+    struct KeyEqual {
+        bool operator()(const LookupKey &lhs, const Key &rhs) const {
+            return lhs.route == rhs.route && lhs.encoding == rhs.encoding &&
+                *lhs.roattr == rhs.roattr;
+        }
+        bool operator()(const Key &lhs, const LookupKey &rhs) const {
+            return operator()(rhs, lhs);
+        }
+    };
+
+    typedef boost::unordered_map<Key, std::string, KeyHash> CacheMap;
+
+    bool enabled_;
+    CacheMap cache_;
+    uint64_t hit_count_;
+    uint64_t miss_count_;
+
+    DISALLOW_COPY_AND_ASSIGN(MessageCache);
+};
+
+#endif  // SRC_BGP_MESSAGE_CACHE_H_
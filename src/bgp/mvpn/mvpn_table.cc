@@ -529,13 +529,10 @@ BgpRoute *MvpnTable::ReplicatePath(BgpServer *server, const MvpnPrefix &mprefix,
         dest_route->ClearDelete();
     }
 
-    BgpAttrPtr new_attr =
-        server->attr_db()->ReplaceExtCommunityAndLocate(src_path->GetAttr(),
-                                                        comm.get());
-    // Replace Nexthop with controller address, MX rejects the route if
-    // nexthop is same as neighbor address, needed for Type-7 routes
-    new_attr = server->attr_db()->ReplaceNexthopAndLocate(new_attr.get(),
-                                  Ip4Address(server->bgp_identifier()));
+    BgpAttrBuilder builder(server->attr_db(), src_path->GetAttr());
+    ExtCommunityPtr ext_community = comm;
+    bool replace_nexthop = true;
+
     // Need to strip off route targets other than sender-ip:0
     if (src_rt->GetPrefix().type() == MvpnPrefix::LeafADRoute) {
         ExtCommunity::ExtCommunityList rtarget;
@@ -552,16 +549,23 @@ BgpRoute *MvpnTable::ReplicatePath(BgpServer *server, const MvpnPrefix &mprefix,
         }
 
         if (rtarget.size() == 1) {
-            ExtCommunityPtr ext_community = server->extcomm_db()->
-                ReplaceRTargetAndLocate(new_attr->ext_community(), rtarget);
-            new_attr = server->attr_db()->ReplaceExtCommunityAndLocate(
-                src_path->GetAttr(), ext_community.get());
+            ext_community = server->extcomm_db()->
+                ReplaceRTargetAndLocate(comm.get(), rtarget);
+            // Leaf AD route keeps the nexthop of the source path.
+            replace_nexthop = false;
         } else {
             MVPN_RT_LOG(src_rt,
                         "Could not find <originator>:0 route-target community");
         }
     }
 
+    builder.set_ext_community(ext_community);
+    // Replace Nexthop with controller address, MX rejects the route if
+    // nexthop is same as neighbor address, needed for Type-7 routes
+    if (replace_nexthop)
+        builder.set_nexthop(Ip4Address(server->bgp_identifier()));
+    BgpAttrPtr new_attr = builder.Locate();
+
     // Check whether peer already has a path.
     BgpPath *dest_path = dest_route->FindSecondaryPath(src_rt,
             src_path->GetSource(), src_path->GetPeer(),
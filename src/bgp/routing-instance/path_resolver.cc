@@ -1048,16 +1048,17 @@ bool ResolverPath::UpdateResolvedPaths() {
             continue;
 
         // Use source rd from the nexthop path.
-        attr = attr_db->ReplaceSourceRdAndLocate(attr.get(), source_rd);
+        BgpAttrBuilder builder(attr_db, attr.get());
+        builder.set_source_rd(source_rd);
 
         // Use nexthop address from the nexthop path.
-        attr = attr_db->ReplaceNexthopAndLocate(attr.get(),
-            nh_path->GetAttr()->nexthop());
+        builder.set_nexthop(nh_path->GetAttr()->nexthop());
 
         // Update extended community based on the nexthop path and use it.
-        ExtCommunityPtr ext_community =
-            UpdateExtendedCommunity(extcomm_db, attr.get(), nh_path->GetAttr());
-        attr = attr_db->ReplaceExtCommunityAndLocate(attr.get(), ext_community);
+        ExtCommunityPtr ext_community = UpdateExtendedCommunity(extcomm_db,
+            builder.get(), nh_path->GetAttr());
+        builder.set_ext_community(ext_community);
+        attr = builder.Locate();
 
         // Locate the resolved path.
         uint32_t path_id = nh_path->GetAttr()->nexthop().to_v4().to_ulong();
@@ -171,6 +171,7 @@ RoutePathReplicator::RoutePathReplicator(BgpServer *server,
       family_(family),
       vpn_table_(NULL),
       trace_buf_(SandeshTraceBufferCreate("RoutePathReplicator", 500)) {
+    replicated_path_count_ = 0;
 }
 
 RoutePathReplicator::~RoutePathReplicator() {
@@ -592,6 +593,7 @@ bool RoutePathReplicator::RouteListener(TableState *ts,
                 server_, table, rt, path, new_extcomm_ptr);
             if (!replicated_rt)
                 continue;
+            replicated_path_count_++;
 
             // Add information about the secondary path to the replicated path
             // list.
@@ -7,6 +7,7 @@
 
 #include <boost/ptr_container/ptr_map.hpp>
 #include <sandesh/sandesh_trace.h>
+#include <tbb/atomic.h>
 #include <tbb/mutex.h>
 
 #include <list>
@@ -248,6 +249,9 @@ public:
     const RtReplicated *GetReplicationState(BgpTable *table,
                                             BgpRoute *rt) const;
 
+    // Number of times a path was replicated to a secondary table.
+    uint64_t replicated_path_count() const { return replicated_path_count_; }
+
 private:
     friend class ReplicationTest;
     friend class RtReplicated;
@@ -288,6 +292,7 @@ private:
     Address::Family family_;
     BgpTable *vpn_table_;
     SandeshTraceBufferPtr trace_buf_;
+    tbb::atomic<uint64_t> replicated_path_count_;
 
     DISALLOW_COPY_AND_ASSIGN(RoutePathReplicator);
 };
@@ -1793,6 +1793,23 @@ bool RoutingInstance::HasExportTarget(const ExtCommunity *extcomm) const {
     return false;
 }
 
+//
+// Apply the default tunnel encapsulation configured on the peer of the path.
+// The attribute is copied only if the peer has a default for the family.
+//
+static void ProcessPathTunnelEncapsulation(const BgpRoute *route,
+    const BgpPath *path, BgpAttrBuilder *builder) {
+    IPeer *peer = path->GetPeer();
+    if (!peer)
+        return;
+    const BgpTable *table = route->table();
+    if (peer->GetDefaultTunnelEncap(table->family()).empty())
+        return;
+    BgpServer *server = builder->attr_db()->server();
+    peer->ProcessPathTunnelEncapsulation(path, builder->attr(),
+        server->extcomm_db(), table);
+}
+
 //
 // On given route/path apply the routing policy
 //    Called from
@@ -1806,8 +1823,9 @@ bool RoutingInstance::ProcessRoutingPolicy(const BgpRoute *route,
     if (path->IsReplicated())
         return true;
     const RoutingPolicyMgr *policy_mgr = server()->routing_policy_mgr();
-    // Take snapshot of original attribute
-    BgpAttr *out_attr = new BgpAttr(*(path->GetOriginalAttr()));
+    // Updates are made to a copy of the original attribute, which is taken
+    // only if a policy action or the tunnel encapsulation changes it.
+    BgpAttrBuilder builder(server_->attr_db(), path->GetOriginalAttr());
     BOOST_FOREACH(RoutingPolicyInfo info, routing_policies()) {
         RoutingPolicyPtr policy = info.first;
         // Process the routing policy on original attribute and prefix
@@ -1815,7 +1833,7 @@ bool RoutingInstance::ProcessRoutingPolicy(const BgpRoute *route,
         // on the snapshot of original attribute passed to this function
         RoutingPolicy::PolicyResult result =
             policy_mgr->ExecuteRoutingPolicy(policy.get(), route,
-                                             path, out_attr);
+                                             path, &builder);
         if (result.first) {
             // Hit a terminal policy
             if (!result.second) {
@@ -1826,15 +1844,11 @@ bool RoutingInstance::ProcessRoutingPolicy(const BgpRoute *route,
                 // Clear the reject flag is marked before
                 path->ResetPolicyReject();
             }
-            IPeer *peer = path->GetPeer();
             // Process default tunnel encapsulation that may be configured per
             // address family on the peer. 'peer' is not expected to be NULL
             // except in unit tests.
-            if (peer) {
-                peer->ProcessPathTunnelEncapsulation(path, out_attr,
-                    server_->extcomm_db(), route->table());
-            }
-            BgpAttrPtr modified_attr = server_->attr_db()->Locate(out_attr);
+            ProcessPathTunnelEncapsulation(route, path, &builder);
+            BgpAttrPtr modified_attr = builder.Locate();
             // Update the path with new set of attributes
             path->SetAttr(modified_attr, path->GetOriginalAttr());
             return result.second;
@@ -1842,12 +1856,8 @@ bool RoutingInstance::ProcessRoutingPolicy(const BgpRoute *route,
     }
     // After processing all the routing policy,,
     // We are here means, all the routing policies have accepted the route
-    IPeer *peer = path->GetPeer();
-    if (peer) {
-        peer->ProcessPathTunnelEncapsulation(path, out_attr,
-            server_->extcomm_db(), route->table());
-    }
-    BgpAttrPtr modified_attr = server_->attr_db()->Locate(out_attr);
+    ProcessPathTunnelEncapsulation(route, path, &builder);
+    BgpAttrPtr modified_attr = builder.Locate();
     path->SetAttr(modified_attr, path->GetOriginalAttr());
     // Clear the reject if marked so in past
     if (path->IsPolicyReject()) path->ResetPolicyReject();
@@ -524,16 +524,14 @@ void ServiceChain<T>::UpdateServiceChainRoute(PrefixT prefix,
             new_ext_community.get(), origin_vn.GetExtCommunity());
 
         // Replace extended community, community and origin vn path.
-        BgpAttrPtr new_attr = attr_db->ReplaceExtCommunityAndLocate(
-            attr, new_ext_community);
-        new_attr =
-            attr_db->ReplaceCommunityAndLocate(new_attr.get(), new_community);
-        new_attr = attr_db->ReplaceOriginVnPathAndLocate(new_attr.get(),
-            new_ovnpath);
+        BgpAttrBuilder builder(attr_db, attr);
+        builder.set_ext_community(new_ext_community);
+        builder.set_community(new_community);
+        builder.set_origin_vn_path(new_ovnpath);
 
         // Strip aspath. This is required when the connected route is
         // learnt via BGP.
-        new_attr = attr_db->ReplaceAsPathAndLocate(new_attr.get(), AsPathPtr());
+        builder.set_as_path(AsPathPtr());
 
         // If the connected path is learnt via XMPP, construct RD based on
         // the id registered with source table instead of connected table.
@@ -551,7 +549,7 @@ void ServiceChain<T>::UpdateServiceChainRoute(PrefixT prefix,
                 continue;
 
             RouteDistinguisher rd(connected_rd.GetAddress(), instance_id);
-            new_attr = attr_db->ReplaceSourceRdAndLocate(new_attr.get(), rd);
+            builder.set_source_rd(rd);
         }
 
         // Replace the source rd if the connected path is a secondary path
@@ -563,14 +561,15 @@ void ServiceChain<T>::UpdateServiceChainRoute(PrefixT prefix,
             if (ri->IsMasterRoutingInstance()) {
                 const VpnRouteT *vpn_route =
                     static_cast<const VpnRouteT *>(spath->src_rt());
-                new_attr = attr_db->ReplaceSourceRdAndLocate(new_attr.get(),
+                builder.set_source_rd(
                     vpn_route->GetPrefix().route_distinguisher());
             }
         }
 
         // Skip paths with Source RD same as source RD of the connected path
-        if (!orig_rd.IsZero() && new_attr->source_rd() == orig_rd)
+        if (!orig_rd.IsZero() && builder.get()->source_rd() == orig_rd)
             continue;
+        BgpAttrPtr new_attr = builder.Locate();
 
         // Check whether we already have a path with the associated path id.
         uint32_t path_id =
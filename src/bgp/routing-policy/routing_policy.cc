@@ -6,16 +6,22 @@
 
 #include <boost/assign/list_of.hpp>
 #include <boost/foreach.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/unordered_map.hpp>
 
 #include "base/task_annotations.h"
 #include "base/task_trigger.h"
+#include "bgp/bgp_attr.h"
 #include "bgp/bgp_config.h"
 #include "bgp/bgp_factory.h"
+#include "bgp/bgp_path.h"
 #include "bgp/bgp_server.h"
 #include "bgp/bgp_table.h"
 #include "bgp/routing-instance/routing_instance.h"
 #include "bgp/routing-policy/routing_policy_action.h"
 #include "bgp/routing-policy/routing_policy_match.h"
+#include "db/db.h"
+#include "db/db_table_partition.h"
 
 
 class RoutingPolicyMgr::DeleteActor : public LifetimeActor {
@@ -31,6 +37,7 @@ public:
     }
     virtual void Destroy() {
         // memory is deallocated by BgpServer scoped_ptr.
+        manager_->ClearResultCache();
         manager_->server_delete_ref_.Reset(NULL);
     }
 
@@ -38,14 +45,124 @@ private:
     RoutingPolicyMgr *manager_;
 };
 
+//
+// Memoized results of applying a RoutingPolicy on an interned BgpAttr.
+//
+// Update actions depend only on the attribute, and match conditions depend
+// on the attribute, the prefix of the route or the source of the path. The
+// result of a policy is hence determined by the policy generation, the input
+// attribute, the source of the path and the prefix class of the route i.e.
+// the set of terms whose prefix match conditions accept the route. Paths
+// with the same key get the same resulting attribute and reject decision.
+//
+// The value holds a reference to the input attribute, so that the pointer
+// in the key can't be reused for a different attribute. Entries of older
+// generations are never found and go away when the cache is cleared. The
+// cache is cleared when the policy is updated or deleted, and when it's
+// full.
+//
+// There's one cache per DB partition so that policy evaluation in different
+// partitions doesn't contend on the mutex.
+//
+class RoutingPolicyMgr::ResultCache {
+public:
+    static const size_t kMaxEntries = 16 * 1024;
+
+    struct Key {
+        Key(const RoutingPolicy *policy, const BgpAttr *attr,
+            const BgpPath *path, uint64_t prefix_class)
+            : policy(policy), generation(policy->generation()), attr(attr),
+              prefix_class(prefix_class) {
+            const IPeer *peer = path->GetPeer();
+            bool is_xmpp = peer ? peer->IsXmppPeer() : false;
+            path_class = (path->GetSource() << 1) | (is_xmpp ? 1 : 0);
+        }
+        bool operator==(const Key &rhs) const {
+            return policy == rhs.policy && generation == rhs.generation &&
+                attr == rhs.attr && path_class == rhs.path_class &&
+                prefix_class == rhs.prefix_class;
+        }
+
+        const RoutingPolicy *policy;
+        uint32_t generation;
+        const BgpAttr *attr;
+        uint32_t path_class;
+        uint64_t prefix_class;
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key &key) const {
+            size_t hash = 0;
+            boost::hash_combine(hash, key.policy);
+            boost::hash_combine(hash, key.generation);
+            boost::hash_combine(hash, key.attr);
+            boost::hash_combine(hash, key.path_class);
+            boost::hash_combine(hash, key.prefix_class);
+            return hash;
+        }
+    };
+
+    struct Value {
+        BgpAttrPtr in_attr;
+        BgpAttrPtr out_attr;
+        RoutingPolicy::PolicyResult result;
+    };
+
+    ResultCache() { }
+
+    bool Find(const Key &key, RoutingPolicy::PolicyResult *result,
+              BgpAttrPtr *out_attr) const {
+        tbb::mutex::scoped_lock lock(mutex_);
+        CacheMap::const_iterator it = cache_.find(key);
+        if (it == cache_.end())
+            return false;
+        *result = it->second.result;
+        *out_attr = it->second.out_attr;
+        return true;
+    }
+
+    void Add(const Key &key, RoutingPolicy::PolicyResult result,
+             BgpAttrPtr out_attr) {
+        tbb::mutex::scoped_lock lock(mutex_);
+        if (cache_.size() >= kMaxEntries)
+            cache_.clear();
+        Value &value = cache_[key];
+        value.in_attr = key.attr;
+        value.out_attr = out_attr;
+        value.result = result;
+    }
+
+    void Clear() {
+        tbb::mutex::scoped_lock lock(mutex_);
+        cache_.clear();
+    }
+
+    size_t size() const {
+        tbb::mutex::scoped_lock lock(mutex_);
+        return cache_.size();
+    }
+
+private:
+    typedef boost::unordered_map<Key, Value, KeyHash> CacheMap;
+
+    mutable tbb::mutex mutex_;
+    CacheMap cache_;
+
+    DISALLOW_COPY_AND_ASSIGN(ResultCache);
+};
+
 RoutingPolicyMgr::RoutingPolicyMgr(BgpServer *server) :
         server_(server),
         deleter_(new DeleteActor(this)),
         server_delete_ref_(this, server->deleter()),
         trace_buf_(SandeshTraceBufferCreate("RoutingPolicyMgr", 500)) {
+    for (int idx = 0; idx < DB::PartitionCount(); ++idx) {
+        result_cache_.push_back(new ResultCache);
+    }
 }
 
 RoutingPolicyMgr::~RoutingPolicyMgr() {
+    STLDeleteValues(&result_cache_);
 }
 
 void RoutingPolicyMgr::ManagedDelete() {
@@ -90,7 +207,10 @@ void RoutingPolicyMgr::UpdateRoutingPolicy(
         return;
     }
 
+    uint32_t generation = policy->generation();
     policy->UpdateConfig(config);
+    if (policy->generation() != generation)
+        ClearResultCache();
 }
 
 //
@@ -123,6 +243,7 @@ void RoutingPolicyMgr::DestroyRoutingPolicy(RoutingPolicy *policy) {
     const std::string name = policy->name();
     routing_policies_.erase(name);
     delete policy;
+    ClearResultCache();
 
     if (deleted()) return;
 
@@ -150,11 +271,53 @@ void RoutingPolicyMgr::ApplyRoutingPolicy(RoutingInstance *instance) {
     }
 }
 
+//
 // On a given path of the route, apply the policy
+//
+// The result is memoized if the builder holds an interned attribute i.e. if
+// the attribute was not modified by a previous policy, or the result of the
+// previous policy was memoized. On a miss, the attribute updated by policy
+// is interned so that it can be stored in the cache and used as the input
+// for the next policy.
+//
 RoutingPolicy::PolicyResult RoutingPolicyMgr::ExecuteRoutingPolicy(
                              const RoutingPolicy *policy, const BgpRoute *route,
-                             const BgpPath *path, BgpAttr *attr) const {
-    return (*policy)(route, path, attr);
+                             const BgpPath *path,
+                             BgpAttrBuilder *builder) const {
+    uint64_t prefix_class;
+    if (builder->modified() || !policy->GetPrefixClass(route, &prefix_class))
+        return (*policy)(route, path, builder);
+
+    const DBTablePartBase *tpart = route->get_table_partition();
+    int index = tpart ? tpart->index() : 0;
+    ResultCache *cache = result_cache_[index % result_cache_.size()];
+    ResultCache::Key key(policy, builder->get(), path, prefix_class);
+    RoutingPolicy::PolicyResult result;
+    BgpAttrPtr out_attr;
+    if (cache->Find(key, &result, &out_attr)) {
+        policy->result_cache_hits_++;
+        builder->Reset(out_attr.get());
+        return result;
+    }
+
+    policy->result_cache_misses_++;
+    result = (*policy)(route, path, builder);
+    cache->Add(key, result, builder->Locate());
+    return result;
+}
+
+void RoutingPolicyMgr::ClearResultCache() {
+    BOOST_FOREACH(ResultCache *cache, result_cache_) {
+        cache->Clear();
+    }
+}
+
+size_t RoutingPolicyMgr::result_cache_size() const {
+    size_t size = 0;
+    BOOST_FOREACH(const ResultCache *cache, result_cache_) {
+        size += cache->size();
+    }
+    return size;
 }
 
 //
@@ -308,6 +471,8 @@ RoutingPolicy::RoutingPolicy(std::string name, BgpServer *server,
       deleter_(new DeleteActor(server, this)),
       manager_delete_ref_(this, mgr->deleter()), generation_(0) {
     refcount_ = 0;
+    result_cache_hits_ = 0;
+    result_cache_misses_ = 0;
 }
 
 RoutingPolicy::~RoutingPolicy() {
@@ -540,10 +705,10 @@ void RoutingPolicy::RetryDelete() {
 }
 
 RoutingPolicy::PolicyResult RoutingPolicy::operator()(const BgpRoute *route,
-                                  const BgpPath *path, BgpAttr *attr) const {
+        const BgpPath *path, BgpAttrBuilder *builder) const {
     BOOST_FOREACH(PolicyTermPtr term, terms()) {
         bool terminal = term->terminal();
-        bool matched = term->ApplyTerm(route, path, attr);
+        bool matched = term->ApplyTerm(route, path, builder);
         if (matched && terminal) {
             return std::make_pair(terminal,
                                   (*term->actions().begin())->accept());
@@ -552,6 +717,21 @@ RoutingPolicy::PolicyResult RoutingPolicy::operator()(const BgpRoute *route,
     return std::make_pair(false, true);
 }
 
+bool RoutingPolicy::GetPrefixClass(const BgpRoute *route,
+                                   uint64_t *prefix_class) const {
+    if (terms().size() > 64)
+        return false;
+    uint64_t bitmap = 0;
+    uint64_t bit = 1;
+    BOOST_FOREACH(const PolicyTermPtr &term, terms()) {
+        if (term->MatchRoute(route))
+            bitmap |= bit;
+        bit <<= 1;
+    }
+    *prefix_class = bitmap;
+    return true;
+}
+
 PolicyTerm::PolicyTerm() {
 }
 
@@ -567,10 +747,10 @@ bool PolicyTerm::terminal() const {
 }
 
 bool PolicyTerm::ApplyTerm(const BgpRoute *route, const BgpPath *path,
-                           BgpAttr *attr) const {
+                           BgpAttrBuilder *builder) const {
     bool matched = true;
     BOOST_FOREACH(RoutingPolicyMatch *match, matches()) {
-        if (!(*match)(route, path, attr)) {
+        if (!(*match)(route, path, builder->get())) {
             matched = false;
             break;
         }
@@ -591,13 +771,21 @@ bool PolicyTerm::ApplyTerm(const BgpRoute *route, const BgpPath *path,
             } else {
                 RoutingPolicyUpdateAction *update =
                     static_cast<RoutingPolicyUpdateAction *>(action);
-                (*update)(attr);
+                (*update)(builder);
             }
         }
     }
     return matched;
 }
 
+bool PolicyTerm::MatchRoute(const BgpRoute *route) const {
+    BOOST_FOREACH(RoutingPolicyMatch *match, matches()) {
+        if (match->IsRouteMatch() && !(*match)(route, NULL, NULL))
+            return false;
+    }
+    return true;
+}
+
 // Compare two terms
 bool PolicyTerm::operator==(const PolicyTerm &rhs) const {
     // Different number of match conditions
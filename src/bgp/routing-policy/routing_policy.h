@@ -23,7 +23,7 @@
 #include "bgp/bgp_common.h"
 #include "db/db_table.h"
 
-class BgpAttr;
+class BgpAttrBuilder;
 class BgpPath;
 class BgpRoute;
 class BgpServer;
@@ -62,6 +62,10 @@ class TaskTrigger;
 //     policy in input to match and apply the action on successful match.
 //
 //
+// Results of ExecuteRoutingPolicy are memoized in a bounded cache, so that
+// re-applying a policy to many routes that share an interned BgpAttr walks
+// the terms only once per attribute. See RoutingPolicyMgr::ResultCache.
+//
 // RoutingPolicyManager takes a delete reference of BgpServer.
 //
 // RoutingPolicy
@@ -187,7 +191,9 @@ class TaskTrigger;
 // are same. This is done by comparing the typeid() of the object and invoking
 // IsEqual when typeid() is same.
 // RoutingPolicyUpdateAction which inherits the RoutingPolicyAction provides the
-// pure virtual method operator() to apply update action on BgpAttr.
+// pure virtual method operator() to apply update action on BgpAttr. Updates are
+// made through a BgpAttrBuilder, so that the attribute is copied only if an
+// action changes it, and interned once after all policies are applied.
 // Currently support for updating the local-pref and community list is supported
 // for update action.
 // UpdateCommunity supports add/remove/set list of
@@ -201,7 +207,9 @@ public:
     ~PolicyTerm();
     bool terminal() const;
     bool ApplyTerm(const BgpRoute *route,
-                   const BgpPath *path, BgpAttr *attr) const;
+                   const BgpPath *path, BgpAttrBuilder *builder) const;
+    // Return true if the route matches all the prefix match conditions.
+    bool MatchRoute(const BgpRoute *route) const;
     void set_actions(const ActionList &actions) {
         actions_ = actions;
     }
@@ -256,10 +264,18 @@ public:
     }
 
     PolicyResult operator()(const BgpRoute *route,
-                            const BgpPath *path, BgpAttr *attr) const;
+                            const BgpPath *path,
+                            BgpAttrBuilder *builder) const;
     uint32_t generation() const { return generation_; }
     uint32_t refcount() const { return refcount_; }
 
+    // Bitmap of the terms whose prefix match conditions accept the route.
+    // Returns false if the policy has too many terms for the bitmap.
+    bool GetPrefixClass(const BgpRoute *route, uint64_t *prefix_class) const;
+
+    uint64_t result_cache_hits() const { return result_cache_hits_; }
+    uint64_t result_cache_misses() const { return result_cache_misses_; }
+
 private:
     friend class RoutingPolicyMgr;
     class DeleteActor;
@@ -278,6 +294,10 @@ private:
     tbb::atomic<uint32_t> refcount_;
     uint32_t generation_;
     RoutingPolicyTermList terms_;
+
+    // Updated by RoutingPolicyMgr on lookups in the result cache
+    mutable tbb::atomic<uint64_t> result_cache_hits_;
+    mutable tbb::atomic<uint64_t> result_cache_misses_;
 };
 
 inline void intrusive_ptr_add_ref(RoutingPolicy *policy) {
@@ -349,7 +369,11 @@ public:
 
     RoutingPolicy::PolicyResult ExecuteRoutingPolicy(
         const RoutingPolicy *policy, const BgpRoute *route,
-        const BgpPath *path, BgpAttr *attr) const;
+        const BgpPath *path, BgpAttrBuilder *builder) const;
+
+    // Remove all memoized policy results.
+    void ClearResultCache();
+    size_t result_cache_size() const;
 
     // Update the routing policy list on attach point
     bool UpdateRoutingPolicyList(const RoutingPolicyConfigList &cfg_list,
@@ -365,6 +389,7 @@ public:
 
 private:
     class DeleteActor;
+    class ResultCache;
 
     BgpServer *server_;
     tbb::mutex mutex_;
@@ -373,6 +398,7 @@ private:
     LifetimeRef<RoutingPolicyMgr> server_delete_ref_;
     RoutingPolicyWalkRequests routing_policy_sync_;
     SandeshTraceBufferPtr trace_buf_;
+    std::vector<ResultCache *> result_cache_;
 };
 
 #endif  // SRC_BGP_ROUTING_POLICY_ROUTING_POLICY_H_
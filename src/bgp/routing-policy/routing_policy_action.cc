@@ -22,19 +22,19 @@ UpdateAsPath::UpdateAsPath(const vector<uint32_t> &asn_list)
     : asn_list_(asn_list) {
 }
 
-void UpdateAsPath::operator()(BgpAttr *attr) const {
-    if (!attr)
+void UpdateAsPath::operator()(BgpAttrBuilder *builder) const {
+    if (!builder)
         return;
-    const AsPath4Byte *as_path = attr->aspath_4byte();
+    const AsPath4Byte *as_path = builder->get()->aspath_4byte();
     if (as_path) {
         const AsPath4ByteSpec &as_path_spec = as_path->path();
         AsPath4ByteSpec *as_path_spec_ptr = as_path_spec.Add(asn_list_);
-        attr->set_aspath_4byte(as_path_spec_ptr);
+        builder->set_aspath_4byte(as_path_spec_ptr);
         delete as_path_spec_ptr;
     } else {
         AsPath4ByteSpec as_path_spec;
         AsPath4ByteSpec *as_path_spec_ptr = as_path_spec.Add(asn_list_);
-        attr->set_aspath_4byte(as_path_spec_ptr);
+        builder->set_aspath_4byte(as_path_spec_ptr);
         delete as_path_spec_ptr;
     }
 }
@@ -75,11 +75,10 @@ UpdateCommunity::UpdateCommunity(const std::vector<string> communities,
     }
 }
 
-void UpdateCommunity::operator()(BgpAttr *attr) const {
-    if (!attr) return;
-    const Community *comm = attr->community();
-    BgpAttrDB *attr_db = attr->attr_db();
-    BgpServer *server = attr_db->server();
+void UpdateCommunity::operator()(BgpAttrBuilder *builder) const {
+    if (!builder) return;
+    const Community *comm = builder->get()->community();
+    BgpServer *server = builder->attr_db()->server();
     CommunityDB *comm_db = server->comm_db();
     CommunityPtr new_community = NULL;
     if (op_ == SET) {
@@ -89,7 +88,7 @@ void UpdateCommunity::operator()(BgpAttr *attr) const {
     } else if (op_ == REMOVE) {
         if (comm) new_community = comm_db->RemoveAndLocate(comm, communities_);
     }
-    attr->set_community(new_community);
+    builder->set_community(new_community);
 }
 
 string UpdateCommunity::ToString() const {
@@ -137,11 +136,10 @@ UpdateExtCommunity::UpdateExtCommunity(const std::vector<string> &communities,
     }
 }
 
-void UpdateExtCommunity::operator()(BgpAttr *attr) const {
-    if (!attr) return;
-    const ExtCommunity *comm = attr->ext_community();
-    BgpAttrDB *attr_db = attr->attr_db();
-    BgpServer *server = attr_db->server();
+void UpdateExtCommunity::operator()(BgpAttrBuilder *builder) const {
+    if (!builder) return;
+    const ExtCommunity *comm = builder->get()->ext_community();
+    BgpServer *server = builder->attr_db()->server();
     ExtCommunityDB *comm_db = server->extcomm_db();
     ExtCommunityPtr new_community = NULL;
     if (op_ == SET) {
@@ -151,7 +149,7 @@ void UpdateExtCommunity::operator()(BgpAttr *attr) const {
     } else if (op_ == REMOVE) {
         new_community = comm_db->RemoveAndLocate(comm, communities_);
     }
-    attr->set_ext_community(new_community);
+    builder->set_ext_community(new_community);
 }
 
 string UpdateExtCommunity::ToString() const {
@@ -181,8 +179,8 @@ UpdateLocalPref::UpdateLocalPref(uint32_t local_pref)
     : local_pref_(local_pref) {
 }
 
-void UpdateLocalPref::operator()(BgpAttr *attr) const {
-    attr->set_local_pref(local_pref_);
+void UpdateLocalPref::operator()(BgpAttrBuilder *builder) const {
+    builder->set_local_pref(local_pref_);
 }
 
 string UpdateLocalPref::ToString() const {
@@ -201,8 +199,8 @@ UpdateMed::UpdateMed(uint32_t med)
     : med_(med) {
 }
 
-void UpdateMed::operator()(BgpAttr *attr) const {
-    attr->set_med(med_);
+void UpdateMed::operator()(BgpAttrBuilder *builder) const {
+    builder->set_med(med_);
 }
 
 string UpdateMed::ToString() const {
@@ -12,7 +12,7 @@
 #include "bgp/community.h"
 #include "net/community_type.h"
 
-class BgpAttr;
+class BgpAttrBuilder;
 
 class RoutingPolicyAction {
 public:
@@ -37,7 +37,7 @@ public:
     virtual ~RoutingPolicyUpdateAction() {}
     bool terminal()  const { return false; }
     bool accept() const { return true; }
-    virtual void operator()(BgpAttr *out_attr) const = 0;
+    virtual void operator()(BgpAttrBuilder *builder) const = 0;
 };
 
 class RoutingPolicyAcceptAction : public RoutingPolicyAction {
@@ -84,7 +84,7 @@ public:
     UpdateAsPath(const std::vector<uint32_t> &asn_list);
     virtual ~UpdateAsPath() {}
 
-    virtual void operator()(BgpAttr *out_attr) const;
+    virtual void operator()(BgpAttrBuilder *builder) const;
     std::string ToString() const;
     virtual bool IsEqual(const RoutingPolicyAction &as_path) const;
     const std::vector<uint32_t> &asn_list() const { return asn_list_; }
@@ -103,7 +103,7 @@ public:
     };
     UpdateCommunity(const std::vector<std::string> communities, std::string op);
     virtual ~UpdateCommunity() {}
-    virtual void operator()(BgpAttr *out_attr) const;
+    virtual void operator()(BgpAttrBuilder *builder) const;
     std::string ToString() const;
     virtual bool IsEqual(const RoutingPolicyAction &community) const;
     const CommunityList &communities() const {
@@ -125,7 +125,7 @@ public:
     UpdateExtCommunity(const std::vector<std::string> &communities,
                        std::string op);
     virtual ~UpdateExtCommunity() {}
-    virtual void operator()(BgpAttr *out_attr) const;
+    virtual void operator()(BgpAttrBuilder *builder) const;
     std::string ToString() const;
     virtual bool IsEqual(const RoutingPolicyAction &community) const;
     const ExtCommunity::ExtCommunityList &communities() const {
@@ -141,7 +141,7 @@ class UpdateLocalPref : public RoutingPolicyUpdateAction {
 public:
     explicit UpdateLocalPref(uint32_t local_pref);
     virtual ~UpdateLocalPref() {}
-    virtual void operator()(BgpAttr *out_attr) const;
+    virtual void operator()(BgpAttrBuilder *builder) const;
     std::string ToString() const;
     virtual bool IsEqual(const RoutingPolicyAction &local_pref) const;
 
@@ -153,7 +153,7 @@ class UpdateMed : public RoutingPolicyUpdateAction {
 public:
     explicit UpdateMed(uint32_t med);
     virtual ~UpdateMed() {}
-    virtual void operator()(BgpAttr *out_attr) const;
+    virtual void operator()(BgpAttrBuilder *builder) const;
     std::string ToString() const;
     virtual bool IsEqual(const RoutingPolicyAction &med) const;
 
@@ -47,6 +47,66 @@ using std::unique;
 using std::vector;
 using std::find;
 
+CommunityRegexMatcher::CommunityRegexMatcher() : combined_(false) {
+}
+
+CommunityRegexMatcher::~CommunityRegexMatcher() {
+}
+
+//
+// Return true if the regex string has a back reference to a group.
+//
+static bool HasBackReference(const string &regex_str) {
+    for (size_t pos = regex_str.find('\\'); pos != string::npos;
+         pos = regex_str.find('\\', pos + 2)) {
+        if (pos + 1 == regex_str.size())
+            break;
+        char next = regex_str[pos + 1];
+        if ((next >= '1' && next <= '9') || next == 'g' || next == 'k')
+            return true;
+    }
+    return false;
+}
+
+//
+// Build the combined regex from the valid regex strings.
+//
+void CommunityRegexMatcher::Build(const vector<string> &regex_strings) {
+    vector<regex> regexs;
+    string pattern;
+    bool combine = true;
+    BOOST_FOREACH(const string &regex_str, regex_strings) {
+        regex match_expr(regex_str);
+        if (match_expr.status() != 0)
+            continue;
+        regexs.push_back(match_expr);
+        if (HasBackReference(regex_str))
+            combine = false;
+        if (!pattern.empty())
+            pattern += "|";
+        pattern += "(?:" + regex_str + ")";
+    }
+
+    combined_ = false;
+    if (combine && regexs.size() > 1) {
+        combined_regex_ = regex(pattern);
+        combined_ = (combined_regex_.status() == 0);
+    }
+    regexs_.clear();
+    if (!combined_)
+        regexs_.swap(regexs);
+}
+
+bool CommunityRegexMatcher::Match(const string &input) const {
+    if (combined_)
+        return regex_match(input, combined_regex_);
+    BOOST_FOREACH(const regex &match_expr, regexs_) {
+        if (regex_match(input, match_expr))
+            return true;
+    }
+    return false;
+}
+
 MatchCommunity::MatchCommunity(const vector<string> &communities,
     bool match_all) : match_all_(match_all) {
     // Assume that the each community string that doesn't correspond to a
@@ -70,6 +130,7 @@ MatchCommunity::MatchCommunity(const vector<string> &communities,
     BOOST_FOREACH(string regex_str, regex_strings()) {
         to_match_regexs_.push_back(regex(regex_str));
     }
+    regex_matcher_.Build(regex_strings());
 }
 
 MatchCommunity::~MatchCommunity() {
@@ -94,12 +155,20 @@ bool MatchCommunity::MatchAll(const BgpAttr *attr) const {
         return false;
     }
 
+    if (regexs().empty())
+        return true;
+
     // Make sure that each regex in this MatchCommunity is matched by one
-    // of the communities in the BgpAttr.
+    // of the communities in the BgpAttr. The communities are converted to
+    // strings only once.
+    vector<string> community_strs;
+    community_strs.reserve(comm->communities().size());
+    BOOST_FOREACH(uint32_t community, comm->communities()) {
+        community_strs.push_back(CommunityType::CommunityToString(community));
+    }
     BOOST_FOREACH(const regex &match_expr, regexs()) {
         bool matched = false;
-        BOOST_FOREACH(uint32_t community, comm->communities()) {
-            string community_str = CommunityType::CommunityToString(community);
+        BOOST_FOREACH(const string &community_str, community_strs) {
             if (regex_match(community_str, match_expr)) {
                 matched = true;
                 break;
@@ -131,12 +200,12 @@ bool MatchCommunity::MatchAny(const BgpAttr *attr) const {
 
     // Check if any of the community values in the BgpAttr matches one of
     // the community regexs.
+    if (regex_matcher_.empty())
+        return false;
     BOOST_FOREACH(uint32_t community, comm->communities()) {
         string community_str = CommunityType::CommunityToString(community);
-        BOOST_FOREACH(const regex &match_expr, regexs()) {
-            if (regex_match(community_str, match_expr))
-                return true;
-        }
+        if (regex_matcher_.Match(community_str))
+            return true;
     }
 
     return false;
@@ -213,6 +282,7 @@ MatchExtCommunity::MatchExtCommunity(const vector<string> &communities,
     BOOST_FOREACH(string regex_str, regex_strings()) {
         to_match_regexs_.push_back(regex(regex_str));
     }
+    regex_matcher_.Build(regex_strings());
 }
 
 MatchExtCommunity::~MatchExtCommunity() {
@@ -237,18 +307,23 @@ bool MatchExtCommunity::MatchAll(const BgpAttr *attr) const {
         return false;
     }
 
+    if (regexs().empty())
+        return true;
+
     // Make sure that each regex in this MatchExtCommunity is matched by one
-    // of the communities in the BgpAttr.
+    // of the communities in the BgpAttr. The communities are converted to
+    // strings only once, the string and hex representations of a community
+    // are adjacent.
+    vector<string> community_strs;
+    community_strs.reserve(comm->communities().size() * 2);
+    BOOST_FOREACH(const ExtCommunity::ExtCommunityValue &community,
+                  comm->communities()) {
+        community_strs.push_back(ExtCommunity::ToString(community));
+        community_strs.push_back(ExtCommunity::ToHexString(community));
+    }
     BOOST_FOREACH(const regex &match_expr, regexs()) {
         bool matched = false;
-        BOOST_FOREACH(ExtCommunity::ExtCommunityValue community,
-                      comm->communities()) {
-            string community_str = ExtCommunity::ToString(community);
-            if (regex_match(community_str, match_expr)) {
-                matched = true;
-                break;
-            }
-            community_str = ExtCommunity::ToHexString(community);
+        BOOST_FOREACH(const string &community_str, community_strs) {
             if (regex_match(community_str, match_expr)) {
                 matched = true;
                 break;
@@ -287,18 +362,14 @@ bool MatchExtCommunity::MatchAny(const BgpAttr *attr) const {
 
     // Check if any of the community values in the BgpAttr matches one of
     // the community regexs.
-    BOOST_FOREACH(ExtCommunity::ExtCommunityValue community,
+    if (regex_matcher_.empty())
+        return false;
+    BOOST_FOREACH(const ExtCommunity::ExtCommunityValue &community,
                   comm->communities()) {
-        string community_str = ExtCommunity::ToString(community);
-        BOOST_FOREACH(const regex &match_expr, regexs()) {
-            if (regex_match(community_str, match_expr))
-                return true;
-        }
-        community_str = ExtCommunity::ToHexString(community);
-        BOOST_FOREACH(const regex &match_expr, regexs()) {
-            if (regex_match(community_str, match_expr))
-                return true;
-        }
+        if (regex_matcher_.Match(ExtCommunity::ToString(community)))
+            return true;
+        if (regex_matcher_.Match(ExtCommunity::ToHexString(community)))
+            return true;
     }
 
     return false;
@@ -378,6 +449,62 @@ MatchPrefix<T>::MatchPrefix(const PrefixMatchConfigList &match_config_list) {
     typename PrefixMatchList::iterator it =
         unique(match_list_.begin(), match_list_.end());
     match_list_.erase(it, match_list_.end());
+
+    // Compile the match list into the trie.
+    trie_.push_back(TrieNode());
+    BOOST_FOREACH(const PrefixMatch &prefix_match, match_list_) {
+        AddTrieNode(prefix_match.prefix.addr(),
+            prefix_match.prefix.prefixlen(), prefix_match.match_type);
+    }
+}
+
+template <typename BytesT>
+static inline int AddressBit(const BytesT &bytes, int bit) {
+    return (bytes[bit >> 3] >> (7 - (bit & 7))) & 1;
+}
+
+template <typename T>
+template <typename AddressT>
+void MatchPrefix<T>::AddTrieNode(const AddressT &addr, int plen,
+                                 MatchType match_type) {
+    typename AddressT::bytes_type bytes = addr.to_bytes();
+    uint32_t index = 0;
+    for (int bit = 0; bit < plen; ++bit) {
+        int dir = AddressBit(bytes, bit);
+        if (!trie_[index].child[dir]) {
+            trie_[index].child[dir] = trie_.size();
+            trie_.push_back(TrieNode());
+        }
+        index = trie_[index].child[dir];
+    }
+    trie_[index].match_types |= (1 << match_type);
+}
+
+//
+// Walk down the trie along the bits of the route prefix. A node above the
+// route prefix matches if it has a longer or orlonger prefix, and the node
+// for the route prefix itself matches if it has an exact or orlonger prefix.
+// The cost depends on the prefix length and not on the size of the list.
+//
+// Configured prefixes don't have bits set beyond the prefix length, since
+// they are parsed as subnets. Route prefixes are assumed to be the same.
+//
+template <typename T>
+template <typename AddressT>
+bool MatchPrefix<T>::MatchTrie(const AddressT &addr, int plen) const {
+    static const uint8_t kShorterTypes = (1 << LONGER) | (1 << ORLONGER);
+    static const uint8_t kEqualTypes = (1 << EXACT) | (1 << ORLONGER);
+
+    typename AddressT::bytes_type bytes = addr.to_bytes();
+    uint32_t index = 0;
+    for (int bit = 0; bit < plen; ++bit) {
+        if (trie_[index].match_types & kShorterTypes)
+            return true;
+        index = trie_[index].child[AddressBit(bytes, bit)];
+        if (!index)
+            return false;
+    }
+    return (trie_[index].match_types & kEqualTypes) != 0;
 }
 
 template <typename T>
@@ -391,21 +518,7 @@ bool MatchPrefix<T>::Match(const BgpRoute *route, const BgpPath *path,
     if (in_route == NULL)
         return false;
     const PrefixT &prefix = in_route->GetPrefix();
-    BOOST_FOREACH(const PrefixMatch &prefix_match, match_list_) {
-        if (prefix_match.match_type == EXACT) {
-            if (prefix == prefix_match.prefix)
-                return true;
-        } else if (prefix_match.match_type == LONGER) {
-            if (prefix == prefix_match.prefix)
-                continue;
-            if (prefix.IsMoreSpecific(prefix_match.prefix))
-                return true;
-        } else if (prefix_match.match_type == ORLONGER) {
-            if (prefix.IsMoreSpecific(prefix_match.prefix))
-                return true;
-        }
-    }
-    return false;
+    return MatchTrie(prefix.addr(), prefix.prefixlen());
 }
 
 template <typename T>
@@ -43,6 +43,34 @@ public:
         return !operator==(match);
     }
     virtual bool IsEqual(const RoutingPolicyMatch &match) const = 0;
+    // Return true if the result depends only on the route and not on the
+    // path or the attribute.
+    virtual bool IsRouteMatch() const { return false; }
+};
+
+//
+// Matches a string against a set of community regexs in a single pass.
+//
+// The regexs are compiled into one alternation, so that matching a community
+// value against any of the regexs runs one automaton instead of one per
+// regex. Invalid regexs never match and are left out. Regexs with back
+// references can't be combined since the alternation renumbers the groups,
+// in which case each regex is tried in turn.
+//
+class CommunityRegexMatcher {
+public:
+    CommunityRegexMatcher();
+    ~CommunityRegexMatcher();
+
+    void Build(const std::vector<std::string> &regex_strings);
+    bool Match(const std::string &input) const;
+    bool empty() const { return !combined_ && regexs_.empty(); }
+    bool combined() const { return combined_; }
+
+private:
+    contrail::regex combined_regex_;
+    bool combined_;
+    std::vector<contrail::regex> regexs_;
 };
 
 class MatchCommunity: public RoutingPolicyMatch {
@@ -72,6 +100,7 @@ private:
     CommunityList to_match_;
     CommunityRegexStringList to_match_regex_strings_;
     CommunityRegexList to_match_regexs_;
+    CommunityRegexMatcher regex_matcher_;
 };
 
 class MatchExtCommunity: public RoutingPolicyMatch {
@@ -106,6 +135,7 @@ private:
     ExtCommunity::ExtCommunityList to_match_;
     CommunityRegexStringList to_match_regex_strings_;
     CommunityRegexList to_match_regexs_;
+    CommunityRegexMatcher regex_matcher_;
 };
 
 class MatchProtocol: public RoutingPolicyMatch {
@@ -182,6 +212,7 @@ public:
                        const BgpPath *path, const BgpAttr *attr) const;
     virtual std::string ToString() const;
     virtual bool IsEqual(const RoutingPolicyMatch &prefix) const;
+    virtual bool IsRouteMatch() const { return true; }
 
     static MatchType GetMatchType(const std::string &match_type_str);
 
@@ -189,7 +220,27 @@ private:
     template <typename U> friend class MatchPrefixTest;
     typedef std::vector<PrefixMatch> PrefixMatchList;
 
+    // Binary trie of the prefixes in the match list, indexed by the bits of
+    // the address. The node at depth n stands for the n bit prefix on the
+    // path from the root and holds a bitmap of the match types configured
+    // for that prefix. Child index 0 means no child since the root is never
+    // a child.
+    struct TrieNode {
+        TrieNode() : match_types(0) {
+            child[0] = child[1] = 0;
+        }
+        uint32_t child[2];
+        uint8_t match_types;
+    };
+    typedef std::vector<TrieNode> Trie;
+
+    template <typename AddressT>
+    void AddTrieNode(const AddressT &addr, int plen, MatchType match_type);
+    template <typename AddressT>
+    bool MatchTrie(const AddressT &addr, int plen) const;
+
     PrefixMatchList match_list_;
+    Trie trie_;
 };
 
 typedef MatchPrefix<PrefixMatchInet> MatchPrefixInet;
@@ -24,6 +24,8 @@ static void FillRoutingPolicyInfo(ShowRoutingPolicyInfo *srpi,
     srpi->set_generation(policy->generation());
     srpi->set_ref_count(policy->refcount());
     srpi->set_deleted(policy->deleted());
+    srpi->set_result_cache_hits(policy->result_cache_hits());
+    srpi->set_result_cache_misses(policy->result_cache_misses());
     vector<PolicyTermInfo> term_list;
     BOOST_FOREACH(RoutingPolicy::PolicyTermPtr term, policy->terms()) {
         PolicyTermInfo show_term;
@@ -1601,6 +1601,79 @@ TEST_F(BgpAttrTest, SourceRdBasic3) {
     EXPECT_EQ(rd2, ptr->source_rd());
 }
 
+TEST_F(BgpAttrTest, Builder1) {
+    BgpAttrSpec attr_spec;
+    BgpAttrLocalPref lpref_spec(100);
+    attr_spec.push_back(&lpref_spec);
+    BgpAttrNextHop nexthop_spec(0x0a0a0a0a);
+    attr_spec.push_back(&nexthop_spec);
+    BgpAttrPtr ptr = attr_db_->Locate(attr_spec);
+    EXPECT_EQ(1, attr_db_->Size());
+
+    ExtCommunitySpec ext_spec;
+    ext_spec.communities.push_back(0x0002fe0000000001ULL);
+    ExtCommunityPtr extcomm = extcomm_db_->Locate(ext_spec);
+    RouteDistinguisher rd = RouteDistinguisher::FromString("192.168.0.1:1");
+    IpAddress nexthop = Ip4Address::from_string("10.1.1.1");
+
+    // Several modifications result in a single copy of the attribute.
+    uint64_t clones = attr_db_->clone_count();
+    BgpAttrBuilder builder(attr_db_, ptr.get());
+    builder.set_ext_community(extcomm);
+    builder.set_source_rd(rd);
+    builder.set_nexthop(nexthop);
+    builder.set_local_pref(200);
+    EXPECT_TRUE(builder.modified());
+    BgpAttrPtr new_ptr = builder.Locate();
+    EXPECT_EQ(clones + 1, attr_db_->clone_count());
+    EXPECT_EQ(2, attr_db_->Size());
+    EXPECT_EQ(extcomm.get(), new_ptr->ext_community());
+    EXPECT_EQ(rd, new_ptr->source_rd());
+    EXPECT_EQ(nexthop, new_ptr->nexthop());
+    EXPECT_EQ(200, new_ptr->local_pref());
+
+    // The result is the same as that of chained Replace...AndLocate calls.
+    BgpAttrPtr replace_ptr =
+        attr_db_->ReplaceExtCommunityAndLocate(ptr.get(), extcomm);
+    replace_ptr = attr_db_->ReplaceSourceRdAndLocate(replace_ptr.get(), rd);
+    replace_ptr = attr_db_->ReplaceNexthopAndLocate(replace_ptr.get(), nexthop);
+    replace_ptr = attr_db_->ReplaceLocalPreferenceAndLocate(
+        replace_ptr.get(), 200);
+    EXPECT_EQ(new_ptr, replace_ptr);
+    EXPECT_EQ(clones + 5, attr_db_->clone_count());
+}
+
+TEST_F(BgpAttrTest, Builder2) {
+    BgpAttrSpec attr_spec;
+    BgpAttrLocalPref lpref_spec(100);
+    attr_spec.push_back(&lpref_spec);
+    BgpAttrPtr ptr = attr_db_->Locate(attr_spec);
+
+    // Modifications that do not change the attribute do not copy it.
+    uint64_t clones = attr_db_->clone_count();
+    BgpAttrBuilder builder(attr_db_, ptr.get());
+    builder.set_local_pref(100);
+    builder.set_ext_community(NULL);
+    builder.set_source_rd(RouteDistinguisher::kZeroRd);
+    EXPECT_FALSE(builder.modified());
+    EXPECT_EQ(ptr.get(), builder.get());
+    EXPECT_EQ(ptr, builder.Locate());
+    EXPECT_EQ(ptr, attr_db_->ReplaceLocalPreferenceAndLocate(ptr.get(), 100));
+    EXPECT_EQ(clones, attr_db_->clone_count());
+    EXPECT_EQ(1, attr_db_->Size());
+
+    // The builder can be used again after Locate.
+    builder.set_med(10);
+    EXPECT_TRUE(builder.modified());
+    EXPECT_EQ(10, builder.get()->med());
+    EXPECT_EQ(100, builder.get()->local_pref());
+    BgpAttrPtr new_ptr = builder.Locate();
+    EXPECT_NE(ptr, new_ptr);
+    EXPECT_EQ(10, new_ptr->med());
+    EXPECT_EQ(clones + 1, attr_db_->clone_count());
+    EXPECT_EQ(2, attr_db_->Size());
+}
+
 TEST_F(BgpAttrTest, SourceRdCompareTo) {
     RouteDistinguisher rd1 = RouteDistinguisher::FromString("192.168.0.1:1");
     RouteDistinguisher rd2 = RouteDistinguisher::FromString("192.168.0.1:2");
@@ -2369,6 +2442,38 @@ TEST_F(BgpAttrTest, EdgeDiscovery7c) {
     EXPECT_EQ(ediscovery1, ediscovery2);
 }
 
+// Same edges in different order must hash to the same partition and share
+// the same entry.
+TEST_F(BgpAttrTest, EdgeDiscovery7d) {
+    EdgeDiscoverySpec edspec1;
+    for (int idx = 1; idx < 5; ++idx) {
+        error_code ec;
+        EdgeDiscoverySpec::Edge *edge = new(EdgeDiscoverySpec::Edge);
+        std::string addr_str = "10.1.1." + integerToString(idx);
+        edge->SetIp4Address(Ip4Address::from_string(addr_str, ec));
+        edge->SetLabels(1000 * idx, 1000 * idx + 999);
+        edspec1.edge_list.push_back(edge);
+    }
+    EdgeDiscoverySpec edspec2;
+    for (int idx = 4; idx > 0; --idx) {
+        error_code ec;
+        EdgeDiscoverySpec::Edge *edge = new(EdgeDiscoverySpec::Edge);
+        std::string addr_str = "10.1.1." + integerToString(idx);
+        edge->SetIp4Address(Ip4Address::from_string(addr_str, ec));
+        edge->SetLabels(1000 * idx, 1000 * idx + 999);
+        edspec2.edge_list.push_back(edge);
+    }
+
+    EdgeDiscoveryPtr ediscovery1 = edge_discovery_db_->Locate(edspec1);
+    EdgeDiscoveryPtr ediscovery2 = edge_discovery_db_->Locate(edspec2);
+    EXPECT_EQ(1, edge_discovery_db_->Size());
+    EXPECT_EQ(ediscovery1, ediscovery2);
+
+    EdgeDiscovery ediscovery3(edge_discovery_db_, edspec2);
+    EXPECT_EQ(0, ediscovery1->CompareTo(ediscovery3));
+    EXPECT_EQ(hash_value(*ediscovery1), hash_value(ediscovery3));
+}
+
 TEST_F(BgpAttrTest, EdgeDiscovery8a) {
     EdgeDiscoverySpec edspec1;
     for (int idx = 1; idx < 4; ++idx) {
@@ -2503,6 +2608,37 @@ TEST_F(BgpAttrTest, BgpOList2b) {
     EXPECT_EQ(olist1, olist2);
 }
 
+// Same elements and encaps in different order must hash to the same
+// partition and share the same entry.
+TEST_F(BgpAttrTest, BgpOList2e) {
+    BgpOListSpec olist_spec1(BgpAttribute::OList);
+    for (int idx = 1; idx < 5; ++idx) {
+        error_code ec;
+        std::string addr_str = "10.1.1." + integerToString(idx);
+        std::vector<std::string> encap = list_of("gre")("udp");
+        BgpOListElem elem(
+            Ip4Address::from_string(addr_str, ec), 1000 * idx, encap);
+        olist_spec1.elements.push_back(elem);
+    }
+    BgpOListSpec olist_spec2(BgpAttribute::OList);
+    for (int idx = 4; idx > 0; --idx) {
+        error_code ec;
+        std::string addr_str = "10.1.1." + integerToString(idx);
+        std::vector<std::string> encap = list_of("udp")("gre");
+        BgpOListElem elem(
+            Ip4Address::from_string(addr_str, ec), 1000 * idx, encap);
+        olist_spec2.elements.push_back(elem);
+    }
+    BgpOListPtr olist1 = olist_db_->Locate(olist_spec1);
+    BgpOListPtr olist2 = olist_db_->Locate(olist_spec2);
+    EXPECT_EQ(1, olist_db_->Size());
+    EXPECT_EQ(olist1, olist2);
+
+    BgpOList olist3(olist_db_, olist_spec2);
+    EXPECT_EQ(0, olist1->CompareTo(olist3));
+    EXPECT_EQ(hash_value(*olist1), hash_value(olist3));
+}
+
 TEST_F(BgpAttrTest, BgpOList2c) {
     BgpOListSpec olist_spec1(BgpAttribute::OList);
     for (int idx = 1; idx < 3; ++idx) {
@@ -3136,6 +3272,42 @@ TEST_F(BgpAttrTest, BgpAttrDB) {
     STLDeleteValues(&spec);
 }
 
+TEST_F(BgpAttrTest, BgpAttrDBStats) {
+    EXPECT_LT(1, attr_db_->hash_size());
+    BgpPathAttributeDBStats stats1;
+    attr_db_->GetStats(&stats1);
+
+    BgpAttrSpec spec;
+    BgpAttrNextHop nexthop(0xabcdef01);
+    spec.push_back(&nexthop);
+    BgpAttrLocalPref local_pref(100);
+    spec.push_back(&local_pref);
+
+    BgpAttrPtr ptr1 = attr_db_->Locate(spec);
+    BgpAttrPtr ptr2 = attr_db_->Locate(spec);
+    EXPECT_EQ(ptr1, ptr2);
+    local_pref.local_pref = 200;
+    BgpAttrPtr ptr3 = attr_db_->Locate(spec);
+    EXPECT_NE(ptr1, ptr3);
+    EXPECT_EQ(2, attr_db_->Size());
+
+    BgpPathAttributeDBStats stats2;
+    attr_db_->GetStats(&stats2);
+    EXPECT_EQ(stats1.lookups + 3, stats2.lookups);
+    EXPECT_EQ(stats1.hits + 1, stats2.hits);
+    EXPECT_EQ(stats1.inserts + 2, stats2.inserts);
+    EXPECT_EQ(stats1.deletes, stats2.deletes);
+
+    ptr1.reset();
+    ptr2.reset();
+    ptr3.reset();
+    EXPECT_EQ(0, attr_db_->Size());
+
+    BgpPathAttributeDBStats stats3;
+    attr_db_->GetStats(&stats3);
+    EXPECT_EQ(stats1.deletes + 2, stats3.deletes);
+}
+
 // ----- Test multi-threaded issues in path attributes db.
 // Launch a number of threads, that add and delete the same attribute content.
 // Since many threads are launched, we get to uncover most of the concurrency
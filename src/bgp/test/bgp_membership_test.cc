@@ -13,7 +13,9 @@
 #include "bgp/bgp_membership.h"
 #include "bgp/bgp_session_manager.h"
 #include "bgp/test/bgp_server_test_util.h"
+#include "db/db.h"
 #include "db/db_partition.h"
+#include "db/db_table_walk_mgr.h"
 
 using boost::scoped_ptr;
 using std::ostringstream;
@@ -276,6 +278,16 @@ protected:
     size_t GetWalkerRibOutStateListSize() {
         return walker_->GetRibOutStateListSize();
     }
+    size_t GetWalkerWalkCount() { return walker_->GetWalkCount(); }
+    void SetMaxConcurrentWalks(uint32_t count) {
+        server_->database()->GetWalkMgr()->SetMaxConcurrentWalks(count);
+    }
+    uint64_t GetFirstRouteLatency(IPeer *peer, BgpTable *table) {
+        return mgr_->FindPeerRibState(peer, table)->first_route_latency();
+    }
+    uint64_t GetJoinLatency(IPeer *peer, BgpTable *table) {
+        return mgr_->FindPeerRibState(peer, table)->join_latency();
+    }
     void WalkerPostponeWalk() {
         task_util::TaskFire(
             boost::bind(&BgpMembershipManager::Walker::PostponeWalk, walker_),
@@ -1144,6 +1156,66 @@ TEST_F(BgpMembershipTest, MultiplePeersMultipleTable) {
     TASK_UTIL_EXPECT_EQ(red_walk_count + 2, red_tbl_->walk_complete_count());
 }
 
+//
+// Verify that walks for multiple tables are started concurrently when the
+// DBTableWalkMgr allows concurrent walks.
+// Register for a table that's being walked needs another table walk.
+//
+TEST_F(BgpMembershipTest, MultipleTableConcurrentWalks) {
+    uint64_t blue_walk_count = blue_tbl_->walk_complete_count();
+    uint64_t red_walk_count = red_tbl_->walk_complete_count();
+    SetMaxConcurrentWalks(2);
+
+    // Postpone walk.
+    WalkerPostponeWalk();
+
+    // Register first peer to both tables.
+    Register(peers_[0], blue_tbl_);
+    Register(peers_[0], red_tbl_);
+    task_util::WaitForIdle();
+
+    TASK_UTIL_EXPECT_EQ(0, GetWalkerQueueSize());
+    TASK_UTIL_EXPECT_EQ(2, GetWalkerWalkCount());
+    TASK_UTIL_EXPECT_EQ(2, GetWalkerRibOutStateListSize());
+    TASK_UTIL_EXPECT_EQ(blue_walk_count, blue_tbl_->walk_complete_count());
+    TASK_UTIL_EXPECT_EQ(red_walk_count, red_tbl_->walk_complete_count());
+
+    // Register remaining peers to blue.
+    Register(peers_[1], blue_tbl_);
+    Register(peers_[2], blue_tbl_);
+    task_util::WaitForIdle();
+    TASK_UTIL_EXPECT_EQ(1, GetWalkerQueueSize());
+    TASK_UTIL_EXPECT_EQ(2, GetWalkerWalkCount());
+
+    // Resume walk.
+    WalkerResumeWalk();
+    task_util::WaitForIdle();
+
+    TASK_UTIL_EXPECT_EQ(0, GetWalkerQueueSize());
+    TASK_UTIL_EXPECT_EQ(0, GetWalkerWalkCount());
+    TASK_UTIL_EXPECT_EQ(4, mgr_->GetMembershipCount());
+    TASK_UTIL_EXPECT_EQ(blue_walk_count + 2, blue_tbl_->walk_complete_count());
+    TASK_UTIL_EXPECT_EQ(red_walk_count + 1, red_tbl_->walk_complete_count());
+    for (size_t idx = 0; idx < 3; ++idx) {
+        TASK_UTIL_EXPECT_TRUE(
+            mgr_->GetRegistrationInfo(peers_[idx], blue_tbl_));
+        EXPECT_LE(GetFirstRouteLatency(peers_[idx], blue_tbl_),
+            GetJoinLatency(peers_[idx], blue_tbl_));
+    }
+    TASK_UTIL_EXPECT_TRUE(mgr_->GetRegistrationInfo(peers_[0], red_tbl_));
+
+    // Unregister all peers.
+    Unregister(peers_[0], blue_tbl_);
+    Unregister(peers_[1], blue_tbl_);
+    Unregister(peers_[2], blue_tbl_);
+    Unregister(peers_[0], red_tbl_);
+    task_util::WaitForIdle();
+
+    TASK_UTIL_EXPECT_EQ(0, GetWalkerQueueSize());
+    TASK_UTIL_EXPECT_EQ(0, mgr_->GetMembershipCount());
+    SetMaxConcurrentWalks(1);
+}
+
 //
 // Duplicate register causes assertion.
 // Duplicate register happens after original is fully processed.
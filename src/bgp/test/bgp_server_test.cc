@@ -304,6 +304,18 @@ void BgpServerUnitTest::ValidateShowBgpServerResponse(Sandesh *sandesh) {
     EXPECT_NE(0, tx_stats.calls);
     EXPECT_NE(0, tx_stats.bytes);
     EXPECT_NE(0, tx_stats.average_bytes);
+    const vector<ShowPathAttributeDBStats> &db_stats =
+        resp->get_attribute_db_stats();
+    EXPECT_EQ(12, db_stats.size());
+    EXPECT_EQ("attr", db_stats[0].name);
+    EXPECT_NE(0, db_stats[0].partitions);
+    EXPECT_NE(0, db_stats[0].lookups);
+    EXPECT_EQ(db_stats[0].lookups,
+              db_stats[0].hits + db_stats[0].inserts + db_stats[0].retries);
+    const vector<ShowReplicatorStats> &replicator_stats =
+        resp->get_replicator_stats();
+    EXPECT_EQ(5, replicator_stats.size());
+    EXPECT_EQ("inet-vpn", replicator_stats[0].family);
     validate_done_ = true;
 }
 
@@ -1085,6 +1085,110 @@ TEST_F(BgpTableWalkTest, WalkEmptyTable) {
     TASK_UTIL_EXPECT_EQ(1, red_->walk_complete_count());
 }
 
+//
+// Allow two concurrent walks and trigger walk on three tables.
+// Verify that two tables are walked at the same time and the third table is
+// walked when one of the walks completes
+//
+TEST_F(BgpTableWalkTest, ConcurrentWalk) {
+    AddInetRoute(red_, "11.1.1.0/24");
+    AddInetRoute(blue_, "22.2.2.0/24");
+    AddInetRoute(purple_, "33.3.3.0/24");
+
+    DBTableWalkMgr *walk_mgr = server_.database()->GetWalkMgr();
+    walk_mgr->SetMaxConcurrentWalks(2);
+    task_util::WaitForIdle();
+
+    DBTable::DBTableWalkRef walk_ref_1 = red_->AllocWalker(
+              boost::bind(&BgpTableWalkTest::WalkTableCallback, this, _1, _2),
+              boost::bind(&BgpTableWalkTest::WalkDone, this, _1, _2));
+    DBTable::DBTableWalkRef walk_ref_2 = blue_->AllocWalker(
+              boost::bind(&BgpTableWalkTest::WalkTableCallback, this, _1, _2),
+              boost::bind(&BgpTableWalkTest::WalkDone, this, _1, _2));
+    DBTable::DBTableWalkRef walk_ref_3 = purple_->AllocWalker(
+              boost::bind(&BgpTableWalkTest::WalkTableCallback, this, _1, _2),
+              boost::bind(&BgpTableWalkTest::WalkDone, this, _1, _2));
+
+    // Hold the walk done processing to keep both walk slots in use
+    DisableWalkDoneProcessing();
+    DisableWalkProcessing();
+    WalkTable(red_, walk_ref_1);
+    WalkTable(blue_, walk_ref_2);
+    WalkTable(purple_, walk_ref_3);
+    EnableWalkProcessing();
+
+    TASK_UTIL_EXPECT_EQ(2, walk_count_);
+    TASK_UTIL_EXPECT_EQ(1, red_->walk_complete_count());
+    TASK_UTIL_EXPECT_EQ(1, blue_->walk_complete_count());
+    TASK_UTIL_EXPECT_EQ(2, walk_mgr->walk_in_progress_count());
+    TASK_UTIL_EXPECT_EQ(1, walk_mgr->walk_request_count());
+    // Ensure that walk did not start on PURPLE table
+    TASK_UTIL_EXPECT_EQ(0, purple_->walk_count());
+    TASK_UTIL_EXPECT_EQ(0, walk_done_count_);
+
+    EnableWalkDoneProcessing();
+    TASK_UTIL_EXPECT_EQ(3, walk_done_count_);
+    TASK_UTIL_EXPECT_EQ(3, walk_count_);
+    TASK_UTIL_EXPECT_EQ(1, purple_->walk_count());
+    TASK_UTIL_EXPECT_EQ(1, purple_->walk_complete_count());
+    TASK_UTIL_EXPECT_EQ(0, walk_mgr->walk_in_progress_count());
+    TASK_UTIL_EXPECT_EQ(0, walk_mgr->walk_request_count());
+    TASK_UTIL_EXPECT_EQ(1, red_->walk_entries_visited());
+    TASK_UTIL_EXPECT_EQ(1, purple_->walk_entries_visited());
+
+    DeleteInetRoute(red_, "11.1.1.0/24");
+    DeleteInetRoute(blue_, "22.2.2.0/24");
+    DeleteInetRoute(purple_, "33.3.3.0/24");
+}
+
+//
+// Trigger walks with different priorities on multiple tables.
+// Verify that tables are walked in priority order and that a request is
+// raised to the priority of a higher priority walker on the same table
+//
+TEST_F(BgpTableWalkTest, WalkPriority) {
+    AddInetRoute(red_, "11.1.1.0/24");
+    AddInetRoute(blue_, "22.2.2.0/24");
+    AddInetRoute(purple_, "33.3.3.0/24");
+
+    DBTable::DBTableWalkRef walk_ref_1 = blue_->AllocWalker(
+        boost::bind(&BgpTableWalkTest::WalkTableCallback, this, _1, _2),
+        boost::bind(&BgpTableWalkTest::VerifyWalkDoneCbOrder, this, 3, _1, _2),
+        DBTable::WALK_PRIORITY_LOW);
+    DBTable::DBTableWalkRef walk_ref_2 = red_->AllocWalker(
+        boost::bind(&BgpTableWalkTest::WalkTableCallback, this, _1, _2),
+        boost::bind(&BgpTableWalkTest::VerifyWalkDoneCbOrder, this, 2, _1, _2));
+    DBTable::DBTableWalkRef walk_ref_3 = purple_->AllocWalker(
+        boost::bind(&BgpTableWalkTest::WalkTableCallback, this, _1, _2),
+        boost::bind(&BgpTableWalkTest::VerifyWalkDoneCbOrder, this, 1, _1, _2),
+        DBTable::WALK_PRIORITY_LOW);
+    DBTable::DBTableWalkRef walk_ref_4 = purple_->AllocWalker(
+        boost::bind(&BgpTableWalkTest::WalkTableCallback_1, this, _1, _2),
+        boost::bind(&BgpTableWalkTest::WalkDone_1, this, _1, _2),
+        DBTable::WALK_PRIORITY_HIGH);
+
+    DisableWalkProcessing();
+    WalkTable(blue_, walk_ref_1);
+    WalkTable(red_, walk_ref_2);
+    WalkTable(purple_, walk_ref_3);
+    WalkTable(purple_, walk_ref_4);
+    EnableWalkProcessing();
+
+    TASK_UTIL_EXPECT_EQ(3, current_done_seq_);
+    TASK_UTIL_EXPECT_TRUE(walk_done_1_);
+    TASK_UTIL_EXPECT_EQ(3, walk_count_);
+    TASK_UTIL_EXPECT_EQ(1, walk_count_1_);
+    // Ensure that purple table is walked only once
+    TASK_UTIL_EXPECT_EQ(1, purple_->walk_count());
+    TASK_UTIL_EXPECT_EQ(1, purple_->walk_complete_count());
+    TASK_UTIL_EXPECT_EQ(1, red_->walk_count());
+    TASK_UTIL_EXPECT_EQ(1, blue_->walk_count());
+
+    DeleteInetRoute(red_, "11.1.1.0/24");
+    DeleteInetRoute(blue_, "22.2.2.0/24");
+    DeleteInetRoute(purple_, "33.3.3.0/24");
+}
+
 class TestEnvironment : public ::testing::Environment {
     virtual ~TestEnvironment() { }
 };
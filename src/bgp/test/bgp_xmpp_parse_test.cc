@@ -8,6 +8,8 @@
 #include "bgp/bgp_log.h"
 #include "bgp/bgp_server.h"
 #include "bgp/bgp_xmpp_channel.h"
+#include "bgp/bgp_xmpp_item_decoder.h"
+#include "schema/xmpp_unicast_types.h"
 #include "xml/xml_pugi.h"
 #include "testing/gunit.h"
 
@@ -15,6 +17,7 @@ using std::auto_ptr;
 using std::ifstream;
 using std::istreambuf_iterator;
 using std::string;
+using std::vector;
 using pugi::xml_node;
 
 class XmppChannelMock : public XmppChannel {
@@ -152,6 +155,58 @@ protected:
         return bx_channel_->ProcessEnetItem("blue", item, true);
     }
 
+    // Decode the item with BgpXmppInetItem and with the generated parser
+    // and verify that both produce the same values.
+    void VerifyInetItemDecode(const xml_node &node) {
+        BgpXmppInetItem item;
+        EXPECT_TRUE(item.Decode(node));
+        autogen::ItemType expected;
+        expected.Clear();
+        EXPECT_TRUE(expected.XmlParse(node));
+
+        EXPECT_EQ(expected.entry.nlri.af, item.entry.nlri.af);
+        EXPECT_EQ(expected.entry.nlri.safi, item.entry.nlri.safi);
+        EXPECT_EQ(expected.entry.nlri.address, item.entry.nlri.address);
+        EXPECT_EQ(expected.entry.version, item.entry.version);
+        EXPECT_EQ(expected.entry.virtual_network, item.entry.virtual_network);
+        EXPECT_EQ(expected.entry.sequence_number, item.entry.sequence_number);
+        EXPECT_EQ(expected.entry.local_preference,
+                  item.entry.local_preference);
+        EXPECT_EQ(expected.entry.med, item.entry.med);
+        EXPECT_EQ(expected.entry.sub_protocol, item.entry.sub_protocol);
+        EXPECT_EQ(expected.entry.security_group_list.security_group.size(),
+                  item.entry.security_group_list.size());
+        for (size_t idx = 0; idx < item.entry.security_group_list.size();
+             ++idx) {
+            EXPECT_EQ(expected.entry.security_group_list.security_group[idx],
+                      item.entry.security_group_list[idx]);
+        }
+        EXPECT_EQ(expected.entry.community_tag_list.community_tag.size(),
+                  item.entry.community_tag_list.size());
+        for (size_t idx = 0; idx < item.entry.community_tag_list.size();
+             ++idx) {
+            EXPECT_EQ(expected.entry.community_tag_list.community_tag[idx],
+                      item.entry.community_tag_list[idx]);
+        }
+
+        ASSERT_EQ(expected.entry.next_hops.next_hop.size(),
+                  item.entry.next_hops.next_hop.size());
+        for (size_t idx = 0; idx < item.entry.next_hops.next_hop.size();
+             ++idx) {
+            const autogen::NextHopType &enh =
+                expected.entry.next_hops.next_hop[idx];
+            const BgpXmppInetItem::NextHop &nh =
+                item.entry.next_hops.next_hop[idx];
+            EXPECT_EQ(enh.af, nh.af);
+            EXPECT_EQ(enh.address, nh.address);
+            EXPECT_EQ(enh.label, nh.label);
+            EXPECT_EQ(enh.tunnel_encapsulation_list.tunnel_encapsulation,
+                      vector<string>(nh.tunnel_encapsulation_list.begin(),
+                                     nh.tunnel_encapsulation_list.end()));
+            EXPECT_EQ(enh.tag_list.tag, nh.tag_list);
+        }
+    }
+
     EventManager evm_;
     BgpServer server_;
     auto_ptr<XmlBase> impl_;
@@ -256,6 +311,105 @@ TEST_F(BgpXmppParseTest, Inet6ItemError6) {
      EXPECT_FALSE(ProcessInet6Item(item));
 }
 
+// Decoded inet item matches the generated parser.
+TEST_F(BgpXmppParseTest, InetItemDecode) {
+     string data = FileRead("controller/src/bgp/testdata/good_inet_item_1.xml");
+     impl_->LoadDoc(data);
+     xml_node node = pugi_->FindNode("item");
+     VerifyInetItemDecode(node);
+
+     BgpXmppInetItem item;
+     EXPECT_TRUE(item.Decode(node));
+     Ip4Address addr;
+     int prefixlen;
+     EXPECT_TRUE(item.DecodePrefix(&addr, &prefixlen));
+     EXPECT_EQ(Ip4Address::from_string("10.1.1.0"), addr);
+     EXPECT_EQ(24, prefixlen);
+}
+
+// Decoded inet6 item matches the generated parser.
+TEST_F(BgpXmppParseTest, Inet6ItemDecode) {
+     string data = FileRead("controller/src/bgp/testdata/good_inet6_item_1.xml");
+     impl_->LoadDoc(data);
+     xml_node node = pugi_->FindNode("item");
+     VerifyInetItemDecode(node);
+
+     BgpXmppInetItem item;
+     EXPECT_TRUE(item.Decode(node));
+     Ip6Address addr;
+     int prefixlen;
+     EXPECT_TRUE(item.DecodePrefix(&addr, &prefixlen));
+     EXPECT_EQ(Ip6Address::from_string("abcd::"), addr);
+     EXPECT_EQ(64, prefixlen);
+}
+
+// The host bits of the prefix are cleared, as done by Ip4Prefix::FromString
+// and Inet6Prefix::FromString.
+TEST_F(BgpXmppParseTest, InetItemDecodeHostBits) {
+     string data = FileRead("controller/src/bgp/testdata/good_inet_item_1.xml");
+     impl_->LoadDoc(data);
+     BgpXmppInetItem item;
+     EXPECT_TRUE(item.Decode(pugi_->FindNode("item")));
+
+     Ip4Address addr;
+     int prefixlen;
+     item.entry.nlri.address = "10.1.1.5/24";
+     EXPECT_TRUE(item.DecodePrefix(&addr, &prefixlen));
+     EXPECT_EQ(Ip4Address::from_string("10.1.1.0"), addr);
+     EXPECT_EQ(24, prefixlen);
+     item.entry.nlri.address = "10.1.1.5/0";
+     EXPECT_TRUE(item.DecodePrefix(&addr, &prefixlen));
+     EXPECT_EQ(Ip4Address::from_string("0.0.0.0"), addr);
+     EXPECT_EQ(0, prefixlen);
+     item.entry.nlri.address = "10.1.1.5/32";
+     EXPECT_TRUE(item.DecodePrefix(&addr, &prefixlen));
+     EXPECT_EQ(Ip4Address::from_string("10.1.1.5"), addr);
+
+     Ip6Address addr6;
+     item.entry.nlri.address = "abcd::1:2:3/64";
+     EXPECT_TRUE(item.DecodePrefix(&addr6, &prefixlen));
+     EXPECT_EQ(Ip6Address::from_string("abcd::"), addr6);
+     EXPECT_EQ(64, prefixlen);
+     item.entry.nlri.address = "abcd:ffff::1/20";
+     EXPECT_TRUE(item.DecodePrefix(&addr6, &prefixlen));
+     EXPECT_EQ(Ip6Address::from_string("abcd:f000::"), addr6);
+     EXPECT_EQ(20, prefixlen);
+}
+
+// Decoder rejects the same fields as the generated parser and the prefix
+// parser.
+TEST_F(BgpXmppParseTest, InetItemDecodeError) {
+     string data = FileRead("controller/src/bgp/testdata/bad_inet_item_1.xml");
+     impl_->LoadDoc(data);
+     BgpXmppInetItem item1;
+     EXPECT_FALSE(item1.Decode(pugi_->FindNode("item")));
+
+     data = FileRead("controller/src/bgp/testdata/bad_inet_item_3.xml");
+     impl_->LoadDoc(data);
+     BgpXmppInetItem item2;
+     EXPECT_TRUE(item2.Decode(pugi_->FindNode("item")));
+     Ip4Address addr;
+     int prefixlen;
+     EXPECT_FALSE(item2.DecodePrefix(&addr, &prefixlen));
+
+     data = FileRead("controller/src/bgp/testdata/bad_inet6_item_3.xml");
+     impl_->LoadDoc(data);
+     BgpXmppInetItem item3;
+     EXPECT_TRUE(item3.Decode(pugi_->FindNode("item")));
+     Ip6Address addr6;
+     EXPECT_FALSE(item3.DecodePrefix(&addr6, &prefixlen));
+
+     // Prefix length out of range or missing.
+     item3.entry.nlri.address = "10.1.1.1/33";
+     EXPECT_FALSE(item3.DecodePrefix(&addr, &prefixlen));
+     item3.entry.nlri.address = "10.1.1.1/";
+     EXPECT_FALSE(item3.DecodePrefix(&addr, &prefixlen));
+     item3.entry.nlri.address = "10.1.1.1";
+     EXPECT_FALSE(item3.DecodePrefix(&addr, &prefixlen));
+     item3.entry.nlri.address = "abcd::1/129";
+     EXPECT_FALSE(item3.DecodePrefix(&addr6, &prefixlen));
+}
+
 // Error in parsing message, XML document is fine.
 TEST_F(BgpXmppParseTest, McastItemError1) {
      string data = FileRead("controller/src/bgp/testdata/bad_mcast_item_1.xml");
@@ -682,6 +682,50 @@ TEST_F(ReplicationTest, SourceRD) {
     VERIFY_EQ(0, RouteCount("red"));
 }
 
+//
+// Verify that replicating a path from the vpn table, which updates both the
+// extended community and the source RD, copies the attribute at most once.
+//
+TEST_F(ReplicationTest, AttributeClones) {
+    vector<string> instance_names = list_of("blue")("red")("green");
+    multimap<string, string> connections = map_list_of("blue", "red");
+    NetworkConfig(instance_names, connections);
+    task_util::WaitForIdle();
+
+    boost::system::error_code ec;
+    peers_.push_back(
+        new BgpPeerMock(Ip4Address::from_string("192.168.0.1", ec)));
+
+    const RoutePathReplicator *replicator =
+        bgp_server_->replicator(Address::INETVPN);
+    uint64_t replicated = replicator->replicated_path_count();
+    uint64_t clones = bgp_server_->attr_db()->clone_count();
+
+    for (int idx = 1; idx <= 16; ++idx) {
+        string prefix = "192.168.0.1:1:10.0.1." + integerToString(idx) + "/32";
+        AddVPNRoute(peers_[0], prefix, 100, list_of("blue"));
+    }
+    task_util::WaitForIdle();
+    VERIFY_EQ(16, RouteCount("blue"));
+    VERIFY_EQ(16, RouteCount("red"));
+
+    replicated = replicator->replicated_path_count() - replicated;
+    clones = bgp_server_->attr_db()->clone_count() - clones;
+    cout << "Replicated paths " << replicated << " Attribute clones " <<
+        clones << " Clones per replicated path " <<
+        (replicated ? static_cast<double>(clones) / replicated : 0) << endl;
+    EXPECT_EQ(32, replicated);
+    EXPECT_LE(clones, replicated);
+
+    for (int idx = 1; idx <= 16; ++idx) {
+        string prefix = "192.168.0.1:1:10.0.1." + integerToString(idx) + "/32";
+        DeleteVPNRoute(peers_[0], prefix);
+    }
+    task_util::WaitForIdle();
+    VERIFY_EQ(0, RouteCount("blue"));
+    VERIFY_EQ(0, RouteCount("red"));
+}
+
 TEST_F(ReplicationTest, Delete) {
     vector<string> instance_names = list_of("blue")("red")("green");
     multimap<string, string> connections = map_list_of("blue", "red");
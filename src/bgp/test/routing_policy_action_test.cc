@@ -4,6 +4,7 @@
 
 
 #include <boost/assign/list_of.hpp>
+#include <boost/foreach.hpp>
 
 #include "base/test/task_test_util.h"
 #include "bgp/bgp_log.h"
@@ -41,8 +42,9 @@ TEST_F(UpdateExtCommunityTest, Update) {
     BgpAttrSpec spec;
     spec.push_back(&comm_spec);
     BgpAttrPtr attr = attr_db_->Locate(spec);
-    action(const_cast<BgpAttr *>(attr.get()));
-    const ExtCommunity *comm = attr->ext_community();
+    BgpAttrBuilder builder(attr_db_, attr.get());
+    action(&builder);
+    const ExtCommunity *comm = builder.get()->ext_community();
     EXPECT_TRUE(comm!= NULL);
     EXPECT_TRUE(comm->communities().size() == 2);
     RouteTarget val0 = RouteTarget(comm->communities()[0]);
@@ -52,8 +54,8 @@ TEST_F(UpdateExtCommunityTest, Update) {
 
     communities = list_of("target:33:11")("target:53:11");
     UpdateExtCommunity action2(communities, "set");
-    action2(const_cast<BgpAttr *>(attr.get()));
-    comm = attr->ext_community();
+    action2(&builder);
+    comm = builder.get()->ext_community();
     EXPECT_TRUE(comm!= NULL);
     EXPECT_TRUE(comm->communities().size() == 2);
     val0 = RouteTarget(comm->communities()[0]);
@@ -63,12 +65,41 @@ TEST_F(UpdateExtCommunityTest, Update) {
 
     vector<string> communities2 = list_of("target:53:11");
     UpdateExtCommunity action3(communities2, "remove");
-    action3(const_cast<BgpAttr *>(attr.get()));
-    comm = attr->ext_community();
+    action3(&builder);
+    comm = builder.get()->ext_community();
     EXPECT_TRUE(comm!= NULL);
     EXPECT_TRUE(comm->communities().size() == 1);
     val0 = RouteTarget(comm->communities()[0]);
     EXPECT_TRUE(val0.ToString() == communities[0]);
+
+    // All the updates are made to a single copy of the attribute.
+    uint64_t clones = attr_db_->clone_count();
+    BgpAttrPtr new_attr = builder.Locate();
+    EXPECT_EQ(clones, attr_db_->clone_count());
+    EXPECT_NE(attr, new_attr);
+    EXPECT_EQ(comm, new_attr->ext_community());
+}
+
+// An update that leaves the attribute unchanged does not copy it.
+TEST_F(UpdateExtCommunityTest, UpdateNoChange) {
+    vector<string> communities = list_of("target:23:11")("target:43:11");
+    UpdateExtCommunity action(communities, "add");
+
+    ExtCommunitySpec comm_spec;
+    BOOST_FOREACH(const string &community, communities) {
+        comm_spec.communities.push_back(
+            RouteTarget::FromString(community).GetExtCommunityValue());
+    }
+    BgpAttrSpec spec;
+    spec.push_back(&comm_spec);
+    BgpAttrPtr attr = attr_db_->Locate(spec);
+
+    uint64_t clones = attr_db_->clone_count();
+    BgpAttrBuilder builder(attr_db_, attr.get());
+    action(&builder);
+    EXPECT_FALSE(builder.modified());
+    EXPECT_EQ(attr, builder.Locate());
+    EXPECT_EQ(clones, attr_db_->clone_count());
 }
 
 TEST_F(UpdateExtCommunityTest, ToString) {
@@ -141,9 +172,11 @@ TEST_F(UpdateAsPathTest, UpdateNull) {
     UpdateAsPath action(asn_list);
     EXPECT_EQ(asn_list, action.asn_list());
 
-    BgpAttr attr(attr_db_);
-    action(&attr);
-    const AsPath4Byte *as_path = attr.aspath_4byte();
+    BgpAttrSpec spec;
+    BgpAttrPtr attr = attr_db_->Locate(spec);
+    BgpAttrBuilder builder(attr_db_, attr.get());
+    action(&builder);
+    const AsPath4Byte *as_path = builder.Locate()->aspath_4byte();
     EXPECT_TRUE(as_path != NULL);
     const AsPath4ByteSpec &as_path_spec = as_path->path();
     EXPECT_EQ(1, as_path_spec.path_segments.size());
@@ -165,9 +198,10 @@ TEST_F(UpdateAsPathTest, UpdateNonNull) {
     path.path_segments.push_back(ps);
     spec.push_back(&path);
 
-    BgpAttr attr(attr_db_, spec);
-    action(&attr);
-    const AsPath4Byte *as_path = attr.aspath_4byte();
+    BgpAttrPtr attr = attr_db_->Locate(spec);
+    BgpAttrBuilder builder(attr_db_, attr.get());
+    action(&builder);
+    const AsPath4Byte *as_path = builder.Locate()->aspath_4byte();
     EXPECT_TRUE(as_path != NULL);
     const AsPath4ByteSpec &as_path_spec = as_path->path();
     EXPECT_EQ(1, as_path_spec.path_segments.size());
@@ -4,8 +4,11 @@
 
 
 #include <boost/assign/list_of.hpp>
+#include <boost/foreach.hpp>
 
+#include "base/string_util.h"
 #include "base/test/task_test_util.h"
+#include "base/time_util.h"
 #include "bgp/bgp_config.h"
 #include "bgp/bgp_log.h"
 #include "bgp/bgp_path.h"
@@ -16,6 +19,10 @@
 #include "net/community_type.h"
 
 using boost::assign::list_of;
+using contrail::regex;
+using contrail::regex_match;
+using std::cout;
+using std::endl;
 using std::find;
 using std::string;
 
@@ -810,6 +817,68 @@ TEST_F(MatchCommunityTest, MatchAny3) {
     EXPECT_FALSE(match.Match(NULL, NULL, attr.get()));
 }
 
+//
+// Compare matching a large list of community regexs with the combined regex
+// against trying each regex in turn.
+//
+TEST_F(MatchCommunityTest, Performance) {
+    int regex_count = 256;
+    int community_count = 32;
+    int repeat_count = 200;
+
+    vector<string> communities;
+    for (int idx = 0; idx < regex_count; ++idx) {
+        communities.push_back(integerToString(1000 + idx) + ":1.*");
+    }
+    MatchCommunity match(communities, false);
+
+    // None of the communities match except possibly the last one.
+    CommunitySpec comm_spec;
+    for (int idx = 0; idx < community_count; ++idx) {
+        comm_spec.communities.push_back(CommunityType::CommunityFromString(
+            integerToString(2000 + idx) + ":100"));
+    }
+    BgpAttrSpec spec;
+    spec.push_back(&comm_spec);
+    BgpAttrPtr attr_nomatch = attr_db_->Locate(spec);
+    comm_spec.communities.push_back(CommunityType::CommunityFromString(
+        integerToString(1000 + regex_count - 1) + ":100"));
+    BgpAttrPtr attr_match = attr_db_->Locate(spec);
+    vector<BgpAttrPtr> attrs = list_of(attr_nomatch)(attr_match);
+
+    uint64_t start = ClockMonotonicUsec();
+    for (int idx = 0; idx < repeat_count; ++idx) {
+        EXPECT_FALSE(match.Match(NULL, NULL, attr_nomatch.get()));
+        EXPECT_TRUE(match.Match(NULL, NULL, attr_match.get()));
+    }
+    uint64_t combined_time = ClockMonotonicUsec() - start;
+
+    start = ClockMonotonicUsec();
+    for (int idx = 0; idx < repeat_count; ++idx) {
+        BOOST_FOREACH(const BgpAttrPtr &attr, attrs) {
+            bool matched = false;
+            BOOST_FOREACH(uint32_t value, attr->community()->communities()) {
+                string value_str = CommunityType::CommunityToString(value);
+                BOOST_FOREACH(const regex &match_expr, match.regexs()) {
+                    if (regex_match(value_str, match_expr)) {
+                        matched = true;
+                        break;
+                    }
+                }
+                if (matched)
+                    break;
+            }
+            EXPECT_EQ(attr == attr_match, matched);
+        }
+    }
+    uint64_t linear_time = ClockMonotonicUsec() - start;
+
+    cout << repeat_count << " x 2 attributes x " << community_count
+         << " communities x " << regex_count << " regexs" << endl;
+    cout << "    Each regex     : " << linear_time << " usec" << endl;
+    cout << "    Combined regex : " << combined_time << " usec" << endl;
+}
+
 // Parameterize match-all vs. match-any in MatchCommunity.
 class MatchCommunityParamTest:
     public MatchCommunityTest,
@@ -1769,6 +1838,26 @@ protected:
         EXPECT_EQ(size, match->match_list_.size());
     }
 
+    // Match the prefix by walking the match list.
+    bool LinearMatch(const MatchPrefixT *match, const PrefixT &prefix) {
+        typedef typename MatchPrefixT::PrefixMatch PrefixMatch;
+        BOOST_FOREACH(const PrefixMatch &prefix_match, match->match_list_) {
+            if (prefix_match.match_type == MatchPrefixT::EXACT) {
+                if (prefix == prefix_match.prefix)
+                    return true;
+            } else if (prefix_match.match_type == MatchPrefixT::LONGER) {
+                if (prefix == prefix_match.prefix)
+                    continue;
+                if (prefix.IsMoreSpecific(prefix_match.prefix))
+                    return true;
+            } else if (prefix_match.match_type == MatchPrefixT::ORLONGER) {
+                if (prefix.IsMoreSpecific(prefix_match.prefix))
+                    return true;
+            }
+        }
+        return false;
+    }
+
     void VerifyPrefixMatchExists(const MatchPrefixT *match_prefix,
         const string &match_prefix_str, const string &match_type_str) {
         boost::system::error_code ec;
@@ -2029,6 +2118,68 @@ TYPED_TEST(MatchPrefixTest, Match) {
     EXPECT_FALSE(match.Match(&route8, NULL, NULL));
 }
 
+//
+// Compare matching routes against a large prefix list using the trie with
+// walking the list. The prefixes in the list have exact, longer and orlonger
+// match types, and a quarter of the routes fall within the list.
+//
+TYPED_TEST(MatchPrefixTest, Performance) {
+    int prefix_count = 4096;
+    int route_count = 16 * 1024;
+    const char *match_types[] = { "exact", "longer", "orlonger" };
+
+    PrefixMatchConfigList cfg_list;
+    for (int idx = 0; idx < prefix_count; ++idx) {
+        string addr = "10." + integerToString(idx / 16) + "." +
+            integerToString((idx % 16) * 16) + ".0";
+        cfg_list.push_back(PrefixMatchConfig(
+            this->BuildPrefix(addr, 20), match_types[idx % 3]));
+    }
+    typename TestFixture::MatchPrefixT match(cfg_list);
+    this->VerifyPrefixMatchListSize(&match, prefix_count);
+
+    vector<typename TestFixture::RouteT *> routes;
+    for (int idx = 0; idx < route_count; ++idx) {
+        int first = (idx % 4 == 0) ? 10 : 11;
+        int plen = 16 + (idx % 3) * 4;
+        string addr = integerToString(first) + "." +
+            integerToString((idx / 4) % 256) + "." +
+            integerToString(((idx / 4) / 256) * 16 % 256) + ".0";
+        typename TestFixture::PrefixT prefix =
+            TestFixture::PrefixT::FromString(this->BuildPrefix(addr, plen));
+        routes.push_back(new typename TestFixture::RouteT(prefix));
+    }
+
+    int trie_matches = 0;
+    uint64_t start = ClockMonotonicUsec();
+    BOOST_FOREACH(typename TestFixture::RouteT *route, routes) {
+        if (match.Match(route, NULL, NULL))
+            trie_matches++;
+    }
+    uint64_t trie_time = ClockMonotonicUsec() - start;
+
+    int linear_matches = 0;
+    start = ClockMonotonicUsec();
+    BOOST_FOREACH(typename TestFixture::RouteT *route, routes) {
+        if (this->LinearMatch(&match, route->GetPrefix()))
+            linear_matches++;
+    }
+    uint64_t linear_time = ClockMonotonicUsec() - start;
+    EXPECT_EQ(linear_matches, trie_matches);
+
+    BOOST_FOREACH(typename TestFixture::RouteT *route, routes) {
+        EXPECT_EQ(this->LinearMatch(&match, route->GetPrefix()),
+                  match.Match(route, NULL, NULL));
+    }
+    EXPECT_NE(0, trie_matches);
+
+    cout << route_count << " routes x " << prefix_count << " prefixes, "
+         << trie_matches << " matches" << endl;
+    cout << "    Match list : " << linear_time << " usec" << endl;
+    cout << "    Trie       : " << trie_time << " usec" << endl;
+    STLDeleteValues(&routes);
+}
+
 static void SetUp() {
     bgp_log_test::init();
     ControlNode::SetDefaultSchedulingPolicy();
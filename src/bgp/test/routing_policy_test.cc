@@ -9,6 +9,7 @@
 #include <boost/foreach.hpp>
 #include <boost/assign/list_of.hpp>
 
+#include "base/string_util.h"
 #include "bgp/bgp_config_ifmap.h"
 #include "bgp/bgp_config_parser.h"
 #include "bgp/bgp_factory.h"
@@ -467,6 +468,59 @@ TEST_F(RoutingPolicyTest, PolicyMultiplePrefixMatchUpdateLocalPref) {
     DeleteRoute<InetDefinition>(peers_[0], "test.inet.0", "30.1.1.1/32");
 }
 
+//
+// Routes that share an attribute and match the same prefix match conditions
+// get the memoized result of the policy.
+//
+TEST_F(RoutingPolicyTest, PolicyResultCache) {
+    string content =
+        FileRead("controller/src/bgp/testdata/routing_policy_0.xml");
+    EXPECT_TRUE(parser_.Parse(content));
+    task_util::WaitForIdle();
+
+    boost::system::error_code ec;
+    peers_.push_back(
+        new BgpPeerMock(Ip4Address::from_string("192.168.0.1", ec)));
+
+    const RoutingPolicy *policy = FindRoutingPolicy("basic");
+    ASSERT_TRUE(policy != NULL);
+    uint64_t hits = policy->result_cache_hits();
+    uint64_t misses = policy->result_cache_misses();
+
+    int route_count = 256;
+    AddRoute<InetDefinition>(peers_[0], "test.inet.0", "10.0.1.1/32", 100);
+    for (int idx = 0; idx < route_count; ++idx) {
+        string prefix = "10.1." + integerToString(idx) + ".1/32";
+        AddRoute<InetDefinition>(peers_[0], "test.inet.0", prefix, 100);
+    }
+    task_util::WaitForIdle();
+    VERIFY_EQ(route_count + 1, RouteCount("test.inet.0"));
+
+    BgpRoute *rt = RouteLookup<InetDefinition>("test.inet.0", "10.0.1.1/32");
+    ASSERT_TRUE(rt != NULL);
+    ASSERT_TRUE(rt->BestPath()->GetAttr()->local_pref() == 102);
+    for (int idx = 0; idx < route_count; ++idx) {
+        string prefix = "10.1." + integerToString(idx) + ".1/32";
+        rt = RouteLookup<InetDefinition>("test.inet.0", prefix);
+        ASSERT_TRUE(rt != NULL);
+        ASSERT_TRUE(rt->BestPath()->GetAttr()->local_pref() == 100);
+    }
+
+    // Each partition evaluates the policy at most once for the routes that
+    // don't match the prefix, and once for the route that does.
+    uint64_t new_hits = policy->result_cache_hits() - hits;
+    uint64_t new_misses = policy->result_cache_misses() - misses;
+    EXPECT_EQ(static_cast<uint64_t>(route_count + 1), new_hits + new_misses);
+    EXPECT_GE(static_cast<uint64_t>(DB::PartitionCount() + 1), new_misses);
+    EXPECT_NE(0U, bgp_server_->routing_policy_mgr()->result_cache_size());
+
+    DeleteRoute<InetDefinition>(peers_[0], "test.inet.0", "10.0.1.1/32");
+    for (int idx = 0; idx < route_count; ++idx) {
+        string prefix = "10.1." + integerToString(idx) + ".1/32";
+        DeleteRoute<InetDefinition>(peers_[0], "test.inet.0", prefix);
+    }
+}
+
 TEST_F(RoutingPolicyTest, PolicyProtocolMatchUpdateLocalPref) {
     string content =
         FileRead("controller/src/bgp/testdata/routing_policy_0e.xml");
@@ -2,9 +2,11 @@
  * Copyright (c) 2016 Juniper Networks, Inc. All rights reserved.
  */
 
+#include "base/time_util.h"
 #include "bgp/bgp_factory.h"
 #include "bgp/bgp_ribout.h"
 #include "bgp/bgp_ribout_updates.h"
+#include "bgp/message_cache.h"
 #include "bgp/xmpp_message_builder.h"
 #include "bgp/inet/inet_route.h"
 #include "bgp/mvpn/mvpn_route.h"
@@ -275,6 +277,112 @@ INSTANTIATE_TEST_CASE_P(LongPeerName, XmppMessageBuilderParamTest,
     ::testing::Combine(
         ::testing::Values(true), ::testing::Values(false), ::testing::Bool()));
 
+//
+// Build the same routes for several RibOuts, each with its own copy of the
+// RibOutAttrs as is the case for RibOuts with different export policies.
+// Verify that the MessageCache shared by the RibOuts produces the same
+// message and compare the time taken with and without the cache.
+//
+class XmppMessageCacheTest : public XmppMessageBuilderTest {
+protected:
+    static const int kRibOutCount = 8;
+    static const int kCacheRepeatCount = 256;
+
+    virtual void SetUp() {
+        XmppMessageBuilderTest::SetUp();
+        for (int ro_idx = 0; ro_idx < kRibOutCount; ++ro_idx) {
+            for (int ridx = 0; ridx < kRouteCount; ++ridx) {
+                ribout_roattrs_.push_back(new RibOutAttr(*roattrs_[ridx]));
+            }
+        }
+    }
+
+    virtual void TearDown() {
+        STLDeleteValues(&ribout_roattrs_);
+        XmppMessageBuilderTest::TearDown();
+    }
+
+    const RibOutAttr *GetRibOutAttr(int ro_idx, int ridx) {
+        return ribout_roattrs_[ro_idx * kRouteCount + ridx];
+    }
+
+    string BuildMessage(int ro_idx, MessageCache *cache) {
+        message_->set_cache(cache);
+        message_->Start(ribout_, false, GetRibOutAttr(ro_idx, 0), routes_[0]);
+        for (int ridx = 1; ridx < kRouteCount; ++ridx) {
+            message_->AddRoute(routes_[ridx], GetRibOutAttr(ro_idx, ridx));
+        }
+        message_->Finish();
+        message_->set_cache(NULL);
+
+        XmppTestPeer peer("agent.juniper.net");
+        size_t msgsize;
+        const string *msg_str = NULL;
+        string temp;
+        const uint8_t *msg =
+            message_->GetData(&peer, &msgsize, &msg_str, &temp);
+        return string(reinterpret_cast<const char *>(msg), msgsize);
+    }
+
+    uint64_t BuildMessages(MessageCache *cache) {
+        uint64_t start = ClockMonotonicUsec();
+        for (int idx = 0; idx < kCacheRepeatCount; ++idx) {
+            if (cache)
+                cache->Enable();
+            for (int ro_idx = 0; ro_idx < kRibOutCount; ++ro_idx) {
+                BuildMessage(ro_idx, cache);
+            }
+            if (cache)
+                cache->Clear();
+        }
+        return ClockMonotonicUsec() - start;
+    }
+
+    vector<RibOutAttr *> ribout_roattrs_;
+};
+
+TEST_F(XmppMessageCacheTest, Basic) {
+    MessageCache cache;
+    size_t route_count = kRouteCount;
+    string expected = BuildMessage(0, NULL);
+
+    // Nothing is cached till the cache is enabled.
+    EXPECT_EQ(expected, BuildMessage(0, &cache));
+    EXPECT_EQ(0U, cache.size());
+
+    cache.Enable();
+    EXPECT_EQ(expected, BuildMessage(0, &cache));
+    EXPECT_EQ(route_count, cache.size());
+    EXPECT_EQ(0U, cache.hit_count());
+    EXPECT_EQ(route_count, cache.miss_count());
+    EXPECT_EQ(route_count, message_->num_cache_misses());
+    for (int ro_idx = 1; ro_idx < kRibOutCount; ++ro_idx) {
+        EXPECT_EQ(expected, BuildMessage(ro_idx, &cache));
+        EXPECT_EQ(route_count, message_->num_cache_hits());
+        EXPECT_EQ(0U, message_->num_cache_misses());
+    }
+    EXPECT_EQ((kRibOutCount - 1) * route_count, cache.hit_count());
+
+    cache.Clear();
+    EXPECT_FALSE(cache.enabled());
+    EXPECT_EQ(0U, cache.size());
+}
+
+TEST_F(XmppMessageCacheTest, Performance) {
+    MessageCache cache;
+    uint64_t no_cache_time = BuildMessages(NULL);
+    uint64_t cache_time = BuildMessages(&cache);
+    uint64_t lookups = cache.hit_count() + cache.miss_count();
+    EXPECT_EQ(static_cast<uint64_t>(
+        kCacheRepeatCount * kRibOutCount * kRouteCount), lookups);
+
+    cout << kCacheRepeatCount << " x " << kRibOutCount << " RibOuts x "
+         << kRouteCount << " routes" << endl;
+    cout << "    No cache : " << no_cache_time << " usec" << endl;
+    cout << "    Cache    : " << cache_time << " usec, hit rate "
+         << (cache.hit_count() * 100 / lookups) << "%" << endl;
+}
+
 class TestEnvironment : public ::testing::Environment {
     virtual ~TestEnvironment() { }
     virtual void SetUp() {
@@ -11,6 +11,7 @@
 #include "bgp/ipeer.h"
 #include "bgp/bgp_server.h"
 #include "bgp/bgp_table.h"
+#include "bgp/message_cache.h"
 #include "bgp/extended-community/etree.h"
 #include "bgp/extended-community/mac_mobility.h"
 #include "bgp/ermvpn/ermvpn_route.h"
@@ -201,12 +202,49 @@ void BgpXmppMessage::EncodeNextHop(const BgpRoute *route,
     item->entry.next_hops.next_hop.push_back(item_nexthop);
 }
 
-void BgpXmppMessage::AddIpReach(const BgpRoute *route,
-                                const RibOutAttr *roattr) {
+//
+// Append the string representation of the route if it's already cached in
+// the RibOutAttr or in the MessageCache shared with other RibOuts.
+//
+// Return false if the route needs to be encoded.
+//
+bool BgpXmppMessage::AddCachedRoute(const BgpRoute *route,
+                                    const RibOutAttr *roattr) {
     if (!roattr->repr().empty()) {
         repr_ += roattr->repr();
-        return;
+        return true;
     }
+    if (!cache_ || !cache_->enabled())
+        return false;
+
+    const string *repr = cache_->Find(route, roattr, RibExportPolicy::XMPP);
+    if (!repr) {
+        num_cache_miss_++;
+        return false;
+    }
+    num_cache_hit_++;
+    repr_ += *repr;
+    if (cache_routes_)
+        roattr->set_repr(*repr);
+    return true;
+}
+
+//
+// Cache the string representation of the route, which is the substring of
+// repr_ starting at pos.
+//
+void BgpXmppMessage::CacheRoute(const BgpRoute *route,
+                                const RibOutAttr *roattr, size_t pos) {
+    if (cache_routes_)
+        roattr->set_repr(repr_, pos);
+    if (cache_ && cache_->enabled())
+        cache_->Add(route, roattr, RibExportPolicy::XMPP, repr_, pos);
+}
+
+void BgpXmppMessage::AddIpReach(const BgpRoute *route,
+                                const RibOutAttr *roattr) {
+    if (AddCachedRoute(route, roattr))
+        return;
     Address::Family family = table_->family();
 
     autogen::ItemType item;
@@ -254,8 +292,7 @@ void BgpXmppMessage::AddIpReach(const BgpRoute *route,
     doc_.remove_child(node);
 
     // Cache the substring starting at the previous size.
-    if (cache_routes_)
-        roattr->set_repr(repr_, pos);
+    CacheRoute(route, roattr, pos);
 }
 
 void BgpXmppMessage::AddIpUnreach(const BgpRoute *route) {
@@ -312,10 +349,8 @@ void BgpXmppMessage::EncodeEnetNextHop(const BgpRoute *route,
 
 void BgpXmppMessage::AddEnetReach(const BgpRoute *route,
                                   const RibOutAttr *roattr) {
-    if (!roattr->repr().empty()) {
-        repr_ += roattr->repr();
+    if (AddCachedRoute(route, roattr))
         return;
-    }
     Address::Family family = table_->family();
 
     autogen::EnetItemType item;
@@ -391,8 +426,7 @@ void BgpXmppMessage::AddEnetReach(const BgpRoute *route,
     doc_.remove_child(node);
 
     // Cache the substring starting at the previous size.
-    if (cache_routes_)
-        roattr->set_repr(repr_, pos);
+    CacheRoute(route, roattr, pos);
 }
 
 void BgpXmppMessage::AddEnetUnreach(const BgpRoute *route) {
@@ -69,6 +69,9 @@ private:
     };
 
     virtual void Reset();
+    bool AddCachedRoute(const BgpRoute *route, const RibOutAttr *roattr);
+    void CacheRoute(const BgpRoute *route, const RibOutAttr *roattr,
+                    size_t pos);
     void EncodeNextHop(const BgpRoute *route,
                        const RibOutAttr::NextHop &nexthop,
                        autogen::ItemType *item);
@@ -36,6 +36,7 @@
 #include "control-node/control_node.h"
 #include "control-node/options.h"
 #include "db/db_graph.h"
+#include "db/db_table_walk_mgr.h"
 #include "ifmap/client/config_json_parser.h"
 #include "ifmap/ifmap_link_table.h"
 #include "ifmap/ifmap_sandesh_context.h"
@@ -67,6 +68,10 @@ using process::Signal;
 static EventManager evm;
 static Options options;
 
+// Number of bgp tables walked at the same time. Each routing instance has a
+// set of tables, so walks triggered by a config change usually span tables.
+static const uint32_t kMaxConcurrentTableWalks = 4;
+
 static string FileRead(const char *filename) {
     ifstream file(filename);
     string content((istreambuf_iterator<char>(file)),
@@ -274,6 +279,8 @@ int main(int argc, char *argv[]) {
     sandesh_context.bgp_server = bgp_server.get();
     bgp_server->set_gr_helper_disable(options.gr_helper_bgp_disable());
     bgp_server->set_mvpn_ipv4_enable(options.mvpn_ipv4_enable());
+    bgp_server->database()->GetWalkMgr()->SetMaxConcurrentWalks(
+        kMaxConcurrentTableWalks);
 
     ConnectionStateManager::GetInstance();
 
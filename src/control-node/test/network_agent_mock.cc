@@ -958,9 +958,10 @@ public:
         tbb::mutex::scoped_lock lock(mutex_);
         XmppChannelMux::UnRegisterReceive(id);
     }
-    void ProcessXmppMessage(const XmppStanza::XmppMessage *msg) {
+    void ProcessXmppMessage(const XmppStanza::XmppMessage *msg,
+                            std::string *stanza) {
         tbb::mutex::scoped_lock lock(mutex_);
-        XmppChannelMux::ProcessXmppMessage(msg);
+        XmppChannelMux::ProcessXmppMessage(msg, stanza);
     }
 
 private:
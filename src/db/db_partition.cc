@@ -17,7 +17,15 @@
 using tbb::concurrent_queue;
 using tbb::atomic;
 
-struct RequestQueueEntry {
+// Intrusive link used by the request ingress queue.
+struct RequestQueueNode {
+    RequestQueueNode() {
+        next = NULL;
+    }
+    atomic<RequestQueueNode *> next;
+};
+
+struct RequestQueueEntry : public RequestQueueNode {
     // Constructor takes ownership of DBRequest key, data.
     RequestQueueEntry(DBTablePartBase *tpart, DBClient *client, DBRequest *req)
         : tpart(tpart), client(client) {
@@ -36,49 +44,143 @@ struct RemoveQueueEntry {
     DBEntryBase *db_entry;
 };
 
+//
+// Multi-producer, single-consumer request ingress queue.
+//
+// Producers (xmpp/bgp input tasks, config tasks etc.) only perform a single
+// atomic exchange on head_ to publish an entry, so there's no lock on the
+// enqueue path irrespective of the number of producers.  The consumer is the
+// DBPartition QueueRunner, which is guaranteed to be single threaded since
+// there's at most one runner per partition.
+//
+// A producer that has swapped head_ but not yet linked the previous entry
+// makes the queue transiently look empty to the consumer. Callers must use
+// the request count, rather than the result of Dequeue, to decide whether
+// more work is pending.
+//
+class RequestIngressQueue {
+public:
+    RequestIngressQueue() : tail_(&stub_) {
+        head_ = &stub_;
+    }
+
+    void Enqueue(RequestQueueEntry *entry) {
+        Push(entry);
+    }
+
+    // Publish a chain of entries, already linked through their next field,
+    // with a single exchange.
+    void EnqueueList(RequestQueueEntry *first, RequestQueueEntry *last) {
+        last->next = NULL;
+        RequestQueueNode *prev = head_.fetch_and_store(last);
+        prev->next = first;
+    }
+
+    RequestQueueEntry *Dequeue() {
+        RequestQueueNode *tail = tail_;
+        RequestQueueNode *next = tail->next;
+        if (tail == &stub_) {
+            if (next == NULL)
+                return NULL;
+            tail_ = next;
+            tail = next;
+            next = next->next;
+        }
+        if (next != NULL) {
+            tail_ = next;
+            return static_cast<RequestQueueEntry *>(tail);
+        }
+        if (tail != head_)
+            return NULL;
+        Push(&stub_);
+        next = tail->next;
+        if (next != NULL) {
+            tail_ = next;
+            return static_cast<RequestQueueEntry *>(tail);
+        }
+        return NULL;
+    }
+
+private:
+    void Push(RequestQueueNode *node) {
+        node->next = NULL;
+        RequestQueueNode *prev = head_.fetch_and_store(node);
+        prev->next = node;
+    }
+
+    atomic<RequestQueueNode *> head_;
+    RequestQueueNode *tail_;
+    RequestQueueNode stub_;
+
+    DISALLOW_COPY_AND_ASSIGN(RequestIngressQueue);
+};
+
 class DBPartition::WorkQueue {
 public:
     static const int kThreshold = 1024;
-    typedef concurrent_queue<RequestQueueEntry *> RequestQueue;
+    typedef RequestIngressQueue RequestQueue;
     typedef concurrent_queue<RemoveQueueEntry *> RemoveQueue;
     typedef std::list<DBTablePartBase *> TablePartList;
 
     explicit WorkQueue(DBPartition *partition, int partition_id)
         : db_partition_(partition),
           db_partition_id_(partition_id),
-          disable_(false),
-          running_(false) {
+          disable_(false) {
+        running_ = false;
         request_count_ = 0;
         max_request_queue_len_ = 0;
         total_request_count_ = 0;
+        for (int idx = 0; idx < kQueueLenHistogramSize; ++idx) {
+            request_queue_len_histogram_[idx] = 0;
+        }
     }
     ~WorkQueue() {
-        for (RequestQueue::iterator iter = request_queue_.unsafe_begin();
-             iter != request_queue_.unsafe_end();) {
-            RequestQueueEntry *req_entry = *iter;
-            ++iter;
+        RequestQueueEntry *req_entry;
+        while (request_count_ != 0) {
+            if ((req_entry = request_queue_.Dequeue()) == NULL)
+                continue;
+            request_count_--;
             delete req_entry;
         }
-        request_queue_.clear();
     }
 
+    // Lock free: safe to be called concurrently from any number of tasks.
+    // The count is bumped before the entry is published so that the runner
+    // never declares itself done while an entry is in flight.
     bool EnqueueRequest(RequestQueueEntry *req_entry) {
-        request_queue_.push(req_entry);
-        MaybeStartRunner();
         uint32_t max = request_count_.fetch_and_increment();
-        if (max > max_request_queue_len_)
-            max_request_queue_len_ = max;
+        request_queue_.Enqueue(req_entry);
+        MaybeStartRunner();
+        UpdateQueueLenStats(max + 1);
         total_request_count_++;
         return max < (kThreshold - 1);
+    }
 
+    // Lock free, as above. The queue length stats observe the batch as a
+    // single enqueue.
+    bool EnqueueRequestBatch(RequestQueueEntry *first, RequestQueueEntry *last,
+                             long count) {
+        long max = request_count_.fetch_and_add(count);
+        request_queue_.EnqueueList(first, last);
+        MaybeStartRunner();
+        UpdateQueueLenStats(max + count);
+        total_request_count_ += count;
+        return (max + count) < kThreshold;
     }
 
-    bool DequeueRequest(RequestQueueEntry **req_entry) {
-        bool success = request_queue_.try_pop(*req_entry);
-        if (success) {
-            request_count_.fetch_and_decrement();
+    // Dequeue up to max_count requests into the caller supplied array.
+    // Returns the number of requests dequeued.
+    int DequeueRequestBatch(RequestQueueEntry **batch, int max_count) {
+        int count = 0;
+        while (count < max_count) {
+            RequestQueueEntry *req_entry = request_queue_.Dequeue();
+            if (req_entry == NULL)
+                break;
+            batch[count++] = req_entry;
         }
-        return success;
+        if (count)
+            request_count_.fetch_and_add(-count);
+        return count;
     }
 
     void EnqueueRemove(RemoveQueueEntry *rm_entry) {
@@ -91,7 +193,6 @@ public:
         return success;
     }
 
-    void MaybeStartRunnerUnlocked();
     void MaybeStartRunner();
     bool RunnerDone();
 
@@ -99,12 +200,15 @@ public:
     // exclusive with DB task, but can be called concurrently from multiple
     // bgp::ConfigHelper tasks.
     void SetActive(DBTablePartBase *tpart) {
-        tbb::mutex::scoped_lock lock(mutex_);
-        change_list_.push_back(tpart);
-        MaybeStartRunnerUnlocked();
+        {
+            tbb::mutex::scoped_lock lock(mutex_);
+            change_list_.push_back(tpart);
+        }
+        MaybeStartRunner();
     }
 
     DBTablePartBase *GetActiveTable() {
+        tbb::mutex::scoped_lock lock(mutex_);
         DBTablePartBase *tpart = NULL;
         if (!change_list_.empty()) {
             tpart = change_list_.front();
@@ -120,7 +224,8 @@ public:
     int db_task_id() const { return db_partition_->task_id(); }
 
     bool IsDBQueueEmpty() const {
-        return (request_queue_.empty() && change_list_.empty());
+        tbb::mutex::scoped_lock lock(mutex_);
+        return (request_count_ == 0 && change_list_.empty());
     }
 
     bool disable() { return disable_; }
@@ -138,18 +243,49 @@ public:
         return max_request_queue_len_;
     }
 
+    void request_queue_len_histogram(std::vector<uint64_t> *histogram) const {
+        histogram->resize(kQueueLenHistogramSize);
+        for (int idx = 0; idx < kQueueLenHistogramSize; ++idx) {
+            (*histogram)[idx] = request_queue_len_histogram_[idx];
+        }
+    }
+
 private:
+    bool IsEmpty() const {
+        tbb::mutex::scoped_lock lock(mutex_);
+        return (request_count_ == 0 && remove_queue_.empty() &&
+                change_list_.empty());
+    }
+
+    void UpdateQueueLenStats(uint64_t len) {
+        int bucket = 0;
+        for (uint64_t value = len; value > 1 &&
+             bucket < kQueueLenHistogramSize - 1; value >>= 1) {
+            bucket++;
+        }
+        request_queue_len_histogram_[bucket]++;
+
+        uint64_t max = max_request_queue_len_;
+        while (len > max) {
+            uint64_t prev = max_request_queue_len_.compare_and_swap(len, max);
+            if (prev == max)
+                break;
+            max = prev;
+        }
+    }
+
     DBPartition *db_partition_;
     RequestQueue request_queue_;
     TablePartList change_list_;
     atomic<long> request_count_;
-    uint64_t total_request_count_;
-    uint64_t max_request_queue_len_;
+    atomic<uint64_t> total_request_count_;
+    atomic<uint64_t> max_request_queue_len_;
+    atomic<uint64_t> request_queue_len_histogram_[kQueueLenHistogramSize];
     RemoveQueue remove_queue_;
-    tbb::mutex mutex_;
+    mutable tbb::mutex mutex_;
     int db_partition_id_;
     bool disable_;
-    bool running_;
+    atomic<bool> running_;
 
     DISALLOW_COPY_AND_ASSIGN(WorkQueue);
 };
@@ -203,11 +339,20 @@ public:
             }
         }
 
-        RequestQueueEntry *req_entry = NULL;
-        while (queue_->DequeueRequest(&req_entry)) {
-            req_entry->tpart->Process(req_entry->client, &req_entry->request);
-            delete req_entry;
-            if (++count == kMaxIterations) {
+        // Drain the request queue in batches so that the shared request
+        // count is touched once per batch rather than once per request.
+        RequestQueueEntry *batch[kMaxIterations];
+        int batch_count;
+        while ((batch_count = queue_->DequeueRequestBatch(
+                    batch, kMaxIterations - count)) != 0) {
+            for (int idx = 0; idx < batch_count; ++idx) {
+                RequestQueueEntry *req_entry = batch[idx];
+                req_entry->tpart->Process(req_entry->client,
+                                          &req_entry->request);
+                delete req_entry;
+            }
+            count += batch_count;
+            if (count == kMaxIterations) {
                 return false;
             }
         }
@@ -236,29 +381,27 @@ private:
     WorkQueue *queue_;
 };
 
-void DBPartition::WorkQueue::MaybeStartRunnerUnlocked() {
-    if (running_) {
+// Lock free: the first caller to flip running_ schedules the runner.
+void DBPartition::WorkQueue::MaybeStartRunner() {
+    if (running_ || running_.compare_and_swap(true, false))
         return;
-    }
-    running_ = true;
     QueueRunner *runner = new QueueRunner(this);
     TaskScheduler *scheduler = TaskScheduler::GetInstance();
     scheduler->Enqueue(runner);
 }
 
-void DBPartition::WorkQueue::MaybeStartRunner() {
-    tbb::mutex::scoped_lock lock(mutex_);
-    MaybeStartRunnerUnlocked();
-}
-
+// Clear running_ before checking for pending work. Any producer that enqueues
+// after the check is guaranteed to observe running_ as false and schedule a
+// new runner. If work is pending, the runner attempts to claim running_ back
+// and continue; if a producer won that race, the new runner takes over.
 bool DBPartition::WorkQueue::RunnerDone() {
-    tbb::mutex::scoped_lock lock(mutex_);
-    if (disable_ || (request_queue_.empty() && remove_queue_.empty())) {
-        running_ = false;
+    running_ = false;
+    if (disable_ || IsEmpty()) {
+        return true;
+    }
+    if (running_.compare_and_swap(true, false)) {
         return true;
     }
-
-    running_ = true;
     return false;
 }
 
@@ -277,6 +420,41 @@ bool DBPartition::EnqueueRequest(DBTablePartBase *tpart, DBClient *client,
     return work_queue_->EnqueueRequest(entry);
 }
 
+DBPartition::RequestBatch::RequestBatch()
+    : first_(NULL), last_(NULL), count_(0) {
+}
+
+DBPartition::RequestBatch::~RequestBatch() {
+    while (first_ != NULL) {
+        RequestQueueEntry *entry = first_;
+        first_ = static_cast<RequestQueueEntry *>(
+            static_cast<RequestQueueNode *>(entry->next));
+        delete entry;
+    }
+}
+
+void DBPartition::RequestBatch::Add(DBTablePartBase *tpart, DBClient *client,
+                                    DBRequest *req) {
+    RequestQueueEntry *entry = new RequestQueueEntry(tpart, client, req);
+    if (last_ == NULL) {
+        first_ = entry;
+    } else {
+        last_->next = entry;
+    }
+    last_ = entry;
+    count_++;
+}
+
+bool DBPartition::EnqueueRequestBatch(RequestBatch *batch) {
+    if (batch->empty())
+        return true;
+    bool result = work_queue_->EnqueueRequestBatch(batch->first_, batch->last_,
+                                                   batch->count_);
+    batch->first_ = batch->last_ = NULL;
+    batch->count_ = 0;
+    return result;
+}
+
 void DBPartition::EnqueueRemove(DBTablePartBase *tpart, DBEntryBase *db_entry) {
     RemoveQueueEntry *entry = new RemoveQueueEntry(tpart, db_entry);
     db_entry->SetOnRemoveQ();
@@ -300,6 +478,11 @@ uint64_t DBPartition::max_request_queue_len() const {
     return work_queue_->max_request_queue_len();
 }
 
+void DBPartition::request_queue_len_histogram(
+    std::vector<uint64_t> *histogram) const {
+    work_queue_->request_queue_len_histogram(histogram);
+}
+
 int DBPartition::task_id() const {
     return db_->task_id();
 }
@@ -5,6 +5,8 @@
 #ifndef ctrlplane_db_partition_h
 #define ctrlplane_db_partition_h
 
+#include <vector>
+
 #include <boost/function.hpp>
 
 #include "base/util.h"
@@ -14,6 +16,7 @@
 class DB;
 class DBClient;
 class DBTablePartBase;
+struct RequestQueueEntry;
 
 // Database shard interface.
 // Each shard handles the full pipeline of DB update processing.
@@ -21,6 +24,32 @@ class DBPartition {
 public:
     typedef boost::function<void(void)> Callback;
 
+    // Number of log2 buckets in the request queue length histogram.
+    static const int kQueueLenHistogramSize = 16;
+
+    // Requests collected by a producer, to be published to the partition
+    // with a single operation. Requests that are not enqueued are freed
+    // with the batch.
+    class RequestBatch {
+    public:
+        RequestBatch();
+        ~RequestBatch();
+
+        // Takes ownership of the request key and data.
+        void Add(DBTablePartBase *tpart, DBClient *client, DBRequest *req);
+
+        bool empty() const { return count_ == 0; }
+        size_t size() const { return count_; }
+
+    private:
+        friend class DBPartition;
+        RequestQueueEntry *first_;
+        RequestQueueEntry *last_;
+        size_t count_;
+
+        DISALLOW_COPY_AND_ASSIGN(RequestBatch);
+    };
+
     explicit DBPartition(DB *db, int partition_id);
     ~DBPartition();
 
@@ -29,6 +58,9 @@ public:
     bool EnqueueRequest(DBTablePartBase *tpart, DBClient *client,
                         DBRequest *req);
 
+    // Enqueue the requests of the batch, in order, and empty it.
+    bool EnqueueRequestBatch(RequestBatch *batch);
+
     void EnqueueRemove(DBTablePartBase *tpart, DBEntryBase *db_entry);
 
     // Enqueue table on change list.
@@ -39,6 +71,10 @@ public:
     long request_queue_len() const;
     uint64_t total_request_count() const;
     uint64_t max_request_queue_len() const;
+
+    // Bucket i counts enqueues that observed a queue length in the range
+    // [2^i, 2^(i+1)). The last bucket also counts all larger lengths.
+    void request_queue_len_histogram(std::vector<uint64_t> *histogram) const;
     int task_id() const;
 
 private:
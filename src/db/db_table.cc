@@ -8,6 +8,7 @@
 
 #include <boost/bind.hpp>
 #include <boost/foreach.hpp>
+#include <boost/scoped_array.hpp>
 #include <boost/dynamic_bitset.hpp>
 #include <boost/type_traits.hpp>
 
@@ -173,11 +174,28 @@ DBTableBase::DBTableBase(DB *db, const string &name)
     walk_cancel_count_ = 0;
     walk_again_count_ = 0;
     walk_count_ = 0;
+    walk_entries_visited_ = 0;
+    last_walk_wait_time_ = 0;
+    max_walk_wait_time_ = 0;
+    last_walk_duration_ = 0;
+    max_walk_duration_ = 0;
 }
 
 DBTableBase::~DBTableBase() {
 }
 
+void DBTableBase::set_walk_wait_time(uint64_t wait_time) {
+    last_walk_wait_time_ = wait_time;
+    if (wait_time > max_walk_wait_time_)
+        max_walk_wait_time_ = wait_time;
+}
+
+void DBTableBase::set_walk_duration(uint64_t duration) {
+    last_walk_duration_ = duration;
+    if (duration > max_walk_duration_)
+        max_walk_duration_ = duration;
+}
+
 DBTableBase::ListenerId DBTableBase::Register(ChangeCallback callback,
     const string &name) {
     return info_->Register(callback, name);
@@ -198,6 +216,29 @@ bool DBTableBase::Enqueue(DBRequest *req) {
     return partition->EnqueueRequest(tpart, NULL, req);
 }
 
+bool DBTableBase::Enqueue(DBRequestList *reqs) {
+    if (reqs->empty())
+        return true;
+
+    int count = DB::PartitionCount();
+    boost::scoped_array<DBPartition::RequestBatch> batches(
+        new DBPartition::RequestBatch[count]);
+    for (DBRequestList::iterator it = reqs->begin(); it != reqs->end(); ++it) {
+        DBTablePartBase *tpart = GetTablePartition(it->key.get());
+        batches[tpart->index()].Add(tpart, NULL, &*it);
+    }
+    enqueue_count_ += reqs->size();
+    reqs->clear();
+
+    bool result = true;
+    for (int index = 0; index < count; ++index) {
+        DBPartition *partition = db_->GetPartition(index);
+        if (!partition->EnqueueRequestBatch(&batches[index]))
+            result = false;
+    }
+    return result;
+}
+
 void DBTableBase::EnqueueRemove(DBEntryBase *db_entry) {
     DBTablePartBase *tpart = GetTablePartition(db_entry);
     DBPartition *partition = db_->GetPartition(tpart->index());
@@ -310,6 +351,7 @@ bool DBTable::WalkWorker::Run() {
         if (count == max_walk_entry_count) {
             // store the context
             walk_ctx_ = entry->GetDBRequestKey();
+            table->add_walk_entries_visited(count);
             return false;
         }
 
@@ -324,6 +366,7 @@ bool DBTable::WalkWorker::Run() {
     }
 
 walk_done:
+    table->add_walk_entries_visited(count);
     // Check whether all other walks on the table is completed
     long num_walkers_on_tpart = walker_->pending_workers_.fetch_and_decrement();
     if (num_walkers_on_tpart == 1) {
@@ -397,6 +440,7 @@ DBTablePartition *DBTable::AllocPartition(int index) {
 void DBTable::StartWalk() {
     CHECK_CONCURRENCY("db::Walker");
     incr_walk_count();
+    reset_walk_entries_visited();
     walker_->StartWalk();
 }
 
@@ -603,9 +647,10 @@ void DBTable::NotifyAllEntries() {
 }
 
 DBTable::DBTableWalkRef DBTable::AllocWalker(WalkFn walk_fn,
-                                             WalkCompleteFn walk_complete) {
+                                             WalkCompleteFn walk_complete,
+                                             WalkPriority priority) {
     DBTableWalkMgr *walk_mgr = database()->GetWalkMgr();
-    return walk_mgr->AllocWalker(this, walk_fn, walk_complete);
+    return walk_mgr->AllocWalker(this, walk_fn, walk_complete, priority);
 }
 
 void DBTable::ReleaseWalker(DBTable::DBTableWalkRef &walk) {
@@ -635,5 +680,5 @@ void DBTable::WalkDone() {
     incr_walk_complete_count();
     walker_->ClearWalkWorks();
     DBTableWalkMgr *walk_mgr = database()->GetWalkMgr();
-    return walk_mgr->WalkDone();
+    return walk_mgr->WalkDone(this);
 }
@@ -10,6 +10,7 @@
 #include <unistd.h>
 #include <boost/function.hpp>
 #include <boost/intrusive_ptr.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
 #include <tbb/atomic.h>
 
 #include "base/util.h"
@@ -55,6 +56,9 @@ private:
     DISALLOW_COPY_AND_ASSIGN(DBRequest);
 };
 
+// Requests collected by a producer and enqueued to a table together.
+typedef boost::ptr_vector<DBRequest> DBRequestList;
+
 // Database table interface.
 class DBTableBase {
 public:
@@ -68,6 +72,9 @@ public:
 
     // Enqueue a request to the table. Takes ownership of the data.
     bool Enqueue(DBRequest *req);
+    // Enqueue a list of requests to the table, with a single operation for
+    // the requests that map to the same partition, and clear the list.
+    bool Enqueue(DBRequestList *reqs);
     void EnqueueRemove(DBEntryBase *db_entry);
 
     // Determine the table partition depending on the record key.
@@ -141,6 +148,19 @@ public:
     void incr_walk_again_count() { walk_again_count_++; }
     void incr_walk_count() { walk_count_++; }
 
+    // Walk progress and latency, in microseconds
+    uint64_t walk_entries_visited() const { return walk_entries_visited_; }
+    void reset_walk_entries_visited() { walk_entries_visited_ = 0; }
+    void add_walk_entries_visited(uint64_t count) {
+        walk_entries_visited_ += count;
+    }
+    uint64_t last_walk_wait_time() const { return last_walk_wait_time_; }
+    uint64_t max_walk_wait_time() const { return max_walk_wait_time_; }
+    uint64_t last_walk_duration() const { return last_walk_duration_; }
+    uint64_t max_walk_duration() const { return max_walk_duration_; }
+    void set_walk_wait_time(uint64_t wait_time);
+    void set_walk_duration(uint64_t duration);
+
 private:
     class ListenerInfo;
     DB *db_;
@@ -155,6 +175,11 @@ private:
     tbb::atomic<uint64_t> walk_complete_count_;
     tbb::atomic<uint64_t> walk_cancel_count_;
     tbb::atomic<uint64_t> walk_again_count_;
+    tbb::atomic<uint64_t> walk_entries_visited_;
+    uint64_t last_walk_wait_time_;
+    uint64_t max_walk_wait_time_;
+    uint64_t last_walk_duration_;
+    uint64_t max_walk_duration_;
 };
 
 // An implementation of DBTableBase that uses boost::set as data-store
@@ -168,6 +193,14 @@ class DBTable : public DBTableBase {
 public:
     typedef boost::intrusive_ptr<DBTableWalk> DBTableWalkRef;
 
+    // Pending walk requests are served in priority order.
+    enum WalkPriority {
+        WALK_PRIORITY_LOW,
+        WALK_PRIORITY_NORMAL,
+        WALK_PRIORITY_HIGH,
+        WALK_PRIORITY_COUNT
+    };
+
     // Walker function:
     // Called for each DBEntry under a db::DBTable task that corresponds to the
     // specific partition.
@@ -266,7 +299,8 @@ public:
     // Walk APIs
     // Create a DBTable Walker
     // Concurrency : can be invoked from any task
-    DBTableWalkRef AllocWalker(WalkFn walk_fn, WalkCompleteFn walk_complete);
+    DBTableWalkRef AllocWalker(WalkFn walk_fn, WalkCompleteFn walk_complete,
+                               WalkPriority priority = WALK_PRIORITY_NORMAL);
 
     // Release the Walker
     // Concurrency : can be invoked from any task
@@ -365,8 +399,10 @@ public:
     };
 
     DBTableWalk(DBTable *table, DBTable::WalkFn walk_fn,
-                DBTable::WalkCompleteFn walk_complete)
-        : table_(table), walk_fn_(walk_fn), walk_complete_(walk_complete) {
+                DBTable::WalkCompleteFn walk_complete,
+                DBTable::WalkPriority priority)
+        : table_(table), walk_fn_(walk_fn), walk_complete_(walk_complete),
+          priority_(priority) {
         walk_state_ = INIT;
         walk_again_ = false;
         refcount_ = 0;
@@ -375,6 +411,7 @@ public:
     DBTable *table() const { return table_;}
     DBTable::WalkFn walk_fn() const { return walk_fn_;}
     DBTable::WalkCompleteFn walk_complete() const { return walk_complete_;}
+    DBTable::WalkPriority priority() const { return priority_;}
 
     bool requested() const { return (walk_state_ == WALK_REQUESTED);}
     bool in_progress() const { return (walk_state_ == WALK_IN_PROGRESS);}
@@ -405,6 +442,7 @@ private:
     DBTable *table_;
     DBTable::WalkFn walk_fn_;
     DBTable::WalkCompleteFn walk_complete_;
+    DBTable::WalkPriority priority_;
     tbb::atomic<WalkState> walk_state_;
     tbb::atomic<bool> walk_again_;
     tbb::atomic<int> refcount_;
@@ -12,6 +12,7 @@
 #include "base/logging.h"
 #include "base/task.h"
 #include "base/task_annotations.h"
+#include "base/time_util.h"
 #include "db/db.h"
 #include "db/db_partition.h"
 #include "db/db_table.h"
@@ -23,41 +24,75 @@ DBTableWalkMgr::DBTableWalkMgr()
         TaskScheduler::GetInstance()->GetTaskId("db::Walker"), 0)),
       walk_done_trigger_(new TaskTrigger(
         boost::bind(&DBTableWalkMgr::ProcessWalkDone, this),
-        TaskScheduler::GetInstance()->GetTaskId("db::Walker"), 0)) {
+        TaskScheduler::GetInstance()->GetTaskId("db::Walker"), 0)),
+      max_concurrent_walks_(kDefaultMaxConcurrentWalks) {
+}
+
+void DBTableWalkMgr::SetMaxConcurrentWalks(uint32_t count) {
+    assert(count > 0);
+    max_concurrent_walks_ = count;
+    walk_request_trigger_->Set();
+}
+
+DBTableWalkMgr::WalkRequestInfoPtr DBTableWalkMgr::DequeueWalkRequest() {
+    tbb::mutex::scoped_lock lock(mutex_);
+    for (int priority = DBTable::WALK_PRIORITY_COUNT - 1; priority >= 0;
+         priority--) {
+        WalkRequestInfoList *list = &walk_request_list_[priority];
+        for (WalkRequestInfoList::iterator it = list->begin();
+             it != list->end(); ) {
+            WalkRequestInfoPtr info = *it;
+            // Skip the stale entry of a request raised to higher priority
+            if (info->priority != priority) {
+                it = list->erase(it);
+                continue;
+            }
+            if (walk_in_progress_.find(info->table) !=
+                walk_in_progress_.end()) {
+                ++it;
+                continue;
+            }
+            list->erase(it);
+            walk_request_set_.erase(info.get());
+            return info;
+        }
+    }
+    return WalkRequestInfoPtr();
+}
+
+bool DBTableWalkMgr::StartWalk(WalkRequestInfoPtr info) {
+    bool walk_table = false;
+    BOOST_FOREACH(DBTable::DBTableWalkRef walker, info->pending_requests) {
+        if (walker->stopped()) continue;
+        walker->set_in_progress();
+        walker->reset_walk_again();
+        walk_table = true;
+    }
+    if (!walk_table)
+        return false;
+
+    DBTable *table = info->table;
+    info->start_time = UTCTimestampUsec();
+    table->set_walk_wait_time(info->start_time - info->request_time);
+    walk_in_progress_.insert(std::make_pair(table, info));
+    table->StartWalk();
+    return true;
 }
 
 bool DBTableWalkMgr::ProcessWalkRequestList() {
     CHECK_CONCURRENCY("db::Walker");
-    if (!current_table_walk_.empty()) return true;
-    while (true) {
-        if (walk_request_list_.empty()) break;
-        WalkRequestInfoPtr info = walk_request_list_.front();
-        walk_request_set_.erase(info.get());
-        walk_request_list_.pop_front();
-        current_table_walk_.swap(info->pending_requests);
-        DBTable *table = info->table;
-        bool walk_table = false;
-        BOOST_FOREACH(DBTable::DBTableWalkRef walker, current_table_walk_) {
-            if (walker->stopped()) continue;
-            walker->set_in_progress();
-            walker->reset_walk_again();
-            walk_table = true;
-        }
-        if (walk_table) {
-            // start the walk
-            table->StartWalk();
+    while (walk_in_progress_.size() < max_concurrent_walks_) {
+        WalkRequestInfoPtr info = DequeueWalkRequest();
+        if (!info)
             break;
-        } else {
-            current_table_walk_.clear();
-        }
+        StartWalk(info);
     }
     return true;
 }
 
-bool DBTableWalkMgr::ProcessWalkDone() {
-    CHECK_CONCURRENCY("db::Walker");
-    assert(!current_table_walk_.empty());
-    BOOST_FOREACH(DBTable::DBTableWalkRef walker, current_table_walk_) {
+void DBTableWalkMgr::WalkDoneInternal(WalkRequestInfoPtr info) {
+    info->table->set_walk_duration(UTCTimestampUsec() - info->start_time);
+    BOOST_FOREACH(DBTable::DBTableWalkRef walker, info->pending_requests) {
         if (walker->walk_again())
             walker->set_walk_requested();
         else if (!walker->stopped())
@@ -65,15 +100,32 @@ bool DBTableWalkMgr::ProcessWalkDone() {
         if (walker->stopped() || walker->walk_again()) continue;
         walker->walk_complete()(walker, walker->table());
     }
-    current_table_walk_.clear();
+}
+
+bool DBTableWalkMgr::ProcessWalkDone() {
+    CHECK_CONCURRENCY("db::Walker");
+    std::vector<DBTable *> done_list;
+    {
+        tbb::mutex::scoped_lock lock(mutex_);
+        done_list.swap(walk_done_list_);
+    }
+    BOOST_FOREACH(DBTable *table, done_list) {
+        WalkInProgressMap::iterator it = walk_in_progress_.find(table);
+        assert(it != walk_in_progress_.end());
+        WalkRequestInfoPtr info = it->second;
+        walk_in_progress_.erase(it);
+        WalkDoneInternal(info);
+    }
     walk_request_trigger_->Set();
     return true;
 }
 
 DBTable::DBTableWalkRef DBTableWalkMgr::AllocWalker(DBTable *table,
-               DBTable::WalkFn walk_fn, DBTable::WalkCompleteFn walk_complete) {
+               DBTable::WalkFn walk_fn, DBTable::WalkCompleteFn walk_complete,
+               DBTable::WalkPriority priority) {
     table->incr_walker_count();
-    DBTableWalk *walker = new DBTableWalk(table, walk_fn, walk_complete);
+    DBTableWalk *walker =
+        new DBTableWalk(table, walk_fn, walk_complete, priority);
     return DBTable::DBTableWalkRef(walker);
 }
 
@@ -101,24 +153,41 @@ void DBTableWalkMgr::WalkTable(DBTable::DBTableWalkRef walk) {
     WalkRequestInfo tmp_info = WalkRequestInfo(table);
     WalkRequestInfoSet::iterator it = walk_request_set_.find(&tmp_info);
     if (it != walk_request_set_.end()) {
-        (*it)->AppendWalkReq(walk);
+        WalkRequestInfo *info = *it;
+        info->AppendWalkReq(walk);
+        if (walk->priority() > info->priority) {
+            // Requeue at the higher priority, the older entry is skipped by
+            // DequeueWalkRequest
+            info->priority = walk->priority();
+            walk_request_list_[info->priority].push_back(
+                info->shared_from_this());
+        }
         return;
     }
 
     WalkRequestInfo *new_info = new WalkRequestInfo(table);
     new_info->AppendWalkReq(walk);
-    walk_request_list_.push_back(WalkRequestInfoPtr(new_info));
+    new_info->priority = walk->priority();
+    new_info->request_time = UTCTimestampUsec();
+    walk_request_list_[new_info->priority].push_back(
+        WalkRequestInfoPtr(new_info));
     walk_request_set_.insert(new_info);
     walk_request_trigger_->Set();
 }
 
-void DBTableWalkMgr::WalkDone() {
+void DBTableWalkMgr::WalkDone(DBTable *table) {
+    tbb::mutex::scoped_lock lock(mutex_);
+    walk_done_list_.push_back(table);
     walk_done_trigger_->Set();
 }
 
 bool DBTableWalkMgr::InvokeWalkCb(DBTablePartBase *part, DBEntryBase *entry) {
+    DBTable *table = static_cast<DBTable *>(part->parent());
+    WalkInProgressMap::const_iterator it = walk_in_progress_.find(table);
+    assert(it != walk_in_progress_.end());
+    const WalkReqList &current_table_walk = it->second->pending_requests;
     uint32_t skip_walk_count = 0;
-    BOOST_FOREACH(DBTable::DBTableWalkRef walker, current_table_walk_) {
+    BOOST_FOREACH(DBTable::DBTableWalkRef walker, current_table_walk) {
         if (walker->done() || walker->stopped() || walker->walk_again()) {
             skip_walk_count++;
             continue;
@@ -129,5 +198,5 @@ bool DBTableWalkMgr::InvokeWalkCb(DBTablePartBase *part, DBEntryBase *entry) {
             if (!walker->stopped()) walker->set_walk_done();
         }
     }
-    return (skip_walk_count < current_table_walk_.size());
+    return (skip_walk_count < current_table_walk.size());
 }
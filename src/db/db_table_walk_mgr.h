@@ -6,9 +6,12 @@
 #define ctrlplane_db_table_walk_mgr_h
 
 #include <list>
+#include <map>
 #include <set>
+#include <vector>
 
 #include <boost/assign.hpp>
+#include <boost/enable_shared_from_this.hpp>
 #include <boost/function.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
@@ -62,49 +65,71 @@
 //    restarted from beginning of DBTable. This API should be called from a task
 //    which is mutually exclusive from db::Walker task.
 //
-// DBTableWalkMgr ensures that not more than one DBTable is walked at any point
-// in time. All other DBTable walk requests are queued and taken up only after
-// current walk completes.
+// DBTableWalkMgr walks up to max_concurrent_walks_ different DBTables at any
+// point in time (one by default). A given DBTable is never walked by more than
+// one walk at a time. All other DBTable walk requests are queued and taken up
+// when a walk slot is free.
 // Actual DBTable walk (i.e. iterating the DBTablePartition) is performed in
 // db::DBTable task or task id configured with DBTable::SetWalkTaskId with
 // instance id set as partition index.
-// The advantage of running DBTable walk in serial manner is in clubbing
-// multiple walk requests on a given table and serving such requests in one
-// iteration of DBTable walk
+// The advantage of walking a given table in serial manner is in clubbing
+// multiple walk requests on the table and serving such requests in one
+// iteration of DBTable walk. Walking different tables concurrently lets the
+// walk of one table use the partitions left idle by the tail of the walk of
+// another table.
 //
 // WalkReqList holds list of DBTableWalkRef(i.e. walkers created by multiple
 // application modules) that requested for DBTable walk on a specific table.
-// InvokeWalkCb notifies all such walkers stored in current_table_walk_, while
-// iterating through DBTable entries
+// InvokeWalkCb notifies all such walkers stored in the WalkRequestInfo of the
+// table in walk_in_progress_, while iterating through DBTable entries
 //
 // WalkRequestInfo:
 // ===============
 // WalkRequestInfo is a per table Walk request structure. It also holds
-// DBTableWalkRef which requested for DBTable walk.
+// DBTableWalkRef which requested for DBTable walk. The priority of the request
+// is the highest priority of the walkers in it.
 //
 // WalkRequestInfoList
 // ===================
-// walk_request_list_ holds list of WalkRequestInfo. This list is keyed by
-// DBTable. Additional walk_request_set_ is maintained for easy search of
+// walk_request_list_ holds one list of WalkRequestInfo per walk priority.
+// Requests are served from the highest priority list first and in FIFO order
+// within a list. Additional walk_request_set_ is maintained for easy search of
 // WalkRequestInfo for a given DBTable.
-// Current table on which walk is going on will not be present in the
-// walk_request_list_. If caller requests for WalkAgain(), it is added back to
-// the walk_request_list_ (in the end of the list).
+// When a request is raised to a higher priority, it is appended to the higher
+// priority list and the entry left in the lower priority list is skipped.
+// Tables on which walk is going on are present in walk_in_progress_ and not in
+// the walk_request_set_. If caller requests for WalkAgain(), the request is
+// added back to the walk_request_list_ and is not taken up until the ongoing
+// walk of the table is done.
 //
 // Task Triggers:
 // walk_request_trigger_ : Task trigger which evaluate walk_request_list_.
 // It removes the WalkRequestInfo on top of this list and starts walk on the
-// table. This task trigger runs in "db::Walker" task context.
+// table, until all walk slots are in use. This task trigger runs in
+// "db::Walker" task context.
 //
 // walk_done_trigger_ : Task trigger ensures that WalkCompleteFn is triggered
-// in db::Walker task context for all DBTableWalkRef which requested for
-// current DBTable walk. At the end of ProcessWalkDone, walk_request_trigger_ is
-// triggered to evaluate walk request from top of walk_request_list_.
+// in db::Walker task context for all DBTableWalkRef which requested for the
+// DBTable walks in walk_done_list_. At the end of ProcessWalkDone,
+// walk_request_trigger_ is triggered to take up requests in the freed slots.
+//
+// Walk latency (time from walk request to start of the walk) and duration are
+// recorded in the DBTable and can be looked at with the route summary
+// introspect.
 //
 class DBTableWalkMgr {
 public:
+    static const uint32_t kDefaultMaxConcurrentWalks = 1;
+
     DBTableWalkMgr();
 
+    // Number of different tables that can be walked at the same time
+    void SetMaxConcurrentWalks(uint32_t count);
+    uint32_t max_concurrent_walks() const { return max_concurrent_walks_; }
+
+    size_t walk_in_progress_count() const { return walk_in_progress_.size(); }
+    size_t walk_request_count() const { return walk_request_set_.size(); }
+
     void DisableWalkProcessing() {
         walk_request_trigger_->set_disable();
     }
@@ -125,8 +150,11 @@ private:
     friend class DBTable;
     typedef std::set<DBTable::DBTableWalkRef> WalkReqList;
 
-    struct WalkRequestInfo {
-        WalkRequestInfo(DBTable *table) : table(table) {
+    struct WalkRequestInfo
+        : public boost::enable_shared_from_this<WalkRequestInfo> {
+        WalkRequestInfo(DBTable *table)
+            : table(table), priority(DBTable::WALK_PRIORITY_LOW),
+              request_time(0), start_time(0) {
         }
 
         void AppendWalkReq(DBTable::DBTableWalkRef ref) {
@@ -141,6 +169,9 @@ private:
             return !pending_requests.empty();
         }
         DBTable *table;
+        DBTable::WalkPriority priority;
+        uint64_t request_time;
+        uint64_t start_time;
         WalkReqList pending_requests;
     };
 
@@ -153,10 +184,12 @@ private:
     typedef boost::shared_ptr<WalkRequestInfo> WalkRequestInfoPtr;
     typedef std::list<WalkRequestInfoPtr> WalkRequestInfoList;
     typedef std::set<WalkRequestInfo *, WalkRequestCompare> WalkRequestInfoSet;
+    typedef std::map<DBTable *, WalkRequestInfoPtr> WalkInProgressMap;
 
     // Create a DBTable Walker
     DBTable::DBTableWalkRef AllocWalker(DBTable *table, DBTable::WalkFn walk_fn,
-                       DBTable::WalkCompleteFn walk_complete);
+                       DBTable::WalkCompleteFn walk_complete,
+                       DBTable::WalkPriority priority);
 
     // Release the Walker
     void ReleaseWalker(DBTable::DBTableWalkRef &walk);
@@ -165,27 +198,38 @@ private:
     void WalkTable(DBTable::DBTableWalkRef walk);
 
     // DBTable finished walking
-    void WalkDone();
+    void WalkDone(DBTable *table);
 
     // Walk the table again
     void WalkAgain(DBTable::DBTableWalkRef walk);
 
     bool ProcessWalkRequestList();
 
+    // Remove the first request in priority order whose table is not being
+    // walked. Returns NULL if there is no such request
+    WalkRequestInfoPtr DequeueWalkRequest();
+
+    bool StartWalk(WalkRequestInfoPtr info);
+
     bool ProcessWalkDone();
 
+    void WalkDoneInternal(WalkRequestInfoPtr info);
+
     bool InvokeWalkCb(DBTablePartBase *part, DBEntryBase *entry);
 
     boost::scoped_ptr<TaskTrigger> walk_request_trigger_;
     boost::scoped_ptr<TaskTrigger> walk_done_trigger_;
 
-    // Mutex to protect walk_request_list_ and walk_request_set_ as
-    // Walk can be requested from task which may run concurrently
+    // Mutex to protect walk_request_list_, walk_request_set_ and
+    // walk_done_list_ as Walk can be requested and finished from tasks which
+    // may run concurrently
     tbb::mutex mutex_;
-    WalkRequestInfoList walk_request_list_;
+    WalkRequestInfoList walk_request_list_[DBTable::WALK_PRIORITY_COUNT];
     WalkRequestInfoSet walk_request_set_;
 
-    WalkReqList current_table_walk_;
+    uint32_t max_concurrent_walks_;
+    WalkInProgressMap walk_in_progress_;
+    std::vector<DBTable *> walk_done_list_;
 
     DISALLOW_COPY_AND_ASSIGN(DBTableWalkMgr);
 };
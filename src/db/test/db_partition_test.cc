@@ -0,0 +1,377 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include <pthread.h>
+#include <boost/bind.hpp>
+#include <boost/foreach.hpp>
+#include <tbb/atomic.h>
+
+#include "db/db.h"
+#include "db/db_table.h"
+#include "db/db_entry.h"
+#include "db/db_client.h"
+#include "db/db_partition.h"
+#include "base/time_util.h"
+#include "base/task.h"
+#include "base/test/task_test_util.h"
+
+#include "base/logging.h"
+#include "base/task_annotations.h"
+#include "testing/gunit.h"
+
+#define ENQUEUE_COUNT (256*1000)
+class VlanTable;
+
+struct VlanTableReqKey : public DBRequestKey {
+    VlanTableReqKey(uint32_t tag) : tag(tag) {}
+    uint32_t tag;
+};
+
+struct VlanTableReqData : public DBRequestData {
+    VlanTableReqData(uint32_t value) : value(value) {}
+    uint32_t value;
+};
+
+class Vlan : public DBEntry {
+public:
+    Vlan(uint32_t tag) : vlan_tag_(tag) { }
+
+    bool IsLess(const DBEntry &rhs) const {
+        const Vlan &a = static_cast<const Vlan &>(rhs);
+        return vlan_tag_ < a.vlan_tag_;
+    }
+
+    void SetKey(const DBRequestKey *key) {
+        const VlanTableReqKey *k = static_cast<const VlanTableReqKey *>(key);
+        vlan_tag_ = k->tag;
+    }
+
+    std::string ToString() const {
+        return "Vlan";
+    }
+
+    virtual KeyPtr GetDBRequestKey() const {
+        VlanTableReqKey *key = new VlanTableReqKey(vlan_tag_);
+        return KeyPtr(key);
+    }
+
+private:
+    uint32_t vlan_tag_;
+    DISALLOW_COPY_AND_ASSIGN(Vlan);
+};
+
+class VlanTable : public DBTable {
+public:
+    VlanTable(DB *db) : DBTable(db, "__vlan__.0") {
+        request_count_ = 0;
+    }
+    ~VlanTable() { }
+
+    virtual std::auto_ptr<DBEntry> AllocEntry(const DBRequestKey *key) const {
+        const VlanTableReqKey *vkey = static_cast<const VlanTableReqKey *>(key);
+        Vlan *vlan = new Vlan(vkey->tag);
+        return std::auto_ptr<DBEntry>(vlan);
+    };
+
+    size_t Hash(const DBEntry *entry) const {
+        return 0;
+    }
+
+    size_t Hash(const DBRequestKey *key) const {
+        return 0;
+    }
+
+    virtual DBEntry *Add(const DBRequest *req) {
+        const VlanTableReqKey *key = static_cast<const VlanTableReqKey *>
+            (req->key.get());
+        request_count_++;
+        return new Vlan(key->tag);
+    };
+
+    virtual bool OnChange(DBEntry *entry, const DBRequest *req) {
+        request_count_++;
+        return true;
+    };
+
+    virtual bool Delete(DBEntry *entry, const DBRequest *req) {
+        request_count_++;
+        return true;
+    }
+
+    static DBTableBase *CreateTable(DB *db, const std::string &name) {
+        VlanTable *table = new VlanTable(db);
+        table->Init();
+        return table;
+    }
+
+    uint32_t request_count() const { return request_count_; }
+
+private:
+    tbb::atomic<uint32_t> request_count_;
+    DISALLOW_COPY_AND_ASSIGN(VlanTable);
+};
+
+// Producer thread that enqueues a range of add requests to the table, one at
+// a time or in lists of batch_size requests. The producers are plain threads
+// rather than scheduler tasks so that they all run at the same time whatever
+// the number of scheduler threads, and they wait to be released together so
+// that they contend on the partition ingress queue.
+class Producer {
+public:
+    Producer(VlanTable *table, uint32_t start, uint32_t count,
+             uint32_t batch_size) :
+        table_(table), start_(start), count_(count), batch_size_(batch_size) {
+    }
+
+    bool Start() {
+        return pthread_create(&thread_id_, NULL, &Producer::Run, this) == 0;
+    }
+
+    void Join() {
+        pthread_join(thread_id_, NULL);
+    }
+
+    // Release all the producers waiting to start.
+    static void Release(bool released) {
+        pthread_mutex_lock(&mutex_);
+        released_ = released;
+        pthread_cond_broadcast(&cond_);
+        pthread_mutex_unlock(&mutex_);
+    }
+
+private:
+    static void *Run(void *objp) {
+        Producer *producer = reinterpret_cast<Producer *>(objp);
+        pthread_mutex_lock(&mutex_);
+        while (!released_)
+            pthread_cond_wait(&cond_, &mutex_);
+        pthread_mutex_unlock(&mutex_);
+        producer->EnqueueRequests();
+        return NULL;
+    }
+
+    void EnqueueRequests() {
+        DBRequestList reqs;
+        for (uint32_t tag = start_; tag < start_ + count_; ++tag) {
+            if (batch_size_ <= 1) {
+                DBRequest req;
+                req.oper = DBRequest::DB_ENTRY_ADD_CHANGE;
+                req.key.reset(new VlanTableReqKey(tag));
+                req.data.reset(new VlanTableReqData(tag));
+                table_->Enqueue(&req);
+                continue;
+            }
+            DBRequest *req = new DBRequest(DBRequest::DB_ENTRY_ADD_CHANGE);
+            req->key.reset(new VlanTableReqKey(tag));
+            req->data.reset(new VlanTableReqData(tag));
+            reqs.push_back(req);
+            if (reqs.size() == batch_size_)
+                table_->Enqueue(&reqs);
+        }
+        table_->Enqueue(&reqs);
+    }
+
+    static pthread_mutex_t mutex_;
+    static pthread_cond_t cond_;
+    static bool released_;
+
+    VlanTable *table_;
+    uint32_t start_;
+    uint32_t count_;
+    uint32_t batch_size_;
+    pthread_t thread_id_;
+    DISALLOW_COPY_AND_ASSIGN(Producer);
+};
+
+pthread_mutex_t Producer::mutex_ = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t Producer::cond_ = PTHREAD_COND_INITIALIZER;
+bool Producer::released_;
+
+class DBPartitionTest : public ::testing::Test {
+public:
+    DBPartitionTest() : next_tag_(0) {
+        table_ = static_cast<VlanTable *>(db_.CreateTable("db.test.vlan.0"));
+    }
+
+    virtual void TearDown() {
+        for (uint32_t tag = 0; tag < next_tag_; ++tag) {
+            DBRequest req;
+            req.oper = DBRequest::DB_ENTRY_DELETE;
+            req.key.reset(new VlanTableReqKey(tag));
+            table_->Enqueue(&req);
+        }
+        task_util::WaitForIdle();
+        EXPECT_EQ(0, table_->Size());
+    }
+
+protected:
+    // Enqueue count add requests, spread across producer_count concurrent
+    // producer threads. Returns the time taken, in usec, for all the requests
+    // to be enqueued and processed.
+    uint64_t EnqueueScale(uint32_t producer_count, uint32_t count,
+                          uint32_t batch_size = 1) {
+        uint32_t base = table_->request_count();
+        uint32_t per_producer = count / producer_count;
+
+        Producer::Release(false);
+        std::vector<Producer *> producers;
+        for (uint32_t idx = 0; idx < producer_count; ++idx) {
+            Producer *producer = new Producer(table_,
+                next_tag_ + idx * per_producer, per_producer, batch_size);
+            if (!producer->Start()) {
+                ADD_FAILURE() << "Failed to start producer " << idx;
+                delete producer;
+                continue;
+            }
+            producers.push_back(producer);
+        }
+
+        uint64_t start = ClockMonotonicUsec();
+        Producer::Release(true);
+        BOOST_FOREACH(Producer *producer, producers) {
+            producer->Join();
+            delete producer;
+        }
+        task_util::WaitForIdle();
+        next_tag_ += per_producer * producer_count;
+        uint64_t delay = ClockMonotonicUsec() - start;
+        EXPECT_EQ(base + per_producer * producer_count,
+                  table_->request_count());
+        return delay;
+    }
+
+    DB db_;
+    VlanTable *table_;
+    uint32_t next_tag_;
+};
+
+TEST_F(DBPartitionTest, QueueLenStats) {
+    DBPartition *partition = db_.GetPartition(0);
+    uint64_t total = partition->total_request_count();
+
+    // Disable the queue so that requests accumulate.
+    db_.SetQueueDisable(true);
+    for (uint32_t tag = 0; tag < 100; ++tag) {
+        DBRequest req;
+        req.oper = DBRequest::DB_ENTRY_ADD_CHANGE;
+        req.key.reset(new VlanTableReqKey(tag));
+        req.data.reset(new VlanTableReqData(tag));
+        table_->Enqueue(&req);
+    }
+    next_tag_ = 100;
+    task_util::WaitForIdle();
+    EXPECT_EQ(100, partition->request_queue_len());
+    EXPECT_EQ(100, partition->max_request_queue_len());
+    EXPECT_EQ(total + 100, partition->total_request_count());
+    EXPECT_FALSE(db_.IsDBQueueEmpty());
+
+    // Enqueues observed lengths 1..100, so buckets 0 through 6 are in use.
+    std::vector<uint64_t> histogram;
+    partition->request_queue_len_histogram(&histogram);
+    EXPECT_EQ(DBPartition::kQueueLenHistogramSize, histogram.size());
+    EXPECT_EQ(1, histogram[0]);
+    EXPECT_EQ(2, histogram[1]);
+    EXPECT_EQ(4, histogram[2]);
+    EXPECT_EQ(37, histogram[6]);
+    EXPECT_EQ(0, histogram[7]);
+
+    db_.SetQueueDisable(false);
+    task_util::WaitForIdle();
+    EXPECT_EQ(0, partition->request_queue_len());
+    EXPECT_EQ(100, partition->max_request_queue_len());
+    EXPECT_EQ(100, table_->Size());
+    EXPECT_TRUE(db_.IsDBQueueEmpty());
+}
+
+// Requests enqueued as a list are processed in order, and the queue length
+// stats observe the list as a single enqueue.
+TEST_F(DBPartitionTest, EnqueueList) {
+    DBPartition *partition = db_.GetPartition(0);
+    uint64_t total = partition->total_request_count();
+    uint32_t base = table_->request_count();
+
+    db_.SetQueueDisable(true);
+    DBRequestList reqs;
+    for (uint32_t tag = 0; tag < 100; ++tag) {
+        DBRequest *req = new DBRequest(DBRequest::DB_ENTRY_ADD_CHANGE);
+        req->key.reset(new VlanTableReqKey(tag));
+        req->data.reset(new VlanTableReqData(tag));
+        reqs.push_back(req);
+    }
+    DBRequest *req = new DBRequest(DBRequest::DB_ENTRY_DELETE);
+    req->key.reset(new VlanTableReqKey(99));
+    reqs.push_back(req);
+    EXPECT_TRUE(table_->Enqueue(&reqs));
+    EXPECT_TRUE(reqs.empty());
+    task_util::WaitForIdle();
+    EXPECT_EQ(101, partition->request_queue_len());
+    EXPECT_EQ(total + 101, partition->total_request_count());
+
+    std::vector<uint64_t> histogram;
+    partition->request_queue_len_histogram(&histogram);
+    EXPECT_EQ(1, histogram[6]);
+
+    db_.SetQueueDisable(false);
+    task_util::WaitForIdle();
+    EXPECT_EQ(0, partition->request_queue_len());
+    EXPECT_EQ(base + 101, table_->request_count());
+    EXPECT_EQ(99, table_->Size());
+    EXPECT_TRUE(db_.IsDBQueueEmpty());
+
+    // The remaining entries are deleted with a list as well.
+    for (uint32_t tag = 0; tag < 99; ++tag) {
+        req = new DBRequest(DBRequest::DB_ENTRY_DELETE);
+        req->key.reset(new VlanTableReqKey(tag));
+        reqs.push_back(req);
+    }
+    EXPECT_TRUE(table_->Enqueue(&reqs));
+    task_util::WaitForIdle();
+    EXPECT_EQ(0, table_->Size());
+}
+
+// Enqueue throughput as the number of concurrent producers grows.
+TEST_F(DBPartitionTest, EnqueueScale) {
+    uint32_t count = ENQUEUE_COUNT;
+    char *str = getenv("DB_PARTITION_ENQUEUE_COUNT");
+    if (str) count = strtoul(str, NULL, 0);
+
+    for (uint32_t producers = 1; producers <= 16; producers *= 2) {
+        uint64_t delay = EnqueueScale(producers, count);
+        std::cout << "Producers " << producers << " Requests " << count <<
+            " Time " << delay << " usec Rate " <<
+            (delay ? (count * 1000000ULL) / delay : 0) << " req/sec" <<
+            std::endl;
+    }
+}
+
+// Enqueue throughput with requests enqueued in lists.
+TEST_F(DBPartitionTest, EnqueueListScale) {
+    uint32_t count = ENQUEUE_COUNT;
+    char *str = getenv("DB_PARTITION_ENQUEUE_COUNT");
+    if (str) count = strtoul(str, NULL, 0);
+
+    for (uint32_t batch_size = 1; batch_size <= 256; batch_size *= 16) {
+        for (uint32_t producers = 1; producers <= 16; producers *= 4) {
+            uint64_t delay = EnqueueScale(producers, count, batch_size);
+            std::cout << "Batch " << batch_size << " Producers " <<
+                producers << " Requests " << count << " Time " << delay <<
+                " usec Rate " <<
+                (delay ? (count * 1000000ULL) / delay : 0) << " req/sec" <<
+                std::endl;
+        }
+    }
+}
+
+void RegisterFactory() {
+    DB::RegisterFactory("db.test.vlan.0", &VlanTable::CreateTable);
+}
+
+int main(int argc, char **argv) {
+    LoggingInit();
+    ::testing::InitGoogleTest(&argc, argv);
+
+    RegisterFactory();
+
+    return RUN_ALL_TESTS();
+}
@@ -6,6 +6,7 @@
 
 #include "base/bitset.h"
 #include "base/time_util.h"
+#include "ifmap/ifmap_encoder.h"
 #include "ifmap/ifmap_exporter.h"
 #include "ifmap/ifmap_update.h"
 
@@ -19,6 +20,12 @@ IFMapClient::IFMapClient()
 IFMapClient::~IFMapClient() {
 }
 
+bool IFMapClient::SendUpdate(
+    const boost::shared_ptr<const IFMapEncodedMessage> &msg) {
+    return SendUpdate(
+        msg->ToString(IFMapEncodedMessage::EscapeIdentifier(identifier())));
+}
+
 void IFMapClient::Initialize(IFMapExporter *exporter, int index) {
     index_ = index;
     exporter_ = exporter;
@@ -9,8 +9,10 @@
 #include <map>
 #include <string>
 #include <vector>
+#include <boost/shared_ptr.hpp>
 #include <boost/unordered_set.hpp>
 
+class IFMapEncodedMessage;
 class IFMapExporter;
 class IFMapState;
 
@@ -25,6 +27,10 @@ public:
 
     virtual const std::string &identifier() const = 0;
     virtual bool SendUpdate(const std::string &msg) = 0;
+    // Send a message encoded once for all its receivers. The default sends
+    // a private copy of the message addressed to this client.
+    virtual bool SendUpdate(
+        const boost::shared_ptr<const IFMapEncodedMessage> &msg);
     virtual const std::string &name() const { return name_; }
     virtual void SetName(const std::string &name) { name_ = name; }
 
@@ -0,0 +1,390 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include "ifmap/ifmap_client_set.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "base/bitset.h"
+
+using std::string;
+
+namespace {
+
+struct BlockIndexLess {
+    template <typename BlockType>
+    bool operator()(const BlockType &block, uint32_t index) const {
+        return block.index < index;
+    }
+};
+
+}  // namespace
+
+const size_t IFMapClientSet::npos;
+const size_t IFMapClientSet::kBlockBits;
+
+IFMapClientSet::Block::Block(uint32_t index) : index(index) {
+    for (size_t i = 0; i < kBlockWords; ++i) {
+        words[i] = 0;
+    }
+}
+
+bool IFMapClientSet::Block::IsZero() const {
+    uint64_t result = 0;
+    for (size_t i = 0; i < kBlockWords; ++i) {
+        result |= words[i];
+    }
+    return result == 0;
+}
+
+IFMapClientSet::IFMapClientSet(const BitSet &bset) {
+    BlockList blocks;
+    for (size_t pos = bset.find_first(); pos != BitSet::npos;
+         pos = bset.find_next(pos)) {
+        uint32_t index = pos / kBlockBits;
+        if (blocks.empty() || blocks.back().index != index) {
+            blocks.push_back(Block(index));
+        }
+        size_t bit = pos % kBlockBits;
+        blocks.back().words[bit / kWordBits] |= 1ULL << (bit % kWordBits);
+    }
+    Assign(&blocks);
+}
+
+const IFMapClientSet::BlockList &IFMapClientSet::blocks() const {
+    static const BlockList empty_blocks;
+    return rep_.get() ? rep_->blocks : empty_blocks;
+}
+
+const IFMapClientSet::Block *IFMapClientSet::FindBlock(size_t pos) const {
+    const BlockList &list = blocks();
+    uint32_t index = pos / kBlockBits;
+    BlockList::const_iterator it =
+        std::lower_bound(list.begin(), list.end(), index, BlockIndexLess());
+    if (it == list.end() || it->index != index)
+        return NULL;
+    return &*it;
+}
+
+// Return the block list for modification, copying it if it's shared.
+IFMapClientSet::BlockList *IFMapClientSet::Mutable() {
+    if (rep_.get() == NULL) {
+        rep_.reset(new Rep);
+    } else if (rep_->refcount > 1) {
+        Rep *rep = new Rep;
+        rep->blocks = rep_->blocks;
+        rep_.reset(rep);
+    }
+    return &rep_->blocks;
+}
+
+// Take over the contents of blocks, which must not have zero blocks.
+void IFMapClientSet::Assign(BlockList *blocks) {
+    if (blocks->empty()) {
+        rep_.reset();
+        return;
+    }
+    Rep *rep = new Rep;
+    rep->blocks.swap(*blocks);
+    rep_.reset(rep);
+}
+
+size_t IFMapClientSet::count() const {
+    const BlockList &list = blocks();
+    size_t result = 0;
+    for (BlockList::const_iterator it = list.begin(); it != list.end(); ++it) {
+        for (size_t i = 0; i < kBlockWords; ++i) {
+            result += __builtin_popcountll(it->words[i]);
+        }
+    }
+    return result;
+}
+
+bool IFMapClientSet::test(size_t pos) const {
+    const Block *block = FindBlock(pos);
+    if (block == NULL)
+        return false;
+    size_t bit = pos % kBlockBits;
+    return (block->words[bit / kWordBits] & (1ULL << (bit % kWordBits))) != 0;
+}
+
+size_t IFMapClientSet::find_first() const {
+    if (empty())
+        return npos;
+    return find_next(npos);
+}
+
+// Returns the first bit set after pos. A pos of npos wraps around to 0.
+size_t IFMapClientSet::find_next(size_t pos) const {
+    const BlockList &list = blocks();
+    size_t start = pos + 1;
+    uint32_t index = start / kBlockBits;
+    BlockList::const_iterator it =
+        std::lower_bound(list.begin(), list.end(), index, BlockIndexLess());
+    if (it != list.end() && it->index == index) {
+        size_t bit = start % kBlockBits;
+        for (size_t i = bit / kWordBits; i < kBlockWords; ++i) {
+            uint64_t word = it->words[i];
+            if (i == bit / kWordBits) {
+                word &= ~0ULL << (bit % kWordBits);
+            }
+            if (word) {
+                return index * kBlockBits + i * kWordBits +
+                    __builtin_ctzll(word);
+            }
+        }
+        ++it;
+    }
+    if (it == list.end())
+        return npos;
+    // Blocks are never zero, the next one has the bit.
+    for (size_t i = 0; i < kBlockWords; ++i) {
+        if (it->words[i]) {
+            return it->index * kBlockBits + i * kWordBits +
+                __builtin_ctzll(it->words[i]);
+        }
+    }
+    assert(false);
+    return npos;
+}
+
+void IFMapClientSet::set(size_t pos) {
+    if (test(pos))
+        return;
+    BlockList *list = Mutable();
+    uint32_t index = pos / kBlockBits;
+    BlockList::iterator it =
+        std::lower_bound(list->begin(), list->end(), index, BlockIndexLess());
+    if (it == list->end() || it->index != index) {
+        it = list->insert(it, Block(index));
+    }
+    size_t bit = pos % kBlockBits;
+    it->words[bit / kWordBits] |= 1ULL << (bit % kWordBits);
+}
+
+void IFMapClientSet::reset(size_t pos) {
+    if (!test(pos))
+        return;
+    BlockList *list = Mutable();
+    uint32_t index = pos / kBlockBits;
+    BlockList::iterator it =
+        std::lower_bound(list->begin(), list->end(), index, BlockIndexLess());
+    size_t bit = pos % kBlockBits;
+    it->words[bit / kWordBits] &= ~(1ULL << (bit % kWordBits));
+    if (it->IsZero()) {
+        list->erase(it);
+        if (list->empty()) {
+            rep_.reset();
+        }
+    }
+}
+
+bool IFMapClientSet::operator==(const IFMapClientSet &rhs) const {
+    if (rep_ == rhs.rep_)
+        return true;
+    if (empty() || rhs.empty())
+        return false;
+    const BlockList &lhs_list = blocks();
+    const BlockList &rhs_list = rhs.blocks();
+    if (lhs_list.size() != rhs_list.size())
+        return false;
+    for (size_t n = 0; n < lhs_list.size(); ++n) {
+        const Block &lblock = lhs_list[n];
+        const Block &rblock = rhs_list[n];
+        if (lblock.index != rblock.index)
+            return false;
+        uint64_t diff = 0;
+        for (size_t i = 0; i < kBlockWords; ++i) {
+            diff |= lblock.words[i] ^ rblock.words[i];
+        }
+        if (diff)
+            return false;
+    }
+    return true;
+}
+
+bool IFMapClientSet::Contains(const IFMapClientSet &rhs) const {
+    if (rep_ == rhs.rep_ || rhs.empty())
+        return true;
+    const BlockList &lhs_list = blocks();
+    const BlockList &rhs_list = rhs.blocks();
+    if (lhs_list.size() < rhs_list.size())
+        return false;
+    BlockList::const_iterator lit = lhs_list.begin();
+    for (BlockList::const_iterator rit = rhs_list.begin();
+         rit != rhs_list.end(); ++rit) {
+        while (lit != lhs_list.end() && lit->index < rit->index) {
+            ++lit;
+        }
+        if (lit == lhs_list.end() || lit->index != rit->index)
+            return false;
+        uint64_t missing = 0;
+        for (size_t i = 0; i < kBlockWords; ++i) {
+            missing |= rit->words[i] & ~lit->words[i];
+        }
+        if (missing)
+            return false;
+    }
+    return true;
+}
+
+bool IFMapClientSet::Intersects(const IFMapClientSet &rhs) const {
+    if (empty() || rhs.empty())
+        return false;
+    if (rep_ == rhs.rep_)
+        return true;
+    const BlockList &lhs_list = blocks();
+    const BlockList &rhs_list = rhs.blocks();
+    BlockList::const_iterator lit = lhs_list.begin();
+    BlockList::const_iterator rit = rhs_list.begin();
+    while (lit != lhs_list.end() && rit != rhs_list.end()) {
+        if (lit->index < rit->index) {
+            ++lit;
+        } else if (rit->index < lit->index) {
+            ++rit;
+        } else {
+            uint64_t common = 0;
+            for (size_t i = 0; i < kBlockWords; ++i) {
+                common |= lit->words[i] & rit->words[i];
+            }
+            if (common)
+                return true;
+            ++lit;
+            ++rit;
+        }
+    }
+    return false;
+}
+
+IFMapClientSet &IFMapClientSet::operator|=(const IFMapClientSet &rhs) {
+    if (Contains(rhs))
+        return *this;
+    if (rhs.Contains(*this)) {
+        rep_ = rhs.rep_;
+        return *this;
+    }
+
+    const BlockList &lhs_list = blocks();
+    const BlockList &rhs_list = rhs.blocks();
+    BlockList result;
+    result.reserve(lhs_list.size() + rhs_list.size());
+    BlockList::const_iterator lit = lhs_list.begin();
+    BlockList::const_iterator rit = rhs_list.begin();
+    while (lit != lhs_list.end() || rit != rhs_list.end()) {
+        if (rit == rhs_list.end() ||
+            (lit != lhs_list.end() && lit->index < rit->index)) {
+            result.push_back(*lit++);
+        } else if (lit == lhs_list.end() || rit->index < lit->index) {
+            result.push_back(*rit++);
+        } else {
+            Block block(lit->index);
+            for (size_t i = 0; i < kBlockWords; ++i) {
+                block.words[i] = lit->words[i] | rit->words[i];
+            }
+            result.push_back(block);
+            ++lit;
+            ++rit;
+        }
+    }
+    Assign(&result);
+    return *this;
+}
+
+void IFMapClientSet::Reset(const IFMapClientSet &rhs) {
+    if (!Intersects(rhs))
+        return;
+
+    const BlockList &lhs_list = blocks();
+    const BlockList &rhs_list = rhs.blocks();
+    BlockList result;
+    result.reserve(lhs_list.size());
+    BlockList::const_iterator rit = rhs_list.begin();
+    for (BlockList::const_iterator lit = lhs_list.begin();
+         lit != lhs_list.end(); ++lit) {
+        while (rit != rhs_list.end() && rit->index < lit->index) {
+            ++rit;
+        }
+        if (rit == rhs_list.end() || rit->index != lit->index) {
+            result.push_back(*lit);
+            continue;
+        }
+        Block block(lit->index);
+        for (size_t i = 0; i < kBlockWords; ++i) {
+            block.words[i] = lit->words[i] & ~rit->words[i];
+        }
+        if (!block.IsZero()) {
+            result.push_back(block);
+        }
+    }
+    Assign(&result);
+}
+
+void IFMapClientSet::BuildComplement(const IFMapClientSet &lhs,
+                                     const IFMapClientSet &rhs) {
+    IFMapClientSet result(lhs);
+    result.Reset(rhs);
+    rep_.swap(result.rep_);
+}
+
+IFMapClientSet operator&(const IFMapClientSet &lhs,
+                         const IFMapClientSet &rhs) {
+    typedef IFMapClientSet::BlockList BlockList;
+    typedef IFMapClientSet::Block Block;
+
+    if (lhs.Contains(rhs))
+        return rhs;
+    if (rhs.Contains(lhs))
+        return lhs;
+
+    const BlockList &lhs_list = lhs.blocks();
+    const BlockList &rhs_list = rhs.blocks();
+    BlockList result;
+    BlockList::const_iterator lit = lhs_list.begin();
+    BlockList::const_iterator rit = rhs_list.begin();
+    while (lit != lhs_list.end() && rit != rhs_list.end()) {
+        if (lit->index < rit->index) {
+            ++lit;
+        } else if (rit->index < lit->index) {
+            ++rit;
+        } else {
+            Block block(lit->index);
+            for (size_t i = 0; i < IFMapClientSet::kBlockWords; ++i) {
+                block.words[i] = lit->words[i] & rit->words[i];
+            }
+            if (!block.IsZero()) {
+                result.push_back(block);
+            }
+            ++lit;
+            ++rit;
+        }
+    }
+    IFMapClientSet intersection;
+    intersection.Assign(&result);
+    return intersection;
+}
+
+BitSet IFMapClientSet::ToBitSet() const {
+    BitSet bset;
+    for (size_t pos = find_first(); pos != npos; pos = find_next(pos)) {
+        bset.set(pos);
+    }
+    return bset;
+}
+
+string IFMapClientSet::ToString() const {
+    return ToBitSet().ToString();
+}
+
+string IFMapClientSet::ToNumberedString() const {
+    return ToBitSet().ToNumberedString();
+}
+
+size_t IFMapClientSet::memory() const {
+    size_t size = sizeof(*this);
+    if (rep_.get()) {
+        size += sizeof(Rep) + rep_->blocks.capacity() * sizeof(Block);
+    }
+    return size;
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#ifndef SRC_IFMAP_IFMAP_CLIENT_SET_H_
+#define SRC_IFMAP_IFMAP_CLIENT_SET_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+#include <boost/intrusive_ptr.hpp>
+#include <tbb/atomic.h>
+
+class BitSet;
+
+//
+// Compressed set of client indices, used for the interest and advertised
+// sets of the IFMapState of every node and link.
+//
+// A BitSet is a flat vector of words sized to the highest client index, so
+// a node of interest to a single vrouter with a high index costs as much
+// as one of interest to all of them. Here bits are grouped in blocks of
+// kBlockBits and only the non-empty blocks are stored, ordered by block
+// index. Set operations walk the two block lists in step and operate on
+// the kBlockWords words of matching blocks in fixed size loops, which the
+// compiler unrolls and vectorizes.
+//
+// The block list is immutable and reference counted. Copies share it and
+// a modification makes a private copy only if it is shared (copy on write).
+// Operations that leave a set unchanged don't copy, and operations whose
+// result is equal to one of the operands share the operand's block list,
+// e.g. the interest of a link is shared with its nodes when they have the
+// same interest, and the interest of all nodes reached by a graph walk is
+// shared when they had none before.
+//
+class IFMapClientSet {
+public:
+    static const size_t npos = static_cast<size_t>(-1);
+    static const size_t kBlockBits = 256;
+
+    IFMapClientSet() { }
+    explicit IFMapClientSet(const BitSet &bset);
+
+    bool empty() const { return rep_.get() == NULL; }
+    size_t count() const;
+    bool test(size_t pos) const;
+    size_t find_first() const;
+    size_t find_next(size_t pos) const;
+
+    void set(size_t pos);
+    void reset(size_t pos);
+    void clear() { rep_.reset(); }
+
+    bool operator==(const IFMapClientSet &rhs) const;
+    bool operator!=(const IFMapClientSet &rhs) const {
+        return !operator==(rhs);
+    }
+
+    // Returns true if all bits of rhs are set in this.
+    bool Contains(const IFMapClientSet &rhs) const;
+    // Returns true if any bit is set in both this and rhs.
+    bool Intersects(const IFMapClientSet &rhs) const;
+
+    IFMapClientSet &operator|=(const IFMapClientSet &rhs);
+    // this = this - rhs
+    void Reset(const IFMapClientSet &rhs);
+    // this = lhs - rhs
+    void BuildComplement(const IFMapClientSet &lhs, const IFMapClientSet &rhs);
+
+    BitSet ToBitSet() const;
+    std::string ToString() const;
+    std::string ToNumberedString() const;
+
+    // Bytes used by the set, including the shared block list.
+    size_t memory() const;
+    // Returns true if the block list is shared with other sets.
+    bool shared() const { return rep_.get() != NULL && rep_->refcount > 1; }
+
+    friend IFMapClientSet operator&(const IFMapClientSet &lhs,
+                                    const IFMapClientSet &rhs);
+
+private:
+    static const size_t kWordBits = 64;
+    static const size_t kBlockWords = kBlockBits / kWordBits;
+
+    struct Block {
+        explicit Block(uint32_t index);
+        bool IsZero() const;
+
+        // The first bit in the block is index * kBlockBits.
+        uint32_t index;
+        uint64_t words[kBlockWords];
+    };
+    typedef std::vector<Block> BlockList;
+
+    struct Rep {
+        Rep() { refcount = 0; }
+        tbb::atomic<int> refcount;
+        BlockList blocks;
+    };
+
+    friend void intrusive_ptr_add_ref(Rep *rep) {
+        rep->refcount++;
+    }
+    friend void intrusive_ptr_release(Rep *rep) {
+        if (--rep->refcount == 0)
+            delete rep;
+    }
+
+    const BlockList &blocks() const;
+    const Block *FindBlock(size_t pos) const;
+    BlockList *Mutable();
+    void Assign(BlockList *blocks);
+
+    boost::intrusive_ptr<Rep> rep_;
+};
+
+#endif  // SRC_IFMAP_IFMAP_CLIENT_SET_H_
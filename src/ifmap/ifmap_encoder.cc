@@ -4,7 +4,6 @@
 
 #include "ifmap/ifmap_encoder.h"
 
-#include <sstream>
 #include "ifmap/ifmap_link.h"
 #include "ifmap/ifmap_object.h"
 #include "ifmap/ifmap_update.h"
@@ -12,6 +11,84 @@
 using namespace pugi;
 using namespace std;
 
+namespace {
+
+// Saves the document directly into a string.
+class StringWriter : public xml_writer {
+public:
+    explicit StringWriter(string *str) : str_(str) { }
+    virtual void write(const void *data, size_t size) {
+        str_->append(static_cast<const char *>(data), size);
+    }
+
+private:
+    string *str_;
+};
+
+}  // namespace
+
+const char IFMapEncodedMessage::kReceiverSuffix[] = "/config";
+
+IFMapEncodedMessage::IFMapEncodedMessage(string *text, size_t receiver_offset)
+    : receiver_offset_(receiver_offset) {
+    text_.swap(*text);
+    assert(receiver_offset_ <= text_.size());
+}
+
+string IFMapEncodedMessage::EscapeIdentifier(const string &identifier) {
+    string receiver;
+    receiver.reserve(identifier.size());
+    for (string::const_iterator it = identifier.begin();
+         it != identifier.end(); ++it) {
+        switch (*it) {
+        case '&':
+            receiver.append("&amp;");
+            break;
+        case '<':
+            receiver.append("&lt;");
+            break;
+        case '>':
+            receiver.append("&gt;");
+            break;
+        case '"':
+            receiver.append("&quot;");
+            break;
+        case '\'':
+            receiver.append("&apos;");
+            break;
+        default:
+            receiver.push_back(*it);
+            break;
+        }
+    }
+    return receiver;
+}
+
+size_t IFMapEncodedMessage::size(const string &receiver) const {
+    return text_.size() + receiver.size() + sizeof(kReceiverSuffix) - 1;
+}
+
+void IFMapEncodedMessage::GetBuffers(const string &receiver,
+                                     vector<boost::asio::const_buffer> *buffers)
+    const {
+    buffers->push_back(boost::asio::buffer(text_.data(), receiver_offset_));
+    buffers->push_back(boost::asio::buffer(receiver));
+    buffers->push_back(boost::asio::buffer(kReceiverSuffix,
+                                           sizeof(kReceiverSuffix) - 1));
+    buffers->push_back(boost::asio::buffer(text_.data() + receiver_offset_,
+                                           text_.size() - receiver_offset_));
+}
+
+string IFMapEncodedMessage::ToString(const string &receiver) const {
+    string msg;
+    msg.reserve(size(receiver));
+    msg.append(text_, 0, receiver_offset_);
+    msg.append(receiver);
+    msg.append(kReceiverSuffix);
+    msg.append(text_, receiver_offset_, string::npos);
+    return msg;
+}
+
 IFMapMessage::IFMapMessage() : op_type_(NONE), node_count_(0),
     objects_per_message_(kObjectsPerMessage) {
     // init empty document
@@ -27,20 +104,20 @@ void IFMapMessage::Open() {
     config_ = iq.append_child("config");
 }
 
+//
+// Save the document once, with an empty 'to' attribute. The attribute is
+// the first one with that name in the text since the iq element is the
+// first element of the document.
+//
 void IFMapMessage::Close() {
-    ostringstream oss;
-    doc_.save(oss);
-    str_ = oss.str();
-}
-
-void IFMapMessage::SetReceiverInMsg(const std::string &cli_identifier) {
-    xml_node iq = doc_.child("iq");
-    assert(iq);
-    xml_attribute iqattr = iq.attribute("to");
-    assert(iqattr);
-    std::string str(cli_identifier);
-    str += "/config";
-    iqattr.set_value(str.c_str());
+    static const char kReceiverAttribute[] = " to=\"";
+    string text;
+    StringWriter writer(&text);
+    doc_.save(writer);
+    size_t offset = text.find(kReceiverAttribute);
+    assert(offset != string::npos);
+    offset += sizeof(kReceiverAttribute) - 1;
+    encoded_.reset(new IFMapEncodedMessage(&text, offset));
 }
 
 void IFMapMessage::SetObjectsPerMessage(int num) {
@@ -123,5 +200,6 @@ void IFMapMessage::Reset() {
     doc_.remove_child("iq");
     node_count_ = 0;
     op_type_ = NONE;
+    encoded_.reset();
     Open();
 }
@@ -5,27 +5,70 @@
 #ifndef __ctrlplane__ifmap_encoder__
 #define __ctrlplane__ifmap_encoder__
 
+#include <string>
+#include <vector>
+#include <boost/asio/buffer.hpp>
+#include <boost/shared_ptr.hpp>
 #include <pugixml/pugixml.hpp>
 
 class IFMapNode;
 class IFMapLink;
 class IFMapUpdate;
 
+//
+// A config message encoded once for all the clients it's sent to. The text
+// has an empty 'to' attribute in the iq element and the receiver address of
+// each client is inserted at receiver_offset() when the message is sent to
+// it, so the text itself is shared rather than copied per client.
+//
+// The receiver passed to the methods below is the identifier of the client
+// as returned by EscapeIdentifier, since it is inserted in the text as is.
+//
+class IFMapEncodedMessage {
+public:
+    IFMapEncodedMessage(std::string *text, size_t receiver_offset);
+
+    // Returns the identifier with the characters that are special in an XML
+    // attribute value replaced by entity references.
+    static std::string EscapeIdentifier(const std::string &identifier);
+
+    const std::string &text() const { return text_; }
+    size_t receiver_offset() const { return receiver_offset_; }
+
+    // Size of the message sent to the given receiver.
+    size_t size(const std::string &receiver) const;
+
+    // Append the fragments of the message for the given receiver. The
+    // buffers refer to the text and to receiver.
+    void GetBuffers(const std::string &receiver,
+                    std::vector<boost::asio::const_buffer> *buffers) const;
+
+    // Returns a copy of the message for the given receiver.
+    std::string ToString(const std::string &receiver) const;
+
+private:
+    static const char kReceiverSuffix[];
+
+    std::string text_;
+    size_t receiver_offset_;
+};
+
 class IFMapMessage {
 public:
+    typedef boost::shared_ptr<const IFMapEncodedMessage> EncodedPtr;
+
     static const int kObjectsPerMessage = 16;
     IFMapMessage();
 
+    // Encode the message. The result is shared by all the receivers.
     void Close();
-    // set the 'to' field in the message
-    void SetReceiverInMsg(const std::string &cli_identifier);
     void SetObjectsPerMessage(int num);
     void EncodeUpdate(const IFMapUpdate *update);
     bool IsFull();
     bool IsEmpty();
     void Reset();
 
-    const std::string &get_string() const { return str_; }
+    const EncodedPtr &encoded() const { return encoded_; }
 
 private:
     enum Op {
@@ -41,7 +84,7 @@ private:
     pugi::xml_node config_;
     Op op_type_;             // the current  type of op_node_
     pugi::xml_node op_node_;
-    std::string str_;
+    EncodedPtr encoded_;
     int node_count_;
     int objects_per_message_;
 };
@@ -7,6 +7,8 @@
 #include <boost/bind.hpp>
 #include <boost/checked_delete.hpp>
 
+#include "base/time_util.h"
+#include "base/util.h"
 #include "db/db.h"
 #include "db/db_table_partition.h"
 #include "ifmap/ifmap_client.h"
@@ -34,8 +36,33 @@ private:
     DBTableBase::ListenerId id_;
 };
 
+// Adds the time spent in a table listener to export_time_. The listeners
+// call each other, e.g. from RemoveDependentLinks and ProcessAdjacentNode,
+// so only the outermost call is timed.
+class IFMapExporter::ExportTimer {
+public:
+    explicit ExportTimer(IFMapExporter *exporter)
+        : exporter_(exporter), start_(0) {
+        if (exporter_->export_depth_++ == 0) {
+            start_ = ClockMonotonicUsec();
+        }
+    }
+    ~ExportTimer() {
+        if (--exporter_->export_depth_ == 0) {
+            exporter_->export_time_ += ClockMonotonicUsec() - start_;
+        }
+    }
+
+private:
+    IFMapExporter *exporter_;
+    uint64_t start_;
+
+    DISALLOW_COPY_AND_ASSIGN(ExportTimer);
+};
+
 IFMapExporter::IFMapExporter(IFMapServer *server)
-        : server_(server), link_table_(NULL) {
+        : server_(server), link_table_(NULL), node_export_count_(0),
+          link_export_count_(0), export_time_(0), export_depth_(0) {
 }
 
 IFMapExporter::~IFMapExporter() {
@@ -114,25 +141,21 @@ bool IFMapExporter::IsFeasible(const IFMapNode *node) {
     return true;
 }
 
-const BitSet *IFMapExporter::MergeClientInterest(
-    IFMapNode * node, IFMapNodeState *state, std::auto_ptr<BitSet> *ptr) {
-
-    const BitSet *set = &state->interest();
+// Copies of the interest share the block list with the state.
+IFMapClientSet IFMapExporter::MergeClientInterest(IFMapNode *node,
+                                                  IFMapNodeState *state) {
     IFMapTable *table = node->table();
 
     if (table->name() == "__ifmap__.virtual_router.0") {
         IFMapClient *client = server_->FindClient(node->name());
-        if (!client) {
-            return set;
+        if (client && !state->interest().test(client->index())) {
+            IFMapClientSet merged_set(state->interest());
+            merged_set.set(client->index());
+            StateInterestSet(state, merged_set);
         }
-        BitSet *merged_set = new BitSet(*set);
-        merged_set->set(client->index());
-        ptr->reset(merged_set);
-        StateInterestSet(state, *merged_set);
-        return merged_set;
     }
 
-    return set;
+    return state->interest();
 }
 
 IFMapNodeState *IFMapExporter::NodeStateLookup(IFMapNode *node){
@@ -163,13 +186,14 @@ IFMapUpdateSender *IFMapExporter::sender() {
 
 template <class ObjectType>
 bool IFMapExporter::UpdateAddChange(ObjectType *obj, IFMapState *state,
-                                    const BitSet &add_set, const BitSet &rm_set,
+                                    const IFMapClientSet &add_set,
+                                    const IFMapClientSet &rm_set,
                                     bool change) {
     // Remove any bit in "advertise" from the positive update.
     // This is a NOP in case the interest set is non empty and this is change.
     IFMapUpdate *update = state->GetUpdate(IFMapListEntry::UPDATE);
-    if (update != NULL) {
-        update->AdvertiseReset(rm_set);
+    if (update != NULL && !rm_set.empty()) {
+        update->AdvertiseReset(rm_set.ToBitSet());
     }
 
     if (state->interest().empty()) {
@@ -187,12 +211,13 @@ bool IFMapExporter::UpdateAddChange(ObjectType *obj, IFMapState *state,
 
     bool is_move = false;
     if (update != NULL) {
+        IFMapClientSet advertise(update->advertise());
         if (!change) {
-            if (update->advertise().Contains(add_set)) {
+            if (advertise.Contains(add_set)) {
                 return false;
             }
         } else {
-            if (state->interest() == update->advertise()) {
+            if (state->interest() == advertise) {
                 return false;
             }
         }
@@ -204,9 +229,9 @@ bool IFMapExporter::UpdateAddChange(ObjectType *obj, IFMapState *state,
     }
 
     if (!change) {
-        update->AdvertiseOr(add_set);
+        update->AdvertiseOr(add_set.ToBitSet());
     } else {
-        update->SetAdvertise(state->interest());
+        update->SetAdvertise(state->interest().ToBitSet());
     }
     queue()->Enqueue(update);
     sender()->QueueActive();
@@ -215,11 +240,11 @@ bool IFMapExporter::UpdateAddChange(ObjectType *obj, IFMapState *state,
 
 template <class ObjectType>
 bool IFMapExporter::UpdateRemove(ObjectType *obj, IFMapState *state,
-                                 const BitSet &rm_set) {
+                                 const IFMapClientSet &rm_set) {
     // Remove any bit in "interest" from the delete update.
     IFMapUpdate *update = state->GetUpdate(IFMapListEntry::DEL);
-    if (update != NULL) {
-        update->AdvertiseReset(state->interest());
+    if (update != NULL && !state->interest().empty()) {
+        update->AdvertiseReset(state->interest().ToBitSet());
     }
 
     if (rm_set.empty()) {
@@ -233,7 +258,7 @@ bool IFMapExporter::UpdateRemove(ObjectType *obj, IFMapState *state,
 
     bool is_move = false;
     if (update != NULL) {
-        if (rm_set == update->advertise()) {
+        if (rm_set == IFMapClientSet(update->advertise())) {
             return false;
         }
         is_move = true;
@@ -243,7 +268,7 @@ bool IFMapExporter::UpdateRemove(ObjectType *obj, IFMapState *state,
         state->Insert(update);
     }
 
-    update->SetAdvertise(rm_set);
+    update->SetAdvertise(rm_set.ToBitSet());
     queue()->Enqueue(update);
     sender()->QueueActive();
     return is_move;
@@ -271,7 +296,7 @@ void IFMapExporter::EnqueueDelete(ObjectType *obj, IFMapState *state) {
         update = new IFMapUpdate(obj, false);
         state->Insert(update);
     }
-    update->SetAdvertise(state->advertised());
+    update->SetAdvertise(state->advertised().ToBitSet());
     queue()->Enqueue(update);
     sender()->QueueActive();
 }
@@ -315,7 +340,7 @@ void IFMapExporter::MoveAdjacentNode(IFMapNodeState *state) {
 }
 
 void IFMapExporter::RemoveDependentLinks(IFMapNodeState *state,
-                                         const BitSet &rm_set) {
+                                         const IFMapClientSet &rm_set) {
     for (IFMapNodeState::iterator iter = state->begin(), next = state->begin();
          iter != state->end(); iter = next) {
         IFMapLink *link = iter.operator->();
@@ -324,19 +349,18 @@ void IFMapExporter::RemoveDependentLinks(IFMapNodeState *state,
         if (ls == NULL) {
             continue;
         }
-        BitSet common = ls->advertised() & rm_set;
-        if (!common.empty()) {
+        if (ls->advertised().Intersects(rm_set)) {
             LinkTableExport(link->get_table_partition(), link);
         }
     }
 }
 
-void IFMapExporter::ProcessAdjacentNode(IFMapNode *node, const BitSet &add_set,
-        IFMapNodeState *state) {
-    BitSet current = state->advertised();
+void IFMapExporter::ProcessAdjacentNode(IFMapNode *node,
+        const IFMapClientSet &add_set, IFMapNodeState *state) {
+    IFMapClientSet current = state->advertised();
     IFMapUpdate *update = state->GetUpdate(IFMapListEntry::UPDATE);
     if (update) {
-        current |= update->advertise();
+        current |= IFMapClientSet(update->advertise());
     }
     if (!current.Contains(add_set)) {
         NodeTableExport(node->get_table_partition(), node);
@@ -369,6 +393,8 @@ void IFMapExporter::DeleteStateIfAppropriate(DBTable *table, DBEntryBase *entry,
 // also.
 void IFMapExporter::NodeTableExport(DBTablePartBase *partition,
                                     DBEntryBase *entry) {
+    ExportTimer timer(this);
+    node_export_count_++;
     IFMapNode *node = static_cast<IFMapNode *>(entry);
     DBTable *table = static_cast<DBTablePartition *>(partition)->table();
 
@@ -385,12 +411,12 @@ void IFMapExporter::NodeTableExport(DBTablePartBase *partition,
 
         // This is an add operation for nodes that are interested and
         // have not seen the advertisement.
-        BitSet add_set;
+        IFMapClientSet add_set;
         add_set.BuildComplement(state->interest(), state->advertised());
 
         // This is a delete operation for nodes that have seen it but are no
         // longer interested.
-        BitSet rm_set;
+        IFMapClientSet rm_set;
         rm_set.BuildComplement(state->advertised(), state->interest());
 
         bool change = ConfigChanged(node);
@@ -439,6 +465,8 @@ static void MaybeNotifyOnLinkDelete(IFMapNode *node, IFMapNodeState *state) {
 // feasible.
 void IFMapExporter::LinkTableExport(DBTablePartBase *partition,
                                     DBEntryBase *entry) {
+    ExportTimer timer(this);
+    link_export_count_++;
     IFMapLink *link = static_cast<IFMapLink *>(entry);
     DBTable *table = static_cast<DBTablePartition *>(partition)->table();
     const TableInfo *tinfo = Find(table);
@@ -473,11 +501,10 @@ void IFMapExporter::LinkTableExport(DBTablePartBase *partition,
 
         // If one of the nodes is a vswitch node, then the interest mask
         // is the corresponding peer bit.
-        std::auto_ptr<BitSet> ml, mr;
-        const BitSet *lset = MergeClientInterest(link->left(), s_left, &ml);
-        const BitSet *rset = MergeClientInterest(link->right(), s_right, &mr);
-        if (*lset != *rset) {
-            walker_->LinkAdd(link, link->left(), *lset, link->right(), *rset);
+        IFMapClientSet lset = MergeClientInterest(link->left(), s_left);
+        IFMapClientSet rset = MergeClientInterest(link->right(), s_right);
+        if (lset != rset) {
+            walker_->LinkAdd(link, link->left(), lset, link->right(), rset);
         }
 
         if (add_link) {
@@ -490,15 +517,15 @@ void IFMapExporter::LinkTableExport(DBTablePartBase *partition,
             // Interest mask is the intersection of left and right nodes.
             StateInterestSet(state, (s_left->interest() & s_right->interest()));
         } else {
-            StateInterestSet(state, BitSet());
+            StateInterestSet(state, IFMapClientSet());
         }
 
         // This is an add operation for nodes that are interested and
         // have not seen the advertisement.
-        BitSet add_set;
+        IFMapClientSet add_set;
         add_set.BuildComplement(state->interest(), state->advertised());
 
-        BitSet rm_set;
+        IFMapClientSet rm_set;
         rm_set.BuildComplement(state->advertised(), state->interest());
 
         if (!add_set.empty()) {
@@ -520,12 +547,12 @@ void IFMapExporter::LinkTableExport(DBTablePartBase *partition,
         IFMapNode *right = link->RightNode(server_->database());
         IFMapNodeState *s_right = state->right();
         assert((right != NULL) && (s_right != NULL));
-        BitSet interest = s_left->interest() & s_right->interest();
+        IFMapClientSet interest = s_left->interest() & s_right->interest();
         StateInterestReset(state, state->interest());
 
         IFMAP_DEBUG(LinkOper, "LinkRemove", left->ToString(), right->ToString(),
             s_left->interest().ToString(), s_right->interest().ToString());
-        walker_->LinkRemove(interest);
+        walker_->LinkRemove(left, right, interest);
 
         state->RemoveDependency();
         state->ClearValid();
@@ -558,14 +585,18 @@ void IFMapExporter::StateUpdateOnDequeue(IFMapUpdate *update,
     }
     state = static_cast<IFMapState *>(
         db_entry->GetState(table, TableListenerId(table)));
+    IFMapClientSet dequeue_clients(dequeue_set);
     if (is_delete) {
         // For any bit in dequeue_set, its possible that advertised is not set.
         // EG: update is UPDATE and we are called from UpdateQ.Leave(). Reset
         // only the bits that are really set.
-        BitSet adv_bits = state->advertised() & dequeue_set;
+        IFMapClientSet adv_bits = state->advertised() & dequeue_clients;
         StateAdvertisedReset(state, adv_bits);
     } else {
-        StateAdvertisedOr(state, dequeue_set);
+        // Advertising to clients that already have the update is a NOP.
+        IFMapClientSet adv_bits;
+        adv_bits.BuildComplement(dequeue_clients, state->advertised());
+        StateAdvertisedOr(state, adv_bits);
     }
 
     if (update->advertise().empty()) {
@@ -648,8 +679,8 @@ void IFMapExporter::DeleteClientConfigTracker(int index) {
 }
 
 void IFMapExporter::UpdateClientConfigTracker(IFMapState *state,
-        const BitSet& client_bits, bool add, TrackerType tracker_type) {
-    for (size_t pos = client_bits.find_first(); pos != BitSet::npos;
+        const IFMapClientSet &client_bits, bool add, TrackerType tracker_type) {
+    for (size_t pos = client_bits.find_first(); pos != IFMapClientSet::npos;
             pos = client_bits.find_next(pos)) {
         ConfigSet *set = client_config_tracker_[tracker_type].at(pos);
         assert(set);
@@ -663,7 +694,7 @@ void IFMapExporter::UpdateClientConfigTracker(IFMapState *state,
 }
 
 void IFMapExporter::CleanupClientConfigTrackedEntries(int index) {
-    BitSet rm_bs;
+    IFMapClientSet rm_bs;
     rm_bs.set(index);
 
     ConfigSet *set = client_config_tracker_[INTEREST].at(index);
@@ -724,11 +755,11 @@ IFMapExporter::Cs_citer IFMapExporter::ClientConfigTrackerEnd(
 }
 
 void IFMapExporter::StateInterestSet(IFMapState *state,
-                                     const BitSet& interest_bits) {
+                                     const IFMapClientSet &interest_bits) {
     // Add the node to the config-tracker of all clients that just became
     // interested in this node.
     bool add = true;
-    BitSet new_clients;
+    IFMapClientSet new_clients;
     new_clients.BuildComplement(interest_bits, state->interest());
     if (!new_clients.empty()) {
         UpdateClientConfigTracker(state, new_clients, add, INTEREST);
@@ -737,7 +768,7 @@ void IFMapExporter::StateInterestSet(IFMapState *state,
     // Remove the node from the config-tracker of all clients that are no longer
     // interested in this node.
     add = false;
-    BitSet old_clients;
+    IFMapClientSet old_clients;
     old_clients.BuildComplement(state->interest(), interest_bits);
     if (!old_clients.empty()) {
         UpdateClientConfigTracker(state, old_clients, add, INTEREST);
@@ -749,7 +780,7 @@ void IFMapExporter::StateInterestSet(IFMapState *state,
 // Add the node to the config-tracker of all clients that just became interested
 // in this node.
 void IFMapExporter::StateInterestOr(IFMapState *state,
-                                    const BitSet& interest_bits) {
+                                    const IFMapClientSet &interest_bits) {
     bool add = true;
     UpdateClientConfigTracker(state, interest_bits, add, INTEREST);
     state->InterestOr(interest_bits);
@@ -758,7 +789,7 @@ void IFMapExporter::StateInterestOr(IFMapState *state,
 // Remove the node from the config-tracker of all clients that are no longer
 // interested in this node.
 void IFMapExporter::StateInterestReset(IFMapState *state,
-                                       const BitSet& interest_bits) {
+                                       const IFMapClientSet &interest_bits) {
     bool add = false;
     UpdateClientConfigTracker(state, interest_bits, add, INTEREST);
     state->InterestReset(interest_bits);
@@ -766,7 +797,7 @@ void IFMapExporter::StateInterestReset(IFMapState *state,
 
 // Add the node to the config-tracker of all clients that just sent this node.
 void IFMapExporter::StateAdvertisedOr(IFMapState *state,
-                                      const BitSet& advertised_bits) {
+                                      const IFMapClientSet &advertised_bits) {
     bool add = true;
     UpdateClientConfigTracker(state, advertised_bits, add, ADVERTISED);
     state->AdvertisedOr(advertised_bits);
@@ -775,7 +806,7 @@ void IFMapExporter::StateAdvertisedOr(IFMapState *state,
 // Remove the node from the config-tracker of all clients from whom the node
 // was withdrawn.
 void IFMapExporter::StateAdvertisedReset(IFMapState *state,
-                                         const BitSet& advertised_bits) {
+        const IFMapClientSet &advertised_bits) {
     bool add = false;
     UpdateClientConfigTracker(state, advertised_bits, add, ADVERTISED);
     state->AdvertisedReset(advertised_bits);
@@ -18,6 +18,7 @@
 class BitSet;
 
 class IFMapClient;
+class IFMapClientSet;
 class IFMapGraphWalker;
 class IFMapLink;
 class IFMapLinkState;
@@ -73,7 +74,8 @@ public:
 
     void AddClientConfigTracker(int index);
     void DeleteClientConfigTracker(int index);
-    void UpdateClientConfigTracker(IFMapState *state, const BitSet& client_bits,
+    void UpdateClientConfigTracker(IFMapState *state,
+                                   const IFMapClientSet &client_bits,
                                    bool add, TrackerType tracker_type);
     void CleanupClientConfigTrackedEntries(int index);
     bool ClientHasConfigTracker(TrackerType tracker_type, int index);
@@ -84,17 +86,29 @@ public:
     Cs_citer ClientConfigTrackerBegin(TrackerType tracker_type, int index) const;
     Cs_citer ClientConfigTrackerEnd(TrackerType tracker_type, int index) const;
 
-    void StateInterestSet(IFMapState *state, const BitSet& interest_bits);
-    void StateInterestOr(IFMapState *state, const BitSet& interest_bits);
-    void StateInterestReset(IFMapState *state, const BitSet& interest_bits);
-    void StateAdvertisedOr(IFMapState *state, const BitSet& interest_bits);
-    void StateAdvertisedReset(IFMapState *state, const BitSet& interest_bits);
+    void StateInterestSet(IFMapState *state,
+                          const IFMapClientSet &interest_bits);
+    void StateInterestOr(IFMapState *state,
+                         const IFMapClientSet &interest_bits);
+    void StateInterestReset(IFMapState *state,
+                            const IFMapClientSet &interest_bits);
+    void StateAdvertisedOr(IFMapState *state,
+                           const IFMapClientSet &advertised_bits);
+    void StateAdvertisedReset(IFMapState *state,
+                              const IFMapClientSet &advertised_bits);
 
     const IFMapTypenameWhiteList &get_traversal_white_list() const;
     void ResetLinkDeleteClients(const BitSet &bset);
 
+    uint64_t node_export_count() const { return node_export_count_; }
+    uint64_t link_export_count() const { return link_export_count_; }
+    // Time spent in the table listeners, in usecs.
+    uint64_t export_time() const { return export_time_; }
+    const IFMapGraphWalker *walker() const { return walker_.get(); }
+
 private:
     friend class XmppIfmapTest;
+    class ExportTimer;
     class TableInfo;
     typedef std::map<DBTable *, TableInfo *> TableMap;
 
@@ -105,24 +119,25 @@ private:
 
     template <class ObjectType>
     bool UpdateAddChange(ObjectType *obj, IFMapState *state,
-                         const BitSet &add_set, const BitSet &rm_set,
-                         bool change);
+                         const IFMapClientSet &add_set,
+                         const IFMapClientSet &rm_set, bool change);
     template <class ObjectType>
     bool UpdateRemove(ObjectType *obj, IFMapState *state,
-                      const BitSet &rm_set);
+                      const IFMapClientSet &rm_set);
     template <class ObjectType>
     void EnqueueDelete(ObjectType *obj, IFMapState *state);
 
     void MoveDependentLinks(IFMapNodeState *state);
-    void RemoveDependentLinks(IFMapNodeState *state, const BitSet &rm_set);
+    void RemoveDependentLinks(IFMapNodeState *state,
+                              const IFMapClientSet &rm_set);
     void MoveAdjacentNode(IFMapNodeState *state);
-    void ProcessAdjacentNode(IFMapNode *node, const BitSet &add_set,
+    void ProcessAdjacentNode(IFMapNode *node, const IFMapClientSet &add_set,
                              IFMapNodeState *state);
 
     bool IsFeasible(const IFMapNode *node);
 
-    const BitSet *MergeClientInterest(IFMapNode *node, IFMapNodeState *state,
-                                      std::auto_ptr<BitSet> *ptr);
+    IFMapClientSet MergeClientInterest(IFMapNode *node,
+                                       IFMapNodeState *state);
 
     const TableInfo *Find(const DBTable *table) const;
 
@@ -140,6 +155,10 @@ private:
 
     DBTable *link_table_;
     ClientConfigTracker client_config_tracker_[TT_END];
+    uint64_t node_export_count_;
+    uint64_t link_export_count_;
+    uint64_t export_time_;
+    int export_depth_;
 };
 
 #endif
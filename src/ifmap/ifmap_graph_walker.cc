@@ -29,7 +29,7 @@ class GraphPropagateFilter : public DBGraph::VisitorFilter {
 public:
     GraphPropagateFilter(IFMapExporter *exporter,
                          const IFMapTypenameWhiteList *type_filter,
-                         const BitSet &bitset)
+                         const IFMapClientSet &bitset)
             : exporter_(exporter),
               type_filter_(type_filter),
               bset_(bitset) {
@@ -64,7 +64,7 @@ public:
 private:
     IFMapExporter *exporter_;
     const IFMapTypenameWhiteList *type_filter_;
-    const BitSet &bset_;
+    const IFMapClientSet &bset_;
 };
 
 IFMapGraphWalker::IFMapGraphWalker(DBGraph *graph, IFMapExporter *exporter)
@@ -73,7 +73,10 @@ IFMapGraphWalker::IFMapGraphWalker(DBGraph *graph, IFMapExporter *exporter)
       link_delete_walk_trigger_(new TaskTrigger(
           boost::bind(&IFMapGraphWalker::LinkDeleteWalk, this),
           TaskScheduler::GetInstance()->GetTaskId("db::IFMapTable"), 0)),
-      walk_client_index_(BitSet::npos) {
+      walk_client_index_(BitSet::npos),
+      link_delete_walk_count_(0),
+      link_delete_suspect_count_(0),
+      interest_reset_count_(0) {
     traversal_white_list_.reset(new IFMapTypenameWhiteList());
     AddNodesToWhitelist();
 }
@@ -81,12 +84,14 @@ IFMapGraphWalker::IFMapGraphWalker(DBGraph *graph, IFMapExporter *exporter)
 IFMapGraphWalker::~IFMapGraphWalker() {
 }
 
-void IFMapGraphWalker::NotifyEdge(DBGraphEdge *edge, const BitSet &bset) {
+void IFMapGraphWalker::NotifyEdge(DBGraphEdge *edge,
+                                  const IFMapClientSet &bset) {
     DBTable *table = exporter_->link_table();
     table->Change(edge);
 }
 
-void IFMapGraphWalker::JoinVertex(DBGraphVertex *vertex, const BitSet &bset) {
+void IFMapGraphWalker::JoinVertex(DBGraphVertex *vertex,
+                                  const IFMapClientSet &bset) {
     IFMapNode *node = static_cast<IFMapNode *>(vertex);
     IFMapNodeState *state = exporter_->NodeStateLocate(node);
     IFMAP_DEBUG(JoinVertex, vertex->ToString(), state->interest().ToString(),
@@ -96,7 +101,7 @@ void IFMapGraphWalker::JoinVertex(DBGraphVertex *vertex, const BitSet &bset) {
 }
 
 void IFMapGraphWalker::ProcessLinkAdd(IFMapNode *lnode, IFMapNode *rnode,
-                                      const BitSet &bset) {
+                                      const IFMapClientSet &bset) {
     GraphPropagateFilter filter(exporter_, traversal_white_list_.get(), bset);
     graph_->Visit(rnode,
                   boost::bind(&IFMapGraphWalker::JoinVertex, this, _1, bset),
@@ -104,8 +109,9 @@ void IFMapGraphWalker::ProcessLinkAdd(IFMapNode *lnode, IFMapNode *rnode,
                   filter);
 }
 
-void IFMapGraphWalker::LinkAdd(IFMapLink *link, IFMapNode *lnode, const BitSet &lhs,
-                               IFMapNode *rnode, const BitSet &rhs) {
+void IFMapGraphWalker::LinkAdd(IFMapLink *link, IFMapNode *lnode,
+                               const IFMapClientSet &lhs, IFMapNode *rnode,
+                               const IFMapClientSet &rhs) {
     IFMAP_DEBUG(LinkOper, "LinkAdd", lnode->ToString(), rnode->ToString(),
                 lhs.ToString(), rhs.ToString());
     if (!lhs.empty() && !rhs.Contains(lhs) &&
@@ -120,8 +126,18 @@ void IFMapGraphWalker::LinkAdd(IFMapLink *link, IFMapNode *lnode, const BitSet &
     }
 }
 
-void IFMapGraphWalker::LinkRemove(const BitSet &bset) {
-    OrLinkDeleteClients(bset);          // link_delete_clients_ | bset
+// Record the nodes of a deleted link; clients in bset may no longer reach
+// the nodes downstream of it.
+void IFMapGraphWalker::LinkRemove(IFMapNode *lnode, IFMapNode *rnode,
+                                  const IFMapClientSet &bset) {
+    if (bset.empty()) {
+        return;
+    }
+    link_delete_nodes_.insert(
+        std::make_pair(lnode->table()->Typename(), lnode->name()));
+    link_delete_nodes_.insert(
+        std::make_pair(rnode->table()->Typename(), rnode->name()));
+    OrLinkDeleteClients(bset.ToBitSet());   // link_delete_clients_ | bset
     link_delete_walk_trigger_->Set();
 }
 
@@ -138,16 +154,177 @@ bool IFMapGraphWalker::FilterNeighbor(IFMapNode *lnode, IFMapLink *link) {
     return false;
 }
 
-void IFMapGraphWalker::RecomputeInterest(DBGraphVertex *vertex, int bit) {
-    IFMapNode *node = static_cast<IFMapNode *>(vertex);
-    IFMapNodeState *state = exporter_->NodeStateLocate(node);
-    state->nmask_set(bit);
-    UpdateNewReachableNodesTracker(bit, state);
+// Returns the node at the other end of a link that hasn't been deleted.
+static IFMapNode *AdjacentNode(IFMapNode *node, IFMapLink *link) {
+    if (link->IsDeleted()) {
+        return NULL;
+    }
+    return (link->left() == node) ? link->right() : link->left();
+}
+
+// Returns true if the walk from source may continue over link to the node at
+// the other end.
+bool IFMapGraphWalker::Traversable(const IFMapNode *source,
+                                   const IFMapLink *link,
+                                   const IFMapNode *target) const {
+    if (source->IsDeleted() || target->IsDeleted() || link->IsDeleted()) {
+        return false;
+    }
+    return traversal_white_list_->VertexFilter(source) &&
+        traversal_white_list_->VertexFilter(target) &&
+        traversal_white_list_->EdgeFilter(source, target, link);
+}
+
+bool IFMapGraphWalker::HasInterest(IFMapNode *node, int client_index) const {
+    const IFMapNodeState *state = exporter_->NodeStateLookup(node);
+    return state != NULL && state->interest().test(client_index);
+}
+
+//
+// Find the nodes that the client can no longer reach after the deletion of
+// the links adjacent to the seed nodes.
+//
+// The interest of a node has the client's bit iff the node is reachable
+// from the client's virtual-router over the traversal white list. Only the
+// nodes reachable from the seeds can have lost their path, so they are
+// collected first as suspects. A suspect is still reachable if a node that
+// is not a suspect and has the bit links to it, or if it is reachable from
+// such a suspect. The remaining suspects are unreachable.
+//
+// Links are taken from the dependents of the node states, so that only the
+// links processed by the exporter are considered. No state is modified, the
+// interest is cleaned up once the walks of all clients of the run are done.
+//
+void IFMapGraphWalker::FindUnreachableNodes(LinkDeleteWalkState *walk) const {
+    int index = walk->client_index;
+    std::set<IFMapNode *> suspects;
+    std::vector<IFMapNode *> queue;
+
+    for (std::vector<IFMapNode *>::const_iterator it =
+         walk->seeds->begin(); it != walk->seeds->end(); ++it) {
+        IFMapNode *node = *it;
+        if (node != walk->root && HasInterest(node, index) &&
+            suspects.insert(node).second) {
+            queue.push_back(node);
+        }
+    }
+    while (!queue.empty()) {
+        IFMapNode *node = queue.back();
+        queue.pop_back();
+        IFMapNodeState *state = exporter_->NodeStateLookup(node);
+        for (IFMapNodeState::iterator iter = state->begin();
+             iter != state->end(); ++iter) {
+            IFMapLink *link = iter.operator->();
+            IFMapNode *target = AdjacentNode(node, link);
+            if (target == NULL) {
+                continue;
+            }
+            if (target == walk->root || !HasInterest(target, index) ||
+                !Traversable(node, link, target)) {
+                continue;
+            }
+            if (suspects.insert(target).second) {
+                queue.push_back(target);
+            }
+        }
+    }
+    walk->suspect_count = suspects.size();
+
+    std::set<IFMapNode *> reached;
+    for (std::set<IFMapNode *>::const_iterator it = suspects.begin();
+         it != suspects.end(); ++it) {
+        IFMapNode *node = *it;
+        IFMapNodeState *state = exporter_->NodeStateLookup(node);
+        for (IFMapNodeState::iterator iter = state->begin();
+             iter != state->end(); ++iter) {
+            IFMapLink *link = iter.operator->();
+            IFMapNode *source = AdjacentNode(node, link);
+            if (source == NULL) {
+                continue;
+            }
+            if (suspects.count(source) == 0 && HasInterest(source, index) &&
+                Traversable(source, link, node)) {
+                reached.insert(node);
+                queue.push_back(node);
+                break;
+            }
+        }
+    }
+    while (!queue.empty()) {
+        IFMapNode *node = queue.back();
+        queue.pop_back();
+        IFMapNodeState *state = exporter_->NodeStateLookup(node);
+        for (IFMapNodeState::iterator iter = state->begin();
+             iter != state->end(); ++iter) {
+            IFMapLink *link = iter.operator->();
+            IFMapNode *target = AdjacentNode(node, link);
+            if (target == NULL) {
+                continue;
+            }
+            if (suspects.count(target) == 0 ||
+                !Traversable(node, link, target)) {
+                continue;
+            }
+            if (reached.insert(target).second) {
+                queue.push_back(target);
+            }
+        }
+    }
+
+    for (std::set<IFMapNode *>::const_iterator it = suspects.begin();
+         it != suspects.end(); ++it) {
+        if (reached.count(*it) == 0) {
+            walk->unreachable.push_back(*it);
+        }
+    }
+}
+
+// Without its virtual-router, the client can't reach any node.
+void IFMapGraphWalker::FindInterestNodes(LinkDeleteWalkState *walk) const {
+    IFMapExporter::Cs_citer iter = exporter_->ClientConfigTrackerBegin(
+        IFMapExporter::INTEREST, walk->client_index);
+    IFMapExporter::Cs_citer end_iter = exporter_->ClientConfigTrackerEnd(
+        IFMapExporter::INTEREST, walk->client_index);
+    for (; iter != end_iter; ++iter) {
+        IFMapState *state = *iter;
+        if (state->IsNode()) {
+            walk->unreachable.push_back(state->GetIFMapNode());
+        }
+    }
+    walk->suspect_count = walk->unreachable.size();
+}
+
+void IFMapGraphWalker::LinkDeleteWalkClient(LinkDeleteWalkState *walk) const {
+    if (walk->root == NULL) {
+        FindInterestNodes(walk);
+    } else {
+        FindUnreachableNodes(walk);
+    }
+}
+
+// Look up the seeds of the walks, the nodes on both sides of the deleted
+// links, which LinkRemove records by name. Nodes that are gone, or that the
+// exporter has no state for, are dropped.
+void IFMapGraphWalker::ResolveLinkDeleteNodes(std::vector<IFMapNode *> *seeds) {
+    IFMapServer *server = exporter_->server();
+    for (NodeKeySet::iterator it = link_delete_nodes_.begin(), next = it;
+         it != link_delete_nodes_.end(); it = next) {
+        ++next;
+        IFMapTable *table = IFMapTable::FindTable(server->database(),
+                                                  it->first);
+        IFMapNode *node = table ? table->FindNode(it->second) : NULL;
+        if (node == NULL || exporter_->NodeStateLookup(node) == NULL) {
+            link_delete_nodes_.erase(it);
+            continue;
+        }
+        seeds->push_back(node);
+    }
 }
 
 bool IFMapGraphWalker::LinkDeleteWalk() {
     if (link_delete_clients_.empty()) {
         walk_client_index_ = BitSet::npos;
+        link_delete_nodes_.clear();
         return true;
     }
 
@@ -160,42 +337,59 @@ bool IFMapGraphWalker::LinkDeleteWalk() {
     } else {
         // walk_client_index_ was the last client that we finished processing.
         i = link_delete_clients_.find_next(walk_client_index_);
+        if (i == BitSet::npos) {
+            i = link_delete_clients_.find_first();
+        }
     }
-    int count = 0;
+
+    std::vector<IFMapNode *> seeds;
+    ResolveLinkDeleteNodes(&seeds);
+
+    std::vector<LinkDeleteWalkState> walks;
     BitSet done_set;
     while (i != BitSet::npos) {
         IFMapClient *client = server->GetClient(i);
         assert(client);
-        AddNewReachableNodesTracker(client->index());
 
         IFMapTable *table = IFMapTable::FindTable(server->database(),
                                                   "virtual-router");
         IFMapNode *node = table->FindNode(client->identifier());
-        if ((node != NULL) && node->IsVertexValid()) {
-            graph_->Visit(node,
-                boost::bind(&IFMapGraphWalker::RecomputeInterest, this, _1, i),
-                0, *traversal_white_list_.get());
+        if ((node == NULL) || !node->IsVertexValid()) {
+            node = NULL;
         }
+        walks.push_back(LinkDeleteWalkState(i, node, &seeds));
         done_set.set(i);
-        if (++count == kMaxLinkDeleteWalks) {
-            // client 'i' has been processed. If 'i' is the last bit set, we
-            // will return true below. Else we will return false and there
-            // is atleast one more bit left to process.
+        walk_client_index_ = i;
+        if (walks.size() == kMaxLinkDeleteWalks) {
             break;
         }
 
         i = link_delete_clients_.find_next(i);
     }
+
+    for (std::vector<LinkDeleteWalkState>::iterator it = walks.begin();
+         it != walks.end(); ++it) {
+        LinkDeleteWalkClient(&(*it));
+    }
+
     // Remove the subset of clients that we have finished processing.
     ResetLinkDeleteClients(done_set);
 
-    LinkDeleteWalkBatchEnd(done_set);
+    for (std::vector<LinkDeleteWalkState>::const_iterator it = walks.begin();
+         it != walks.end(); ++it) {
+        link_delete_walk_count_++;
+        link_delete_suspect_count_ += it->suspect_count;
+        for (std::vector<IFMapNode *>::const_iterator iter =
+             it->unreachable.begin(); iter != it->unreachable.end(); ++iter) {
+            CleanupInterest(it->client_index, *iter);
+        }
+    }
 
     if (link_delete_clients_.empty()) {
         walk_client_index_ = BitSet::npos;
+        link_delete_nodes_.clear();
         return true;
     } else {
-        walk_client_index_ = i;
         return false;
     }
 }
@@ -208,27 +402,20 @@ void IFMapGraphWalker::ResetLinkDeleteClients(const BitSet &bset) {
     link_delete_clients_.Reset(bset);
 }
 
-void IFMapGraphWalker::CleanupInterest(int client_index, IFMapNode *node,
-                                       IFMapNodeState *state) {
-    BitSet rm_mask;
-    rm_mask.set(client_index);
-
-    // interest = interest - rm_mask + nmask
-
-    if (!state->interest().empty() && !state->nmask().empty()) {
-        IFMAP_DEBUG(CleanupInterest, node->ToString(),
-                    state->interest().ToString(), rm_mask.ToString(),
-                    state->nmask().ToString());
-    }
-    BitSet ninterest;
-    ninterest.BuildComplement(state->interest(), rm_mask);
-    ninterest |= state->nmask();
-    state->nmask_clear();
-    if (state->interest() == ninterest) {
+// Remove the client from the interest of a node it can no longer reach.
+void IFMapGraphWalker::CleanupInterest(int client_index, IFMapNode *node) {
+    IFMapNodeState *state = exporter_->NodeStateLookup(node);
+    if (state == NULL || !state->interest().test(client_index)) {
         return;
     }
 
-    exporter_->StateInterestSet(state, ninterest);
+    IFMapClientSet rm_mask;
+    rm_mask.set(client_index);
+    IFMAP_DEBUG(CleanupInterest, node->ToString(),
+                state->interest().ToString(), rm_mask.ToString(),
+                std::string());
+    interest_reset_count_++;
+    exporter_->StateInterestReset(state, rm_mask);
     node->table()->Change(node);
 
     // Mark all dependent links as potentially modified.
@@ -239,95 +426,6 @@ void IFMapGraphWalker::CleanupInterest(int client_index, IFMapNode *node,
     }
 }
 
-// Cleanup all the graph nodes that were reachable before this link delete.
-// After this link delete, these nodes may still be reachable. But, its
-// also possible that the link delete has made them unreachable.
-void IFMapGraphWalker::OldReachableNodesCleanupInterest(int client_index) {
-    IFMapState *state = NULL;
-    IFMapNode *node = NULL;
-    IFMapExporter::Cs_citer iter = exporter_->ClientConfigTrackerBegin(
-        IFMapExporter::INTEREST, client_index);
-    IFMapExporter::Cs_citer end_iter = exporter_->ClientConfigTrackerEnd(
-        IFMapExporter::INTEREST, client_index);
-
-    while (iter != end_iter) {
-        state = *iter;
-        // Get the iterator to the next element before calling
-        // CleanupInterest() since the state might be removed from the
-        // client's config-tracker, thereby invalidating the iterator of the
-        // container we are iterating over.
-        ++iter;
-        if (state->IsNode()) {
-            node = state->GetIFMapNode();
-            assert(node);
-            IFMapNodeState *nstate = exporter_->NodeStateLookup(node);
-            assert(state == nstate);
-            CleanupInterest(client_index, node, nstate);
-        }
-    }
-}
-
-// Cleanup all the graph nodes that were not reachable before the link delete
-// but are reachable now. Note, we store nodes in new_reachable_nodes_tracker_
-// only if we visited them during the graph-walk via RecomputeInterest() and if
-// their interest bit was not set i.e. they were not reachable before we
-// started the walk.
-void IFMapGraphWalker::NewReachableNodesCleanupInterest(int client_index) {
-    IFMapState *state = NULL;
-    IFMapNode *node = NULL;
-    ReachableNodesSet *rnset = new_reachable_nodes_tracker_.at(client_index);
-
-    for (Rns_citer iter = rnset->begin(); iter != rnset->end(); ++iter) {
-        state = *iter;
-        assert(state->IsNode());
-        node = state->GetIFMapNode();
-        assert(node);
-        IFMapNodeState *nstate = exporter_->NodeStateLookup(node);
-        assert(state == nstate);
-        CleanupInterest(client_index, node, nstate);
-    }
-    DeleteNewReachableNodesTracker(client_index);
-}
-
-void IFMapGraphWalker::LinkDeleteWalkBatchEnd(const BitSet &done_set) {
-    for (size_t i = done_set.find_first(); i != BitSet::npos;
-            i = done_set.find_next(i)) {
-        // Examine all the nodes that were reachable before the link delete.
-        OldReachableNodesCleanupInterest(i);
-        // Examine all the nodes that were not reachable before the link
-        // delete but are now reachable.
-        NewReachableNodesCleanupInterest(i);
-    }
-}
-
-void IFMapGraphWalker::AddNewReachableNodesTracker(int client_index) {
-    if (client_index >= (int)new_reachable_nodes_tracker_.size()) {
-        new_reachable_nodes_tracker_.resize(client_index + 1, NULL);
-    }
-    assert(new_reachable_nodes_tracker_[client_index] == NULL);
-    ReachableNodesSet *rnset = new ReachableNodesSet();
-    new_reachable_nodes_tracker_[client_index] = rnset;
-}
-
-void IFMapGraphWalker::DeleteNewReachableNodesTracker(int client_index) {
-    ReachableNodesSet *rnset = new_reachable_nodes_tracker_.at(client_index);
-    assert(rnset);
-    delete rnset;
-    new_reachable_nodes_tracker_[client_index] = NULL;
-}
-
-// Keep track of this node if it was unreachable earlier.
-void IFMapGraphWalker::UpdateNewReachableNodesTracker(int client_index,
-                                                      IFMapState *state) {
-    ReachableNodesSet *rnset = new_reachable_nodes_tracker_.at(client_index);
-    assert(rnset);
-    // If the interest is not set, the node was not reachable earlier but is
-    // reachable now.
-    if (!state->interest().test(client_index)) {
-        rnset->insert(state);
-    }
-}
-
 const IFMapTypenameWhiteList &IFMapGraphWalker::get_traversal_white_list()
         const {
     return *traversal_white_list_.get();
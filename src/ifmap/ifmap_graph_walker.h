@@ -5,8 +5,14 @@
 #ifndef __ctrlplane__ifmap_graph_walker__
 #define __ctrlplane__ifmap_graph_walker__
 
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "base/bitset.h"
 #include "base/queue_task.h"
+#include "ifmap/ifmap_client_set.h"
 
 class DBGraph;
 class DBGraphEdge;
@@ -14,59 +20,89 @@ class DBGraphVertex;
 class IFMapExporter;
 class IFMapNode;
 class IFMapLink;
-class IFMapNodeState;
-class IFMapState;
 class TaskTrigger;
 struct IFMapTypenameWhiteList;
 
 // Computes the interest graph for the ifmap clients (i.e. vnc agent).
+//
+// Link additions propagate the interest of one side of the link to the
+// nodes reachable from the other side. Link deletions are processed in
+// batches by the link delete walk, which only examines the nodes reachable
+// from the deleted links rather than re-walking the graph of each client
+// from its virtual-router.
 class IFMapGraphWalker {
 public:
-    typedef std::set<IFMapState *> ReachableNodesSet;
-    typedef ReachableNodesSet::const_iterator Rns_citer;
-    typedef std::vector<ReachableNodesSet *> ReachableNodesTracker;
-
     IFMapGraphWalker(DBGraph *graph, IFMapExporter *exporter);
     ~IFMapGraphWalker();
 
     // When a link is added, for each interest bit, find the corresponding
     // source node and walk the graph constructing the respective interest
     // list.
-    void LinkAdd(IFMapLink *link, IFMapNode *lnode, const BitSet &lhs,
-                 IFMapNode *rnode, const BitSet &rhs);
-    void LinkRemove(const BitSet &bset);
+    void LinkAdd(IFMapLink *link, IFMapNode *lnode, const IFMapClientSet &lhs,
+                 IFMapNode *rnode, const IFMapClientSet &rhs);
+    void LinkRemove(IFMapNode *lnode, IFMapNode *rnode,
+                    const IFMapClientSet &bset);
 
     bool FilterNeighbor(IFMapNode *lnode, IFMapLink *link);
     const IFMapTypenameWhiteList &get_traversal_white_list() const;
     void ResetLinkDeleteClients(const BitSet &bset);
 
+    uint64_t link_delete_walk_count() const { return link_delete_walk_count_; }
+    uint64_t link_delete_suspect_count() const {
+        return link_delete_suspect_count_;
+    }
+    uint64_t interest_reset_count() const { return interest_reset_count_; }
+
 private:
-    static const int kMaxLinkDeleteWalks = 1;
+    // Maximum number of clients processed by a run of the link delete walk.
+    static const size_t kMaxLinkDeleteWalks = 16;
+
+    // Type and name of a node.
+    typedef std::set<std::pair<std::string, std::string> > NodeKeySet;
+
+    struct LinkDeleteWalkState {
+        LinkDeleteWalkState(int client_index, IFMapNode *root,
+                            const std::vector<IFMapNode *> *seeds)
+            : client_index(client_index), root(root), seeds(seeds),
+              suspect_count(0) {
+        }
+
+        int client_index;
+        // The client's virtual-router, NULL if it's gone.
+        IFMapNode *root;
+        const std::vector<IFMapNode *> *seeds;
+        size_t suspect_count;
+        std::vector<IFMapNode *> unreachable;
+    };
 
-    void ProcessLinkAdd(IFMapNode *lnode, IFMapNode *rnode, const BitSet &bset);
-    void JoinVertex(DBGraphVertex *vertex, const BitSet &bset);
-    void NotifyEdge(DBGraphEdge *edge, const BitSet &bset);
-    void RecomputeInterest(DBGraphVertex *vertex, int bit);
-    void CleanupInterest(int client_index, IFMapNode *node,
-                         IFMapNodeState *state);
+    void ProcessLinkAdd(IFMapNode *lnode, IFMapNode *rnode,
+                        const IFMapClientSet &bset);
+    void JoinVertex(DBGraphVertex *vertex, const IFMapClientSet &bset);
+    void NotifyEdge(DBGraphEdge *edge, const IFMapClientSet &bset);
+    void CleanupInterest(int client_index, IFMapNode *node);
     void AddNodesToWhitelist();
     void AddLinksToWhitelist();
     bool LinkDeleteWalk();
-    void LinkDeleteWalkBatchEnd(const BitSet &done_set);
     void OrLinkDeleteClients(const BitSet &bset);
-    void AddNewReachableNodesTracker(int client_index);
-    void DeleteNewReachableNodesTracker(int client_index);
-    void UpdateNewReachableNodesTracker(int client_index, IFMapState *state);
-    void OldReachableNodesCleanupInterest(int client_index);
-    void NewReachableNodesCleanupInterest(int client_index);
+    void ResolveLinkDeleteNodes(std::vector<IFMapNode *> *seeds);
+    void LinkDeleteWalkClient(LinkDeleteWalkState *walk) const;
+    void FindUnreachableNodes(LinkDeleteWalkState *walk) const;
+    void FindInterestNodes(LinkDeleteWalkState *walk) const;
+    bool Traversable(const IFMapNode *source, const IFMapLink *link,
+                     const IFMapNode *target) const;
+    bool HasInterest(IFMapNode *node, int client_index) const;
 
     DBGraph *graph_;
     IFMapExporter *exporter_;
     boost::scoped_ptr<TaskTrigger> link_delete_walk_trigger_;
     std::auto_ptr<IFMapTypenameWhiteList> traversal_white_list_;
     BitSet link_delete_clients_;
+    // Nodes of the links deleted since link_delete_clients_ was last empty.
+    NodeKeySet link_delete_nodes_;
     size_t walk_client_index_;
-    ReachableNodesTracker new_reachable_nodes_tracker_;
+    uint64_t link_delete_walk_count_;
+    uint64_t link_delete_suspect_count_;
+    uint64_t interest_reset_count_;
 };
 
 #endif /* defined(__ctrlplane__ifmap_graph_walker__) */
@@ -20,6 +20,7 @@
 
 #include "ifmap/ifmap_client.h"
 #include "ifmap/ifmap_exporter.h"
+#include "ifmap/ifmap_graph_walker.h"
 #include "ifmap/ifmap_link.h"
 #include "ifmap/ifmap_link_table.h"
 #include "ifmap/ifmap_log.h"
@@ -59,6 +60,7 @@ public:
             // Get the interests and advertised from state
             dest->interests = state->interest().ToNumberedString();
             dest->advertised = state->advertised().ToNumberedString();
+            dest->client_set_bytes = state->client_set_memory();
         } else {
             dest->dbentryflags.append("No state, ");
         }
@@ -572,6 +574,7 @@ void ShowIFMapLinkTable::CopyNode(IFMapLinkShowInfo *dest, DBEntryBase *src,
     if (state) {
         dest->interests = state->interest().ToNumberedString();
         dest->advertised = state->advertised().ToNumberedString();
+        dest->client_set_bytes = state->client_set_memory();
     } else {
         dest->dbentryflags.append("No state, ");
     }
@@ -1929,6 +1932,52 @@ void IFMapServerClientShowReq::HandleRequest() const {
     RequestPipeline rp(ps);
 }
 
+static bool IFMapExporterStatsReqHandleRequest(
+    const Sandesh *sr, const RequestPipeline::PipeSpec ps, int stage,
+    int instNum, RequestPipeline::InstData *data) {
+    const IFMapExporterStatsReq *request =
+        static_cast<const IFMapExporterStatsReq *>(ps.snhRequest_.get());
+    IFMapSandeshContext *sctx =
+        static_cast<IFMapSandeshContext *>(request->module_context("IFMap"));
+    IFMapExporter *exporter = sctx->ifmap_server()->exporter();
+
+    IFMapExporterStatsResp *response = new IFMapExporterStatsResp();
+    response->set_node_export_count(exporter->node_export_count());
+    response->set_link_export_count(exporter->link_export_count());
+    response->set_export_time(exporter->export_time());
+    uint64_t exports =
+        exporter->node_export_count() + exporter->link_export_count();
+    if (exporter->export_time()) {
+        response->set_exports_per_sec(
+            exports * 1000000 / exporter->export_time());
+    }
+    const IFMapGraphWalker *walker = exporter->walker();
+    response->set_link_delete_walk_count(walker->link_delete_walk_count());
+    response->set_link_delete_suspect_count(
+        walker->link_delete_suspect_count());
+    response->set_interest_reset_count(walker->interest_reset_count());
+    response->set_context(request->context());
+    response->set_more(false);
+    response->Response();
+
+    // Return 'true' so that we are not called again
+    return true;
+}
+
+void IFMapExporterStatsReq::HandleRequest() const {
+
+    RequestPipeline::StageSpec s0;
+    TaskScheduler *scheduler = TaskScheduler::GetInstance();
+
+    s0.taskId_ = scheduler->GetTaskId("db::IFMapTable");
+    s0.cbFn_ = IFMapExporterStatsReqHandleRequest;
+    s0.instances_.push_back(0);
+
+    RequestPipeline::PipeSpec ps(this);
+    ps.stages_ = boost::assign::list_of(s0);
+    RequestPipeline rp(ps);
+}
+
 static bool IFMapNodeTableListShowReqHandleRequest(
     const Sandesh *sr, const RequestPipeline::PipeSpec ps, int stage,
     int instNum, RequestPipeline::InstData *data) {
@@ -88,6 +88,43 @@ IFMapState::~IFMapState() {
     assert(update_list_.empty());
 }
 
+void IFMapState::InterestOr(const IFMapClientSet &set) {
+    interest_ |= set;
+    ShareClientSets();
+}
+
+void IFMapState::SetInterest(const IFMapClientSet &set) {
+    interest_ = set;
+    ShareClientSets();
+}
+
+void IFMapState::InterestReset(const IFMapClientSet &set) {
+    interest_.Reset(set);
+    ShareClientSets();
+}
+
+void IFMapState::AdvertisedOr(const IFMapClientSet &set) {
+    advertised_ |= set;
+    ShareClientSets();
+}
+
+void IFMapState::AdvertisedReset(const IFMapClientSet &set) {
+    advertised_.Reset(set);
+    ShareClientSets();
+}
+
+// Once the update has been advertised to all interested clients, both sets
+// are equal. Make them share the same block list.
+void IFMapState::ShareClientSets() {
+    if (!advertised_.empty() && advertised_ == interest_) {
+        advertised_ = interest_;
+    }
+}
+
+size_t IFMapState::client_set_memory() const {
+    return interest_.memory() + advertised_.memory();
+}
+
 IFMapUpdate *IFMapState::GetUpdate(IFMapListEntry::EntryType type) {
     for (UpdateList::iterator iter = update_list_.begin();
          iter != update_list_.end(); ++iter) {
@@ -12,6 +12,7 @@
 #include "base/bitset.h"
 #include "base/dependency.h"
 #include "db/db_entry.h"
+#include "ifmap/ifmap_client_set.h"
 #include "ifmap/ifmap_link.h"
 
 struct IFMapObjectPtr {
@@ -126,20 +127,23 @@ public:
     IFMapState(IFMapLink *link);
     virtual ~IFMapState();
 
-    const BitSet &interest() const { return interest_; }
-    const BitSet &advertised() const { return advertised_; }
+    const IFMapClientSet &interest() const { return interest_; }
+    const IFMapClientSet &advertised() const { return advertised_; }
 
     const UpdateList &update_list() const { return update_list_; }
     IFMapUpdate *GetUpdate(IFMapListEntry::EntryType type);
     void Insert(IFMapUpdate *update);
     void Remove(IFMapUpdate *update);
 
-    void InterestOr(const BitSet &bset) { interest_ |= bset; }
-    void SetInterest(const BitSet &bset) { interest_ = bset; }
-    void InterestReset(const BitSet &set) { interest_.Reset(set); }
+    void InterestOr(const IFMapClientSet &set);
+    void SetInterest(const IFMapClientSet &set);
+    void InterestReset(const IFMapClientSet &set);
 
-    void AdvertisedOr(const BitSet &set) { advertised_ |= set; }
-    void AdvertisedReset(const BitSet &set) { advertised_.Reset(set); }
+    void AdvertisedOr(const IFMapClientSet &set);
+    void AdvertisedReset(const IFMapClientSet &set);
+
+    // Bytes used by the interest and advertised sets.
+    size_t client_set_memory() const;
 
     template <typename Disposer>
     void ClearAndDispose(Disposer disposer) {
@@ -165,10 +169,12 @@ protected:
     IFMapObjectPtr data_;
 
 private:
+    void ShareClientSets();
+
     // The set of clients known to be interested in this update.
-    BitSet interest_;
+    IFMapClientSet interest_;
     // The set of clients to which this update has been advertised.
-    BitSet advertised_;
+    IFMapClientSet advertised_;
     UpdateList update_list_;
     crc32type crc_;
 };
@@ -190,16 +196,12 @@ public:
     const_iterator begin() const { return dependents_.begin(); }
     const_iterator end() const { return dependents_.end(); }
 
-    const BitSet &nmask() const { return nmask_; }
-    void nmask_clear() { nmask_.clear(); }
-    void nmask_set(int bit) { nmask_.set(bit); }
     virtual bool CanDelete() {
         return (update_list().empty() && IsInvalid() && !HasDependents());
     }
 
 private:
     DEPENDENCY_LIST(IFMapLink, IFMapNodeState, dependents_);
-    BitSet nmask_;          // new bitmask computed by graph traversal
 };
 
 class IFMapLinkState : public IFMapState {
@@ -250,18 +250,18 @@ void IFMapUpdateSender::SendUpdate(BitSet send_set, BitSet *blocked_set) {
 
     assert(!message_->IsEmpty());
 
+    // Encode the message once. All the clients share the encoded message
+    // and add their own address to it when sending.
+    message_->Close();
+    const IFMapMessage::EncodedPtr &encoded = message_->encoded();
+
     for (size_t i = send_set.find_first(); i != BitSet::npos;
          i = send_set.find_next(i)) {
         assert(!send_blocked_.test(i));
         client = server_->GetClient(i);
         assert(client);
 
-        message_->SetReceiverInMsg(client->identifier());
-        // Close the message to save the document as string
-        message_->Close();
-
-        // Send the string version of the message to the client.
-        send_result = client->SendUpdate(message_->get_string());
+        send_result = client->SendUpdate(encoded);
 
         // Keep track of all the clients whose buffers are full.
         if (!send_result) {
@@ -12,6 +12,7 @@
 #include "base/logging.h"
 
 #include "ifmap/ifmap_factory.h"
+#include "ifmap/ifmap_encoder.h"
 #include "ifmap/ifmap_log.h"
 #include "ifmap/ifmap_sandesh_context.h"
 #include "ifmap/ifmap_server_show_types.h"
@@ -83,6 +84,8 @@ public:
     IFMapSender(IFMapXmppChannel *parent);
 
     virtual bool SendUpdate(const std::string &msg);
+    virtual bool SendUpdate(
+        const boost::shared_ptr<const IFMapEncodedMessage> &msg);
 
     virtual std::string ToString() const { return identifier_; }
     virtual const std::string &identifier() const { return identifier_; }
@@ -91,12 +94,16 @@ public:
 
     void SetIdentifier(const std::string &identifier) {
         identifier_ = identifier;
+        receiver_ = IFMapEncodedMessage::EscapeIdentifier(identifier);
     }
 
 private:
+    void UpdateSendStats(bool sent, size_t size);
+
     IFMapXmppChannel *parent_;
     std::string hostname_;      // hostname
     std::string identifier_;    // FQN
+    std::string receiver_;      // identifier_ escaped for the message
 };
 
 IFMapXmppChannel::IFMapSender::IFMapSender(IFMapXmppChannel *parent)
@@ -108,15 +115,30 @@ bool IFMapXmppChannel::IFMapSender::SendUpdate(const std::string &msg) {
         reinterpret_cast<const uint8_t *>(msg.data()), msg.size(), &msg,
         xmps::CONFIG,
         boost::bind(&IFMapXmppChannel::WriteReadyCb, parent_, _1));
+    UpdateSendStats(sent, msg.size());
+    return sent;
+}
+
+// The shared text of the message is passed to the channel as is, around the
+// address of this client.
+bool IFMapXmppChannel::IFMapSender::SendUpdate(
+    const boost::shared_ptr<const IFMapEncodedMessage> &msg) {
+    std::vector<boost::asio::const_buffer> buffers;
+    msg->GetBuffers(receiver_, &buffers);
+    bool sent = parent_->channel_->Send(buffers, xmps::CONFIG,
+        boost::bind(&IFMapXmppChannel::WriteReadyCb, parent_, _1));
+    UpdateSendStats(sent, msg->size(receiver_));
+    return sent;
+}
 
+void IFMapXmppChannel::IFMapSender::UpdateSendStats(bool sent, size_t size) {
     if (sent) {
         incr_msgs_sent();
-        incr_bytes_sent(msg.size());
+        incr_bytes_sent(size);
     } else {
         set_send_is_blocked(true);
         incr_msgs_blocked();
     }
-    return sent;
 }
 
 void IFMapXmppChannel::WriteReadyCb(const boost::system::error_code &ec) {
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include "ifmap/ifmap_client_set.h"
+
+#include "base/bitset.h"
+#include "base/logging.h"
+#include "testing/gunit.h"
+
+class IFMapClientSetTest : public ::testing::Test {
+protected:
+    static IFMapClientSet Build(const int *bits, size_t count) {
+        IFMapClientSet set;
+        for (size_t i = 0; i < count; ++i) {
+            set.set(bits[i]);
+        }
+        return set;
+    }
+};
+
+TEST_F(IFMapClientSetTest, SetReset) {
+    IFMapClientSet set;
+    EXPECT_TRUE(set.empty());
+    EXPECT_EQ(IFMapClientSet::npos, set.find_first());
+
+    set.set(3);
+    set.set(700);
+    set.set(2);
+    EXPECT_EQ(3U, set.count());
+    EXPECT_TRUE(set.test(700));
+    EXPECT_FALSE(set.test(701));
+    EXPECT_EQ(2U, set.find_first());
+    EXPECT_EQ(3U, set.find_next(2));
+    EXPECT_EQ(700U, set.find_next(3));
+    EXPECT_EQ(IFMapClientSet::npos, set.find_next(700));
+
+    set.reset(700);
+    set.reset(2);
+    set.reset(3);
+    EXPECT_TRUE(set.empty());
+}
+
+TEST_F(IFMapClientSetTest, SetOperations) {
+    const int lhs_bits[] = { 1, 5, 300, 1000 };
+    const int rhs_bits[] = { 5, 1000, 1001, 4000 };
+    IFMapClientSet lhs = Build(lhs_bits, 4);
+    IFMapClientSet rhs = Build(rhs_bits, 4);
+
+    IFMapClientSet both = lhs & rhs;
+    EXPECT_EQ(2U, both.count());
+    EXPECT_TRUE(both.test(5));
+    EXPECT_TRUE(both.test(1000));
+    EXPECT_TRUE(lhs.Contains(both));
+    EXPECT_FALSE(lhs.Contains(rhs));
+    EXPECT_TRUE(lhs.Intersects(rhs));
+
+    IFMapClientSet diff;
+    diff.BuildComplement(lhs, rhs);
+    EXPECT_EQ(2U, diff.count());
+    EXPECT_TRUE(diff.test(1));
+    EXPECT_TRUE(diff.test(300));
+    EXPECT_FALSE(diff.Intersects(rhs));
+
+    IFMapClientSet all(lhs);
+    all |= rhs;
+    EXPECT_EQ(6U, all.count());
+    all.Reset(rhs);
+    EXPECT_EQ(diff, all);
+    all.Reset(diff);
+    EXPECT_TRUE(all.empty());
+}
+
+TEST_F(IFMapClientSetTest, BitSetConversion) {
+    BitSet bset;
+    bset.set(0);
+    bset.set(255);
+    bset.set(256);
+    bset.set(2048);
+    IFMapClientSet set(bset);
+    EXPECT_EQ(4U, set.count());
+    EXPECT_TRUE(set.ToBitSet() == bset);
+    EXPECT_EQ(bset.ToNumberedString(), set.ToNumberedString());
+}
+
+// Copies and results equal to an operand share the block list, and a
+// shared list is copied when modified.
+TEST_F(IFMapClientSetTest, CopyOnWrite) {
+    const int bits[] = { 1, 2, 3000 };
+    IFMapClientSet lhs = Build(bits, 3);
+    IFMapClientSet rhs(lhs);
+    EXPECT_TRUE(lhs.shared());
+
+    IFMapClientSet both = lhs & rhs;
+    IFMapClientSet any;
+    any |= lhs;
+    EXPECT_TRUE(both.shared());
+    EXPECT_TRUE(any.shared());
+
+    // Setting a bit that is already set doesn't copy.
+    rhs.set(2);
+    EXPECT_TRUE(rhs.shared());
+    rhs.set(4);
+    EXPECT_FALSE(lhs.test(4));
+    EXPECT_TRUE(rhs.test(4));
+    EXPECT_TRUE(rhs.Contains(lhs));
+
+    // A high client index costs a single block.
+    IFMapClientSet high;
+    high.set(3000);
+    IFMapClientSet low;
+    low.set(0);
+    EXPECT_EQ(low.memory(), high.memory());
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    LoggingInit();
+    return RUN_ALL_TESTS();
+}
@@ -5,6 +5,8 @@
 #include "ifmap/ifmap_exporter.h"
 
 #include "base/logging.h"
+#include "base/time_util.h"
+#include "base/util.h"
 #include "base/test/task_test_util.h"
 #include "control-node/control_node.h"
 #include "db/db.h"
@@ -13,6 +15,7 @@
 #include "io/test/event_manager_test.h"
 #include "ifmap/ifmap_client.h"
 #include "ifmap/ifmap_factory.h"
+#include "ifmap/ifmap_graph_walker.h"
 #include "ifmap/ifmap_link_table.h"
 #include "ifmap/ifmap_server.h"
 #include "ifmap/ifmap_server_table.h"
@@ -30,6 +33,7 @@
 
 #include <iostream>
 #include <fstream>
+#include <sstream>
 
 using namespace boost::asio;
 using namespace std;
@@ -1267,6 +1271,171 @@ TEST_F(IFMapExporterTest, ConfigTracker) {
     TASK_UTIL_EXPECT_EQ(LinkTableSize(), 10);
 }
 
+// A node stays of interest while it's reachable through another link and
+// loses the interest once the last path to it is deleted.
+TEST_F(IFMapExporterTest, LinkDeleteAlternatePath) {
+    server_->SetSender(new IFMapUpdateSenderMock(server_.get()));
+    TestClient c1("192.168.1.1");
+    ClientSetup(&c1);
+
+    IFMapMsgLink("virtual-machine", "virtual-machine-interface",
+                 "vm_x", "vm_x:veth0", "virtual-machine-interface-virtual-machine");
+    IFMapMsgLink("virtual-machine", "virtual-machine-interface",
+                 "vm_x", "vm_x:veth1", "virtual-machine-interface-virtual-machine");
+    IFMapMsgLink("virtual-machine-interface", "virtual-network",
+                 "vm_x:veth0", "blue");
+    IFMapMsgLink("virtual-machine-interface", "virtual-network",
+                 "vm_x:veth1", "blue");
+    IFMapMsgLink("virtual-network", "routing-instance", "blue", "blue");
+    IFMapMsgLink("virtual-router", "virtual-machine", "192.168.1.1", "vm_x");
+    task_util::WaitForIdle();
+
+    IFMapNode *blue = TableLookup("virtual-network", "blue");
+    ASSERT_TRUE(blue != NULL);
+    IFMapNode *blue_ri = TableLookup("routing-instance", "blue");
+    ASSERT_TRUE(blue_ri != NULL);
+    IFMapNodeState *state = exporter_->NodeStateLookup(blue);
+    ASSERT_TRUE(state != NULL);
+    IFMapNodeState *ri_state = exporter_->NodeStateLookup(blue_ri);
+    ASSERT_TRUE(ri_state != NULL);
+    TASK_UTIL_EXPECT_TRUE(state->interest().test(c1.index()));
+    TASK_UTIL_EXPECT_TRUE(ri_state->interest().test(c1.index()));
+    ProcessQueue();
+
+    IFMapMsgUnlink("virtual-machine-interface", "virtual-network",
+                   "vm_x:veth0", "blue");
+    task_util::WaitForIdle();
+    EXPECT_TRUE(state->interest().test(c1.index()));
+    EXPECT_TRUE(ri_state->interest().test(c1.index()));
+    EXPECT_TRUE(ConfigTrackerHasInterestState(c1.index(), state));
+
+    IFMapMsgUnlink("virtual-machine-interface", "virtual-network",
+                   "vm_x:veth1", "blue");
+    task_util::WaitForIdle();
+    TASK_UTIL_EXPECT_FALSE(state->interest().test(c1.index()));
+    TASK_UTIL_EXPECT_FALSE(ri_state->interest().test(c1.index()));
+    EXPECT_FALSE(ConfigTrackerHasInterestState(c1.index(), state));
+
+    // The interfaces are still reachable through the vm.
+    IFMapNode *veth0 = TableLookup("virtual-machine-interface", "vm_x:veth0");
+    ASSERT_TRUE(veth0 != NULL);
+    EXPECT_TRUE(exporter_->NodeStateLookup(veth0)->interest().test(
+        c1.index()));
+    EXPECT_LT(0U, exporter_->walker()->link_delete_walk_count());
+}
+
+// The listeners call each other when links are added to, or removed from,
+// nodes of interest. The time of the nested calls is only accounted once, so
+// the export time can't exceed the wall time of the exports.
+TEST_F(IFMapExporterTest, ExportTime) {
+    static const int kVmCount = 64;
+
+    server_->SetSender(new IFMapUpdateSenderMock(server_.get()));
+    TestClient c1("192.168.1.1");
+    ClientSetup(&c1);
+    task_util::WaitForIdle();
+
+    uint64_t export_time = exporter_->export_time();
+    uint64_t start = ClockMonotonicUsec();
+    for (int i = 0; i < kVmCount; ++i) {
+        ostringstream vm;
+        vm << "vm_" << i;
+        IFMapMsgLink("virtual-machine", "virtual-machine-interface",
+                     vm.str(), vm.str() + ":veth0",
+                     "virtual-machine-interface-virtual-machine");
+        IFMapMsgLink("virtual-machine-interface", "virtual-network",
+                     vm.str() + ":veth0", "blue");
+        IFMapMsgLink("virtual-router", "virtual-machine", "192.168.1.1",
+                     vm.str());
+    }
+    IFMapMsgLink("virtual-network", "routing-instance", "blue", "blue");
+    task_util::WaitForIdle();
+    uint64_t elapsed = ClockMonotonicUsec() - start;
+    EXPECT_LT(export_time, exporter_->export_time());
+    EXPECT_GE(elapsed, exporter_->export_time() - export_time);
+    ProcessQueue();
+
+    export_time = exporter_->export_time();
+    start = ClockMonotonicUsec();
+    for (int i = 0; i < kVmCount; ++i) {
+        ostringstream vm;
+        vm << "vm_" << i;
+        IFMapMsgUnlink("virtual-router", "virtual-machine", "192.168.1.1",
+                       vm.str());
+    }
+    task_util::WaitForIdle();
+    elapsed = ClockMonotonicUsec() - start;
+    EXPECT_LT(export_time, exporter_->export_time());
+    EXPECT_GE(elapsed, exporter_->export_time() - export_time);
+}
+
+// Time to converge after the links of many clients to a shared network are
+// deleted in bulk. Only the nodes around the deleted links are examined.
+TEST_F(IFMapExporterTest, LinkDeleteConvergence) {
+    static const int kClientCount = 64;
+    static const int kVmCount = 16;
+
+    server_->SetSender(new IFMapUpdateSenderMock(server_.get()));
+    vector<TestClient *> clients;
+    for (int i = 0; i < kClientCount; ++i) {
+        ostringstream addr;
+        addr << "10.1." << i / 256 << "." << i % 256;
+        TestClient *client = new TestClient(addr.str());
+        ClientSetup(client);
+        clients.push_back(client);
+    }
+
+    IFMapMsgLink("virtual-network", "routing-instance", "shared", "shared");
+    for (int i = 0; i < kClientCount; ++i) {
+        for (int j = 0; j < kVmCount; ++j) {
+            ostringstream vm;
+            vm << "vm_" << i << "_" << j;
+            IFMapMsgLink("virtual-machine", "virtual-machine-interface",
+                         vm.str(), vm.str() + ":veth0",
+                         "virtual-machine-interface-virtual-machine");
+            IFMapMsgLink("virtual-machine-interface", "virtual-network",
+                         vm.str() + ":veth0", "shared");
+            IFMapMsgLink("virtual-router", "virtual-machine",
+                         clients[i]->identifier(), vm.str());
+        }
+    }
+    task_util::WaitForIdle();
+
+    IFMapNode *shared = TableLookup("virtual-network", "shared");
+    ASSERT_TRUE(shared != NULL);
+    IFMapNodeState *state = exporter_->NodeStateLookup(shared);
+    ASSERT_TRUE(state != NULL);
+    TASK_UTIL_EXPECT_EQ(static_cast<size_t>(kClientCount),
+                        state->interest().count());
+    ProcessQueue();
+
+    uint64_t start = ClockMonotonicUsec();
+    for (int i = 0; i < kClientCount; ++i) {
+        for (int j = 0; j < kVmCount; ++j) {
+            ostringstream vm;
+            vm << "vm_" << i << "_" << j;
+            IFMapMsgUnlink("virtual-machine-interface", "virtual-network",
+                           vm.str() + ":veth0", "shared");
+        }
+    }
+    task_util::WaitForIdle();
+    uint64_t elapsed = ClockMonotonicUsec() - start;
+
+    TASK_UTIL_EXPECT_TRUE(state->interest().empty());
+    IFMapNode *shared_ri = TableLookup("routing-instance", "shared");
+    ASSERT_TRUE(shared_ri != NULL);
+    EXPECT_TRUE(exporter_->NodeStateLookup(shared_ri)->interest().empty());
+
+    const IFMapGraphWalker *walker = exporter_->walker();
+    cout << "Deleted " << kClientCount * kVmCount << " links of "
+         << kClientCount << " clients in " << elapsed << " usec, "
+         << walker->link_delete_walk_count() << " walks, "
+         << walker->link_delete_suspect_count() << " suspect nodes, "
+         << walker->interest_reset_count() << " interest resets" << endl;
+
+    STLDeleteValues(&clients);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     LoggingInit();
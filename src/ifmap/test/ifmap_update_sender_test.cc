@@ -4,6 +4,8 @@
 
 #include "ifmap/ifmap_update_sender.h"
 
+#include <pugixml/pugixml.hpp>
+
 #include "base/logging.h"
 #include "base/task.h"
 #include "base/test/task_test_util.h"
@@ -12,6 +14,7 @@
 #include "db/db_table.h"
 #include "io/event_manager.h"
 #include "ifmap/ifmap_client.h"
+#include "ifmap/ifmap_encoder.h"
 #include "ifmap/ifmap_exporter.h"
 #include "ifmap/ifmap_link_table.h"
 #include "ifmap/ifmap_node.h"
@@ -37,10 +40,21 @@ public:
     virtual bool SendUpdate(const std::string &msg) {
         cout << "Sending " << endl << msg << endl;
         send_update_cnt_++;
+        last_msg_ = msg;
         return send_success_;
     }
 
+    virtual bool SendUpdate(
+        const boost::shared_ptr<const IFMapEncodedMessage> &msg) {
+        last_encoded_ = msg;
+        return IFMapClient::SendUpdate(msg);
+    }
+
     int get_send_update_cnt() { return send_update_cnt_; }
+    const string &last_msg() const { return last_msg_; }
+    const IFMapEncodedMessage *last_encoded() const {
+        return last_encoded_.get();
+    }
 
     // Control if you want to block or continue sending
     void set_send_success(bool succ) { send_success_ = succ; }
@@ -49,6 +63,8 @@ private:
     string identifier_;
     bool send_success_;
     int send_update_cnt_;
+    string last_msg_;
+    boost::shared_ptr<const IFMapEncodedMessage> last_encoded_;
 };
 
 struct IFMapUpdateDeleter {
@@ -1231,6 +1247,79 @@ TEST_F(IFMapUpdateSenderTest, Bug228) {
     queue_->PrintQueue();
 }
 
+// The message is encoded once and shared by all the clients, each of which
+// receives it with its own address.
+TEST_F(IFMapUpdateSenderTest, SharedEncodedMessage) {
+    TestClient c0("c0");
+    TestClient c1("c1");
+    server_.ClientRegister(&c0);
+    server_.ClientExporterSetup(&c0);
+    server_.ClientRegister(&c1);
+    server_.ClientExporterSetup(&c1);
+
+    IFMapUpdate *u1 = CreateUpdate("u1", true);
+    IFMapUpdate *u2 = CreateUpdate("u2", false);
+    BitSet cli_bs;
+    cli_bs.set(c0.index());
+    cli_bs.set(c1.index());
+    u1->AdvertiseOr(cli_bs);
+    u2->AdvertiseOr(cli_bs);
+
+    queue_->Join(c0.index());
+    queue_->Join(c1.index());
+    queue_->Enqueue(u1);
+    queue_->Enqueue(u2);
+
+    sender_->QueueActive();
+    task_util::WaitForIdle();
+    TASK_UTIL_EXPECT_EQ(1, c0.get_send_update_cnt());
+    TASK_UTIL_EXPECT_EQ(1, c1.get_send_update_cnt());
+    TASK_UTIL_EXPECT_EQ(1, queue_->size());
+
+    // The clients hold references to the same message.
+    ASSERT_TRUE(c0.last_encoded() != NULL);
+    EXPECT_EQ(c0.last_encoded(), c1.last_encoded());
+    const IFMapEncodedMessage *encoded = c0.last_encoded();
+    EXPECT_EQ(encoded->size(
+                  IFMapEncodedMessage::EscapeIdentifier(c0.identifier())),
+              c0.last_msg().size());
+    EXPECT_NE(string::npos, c0.last_msg().find("to=\"c0/config\""));
+    EXPECT_NE(string::npos, c1.last_msg().find("to=\"c1/config\""));
+    EXPECT_EQ(c0.last_msg().substr(encoded->receiver_offset() + 2),
+              c1.last_msg().substr(encoded->receiver_offset() + 2));
+
+    queue_->Leave(c0.index());
+    queue_->Leave(c1.index());
+}
+
+// The identifier of the client is escaped in the address of the message.
+TEST_F(IFMapUpdateSenderTest, EscapedReceiver) {
+    TestClient c0("c0<&\"'>");
+    server_.ClientRegister(&c0);
+    server_.ClientExporterSetup(&c0);
+
+    IFMapUpdate *u1 = CreateUpdate("u1", true);
+    BitSet cli_bs;
+    cli_bs.set(c0.index());
+    u1->AdvertiseOr(cli_bs);
+
+    queue_->Join(c0.index());
+    queue_->Enqueue(u1);
+
+    sender_->QueueActive();
+    task_util::WaitForIdle();
+    TASK_UTIL_EXPECT_EQ(1, c0.get_send_update_cnt());
+    EXPECT_NE(string::npos,
+              c0.last_msg().find("to=\"c0&lt;&amp;&quot;&apos;&gt;/config\""));
+
+    pugi::xml_document doc;
+    ASSERT_TRUE(doc.load(c0.last_msg().c_str()));
+    EXPECT_EQ(c0.identifier() + "/config",
+              string(doc.child("iq").attribute("to").value()));
+
+    queue_->Leave(c0.index());
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     bool success = RUN_ALL_TESTS();
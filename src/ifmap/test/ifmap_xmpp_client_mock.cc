@@ -82,6 +82,7 @@ void IFMapXmppClientMock::ReceiveUpdate(const XmppStanza::XmppMessage *msg) {
     ++count_;
 
     assert(msg->type == XmppStanza::IQ_STANZA);
+    last_to_ = msg->to;
     XmlBase *impl = msg->dom.get();
     XmlPugi *pugi = reinterpret_cast<XmlPugi *>(impl);
 
@@ -52,6 +52,8 @@ public:
     bool Has2Messages() const { return count_ == 2; }
     bool HasNMessages(uint64_t n) const { return count_ == n; }
     const std::string& name() { return name_; }
+    // Receiver address of the last config message.
+    const std::string &last_to() const { return last_to_; }
 
     void ProcessNodeTag(pugi::xml_node xnode, ObjectSet *oset);
     void ProcessLinkTag(pugi::xml_node xnode) { return; }
@@ -75,5 +77,6 @@ private:
     std::string xmpp_server_addr_;
     std::string xmpp_server_config_name_;
     std::string recv_buffer_;
+    std::string last_to_;
 };
 
@@ -455,6 +455,51 @@ TEST_F(XmppIfmapTest, Connection) {
     EXPECT_TRUE(xmpp_server_->FindConnection(client_name) == NULL);
 }
 
+// Config messages are encoded once and sent through the channel as
+// fragments around the address of the client.
+TEST_F(XmppIfmapTest, ConfigMessageReceiver) {
+    string host_vm_name = "aad4c946-9390-4a53-8bbd-09d346f5ba6c";
+    ParseEventsJson("controller/src/ifmap/testdata/two-vn-connection.json");
+    FeedEventsJson();
+
+    string client_name(kDefaultClientName);
+    string filename("/tmp/" + GetUserName() + "_config_receiver.output");
+    IFMapXmppClientMock *vnsw_client =
+        new IFMapXmppClientMock(&evm_, xmpp_server_->GetPort(), client_name,
+                                filename);
+    TASK_UTIL_EXPECT_EQ(true, vnsw_client->IsEstablished());
+    vnsw_client->RegisterWithXmpp();
+    TASK_UTIL_EXPECT_TRUE(ServerIsEstablished(xmpp_server_, client_name)
+                          == true);
+
+    vnsw_client->SendConfigSubscribe();
+    TASK_UTIL_EXPECT_TRUE(ifmap_server_.FindClient(client_name) != NULL);
+    vnsw_client->SendVmConfigSubscribe(host_vm_name);
+    TASK_UTIL_EXPECT_EQ(2, vnsw_client->Count());
+
+    // The client received complete messages with its own address.
+    EXPECT_EQ(client_name + "/config", vnsw_client->last_to());
+    IFMapClient *client = GetIfmapClientFromChannel(client_name);
+    EXPECT_EQ(2, client->msgs_sent());
+    EXPECT_EQ(0, client->msgs_blocked());
+    EXPECT_LT(0, client->bytes_sent());
+
+    ConfigUpdate(vnsw_client, new XmppConfigData());
+    TASK_UTIL_EXPECT_EQ(ifmap_server_.GetClientMapSize(), 0);
+
+    vnsw_client->UnRegisterWithXmpp();
+    vnsw_client->Shutdown();
+    task_util::WaitForIdle();
+    TcpServerManager::DeleteServer(vnsw_client);
+    vnsw_client = NULL;
+
+    XmppConnection *sconnection = xmpp_server_->FindConnection(client_name);
+    if (sconnection) {
+        sconnection->Shutdown();
+    }
+    TASK_UTIL_EXPECT_EQ(xmpp_server_->ConnectionCount(), 0);
+}
+
 // Create 2 client connections back2back with the same client name
 TEST_F(XmppIfmapTest, CheckClientGraphCleanupTest) {
     string host_vm_name = "aad4c946-9390-4a53-8bbd-09d346f5ba6c";
@@ -14,7 +14,12 @@
 #include "vr_os.h"
 #endif
 #include <sys/socket.h>
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/uio.h>
+#endif
 
+#include <algorithm>
 #include <boost/bind.hpp>
 
 #include <base/logging.h>
@@ -168,12 +173,15 @@ void DecodeSandeshMessages(char *buf, uint32_t buf_len, SandeshContext *sandesh_
 /////////////////////////////////////////////////////////////////////////////
 KSyncSock::KSyncSock() :
     nl_client_(NULL), wait_tree_(), send_queue_(this),
-    max_bulk_msg_count_(kMaxBulkMsgCount), max_bulk_buf_size_(kMaxBulkMsgSize),
+    max_bulk_msg_count_(kMaxBulkMsgCount),
+    bulk_msg_count_limit_(kMaxBulkMsgCountLimit),
+    max_bulk_buf_size_(kMaxBulkMsgSize), bulk_batch_size_(1),
+    bulk_batch_limit_(kMaxBulkBatchSize), bulk_batch_(),
     bulk_seq_no_(kInvalidBulkSeqNo), bulk_buf_size_(0), bulk_msg_count_(0),
     rx_buff_(NULL), read_inline_(true), bulk_msg_context_(NULL),
     use_wait_tree_(true), process_data_inline_(false),
     ksync_bulk_sandesh_context_(), uve_bulk_sandesh_context_(),
-    tx_count_(0), ack_count_(0), err_count_(0), 
+    tx_count_(0), tx_batch_count_(0), ack_count_(0), err_count_(0), 
     rx_process_queue_(TaskScheduler::GetInstance()->GetTaskId("Agent::KSync"), 0,
                     boost::bind(&KSyncSock::ProcessRxData, this, _1)) {
     TaskScheduler *scheduler = TaskScheduler::GetInstance();
@@ -197,6 +205,8 @@ KSyncSock::KSyncSock() :
 
     memset(bulk_mctx_arr_, 0, sizeof(bulk_mctx_arr_));
     bmca_prod_ = bmca_cons_ = 0;
+    memset(rx_batch_buff_, 0, sizeof(rx_batch_buff_));
+    bulk_batch_.reserve(kMaxBulkBatchSize);
 }
 
 KSyncSock::~KSyncSock() {
@@ -207,6 +217,10 @@ KSyncSock::~KSyncSock() {
         rx_buff_ = NULL;
     }
 
+    for (uint32_t i = 0; i < kMaxRxBatchSize; i++) {
+        delete [] rx_batch_buff_[i];
+    }
+
     for(int i = 0; i < kRxWorkQueueCount; i++) {
         ksync_rx_queue[i]->Shutdown();
         delete ksync_rx_queue[i];
@@ -482,36 +496,104 @@ void KSyncSock::WriteHandler(const boost::system::error_code& error,
 }
 
 // End of messages in the work-queue. Send messages pending in bulk context
+// and bulk messages pending in batch
 void KSyncSock::OnEmptyQueue(bool done) {
-    if (bulk_seq_no_ == kInvalidBulkSeqNo)
-        return;
-
-    KSyncBulkMsgContext *bulk_message_context = NULL;
-    if (use_wait_tree_) {
-        if (read_inline_ == false) {
-            tbb::mutex::scoped_lock lock(mutex_);
-            WaitTree::iterator it = wait_tree_.find(bulk_seq_no_);
-            assert(it != wait_tree_.end());
-            bulk_message_context = &it->second;
+    if (bulk_seq_no_ != kInvalidBulkSeqNo) {
+        KSyncBulkMsgContext *bulk_message_context = NULL;
+        if (use_wait_tree_) {
+            if (read_inline_ == false) {
+                tbb::mutex::scoped_lock lock(mutex_);
+                WaitTree::iterator it = wait_tree_.find(bulk_seq_no_);
+                assert(it != wait_tree_.end());
+                bulk_message_context = &it->second;
+            } else {
+                bulk_message_context = bulk_msg_context_;
+            }
         } else {
-            bulk_message_context = bulk_msg_context_;
+            bulk_message_context = bulk_mctx_arr_[bmca_prod_];
         }
-    } else {
-        bulk_message_context = bulk_mctx_arr_[bmca_prod_];
+
+        SendBulkMessage(bulk_message_context, bulk_seq_no_);
     }
 
-    SendBulkMessage(bulk_message_context, bulk_seq_no_);
+    FlushBulkBatch();
+    // Load is light again, fall back to default bulk sizes
+    ResetBulkLimits();
+}
+
+void KSyncSock::ResetBulkLimits() {
+    max_bulk_msg_count_ = kMaxBulkMsgCount;
+    if (max_bulk_msg_count_ > bulk_msg_count_limit_)
+        max_bulk_msg_count_ = bulk_msg_count_limit_;
+    bulk_batch_size_ = 1;
+}
+
+void KSyncSock::SetBulkLimits(uint32_t msg_count_limit, uint32_t batch_limit) {
+    assert(msg_count_limit > 0 && msg_count_limit <= kMaxBulkMsgCountLimit);
+    assert(batch_limit > 0 && batch_limit <= kMaxBulkBatchSize);
+    bulk_msg_count_limit_ = msg_count_limit;
+    bulk_batch_limit_ = batch_limit;
+    ResetBulkLimits();
+}
+
+void KSyncSock::SendBatch(KSyncBulkBatch *batch) {
+    for (KSyncBulkBatch::iterator it = batch->begin(); it != batch->end();
+         ++it) {
+        KSyncBufferList iovec;
+        it->context_->Data(&iovec);
+        bulk_buf_size_ = it->buf_size_;
+        SendTo(&iovec, it->seqno_);
+    }
+}
+
+uint32_t KSyncSock::ReceiveBatch(char **buffs, uint32_t count) {
+    Receive(boost::asio::buffer(buffs[0], kBufLen));
+    return 1;
+}
+
+// Send bulk messages pending in batch and read their responses.
+// Responses arrive in the order bulk messages were sent. The last response
+// for a bulk context does not have more-data set.
+void KSyncSock::FlushBulkBatch() {
+    if (bulk_batch_.empty())
+        return;
+
+    tx_batch_count_++;
+    SendBatch(&bulk_batch_);
+
+    KSyncBulkBatch::iterator it = bulk_batch_.begin();
+    while (it != bulk_batch_.end()) {
+        // Take buffers pre-allocated in the bulk context being read. The
+        // bulk context can be freed once its last response is enqueued, so
+        // it is not accessed after that
+        for (uint32_t i = 0; i < kMaxRxBatchSize; i++) {
+            if (rx_batch_buff_[i] == NULL)
+                rx_batch_buff_[i] = it->context_->GetReceiveBuffer();
+        }
+
+        uint32_t count = ReceiveBatch(rx_batch_buff_, kMaxRxBatchSize);
+        for (uint32_t i = 0; i < count; i++) {
+            assert(it != bulk_batch_.end());
+            char *rxbuf = rx_batch_buff_[i];
+            rx_batch_buff_[i] = NULL;
+            bool more_data = IsMoreData(rxbuf);
+            ValidateAndEnqueue(rxbuf, it->context_);
+            if (more_data == false)
+                ++it;
+        }
+    }
+    bulk_batch_.clear();
 }
 
 // Send messages accumilated in bulk context
 int KSyncSock::SendBulkMessage(KSyncBulkMsgContext *bulk_message_context,
                                uint32_t seqno) {
-    KSyncBufferList iovec;
-    // Get all buffers to send into single io-vector
-    bulk_message_context->Data(&iovec);
     tx_count_++;
 
     if (!read_inline_) {
+        KSyncBufferList iovec;
+        // Get all buffers to send into single io-vector
+        bulk_message_context->Data(&iovec);
         if (!use_wait_tree_) {
             bmca_prod_++;
             if (bmca_prod_ >= KSYNC_BMC_ARR_SIZE) {
@@ -523,19 +605,27 @@ int KSyncSock::SendBulkMessage(KSyncBulkMsgContext *bulk_message_context,
                     boost::bind(&KSyncSock::WriteHandler, this,
                                 placeholders::error,
                                 placeholders::bytes_transferred));
-    } else {
+    } else if (process_data_inline_) {
+        KSyncBufferList iovec;
+        bulk_message_context->Data(&iovec);
         SendTo(&iovec, seqno);
         bool more_data = false;
         do {
             char *rxbuf = bulk_message_context->GetReceiveBuffer();
             Receive(boost::asio::buffer(rxbuf, kBufLen));
             more_data = IsMoreData(rxbuf);
-            if (!process_data_inline_) {
-                ValidateAndEnqueue(rxbuf, bulk_message_context);
-            } else {
-                ProcessDataInline(rxbuf);
-            }
+            ProcessDataInline(rxbuf);
         } while(more_data);
+    } else {
+        bulk_batch_.push_back(KSyncBulkTx(bulk_message_context, seqno,
+                                          bulk_buf_size_));
+        if (bulk_batch_.size() >= bulk_batch_size_) {
+            FlushBulkBatch();
+            // Batch filled up before the queue drained. Send more bulk
+            // messages together till it does
+            bulk_batch_size_ = std::min(bulk_batch_size_ * 2,
+                                        bulk_batch_limit_);
+        }
     }
 
     bulk_msg_context_ = NULL;
@@ -635,6 +725,13 @@ bool KSyncSock::SendAsyncImpl(IoContext *ioc) {
         return true;
     }
 
+    // Bulk context is full on message count with more messages queued.
+    // Allow bigger bulk messages till the queue drains
+    if (bulk_msg_count_ >= max_bulk_msg_count_) {
+        max_bulk_msg_count_ = std::min(max_bulk_msg_count_ * 2,
+                                       bulk_msg_count_limit_);
+    }
+
     // Message cannot be added to bulk-list. Send the current list
     SendBulkMessage(bulk_message_context, bulk_seq_no_);
 
@@ -646,6 +743,90 @@ bool KSyncSock::SendAsyncImpl(IoContext *ioc) {
 }
 
 
+#if defined(__linux__)
+/////////////////////////////////////////////////////////////////////////////
+// Vectored socket i/o utilities
+/////////////////////////////////////////////////////////////////////////////
+// Wait till socket is ready for i/o. Used when the socket is in
+// non-blocking mode
+static void WaitForSocket(int fd, short events) {
+    struct pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = events;
+    pfd.revents = 0;
+    while (poll(&pfd, 1, -1) < 0 && errno == EINTR) {
+    }
+}
+
+// Fill iovec for a bulk message. The first entry is the transport header
+static size_t BulkMsgIoVec(KSyncBulkMsgContext *context, void *hdr,
+                           size_t hdr_len, struct iovec *iov, size_t max) {
+    KSyncBufferList list;
+    context->Data(&list);
+    assert(list.size() < max);
+
+    iov[0].iov_base = hdr;
+    iov[0].iov_len = hdr_len;
+    size_t count = 1;
+    for (KSyncBufferList::iterator it = list.begin(); it != list.end();
+         ++it) {
+        iov[count].iov_base = buffer_cast<void *>(*it);
+        iov[count].iov_len = buffer_size(*it);
+        count++;
+    }
+    return count;
+}
+
+static void SendMessages(int fd, struct mmsghdr *msgs, unsigned int count) {
+    unsigned int sent = 0;
+    while (sent < count) {
+        int ret = sendmmsg(fd, msgs + sent, count - sent, 0);
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                WaitForSocket(fd, POLLOUT);
+                continue;
+            }
+            LOG(ERROR, "Error sending to Ksync sock. Error : "
+                << strerror(errno));
+            assert(0);
+        }
+        sent += ret;
+    }
+}
+
+// Receive at least one message. Returns number of messages received
+static uint32_t ReceiveMessages(int fd, char **buffs, uint32_t count) {
+    struct mmsghdr msgs[KSyncSock::kMaxRxBatchSize];
+    struct iovec iov[KSyncSock::kMaxRxBatchSize];
+    count = std::min(count, (uint32_t)KSyncSock::kMaxRxBatchSize);
+    memset(msgs, 0, sizeof(msgs[0]) * count);
+    for (uint32_t i = 0; i < count; i++) {
+        iov[i].iov_base = buffs[i];
+        iov[i].iov_len = KSyncSock::kBufLen;
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    while (true) {
+        int ret = recvmmsg(fd, msgs, count, MSG_WAITFORONE, NULL);
+        if (ret > 0)
+            return ret;
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            WaitForSocket(fd, POLLIN);
+            continue;
+        }
+        LOG(ERROR, "Error reading from Ksync sock. Error : "
+            << strerror(errno));
+        assert(0);
+    }
+    return 0;
+}
+#endif
+
 /////////////////////////////////////////////////////////////////////////////
 // KSyncSockNetlink routines
 /////////////////////////////////////////////////////////////////////////////
@@ -671,6 +852,7 @@ KSyncSockNetlink::KSyncSockNetlink(boost::asio::io_service &ios, int protocol) :
 
     // TODO(WINDOWS): Windows implementation currently supports only singular message transfers
     max_bulk_msg_count_ = 1;
+    bulk_msg_count_limit_ = 1;
 }
 #else
 KSyncSockNetlink::KSyncSockNetlink(boost::asio::io_service &ios, int protocol)
@@ -809,6 +991,60 @@ void KSyncSockNetlink::Receive(mutable_buffers_1 buf) {
 #endif
 }
 
+#if defined(__linux__)
+// Send all bulk messages with one sendmmsg. Each message gets its own copy
+// of the netlink header built in nl_client_
+void KSyncSockNetlink::SendBatch(KSyncBulkBatch *batch) {
+    static const size_t kMaxHdrLen = 64;
+    char hdr[kMaxBulkBatchSize][kMaxHdrLen];
+    struct iovec iov[kMaxBulkBatchSize][kMaxBulkMsgCountLimit + 1];
+    struct mmsghdr msgs[kMaxBulkBatchSize];
+    struct sockaddr_nl sa;
+
+    assert(batch->size() <= kMaxBulkBatchSize);
+    memset(&sa, 0, sizeof(sa));
+    sa.nl_family = AF_NETLINK;
+    memset(msgs, 0, sizeof(msgs[0]) * batch->size());
+    for (size_t i = 0; i < batch->size(); i++) {
+        const KSyncBulkTx &tx = batch->at(i);
+        ResetNetlink(nl_client_);
+        UpdateNetlink(nl_client_, tx.buf_size_, tx.seqno_);
+        size_t hdr_len = nl_client_->cl_buf_offset;
+        assert(hdr_len <= kMaxHdrLen);
+        memcpy(hdr[i], nl_client_->cl_buf, hdr_len);
+
+        msgs[i].msg_hdr.msg_name = &sa;
+        msgs[i].msg_hdr.msg_namelen = sizeof(sa);
+        msgs[i].msg_hdr.msg_iov = iov[i];
+        msgs[i].msg_hdr.msg_iovlen =
+            BulkMsgIoVec(tx.context_, hdr[i], hdr_len, iov[i],
+                         kMaxBulkMsgCountLimit + 1);
+    }
+    SendMessages(sock_.native(), msgs, batch->size());
+}
+
+uint32_t KSyncSockNetlink::ReceiveBatch(char **buffs, uint32_t count) {
+    count = ReceiveMessages(sock_.native(), buffs, count);
+    for (uint32_t i = 0; i < count; i++) {
+        struct nlmsghdr *nlh = (struct nlmsghdr *)buffs[i];
+        if (nlh->nlmsg_type == NLMSG_ERROR) {
+            LOG(ERROR, "Netlink error for seqno " << nlh->nlmsg_seq
+                << " len " << nlh->nlmsg_len);
+            assert(0);
+        }
+    }
+    return count;
+}
+#else
+void KSyncSockNetlink::SendBatch(KSyncBulkBatch *batch) {
+    KSyncSock::SendBatch(batch);
+}
+
+uint32_t KSyncSockNetlink::ReceiveBatch(char **buffs, uint32_t count) {
+    return KSyncSock::ReceiveBatch(buffs, count);
+}
+#endif
+
 /////////////////////////////////////////////////////////////////////////////
 // KSyncSockUdp routines
 /////////////////////////////////////////////////////////////////////////////
@@ -887,6 +1123,43 @@ void KSyncSockUdp::Receive(mutable_buffers_1 buf) {
     sock_.receive_from(buf, ep);
 }
 
+#if defined(__linux__)
+void KSyncSockUdp::SendBatch(KSyncBulkBatch *batch) {
+    struct uvr_msg_hdr hdr[kMaxBulkBatchSize];
+    struct iovec iov[kMaxBulkBatchSize][kMaxBulkMsgCountLimit + 1];
+    struct mmsghdr msgs[kMaxBulkBatchSize];
+
+    assert(batch->size() <= kMaxBulkBatchSize);
+    memset(msgs, 0, sizeof(msgs[0]) * batch->size());
+    for (size_t i = 0; i < batch->size(); i++) {
+        const KSyncBulkTx &tx = batch->at(i);
+        hdr[i].seq_no = tx.seqno_;
+        hdr[i].flags = 0;
+        hdr[i].msg_len = tx.buf_size_;
+
+        msgs[i].msg_hdr.msg_name = server_ep_.data();
+        msgs[i].msg_hdr.msg_namelen = server_ep_.size();
+        msgs[i].msg_hdr.msg_iov = iov[i];
+        msgs[i].msg_hdr.msg_iovlen =
+            BulkMsgIoVec(tx.context_, &hdr[i], sizeof(hdr[i]), iov[i],
+                         kMaxBulkMsgCountLimit + 1);
+    }
+    SendMessages(sock_.native(), msgs, batch->size());
+}
+
+uint32_t KSyncSockUdp::ReceiveBatch(char **buffs, uint32_t count) {
+    return ReceiveMessages(sock_.native(), buffs, count);
+}
+#else
+void KSyncSockUdp::SendBatch(KSyncBulkBatch *batch) {
+    KSyncSock::SendBatch(batch);
+}
+
+uint32_t KSyncSockUdp::ReceiveBatch(char **buffs, uint32_t count) {
+    return KSyncSock::ReceiveBatch(buffs, count);
+}
+#endif
+
 void KSyncSock::ProcessDataInline(char *data) {
     KSyncBulkMsgContext *bulk_message_context = NULL;
     KSyncBulkSandeshContext *bulk_sandesh_context;
@@ -209,6 +209,20 @@ private:
  *     in single KSync Response Work-Queue
  *   - The input queue for KSyncTxQueue is not empty.
  *
+ *   max_bulk_msg_count_ adapts to load. It starts at kMaxBulkMsgCount and
+ *   doubles each time a bulk context fills up on message count, up to
+ *   bulk_msg_count_limit_. It is reset when KSyncTxQueue drains.
+ *
+ * Batching bulk messages
+ *   When responses are read inline, KSyncTxQueue would otherwise wait for
+ *   the responses of one bulk message before sending the next. Instead,
+ *   bulk messages are collected in bulk_batch_ and sent together (using
+ *   sendmmsg where supported), after which responses for all of them are
+ *   read (using recvmmsg where supported). The batch size starts at one
+ *   and doubles each time a batch fills up before KSyncTxQueue drains, up to
+ *   bulk_batch_limit_. Pending messages are always sent when KSyncTxQueue
+ *   drains, so batching does not add latency when load is light.
+ *
  * Decoding messages
  *   KSync response are processed in context of KSyncSock::receive_work_queue_.
  *   Each IoContext type has its own set of receive work-queue.
@@ -317,8 +331,18 @@ public:
 
     // Number of messages that can be bunched together
     const static unsigned kMaxBulkMsgCount = 16;
+    // Upper limit for number of messages in a bulk context while the
+    // transmit queue has backlog. Each IoContext can bring two receive
+    // buffers into the bulk context
+    const static unsigned kMaxBulkMsgCountLimit =
+        KSyncBulkMsgContext::kMaxRxBufferCount / 2;
     // Max size of buffer that can be bunched together
     const static unsigned kMaxBulkMsgSize = (4*1024);
+    // Max number of bulk messages sent before reading responses when
+    // responses are read inline
+    const static unsigned kMaxBulkBatchSize = 8;
+    // Max number of responses read in one receive call
+    const static unsigned kMaxRxBatchSize = 16;
     // Sequence number to denote invalid builk-context
     const static unsigned kInvalidBulkSeqNo = 0xFFFFFFFF;
 
@@ -327,6 +351,20 @@ public:
     typedef boost::function<void(const boost::system::error_code &, size_t)>
         HandlerCb;
 
+    // Bulk message waiting to be sent in a batch
+    struct KSyncBulkTx {
+        KSyncBulkMsgContext *context_;
+        uint32_t seqno_;
+        // Size of the messages in bulk context
+        uint32_t buf_size_;
+
+        KSyncBulkTx(KSyncBulkMsgContext *ctxt, uint32_t seqno,
+                    uint32_t buf_size) :
+            context_(ctxt), seqno_(seqno), buf_size_(buf_size) {
+        }
+    };
+    typedef std::vector<KSyncBulkTx> KSyncBulkBatch;
+
     // Request structure in the KSync Response Queue
     struct KSyncRxData {
         // buffer having KSync response
@@ -380,6 +418,12 @@ public:
     bool TryAddToBulk(KSyncBulkMsgContext *bulk_context, IoContext *ioc);
     void OnEmptyQueue(bool done);
     int tx_count() const { return tx_count_; }
+    int tx_batch_count() const { return tx_batch_count_; }
+    uint32_t max_bulk_msg_count() const { return max_bulk_msg_count_; }
+    uint32_t bulk_batch_size() const { return bulk_batch_size_; }
+    // Set upper limits for adaptive bulk sizing. Must be called when the
+    // transmit queue is idle
+    void SetBulkLimits(uint32_t msg_count_limit, uint32_t batch_limit);
 
     // Start Ksync Asio operations
     static void Start(bool read_inline);
@@ -434,11 +478,20 @@ protected:
 
     // Information maintained for bulk processing
 
-    // Max messages in one bulk context
+    // Max messages in one bulk context. Grows up to bulk_msg_count_limit_
+    // while the transmit queue has backlog and is reset when it drains
     uint32_t max_bulk_msg_count_;
+    uint32_t bulk_msg_count_limit_;
     // Max buffer size in one bulk context
     uint32_t max_bulk_buf_size_;
 
+    // Bulk messages sent together before reading responses, used when
+    // responses are read inline. Grows up to bulk_batch_limit_ while the
+    // transmit queue has backlog and is reset when it drains
+    uint32_t bulk_batch_size_;
+    uint32_t bulk_batch_limit_;
+    KSyncBulkBatch bulk_batch_;
+
     // Sequence number of first message in bulk context. Entry in WaitTree is
     // added based on this sequence number
     uint32_t bulk_seq_no_;
@@ -458,6 +511,12 @@ private:
                              HandlerCb cb) = 0;
     virtual std::size_t SendTo(KSyncBufferList *iovec, uint32_t seq_no) = 0;
     virtual void Receive(boost::asio::mutable_buffers_1) = 0;
+    // Send all bulk messages in batch. Default implementation sends them
+    // one at a time with SendTo
+    virtual void SendBatch(KSyncBulkBatch *batch);
+    // Receive at least one message into buffers of kBufLen size. Returns
+    // number of messages received. Default implementation uses Receive
+    virtual uint32_t ReceiveBatch(char **buffs, uint32_t count);
     virtual uint32_t GetSeqno(char *data) = 0;
     virtual bool IsMoreData(char *data) = 0;
     virtual bool Validate(char *data) = 0;
@@ -474,6 +533,8 @@ private:
                            const KSyncRxData &data);
     bool ProcessRxData(KSyncRxQueueData data);
     bool SendAsyncImpl(IoContext *ioc);
+    void FlushBulkBatch();
+    void ResetBulkLimits();
     bool SendAsyncStart() {
         tbb::mutex::scoped_lock lock(mutex_);
         return (wait_tree_.size() <= KSYNC_ACK_WAIT_THRESHOLD);
@@ -491,9 +552,13 @@ private:
     bool process_data_inline_;
     KSyncBulkSandeshContext ksync_bulk_sandesh_context_[kRxWorkQueueCount];
     KSyncBulkSandeshContext uve_bulk_sandesh_context_[kRxWorkQueueCount];
+    // Receive buffers for batched reads. Buffers not consumed by a read are
+    // kept for the next one
+    char *rx_batch_buff_[kMaxRxBatchSize];
 
     // Debug stats
     int tx_count_;
+    int tx_batch_count_;
     int ack_count_;
     int err_count_;
     
@@ -530,6 +595,8 @@ public:
                              HandlerCb cb);
     virtual std::size_t SendTo(KSyncBufferList *iovec, uint32_t seq_no);
     virtual void Receive(boost::asio::mutable_buffers_1);
+    virtual void SendBatch(KSyncBulkBatch *batch);
+    virtual uint32_t ReceiveBatch(char **buffs, uint32_t count);
 
     static void NetlinkDecoder(char *data, SandeshContext *ctxt);
     static void NetlinkBulkDecoder(char *data, SandeshContext *ctxt, bool more);
@@ -559,6 +626,8 @@ public:
                              HandlerCb cb);
     virtual std::size_t SendTo(KSyncBufferList *iovec, uint32_t seq_no);
     virtual void Receive(boost::asio::mutable_buffers_1);
+    virtual void SendBatch(KSyncBulkBatch *batch);
+    virtual uint32_t ReceiveBatch(char **buffs, uint32_t count);
 
     static void Init(boost::asio::io_service &ios, int port,
                      const std::string &cpu_pin_policy);
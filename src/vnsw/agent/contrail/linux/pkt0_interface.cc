@@ -6,6 +6,7 @@
 #include <string.h>
 #include <fcntl.h>
 #include <assert.h>
+#include <unistd.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 
@@ -59,6 +60,14 @@ void Pkt0Interface::InitControlInterface() {
         assert(0);
     }
 
+    // Frames are read till EAGAIN in ReadBatch
+    int flags = fcntl(tap_fd_, F_GETFL);
+    if (flags < 0 || fcntl(tap_fd_, F_SETFL, flags | O_NONBLOCK) < 0) {
+        LOG(ERROR, "Packet Tap Error <" << errno << ": " <<
+            strerror(errno) << "> setting non-blocking mode on " << name_);
+        assert(0);
+    }
+
     if (ioctl(tap_fd_, TUNSETPERSIST, 0) < 0) {
         LOG(ERROR, "Packet Tap Error <" << errno << ": " <<
             strerror(errno) << "> making tap interface non-persistent");
@@ -141,9 +150,83 @@ void Pkt0Interface::InitControlInterface() {
     assert(ec == 0);
 
     VrouterControlInterface::InitControlInterface();
+    InitRxRing();
+    AsyncRead();
+}
+
+void Pkt0Interface::InitRxRing() {
+    rx_ring_.resize(kRxBatchSize);
+    PacketBufferManager *mgr =
+        pkt_handler()->agent()->pkt()->packet_buffer_manager();
+    for (int i = 0; i < kRxBatchSize; ++i) {
+        rx_ring_[i] = mgr->AllocatePooled(PktHandler::RX_PACKET,
+                                          kMaxPacketSize, 0);
+    }
+}
+
+void Pkt0Interface::AsyncRead() {
+    input_.async_read_some(
+            boost::asio::null_buffers(),
+            boost::bind(&Pkt0Interface::ReadHandler, this,
+                        boost::asio::placeholders::error,
+                        boost::asio::placeholders::bytes_transferred));
+}
+
+void Pkt0Interface::ReadHandler(const boost::system::error_code &error,
+                                std::size_t length) {
+    if (error) {
+        TAP_TRACE(Err,
+                  "Packet Tap Error <" + error.message() + "> reading packet");
+        if (error == boost::system::errc::operation_canceled) {
+            return;
+        }
+    } else {
+        int count = ReadBatch();
+        if (count > 0) {
+            ProcessBatch(count);
+        }
+    }
+
     AsyncRead();
 }
 
+// The tap device returns one frame per read. Read till the device is
+// drained or the ring is full
+int Pkt0Interface::ReadBatch() {
+    int count = 0;
+    while (count < kRxBatchSize) {
+        PacketBuffer *pkt = rx_ring_[count].get();
+        ssize_t len = read(tap_fd_, pkt->data(), kMaxPacketSize);
+        if (len < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                TAP_TRACE(Err, "Packet Tap Error <" +
+                          std::string(strerror(errno)) + "> reading packet");
+            }
+            break;
+        }
+        pkt->set_len(len);
+        count++;
+    }
+    return count;
+}
+
+// Hand over the first count buffers of the ring as a batch and replace them
+// with buffers from the pool
+void Pkt0Interface::ProcessBatch(int count) {
+    PacketBufferManager *mgr =
+        pkt_handler()->agent()->pkt()->packet_buffer_manager();
+    PktHandler::PacketBufferBatch batch;
+    batch.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        VrouterControlInterface::AddToBatch(rx_ring_[i], &batch);
+        rx_ring_[i] = mgr->AllocatePooled(PktHandler::RX_PACKET,
+                                          kMaxPacketSize, 0);
+    }
+    ControlInterface::ProcessBatch(&batch);
+}
+
 void Pkt0Interface::SendImpl(uint8_t *buff, uint16_t buff_len, const PacketBufferPtr &pkt,
                              buffer_list& buff_list) {
     input_.async_write_some(buff_list,
@@ -207,5 +290,34 @@ void Pkt0RawInterface::InitControlInterface() {
     assert(ec == 0);
 
     VrouterControlInterface::InitControlInterface();
+    InitRxRing();
     AsyncRead();
 }
+
+// Read upto kRxBatchSize frames with a single system call
+int Pkt0RawInterface::ReadBatch() {
+    struct mmsghdr msgs[kRxBatchSize];
+    struct iovec iovecs[kRxBatchSize];
+
+    memset(msgs, 0, sizeof(msgs));
+    for (int i = 0; i < kRxBatchSize; ++i) {
+        iovecs[i].iov_base = rx_ring_[i]->data();
+        iovecs[i].iov_len = kMaxPacketSize;
+        msgs[i].msg_hdr.msg_iov = &iovecs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int count = recvmmsg(tap_fd_, msgs, kRxBatchSize, MSG_DONTWAIT, NULL);
+    if (count < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            TAP_TRACE(Err, "Packet Tap Error <" +
+                      std::string(strerror(errno)) + "> reading packet");
+        }
+        return 0;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        rx_ring_[i]->set_len(msgs[i].msg_len);
+    }
+    return count;
+}
@@ -37,6 +37,20 @@ protected:
     void WriteHandler(const boost::system::error_code &error,
                       std::size_t length, uint8_t *buff);
 
+#ifdef __linux__
+    // On Linux, AsyncRead only waits for the descriptor to be readable.
+    // ReadHandler then reads upto kRxBatchSize frames into the receive ring
+    // of pooled buffers and hands them to PktHandler as one batch.
+    static const int kRxBatchSize = 64;
+
+    void InitRxRing();
+    // Read frames into the receive ring, returns number of frames read
+    virtual int ReadBatch();
+    void ProcessBatch(int count);
+
+    std::vector<PacketBufferPtr> rx_ring_;
+#endif
+
     std::string name_;
     int tap_fd_;
     unsigned char mac_address_[ETHER_ADDR_LEN];
@@ -60,6 +74,11 @@ public:
     void InitControlInterface();
 
 protected:
+#ifdef __linux__
+    // Read frames from the raw socket with recvmmsg
+    virtual int ReadBatch();
+#endif
+
     DISALLOW_COPY_AND_ASSIGN(Pkt0RawInterface);
 };
 
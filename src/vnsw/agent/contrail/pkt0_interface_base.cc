@@ -48,6 +48,10 @@ void Pkt0Interface::IoShutdownControlInterface() {
     boost::system::error_code ec;
     input_.close(ec);
     tap_fd_ = -1;
+#ifdef __linux__
+    // Return the receive ring to the pool
+    rx_ring_.clear();
+#endif
 }
 
 void Pkt0Interface::ShutdownControlInterface() {
@@ -62,7 +66,8 @@ void Pkt0Interface::WriteHandler(const boost::system::error_code &error,
     delete [] buff;
 }
 
-
+// Linux reads frames in batches, see linux/pkt0_interface.cc
+#ifndef __linux__
 void Pkt0Interface::AsyncRead() {
     read_buff_ = new uint8_t[kMaxPacketSize];
     input_.async_read_some(
@@ -95,6 +100,7 @@ void Pkt0Interface::ReadHandler(const boost::system::error_code &error,
 
     AsyncRead();
 }
+#endif
 
 int Pkt0Interface::Send(uint8_t *buff, uint16_t buff_len,
                         const PacketBufferPtr &pkt) {
@@ -182,6 +182,9 @@ void VNController::XmppServerConnect() {
             xmpp_cfg->endpoint.port(port);
             SetDscpConfig(xmpp_cfg);
             xmpp_cfg->xmlns = agent_->subcluster_name();
+            // Route updates are decoded from the stanza, see
+            // AgentXmppChannel::ReceiveUpdate.
+            xmpp_cfg->keep_stanza = true;
 
             // Create Xmpp Client
             XmppClient *client = new XmppClient(agent_->event_manager(), xmpp_cfg);
@@ -859,7 +862,9 @@ bool VNController::XmppMessageProcess(ControllerXmppDataType data) {
         if (data->config()) {
             AgentXmppChannel *peer =
                 agent_->controller_xmpp_channel(data->channel_id());
-            if (peer) {
+            if (peer && !data->stanza().empty()) {
+                peer->ReceiveInetUpdate(&data->stanza());
+            } else if (peer) {
                 peer->ReceiveBgpMessage(data->dom());
             }
         } else {
@@ -38,12 +38,22 @@ public:
         ControllerWorkQueueData(),
         peer_id_(peer_id), peer_state_(peer_state), channel_id_(channel_id),
         dom_(dom), config_(config) { }
+    // Inet route update that is decoded from the stanza without a DOM. The
+    // stanza is swapped in, leaving the argument empty.
+    ControllerXmppData(xmps::PeerId peer_id, uint8_t channel_id,
+                       std::string *stanza) :
+        ControllerWorkQueueData(),
+        peer_id_(peer_id), peer_state_(xmps::UNKNOWN),
+        channel_id_(channel_id), config_(true) {
+        stanza_.swap(*stanza);
+    }
     virtual ~ControllerXmppData() { }
 
     xmps::PeerId peer_id() const {return peer_id_;}
     xmps::PeerState peer_state() const {return peer_state_;}
     uint8_t channel_id() const {return channel_id_;}
     std::auto_ptr<XmlBase> dom() {return dom_;}
+    std::string &stanza() {return stanza_;}
     bool config() const {return config_;}
 
 private:
@@ -51,6 +61,7 @@ private:
     xmps::PeerState peer_state_;
     uint8_t channel_id_;
     std::auto_ptr<XmlBase> dom_;
+    std::string stanza_;
     bool config_;
     DISALLOW_COPY_AND_ASSIGN(ControllerXmppData);
 };
@@ -0,0 +1,344 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include <controller/controller_item_decoder.h>
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+using std::string;
+using std::vector;
+
+//
+// Numeric parsing follows the generated code: leading whitespace and an
+// empty value are accepted, trailing characters other than whitespace are
+// not.
+//
+static bool IsTrailingSpace(const char *endp) {
+    while (isspace(*endp))
+        endp++;
+    return *endp == '\0';
+}
+
+static bool ParseBoolean(const char *str) {
+    return strcmp(str, "true") == 0 || strcmp(str, "1") == 0;
+}
+
+ControllerInetItemDecoder::ControllerInetItemDecoder(char *buf, size_t size)
+    : parser_(buf, size), items_depth_(0), af_(0), safi_(0), vrf_name_(NULL),
+      node_(NULL), id_(NULL), error_(NULL) {
+}
+
+// Errors of the parser itself take precedence, they explain why the
+// expected element wasn't found.
+ControllerInetItemDecoder::Event ControllerInetItemDecoder::Error(
+        const char *error) {
+    error_ = parser_.error() ? parser_.error() : error;
+    return DECODE_ERROR;
+}
+
+// Advance to the child element name of the element at depth, skipping the
+// other children.
+bool ControllerInetItemDecoder::FindChild(size_t depth, const char *name) {
+    while (parser_.NextChild(depth)) {
+        if (strcmp(parser_.name(), name) == 0)
+            return true;
+        if (!parser_.SkipElement())
+            return false;
+    }
+    return false;
+}
+
+//
+// <message><event><items node="af/safi/vrf">
+//
+bool ControllerInetItemDecoder::ReadItems() {
+    if (parser_.Next() != XmlPullParser::START_ELEMENT ||
+        strcmp(parser_.name(), "message") != 0) {
+        Error("message not found");
+        return false;
+    }
+    if (!FindChild(parser_.depth(), "event") ||
+        !FindChild(parser_.depth(), "items")) {
+        Error("items not found");
+        return false;
+    }
+    items_depth_ = parser_.depth();
+    node_ = parser_.Attribute("node");
+    if (node_ == NULL) {
+        Error("items without node");
+        return false;
+    }
+
+    char *endp;
+    af_ = strtol(node_, &endp, 10);
+    if (*endp != '/') {
+        Error("malformed node");
+        return false;
+    }
+    safi_ = strtol(endp + 1, &endp, 10);
+    if (*endp != '/') {
+        Error("malformed node");
+        return false;
+    }
+    vrf_name_ = endp + 1;
+    return true;
+}
+
+ControllerInetItemDecoder::Event ControllerInetItemDecoder::Next(
+        autogen::ItemType *item) {
+    id_ = NULL;
+    while (parser_.NextChild(items_depth_)) {
+        if (strcmp(parser_.name(), "retract") == 0) {
+            id_ = parser_.Attribute("id");
+            if (id_ == NULL)
+                return Error("retract without id");
+            if (!parser_.SkipElement())
+                return Error("truncated retract");
+            return RETRACT;
+        }
+        if (strcmp(parser_.name(), "item") != 0) {
+            if (!parser_.SkipElement())
+                return Error("truncated items");
+            continue;
+        }
+
+        id_ = parser_.Attribute("id");
+        item->Clear();
+        size_t depth = parser_.depth();
+        while (parser_.NextChild(depth)) {
+            if (strcmp(parser_.name(), "entry") == 0) {
+                if (!DecodeEntry(item))
+                    return Error("bad entry");
+            } else if (!parser_.SkipElement()) {
+                return Error("truncated item");
+            }
+        }
+        if (parser_.event() != XmlPullParser::END_ELEMENT)
+            return Error("truncated item");
+        return ITEM;
+    }
+    if (parser_.event() != XmlPullParser::END_ELEMENT)
+        return Error("truncated items");
+    return END;
+}
+
+template <typename NumberType>
+bool ControllerInetItemDecoder::ReadNumber(NumberType *value) {
+    const char *text = parser_.ReadText();
+    if (text == NULL)
+        return false;
+    char *endp;
+    errno = 0;
+    long long number = strtoll(text, &endp, 10);
+    if (errno || !IsTrailingSpace(endp))
+        return false;
+    // Reject the values that don't fit in the field.
+    NumberType result = static_cast<NumberType>(number);
+    if (static_cast<long long>(result) != number)
+        return false;
+    *value = result;
+    return true;
+}
+
+template <typename NumberType>
+bool ControllerInetItemDecoder::ReadNumberList(const char *name,
+                                               vector<NumberType> *list) {
+    size_t depth = parser_.depth();
+    while (parser_.NextChild(depth)) {
+        if (strcmp(parser_.name(), name) == 0) {
+            NumberType value;
+            if (!ReadNumber(&value))
+                return false;
+            list->push_back(value);
+        } else if (!parser_.SkipElement()) {
+            return false;
+        }
+    }
+    return parser_.event() == XmlPullParser::END_ELEMENT;
+}
+
+bool ControllerInetItemDecoder::ReadString(string *value) {
+    const char *text = parser_.ReadText();
+    if (text == NULL)
+        return false;
+    value->assign(text);
+    return true;
+}
+
+bool ControllerInetItemDecoder::ReadStringList(const char *name,
+                                               vector<string> *list) {
+    size_t depth = parser_.depth();
+    while (parser_.NextChild(depth)) {
+        if (strcmp(parser_.name(), name) == 0) {
+            list->push_back(string());
+            if (!ReadString(&list->back()))
+                return false;
+        } else if (!parser_.SkipElement()) {
+            return false;
+        }
+    }
+    return parser_.event() == XmlPullParser::END_ELEMENT;
+}
+
+bool ControllerInetItemDecoder::DecodeNlri(autogen::ItemType *item) {
+    size_t depth = parser_.depth();
+    while (parser_.NextChild(depth)) {
+        const char *name = parser_.name();
+        bool ok;
+        if (strcmp(name, "af") == 0) {
+            ok = ReadNumber(&item->entry.nlri.af);
+        } else if (strcmp(name, "safi") == 0) {
+            ok = ReadNumber(&item->entry.nlri.safi);
+        } else if (strcmp(name, "address") == 0) {
+            ok = ReadString(&item->entry.nlri.address);
+        } else {
+            ok = parser_.SkipElement();
+        }
+        if (!ok)
+            return false;
+    }
+    return parser_.event() == XmlPullParser::END_ELEMENT;
+}
+
+bool ControllerInetItemDecoder::DecodeNextHop(autogen::NextHopType *nexthop) {
+    size_t depth = parser_.depth();
+    while (parser_.NextChild(depth)) {
+        const char *name = parser_.name();
+        bool ok;
+        if (strcmp(name, "af") == 0) {
+            ok = ReadNumber(&nexthop->af);
+        } else if (strcmp(name, "address") == 0) {
+            ok = ReadString(&nexthop->address);
+        } else if (strcmp(name, "mac") == 0) {
+            ok = ReadString(&nexthop->mac);
+        } else if (strcmp(name, "label") == 0) {
+            ok = ReadNumber(&nexthop->label);
+        } else if (strcmp(name, "vni") == 0) {
+            ok = ReadNumber(&nexthop->vni);
+        } else if (strcmp(name, "tunnel-encapsulation-list") == 0) {
+            ok = ReadStringList("tunnel-encapsulation",
+                &nexthop->tunnel_encapsulation_list.tunnel_encapsulation);
+        } else if (strcmp(name, "virtual-network") == 0) {
+            ok = ReadString(&nexthop->virtual_network);
+        } else if (strcmp(name, "tag-list") == 0) {
+            ok = ReadNumberList("tag", &nexthop->tag_list.tag);
+        } else {
+            ok = parser_.SkipElement();
+        }
+        if (!ok)
+            return false;
+    }
+    return parser_.event() == XmlPullParser::END_ELEMENT;
+}
+
+// Accept mobility fields either as attributes or as child elements.
+bool ControllerInetItemDecoder::DecodeMobility(autogen::ItemType *item) {
+    const char *seqno = parser_.Attribute("seqno");
+    if (seqno) {
+        char *endp;
+        errno = 0;
+        unsigned long value = strtoul(seqno, &endp, 10);
+        if (errno || !IsTrailingSpace(endp))
+            return false;
+        item->entry.mobility.seqno = value;
+    }
+    const char *sticky = parser_.Attribute("sticky");
+    if (sticky)
+        item->entry.mobility.sticky = ParseBoolean(sticky);
+
+    size_t depth = parser_.depth();
+    while (parser_.NextChild(depth)) {
+        const char *name = parser_.name();
+        bool ok;
+        if (strcmp(name, "seqno") == 0) {
+            ok = ReadNumber(&item->entry.mobility.seqno);
+        } else if (strcmp(name, "sticky") == 0) {
+            const char *text = parser_.ReadText();
+            ok = text != NULL;
+            if (ok)
+                item->entry.mobility.sticky = ParseBoolean(text);
+        } else {
+            ok = parser_.SkipElement();
+        }
+        if (!ok)
+            return false;
+    }
+    return parser_.event() == XmlPullParser::END_ELEMENT;
+}
+
+bool ControllerInetItemDecoder::DecodeLoadBalance(
+        autogen::LoadBalanceType *load_balance) {
+    size_t depth = parser_.depth();
+    while (parser_.NextChild(depth)) {
+        const char *name = parser_.name();
+        bool ok;
+        if (strcmp(name, "load-balance-fields") == 0) {
+            ok = ReadStringList("load-balance-field-list",
+                &load_balance->load_balance_fields.load_balance_field_list);
+        } else if (strcmp(name, "load-balance-decision") == 0) {
+            ok = ReadString(&load_balance->load_balance_decision);
+        } else {
+            ok = parser_.SkipElement();
+        }
+        if (!ok)
+            return false;
+    }
+    return parser_.event() == XmlPullParser::END_ELEMENT;
+}
+
+bool ControllerInetItemDecoder::DecodeEntry(autogen::ItemType *item) {
+    size_t depth = parser_.depth();
+    while (parser_.NextChild(depth)) {
+        const char *name = parser_.name();
+        bool ok;
+        if (strcmp(name, "nlri") == 0) {
+            ok = DecodeNlri(item);
+        } else if (strcmp(name, "next-hops") == 0) {
+            vector<autogen::NextHopType> &nexthops =
+                item->entry.next_hops.next_hop;
+            size_t nh_depth = parser_.depth();
+            ok = true;
+            while (ok && parser_.NextChild(nh_depth)) {
+                if (strcmp(parser_.name(), "next-hop") == 0) {
+                    nexthops.push_back(autogen::NextHopType());
+                    nexthops.back().Clear();
+                    ok = DecodeNextHop(&nexthops.back());
+                } else {
+                    ok = parser_.SkipElement();
+                }
+            }
+            ok = ok && parser_.event() == XmlPullParser::END_ELEMENT;
+        } else if (strcmp(name, "version") == 0) {
+            ok = ReadNumber(&item->entry.version);
+        } else if (strcmp(name, "virtual-network") == 0) {
+            ok = ReadString(&item->entry.virtual_network);
+        } else if (strcmp(name, "sequence-number") == 0) {
+            ok = ReadNumber(&item->entry.sequence_number);
+        } else if (strcmp(name, "security-group-list") == 0) {
+            ok = ReadNumberList("security-group",
+                &item->entry.security_group_list.security_group);
+        } else if (strcmp(name, "community-tag-list") == 0) {
+            ok = ReadStringList("community-tag",
+                &item->entry.community_tag_list.community_tag);
+        } else if (strcmp(name, "local-preference") == 0) {
+            ok = ReadNumber(&item->entry.local_preference);
+        } else if (strcmp(name, "med") == 0) {
+            ok = ReadNumber(&item->entry.med);
+        } else if (strcmp(name, "mobility") == 0) {
+            ok = DecodeMobility(item);
+        } else if (strcmp(name, "load-balance") == 0) {
+            ok = DecodeLoadBalance(&item->entry.load_balance);
+        } else if (strcmp(name, "sub-protocol") == 0) {
+            ok = ReadString(&item->entry.sub_protocol);
+        } else {
+            ok = parser_.SkipElement();
+        }
+        if (!ok)
+            return false;
+    }
+    return parser_.event() == XmlPullParser::END_ELEMENT;
+}
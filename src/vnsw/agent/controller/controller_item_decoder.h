@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#ifndef __CONTROLLER_ITEM_DECODER_H__
+#define __CONTROLLER_ITEM_DECODER_H__
+
+#include <stddef.h>
+
+#include <string>
+#include <vector>
+
+#include <base/util.h>
+#include <xml/xml_pull_parser.h>
+#include <xmpp_unicast_types.h>
+
+//
+// Streaming decoder for inet and inet6 route updates received from the
+// control-node.
+//
+// The update is parsed in place from the message stanza with XmlPullParser,
+// so no DOM is built and the items are not collected in an ItemsType before
+// they are processed. Items are decoded one at a time into a caller supplied
+// autogen::ItemType, which can be reused across items so that its strings
+// and vectors keep their capacity.
+//
+// Typical use:
+//
+//     ControllerInetItemDecoder decoder(buf, size);
+//     if (!decoder.ReadItems())
+//         return;
+//     autogen::ItemType item;
+//     ControllerInetItemDecoder::Event event;
+//     while ((event = decoder.Next(&item)) != ControllerInetItemDecoder::END) {
+//         ...
+//     }
+//
+class ControllerInetItemDecoder {
+public:
+    enum Event {
+        ITEM,
+        RETRACT,
+        END,
+        DECODE_ERROR
+    };
+
+    // The buffer is modified and must outlive the decoder.
+    ControllerInetItemDecoder(char *buf, size_t size);
+
+    // Advance to the items element of the message and decode its node
+    // attribute. Returns false if there is none or it is malformed.
+    bool ReadItems();
+
+    // Decode the next item into item, or the next retract. The id of either
+    // is available from id().
+    Event Next(autogen::ItemType *item);
+
+    // Address family from the node attribute, <af>/<safi>/<vrf>.
+    int af() const { return af_; }
+    int safi() const { return safi_; }
+    const char *vrf_name() const { return vrf_name_; }
+    const char *node() const { return node_; }
+    const char *id() const { return id_; }
+    const char *error() const { return error_; }
+
+private:
+    Event Error(const char *error);
+    bool FindChild(size_t depth, const char *name);
+    bool DecodeEntry(autogen::ItemType *item);
+    bool DecodeNlri(autogen::ItemType *item);
+    bool DecodeNextHop(autogen::NextHopType *nexthop);
+    bool DecodeMobility(autogen::ItemType *item);
+    bool DecodeLoadBalance(autogen::LoadBalanceType *load_balance);
+    template <typename NumberType> bool ReadNumber(NumberType *value);
+    template <typename NumberType>
+    bool ReadNumberList(const char *name, std::vector<NumberType> *list);
+    bool ReadString(std::string *value);
+    bool ReadStringList(const char *name, std::vector<std::string> *list);
+
+    XmlPullParser parser_;
+    size_t items_depth_;
+    int af_;
+    int safi_;
+    const char *vrf_name_;
+    const char *node_;
+    const char *id_;
+    const char *error_;
+
+    DISALLOW_COPY_AND_ASSIGN(ControllerInetItemDecoder);
+};
+
+#endif // __CONTROLLER_ITEM_DECODER_H__
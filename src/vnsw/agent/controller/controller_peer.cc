@@ -14,6 +14,7 @@
 #include "controller/controller_vrf_export.h"
 #include "controller/controller_init.h"
 #include "controller/controller_ifmap.h"
+#include "controller/controller_item_decoder.h"
 #include "oper/operdb_init.h"
 #include "oper/vrf.h"
 #include "oper/nexthop.h"
@@ -35,6 +36,7 @@
 #include "ifmap/ifmap_agent_table.h"
 #include "controller/controller_types.h"
 #include <assert.h>
+#include <list>
 
 using namespace boost::asio;
 using namespace autogen;
@@ -137,9 +139,8 @@ void AgentXmppChannel::RegisterXmppChannel(XmppChannel *channel) {
 
     channel_ = channel;
     channel_str_ = channel_->ToString();
-    channel->RegisterReceive(xmps::BGP,
-                              boost::bind(&AgentXmppChannel::ReceiveInternal,
-                                          this, _1));
+    channel->RegisterStanzaReceive(xmps::BGP,
+        boost::bind(&AgentXmppChannel::ReceiveInternal, this, _1, _3));
 }
 
 std::string AgentXmppChannel::GetBgpPeerName() const {
@@ -583,16 +584,41 @@ void AgentXmppChannel::ReceiveMvpnUpdate(XmlPugi *pugi) {
     }
 }
 
-void AgentXmppChannel::ReceiveV4V6Update(XmlPugi *pugi) {
+// An item or retract of an inet route update, decoded before the update is
+// applied.
+struct InetRouteUpdate {
+    InetRouteUpdate() : prefix_len(0), retract(false) { }
+    IpAddress prefix_addr;
+    int prefix_len;
+    bool retract;
+    ItemType item;
+};
+
+//
+// Inet and inet6 route updates are decoded from the stanza without a DOM.
+// All items are decoded before any of them is applied, so that a malformed
+// update is dropped as a whole, as it was by the generated parser. The
+// requests for remote routes and deletes are then enqueued to the route
+// table in batches of kRouteReqBatch.
+//
+void AgentXmppChannel::ReceiveInetUpdate(std::string *stanza) {
+    if (agent_->stats())
+        agent_->stats()->incr_xmpp_in_msgs(xs_idx_);
 
-    pugi::xml_node node = pugi->FindNode("items");
-    pugi::xml_attribute attr = node.attribute("node");
+    ControllerInetItemDecoder decoder(&(*stanza)[0], stanza->size());
+    if (!decoder.ReadItems()) {
+        CONTROLLER_TRACE(Trace, GetBgpPeerName(), "",
+                         std::string("Xml Parsing Failed: ") + decoder.error());
+        return;
+    }
+    const char *vrf_name = decoder.vrf_name();
 
-    const char *af = NULL;
-    char *saveptr;
-    af = strtok_r(const_cast<char *>(attr.value()), "/", &saveptr);
-    strtok_r(NULL, "/", &saveptr);
-    char *vrf_name =  strtok_r(NULL, "", &saveptr);
+    // No BGP peer
+    if (bgp_peer_id() == NULL) {
+        CONTROLLER_TRACE (Trace, GetBgpPeerName(), vrf_name,
+                          "BGP peer not present, agentxmppchannel is inactive");
+        return;
+    }
 
     VrfKey vrf_key(vrf_name);
     VrfEntry *vrf =
@@ -605,9 +631,9 @@ void AgentXmppChannel::ReceiveV4V6Update(XmlPugi *pugi) {
     }
 
     InetUnicastAgentRouteTable *rt_table = NULL;
-    if (atoi(af) == BgpAf::IPv4) {
+    if (decoder.af() == BgpAf::IPv4) {
         rt_table = vrf->GetInet4UnicastRouteTable();
-    } else if (atoi(af) == BgpAf::IPv6) {
+    } else if (decoder.af() == BgpAf::IPv6) {
         rt_table = vrf->GetInet6UnicastRouteTable();
     }
 
@@ -617,92 +643,62 @@ void AgentXmppChannel::ReceiveV4V6Update(XmlPugi *pugi) {
         return;
     }
 
-    if (!pugi->IsNull(node)) {
-
-        pugi::xml_node node_check = pugi->FindNode("retract");
-        if (!pugi->IsNull(node_check)) {
-            for (node = node.first_child(); node; node = node.next_sibling()) {
-                if (strcmp(node.name(), "retract") == 0)  {
-                    std::string id = node.first_attribute().value();
-                    CONTROLLER_INFO_TRACE(Trace, GetBgpPeerName(), vrf_name,
-                                                "Delete Node id:" + id);
-
-                    boost::system::error_code ec;
-                    int prefix_len;
-                    if (atoi(af) == BgpAf::IPv4) {
-                        Ip4Address prefix_addr;
-                        ec = Ip4PrefixParse(id, &prefix_addr, &prefix_len);
-                        if (ec.value() != 0) {
-                            CONTROLLER_TRACE(Trace, GetBgpPeerName(), vrf_name,
-                                    "Error parsing v4 prefix for delete");
-                            return;
-                        }
-
-                        rt_table->DeleteReq(bgp_peer_id(), vrf_name,
-                                            prefix_addr, prefix_len,
-                                            new ControllerVmRoute(bgp_peer_id()));
-
-                    } else if (atoi(af) == BgpAf::IPv6) {
-                        Ip6Address prefix_addr;
-                        ec = Inet6PrefixParse(id, &prefix_addr, &prefix_len);
-                        if (ec.value() != 0) {
-                            CONTROLLER_TRACE(Trace, GetBgpPeerName(), vrf_name,
-                                    "Error parsing v6 prefix for delete");
-                            return;
-                        }
-                        rt_table->DeleteReq(bgp_peer_id(), vrf_name,
-                                            prefix_addr, prefix_len,
-                                            new ControllerVmRoute(bgp_peer_id()));
-                    }
-                }
-            }
+    std::list<InetRouteUpdate> updates;
+    while (true) {
+        updates.push_back(InetRouteUpdate());
+        InetRouteUpdate &update = updates.back();
+        ControllerInetItemDecoder::Event event = decoder.Next(&update.item);
+        if (event == ControllerInetItemDecoder::END) {
+            updates.pop_back();
+            break;
+        }
+        if (event == ControllerInetItemDecoder::DECODE_ERROR) {
+            CONTROLLER_TRACE(Trace, GetBgpPeerName(), vrf_name,
+                std::string("Xml Parsing Failed: ") + decoder.error());
             return;
         }
 
-        //Call Auto-generated Code to return struct
-        auto_ptr<AutogenProperty> xparser(new AutogenProperty());
-        if (ItemsType::XmlParseProperty(node, &xparser) == false) {
+        std::string prefix;
+        if (event == ControllerInetItemDecoder::RETRACT) {
+            update.retract = true;
+            prefix = decoder.id();
+            CONTROLLER_INFO_TRACE(Trace, GetBgpPeerName(), vrf_name,
+                                  "Delete Node id:" + prefix);
+        } else {
+            prefix = update.item.entry.nlri.address;
+        }
+
+        boost::system::error_code ec;
+        if (decoder.af() == BgpAf::IPv4) {
+            Ip4Address addr;
+            ec = Ip4PrefixParse(prefix, &addr, &update.prefix_len);
+            update.prefix_addr = addr;
+        } else {
+            Ip6Address addr;
+            ec = Inet6PrefixParse(prefix, &addr, &update.prefix_len);
+            update.prefix_addr = addr;
+        }
+        if (ec.value() != 0) {
             CONTROLLER_TRACE(Trace, GetBgpPeerName(), vrf_name,
-                             "Xml Parsing Failed");
+                             "Error parsing route prefix " + prefix);
             return;
         }
-        ItemsType *items;
-        ItemType *item;
-
-        items = (static_cast<ItemsType *>(xparser.get()));
-        for (vector<ItemType>::iterator iter =items->item.begin();
-                                        iter != items->item.end();
-                                        ++iter) {
-            item = &*iter;
-            boost::system::error_code ec;
-            int prefix_len;
-
-            if (atoi(af) == BgpAf::IPv4) {
-                Ip4Address prefix_addr;
-                ec = Ip4PrefixParse(item->entry.nlri.address, &prefix_addr,
-                                    &prefix_len);
-                if (ec.value() != 0) {
-                    CONTROLLER_TRACE(Trace, GetBgpPeerName(), vrf_name,
-                            "Error parsing v4 route address");
-                    return;
-                }
-                AddRoute(vrf_name, prefix_addr, prefix_len, item);
-            } else if (atoi(af) == BgpAf::IPv6) {
-                Ip6Address prefix_addr;
-                ec = Inet6PrefixParse(item->entry.nlri.address, &prefix_addr,
-                                      &prefix_len);
-                if (ec.value() != 0) {
-                    CONTROLLER_TRACE(Trace, GetBgpPeerName(), vrf_name,
-                            "Error parsing v6 route address");
-                    return;
-                }
-                AddRoute(vrf_name, prefix_addr, prefix_len, item);
-            } else {
-                CONTROLLER_TRACE(Trace, GetBgpPeerName(), vrf_name,
-                                 "Error updating route, Unknown IP family");
-            }
+    }
+
+    for (std::list<InetRouteUpdate>::iterator it = updates.begin();
+         it != updates.end(); ++it) {
+        if (it->retract) {
+            InetUnicastAgentRouteTable::DeleteReq(bgp_peer_id(), vrf_name,
+                it->prefix_addr, it->prefix_len,
+                new ControllerVmRoute(bgp_peer_id()), &route_reqs_);
+        } else {
+            AddRoute(vrf_name, it->prefix_addr, it->prefix_len, &it->item);
+        }
+        if (route_reqs_.size() >= kRouteReqBatch) {
+            InetUnicastAgentRouteTable::EnqueueReqList(&route_reqs_);
         }
     }
+    InetUnicastAgentRouteTable::EnqueueReqList(&route_reqs_);
 }
 
 template <typename TYPE>
@@ -1118,6 +1114,7 @@ void AgentXmppChannel::AddRemoteRoute(string vrf_name, IpAddress prefix_addr,
     if (item->entry.next_hops.next_hop[0].label ==
             MplsTable::kInvalidExportLabel &&
         vrf_name == agent_->fabric_vrf_name() && prefix_addr.is_v4()) {
+        InetUnicastAgentRouteTable::EnqueueReqList(&route_reqs_);
         AddFabricVrfRoute(prefix_addr.to_v4(), prefix_len, addr.to_v4(),
                           vn_list,
                           item->entry.security_group_list.security_group,
@@ -1155,10 +1152,12 @@ void AgentXmppChannel::AddRemoteRoute(string vrf_name, IpAddress prefix_addr,
                                path_preference, false, ecmp_load_balance,
                                false);
         rt_table->AddRemoteVmRouteReq(bgp_peer_id(), vrf_name, prefix_addr,
-                                      prefix_len, data);
+                                      prefix_len, data, &route_reqs_);
         return;
     }
 
+    // Local routes are not batched, enqueue the pending requests first.
+    InetUnicastAgentRouteTable::EnqueueReqList(&route_reqs_);
     bool native_encap = false;
     if (encap & TunnelType::NativeType()) {
         native_encap = true;
@@ -1302,17 +1301,48 @@ void AgentXmppChannel::AddRoute(string vrf_name, IpAddress prefix_addr,
     VnListType vn_list;
     GetVnList(item->entry.next_hops.next_hop, &vn_list);
     if (IsEcmp(item->entry.next_hops.next_hop)) {
+        // Requests that are not batched must not overtake the batched ones.
+        InetUnicastAgentRouteTable::EnqueueReqList(&route_reqs_);
         AddInetEcmpRoute(vrf_name, prefix_addr, prefix_len, item, vn_list);
     } else {
         AddRemoteRoute(vrf_name, prefix_addr, prefix_len, item, vn_list);
     }
 }
 
-void AgentXmppChannel::ReceiveUpdate(const XmppStanza::XmppMessage *msg) {
+// Inet and inet6 route updates are decoded from the stanza by
+// ReceiveInetUpdate, without a copy of the DOM.
+static bool IsInetUpdate(XmlPugi *pugi) {
+    pugi::xml_node node = pugi->FindNode("items");
+    if (pugi->IsNull(node))
+        return false;
+    const char *safi = strchr(node.attribute("node").value(), '/');
+    return safi != NULL && atoi(safi + 1) == BgpAf::Unicast;
+}
+
+void AgentXmppChannel::ReceiveUpdate(const XmppStanza::XmppMessage *msg,
+                                     std::string *stanza) {
     if (msg && msg->type == XmppStanza::MESSAGE_STANZA) {
+        XmlPugi *msg_pugi = reinterpret_cast<XmlPugi *>(msg->dom.get());
+        if (IsInetUpdate(msg_pugi)) {
+            // The stanza is handed over by the channel, it is only missing
+            // if the channel isn't configured to keep it.
+            boost::shared_ptr<ControllerXmppData> data;
+            if (stanza && !stanza->empty()) {
+                data.reset(new ControllerXmppData(xmps::BGP, xs_idx_,
+                                                  stanza));
+            } else {
+                std::ostringstream oss;
+                msg_pugi->PrintDoc(oss);
+                std::string doc(oss.str());
+                data.reset(new ControllerXmppData(xmps::BGP, xs_idx_,
+                                                  &doc));
+            }
+            agent_->controller()->Enqueue(data);
+            return;
+        }
+
         auto_ptr<XmlBase> impl(XmppXmlImplFactory::Instance()->GetXmlImpl());
         XmlPugi *pugi = reinterpret_cast<XmlPugi *>(impl.get());
-        XmlPugi *msg_pugi = reinterpret_cast<XmlPugi *>(msg->dom.get());
         pugi->LoadXmlDoc(msg_pugi->doc());
         boost::shared_ptr<ControllerXmppData> data(new ControllerXmppData(xmps::BGP,
                                                                           xmps::UNKNOWN,
@@ -1369,16 +1399,13 @@ void AgentXmppChannel::ReceiveBgpMessage(std::auto_ptr<XmlBase> impl) {
         ReceiveEvpnUpdate(pugi);
         return;
     }
-    if (atoi(safi) == BgpAf::Unicast) {
-        ReceiveV4V6Update(pugi);
-        return;
-    }
     CONTROLLER_TRACE (Trace, GetBgpPeerName(), vrf_name,
                       "Error Route update, Unknown Address Family or safi");
 }
 
-void AgentXmppChannel::ReceiveInternal(const XmppStanza::XmppMessage *msg) {
-    ReceiveUpdate(msg);
+void AgentXmppChannel::ReceiveInternal(const XmppStanza::XmppMessage *msg,
+                                       std::string *stanza) {
+    ReceiveUpdate(msg, stanza);
 }
 
 std::string AgentXmppChannel::ToString() const {
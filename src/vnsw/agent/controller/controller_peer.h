@@ -16,6 +16,7 @@
 #include <xmpp_enet_types.h>
 #include <xmpp_unicast_types.h>
 #include <cmn/agent.h>
+#include <db/db_table.h>
 #include <oper/peer.h>
 
 class AgentRoute;
@@ -34,6 +35,9 @@ class ControllerEcmpRoute;
 
 class AgentXmppChannel {
 public:
+    // Number of route requests enqueued to the route table together.
+    static const size_t kRouteReqBatch = 64;
+
     AgentXmppChannel(Agent *agent,
                      const std::string &xmpp_server,
                      const std::string &label_range, uint8_t xs_idx);
@@ -41,13 +45,14 @@ public:
 
     virtual std::string ToString() const;
     virtual bool SendUpdate(uint8_t *msg, size_t msgsize);
-    virtual void ReceiveUpdate(const XmppStanza::XmppMessage *msg);
+    virtual void ReceiveUpdate(const XmppStanza::XmppMessage *msg,
+                               std::string *stanza);
     virtual void ReceiveEvpnUpdate(XmlPugi *pugi);
     virtual void ReceiveMulticastUpdate(XmlPugi *pugi);
     virtual void ReceiveMvpnUpdate(XmlPugi *pugi);
-    virtual void ReceiveV4V6Update(XmlPugi *pugi);
     XmppChannel *GetXmppChannel() { return channel_; }
     void ReceiveBgpMessage(std::auto_ptr<XmlBase> impl);
+    void ReceiveInetUpdate(std::string *stanza);
 
     //Helper to identify if specified peer has active BGP peer attached
     static bool IsXmppChannelActive(const Agent *agent, AgentXmppChannel *peer);
@@ -203,7 +208,8 @@ private:
     void PeerIsNotConfig();
     InetUnicastAgentRouteTable *PrefixToRouteTable(const std::string &vrf_name,
                                                    const IpAddress &prefix_addr);
-    void ReceiveInternal(const XmppStanza::XmppMessage *msg);
+    void ReceiveInternal(const XmppStanza::XmppMessage *msg,
+                         std::string *stanza);
     void AddRoute(std::string vrf_name, IpAddress ip, uint32_t plen,
                   autogen::ItemType *item);
     void AddMulticastEvpnRoute(const std::string &vrf_name,
@@ -282,6 +288,8 @@ private:
     boost::scoped_ptr<EndOfRibRxTimer> end_of_rib_rx_timer_;
     boost::scoped_ptr<LlgrStaleTimer> llgr_stale_timer_;
     Agent *agent_;
+    // Route requests of the update being processed, see ReceiveInetUpdate.
+    DBRequestList route_reqs_;
 };
 
 #endif // __CONTROLLER_PEER_H__
@@ -2,6 +2,7 @@
  * Copyright (c) 2013 Juniper Networks, Inc. All rights reserved.
  */
 
+#include <algorithm>
 #include <vector>
 #include <boost/uuid/uuid_io.hpp>
 
@@ -116,6 +117,8 @@ DBEntry *AclTable::OperDBAdd(const DBRequest *req) {
          ++it) {
         acl->AddAclEntry(*it, acl->acl_entries_);
     }
+    acl->UpdateClassifier();
+    acl->SetRulesChanged(0);
 
     AclSandeshData sandesh_data;
     acl->SetAclSandeshData(sandesh_data);
@@ -135,6 +138,9 @@ bool AclTable::OperDBOnChange(DBEntry *entry, const DBRequest *req) {
 
     if (qos_config_data != NULL) {
         changed = acl->ResyncQosConfigEntries();
+        if (changed) {
+            acl->SetRulesChanged(0);
+        }
         if (acl->IsQosConfigResolved() == false) {
             AddUnresolvedEntry(acl);
         }
@@ -146,10 +152,14 @@ bool AclTable::OperDBOnChange(DBEntry *entry, const DBRequest *req) {
     }
 
     if (data->ace_id_to_del_) {
+        uint32_t index = acl->RuleIndex(AclEntryID(data->ace_id_to_del_));
         acl->DeleteAclEntry(data->ace_id_to_del_);
+        acl->SetRulesChanged(index);
         return true;
     }
 
+    // Index of the first rule changed
+    uint32_t index = acl->Size();
     AclDBEntry::AclEntries entries;
     std::vector<AclEntrySpec>::iterator it;
     std::vector<AclEntrySpec> *acl_spec_ptr = &(data->acl_spec_.acl_entry_specs_);
@@ -159,6 +169,7 @@ bool AclTable::OperDBOnChange(DBEntry *entry, const DBRequest *req) {
             acl->AddAclEntry(*it, entries);
         } else { // Add to the existing entries
             if (acl->AddAclEntry(*it, acl->acl_entries_)) {
+                index = std::min(index, acl->RuleIndex(it->id));
                 changed = true;
             }
         }
@@ -168,6 +179,7 @@ bool AclTable::OperDBOnChange(DBEntry *entry, const DBRequest *req) {
     // entries
     if (!data->ace_add) {
         if (acl->Changed(entries)) {
+            index = acl->CommonPrefixSize(entries);
             //Delete All acl entries for now and set newly created one.
             acl->DeleteAllAclEntries();
             acl->SetAclEntries(entries);
@@ -175,7 +187,10 @@ bool AclTable::OperDBOnChange(DBEntry *entry, const DBRequest *req) {
         }
     }
 
-    if (changed == false) {
+    if (changed) {
+        acl->UpdateClassifier();
+        acl->SetRulesChanged(index);
+    } else {
         //Remove temporary create acl entries
         AclDBEntry::AclEntries::iterator iter;
         iter = entries.begin();
@@ -694,6 +709,17 @@ void AclDBEntry::SetAclEntries(AclEntries &entries)
     }
 }
 
+void AclDBEntry::UpdateClassifier()
+{
+    AclClassifier::RuleList rules;
+    rules.reserve(acl_entries_.size());
+    AclEntries::const_iterator it;
+    for (it = acl_entries_.begin(); it != acl_entries_.end(); ++it) {
+        rules.push_back(it.operator->());
+    }
+    classifier_.Build(rules);
+}
+
 bool AclDBEntry::IsQosConfigResolved() {
     AclEntries::iterator it;
     it = acl_entries_.begin();
@@ -772,6 +798,7 @@ bool AclDBEntry::DeleteAclEntry(const uint32_t acl_entry_id)
         if (ace_id == iter->id()) {
             AclEntry *ae = iter.operator->();
             acl_entries_.erase(acl_entries_.iterator_to(*iter));
+            classifier_.Remove(ae);
             ACL_TRACE(Info, "acl entry " + integerToString(acl_entry_id) + " deleted");
             delete ae;
             return true;
@@ -783,6 +810,7 @@ bool AclDBEntry::DeleteAclEntry(const uint32_t acl_entry_id)
 
 void AclDBEntry::DeleteAllAclEntries()
 {
+    classifier_.Clear();
     AclEntries::iterator iter;
     iter = acl_entries_.begin();
     while (iter != acl_entries_.end()) {
@@ -793,84 +821,116 @@ void AclDBEntry::DeleteAllAclEntries()
     return;
 }
 
+bool AclDBEntry::EntryMatch(const AclEntry *entry,
+                            const PacketHeader &packet_header,
+                            MatchAclParams &m_acl, FlowPolicyInfo *info) const
+{
+    const AclEntry::ActionList &al = entry->PacketMatch(packet_header, info);
+    AclEntry::ActionList::const_iterator al_it;
+    for (al_it = al.begin(); al_it != al.end(); ++al_it) {
+        TrafficAction *ta = static_cast<TrafficAction *>(*al_it.operator->());
+        m_acl.action_info.action |= 1 << ta->action();
+        if (ta->action_type() == TrafficAction::MIRROR_ACTION) {
+            MirrorAction *a = static_cast<MirrorAction *>(*al_it.operator->());
+            MirrorActionSpec as;
+            as.ip = a->GetIp();
+            as.port = a->GetPort();
+            as.vrf_name = a->vrf_name();
+            as.analyzer_name = a->GetAnalyzerName();
+            as.encap = a->GetEncap();
+            m_acl.action_info.mirror_l.push_back(as);
+        }
+        if (ta->action_type() == TrafficAction::VRF_TRANSLATE_ACTION) {
+            const VrfTranslateAction *a =
+                static_cast<VrfTranslateAction *>(*al_it.operator->());
+            VrfTranslateActionSpec vrf_translate_action(a->vrf_name(),
+                                                        a->ignore_acl());
+            m_acl.action_info.vrf_translate_action_ = vrf_translate_action;
+        }
+        if (ta->action_type() == TrafficAction::QOS_ACTION) {
+            const QosConfigAction *a =
+                static_cast<const QosConfigAction *>(*al_it.operator->());
+            if (a->qos_config_ref() != NULL) {
+                QosConfigActionSpec qos_action_spec(a->name());
+                if (a->qos_config_ref() &&
+                    a->qos_config_ref()->IsDeleted() == false) {
+                    qos_action_spec.set_id(a->qos_config_ref()->id());
+                    m_acl.action_info.qos_config_action_ = qos_action_spec;
+                }
+            }
+        }
+
+        if (info && ta->IsDrop()) {
+            if (!info->drop) {
+                info->drop = true;
+                info->terminal = false;
+                info->other = false;
+                info->uuid = entry->uuid();
+                info->acl_name = GetName();
+            }
+        }
+    }
+
+    if (al.empty()) {
+        return false;
+    }
+
+    m_acl.ace_id_list.push_back(entry->id());
+    if (entry->IsTerminal()) {
+        m_acl.terminal_rule = true;
+        /* Set uuid only if it is NOT already set as
+         * drop/terminal uuid */
+        if (info && !info->drop && !info->terminal) {
+            info->terminal = true;
+            info->other = false;
+            info->uuid = entry->uuid();
+            info->acl_name = GetName();
+        }
+        return true;
+    }
+    /* If the ace action is not drop and if ace is not terminal rule
+     * then set the uuid with the first matching uuid */
+    if (info && !info->drop && !info->terminal && !info->other) {
+        info->other = true;
+        info->uuid = entry->uuid();
+        info->acl_name = GetName();
+    }
+    return true;
+}
+
 bool AclDBEntry::PacketMatch(const PacketHeader &packet_header,
                              MatchAclParams &m_acl, FlowPolicyInfo *info) const
 {
-    AclEntries::const_iterator iter;
     bool ret_val = false;
     m_acl.terminal_rule = false;
     m_acl.action_info.action = 0;
 
+    // Evaluate only the rules picked by the classifier, in rule order
+    if (classifier_.enabled()) {
+        AclRuleBitmap candidates;
+        classifier_.Classify(packet_header, info != NULL, &candidates);
+        for (uint32_t i = AclClassifier::FindFirst(candidates);
+             i < classifier_.rule_count();
+             i = AclClassifier::FindNext(candidates, i)) {
+            if (EntryMatch(classifier_.rule(i), packet_header, m_acl, info)) {
+                ret_val = true;
+                if (m_acl.terminal_rule) {
+                    return ret_val;
+                }
+            }
+        }
+        return ret_val;
+    }
+
+    AclEntries::const_iterator iter;
     for (iter = acl_entries_.begin();
          iter != acl_entries_.end();
          ++iter) {
-        const AclEntry::ActionList &al = iter->PacketMatch(packet_header, info);
-    AclEntry::ActionList::const_iterator al_it;
-    for (al_it = al.begin(); al_it != al.end(); ++al_it) {
-         TrafficAction *ta = static_cast<TrafficAction *>(*al_it.operator->());
-         m_acl.action_info.action |= 1 << ta->action();
-         if (ta->action_type() == TrafficAction::MIRROR_ACTION) {
-             MirrorAction *a = static_cast<MirrorAction *>(*al_it.operator->());
-                 MirrorActionSpec as;
-         as.ip = a->GetIp();
-         as.port = a->GetPort();
-                 as.vrf_name = a->vrf_name();
-                 as.analyzer_name = a->GetAnalyzerName();
-                 as.encap = a->GetEncap();
-                 m_acl.action_info.mirror_l.push_back(as);
-         }
-         if (ta->action_type() == TrafficAction::VRF_TRANSLATE_ACTION) {
-             const VrfTranslateAction *a =
-                 static_cast<VrfTranslateAction *>(*al_it.operator->());
-             VrfTranslateActionSpec vrf_translate_action(a->vrf_name(),
-                                                         a->ignore_acl());
-             m_acl.action_info.vrf_translate_action_ = vrf_translate_action;
-         }
-         if (ta->action_type() == TrafficAction::QOS_ACTION) {
-             const QosConfigAction *a =
-                 static_cast<const QosConfigAction *>(*al_it.operator->());
-             if (a->qos_config_ref() != NULL) {
-                 QosConfigActionSpec qos_action_spec(a->name());
-                 if (a->qos_config_ref() &&
-                     a->qos_config_ref()->IsDeleted() == false) {
-                     qos_action_spec.set_id(a->qos_config_ref()->id());
-                     m_acl.action_info.qos_config_action_ = qos_action_spec;
-                 }
-             }
-         }
-
-         if (info && ta->IsDrop()) {
-             if (!info->drop) {
-                 info->drop = true;
-                 info->terminal = false;
-                 info->other = false;
-                 info->uuid = iter->uuid();
-                 info->acl_name = GetName();
-             }
-         }
-    }
-        if (!(al.empty())) {
+        if (EntryMatch(iter.operator->(), packet_header, m_acl, info)) {
             ret_val = true;
-            m_acl.ace_id_list.push_back(iter->id());
-            if (iter->IsTerminal()) {
-                m_acl.terminal_rule = true;
-                /* Set uuid only if it is NOT already set as
-                 * drop/terminal uuid */
-                if (info && !info->drop && !info->terminal) {
-                    info->terminal = true;
-                    info->other = false;
-                    info->uuid = iter->uuid();
-                    info->acl_name = GetName();
-                }
+            if (m_acl.terminal_rule) {
                 return ret_val;
             }
-            /* If the ace action is not drop and if ace is not terminal rule
-             * then set the uuid with the first matching uuid */
-            if (info && !info->drop && !info->terminal && !info->other) {
-                info->other = true;
-                info->uuid = iter->uuid();
-                info->acl_name = GetName();
-            }
         }
     }
     return ret_val;
@@ -910,6 +970,63 @@ bool AclDBEntry::Changed(const AclEntries &new_entries) const {
     return true;
 }
 
+uint32_t AclDBEntry::CommonPrefixSize(const AclEntries &new_entries) const {
+    uint32_t size = 0;
+    AclEntries::const_iterator it = acl_entries_.begin();
+    AclEntries::const_iterator new_entries_it = new_entries.begin();
+    while (it != acl_entries_.end() &&
+           new_entries_it != new_entries.end() && *it == *new_entries_it) {
+        it++;
+        new_entries_it++;
+        size++;
+    }
+    return size;
+}
+
+// Returns Size() if the rule is not present
+uint32_t AclDBEntry::RuleIndex(const AclEntryID &id) const {
+    uint32_t index = 0;
+    AclEntries::const_iterator it = acl_entries_.begin();
+    while (it != acl_entries_.end() && !(it->id() == id)) {
+        it++;
+        index++;
+    }
+    return index;
+}
+
+// Rules before index retain their generation, rest of the rules get the
+// new generation. Ids of deleted rules are removed from the map, they are
+// treated as changed by GetUnchangedAces
+void AclDBEntry::SetRulesChanged(uint32_t index) {
+    change_gen_++;
+    AceChangeGenMap gen_map;
+    uint32_t i = 0;
+    AclEntries::const_iterator it = acl_entries_.begin();
+    for (; it != acl_entries_.end(); it++, i++) {
+        uint32_t gen = change_gen_;
+        if (i < index) {
+            AceChangeGenMap::const_iterator old_it =
+                ace_change_gen_.find(it->id().id_);
+            if (old_it != ace_change_gen_.end()) {
+                gen = old_it->second;
+            }
+        }
+        // Forward and derived rules share the id
+        uint32_t &value = gen_map[it->id().id_];
+        value = std::max(value, gen);
+    }
+    ace_change_gen_.swap(gen_map);
+}
+
+void AclDBEntry::GetUnchangedAces(uint32_t gen, AceIdSet *ace_id_set) const {
+    AceChangeGenMap::const_iterator it = ace_change_gen_.begin();
+    for (; it != ace_change_gen_.end(); it++) {
+        if (it->second <= gen) {
+            ace_id_set->insert(ace_id_set->end(), it->first);
+        }
+    }
+}
+
 const AclDBEntry* AclTable::GetAclDBEntry(const string acl_uuid_str,
                                           const string ctx,
                                           SandeshResponse *resp) {
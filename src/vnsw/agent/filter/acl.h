@@ -5,6 +5,8 @@
 #ifndef __AGENT_ACL_N_H__
 #define __AGENT_ACL_N_H__
 
+#include <map>
+#include <set>
 #include <boost/intrusive/list.hpp>
 #include <boost/uuid/uuid.hpp>
 #include <boost/intrusive_ptr.hpp>
@@ -15,6 +17,7 @@
 #include <filter/acl_entry_match.h>
 #include <filter/acl_entry_spec.h>
 #include <filter/acl_entry.h>
+#include <filter/acl_classifier.h>
 #include <filter/packet_header.h>
 
 struct FlowKey;
@@ -97,9 +100,11 @@ public:
             boost::intrusive::list_member_hook<>,
             &AclEntry::acl_list_node> AclEntryNode;
     typedef boost::intrusive::list<AclEntry, AclEntryNode> AclEntries;
+    typedef std::map<std::string, uint32_t> AceChangeGenMap;
+    typedef std::set<std::string> AceIdSet;
 
     AclDBEntry(const uuid &id) :
-        AgentOperDBEntry(), uuid_(id), dynamic_acl_(false) {
+        AgentOperDBEntry(), uuid_(id), dynamic_acl_(false), change_gen_(0) {
     }
     ~AclDBEntry() {
     }
@@ -124,6 +129,9 @@ public:
     void DeleteAllAclEntries();
     uint32_t Size() const {return acl_entries_.size();};
     void SetAclEntries(AclEntries &entries);
+    // Compile ACL entries after they are modified
+    void UpdateClassifier();
+    const AclClassifier &classifier() const { return classifier_; }
     void SetDynamicAcl(bool dyn) {dynamic_acl_ = dyn;};
     bool GetDynamicAcl () const {return dynamic_acl_;};
 
@@ -131,6 +139,18 @@ public:
     bool PacketMatch(const PacketHeader &packet_header, MatchAclParams &m_acl,
                      FlowPolicyInfo *info) const;
     bool Changed(const AclEntries &new_acl_entries) const;
+    // Number of leading entries same in both the lists
+    uint32_t CommonPrefixSize(const AclEntries &new_acl_entries) const;
+    uint32_t RuleIndex(const AclEntryID &id) const;
+
+    // Rules are evaluated in order till a terminal rule matches. A change
+    // in rules at and after index can only change the result for packets
+    // which did not match a terminal rule before index. Each ace id is
+    // tagged with the generation of the last change affecting it.
+    void SetRulesChanged(uint32_t index);
+    uint32_t change_gen() const { return change_gen_; }
+    // Ace ids not affected by any change after generation gen
+    void GetUnchangedAces(uint32_t gen, AceIdSet *ace_id_set) const;
     uint32_t ace_count() const { return acl_entries_.size();}
     bool IsRulePresent(const std::string &uuid) const;
     bool ResyncQosConfigEntries();
@@ -139,10 +159,17 @@ public:
     const AclEntry* GetAclEntryAtIndex(uint32_t) const;
 private:
     friend class AclTable;
+    // Apply actions of entry if it matches. Returns true if entry matched
+    bool EntryMatch(const AclEntry *entry, const PacketHeader &packet_header,
+                    MatchAclParams &m_acl, FlowPolicyInfo *info) const;
+
     uuid uuid_;
     bool dynamic_acl_;
     std::string name_;
     AclEntries acl_entries_;
+    AclClassifier classifier_;
+    uint32_t change_gen_;
+    AceChangeGenMap ace_change_gen_;
     DISALLOW_COPY_AND_ASSIGN(AclDBEntry);
 };
 
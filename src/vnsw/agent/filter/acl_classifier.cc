@@ -0,0 +1,359 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include <algorithm>
+
+#include <cmn/agent_cmn.h>
+
+#include <filter/acl_entry_match.h>
+#include <filter/acl_entry.h>
+#include <filter/packet_header.h>
+#include <filter/acl_classifier.h>
+
+static const uint32_t kBitsPerWord = 64;
+
+static inline uint32_t WordCount(uint32_t bits) {
+    return (bits + kBitsPerWord - 1) / kBitsPerWord;
+}
+
+static inline void SetBit(AclRuleBitmap *bitmap, uint32_t index) {
+    (*bitmap)[index / kBitsPerWord] |= (1ULL << (index % kBitsPerWord));
+}
+
+static inline void ResetBit(AclRuleBitmap *bitmap, uint32_t index) {
+    (*bitmap)[index / kBitsPerWord] &= ~(1ULL << (index % kBitsPerWord));
+}
+
+// Helpers to compute interval boundaries for each key type
+static inline bool IsMaxKey(uint16_t key) { return key == 0xFFFF; }
+static inline bool IsMaxKey(uint32_t key) { return key == 0xFFFFFFFF; }
+static inline bool IsMaxKey(const AclIp6Key &key) {
+    return key.upper == ~0ULL && key.lower == ~0ULL;
+}
+
+static inline uint16_t NextKey(uint16_t key) { return key + 1; }
+static inline uint32_t NextKey(uint32_t key) { return key + 1; }
+static inline AclIp6Key NextKey(const AclIp6Key &key) {
+    if (key.lower == ~0ULL)
+        return AclIp6Key(key.upper + 1, 0);
+    return AclIp6Key(key.upper, key.lower + 1);
+}
+
+static AclIp6Key Ip6ToKey(const Ip6Address &addr) {
+    Ip6Address::bytes_type bytes = addr.to_bytes();
+    uint64_t upper = 0;
+    uint64_t lower = 0;
+    for (int i = 0; i < 8; i++) {
+        upper = (upper << 8) | bytes[i];
+        lower = (lower << 8) | bytes[i + 8];
+    }
+    return AclIp6Key(upper, lower);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// AclIntervalTable routines
+/////////////////////////////////////////////////////////////////////////////
+template <typename Key>
+void AclIntervalTable<Key>::AddRange(uint32_t rule, const Key &min,
+                                     const Key &max) {
+    ranges_.push_back(RuleRange(rule, min, max));
+}
+
+template <typename Key>
+void AclIntervalTable<Key>::AddAny(uint32_t rule) {
+    any_.push_back(rule);
+}
+
+template <typename Key>
+void AclIntervalTable<Key>::Build(uint32_t rule_count) {
+    starts_.clear();
+    starts_.push_back(Key());
+    typename std::vector<RuleRange>::const_iterator it;
+    for (it = ranges_.begin(); it != ranges_.end(); ++it) {
+        starts_.push_back(it->min);
+        if (IsMaxKey(it->max) == false)
+            starts_.push_back(NextKey(it->max));
+    }
+    std::sort(starts_.begin(), starts_.end());
+    starts_.erase(std::unique(starts_.begin(), starts_.end()), starts_.end());
+
+    AclRuleBitmap empty(WordCount(rule_count), 0);
+    for (std::vector<uint32_t>::const_iterator any_it = any_.begin();
+         any_it != any_.end(); ++any_it) {
+        SetBit(&empty, *any_it);
+    }
+    bitmaps_.assign(starts_.size(), empty);
+
+    // Range boundaries are interval starts, so each range covers a
+    // contiguous run of intervals starting at its min
+    for (it = ranges_.begin(); it != ranges_.end(); ++it) {
+        size_t i = std::lower_bound(starts_.begin(), starts_.end(), it->min) -
+            starts_.begin();
+        while (i < starts_.size() && !(it->max < starts_[i])) {
+            SetBit(&bitmaps_[i], it->rule);
+            i++;
+        }
+    }
+
+    // Ranges are not needed once compiled
+    std::vector<RuleRange>().swap(ranges_);
+    std::vector<uint32_t>().swap(any_);
+}
+
+template <typename Key>
+void AclIntervalTable<Key>::Clear() {
+    std::vector<RuleRange>().swap(ranges_);
+    std::vector<uint32_t>().swap(any_);
+    std::vector<Key>().swap(starts_);
+    std::vector<AclRuleBitmap>().swap(bitmaps_);
+}
+
+template <typename Key>
+void AclIntervalTable<Key>::Filter(const Key &key,
+                                   AclRuleBitmap *result) const {
+    // First interval starts at the minimum key, so upper_bound never
+    // returns the first interval
+    size_t i = std::upper_bound(starts_.begin(), starts_.end(), key) -
+        starts_.begin() - 1;
+    const AclRuleBitmap &bitmap = bitmaps_[i];
+    for (size_t w = 0; w < result->size(); w++) {
+        (*result)[w] &= bitmap[w];
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// AclClassifier routines
+/////////////////////////////////////////////////////////////////////////////
+AclClassifier::AclClassifier() : enabled_(false) {
+}
+
+AclClassifier::~AclClassifier() {
+}
+
+void AclClassifier::Clear() {
+    enabled_ = false;
+    RuleList().swap(rules_);
+    AclRuleBitmap().swap(valid_);
+    AclRuleBitmap().swap(flow_policy_info_);
+    protocol_.Clear();
+    src_port_.Clear();
+    dst_port_.Clear();
+    src_ip4_.Clear();
+    dst_ip4_.Clear();
+    src_ip6_.Clear();
+    dst_ip6_.Clear();
+}
+
+void AclClassifier::AddRule(uint32_t index, const AclEntry *rule) {
+    bool protocol = false;
+    bool src_port = false;
+    bool dst_port = false;
+    bool src_ip = false;
+    bool dst_ip = false;
+
+    for (uint32_t i = 0; i < rule->match_count(); i++) {
+        const AclEntryMatch *match = rule->Get(i);
+        switch (match->type()) {
+        case AclEntryMatch::PROTOCOL_MATCH: {
+            const RangeSList &ranges =
+                static_cast<const ProtocolMatch *>(match)->protocol_ranges();
+            for (RangeSList::const_iterator it = ranges.begin();
+                 it != ranges.end(); ++it) {
+                protocol_.AddRange(index, it->min, it->max);
+            }
+            protocol = true;
+            break;
+        }
+
+        case AclEntryMatch::SOURCE_PORT_MATCH:
+        case AclEntryMatch::DESTINATION_PORT_MATCH: {
+            bool src = (match->type() == AclEntryMatch::SOURCE_PORT_MATCH);
+            AclIntervalTable<uint16_t> *table = src ? &src_port_ : &dst_port_;
+            const RangeSList &ranges =
+                static_cast<const PortMatch *>(match)->port_ranges();
+            for (RangeSList::const_iterator it = ranges.begin();
+                 it != ranges.end(); ++it) {
+                table->AddRange(index, it->min, it->max);
+            }
+            if (src) {
+                src_port = true;
+            } else {
+                dst_port = true;
+            }
+            break;
+        }
+
+        case AclEntryMatch::SERVICE_GROUP_MATCH: {
+            // Ports of a service group depend on the protocol, use only
+            // the protocols. A protocol match, if any, is used instead
+            if (protocol)
+                break;
+            const ServiceGroupMatch::ServicePortList &list =
+                static_cast<const ServiceGroupMatch *>(match)->
+                service_port_list();
+            ServiceGroupMatch::ServicePortList::const_iterator it;
+            for (it = list.begin(); it != list.end(); ++it) {
+                protocol_.AddRange(index, it->protocol.min, it->protocol.max);
+            }
+            protocol = true;
+            break;
+        }
+
+        case AclEntryMatch::ADDRESS_MATCH: {
+            const AddressMatch *addr = static_cast<const AddressMatch *>(match);
+            if (addr->policy_id_s() == "any")
+                break;
+            if (addr->addr_type() == AddressMatch::NETWORK_ID) {
+                SetBit(&flow_policy_info_, index);
+                break;
+            }
+            if (addr->addr_type() != AddressMatch::IP_ADDR ||
+                addr->ip_list().empty())
+                break;
+
+            bool src = addr->is_source();
+            std::vector<AclAddressInfo>::const_iterator it;
+            for (it = addr->ip_list().begin(); it != addr->ip_list().end();
+                 ++it) {
+                if (it->ip_addr.is_v4() && it->ip_mask.is_v4()) {
+                    uint32_t ip = it->ip_addr.to_v4().to_ulong();
+                    uint32_t mask = it->ip_mask.to_v4().to_ulong();
+                    uint32_t min = ip & mask;
+                    (src ? src_ip4_ : dst_ip4_).AddRange(index, min,
+                                                         min | ~mask);
+                } else if (it->ip_addr.is_v6() && it->ip_mask.is_v6()) {
+                    AclIp6Key ip = Ip6ToKey(it->ip_addr.to_v6());
+                    AclIp6Key mask = Ip6ToKey(it->ip_mask.to_v6());
+                    AclIp6Key min(ip.upper & mask.upper,
+                                  ip.lower & mask.lower);
+                    AclIp6Key max(min.upper | ~mask.upper,
+                                  min.lower | ~mask.lower);
+                    (src ? src_ip6_ : dst_ip6_).AddRange(index, min, max);
+                }
+            }
+            if (src) {
+                src_ip = true;
+            } else {
+                dst_ip = true;
+            }
+            break;
+        }
+
+        default:
+            break;
+        }
+    }
+
+    if (protocol == false)
+        protocol_.AddAny(index);
+    if (src_port == false)
+        src_port_.AddAny(index);
+    if (dst_port == false)
+        dst_port_.AddAny(index);
+    if (src_ip == false) {
+        src_ip4_.AddAny(index);
+        src_ip6_.AddAny(index);
+    }
+    if (dst_ip == false) {
+        dst_ip4_.AddAny(index);
+        dst_ip6_.AddAny(index);
+    }
+}
+
+void AclClassifier::Build(const RuleList &rules) {
+    Clear();
+    if (rules.size() < kMinRuleCount)
+        return;
+
+    rules_ = rules;
+    uint32_t count = rules_.size();
+    valid_.assign(WordCount(count), 0);
+    flow_policy_info_.assign(WordCount(count), 0);
+    for (uint32_t i = 0; i < count; i++) {
+        SetBit(&valid_, i);
+        AddRule(i, rules_[i]);
+    }
+
+    protocol_.Build(count);
+    src_port_.Build(count);
+    dst_port_.Build(count);
+    src_ip4_.Build(count);
+    dst_ip4_.Build(count);
+    src_ip6_.Build(count);
+    dst_ip6_.Build(count);
+    enabled_ = true;
+}
+
+void AclClassifier::Remove(const AclEntry *rule) {
+    if (enabled_ == false)
+        return;
+
+    RuleList::iterator it = std::find(rules_.begin(), rules_.end(), rule);
+    if (it == rules_.end())
+        return;
+
+    uint32_t index = it - rules_.begin();
+    *it = NULL;
+    ResetBit(&valid_, index);
+    ResetBit(&flow_policy_info_, index);
+}
+
+void AclClassifier::Classify(const PacketHeader &hdr, bool flow_policy_info,
+                             AclRuleBitmap *result) const {
+    *result = valid_;
+    protocol_.Filter(hdr.protocol, result);
+    // Port matches apply only to TCP and UDP
+    if (hdr.protocol == IPPROTO_TCP || hdr.protocol == IPPROTO_UDP) {
+        src_port_.Filter(hdr.src_port, result);
+        dst_port_.Filter(hdr.dst_port, result);
+    }
+
+    if (hdr.src_ip.is_v4()) {
+        src_ip4_.Filter(hdr.src_ip.to_v4().to_ulong(), result);
+    } else {
+        src_ip6_.Filter(Ip6ToKey(hdr.src_ip.to_v6()), result);
+    }
+
+    if (hdr.dst_ip.is_v4()) {
+        dst_ip4_.Filter(hdr.dst_ip.to_v4().to_ulong(), result);
+    } else {
+        dst_ip6_.Filter(Ip6ToKey(hdr.dst_ip.to_v6()), result);
+    }
+
+    if (flow_policy_info) {
+        for (size_t w = 0; w < result->size(); w++) {
+            (*result)[w] |= flow_policy_info_[w];
+        }
+    }
+}
+
+uint32_t AclClassifier::FindFirst(const AclRuleBitmap &bitmap) {
+    for (size_t w = 0; w < bitmap.size(); w++) {
+        if (bitmap[w])
+            return w * kBitsPerWord + __builtin_ctzll(bitmap[w]);
+    }
+    return bitmap.size() * kBitsPerWord;
+}
+
+uint32_t AclClassifier::FindNext(const AclRuleBitmap &bitmap,
+                                 uint32_t index) {
+    index++;
+    size_t w = index / kBitsPerWord;
+    if (w >= bitmap.size())
+        return bitmap.size() * kBitsPerWord;
+
+    uint64_t word = bitmap[w] & (~0ULL << (index % kBitsPerWord));
+    while (true) {
+        if (word)
+            return w * kBitsPerWord + __builtin_ctzll(word);
+        if (++w == bitmap.size())
+            break;
+        word = bitmap[w];
+    }
+    return bitmap.size() * kBitsPerWord;
+}
+
+template class AclIntervalTable<uint16_t>;
+template class AclIntervalTable<uint32_t>;
+template class AclIntervalTable<AclIp6Key>;
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#ifndef __AGENT_ACL_CLASSIFIER_H__
+#define __AGENT_ACL_CLASSIFIER_H__
+
+#include <stdint.h>
+#include <vector>
+
+#include <base/util.h>
+
+struct PacketHeader;
+class AclEntry;
+
+// Bitmap of rules in an ACL. Bit i stands for the i-th rule in ACL order
+typedef std::vector<uint64_t> AclRuleBitmap;
+
+// Set of disjoint intervals covering the whole key space. Each interval
+// holds the bitmap of rules whose ranges include it. Rules that do not
+// restrict the field are present in every interval
+template <typename Key>
+class AclIntervalTable {
+public:
+    AclIntervalTable() { }
+    ~AclIntervalTable() { }
+
+    void AddRange(uint32_t rule, const Key &min, const Key &max);
+    void AddAny(uint32_t rule);
+    void Build(uint32_t rule_count);
+    void Clear();
+    // Intersect result with rules matching key
+    void Filter(const Key &key, AclRuleBitmap *result) const;
+    uint32_t interval_count() const { return starts_.size(); }
+
+private:
+    struct RuleRange {
+        RuleRange(uint32_t r, const Key &lo, const Key &hi) :
+            rule(r), min(lo), max(hi) { }
+        uint32_t rule;
+        Key min;
+        Key max;
+    };
+
+    std::vector<RuleRange> ranges_;
+    std::vector<uint32_t> any_;
+    // Sorted start of each interval and the rules present in it
+    std::vector<Key> starts_;
+    std::vector<AclRuleBitmap> bitmaps_;
+    DISALLOW_COPY_AND_ASSIGN(AclIntervalTable);
+};
+
+// IPv6 address as a pair of 64 bit words for use as interval key
+struct AclIp6Key {
+    AclIp6Key() : upper(0), lower(0) { }
+    AclIp6Key(uint64_t u, uint64_t l) : upper(u), lower(l) { }
+    bool operator<(const AclIp6Key &rhs) const {
+        if (upper != rhs.upper)
+            return upper < rhs.upper;
+        return lower < rhs.lower;
+    }
+    bool operator==(const AclIp6Key &rhs) const {
+        return upper == rhs.upper && lower == rhs.lower;
+    }
+    uint64_t upper;
+    uint64_t lower;
+};
+
+////////////////////////////////////////////////////////////////////////////
+// Compiled form of the rules in an AclDBEntry.
+//
+// AclEntry::PacketMatch checks a packet against one rule at a time, so
+// finding the matching rules costs a walk over every rule in the ACL. The
+// classifier decomposes the rules into per-field interval tables for
+// protocol, source/destination port and source/destination IPv4/IPv6
+// address. Looking up each packet field gives the bitmap of rules that can
+// match the field, and intersecting the bitmaps gives the candidate rules.
+//
+// Match types that do not map to intervals (VN, SG, tags, address groups
+// and service groups) are treated as wildcards by the tables, so the
+// candidates are a superset of the matching rules. AclDBEntry runs the
+// regular AclEntry::PacketMatch on candidates in rule order, which keeps
+// the result identical to the linear walk.
+//
+// VN address matches update FlowPolicyInfo even when the rule does not
+// match. Rules with VN address matches are always returned as candidates
+// when FlowPolicyInfo is requested, to retain that behavior.
+//
+// Compiling is skipped for ACLs with less than kMinRuleCount rules, the
+// linear walk is cheaper for them. Deleting a rule clears its bit, adding
+// rules compiles the ACL again.
+////////////////////////////////////////////////////////////////////////////
+class AclClassifier {
+public:
+    static const uint32_t kMinRuleCount = 8;
+    typedef std::vector<const AclEntry *> RuleList;
+
+    AclClassifier();
+    ~AclClassifier();
+
+    // Compile rules in the order given. Clears the classifier if there are
+    // too few rules
+    void Build(const RuleList &rules);
+    void Clear();
+    // Remove a rule without compiling again
+    void Remove(const AclEntry *rule);
+
+    bool enabled() const { return enabled_; }
+    uint32_t rule_count() const { return rules_.size(); }
+    const AclEntry *rule(uint32_t index) const { return rules_[index]; }
+
+    // Compute candidate rules for the packet
+    void Classify(const PacketHeader &hdr, bool flow_policy_info,
+                  AclRuleBitmap *result) const;
+
+    // Iterate over bits set in a bitmap. The index returned is at least
+    // rule_count() when no bit is left
+    static uint32_t FindFirst(const AclRuleBitmap &bitmap);
+    static uint32_t FindNext(const AclRuleBitmap &bitmap, uint32_t index);
+
+private:
+    void AddRule(uint32_t index, const AclEntry *rule);
+
+    bool enabled_;
+    RuleList rules_;
+    // Rules not deleted since the last compile
+    AclRuleBitmap valid_;
+    // Rules to be evaluated whenever FlowPolicyInfo is requested
+    AclRuleBitmap flow_policy_info_;
+    AclIntervalTable<uint16_t> protocol_;
+    AclIntervalTable<uint16_t> src_port_;
+    AclIntervalTable<uint16_t> dst_port_;
+    AclIntervalTable<uint32_t> src_ip4_;
+    AclIntervalTable<uint32_t> dst_ip4_;
+    AclIntervalTable<AclIp6Key> src_ip6_;
+    AclIntervalTable<AclIp6Key> dst_ip6_;
+    DISALLOW_COPY_AND_ASSIGN(AclClassifier);
+};
+
+#endif
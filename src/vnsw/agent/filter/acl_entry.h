@@ -128,6 +128,7 @@ public:
     const AclEntryMatch* Get(uint32_t index) const {
         return matches_[index];
     }
+    uint32_t match_count() const { return matches_.size(); }
 
 private:
     AclEntryID id_;
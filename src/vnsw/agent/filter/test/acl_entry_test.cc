@@ -2,6 +2,9 @@
  * Copyright (c) 2013 Juniper Networks, Inc. All rights reserved.
  */
 
+#include <stdlib.h>
+#include <sstream>
+
 #include "base/logging.h"
 #include "testing/gunit.h"
 
@@ -600,6 +603,149 @@ TEST_F(AclEntryTest, BasicIntrospecSgAclEntry) {
 }
 
 
+// Compiled ACL must pick the same rules as the walk over each AclEntry
+TEST_F(AclEntryTest, Classifier) {
+    boost::uuids::uuid acl_uuid = boost::uuids::nil_uuid();
+    AclDBEntry acl(acl_uuid);
+    AclDBEntry::AclEntries entries;
+
+    srand(1);
+    for (int i = 0; i < 64; i++) {
+        AclEntrySpec spec;
+        spec.id = i + 1;
+        spec.terminal = false;
+        if (i % 2) {
+            RangeSpec protocol;
+            protocol.min = (i % 3) ? IPPROTO_TCP : IPPROTO_UDP;
+            protocol.max = protocol.min;
+            spec.protocol.push_back(protocol);
+        }
+        if (i % 3) {
+            RangeSpec port;
+            port.min = rand() % 1000;
+            port.max = port.min + rand() % 200;
+            spec.dst_port.push_back(port);
+        }
+        if (i % 4) {
+            std::stringstream ss;
+            ss << "10.1." << (rand() % 4) << ".0";
+            spec.BuildAddressInfo(ss.str(), 22 + (i % 11), &spec.src_ip_list);
+            spec.src_addr_type = AddressMatch::IP_ADDR;
+        }
+        if (i % 5 == 0) {
+            spec.BuildAddressInfo("fd11::", 64, &spec.dst_ip_list);
+            spec.dst_addr_type = AddressMatch::IP_ADDR;
+        }
+        ActionSpec action;
+        action.ta_type = TrafficAction::SIMPLE_ACTION;
+        action.simple_action = TrafficAction::PASS;
+        spec.action_l.push_back(action);
+        acl.AddAclEntry(spec, entries);
+    }
+    acl.SetAclEntries(entries);
+    acl.UpdateClassifier();
+    EXPECT_TRUE(acl.classifier().enabled());
+
+    // Delete a rule, the classifier must skip it without compiling again
+    EXPECT_TRUE(acl.DeleteAclEntry(6));
+    EXPECT_EQ(63U, acl.Size());
+
+    for (int i = 0; i < 2000; i++) {
+        PacketHeader packet;
+        packet.protocol = (i % 2) ? IPPROTO_TCP : IPPROTO_UDP;
+        packet.dst_port = rand() % 1300;
+        packet.src_ip = Ip4Address(0x0A010000 | (rand() % 0x400));
+        if (i % 4 == 0) {
+            packet.dst_ip = Ip6Address::from_string("fd11::1");
+        } else {
+            packet.dst_ip = Ip4Address(0x0A020202);
+        }
+
+        AclEntryIDList expected;
+        for (uint32_t j = 0; j < acl.Size(); j++) {
+            const AclEntry *entry = acl.GetAclEntryAtIndex(j);
+            if (entry->PacketMatch(packet, NULL).empty() == false) {
+                expected.push_back(entry->id());
+            }
+        }
+
+        MatchAclParams m_acl;
+        EXPECT_EQ(expected.empty() == false,
+                  acl.PacketMatch(packet, m_acl, NULL));
+        EXPECT_TRUE(expected == m_acl.ace_id_list);
+    }
+    acl.DeleteAllAclEntries();
+}
+
+// Rules before the first rule changed retain their generation
+TEST_F(AclEntryTest, ChangeGeneration) {
+    boost::uuids::uuid acl_uuid = boost::uuids::nil_uuid();
+    AclDBEntry acl(acl_uuid);
+    AclDBEntry::AclEntries entries;
+
+    for (int i = 0; i < 8; i++) {
+        AclEntrySpec spec;
+        spec.id = i + 1;
+        spec.terminal = true;
+        ActionSpec action;
+        action.ta_type = TrafficAction::SIMPLE_ACTION;
+        action.simple_action = TrafficAction::PASS;
+        spec.action_l.push_back(action);
+        acl.AddAclEntry(spec, entries);
+    }
+    acl.SetAclEntries(entries);
+    acl.SetRulesChanged(0);
+    uint32_t gen = acl.change_gen();
+
+    AclDBEntry::AceIdSet unchanged;
+    acl.GetUnchangedAces(gen - 1, &unchanged);
+    EXPECT_TRUE(unchanged.empty());
+    acl.GetUnchangedAces(gen, &unchanged);
+    EXPECT_EQ(8U, unchanged.size());
+
+    // Delete the 6th rule, rules 6 onwards are changed
+    uint32_t index = acl.RuleIndex(AclEntryID(6));
+    EXPECT_EQ(5U, index);
+    EXPECT_TRUE(acl.DeleteAclEntry(6));
+    acl.SetRulesChanged(index);
+    EXPECT_EQ(gen + 1, acl.change_gen());
+
+    unchanged.clear();
+    acl.GetUnchangedAces(gen, &unchanged);
+    EXPECT_EQ(5U, unchanged.size());
+    EXPECT_TRUE(unchanged.find(AclEntryID(5).id_) != unchanged.end());
+    EXPECT_TRUE(unchanged.find(AclEntryID(6).id_) == unchanged.end());
+    EXPECT_TRUE(unchanged.find(AclEntryID(7).id_) == unchanged.end());
+
+    // Replace the entries with same rules, but for 3rd rule
+    AclDBEntry::AclEntries new_entries;
+    for (int i = 0; i < 8; i++) {
+        if (i == 5)
+            continue;
+        AclEntrySpec spec;
+        spec.id = i + 1;
+        spec.terminal = (i != 2);
+        ActionSpec action;
+        action.ta_type = TrafficAction::SIMPLE_ACTION;
+        action.simple_action = TrafficAction::PASS;
+        spec.action_l.push_back(action);
+        acl.AddAclEntry(spec, new_entries);
+    }
+    EXPECT_TRUE(acl.Changed(new_entries));
+    EXPECT_EQ(2U, acl.CommonPrefixSize(new_entries));
+    acl.DeleteAllAclEntries();
+    acl.SetAclEntries(new_entries);
+    acl.SetRulesChanged(2);
+
+    unchanged.clear();
+    acl.GetUnchangedAces(gen + 1, &unchanged);
+    EXPECT_EQ(2U, unchanged.size());
+    unchanged.clear();
+    acl.GetUnchangedAces(gen + 2, &unchanged);
+    EXPECT_EQ(7U, unchanged.size());
+    acl.DeleteAllAclEntries();
+}
+
 } // namespace
 
 int main (int argc, char **argv) {
@@ -148,7 +148,9 @@ void ProfileData::FlowStats::Reset() {
     recompute_count_ = 0;
     pkt_handler_queue_.Reset();
     flow_mgmt_queue_.Reset();
-    flow_update_queue_.Reset();
+    for (uint16_t i = 0; i < flow_update_queue_.size(); i++) {
+        flow_update_queue_[i].Reset();
+    }
     for (uint16_t i = 0; i < flow_event_queue_.size(); i++) {
         flow_event_queue_[i].Reset();
     }
@@ -437,7 +439,7 @@ void SandeshTaskStatsRequest::HandleRequest() const {
 }
 
 static void GetOneQueueSummary(SandeshFlowQueueSummaryOneInfo *one,
-                               ProfileData::WorkQueueStats *stats) {
+                               const ProfileData::WorkQueueStats *stats) {
     one->set_qcount(stats->queue_count_);
     one->set_enqueues(stats->enqueue_count_);
     one->set_dequeues(stats->dequeue_count_);
@@ -567,8 +569,36 @@ static void GetQueueSummaryInfo(SandeshFlowQueueSummaryInfo *info, int index,
     info->set_flow_mgmt_queue(one);
 
     // flow_update_queue
-    GetOneQueueSummary(&one, &flow_stats->flow_update_queue_);
+    qcount = 0;
+    enqueues = 0;
+    dequeues = 0;
+    max_qlen = 0;
+    busy_time = 0;
+    starts = 0;
+    std::vector<SandeshFlowQueueSummaryOneInfo> update_list;
+    it = flow_stats->flow_update_queue_.begin();
+    while (it != flow_stats->flow_update_queue_.end()) {
+        SandeshFlowQueueSummaryOneInfo update_one;
+        GetOneQueueSummary(&update_one, &(*it));
+        update_list.push_back(update_one);
+        qcount += it->queue_count_;
+        enqueues += it->enqueue_count_;
+        dequeues += it->dequeue_count_;
+        busy_time += it->busy_time_;
+        starts += it->start_count_;
+        if (it->max_queue_count_ > max_qlen) {
+            max_qlen = it->max_queue_count_;
+        }
+        it++;
+    }
+    one.set_qcount(qcount);
+    one.set_enqueues(enqueues);
+    one.set_dequeues(dequeues);
+    one.set_max_qlen(max_qlen);
+    one.set_starts(starts);
+    one.set_busy_msec(busy_time);
     info->set_flow_update_queue(one);
+    info->set_flow_update_queue_list(update_list);
 
     // flow_stats_queue
     qcount = 0;
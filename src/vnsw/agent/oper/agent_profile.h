@@ -63,7 +63,7 @@ public:
         FlowTokenStats token_stats_;
         WorkQueueStats pkt_handler_queue_;
         WorkQueueStats flow_mgmt_queue_;
-        WorkQueueStats flow_update_queue_;
+        std::vector<WorkQueueStats> flow_update_queue_;
         std::vector<WorkQueueStats> flow_event_queue_;
         std::vector<WorkQueueStats> flow_tokenless_queue_;
         std::vector<WorkQueueStats> flow_delete_queue_;
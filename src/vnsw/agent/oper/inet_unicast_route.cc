@@ -901,6 +901,17 @@ InetUnicastAgentRouteTable::DeleteReq(const Peer *peer, const string &vrf_name,
     InetUnicastTableEnqueue(Agent::GetInstance(), vrf_name, &req);
 }
 
+void
+InetUnicastAgentRouteTable::DeleteReq(const Peer *peer, const string &vrf_name,
+                                      const IpAddress &addr, uint8_t plen,
+                                      AgentRouteData *data,
+                                      DBRequestList *reqs) {
+    DBRequest *req = new DBRequest(DBRequest::DB_ENTRY_DELETE);
+    req->key.reset(new InetUnicastRouteKey(peer, vrf_name, addr, plen));
+    req->data.reset(data);
+    reqs->push_back(req);
+}
+
 // Inline delete request
 void
 InetUnicastAgentRouteTable::Delete(const Peer *peer, const string &vrf_name,
@@ -1125,6 +1136,33 @@ InetUnicastAgentRouteTable::AddRemoteVmRouteReq(const Peer *peer,
     InetUnicastTableEnqueue(Agent::GetInstance(), vm_vrf, &req);
 }
 
+void
+InetUnicastAgentRouteTable::AddRemoteVmRouteReq(const Peer *peer,
+                                                const string &vm_vrf,
+                                                const IpAddress &vm_addr,
+                                                uint8_t plen,
+                                                AgentRouteData *data,
+                                                DBRequestList *reqs) {
+    if (Agent::GetInstance()->simulate_evpn_tor())
+        return;
+    DBRequest *req = new DBRequest(DBRequest::DB_ENTRY_ADD_CHANGE);
+    req->key.reset(new InetUnicastRouteKey(peer, vm_vrf, vm_addr, plen));
+    req->data.reset(data);
+    reqs->push_back(req);
+}
+
+// Requests for both inet4 and inet6 routes are enqueued to the fabric inet4
+// table, as in InetUnicastTableEnqueue.
+void InetUnicastAgentRouteTable::EnqueueReqList(DBRequestList *reqs) {
+    AgentRouteTable *table =
+        Agent::GetInstance()->fabric_inet4_unicast_table();
+    if (table) {
+        table->Enqueue(reqs);
+    } else {
+        reqs->clear();
+    }
+}
+
 void
 InetUnicastAgentRouteTable::AddArpReq(const string &route_vrf_name,
                                       const Ip4Address &ip,
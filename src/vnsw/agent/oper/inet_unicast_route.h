@@ -180,6 +180,9 @@ public:
     static void DeleteReq(const Peer *peer, const string &vrf_name,
                           const IpAddress &addr, uint8_t plen,
                           AgentRouteData *data);
+    static void DeleteReq(const Peer *peer, const string &vrf_name,
+                          const IpAddress &addr, uint8_t plen,
+                          AgentRouteData *data, DBRequestList *reqs);
     static void Delete(const Peer *peer, const string &vrf_name,
                        const IpAddress &addr, uint8_t plen);
     void Delete(const Peer *peer, const string &vrf_name,
@@ -228,6 +231,13 @@ public:
     static void AddRemoteVmRouteReq(const Peer *peer, const string &vm_vrf,
                                     const IpAddress &vm_addr,uint8_t plen,
                                     AgentRouteData *data);
+    // Variants of DeleteReq and AddRemoteVmRouteReq that append the request
+    // to reqs, which is enqueued with EnqueueReqList.
+    static void AddRemoteVmRouteReq(const Peer *peer, const string &vm_vrf,
+                                    const IpAddress &vm_addr, uint8_t plen,
+                                    AgentRouteData *data,
+                                    DBRequestList *reqs);
+    static void EnqueueReqList(DBRequestList *reqs);
     void AddVlanNHRouteReq(const Peer *peer, const string &vm_vrf,
                            const IpAddress &addr, uint8_t plen,
                            VlanNhRoute *data);
@@ -58,6 +58,11 @@ public:
         return true;
     }
 
+    // Handle a batch of control packets. AgentHdr is already decoded
+    void ProcessBatch(PktHandler::PacketBufferBatch *batch) {
+        pkt_handler_->HandleRcvPktBatch(batch);
+    }
+
     PktHandler *pkt_handler() const { return pkt_handler_; }
 private:
     PktHandler *pkt_handler_;
@@ -15,6 +15,32 @@
 #include "flow_mgmt.h"
 #include "flow_event.h"
 
+//////////////////////////////////////////////////////////////////////////////
+// FlowEventHistogram routines
+//////////////////////////////////////////////////////////////////////////////
+void FlowEventHistogram::Add(uint64_t value) {
+    int i = 0;
+    while (value && i < (kBucketCount - 1)) {
+        value >>= 1;
+        i++;
+    }
+    bucket_[i].fetch_and_increment();
+}
+
+void FlowEventHistogram::Reset() {
+    for (int i = 0; i < kBucketCount; i++) {
+        bucket_[i] = 0;
+    }
+}
+
+uint64_t FlowEventHistogram::count() const {
+    uint64_t count = 0;
+    for (int i = 0; i < kBucketCount; i++) {
+        count += bucket_[i];
+    }
+    return count;
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // FlowEventQueue routines
 //////////////////////////////////////////////////////////////////////////////
@@ -52,12 +78,20 @@ void FlowEventQueueBase::Shutdown() {
     queue_->Shutdown();
 }
 
-void FlowEventQueueBase::Enqueue(FlowEvent *event) {
+bool FlowEventQueueBase::Enqueue(FlowEvent *event) {
     if (CanEnqueue(event) == false) {
         delete event;
-        return;
+        return false;
     }
+    depth_histogram_.Add(queue_->Length());
+    event->set_enqueue_time(ClockMonotonicUsec());
     queue_->Enqueue(event);
+    return true;
+}
+
+void FlowEventQueueBase::ClearHistograms() {
+    depth_histogram_.Reset();
+    latency_histogram_.Reset();
 }
 
 bool FlowEventQueueBase::TokenCheck() {
@@ -97,6 +131,7 @@ void FlowEventQueueBase::TaskExit(bool done) {
 bool FlowEventQueueBase::Handler(FlowEvent *event) {
     std::auto_ptr<FlowEvent> event_ptr(event);
     count_++;
+    latency_histogram_.Add(ClockMonotonicUsec() - event->enqueue_time());
     if (CanProcess(event) == false) {
         ProcessDone(event, false);
         return true;
@@ -289,12 +324,13 @@ bool KSyncFlowEventQueue::HandleEvent(FlowEvent *event) {
 }
 
 UpdateFlowEventQueue::UpdateFlowEventQueue(Agent *agent, FlowProto *proto,
+                                           int task_instance,
                                            FlowTokenPool *pool,
                                            uint16_t latency_limit,
                                            uint32_t max_iterations) :
     FlowEventQueueBase(proto, "Flow Update Queue",
-                       agent->task_scheduler()->GetTaskId(kTaskFlowUpdate), 0,
-                       pool, latency_limit, max_iterations) {
+                       agent->task_scheduler()->GetTaskId(kTaskFlowUpdate),
+                       task_instance, pool, latency_limit, max_iterations) {
 }
 
 UpdateFlowEventQueue::~UpdateFlowEventQueue() {
@@ -303,3 +339,68 @@ UpdateFlowEventQueue::~UpdateFlowEventQueue() {
 bool UpdateFlowEventQueue::HandleEvent(FlowEvent *event) {
     return flow_proto_->FlowUpdateHandler(event);
 }
+
+// Event is freed by the base class, release the shard after that
+bool UpdateFlowEventQueue::Handler(FlowEvent *event) {
+    uint32_t shard = event->shard();
+    bool ret = FlowEventQueueBase::Handler(event);
+    flow_proto_->UpdateFlowEventDone(shard);
+    return ret;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// UpdateFlowEventDispatcher routines
+//////////////////////////////////////////////////////////////////////////////
+UpdateFlowEventDispatcher::UpdateFlowEventDispatcher() {
+    move_count_ = 0;
+}
+
+UpdateFlowEventDispatcher::~UpdateFlowEventDispatcher() {
+}
+
+// Flow-pair is identified by the forward flow
+uint32_t UpdateFlowEventDispatcher::ShardIndex(const FlowEntry *flow) {
+    const FlowEntry *fwd = flow;
+    if (flow->is_flags_set(FlowEntry::ReverseFlow) &&
+        flow->reverse_flow_entry() != NULL) {
+        fwd = flow->reverse_flow_entry();
+    }
+    return boost::hash<const FlowEntry *>()(fwd) % kShardCount;
+}
+
+void UpdateFlowEventDispatcher::Enqueue(const QueueList &queues,
+                                        FlowEvent *event) {
+    uint32_t shard_index = ShardIndex(event->flow());
+    Shard *shard = &shards_[shard_index];
+    UpdateFlowEventQueue *queue = NULL;
+    {
+        tbb::mutex::scoped_lock lock(shard->mutex_);
+        if (shard->pending_ == 0) {
+            uint32_t index = shard->queue_index_;
+            uint32_t len = queues[index]->Length();
+            for (uint32_t i = 0; i < queues.size(); i++) {
+                uint32_t tmp = queues[i]->Length();
+                if (tmp < len) {
+                    index = i;
+                    len = tmp;
+                }
+            }
+            if (index != shard->queue_index_) {
+                shard->queue_index_ = index;
+                move_count_++;
+            }
+        }
+        shard->pending_++;
+        queue = queues[shard->queue_index_];
+    }
+
+    event->set_shard(shard_index);
+    if (queue->Enqueue(event) == false) {
+        Done(shard_index);
+    }
+}
+
+void UpdateFlowEventDispatcher::Done(uint32_t shard) {
+    uint32_t prev = shards_[shard].pending_.fetch_and_decrement();
+    assert(prev != 0);
+}
@@ -5,6 +5,7 @@
 #define __AGENT_FLOW_EVENT_H__
 
 #include <sys/resource.h>
+#include <tbb/atomic.h>
 #include <ksync/ksync_entry.h>
 #include "flow_table.h"
 
@@ -61,83 +62,93 @@ public:
     FlowEvent() :
         event_(INVALID), flow_(NULL), pkt_info_(), db_entry_(NULL),
         gen_id_(0), evict_gen_id_(0),
-        flow_handle_(FlowEntry::kInvalidFlowHandle), table_index_(0) {
+        flow_handle_(FlowEntry::kInvalidFlowHandle), table_index_(0),
+        enqueue_time_(0), shard_(0) {
     }
 
     FlowEvent(Event event) :
         event_(event), flow_(NULL), pkt_info_(), db_entry_(NULL),
-        gen_id_(0), evict_gen_id_(0), table_index_(0) {
+        gen_id_(0), evict_gen_id_(0), table_index_(0),
+        enqueue_time_(0), shard_(0) {
     }
 
     FlowEvent(Event event, FlowEntry *flow) :
         event_(event), flow_(flow), pkt_info_(), db_entry_(NULL),
-        table_index_(0) {
+        table_index_(0), enqueue_time_(0), shard_(0) {
     }
 
     FlowEvent(Event event, uint32_t table_index) :
         event_(event), flow_(NULL), pkt_info_(), db_entry_(NULL),
         gen_id_(0), evict_gen_id_(0),
-        flow_handle_(FlowEntry::kInvalidFlowHandle), table_index_(table_index) {
+        flow_handle_(FlowEntry::kInvalidFlowHandle), table_index_(table_index),
+        enqueue_time_(0), shard_(0) {
     }
 
     FlowEvent(Event event, FlowEntry *flow, uint32_t flow_handle,
               uint8_t gen_id) :
         event_(event), flow_(flow), pkt_info_(), db_entry_(NULL),
         gen_id_(gen_id), evict_gen_id_(0), flow_handle_(flow_handle),
-        table_index_(0) {
+        table_index_(0), enqueue_time_(0), shard_(0) {
     }
 
     FlowEvent(Event event, FlowEntry *flow, uint32_t flow_handle,
               uint8_t gen_id, uint8_t evict_gen_id) :
         event_(event), flow_(flow), pkt_info_(), db_entry_(NULL),
         gen_id_(gen_id), evict_gen_id_(evict_gen_id), flow_handle_(flow_handle),
-        table_index_(0) {
+        table_index_(0), enqueue_time_(0), shard_(0) {
     }
 
     FlowEvent(Event event, FlowEntry *flow, const DBEntry *db_entry) :
         event_(event), flow_(flow), pkt_info_(), db_entry_(db_entry),
         gen_id_(0), evict_gen_id_(0),
-        flow_handle_(FlowEntry::kInvalidFlowHandle), table_index_(0) {
+        flow_handle_(FlowEntry::kInvalidFlowHandle), table_index_(0),
+        enqueue_time_(0), shard_(0) {
     }
 
     FlowEvent(Event event, const DBEntry *db_entry, uint32_t gen_id) :
         event_(event), flow_(NULL), pkt_info_(), db_entry_(db_entry),
         gen_id_(gen_id), evict_gen_id_(0),
-        flow_handle_(FlowEntry::kInvalidFlowHandle), table_index_(0) {
+        flow_handle_(FlowEntry::kInvalidFlowHandle), table_index_(0),
+        enqueue_time_(0), shard_(0) {
     }
 
     FlowEvent(Event event, uint16_t table_index, const DBEntry *db_entry,
               uint32_t gen_id) :
         event_(event), flow_(NULL), pkt_info_(), db_entry_(db_entry),
         gen_id_(gen_id), evict_gen_id_(0),
-        flow_handle_(FlowEntry::kInvalidFlowHandle), table_index_(table_index) {
+        flow_handle_(FlowEntry::kInvalidFlowHandle), table_index_(table_index),
+        enqueue_time_(0), shard_(0) {
     }
 
     FlowEvent(Event event, const FlowKey &key) :
         event_(event), flow_(NULL), pkt_info_(), db_entry_(NULL),
         gen_id_(0), evict_gen_id_(0), flow_key_(key),
-        flow_handle_(FlowEntry::kInvalidFlowHandle), table_index_(0) {
+        flow_handle_(FlowEntry::kInvalidFlowHandle), table_index_(0),
+        enqueue_time_(0), shard_(0) {
     }
 
     FlowEvent(Event event, const FlowKey &key, uint32_t flow_handle,
               uint8_t gen_id) :
         event_(event), flow_(NULL), pkt_info_(), db_entry_(NULL),
         gen_id_(gen_id), evict_gen_id_(0), flow_key_(key),
-        flow_handle_(flow_handle), table_index_(0) {
+        flow_handle_(flow_handle), table_index_(0),
+        enqueue_time_(0), shard_(0) {
     }
 
     FlowEvent(Event event, PktInfoPtr pkt_info, FlowEntry *flow,
               uint32_t table_index) :
         event_(event), flow_(flow), pkt_info_(pkt_info), db_entry_(NULL),
         gen_id_(0), evict_gen_id_(0), flow_key_(),
-        flow_handle_(FlowEntry::kInvalidFlowHandle), table_index_(table_index) {
+        flow_handle_(FlowEntry::kInvalidFlowHandle), table_index_(table_index),
+        enqueue_time_(0), shard_(0) {
     }
 
     FlowEvent(const FlowEvent &rhs) :
         event_(rhs.event_), flow_(rhs.flow()), pkt_info_(rhs.pkt_info_),
         db_entry_(rhs.db_entry_), gen_id_(rhs.gen_id_),
         evict_gen_id_(rhs.evict_gen_id_), flow_key_(rhs.flow_key_),
-        flow_handle_(rhs.flow_handle_), table_index_(rhs.table_index_) {
+        flow_handle_(rhs.flow_handle_), table_index_(rhs.table_index_),
+        enqueue_time_(0), shard_(0) {
     }
 
     virtual ~FlowEvent() {
@@ -155,6 +166,10 @@ public:
     PktInfoPtr pkt_info() const { return pkt_info_; }
     uint32_t flow_handle() const { return flow_handle_; }
     uint32_t table_index() const { return table_index_;}
+    uint64_t enqueue_time() const { return enqueue_time_; }
+    void set_enqueue_time(uint64_t time) { enqueue_time_ = time; }
+    uint32_t shard() const { return shard_; }
+    void set_shard(uint32_t shard) { shard_ = shard; }
 private:
     Event event_;
     FlowEntryPtr flow_;
@@ -165,6 +180,10 @@ private:
     FlowKey flow_key_;
     uint32_t flow_handle_;
     uint32_t table_index_;
+    // Time in usec when the event was enqueued
+    uint64_t enqueue_time_;
+    // Shard of flow-pair for the update queues
+    uint32_t shard_;
 };
 
 ////////////////////////////////////////////////////////////////////////////
@@ -258,7 +277,30 @@ private:
 //   We take timestamp at start of queue, and check latency for every 8
 //   events processed in the queue. If the latency goes beyond a limit, the
 //   WorkQueue run is aborted.
+//
+// - Histograms
+//   Each queue keeps a histogram of the queue length seen by enqueued events
+//   and of the time (in usec) an event waits in the queue before it is
+//   processed. Events are enqueued from many tasks, so the buckets are
+//   atomic
 ////////////////////////////////////////////////////////////////////////////
+class FlowEventHistogram {
+public:
+    // Bucket 0 counts value 0, bucket i counts values in [2^(i-1), 2^i).
+    // The last bucket counts all larger values
+    static const int kBucketCount = 24;
+
+    FlowEventHistogram() { Reset(); }
+
+    void Add(uint64_t value);
+    void Reset();
+    uint64_t bucket(int i) const { return bucket_[i]; }
+    uint64_t count() const;
+
+private:
+    tbb::atomic<uint64_t> bucket_[kBucketCount];
+};
+
 class FlowEventQueueBase {
 public:
     typedef WorkQueue<FlowEvent *> Queue;
@@ -272,7 +314,8 @@ public:
     virtual bool Handler(FlowEvent *event);
 
     void Shutdown();
-    void Enqueue(FlowEvent *event);
+    // Returns false if the event is state-compressed and freed
+    bool Enqueue(FlowEvent *event);
     bool TokenCheck();
     bool TaskEntry();
     void TaskExit(bool done);
@@ -282,6 +325,13 @@ public:
     Queue *queue() const { return queue_; }
     uint64_t events_processed() const { return events_processed_; }
     uint64_t events_enqueued() const { return queue_->NumEnqueues(); }
+    const FlowEventHistogram &depth_histogram() const {
+        return depth_histogram_;
+    }
+    const FlowEventHistogram &latency_histogram() const {
+        return latency_histogram_;
+    }
+    void ClearHistograms();
 
 protected:
     bool CanEnqueue(FlowEvent *event);
@@ -299,6 +349,8 @@ protected:
     uint64_t events_processed_;
     uint16_t latency_limit_;
     struct rusage rusage_;
+    FlowEventHistogram depth_histogram_;
+    FlowEventHistogram latency_histogram_;
 };
 
 class FlowEventQueue : public FlowEventQueueBase {
@@ -339,12 +391,56 @@ private:
 
 class UpdateFlowEventQueue : public FlowEventQueueBase {
 public:
-    UpdateFlowEventQueue(Agent *agent, FlowProto *proto,
+    UpdateFlowEventQueue(Agent *agent, FlowProto *proto, int task_instance,
                          FlowTokenPool *pool, uint16_t latency_limit,
                          uint32_t max_iterations);
     virtual ~UpdateFlowEventQueue();
 
     bool HandleEvent(FlowEvent *event);
+    bool Handler(FlowEvent *event);
+};
+
+////////////////////////////////////////////////////////////////////////////
+// Update events (DELETE_DBENTRY, REVALUATE_DBENTRY and RECOMPUTE_FLOW) are
+// processed under the flow locks and do not depend on the partition of
+// the flow. FlowProto has an UpdateFlowEventQueue per partition and the
+// dispatcher balances update events across them.
+//
+// Events of a flow-pair must be processed in order. The flow-pairs are
+// hashed into kShardCount shards, and events of a shard are given to the
+// queue that has the shard's pending events. A shard without pending events
+// moves to the shortest queue. So, a burst of updates (ex: revaluate of all
+// flows of a busy interface) is spread over all queues, but events of a
+// flow-pair are never reordered.
+////////////////////////////////////////////////////////////////////////////
+class UpdateFlowEventDispatcher {
+public:
+    static const uint32_t kShardCount = 1024;
+    typedef std::vector<UpdateFlowEventQueue *> QueueList;
+
+    UpdateFlowEventDispatcher();
+    ~UpdateFlowEventDispatcher();
+
+    void Enqueue(const QueueList &queues, FlowEvent *event);
+    // Called after event of the shard is processed
+    void Done(uint32_t shard);
+
+    uint32_t pending(uint32_t shard) const { return shards_[shard].pending_; }
+    uint64_t move_count() const { return move_count_; }
+    static uint32_t ShardIndex(const FlowEntry *flow);
+
+private:
+    struct Shard {
+        Shard() : queue_index_(0) { pending_ = 0; }
+        tbb::mutex mutex_;
+        tbb::atomic<uint32_t> pending_;
+        uint32_t queue_index_;
+    };
+
+    Shard shards_[kShardCount];
+    // Number of times a shard moved to another queue
+    tbb::atomic<uint64_t> move_count_;
+    DISALLOW_COPY_AND_ASSIGN(UpdateFlowEventDispatcher);
 };
 
 #endif //  __AGENT_FLOW_EVENT_H__
@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include <string.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include <pkt/flow_hash_table.h>
+#include <pkt/flow_entry.h>
+
+const uint32_t FlowEntryHashTable::kGroupSize;
+const uint32_t FlowEntryHashTable::kMinCapacity;
+const int8_t FlowEntryHashTable::kEmpty;
+const int8_t FlowEntryHashTable::kDeleted;
+
+static inline uint64_t HashMix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+static inline uint64_t HashAddress(const IpAddress &addr) {
+    if (addr.is_v4()) {
+        return addr.to_v4().to_ulong();
+    }
+
+    Ip6Address::bytes_type bytes = addr.to_v6().to_bytes();
+    uint64_t high, low;
+    memcpy(&high, &bytes[0], sizeof(high));
+    memcpy(&low, &bytes[8], sizeof(low));
+    return HashMix(high) ^ low;
+}
+
+uint64_t FlowEntryHashTable::Hash(const FlowKey &key) {
+    uint64_t h = ((uint64_t)key.nh << 32) |
+        ((uint64_t)key.src_port << 16) | key.dst_port;
+    h ^= ((uint64_t)key.protocol << 56) ^ ((uint64_t)key.family << 48);
+    h = HashMix(h ^ HashAddress(key.src_addr));
+    return HashMix(h ^ HashAddress(key.dst_addr));
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Group match routines. Each returns a bitmap with bit i set if control
+// byte i of the group matches
+/////////////////////////////////////////////////////////////////////////////
+#if defined(__SSE2__)
+uint32_t FlowEntryHashTable::MatchTag(const int8_t *group, int8_t tag) {
+    __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i *>(group));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(tag), ctrl));
+}
+
+uint32_t FlowEntryHashTable::MatchEmpty(const int8_t *group) {
+    return MatchTag(group, kEmpty);
+}
+
+// Empty and deleted are the only negative control values
+uint32_t FlowEntryHashTable::MatchEmptyOrDeleted(const int8_t *group) {
+    __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i *>(group));
+    return _mm_movemask_epi8(ctrl);
+}
+#else
+uint32_t FlowEntryHashTable::MatchTag(const int8_t *group, int8_t tag) {
+    uint32_t mask = 0;
+    for (uint32_t i = 0; i < kGroupSize; i++) {
+        if (group[i] == tag)
+            mask |= (1 << i);
+    }
+    return mask;
+}
+
+uint32_t FlowEntryHashTable::MatchEmpty(const int8_t *group) {
+    return MatchTag(group, kEmpty);
+}
+
+uint32_t FlowEntryHashTable::MatchEmptyOrDeleted(const int8_t *group) {
+    uint32_t mask = 0;
+    for (uint32_t i = 0; i < kGroupSize; i++) {
+        if (group[i] < 0)
+            mask |= (1 << i);
+    }
+    return mask;
+}
+#endif
+
+static inline uint32_t HashGroup(uint64_t hash) {
+    return (uint32_t)(hash >> 7);
+}
+
+static inline int8_t HashTag(uint64_t hash) {
+    return (int8_t)(hash & 0x7F);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// FlowEntryHashTable routines
+/////////////////////////////////////////////////////////////////////////////
+FlowEntryHashTable::FlowEntryHashTable() :
+    ctrl_(NULL), slots_(NULL), capacity_(0), size_(0), deleted_(0),
+    growth_left_(0), rehash_count_(0) {
+    Allocate(kMinCapacity);
+}
+
+FlowEntryHashTable::~FlowEntryHashTable() {
+    delete [] ctrl_;
+    delete [] slots_;
+}
+
+void FlowEntryHashTable::Allocate(uint32_t capacity) {
+    ctrl_ = new int8_t[capacity];
+    memset(ctrl_, kEmpty, capacity);
+    slots_ = new FlowEntry *[capacity];
+    memset(slots_, 0, capacity * sizeof(FlowEntry *));
+    capacity_ = capacity;
+    size_ = 0;
+    deleted_ = 0;
+    growth_left_ = MaxLoad(capacity);
+}
+
+void FlowEntryHashTable::clear() {
+    delete [] ctrl_;
+    delete [] slots_;
+    Allocate(kMinCapacity);
+}
+
+uint32_t FlowEntryHashTable::NextFull(uint32_t index) const {
+    while (index < capacity_ && ctrl_[index] < 0) {
+        index++;
+    }
+    return index;
+}
+
+// Returns capacity_ if key is not found
+uint32_t FlowEntryHashTable::FindIndex(const FlowKey &key,
+                                       uint64_t hash) const {
+    uint32_t mask = group_count() - 1;
+    uint32_t group = HashGroup(hash) & mask;
+    int8_t tag = HashTag(hash);
+    for (uint32_t probe = 1; probe <= group_count(); probe++) {
+        const int8_t *ctrl = ctrl_ + group * kGroupSize;
+        uint32_t match = MatchTag(ctrl, tag);
+        while (match) {
+            uint32_t index = group * kGroupSize + __builtin_ctz(match);
+            if (slots_[index]->key().IsEqual(key))
+                return index;
+            match &= match - 1;
+        }
+        if (MatchEmpty(ctrl))
+            break;
+        group = (group + probe) & mask;
+    }
+    return capacity_;
+}
+
+uint32_t FlowEntryHashTable::FindFreeIndex(uint64_t hash) const {
+    uint32_t mask = group_count() - 1;
+    uint32_t group = HashGroup(hash) & mask;
+    for (uint32_t probe = 1; ; probe++) {
+        uint32_t match = MatchEmptyOrDeleted(ctrl_ + group * kGroupSize);
+        if (match)
+            return group * kGroupSize + __builtin_ctz(match);
+        group = (group + probe) & mask;
+    }
+}
+
+FlowEntryHashTable::iterator
+FlowEntryHashTable::find(const FlowKey &key) const {
+    return iterator(this, FindIndex(key, Hash(key)));
+}
+
+std::pair<FlowEntryHashTable::iterator, bool>
+FlowEntryHashTable::insert(FlowEntry *flow) {
+    uint64_t hash = Hash(flow->key());
+    uint32_t index = FindIndex(flow->key(), hash);
+    if (index != capacity_)
+        return std::make_pair(iterator(this, index), false);
+
+    if (growth_left_ == 0) {
+        // Reclaim deleted slots if they account for most of the load,
+        // else double the table
+        if (deleted_ > size_)
+            Rehash(capacity_);
+        else
+            Rehash(capacity_ * 2);
+    }
+
+    index = FindFreeIndex(hash);
+    if (ctrl_[index] == kEmpty) {
+        growth_left_--;
+    } else {
+        deleted_--;
+    }
+    SetCtrl(index, HashTag(hash));
+    slots_[index] = flow;
+    size_++;
+    return std::make_pair(iterator(this, index), true);
+}
+
+void FlowEntryHashTable::erase(iterator it) {
+    uint32_t index = it.index_;
+    assert(index < capacity_ && ctrl_[index] >= 0);
+
+    // A lookup stops at first group with an empty slot. If the group already
+    // has an empty slot, no probe sequence went past it and the slot can be
+    // marked empty again. Else mark it deleted to keep probe chains intact
+    const int8_t *group = ctrl_ + (index / kGroupSize) * kGroupSize;
+    if (MatchEmpty(group)) {
+        SetCtrl(index, kEmpty);
+        growth_left_++;
+    } else {
+        SetCtrl(index, kDeleted);
+        deleted_++;
+    }
+    slots_[index] = NULL;
+    size_--;
+}
+
+size_t FlowEntryHashTable::erase(const FlowKey &key) {
+    iterator it = find(key);
+    if (it == end())
+        return 0;
+    erase(it);
+    return 1;
+}
+
+FlowEntryHashTable::iterator
+FlowEntryHashTable::upper_bound(const FlowKey &key) const {
+    uint64_t hash = Hash(key);
+    uint32_t index = FindIndex(key, hash);
+    if (index == capacity_) {
+        index = (HashGroup(hash) & (group_count() - 1)) * kGroupSize;
+        return iterator(this, NextFull(index));
+    }
+    return iterator(this, NextFull(index + 1));
+}
+
+void FlowEntryHashTable::Rehash(uint32_t capacity) {
+    int8_t *old_ctrl = ctrl_;
+    FlowEntry **old_slots = slots_;
+    uint32_t old_capacity = capacity_;
+
+    Allocate(capacity);
+    for (uint32_t i = 0; i < old_capacity; i++) {
+        if (old_ctrl[i] < 0)
+            continue;
+        uint64_t hash = Hash(old_slots[i]->key());
+        uint32_t index = FindFreeIndex(hash);
+        SetCtrl(index, HashTag(hash));
+        slots_[index] = old_slots[i];
+        size_++;
+        growth_left_--;
+    }
+    rehash_count_++;
+
+    delete [] old_ctrl;
+    delete [] old_slots;
+}
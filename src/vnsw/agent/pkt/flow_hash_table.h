@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#ifndef __AGENT_PKT_FLOW_HASH_TABLE_H__
+#define __AGENT_PKT_FLOW_HASH_TABLE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <utility>
+#include <base/util.h>
+
+struct FlowKey;
+class FlowEntry;
+
+/////////////////////////////////////////////////////////////////////////////
+// Open addressing hash index of flows keyed on FlowKey.
+//
+// The table only stores FlowEntry pointers. Flow entries are allocated from
+// FlowEntryFreeList and are never moved, so pointers held by other modules
+// stay valid across inserts and table growth.
+//
+// Slots are organized in groups of kGroupSize. Each slot has a one byte
+// control tag holding either kEmpty, kDeleted or 7 bits of the key hash.
+// A lookup computes the hash once and compares the tag against all control
+// bytes in a group at a time (SSE2 when available), so the FlowEntry itself
+// is dereferenced only for slots whose tag matches. Groups are probed in
+// triangular sequence, which visits every group when the group count is a
+// power of 2.
+//
+// Iteration order is slot order and has no relation to key order. Erasing
+// an entry does not move other entries, so iterators other than the one
+// erased remain valid. Insert may grow the table and invalidate iterators.
+//
+// Not thread safe. All manipulations are done from the FlowEvent task of
+// the owning FlowTable.
+/////////////////////////////////////////////////////////////////////////////
+class FlowEntryHashTable {
+public:
+    static const uint32_t kGroupSize = 16;
+    static const uint32_t kMinCapacity = 1024;
+
+    class iterator {
+    public:
+        iterator() : table_(NULL), index_(0) { }
+        iterator(const FlowEntryHashTable *table, uint32_t index) :
+            table_(table), index_(index) { }
+
+        // Returns NULL if the slot was erased after the iterator was formed
+        FlowEntry *operator*() const { return table_->slots_[index_]; }
+        iterator &operator++() {
+            index_ = table_->NextFull(index_ + 1);
+            return *this;
+        }
+        bool operator==(const iterator &rhs) const {
+            return index_ == rhs.index_;
+        }
+        bool operator!=(const iterator &rhs) const {
+            return index_ != rhs.index_;
+        }
+    private:
+        friend class FlowEntryHashTable;
+        const FlowEntryHashTable *table_;
+        uint32_t index_;
+    };
+
+    FlowEntryHashTable();
+    ~FlowEntryHashTable();
+
+    iterator begin() const { return iterator(this, NextFull(0)); }
+    iterator end() const { return iterator(this, capacity_); }
+
+    iterator find(const FlowKey &key) const;
+    // Inserts flow unless an entry with the same key is present. Returns
+    // iterator to the entry in table and true if flow was inserted
+    std::pair<iterator, bool> insert(FlowEntry *flow);
+    void erase(iterator it);
+    size_t erase(const FlowKey &key);
+    void clear();
+
+    // Returns the entry following key in iteration order. Used to resume
+    // paginated walks. If key is no longer present, the walk resumes from
+    // the first group key hashes to.
+    iterator upper_bound(const FlowKey &key) const;
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    uint32_t capacity() const { return capacity_; }
+    uint32_t deleted_count() const { return deleted_; }
+    uint64_t rehash_count() const { return rehash_count_; }
+
+    static uint64_t Hash(const FlowKey &key);
+
+private:
+    friend class iterator;
+    static const int8_t kEmpty = -128;
+    static const int8_t kDeleted = -2;
+
+    uint32_t group_count() const { return capacity_ / kGroupSize; }
+    static uint32_t MaxLoad(uint32_t capacity) {
+        return capacity - capacity / 8;
+    }
+    static uint32_t MatchTag(const int8_t *group, int8_t tag);
+    static uint32_t MatchEmpty(const int8_t *group);
+    static uint32_t MatchEmptyOrDeleted(const int8_t *group);
+
+    uint32_t NextFull(uint32_t index) const;
+    uint32_t FindIndex(const FlowKey &key, uint64_t hash) const;
+    uint32_t FindFreeIndex(uint64_t hash) const;
+    void SetCtrl(uint32_t index, int8_t ctrl) { ctrl_[index] = ctrl; }
+    void Rehash(uint32_t capacity);
+    void Allocate(uint32_t capacity);
+
+    int8_t *ctrl_;
+    FlowEntry **slots_;
+    uint32_t capacity_;
+    uint32_t size_;
+    uint32_t deleted_;
+    uint32_t growth_left_;
+    uint64_t rehash_count_;
+    DISALLOW_COPY_AND_ASSIGN(FlowEntryHashTable);
+};
+
+#endif  //  __AGENT_PKT_FLOW_HASH_TABLE_H__
@@ -34,7 +34,8 @@ FlowMgmtManager::FlowMgmtManager(Agent *agent, uint16_t table_index) :
     db_event_queue_(agent_->task_scheduler()->GetTaskId(kTaskFlowMgmt),
                     table_index,
                     boost::bind(&FlowMgmtManager::DBRequestHandler, this, _1),
-                    db_event_queue_.kMaxSize, 1) {
+                    db_event_queue_.kMaxSize, 1),
+    acl_revaluate_count_(0), acl_revaluate_skip_count_(0) {
     request_queue_.set_name("Flow management");
     request_queue_.set_measure_busy_time(agent->MeasureQueueDelay());
     db_event_queue_.set_name("Flow DB Event Queue");
@@ -204,6 +205,13 @@ void FlowMgmtManager::AddDBEntryEvent(const DBEntry *entry, uint32_t gen_id) {
     db_event_queue_.Enqueue(req);
 }
 
+void FlowMgmtManager::AddAclEvent(const AclDBEntry *acl, uint32_t gen_id,
+                                  AclDBEntry::AceIdSet *unchanged_aces) {
+    FlowMgmtRequestPtr req(new AclFlowMgmtRequest(acl, gen_id,
+                                                  unchanged_aces));
+    db_event_queue_.Enqueue(req);
+}
+
 void FlowMgmtManager::ChangeDBEntryEvent(const DBEntry *entry,
                                          uint32_t gen_id) {
     FlowMgmtRequestPtr req(new FlowMgmtRequest(FlowMgmtRequest::CHANGE_DBENTRY,
@@ -253,6 +261,12 @@ void FlowMgmtManager::FreeDBEntryEvent(FlowEvent::Event event, FlowMgmtKey *key,
     EnqueueFlowEvent(flow_resp);
 }
 
+void FlowMgmtManager::UpdateAclRevaluateStats(uint32_t revaluated,
+                                              uint32_t skipped) {
+    acl_revaluate_count_ += revaluated;
+    acl_revaluate_skip_count_ += skipped;
+}
+
 void FlowMgmtManager::FlowUpdateQueueDisable(bool disabled) {
     request_queue_.set_disable(disabled);
     db_event_queue_.set_disable(disabled);
@@ -880,13 +894,6 @@ void FlowMgmtManager::AddFlowMgmtKey(FlowEntry *flow, FlowEntryInfo *info,
     if (ret.second == false) {
         delete tmp;
         delete node;
-        if (key->type() == FlowMgmtKey::ACL) {
-            /* Copy the ACE Id list to existing key from new Key */
-            FlowMgmtKey *existing_key = ret.first->first;
-            AclFlowMgmtKey *akey = static_cast<AclFlowMgmtKey *>(existing_key);
-            AclFlowMgmtKey *new_key = static_cast<AclFlowMgmtKey *>(key);
-            akey->set_ace_id_list(new_key->ace_id_list());
-        }
     }
 
     switch (key->type()) {
@@ -898,6 +905,15 @@ void FlowMgmtManager::AddFlowMgmtKey(FlowEntry *flow, FlowEntryInfo *info,
     case FlowMgmtKey::ACL:
         acl_flow_mgmt_tree_.Add(key, flow, old_key,
                                 (ret.second)? node : NULL);
+        if (ret.second == false) {
+            // Copy the ACE Id list to existing key from new Key, after
+            // the tree has updated its state for the old list
+            AclFlowMgmtKey *akey =
+                static_cast<AclFlowMgmtKey *>(ret.first->first);
+            AclFlowMgmtKey *new_key = static_cast<AclFlowMgmtKey *>(key);
+            akey->set_ace_id_list(new_key->ace_id_list());
+            akey->set_terminal_ace_id(new_key->terminal_ace_id());
+        }
         break;
 
     case FlowMgmtKey::VN: {
@@ -1350,6 +1366,8 @@ void AclFlowMgmtEntry::FillAceFlowSandeshInfo(const AclDBEntry *acl,
 
     data.set_flow_count(Size());
     data.set_flow_miss(flow_miss_);
+    data.set_revaluate_count(revaluate_count_);
+    data.set_revaluate_skip_count(revaluate_skip_count_);
 
     if (!key_set) {
         data.set_iteration_key(GetAceSandeshDataKey(acl, Agent::NullString()));
@@ -1399,12 +1417,26 @@ void AclFlowMgmtEntry::DecrementAceIdCountMap(const AclEntryIDList *id_list) {
     }
 }
 
-bool AclFlowMgmtEntry::Add(const AclEntryIDList *id_list, FlowEntry *flow,
-                           const AclEntryIDList *old_id_list,
+void AclFlowMgmtEntry::DeleteFromAceFlowMap(const std::string &ace_id,
+                                            FlowEntry *flow) {
+    AceFlowMap::iterator it = ace_flow_map_.find(ace_id);
+    if (it == ace_flow_map_.end())
+        return;
+    it->second.erase(flow);
+    if (it->second.empty()) {
+        ace_flow_map_.erase(it);
+    }
+}
+
+bool AclFlowMgmtEntry::Add(const AclFlowMgmtKey *key, FlowEntry *flow,
+                           const AclFlowMgmtKey *old_key,
                            FlowMgmtKeyNode *node) {
-    if (old_id_list) {
-        DecrementAceIdCountMap(old_id_list);
+    const AclEntryIDList *id_list = key->ace_id_list();
+    if (old_key) {
+        DecrementAceIdCountMap(old_key->ace_id_list());
+        DeleteFromAceFlowMap(old_key->terminal_ace_id(), flow);
     }
+    ace_flow_map_[key->terminal_ace_id()].insert(flow);
     if (id_list->size()) {
         AclEntryIDList::const_iterator id_it;
         for (id_it = id_list->begin(); id_it != id_list->end(); ++id_it) {
@@ -1416,21 +1448,78 @@ bool AclFlowMgmtEntry::Add(const AclEntryIDList *id_list, FlowEntry *flow,
     return FlowMgmtEntry::Add(flow, node);
 }
 
-bool AclFlowMgmtEntry::Delete(const AclEntryIDList *id_list, FlowEntry *flow,
+bool AclFlowMgmtEntry::Delete(const AclFlowMgmtKey *key, FlowEntry *flow,
                               FlowMgmtKeyNode *node) {
-    if (id_list->size()) {
-        DecrementAceIdCountMap(id_list);
+    if (key->ace_id_list()->size()) {
+        DecrementAceIdCountMap(key->ace_id_list());
     }
+    DeleteFromAceFlowMap(key->terminal_ace_id(), flow);
     return FlowMgmtEntry::Delete(flow, node);
 }
 
+// A change in rules only affects flows which did not stop at a terminal rule
+// before the first rule changed. Flows stopping at an unchanged rule are not
+// revaluated, rest of the flows are revaluated
+bool AclFlowMgmtEntry::OperEntryAdd(FlowMgmtManager *mgr,
+                                    const FlowMgmtRequest *req,
+                                    FlowMgmtKey *key) {
+    const AclFlowMgmtRequest *acl_req =
+        dynamic_cast<const AclFlowMgmtRequest *>(req);
+    if (acl_req == NULL) {
+        return FlowMgmtEntry::OperEntryAdd(mgr, req, key);
+    }
+
+    oper_state_ = OPER_ADD_SEEN;
+    FlowEvent::Event event = req->GetResponseEvent();
+    if (event == FlowEvent::INVALID)
+        return false;
+
+    const AclDBEntry::AceIdSet &unchanged_aces = acl_req->unchanged_aces();
+    revaluate_count_ = 0;
+    revaluate_skip_count_ = 0;
+    AceFlowMap::iterator it = ace_flow_map_.begin();
+    for (; it != ace_flow_map_.end(); it++) {
+        if (it->first.empty() == false &&
+            unchanged_aces.find(it->first) != unchanged_aces.end()) {
+            revaluate_skip_count_ += it->second.size();
+            continue;
+        }
+
+        FlowSet::iterator flow_it = it->second.begin();
+        for (; flow_it != it->second.end(); flow_it++) {
+            mgr->DBEntryEvent(event, key, *flow_it);
+            revaluate_count_++;
+        }
+    }
+    mgr->UpdateAclRevaluateStats(revaluate_count_, revaluate_skip_count_);
+    return true;
+}
+
 void AclFlowMgmtTree::ExtractKeys(FlowEntry *flow, FlowMgmtKeyTree *tree,
                                   const MatchAclParamsList *acl_list) {
     std::list<MatchAclParams>::const_iterator it;
     for (it = acl_list->begin(); it != acl_list->end(); it++) {
+        std::string terminal_ace_id;
+        if (it->terminal_rule && it->ace_id_list.size()) {
+            terminal_ace_id = it->ace_id_list.back().id_;
+        }
         AclFlowMgmtKey *key = new AclFlowMgmtKey(it->acl.get(),
-                                                 &it->ace_id_list);
-        AddFlowMgmtKey(tree, key);
+                                                 &it->ace_id_list,
+                                                 terminal_ace_id);
+        FlowMgmtKeyTree::iterator key_it = tree->find(key);
+        if (key_it == tree->end()) {
+            AddFlowMgmtKey(tree, key);
+            continue;
+        }
+
+        // ACL is applied more than once for the flow. Revaluate flow on
+        // any change unless all of them stop at same terminal rule
+        AclFlowMgmtKey *existing_key =
+            static_cast<AclFlowMgmtKey *>(key_it->first);
+        if (existing_key->terminal_ace_id() != terminal_ace_id) {
+            existing_key->set_terminal_ace_id(std::string());
+        }
+        delete key;
     }
 }
 
@@ -1460,12 +1549,8 @@ bool AclFlowMgmtTree::Add(FlowMgmtKey *key, FlowEntry *flow,
     }
 
     AclFlowMgmtKey *acl_key = static_cast<AclFlowMgmtKey *>(key);
-    const AclEntryIDList *old_ace_id_list = NULL;
-    if (old_key) {
-        AclFlowMgmtKey *old_acl_key = static_cast<AclFlowMgmtKey *>(old_key);
-        old_ace_id_list = old_acl_key->ace_id_list();
-    }
-    return entry->Add(acl_key->ace_id_list(), flow, old_ace_id_list, node);
+    AclFlowMgmtKey *old_acl_key = static_cast<AclFlowMgmtKey *>(old_key);
+    return entry->Add(acl_key, flow, old_acl_key, node);
 }
 
 bool AclFlowMgmtTree::Delete(FlowMgmtKey *key, FlowEntry *flow,
@@ -1477,7 +1562,7 @@ bool AclFlowMgmtTree::Delete(FlowMgmtKey *key, FlowEntry *flow,
 
     AclFlowMgmtKey *acl_key = static_cast<AclFlowMgmtKey *>(key);
     AclFlowMgmtEntry *entry = static_cast<AclFlowMgmtEntry *>(it->second);
-    bool ret = entry->Delete(acl_key->ace_id_list(), flow, node);
+    bool ret = entry->Delete(acl_key, flow, node);
 
     TryDelete(it->first, entry);
     return ret;
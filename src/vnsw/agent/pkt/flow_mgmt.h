@@ -441,41 +441,73 @@ public:
             ace_id_list_ = *ace_id_list;
         }
     }
+    AclFlowMgmtKey(const AclDBEntry *acl, const AclEntryIDList *ace_id_list,
+                   const std::string &terminal_ace_id) :
+        FlowMgmtKey(FlowMgmtKey::ACL, acl), terminal_ace_id_(terminal_ace_id) {
+        if (ace_id_list) {
+            ace_id_list_ = *ace_id_list;
+        }
+    }
     virtual ~AclFlowMgmtKey() { }
     virtual FlowMgmtKey *Clone() {
         return new AclFlowMgmtKey(static_cast<const AclDBEntry *>(db_entry()),
-                                  &ace_id_list_);
+                                  &ace_id_list_, terminal_ace_id_);
     }
     const AclEntryIDList *ace_id_list() const { return &ace_id_list_; }
     void set_ace_id_list(const AclEntryIDList *list) {
         ace_id_list_ = *list;
     }
+    // Id of the terminal rule matched, empty if flow did not match a
+    // terminal rule in the ACL
+    const std::string &terminal_ace_id() const { return terminal_ace_id_; }
+    void set_terminal_ace_id(const std::string &id) { terminal_ace_id_ = id; }
 private:
     AclEntryIDList ace_id_list_;
+    std::string terminal_ace_id_;
     DISALLOW_COPY_AND_ASSIGN(AclFlowMgmtKey);
 };
 
 class AclFlowMgmtEntry : public FlowMgmtEntry {
 public:
     typedef std::map<std::string, int> AceIdFlowCntMap;
-    AclFlowMgmtEntry() : FlowMgmtEntry() { }
+    typedef std::set<FlowEntry *> FlowSet;
+    // Flows indexed by the terminal rule matched. Flows not matching a
+    // terminal rule are indexed with empty id
+    typedef std::map<std::string, FlowSet> AceFlowMap;
+
+    AclFlowMgmtEntry() :
+        FlowMgmtEntry(), flow_miss_(0), revaluate_count_(0),
+        revaluate_skip_count_(0) {
+    }
     virtual ~AclFlowMgmtEntry() { }
     void FillAclFlowSandeshInfo(const AclDBEntry *acl, AclFlowResp &data,
                                 const int last_count, Agent *agent);
     void FillAceFlowSandeshInfo(const AclDBEntry *acl, AclFlowCountResp &data,
                                 const std::string &ace_id);
-    bool Add(const AclEntryIDList *ace_id_list, FlowEntry *flow,
-             const AclEntryIDList *old_id_list, FlowMgmtKeyNode *node);
-    bool Delete(const AclEntryIDList *ace_id_list, FlowEntry *flow,
+    bool Add(const AclFlowMgmtKey *key, FlowEntry *flow,
+             const AclFlowMgmtKey *old_key, FlowMgmtKeyNode *node);
+    bool Delete(const AclFlowMgmtKey *key, FlowEntry *flow,
                 FlowMgmtKeyNode *node);
     void DecrementAceIdCountMap(const AclEntryIDList *id_list);
+    // Revaluate only the flows affected by rules changed in the ACL
+    virtual bool OperEntryAdd(FlowMgmtManager *mgr, const FlowMgmtRequest *req,
+                              FlowMgmtKey *key);
+
+    // Flows revaluated and skipped on the last change of ACL
+    uint32_t revaluate_count() const { return revaluate_count_; }
+    uint32_t revaluate_skip_count() const { return revaluate_skip_count_; }
 private:
     std::string GetAceSandeshDataKey(const AclDBEntry *acl,
                                      const std::string &ace_id);
     std::string GetAclFlowSandeshDataKey(const AclDBEntry *acl,
                                          const int last_count) const;
+    void DeleteFromAceFlowMap(const std::string &ace_id, FlowEntry *flow);
+
     uint32_t flow_miss_;
     AceIdFlowCntMap aceid_cnt_map_;
+    AceFlowMap ace_flow_map_;
+    uint32_t revaluate_count_;
+    uint32_t revaluate_skip_count_;
     DISALLOW_COPY_AND_ASSIGN(AclFlowMgmtEntry);
 };
 
@@ -1143,6 +1175,8 @@ public:
                               uint32_t oflow_bytes,
                               const boost::uuids::uuid &u);
     void AddDBEntryEvent(const DBEntry *entry, uint32_t gen_id);
+    void AddAclEvent(const AclDBEntry *acl, uint32_t gen_id,
+                     AclDBEntry::AceIdSet *unchanged_aces);
     void ChangeDBEntryEvent(const DBEntry *entry, uint32_t gen_id);
     void DeleteDBEntryEvent(const DBEntry *entry, uint32_t gen_id);
     void RouteNHChangeEvent(const DBEntry *entry, uint32_t gen_id);
@@ -1180,6 +1214,14 @@ public:
     InetRouteFlowMgmtTree* ip4_route_flow_mgmt_tree() {
         return &ip4_route_flow_mgmt_tree_;
     }
+    AclFlowMgmtTree* acl_flow_mgmt_tree() { return &acl_flow_mgmt_tree_; }
+
+    // Flows revaluated and skipped on ACL changes
+    void UpdateAclRevaluateStats(uint32_t revaluated, uint32_t skipped);
+    uint64_t acl_revaluate_count() const { return acl_revaluate_count_; }
+    uint64_t acl_revaluate_skip_count() const {
+        return acl_revaluate_skip_count_;
+    }
 
     BgpAsAServiceFlowMgmtKey *FindBgpAsAServiceInfo(
                                 FlowEntry *flow,
@@ -1225,6 +1267,8 @@ private:
     std::auto_ptr<FlowMgmtDbClient> flow_mgmt_dbclient_;
     FlowMgmtQueue request_queue_;
     FlowMgmtQueue db_event_queue_;
+    uint64_t acl_revaluate_count_;
+    uint64_t acl_revaluate_skip_count_;
     static FlowMgmtQueue *log_queue_;
     DISALLOW_COPY_AND_ASSIGN(FlowMgmtManager);
 };
@@ -301,7 +301,14 @@ void FlowMgmtDbClient::AclNotify(DBTablePartBase *part, DBEntryBase *e) {
         e->SetState(part->parent(), acl_listener_id_, state);
     }
     state->deleted_ = false;
-    AddEvent(acl, state);
+
+    // Revaluate all flows if notified without a change in rules
+    AclDBEntry::AceIdSet unchanged_aces;
+    if (acl->change_gen() != state->change_gen_) {
+        acl->GetUnchangedAces(state->change_gen_, &unchanged_aces);
+        state->change_gen_ = acl->change_gen();
+    }
+    mgr_->AddAclEvent(acl, state->gen_id_, &unchanged_aces);
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -100,8 +100,10 @@ public:
     };
 
     struct AclFlowHandlerState : public FlowMgmtState {
-        AclFlowHandlerState() { }
+        AclFlowHandlerState() : change_gen_(0) { }
         virtual ~AclFlowHandlerState() { }
+        // Generation of rule changes in the ACL last notified
+        uint32_t change_gen_;
     };
 
     FlowMgmtDbClient(Agent *agent, FlowMgmtManager *mgr);
@@ -184,4 +184,24 @@ private:
     boost::uuids::uuid health_check_uuid_;
     DISALLOW_COPY_AND_ASSIGN(BgpAsAServiceFlowMgmtRequest);
 };
+
+// Add/Change of an ACL. Carries the ace ids not affected by rule changes
+// since the last request, flows that stopped at a terminal rule with one of
+// these ids need not be revaluated
+class AclFlowMgmtRequest : public FlowMgmtRequest {
+public:
+    AclFlowMgmtRequest(const AclDBEntry *acl, uint32_t gen_id,
+                       AclDBEntry::AceIdSet *unchanged_aces) :
+        FlowMgmtRequest(FlowMgmtRequest::ADD_DBENTRY, acl, gen_id) {
+        unchanged_aces_.swap(*unchanged_aces);
+    }
+    virtual ~AclFlowMgmtRequest() { }
+    const AclDBEntry::AceIdSet &unchanged_aces() const {
+        return unchanged_aces_;
+    }
+
+private:
+    AclDBEntry::AceIdSet unchanged_aces_;
+    DISALLOW_COPY_AND_ASSIGN(AclFlowMgmtRequest);
+};
 #endif //  __AGENT_FLOW_MGMT_REQUEST_H__
@@ -25,8 +25,6 @@ FlowProto::FlowProto(Agent *agent, boost::asio::io_service &io) :
     ksync_tokens_("KSync` Tokens", this, agent->flow_ksync_tokens()),
     del_tokens_("Delete Tokens", this, agent->flow_del_tokens()),
     update_tokens_("Update Tokens", this, agent->flow_update_tokens()),
-    flow_update_queue_(agent, this, &update_tokens_,
-                       agent->params()->flow_task_latency_limit(), 16),
     use_vrouter_hash_(false), ipv4_trace_filter_(), ipv6_trace_filter_(),
     stats_(),
     port_table_manager_(agent, agent->params()->fabric_snat_hash_table_size()),
@@ -63,6 +61,10 @@ FlowProto::FlowProto(Agent *agent, boost::asio::io_service &io) :
             (new KSyncFlowEventQueue(agent, this, flow_table_list_[i],
                                      &ksync_tokens_, latency,
                                      FlowEventQueue::Queue::kMaxIterations));
+
+        flow_update_queue_.push_back
+            (new UpdateFlowEventQueue(agent, this, i, &update_tokens_,
+                                      latency, 16));
     }
     if (::getenv("USE_VROUTER_HASH") != NULL) {
         string opt = ::getenv("USE_VROUTER_HASH");
@@ -78,6 +80,7 @@ FlowProto::~FlowProto() {
     STLDeleteValues(&flow_tokenless_queue_);
     STLDeleteValues(&flow_delete_queue_);
     STLDeleteValues(&flow_ksync_queue_);
+    STLDeleteValues(&flow_update_queue_);
     STLDeleteValues(&flow_table_list_);
 }
 
@@ -113,8 +116,8 @@ void FlowProto::Shutdown() {
         flow_tokenless_queue_[i]->Shutdown();
         flow_delete_queue_[i]->Shutdown();
         flow_ksync_queue_[i]->Shutdown();
+        flow_update_queue_[i]->Shutdown();
     }
-    flow_update_queue_.Shutdown();
     if (stats_update_timer_) {
         stats_update_timer_->Cancel();
         TimerManager::DeleteTimer(stats_update_timer_);
@@ -234,7 +237,9 @@ void FlowProto::DisableFlowEventQueue(uint32_t index, bool disabled) {
 }
 
 void FlowProto::DisableFlowUpdateQueue(bool disabled) {
-    flow_update_queue_.set_disable(disabled);
+    for (uint32_t i = 0; i < flow_update_queue_.size(); i++) {
+        flow_update_queue_[i]->set_disable(disabled);
+    }
 }
 
 void FlowProto::DisableFlowKSyncQueue(uint32_t index, bool disabled) {
@@ -242,7 +247,15 @@ void FlowProto::DisableFlowKSyncQueue(uint32_t index, bool disabled) {
 }
 
 size_t FlowProto::FlowUpdateQueueLength() {
-    return flow_update_queue_.Length();
+    size_t length = 0;
+    for (uint32_t i = 0; i < flow_update_queue_.size(); i++) {
+        length += flow_update_queue_[i]->Length();
+    }
+    return length;
+}
+
+void FlowProto::UpdateFlowEventDone(uint32_t shard) {
+    update_dispatcher_.Done(shard);
 }
 
 void FlowProto::DisableFlowDeleteQueue(uint32_t index, bool disabled) {
@@ -379,8 +392,9 @@ void FlowProto::EnqueueFlowEvent(FlowEvent *event) {
     case FlowEvent::DELETE_DBENTRY:
     case FlowEvent::RECOMPUTE_FLOW:
     case FlowEvent::REVALUATE_DBENTRY: {
-        queue = &flow_update_queue_;
-        break;
+        UpdateStats(event, &stats_);
+        update_dispatcher_.Enqueue(flow_update_queue_, event);
+        return;
     }
 
     case FlowEvent::UNRESOLVED_FLOW_ENTRY: {
@@ -754,7 +768,9 @@ void FlowProto::TokenAvailable(TokenPool *pool_base) {
     }
 
     if (pool == &update_tokens_) {
-        flow_update_queue_.MayBeStartRunner();
+        for (uint32_t i = 0; i < flow_update_queue_.size(); i++) {
+            flow_update_queue_[i]->MayBeStartRunner();
+        }
     }
 }
 
@@ -860,6 +876,7 @@ void FlowProto::SetProfileData(ProfileData *data) {
     data->flow_.flow_delete_queue_.resize(flow_table_list_.size());
     data->flow_.flow_tokenless_queue_.resize(flow_table_list_.size());
     data->flow_.flow_ksync_queue_.resize(flow_table_list_.size());
+    data->flow_.flow_update_queue_.resize(flow_table_list_.size());
     for (uint16_t i = 0; i < flow_table_list_.size(); i++) {
         SetFlowMgmtQueueStats(agent(), mgr_list[i]->request_queue(),
                               &data->flow_.flow_mgmt_queue_);
@@ -871,9 +888,9 @@ void FlowProto::SetProfileData(ProfileData *data) {
                                &data->flow_.flow_tokenless_queue_[i]);
         SetFlowEventQueueStats(agent(), flow_ksync_queue_[i]->queue(),
                                &data->flow_.flow_ksync_queue_[i]);
+        SetFlowEventQueueStats(agent(), flow_update_queue_[i]->queue(),
+                               &data->flow_.flow_update_queue_[i]);
     }
-    SetFlowEventQueueStats(agent(), flow_update_queue_.queue(),
-                           &data->flow_.flow_update_queue_);
     const PktHandler::PktHandlerQueue *pkt_queue =
         pkt->pkt_handler()->work_queue();
     SetPktHandlerQueueStats(agent(), pkt_queue,
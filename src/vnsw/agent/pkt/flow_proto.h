@@ -103,6 +103,10 @@ public:
     void DisableFlowKSyncQueue(uint32_t index, bool disabled);
     void DisableFlowDeleteQueue(uint32_t index, bool disabled);
     size_t FlowUpdateQueueLength();
+    void UpdateFlowEventDone(uint32_t shard);
+    const UpdateFlowEventDispatcher *update_dispatcher() const {
+        return &update_dispatcher_;
+    }
 
     const FlowStats *flow_stats() const { return &stats_; }
 
@@ -148,7 +152,8 @@ private:
     std::vector<DeleteFlowEventQueue *> flow_delete_queue_;
     std::vector<KSyncFlowEventQueue *> flow_ksync_queue_;
     std::vector<FlowTable *> flow_table_list_;
-    UpdateFlowEventQueue flow_update_queue_;
+    std::vector<UpdateFlowEventQueue *> flow_update_queue_;
+    UpdateFlowEventDispatcher update_dispatcher_;
     tbb::atomic<int> linklocal_flow_count_;
     bool use_vrouter_hash_;
     FlowTraceFilter ipv4_trace_filter_;
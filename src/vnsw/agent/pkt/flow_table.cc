@@ -129,7 +129,7 @@ FlowEntry *FlowTable::Find(const FlowKey &key) {
 
     it = flow_entry_map_.find(key);
     if (it != flow_entry_map_.end()) {
-        return it->second;
+        return *it;
     } else {
         return NULL;
     }
@@ -146,14 +146,14 @@ void FlowTable::Copy(FlowEntry *lhs, FlowEntry *rhs, bool update) {
 FlowEntry *FlowTable::Locate(FlowEntry *flow, uint64_t time) {
     assert(ConcurrencyCheck(flow_task_id_) == true);
     std::pair<FlowEntryMap::iterator, bool> ret;
-    ret = flow_entry_map_.insert(FlowEntryMapPair(flow->key(), flow));
+    ret = flow_entry_map_.insert(flow);
     if (ret.second == true) {
         agent_->stats()->incr_flow_created();
-        ret.first->second->set_on_tree();
+        flow->set_on_tree();
         return flow;
     }
 
-    return ret.first->second;
+    return *ret.first;
 }
 
 void FlowTable::Add(FlowEntry *flow, FlowEntry *rflow) {
@@ -409,12 +409,17 @@ void FlowTable::DeleteAll() {
 
     it = flow_entry_map_.begin();
     while (it != flow_entry_map_.end()) {
-        FlowEntry *entry = it->second;
+        FlowEntry *entry = *it;
         FlowEntry *reverse_entry = NULL;
         ++it;
+        // Deleting a flow can release the last reference to other flows and
+        // erase them from the table. Skip slots erased after iterator moved
+        if (entry == NULL) {
+            continue;
+        }
         if (it != flow_entry_map_.end() &&
-            it->second == entry->reverse_flow_entry()) {
-            reverse_entry = it->second;
+            *it == entry->reverse_flow_entry()) {
+            reverse_entry = *it;
             ++it;
         }
         FLOW_LOCK(entry, reverse_entry, FlowEvent::DELETE_FLOW);
@@ -37,6 +37,7 @@
 #include <pkt/pkt_init.h>
 #include <pkt/pkt_flow_info.h>
 #include <pkt/flow_entry.h>
+#include <pkt/flow_hash_table.h>
 #include <sandesh/sandesh_trace.h>
 #include <oper/vn.h>
 #include <oper/vm.h>
@@ -131,7 +132,8 @@ private:
 //   responsible to generate KSync events. It is run in a single task context
 //
 //   Functionality of FlowTable:
-//   1. Manage flow_entry_map_ which contains all flows
+//   1. Manage flow_entry_map_ which contains all flows. The flows are indexed
+//      in a FlowEntryHashTable, so iteration is not in key order
 //   2. Enforce the per-VM flow limits
 //   3. Generate events to KSync and FlowMgmt modueles
 /////////////////////////////////////////////////////////////////////////////
@@ -142,20 +144,12 @@ struct FlowTaskMsg : public InterTaskMsg {
     FlowEntryPtr fe_ptr;
 };
 
-struct Inet4FlowKeyCmp {
-    bool operator()(const FlowKey &lhs, const FlowKey &rhs) const {
-        const FlowKey &lhs_base = static_cast<const FlowKey &>(lhs);
-        return lhs_base.IsLess(rhs);
-    }
-};
-
 class FlowTable {
 public:
     static const uint32_t kPortNatFlowTableInstance = 0;
     static const uint32_t kInvalidFlowTableInstance = 0xFF;
 
-    typedef std::map<FlowKey, FlowEntry *, Inet4FlowKeyCmp> FlowEntryMap;
-    typedef std::pair<FlowKey, FlowEntry *> FlowEntryMapPair;
+    typedef FlowEntryHashTable FlowEntryMap;
     typedef boost::function<bool(FlowEntry *flow)> FlowEntryCb;
     typedef std::vector<FlowEntryPtr> FlowIndexTree;
 
@@ -203,6 +197,7 @@ public:
     FlowTable::FlowEntryMap::iterator end() {
         return flow_entry_map_.end();
     }
+    const FlowEntryMap &flow_entry_map() const { return flow_entry_map_; }
 
     const LinkLocalFlowInfoMap &linklocal_flow_info_map() {
         return linklocal_flow_info_map_;
@@ -8,9 +8,16 @@
 
 PacketBufferManager::PacketBufferManager(PktModule *pkt_module) :
     alloc_(0), free_(0), pkt_module_(pkt_module) {
+    pool_free_count_ = 0;
+    pool_alloc_count_ = 0;
+    pool_miss_count_ = 0;
 }
 
 PacketBufferManager::~PacketBufferManager() {
+    uint8_t *buff;
+    while (pool_.try_pop(buff)) {
+        delete [] buff;
+    }
 }
 
 PacketBufferPtr PacketBufferManager::Allocate(uint32_t module, uint16_t len,
@@ -31,6 +38,34 @@ PacketBufferPtr PacketBufferManager::Allocate(uint32_t module, uint8_t *buff,
     return ptr;
 }
 
+PacketBufferPtr PacketBufferManager::AllocatePooled(uint32_t module,
+                                                    uint16_t len,
+                                                    uint32_t mdata) {
+    assert(len <= kPoolBufferLen);
+    uint8_t *buff = NULL;
+    if (pool_.try_pop(buff)) {
+        pool_free_count_--;
+    } else {
+        buff = new uint8_t[kPoolBufferLen];
+        pool_miss_count_++;
+    }
+    pool_alloc_count_++;
+
+    boost::shared_array<uint8_t> array(buff, PoolDeleter(this));
+    PacketBufferPtr ptr(new PacketBuffer(this, module, array, len, mdata));
+    alloc_++;
+    return ptr;
+}
+
+void PacketBufferManager::ReleasePooled(uint8_t *buff) {
+    if (pool_free_count_.fetch_and_increment() >= kMaxPoolBuffers) {
+        pool_free_count_--;
+        delete [] buff;
+        return;
+    }
+    pool_.push(buff);
+}
+
 void PacketBufferManager::FreeIndication(PacketBuffer *pkt) {
     free_++;
 }
@@ -48,6 +83,13 @@ PacketBuffer::PacketBuffer(PacketBufferManager *mgr, uint32_t module,
     data_len_(data_len), module_(module), mdata_(mdata), mgr_(mgr) {
 }
 
+PacketBuffer::PacketBuffer(PacketBufferManager *mgr, uint32_t module,
+                           const boost::shared_array<uint8_t> &buff,
+                           uint16_t len, uint32_t mdata) :
+    buffer_(buff), buffer_len_(len), data_(buffer_.get()), data_len_(len),
+    module_(module), mdata_(mdata), mgr_(mgr) {
+}
+
 PacketBuffer::~PacketBuffer() {
     mgr_->FreeIndication(this);
     data_ = NULL;
@@ -9,6 +9,8 @@
 #include <stdint.h>
 #include <boost/shared_ptr.hpp>
 #include <boost/shared_array.hpp>
+#include <tbb/atomic.h>
+#include <tbb/concurrent_queue.h>
 #include <base/util.h>
 
 class PacketBuffer;
@@ -44,6 +46,11 @@ private:
                  uint16_t len, uint16_t data_offset, uint16_t data_len,
                  uint32_t mdata);
 
+    // Create PacketBuffer from memory with a custom deleter
+    PacketBuffer(PacketBufferManager *mgr, uint32_t module,
+                 const boost::shared_array<uint8_t> &buff, uint16_t len,
+                 uint32_t mdata);
+
     boost::shared_array<uint8_t> buffer_;
     uint16_t buffer_len_;
 
@@ -56,8 +63,15 @@ private:
     DISALLOW_COPY_AND_ASSIGN(PacketBuffer);
 };
 
+// PacketBufferManager keeps a pool of fixed size buffers for packets
+// received from the control interface. A pooled buffer goes back to the pool
+// when the last reference to it is released, which can happen in any task.
+// The pool keeps upto kMaxPoolBuffers free buffers, the rest are freed.
 class PacketBufferManager {
 public:
+    static const uint16_t kPoolBufferLen = 9216;
+    static const uint32_t kMaxPoolBuffers = 1024;
+
     PacketBufferManager(PktModule *pkt_module);
     virtual ~PacketBufferManager();
 
@@ -66,14 +80,35 @@ public:
     PacketBufferPtr Allocate(uint32_t module, uint8_t *buff, uint16_t len,
                              uint16_t data_offset, uint16_t data_len,
                              uint32_t mdata);
+
+    // Allocate packet buffer of len bytes from the pool
+    PacketBufferPtr AllocatePooled(uint32_t module, uint16_t len,
+                                   uint32_t mdata);
+
+    uint32_t pool_free_count() const { return pool_free_count_; }
+    uint64_t pool_alloc_count() const { return pool_alloc_count_; }
+    uint64_t pool_miss_count() const { return pool_miss_count_; }
+
 private:
     friend class PacketBuffer;
+    struct PoolDeleter {
+        explicit PoolDeleter(PacketBufferManager *mgr) : mgr_(mgr) { }
+        void operator()(uint8_t *buff) const { mgr_->ReleasePooled(buff); }
+        PacketBufferManager *mgr_;
+    };
+
     void FreeIndication(PacketBuffer *);
+    void ReleasePooled(uint8_t *buff);
 
     uint64_t alloc_;
     uint64_t free_;
     PktModule *pkt_module_;
 
+    tbb::concurrent_queue<uint8_t *> pool_;
+    tbb::atomic<uint32_t> pool_free_count_;
+    tbb::atomic<uint64_t> pool_alloc_count_;
+    tbb::atomic<uint64_t> pool_miss_count_;
+
     DISALLOW_COPY_AND_ASSIGN(PacketBufferManager);
 };
 
@@ -312,20 +312,46 @@ PktHandler::PktModuleName PktHandler::ParsePacket(const AgentHdr &hdr,
 void PktHandler::HandleRcvPkt(const AgentHdr &hdr, const PacketBufferPtr &buff){
     // Enqueue packets to a workqueue to decouple from ASIO and run in
     // exclusion with DB
-    boost::shared_ptr<PacketBufferEnqueueItem>
-        info(new PacketBufferEnqueueItem(hdr, buff));
-    work_queue_.Enqueue(info);
+    boost::shared_ptr<PacketBufferBatch> batch(new PacketBufferBatch());
+    batch->push_back(PacketBufferEnqueueItem(hdr, buff));
+    work_queue_.Enqueue(batch);
+}
 
+void PktHandler::HandleRcvPktBatch(PacketBufferBatch *batch) {
+    if (batch->empty())
+        return;
+    boost::shared_ptr<PacketBufferBatch> item(new PacketBufferBatch());
+    item->swap(*batch);
+    work_queue_.Enqueue(item);
 }
 
-bool PktHandler::ProcessPacket(boost::shared_ptr<PacketBufferEnqueueItem> item) {
-    agent_->stats()->incr_pkt_exceptions();
-    const AgentHdr &hdr = item->hdr;
-    const PacketBufferPtr &buff = item->buff;
-    boost::shared_ptr<PktInfo> pkt_info (new PktInfo(buff));
-    uint8_t *pkt = buff->data();
-    PktModuleName mod = ParsePacket(hdr, pkt_info.get(), pkt);
-    PktModuleEnqueue(mod, hdr, pkt_info, pkt);
+// Parse all packets in the batch first and then dispatch them module by
+// module, preserving the order of packets for each module
+bool PktHandler::ProcessPacket(boost::shared_ptr<PacketBufferBatch> batch) {
+    for (PacketBufferBatch::const_iterator it = batch->begin();
+         it != batch->end(); ++it) {
+        agent_->stats()->incr_pkt_exceptions();
+        const AgentHdr &hdr = it->hdr;
+        const PacketBufferPtr &buff = it->buff;
+        boost::shared_ptr<PktInfo> pkt_info (new PktInfo(buff));
+        uint8_t *pkt = buff->data();
+        PktModuleName mod = ParsePacket(hdr, pkt_info.get(), pkt);
+        if (mod == INVALID) {
+            PktModuleEnqueue(mod, hdr, pkt_info, pkt);
+            continue;
+        }
+        module_batch_.at(mod).push_back(pkt_info);
+    }
+
+    for (int mod = 0; mod < MAX_MODULES; ++mod) {
+        PktInfoList &list = module_batch_[mod];
+        for (PktInfoList::iterator it = list.begin(); it != list.end(); ++it) {
+            PktModuleEnqueue(static_cast<PktModuleName>(mod),
+                             (*it)->agent_hdr, *it,
+                             (*it)->packet_buffer()->data());
+        }
+        list.clear();
+    }
     return true;
 }
 
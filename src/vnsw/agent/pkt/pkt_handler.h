@@ -253,14 +253,17 @@ public:
     };
 
     struct PacketBufferEnqueueItem {
-        const AgentHdr hdr;
-        const PacketBufferPtr buff;
+        AgentHdr hdr;
+        PacketBufferPtr buff;
 
         PacketBufferEnqueueItem(const AgentHdr &h, const PacketBufferPtr &b)
             : hdr(h), buff(b) {}
     };
-    typedef WorkQueue<boost::shared_ptr<PacketBufferEnqueueItem> >
-        PktHandlerQueue;
+    // Packets read from the control interface in one batch. A batch is
+    // enqueued to the work queue as a single entry
+    typedef std::vector<PacketBufferEnqueueItem> PacketBufferBatch;
+    typedef WorkQueue<boost::shared_ptr<PacketBufferBatch> > PktHandlerQueue;
+    typedef std::vector<boost::shared_ptr<PktInfo> > PktInfoList;
 
     PktHandler(Agent *, PktModule *pkt_module);
     virtual ~PktHandler();
@@ -274,9 +277,11 @@ public:
                               uint8_t *pkt);
     int ParseUserPkt(PktInfo *pkt_info, Interface *intf,
                      PktType::Type &pkt_type, uint8_t *pkt);
-    bool ProcessPacket(boost::shared_ptr<PacketBufferEnqueueItem> item);
+    bool ProcessPacket(boost::shared_ptr<PacketBufferBatch> batch);
 // identify pkt type and send to the registered handler
     void HandleRcvPkt(const AgentHdr &hdr, const PacketBufferPtr &buff);
+    // Enqueue all packets in the batch, batch is empty on return
+    void HandleRcvPktBatch(PacketBufferBatch *batch);
     void SendMessage(PktModuleName mod, InterTaskMsg *msg);
 
     bool IsGwPacket(const Interface *intf, const IpAddress &dst_ip);
@@ -339,6 +344,8 @@ private:
     bool IsDiagPacket(PktInfo *pkt_info);
 
     boost::array<Proto *, MAX_MODULES> proto_list_;
+    // Packets of a batch parsed for each module, used in ProcessPacket
+    boost::array<PktInfoList, MAX_MODULES> module_batch_;
 
     PktStats stats_;
     boost::array<PktTrace, MAX_MODULES> pkt_trace_;
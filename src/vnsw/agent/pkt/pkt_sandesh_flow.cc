@@ -255,6 +255,20 @@ PktSandeshFlow::PktSandeshFlow(Agent *agent, FlowRecordsResp *obj,
 PktSandeshFlow::~PktSandeshFlow() {
 }
 
+// Flows are not kept in key order. A walk with null key (start_key, or the
+// key set when moving to next partition) begins at first flow in the table,
+// else it resumes after the last flow sent
+FlowTable::FlowEntryMap::iterator
+PktSandeshFlow::FlowIterationStart(FlowTable *table) const {
+    const FlowKey &key = flow_iteration_key_;
+    if (key.nh == 0 && key.src_port == 0 && key.dst_port == 0 &&
+        key.protocol == 0 && key.src_addr == IpAddress(Ip4Address(0)) &&
+        key.dst_addr == IpAddress(Ip4Address(0))) {
+        return table->flow_entry_map_.begin();
+    }
+    return table->flow_entry_map_.upper_bound(key);
+}
+
 void PktSandeshFlow::SetSandeshFlowData(std::vector<SandeshFlowData> &list,
                                         FlowEntry *fe, const FlowExportInfo *info) {
     SandeshFlowData data;
@@ -348,7 +362,7 @@ bool PktSandeshFlow::Run() {
     }
 
     if (key_valid_)  {
-        it = flow_obj->flow_entry_map_.upper_bound(flow_iteration_key_);
+        it = FlowIterationStart(flow_obj);
     } else {
          FlowErrorResp *resp = new FlowErrorResp();
          SendResponse(resp);
@@ -362,7 +376,7 @@ bool PktSandeshFlow::Run() {
     }
 
     while (it != flow_obj->flow_entry_map_.end()) {
-        FlowEntry *fe = it->second;
+        FlowEntry *fe = *it;
         FlowStatsCollector *fec = fe->fsc();
         const FlowExportInfo *info = NULL;
         if (fec) {
@@ -465,7 +479,7 @@ void FetchFlowRecord::HandleRequest() const {
     SandeshResponse *resp;
     if (flow_obj && it != flow_obj->flow_entry_map_.end()) {
        FlowRecordResp *flow_resp = new FlowRecordResp();
-       FlowEntry *fe = it->second;
+       FlowEntry *fe = *it;
        FlowStatsCollector *fec = fe->fsc();
        const FlowExportInfo *info = NULL;
        if (fec) {
@@ -562,7 +576,7 @@ bool PktSandeshFlowStats::Run() {
 
     FlowTable::FlowEntryMap::iterator it;
     if (key_valid_)  {
-        it = flow_obj->flow_entry_map_.upper_bound(flow_iteration_key_);
+        it = FlowIterationStart(flow_obj);
     } else {
          FlowErrorResp *resp = new FlowErrorResp();
          SendResponse(resp);
@@ -576,7 +590,7 @@ bool PktSandeshFlowStats::Run() {
     }
 
     while (it != flow_obj->flow_entry_map_.end()) {
-        FlowEntry *fe = it->second;
+        FlowEntry *fe = *it;
         const FlowExportInfo *info = NULL;
         if (fe->fsc()) {
             info = fe->fsc()->FindFlowExportInfo(fe);
@@ -30,6 +30,8 @@ public:
     void set_delete_op(bool delete_op) {delete_op_ = delete_op;}
 
 protected:
+    FlowTable::FlowEntryMap::iterator FlowIterationStart(FlowTable *table) const;
+
     FlowRecordsResp *resp_obj_;
     std::string resp_data_;
     FlowKey flow_iteration_key_;
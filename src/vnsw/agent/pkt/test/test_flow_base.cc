@@ -10,6 +10,7 @@
 #include "ksync/ksync_sock_user.h"
 #include "oper/tunnel_nh.h"
 #include "pkt/flow_table.h"
+#include "pkt/flow_mgmt.h"
 
 #define MAX_VNET 4
 
@@ -765,8 +766,35 @@ protected:
         return flow_proto_->flow_ksync_queue_[table_index];
     }
 
-    UpdateFlowEventQueue *GetUpdateFlowEventQueue() {
-        return &flow_proto_->flow_update_queue_;
+    UpdateFlowEventQueue *GetUpdateFlowEventQueue(uint32_t table_index) {
+        return flow_proto_->flow_update_queue_[table_index];
+    }
+
+    // Update events are balanced across the update queues
+    uint64_t UpdateEventsProcessed() {
+        uint64_t count = 0;
+        for (uint32_t i = 0; i < flow_proto_->flow_update_queue_.size(); i++) {
+            count += flow_proto_->flow_update_queue_[i]->events_processed();
+        }
+        return count;
+    }
+
+    uint64_t AclRevaluateCount() {
+        uint64_t count = 0;
+        for (uint32_t i = 0; i < flow_proto_->flow_table_count(); i++) {
+            FlowMgmtManager *mgr = agent_->pkt()->flow_mgmt_manager(i);
+            count += mgr->acl_revaluate_count();
+        }
+        return count;
+    }
+
+    uint64_t AclRevaluateSkipCount() {
+        uint64_t count = 0;
+        for (uint32_t i = 0; i < flow_proto_->flow_table_count(); i++) {
+            FlowMgmtManager *mgr = agent_->pkt()->flow_mgmt_manager(i);
+            count += mgr->acl_revaluate_skip_count();
+        }
+        return count;
     }
 
 protected:
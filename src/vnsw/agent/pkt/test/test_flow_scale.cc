@@ -3,6 +3,7 @@
  */
 
 #include "base/os.h"
+#include "base/time_util.h"
 #include "test/test_cmn_util.h"
 #include "test_pkt_util.h"
 #include "pkt/flow_proto.h"
@@ -101,6 +102,38 @@ TEST_F(FlowTest, FlowScaling_2) {
     EXPECT_TRUE(free_queue_->max_queue_len() <= (uint32_t)(count/4));
 }
 
+// Flow setup rate through the FlowHandler/FlowTable path. Reports the time
+// taken for count flow pairs to be set up and the flow index occupancy
+TEST_F(FlowTest, FlowScaling_SetupRate) {
+    char env[100];
+    int count = 5000;
+    if (getenv("AGENT_FLOW_SCALE_COUNT")) {
+        strcpy(env, getenv("AGENT_FLOW_SCALE_COUNT"));
+        count = strtoul(env, NULL, 0);
+    }
+
+    uint64_t start = ClockMonotonicUsec();
+    for (int i = 0; i < count; i++) {
+        Ip4Address addr(0x05000000 + i);
+        TxTcpPacket(vnet->id(), vnet_addr, addr.to_string().c_str(),
+                    1000 + (i % 1000), 80, false);
+    }
+    WAIT_FOR(count * 10, 1000, ((2 * count) ==
+                                (int) flow_proto_->FlowCount()));
+    uint64_t delay = ClockMonotonicUsec() - start;
+
+    std::cout << "Flows " << (2 * count) << " Time " << delay << " usec"
+        << " Rate " << (delay ? ((2ULL * count * 1000000) / delay) : 0)
+        << " flows/sec" << std::endl;
+    for (uint16_t i = 0; i < agent_->flow_thread_count(); i++) {
+        const FlowTable::FlowEntryMap &map =
+            flow_proto_->GetTable(i)->flow_entry_map();
+        std::cout << "FlowTable " << i << " Size " << map.size()
+            << " Capacity " << map.capacity() << " Rehash "
+            << map.rehash_count() << std::endl;
+    }
+}
+
 int main(int argc, char *argv[]) {
     int ret = 0;
 
@@ -347,6 +347,63 @@ TEST_F(TestFlowTable, ResetFlowStats) {
                                200, 1, 30, vif0->flow_key_nh()->id(), 10));
 }
 
+// Verify the flow index across growth, erase and re-insert
+TEST_F(TestFlowTable, FlowHashTable_1) {
+    FlowTable *table = flow_proto_->GetTable(0);
+    FlowEntryHashTable hash_table;
+    std::vector<FlowEntry *> flows;
+    const uint32_t count = 4 * FlowEntryHashTable::kMinCapacity;
+
+    for (uint32_t i = 0; i < count; i++) {
+        FlowKey key(i % 8, Ip4Address(0x01010101 + i), Ip4Address(0x02020202),
+                    IPPROTO_TCP, 1000 + i, 80);
+        flows.push_back(FlowEntry::Allocate(key, table));
+        EXPECT_TRUE(hash_table.insert(flows[i]).second);
+    }
+    EXPECT_EQ(count, hash_table.size());
+    EXPECT_TRUE(hash_table.capacity() > count);
+
+    // Duplicate insert returns existing entry
+    std::pair<FlowEntryHashTable::iterator, bool> ret =
+        hash_table.insert(flows[10]);
+    EXPECT_FALSE(ret.second);
+    EXPECT_EQ(flows[10], *ret.first);
+
+    uint32_t iter_count = 0;
+    for (FlowEntryHashTable::iterator it = hash_table.begin();
+         it != hash_table.end(); ++it) {
+        iter_count++;
+    }
+    EXPECT_EQ(count, iter_count);
+
+    // Erase every other flow and verify lookups
+    for (uint32_t i = 0; i < count; i += 2) {
+        EXPECT_EQ(1U, hash_table.erase(flows[i]->key()));
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        FlowEntryHashTable::iterator it = hash_table.find(flows[i]->key());
+        if (i % 2) {
+            EXPECT_TRUE(it != hash_table.end());
+            EXPECT_EQ(flows[i], *it);
+        } else {
+            EXPECT_TRUE(it == hash_table.end());
+        }
+    }
+    EXPECT_EQ(count / 2, hash_table.size());
+
+    // Re-insert erased flows
+    for (uint32_t i = 0; i < count; i += 2) {
+        EXPECT_TRUE(hash_table.insert(flows[i]).second);
+    }
+    EXPECT_EQ(count, hash_table.size());
+
+    for (uint32_t i = 0; i < count; i++) {
+        EXPECT_EQ(1U, hash_table.erase(flows[i]->key()));
+        table->free_list()->Free(flows[i]);
+    }
+    EXPECT_TRUE(hash_table.empty());
+}
+
 int main(int argc, char *argv[]) {
     int ret = 0;
     GETUSERARGS();
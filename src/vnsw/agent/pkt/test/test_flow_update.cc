@@ -39,7 +39,6 @@ public:
 
         strcpy(sg1_acl_name_, "sg_acl1" "egress-access-control-list");
         strcpy(sg2_acl_name_, "sg_acl2" "egress-access-control-list");
-        update_queue_ = GetUpdateFlowEventQueue();
         event_queue_ = GetFlowEventQueue(0);
         delete_queue_ = GetDeleteFlowEventQueue(0);
     }
@@ -61,12 +60,19 @@ public:
         FlowTest::TearDown();
     }
 
+    void DeleteAclRule(int acl_id, int ace_id) {
+        DBRequest req(DBRequest::DB_ENTRY_ADD_CHANGE);
+        req.key.reset(new AclKey(MakeUuid(acl_id)));
+        req.data.reset(new AclData(agent_, NULL, ace_id));
+        agent_->acl_table()->Enqueue(&req);
+        client->WaitForIdle();
+    }
+
 protected:
     char sg1_acl_name_[1024];
     char sg2_acl_name_[1024];
     const struct FlowStats *flow_stats_;
     FlowEventQueue *event_queue_;
-    UpdateFlowEventQueue *update_queue_;
     DeleteFlowEventQueue *delete_queue_;
 };
 
@@ -147,6 +153,40 @@ TEST_F(FlowUpdateTest, sg_change_3) {
     EXPECT_GE(flow_stats_->revaluate_count_, update_count);
 }
 
+// Flows matching a terminal rule before the rule changed are not revaluated
+TEST_F(FlowUpdateTest, sg_change_incremental_1) {
+    char subnet_str[1000];
+    sprintf(subnet_str,
+            "<subnet> <ip-prefix>16.1.1.0</ip-prefix>"
+            "<ip-prefix-len>24</ip-prefix-len></subnet>\n");
+    AddAclEntry(sg1_acl_name_, 10, 1, "pass", uuid_1, subnet_str, subnet_str);
+    AclDBEntry *acl = AclGet(10);
+    EXPECT_EQ(2U, acl->Size());
+
+    TxIpPacket(flow5->id(), vm_a_ip, vm_b_ip, 1);
+    client->WaitForIdle();
+    EXPECT_EQ(2U, flow_proto_->FlowCount());
+
+    FlowEntry *flow = FlowGet(flow5->vrf()->vrf_id(), vm_a_ip, vm_b_ip, 1, 0,
+                              0, flow5->flow_key_nh()->id());
+    EXPECT_TRUE(flow != NULL);
+    EXPECT_FALSE(flow->ActionSet(TrafficAction::DENY));
+
+    // Delete the second rule, flows stop at the first rule
+    uint64_t revaluate_count = AclRevaluateCount();
+    uint64_t skip_count = AclRevaluateSkipCount();
+    DeleteAclRule(10, atoi(acl->GetAclEntryAtIndex(1)->id().id_.c_str()));
+    EXPECT_EQ(1U, acl->Size());
+    EXPECT_EQ(revaluate_count, AclRevaluateCount());
+    EXPECT_LT(skip_count, AclRevaluateSkipCount());
+
+    // Change the first rule, flows are revaluated
+    AddAclEntry(sg1_acl_name_, 10, 1, "deny", uuid_1, subnet_str, subnet_str);
+    client->WaitForIdle();
+    EXPECT_TRUE(flow->ActionSet(TrafficAction::DENY));
+    EXPECT_LT(revaluate_count, AclRevaluateCount());
+}
+
 // Change ACL linked to a VN
 TEST_F(FlowUpdateTest, vn_change_1) {
 
@@ -186,7 +226,7 @@ TEST_F(FlowUpdateTest, multiple_change_1) {
     EXPECT_FALSE(flow->ActionSet(TrafficAction::DENY));
 
     // Enable flow-update queue and validate statistics
-    uint64_t update_count = update_queue_->events_processed();
+    uint64_t update_count = UpdateEventsProcessed();
     uint64_t event_count = event_queue_->events_processed();
 
     // Disable flow-update queue to ensure state compression
@@ -207,7 +247,7 @@ TEST_F(FlowUpdateTest, multiple_change_1) {
     client->WaitForIdle();
 
     // There can be 2 RECOMPUTE events - one for each flow
-    EXPECT_LE((update_count + 2), update_queue_->events_processed());
+    EXPECT_LE((update_count + 2), UpdateEventsProcessed());
     // There should be atmost one FLOW_MESSAGE
     EXPECT_LE((event_count + 1), event_queue_->events_processed());
 
@@ -217,6 +257,50 @@ TEST_F(FlowUpdateTest, multiple_change_1) {
     client->WaitForIdle();
 }
 
+// Update events of a flow-pair are dispatched to a single update queue and
+// the shard of the flow-pair is released once the events are processed
+TEST_F(FlowUpdateTest, update_dispatch_1) {
+    TxIpPacket(flow5->id(), vm_a_ip, vm_b_ip, 1);
+    client->WaitForIdle();
+    EXPECT_EQ(2U, flow_proto_->FlowCount());
+
+    FlowEntry *flow = FlowGet(flow5->vrf()->vrf_id(), vm_a_ip, vm_b_ip, 1, 0,
+                              0, flow5->flow_key_nh()->id());
+    EXPECT_TRUE(flow != NULL);
+    uint32_t shard = UpdateFlowEventDispatcher::ShardIndex(flow);
+    EXPECT_EQ(shard,
+              UpdateFlowEventDispatcher::ShardIndex(flow->reverse_flow_entry()));
+    const UpdateFlowEventDispatcher *dispatcher =
+        flow_proto_->update_dispatcher();
+
+    uint64_t latency_count = 0;
+    for (uint32_t i = 0; i < flow_proto_->flow_table_count(); i++) {
+        latency_count +=
+            GetUpdateFlowEventQueue(i)->latency_histogram().count();
+    }
+
+    // Disable flow-update queue to hold the events
+    flow_proto_->DisableFlowUpdateQueue(true);
+    client->WaitForIdle();
+
+    // Update interface config to use sg2
+    AddLink("virtual-machine-interface", "flow5", "security-group", "sg2");
+    client->WaitForIdle();
+    EXPECT_LT(0U, dispatcher->pending(shard));
+    EXPECT_LT(0U, flow_proto_->FlowUpdateQueueLength());
+
+    flow_proto_->DisableFlowUpdateQueue(false);
+    client->WaitForIdle();
+    EXPECT_EQ(0U, dispatcher->pending(shard));
+    EXPECT_EQ(0U, flow_proto_->FlowUpdateQueueLength());
+
+    uint64_t count = 0;
+    for (uint32_t i = 0; i < flow_proto_->flow_table_count(); i++) {
+        count += GetUpdateFlowEventQueue(i)->latency_histogram().count();
+    }
+    EXPECT_LT(latency_count, count);
+}
+
 // Test for delete state-compressing pending changes for a flow-entry
 TEST_F(FlowUpdateTest, multiple_change_delete_1) {
     TxIpPacket(flow5->id(), vm_a_ip, vm_b_ip, 1);
@@ -229,7 +313,7 @@ TEST_F(FlowUpdateTest, multiple_change_delete_1) {
     EXPECT_FALSE(flow->ActionSet(TrafficAction::DENY));
 
     // Enable flow-update queue and validate statistics
-    uint64_t update_count = update_queue_->events_processed();
+    uint64_t update_count = UpdateEventsProcessed();
 
     uint64_t delete_count = delete_queue_->events_processed();
 
@@ -251,10 +335,10 @@ TEST_F(FlowUpdateTest, multiple_change_delete_1) {
     client->WaitForIdle();
 
     // Ensure that only one recompute is done
-    EXPECT_LE((update_count + 2), update_queue_->events_processed());
+    EXPECT_LE((update_count + 2), UpdateEventsProcessed());
     EXPECT_EQ((delete_count), delete_queue_->events_processed());
 
-    update_count = update_queue_->events_processed();
+    update_count = UpdateEventsProcessed();
     // Disable flow-update queue before deleting ACL
     flow_proto_->DisableFlowUpdateQueue(true);
     client->WaitForIdle();
@@ -270,7 +354,7 @@ TEST_F(FlowUpdateTest, multiple_change_delete_1) {
 
     // Update queue has following events,
     // - 2 DELETE_DBENTRY delete for flows
-    EXPECT_LE((update_count + 2), update_queue_->events_processed());
+    EXPECT_LE((update_count + 2), UpdateEventsProcessed());
     EXPECT_EQ(delete_count, delete_queue_->events_processed());
 }
 
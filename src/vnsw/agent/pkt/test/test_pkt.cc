@@ -253,6 +253,49 @@ TEST_F(PktTest, tx_vlan_1) {
     client->WaitForIdle();
 }
 
+// Buffers released to the pool are reused
+TEST_F(PktTest, PacketBufferPool_1) {
+    PacketBufferManager *mgr = agent_->pkt()->packet_buffer_manager();
+    PacketBufferPtr pkt = mgr->AllocatePooled(PktHandler::RX_PACKET, 1024, 0);
+    EXPECT_EQ(1024, pkt->data_len());
+    uint64_t miss = mgr->pool_miss_count();
+    pkt.reset();
+    EXPECT_LT(0U, mgr->pool_free_count());
+
+    pkt = mgr->AllocatePooled(PktHandler::RX_PACKET, 1024, 0);
+    EXPECT_EQ(miss, mgr->pool_miss_count());
+}
+
+// Packets received in a batch are dispatched to the flow module
+TEST_F(PktTest, RxBatch_1) {
+    VmInterface *intf = VmInterfaceGet(input[0].intf_id);
+    PacketBufferManager *mgr = agent_->pkt()->packet_buffer_manager();
+    const PktHandler::PktStats &stats =
+        agent_->pkt()->pkt_handler()->GetStats();
+    uint32_t flow_rcvd = stats.received[PktHandler::FLOW];
+
+    PktHandler::PacketBufferBatch batch;
+    for (int i = 0; i < 8; ++i) {
+        char dip[32];
+        sprintf(dip, "1.1.1.%d", 10 + i);
+        PktGen pkt;
+        pkt.AddEthHdr("00:00:00:00:00:01", "00:00:00:00:00:02", 0x800);
+        pkt.AddAgentHdr(intf->id(), AgentHdr::TRAP_FLOW_MISS);
+        pkt.AddEthHdr("00:00:00:00:00:01", "00:00:00:00:00:02", 0x800);
+        pkt.AddIpHdr("1.1.1.1", dip, 1);
+
+        PacketBufferPtr buff = mgr->AllocatePooled(PktHandler::RX_PACKET,
+                                                   pkt.GetBuffLen(), 0);
+        memcpy(buff->data(), pkt.GetBuff(), pkt.GetBuffLen());
+        EXPECT_TRUE(client->agent_init()->pkt0()->AddToBatch(buff, &batch));
+    }
+    EXPECT_EQ(8U, batch.size());
+    client->agent_init()->pkt0()->ProcessBatch(&batch);
+    EXPECT_TRUE(batch.empty());
+    client->WaitForIdle();
+    EXPECT_EQ(flow_rcvd + 8, stats.received[PktHandler::FLOW]);
+}
+
 int main(int argc, char *argv[]) {
     GETUSERARGS();
 
@@ -114,6 +114,23 @@ public:
         return ControlInterface::Process(hdr, pkt);
     }
 
+    // Decode packet received in a batch and add it to the batch. The batch
+    // is handed over with ControlInterface::ProcessBatch
+    bool AddToBatch(const PacketBufferPtr &pkt,
+                    PktHandler::PacketBufferBatch *batch) {
+        AgentHdr hdr;
+        int agent_hdr_len = 0;
+
+        agent_hdr_len = DecodeAgentHdr(&hdr, pkt->data(), pkt->data_len());
+        if (agent_hdr_len <= 0) {
+            return false;
+        }
+
+        pkt->SetOffset(agent_hdr_len);
+        batch->push_back(PktHandler::PacketBufferEnqueueItem(hdr, pkt));
+        return true;
+    }
+
     int EncodeAgentHdr(uint8_t *buff, const AgentHdr &hdr) {
         memset(buff, 0, sizeof(agent_hdr));
 
@@ -1,5 +1,11 @@
 
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <pugixml/pugixml.hpp>
+#include <boost/crc.hpp>
 #include <boost/filesystem.hpp>
 #include "net/address_util.h"
 #include "base/timer.h"
@@ -12,13 +18,22 @@
 
 using namespace pugi;
 
+static const char kJournalMagic[] = "CTDHCPLJ";
+static const size_t kJournalMagicSize = 8;
+static const uint8_t kLeaseReleased = 0x1;
+
 DhcpLeaseDb::DhcpLeaseDb(const Ip4Address &subnet, uint8_t plen,
                          const std::vector<Ip4Address> &reserve_addresses,
                          const std::string &lease_filename,
                          boost::asio::io_service &io) :
     subnet_(subnet), plen_(plen),
     max_lease_update_count_(0), lease_update_count_(0),
-    lease_timeout_(kDhcpLeaseTimer), lease_filename_(lease_filename) {
+    lease_timeout_(kDhcpLeaseTimer), lease_filename_(lease_filename),
+    lease_fd_(-1), commit_count_(0) {
+    commit_trigger_ =
+        new TaskTrigger(boost::bind(&DhcpLeaseDb::CommitLeaseRecords, this),
+                        TaskScheduler::GetInstance()->
+                        GetTaskId("Agent::Services"), PktHandler::DHCP);
     ReserveAddresses(reserve_addresses, true);
     LoadLeaseFile();
     timer_ = TimerManager::CreateTimer(io, "DhcpLeaseTimer",
@@ -34,6 +49,10 @@ DhcpLeaseDb::~DhcpLeaseDb() {
     released_lease_bitmap_.clear();
     timer_->Cancel();
     TimerManager::DeleteTimer(timer_);
+    commit_trigger_->Reset();
+    delete commit_trigger_;
+    CommitLeaseRecords();
+    CloseLeaseFile();
     // remove(lease_filename_.c_str());
 }
 
@@ -48,6 +67,8 @@ void DhcpLeaseDb::Update(const Ip4Address &subnet, uint8_t plen,
         leases_.clear();
         lease_bitmap_.clear();
         released_lease_bitmap_.clear();
+        journal_buffer_.clear();
+        CloseLeaseFile();
         remove(lease_filename_.c_str());
         subnet_change = true;
     }
@@ -224,107 +245,232 @@ void DhcpLeaseDb::set_lease_timeout(uint32_t timeout) {
     }
 }
 
-// Write the complete lease file
+// Write the complete lease file. Pending records are covered by the leases
+// written, hence dropped.
 void DhcpLeaseDb::CreateLeaseFile() {
-    std::ofstream lease_ofstream;
-    lease_ofstream.open(lease_filename_.c_str(),
-                        std::ofstream::out | std::ofstream::trunc);
-    if (!lease_ofstream.good()) {
-        lease_ofstream.close();
-        DHCP_TRACE(Error, "Cannot create DHCP Lease file: " << lease_filename_);
-        return;
-    }
-
+    std::string data;
+    data.reserve(kJournalHeaderSize + leases_.size() * kJournalRecordSize);
+    EncodeJournalHeader(&data);
     for (std::set<DhcpLease>::const_iterator it = leases_.begin();
          it != leases_.end(); ++it) {
-        WriteLeaseRecord(lease_ofstream, it->mac_, it->ip_,
-                         it->lease_expiry_time_, it->released_);
+        EncodeLeaseRecord(&data, it->mac_, it->ip_, it->lease_expiry_time_,
+                          it->released_);
     }
+    journal_buffer_.clear();
+    CloseLeaseFile();
 
-    lease_ofstream.flush();
-    lease_ofstream.close();
+    std::string tmp_filename = lease_filename_ + ".tmp";
+    int fd = open(tmp_filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        DHCP_TRACE(Error, "Cannot create DHCP Lease file: " << tmp_filename);
+        return;
+    }
+    bool success = WriteLeaseFile(fd, data);
+    close(fd);
+    if (!success || rename(tmp_filename.c_str(), lease_filename_.c_str())) {
+        DHCP_TRACE(Error, "Cannot create DHCP Lease file: " << lease_filename_);
+        remove(tmp_filename.c_str());
+    }
 }
 
-// Append lease record
+// Append lease record; written on the next run of the commit trigger
 void DhcpLeaseDb::PersistLeaseRecord(const MacAddress &mac,
                                      const Ip4Address &ip,
                                      const uint64_t &expiry,
                                      bool released) {
-    std::ofstream lease_ofstream;
-    lease_ofstream.open(lease_filename_.c_str(), std::ofstream::app);
-    if (!lease_ofstream.good()) {
-        lease_ofstream.close();
-        DHCP_TRACE(Error, "Cannot open DHCP Lease file for writing : " <<
-                   lease_filename_);
-        return;
+    EncodeLeaseRecord(&journal_buffer_, mac, ip, expiry, released);
+    if (pending_record_count() >= kMaxPendingRecords) {
+        CommitLeaseRecords();
+    } else {
+        commit_trigger_->Set();
     }
-
-    WriteLeaseRecord(lease_ofstream, mac, ip, expiry, released);
-
-    lease_ofstream.flush();
-    lease_ofstream.close();
 }
 
 void DhcpLeaseDb::PersistLeaseRecords(const std::vector<DhcpLease> &leases) {
-    std::ofstream lease_ofstream;
-    lease_ofstream.open(lease_filename_.c_str(), std::ofstream::app);
-    if (!lease_ofstream.good()) {
-        lease_ofstream.close();
-        DHCP_TRACE(Error, "Cannot open DHCP Lease file for writing : "
-                   << lease_filename_);
-        return;
-    }
-
     for (std::vector<DhcpLease>::const_iterator it = leases.begin();
          it != leases.end(); ++it) {
-        WriteLeaseRecord(lease_ofstream, it->mac_, it->ip_,
-                         it->lease_expiry_time_, it->released_);
+        EncodeLeaseRecord(&journal_buffer_, it->mac_, it->ip_,
+                          it->lease_expiry_time_, it->released_);
+    }
+    CommitLeaseRecords();
+}
+
+// Write the pending records to the journal with a single write
+bool DhcpLeaseDb::CommitLeaseRecords() {
+    if (journal_buffer_.empty())
+        return true;
+
+    if (lease_fd_ < 0) {
+        lease_fd_ = open(lease_filename_.c_str(),
+                         O_WRONLY | O_APPEND | O_CREAT, 0644);
+        if (lease_fd_ < 0) {
+            DHCP_TRACE(Error, "Cannot open DHCP Lease file for writing : " <<
+                       lease_filename_);
+            journal_buffer_.clear();
+            return true;
+        }
+        struct stat st;
+        if (fstat(lease_fd_, &st) == 0 && st.st_size == 0) {
+            std::string header;
+            EncodeJournalHeader(&header);
+            journal_buffer_.insert(0, header);
+        }
     }
 
-    lease_ofstream.flush();
-    lease_ofstream.close();
+    if (!WriteLeaseFile(lease_fd_, journal_buffer_)) {
+        DHCP_TRACE(Error, "Lease write to " << lease_filename_ << " failed : "
+                   << pending_record_count() << " records");
+        // compact on the next timer expiry, to drop the partial record
+        lease_update_count_ = max_lease_update_count_;
+        CloseLeaseFile();
+    }
+    journal_buffer_.clear();
+    commit_count_++;
+    return true;
 }
 
-void DhcpLeaseDb::WriteLeaseRecord(std::ofstream &lease_ofstream,
-                                   const MacAddress &mac, const Ip4Address &ip,
-                                   const uint64_t &expiry, bool released) {
-    lease_ofstream << "<lease>";
-    lease_ofstream << " <mac>" << mac.ToString() << "</mac>";
-    lease_ofstream << " <ip>" << ip.to_string() << "</ip>";
-    lease_ofstream << " <expiry>" << expiry << "</expiry>";
-    lease_ofstream << " <released>" <<
-        (released ? "true" : "false") << "</released>";
-    lease_ofstream << " </lease>" << std::endl;
-
-    if (!lease_ofstream.good()) {
-        DHCP_TRACE(Error, "Lease write to " << lease_filename_ <<
-                   " failed : " << mac.ToString() << " " << ip.to_string() <<
-                   (released ? " released" : " valid"));
+void DhcpLeaseDb::CloseLeaseFile() {
+    if (lease_fd_ >= 0) {
+        close(lease_fd_);
+        lease_fd_ = -1;
     }
 }
 
-void DhcpLeaseDb::LoadLeaseFile() {
-    std::string leases;
-    ReadLeaseFile(leases);
-    ParseLeaseFile(leases);
+bool DhcpLeaseDb::WriteLeaseFile(int fd, const std::string &data) {
+    const char *buf = data.data();
+    size_t len = data.size();
+    while (len) {
+        ssize_t ret = write(fd, buf, len);
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        buf += ret;
+        len -= ret;
+    }
+    return true;
+}
+
+static void EncodeUint32(std::string *buffer, uint32_t value) {
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        buffer->push_back(static_cast<char>((value >> shift) & 0xFF));
+    }
 }
 
-void DhcpLeaseDb::ReadLeaseFile(std::string &leases) {
-    ifstream ifile(lease_filename_.c_str());
-    if (!ifile.good()) {
-        ifile.close();
+static uint32_t DecodeUint32(const uint8_t *data) {
+    return (static_cast<uint32_t>(data[0]) << 24) |
+        (static_cast<uint32_t>(data[1]) << 16) |
+        (static_cast<uint32_t>(data[2]) << 8) | data[3];
+}
+
+static uint32_t LeaseRecordCrc(const uint8_t *data, size_t len) {
+    boost::crc_32_type crc;
+    crc.process_bytes(data, len);
+    return crc.checksum();
+}
+
+void DhcpLeaseDb::EncodeJournalHeader(std::string *buffer) const {
+    buffer->append(kJournalMagic, kJournalMagicSize);
+    EncodeUint32(buffer, kJournalVersion);
+    EncodeUint32(buffer, kJournalRecordSize);
+}
+
+void DhcpLeaseDb::EncodeLeaseRecord(std::string *buffer,
+                                    const MacAddress &mac,
+                                    const Ip4Address &ip,
+                                    const uint64_t &expiry,
+                                    bool released) const {
+    size_t start = buffer->size();
+    for (size_t i = 0; i < MacAddress::size(); i++) {
+        buffer->push_back(static_cast<char>(mac[i]));
+    }
+    buffer->push_back(static_cast<char>(released ? kLeaseReleased : 0));
+    buffer->push_back(0);
+    EncodeUint32(buffer, ip.to_ulong());
+    EncodeUint32(buffer, static_cast<uint32_t>(expiry >> 32));
+    EncodeUint32(buffer, static_cast<uint32_t>(expiry));
+    EncodeUint32(buffer, LeaseRecordCrc(
+        reinterpret_cast<const uint8_t *>(buffer->data() + start),
+        buffer->size() - start));
+}
+
+void DhcpLeaseDb::LoadLeaseFile() {
+    int fd = open(lease_filename_.c_str(), O_RDONLY);
+    if (fd < 0) {
         DHCP_TRACE(Error, "Cannot open DHCP Lease file for reading : " <<
                    lease_filename_);
         return;
     }
 
-    ifile.seekg(0, std::ios::end);
-    leases.reserve(ifile.tellg());
-    ifile.seekg(0, std::ios::beg);
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return;
+    }
+
+    size_t size = st.st_size;
+    void *addr = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        DHCP_TRACE(Error, "Cannot map DHCP Lease file : " << lease_filename_);
+        return;
+    }
+
+    const uint8_t *data = static_cast<const uint8_t *>(addr);
+    bool compact = false;
+    if (size >= kJournalMagicSize &&
+        memcmp(data, kJournalMagic, kJournalMagicSize) == 0) {
+        compact = !ReplayLeaseJournal(data, size);
+    } else {
+        // lease file in the earlier XML format
+        ParseLeaseFile(std::string(reinterpret_cast<const char *>(data),
+                                   size));
+        compact = true;
+    }
+    munmap(addr, size);
+
+    if (compact) {
+        CreateLeaseFile();
+    }
+}
+
+// Returns false if the journal has a truncated or invalid record
+bool DhcpLeaseDb::ReplayLeaseJournal(const uint8_t *data, size_t size) {
+    if (size < kJournalHeaderSize ||
+        DecodeUint32(data + kJournalMagicSize) != kJournalVersion ||
+        DecodeUint32(data + kJournalMagicSize + 4) != kJournalRecordSize) {
+        DHCP_TRACE(Error, "Invalid DHCP Lease file header : " <<
+                   lease_filename_);
+        return false;
+    }
+
+    size_t offset = kJournalHeaderSize;
+    for (; offset + kJournalRecordSize <= size;
+         offset += kJournalRecordSize) {
+        const uint8_t *record = data + offset;
+        if (LeaseRecordCrc(record, kJournalRecordSize - 4) !=
+            DecodeUint32(record + kJournalRecordSize - 4)) {
+            DHCP_TRACE(Error, "Invalid DHCP Lease record in " <<
+                       lease_filename_ << " at offset " << offset);
+            return false;
+        }
+        MacAddress mac(record);
+        Ip4Address ip(DecodeUint32(record + 8));
+        uint64_t expiry = (static_cast<uint64_t>(DecodeUint32(record + 12))
+                           << 32) | DecodeUint32(record + 16);
+        bool released = (record[6] & kLeaseReleased) != 0;
+        if (mac.IsZero() || ip.is_unspecified() ||
+            !IsIp4SubnetMember(ip, subnet_, plen_)) {
+            DHCP_TRACE(Error, "Invalid DHCP Lease record : " <<
+                       mac.ToString() << " " << ip.to_string() << " " <<
+                       expiry);
+            continue;
+        }
+        UpdateLease(mac, ip, expiry, released);
+    }
 
-    leases.assign((istreambuf_iterator<char>(ifile)),
-                   istreambuf_iterator<char>());
-    ifile.close();
+    return offset == size;
 }
 
 void DhcpLeaseDb::ParseLeaseFile(const std::string &leases) {
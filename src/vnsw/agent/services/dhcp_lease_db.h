@@ -9,6 +9,7 @@
 #include <boost/dynamic_bitset.hpp>
 
 class Timer;
+class TaskTrigger;
 namespace pugi {
 class xml_node;
 }
@@ -26,13 +27,28 @@ class xml_node;
 // is allocated. When lease_bitmap is exhausted, a released address from
 // released_lease_bitmap is allocated.
 //
-// Lease records are persisted in a file. Records are appended to the file,
-// with the last record being the latest for a client. The lease file is
-// compacted after a certain number of lease updates.
+// Lease records are persisted in a binary journal file. Records are appended
+// to the file, with the last record being the latest for a client. Updates
+// are buffered and written together by a task trigger on the services task
+// (group commit), so that a burst of DHCP ACKs costs a single write. The
+// lease file is compacted after a certain number of lease updates; the
+// compacted file is written to a temporary file and renamed.
+//
+// Journal format : header of 16 bytes - magic (8 bytes), version (4 bytes),
+// record size (4 bytes), followed by fixed size records - mac (6 bytes),
+// flags (1 byte), reserved (1 byte), ip (4 bytes), expiry (8 bytes),
+// crc32 of the preceding bytes (4 bytes). Integers are in network order.
+// The file is mapped and replayed on startup; replay stops at a truncated or
+// corrupt record and the file is compacted. Lease files in the earlier XML
+// format are parsed and converted to the journal format.
 
 class DhcpLeaseDb {
 public:
     static const uint32_t kDhcpLeaseTimer = 300000;        // milli seconds
+    static const uint32_t kMaxPendingRecords = 1024;
+    static const uint32_t kJournalVersion = 1;
+    static const size_t kJournalHeaderSize = 16;
+    static const size_t kJournalRecordSize = 24;
 
     struct DhcpLease {
         MacAddress mac_;
@@ -67,6 +83,10 @@ public:
     const std::set<DhcpLease> &leases() const { return leases_; }
     void ClearLeases();
     void set_lease_timeout(uint32_t timeout);
+    uint64_t commit_count() const { return commit_count_; }
+    size_t pending_record_count() const {
+        return journal_buffer_.size() / kJournalRecordSize;
+    }
 
 private:
     friend class DhcpTest;
@@ -85,11 +105,15 @@ private:
     void PersistLeaseRecord(const MacAddress &mac, const Ip4Address &ip,
                             const uint64_t &expiry, bool released);
     void PersistLeaseRecords(const std::vector<DhcpLease> &leases);
-    void WriteLeaseRecord(std::ofstream &lease_ofstream,
-                          const MacAddress &mac, const Ip4Address &ip,
-                          const uint64_t &expiry, bool released);
+    bool CommitLeaseRecords();
+    void CloseLeaseFile();
+    bool WriteLeaseFile(int fd, const std::string &data);
+    void EncodeLeaseRecord(std::string *buffer, const MacAddress &mac,
+                           const Ip4Address &ip, const uint64_t &expiry,
+                           bool released) const;
+    void EncodeJournalHeader(std::string *buffer) const;
     void LoadLeaseFile();
-    void ReadLeaseFile(std::string &leases);
+    bool ReplayLeaseJournal(const uint8_t *data, size_t size);
     void ParseLeaseFile(const std::string &leases);
     void ParseLease(const pugi::xml_node &lease);
 
@@ -105,6 +129,11 @@ private:
     uint32_t lease_timeout_;
     Timer *timer_;
     std::string lease_filename_;
+    int lease_fd_;
+    // encoded records waiting for the commit trigger
+    std::string journal_buffer_;
+    TaskTrigger *commit_trigger_;
+    uint64_t commit_count_;
 
     DISALLOW_COPY_AND_ASSIGN(DhcpLeaseDb);
 };
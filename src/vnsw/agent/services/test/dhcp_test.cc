@@ -567,6 +567,15 @@ public:
         lease_db_ = NULL;
     }
 
+    void WriteDhcpLeaseRecords(
+        const std::vector<DhcpLeaseDb::DhcpLease> &leases) {
+        lease_db_->PersistLeaseRecords(leases);
+    }
+
+    size_t DhcpLeaseCount() const {
+        return lease_db_->leases().size();
+    }
+
 private:
     DBTableBase::ListenerId rid_;
     uint32_t itf_count_;
@@ -2487,6 +2496,53 @@ TEST_F(DhcpTest, DhcpReqv6PortTest) {
     Agent::GetInstance()->GetDhcpProto()->ClearStats();
 }
 
+// Write a lease journal with 100k records and measure the time to load it
+TEST_F(DhcpTest, GatewayDhcpLeaseJournalScale) {
+    const uint32_t kLeaseCount = 100000;
+    const std::string name = "./dhcp.lease-journal-scale.leases";
+    boost::system::error_code ec;
+    Ip4Address subnet = Ip4Address::from_string("10.0.0.0", ec);
+    remove(name.c_str());
+
+    std::vector<DhcpLeaseDb::DhcpLease> leases;
+    for (uint32_t i = 1; i <= kLeaseCount; ++i) {
+        MacAddress mac(0x00, 0x0a, 0x00, (i >> 16) & 0xFF, (i >> 8) & 0xFF,
+                       i & 0xFF);
+        leases.push_back(DhcpLeaseDb::DhcpLease(mac,
+                         Ip4Address(subnet.to_ulong() + i), 86400000000ULL,
+                         (i % 2) == 0));
+    }
+    LoadDhcpLeaseFile(subnet, 14, name);
+    WriteDhcpLeaseRecords(leases);
+    // second update for the first lease, latest record wins
+    leases.resize(1);
+    leases[0].released_ = true;
+    WriteDhcpLeaseRecords(leases);
+    CloseDhcpLeaseFile();
+
+    uint64_t start = ClockMonotonicUsec();
+    LoadDhcpLeaseFile(subnet, 14, name);
+    uint64_t load_time = ClockMonotonicUsec() - start;
+    LOG(DEBUG, "DHCP test : loaded " << DhcpLeaseCount() << " leases in " <<
+        load_time << " usec");
+    EXPECT_EQ(kLeaseCount, DhcpLeaseCount());
+    EXPECT_TRUE(CheckDhcpLease(leases[0].mac_,
+                               Ip4Address(subnet.to_ulong() + 1), true));
+    EXPECT_TRUE(CheckDhcpLease(MacAddress(0x00, 0x0a, 0x00, 0x00, 0x00, 0x03),
+                               Ip4Address(subnet.to_ulong() + 3), false));
+    CloseDhcpLeaseFile();
+
+    // truncated record at the end is dropped when loading
+    EXPECT_EQ(0, truncate(name.c_str(), DhcpLeaseDb::kJournalHeaderSize +
+              (kLeaseCount + 1) * DhcpLeaseDb::kJournalRecordSize - 10));
+    LoadDhcpLeaseFile(subnet, 14, name);
+    EXPECT_EQ(kLeaseCount, DhcpLeaseCount());
+    EXPECT_TRUE(CheckDhcpLease(leases[0].mac_,
+                               Ip4Address(subnet.to_ulong() + 1), false));
+    CloseDhcpLeaseFile();
+    remove(name.c_str());
+}
+
 // Check the DHCP queue limit
 TEST_F(DhcpTest, QueueLimitTest) {
     struct PortInfo input[] = {
@@ -120,13 +120,14 @@ public:
             boost::bind(&AgentBgpXmppPeerTest::ProcessChannelEvent, this, _1)) {
     }
 
-    virtual void ReceiveUpdate(const XmppStanza::XmppMessage *msg) {
+    virtual void ReceiveUpdate(const XmppStanza::XmppMessage *msg,
+                               std::string *stanza) {
         if (GetXmppChannel() && GetXmppChannel()->GetPeerState() != xmps::READY) {
             return;
         }
 
         rx_count_++;
-        AgentXmppChannel::ReceiveUpdate(msg);
+        AgentXmppChannel::ReceiveUpdate(msg, stanza);
     }
 
     bool ProcessChannelEvent(xmps::PeerState state) {
@@ -611,6 +612,8 @@ protected:
         cfg->local_endpoint.address(boost::asio::ip::address::from_string(local_address));
         cfg->ToAddr = to;
         cfg->FromAddr = from;
+        // Agent channels keep the stanza, as configured by VNController.
+        cfg->keep_stanza = isclient;
         return cfg;
     }
 
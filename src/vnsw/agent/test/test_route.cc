@@ -2363,6 +2363,48 @@ TEST_F(RouteTest, fip_evpn_route_local) {
     client->WaitForIdle();
 }
 
+// Inet route update for vrf1 with a remote route and, optionally, a second
+// item with a malformed med.
+static string InetUpdate(bool malformed) {
+    std::ostringstream oss;
+    oss << "<message from=\"network-control@contrailsystems.com\" "
+           "to=\"agent/bgp-peer\"><event "
+           "xmlns=\"http://jabber.org/protocol/pubsub\">"
+           "<items node=\"1/1/vrf1\"><item id=\"1.1.1.11/32\"><entry>"
+           "<nlri><af>1</af><safi>1</safi><address>1.1.1.11/32</address>"
+           "</nlri><next-hops><next-hop><af>1</af>"
+           "<address>10.1.1.11</address><label>16</label>"
+           "<tunnel-encapsulation-list>"
+           "<tunnel-encapsulation>gre</tunnel-encapsulation>"
+           "</tunnel-encapsulation-list>"
+           "<virtual-network>vn1</virtual-network></next-hop></next-hops>"
+           "<virtual-network>vn1</virtual-network></entry></item>";
+    if (malformed) {
+        oss << "<item id=\"1.1.1.12/32\"><entry><med>x</med></entry>"
+               "</item>";
+    }
+    oss << "</items></event></message>";
+    return oss.str();
+}
+
+// An inet route update is applied as a whole or not at all.
+TEST_F(RouteTest, InetUpdateMalformedLastItem) {
+    AgentXmppChannel *channel = bgp_peer_->GetAgentXmppChannel();
+    string stanza = InetUpdate(true);
+    channel->ReceiveInetUpdate(&stanza);
+    client->WaitForIdle();
+    EXPECT_FALSE(RouteFind(vrf_name_, remote_vm_ip_, 32));
+
+    stanza = InetUpdate(false);
+    channel->ReceiveInetUpdate(&stanza);
+    client->WaitForIdle();
+    EXPECT_TRUE(RouteFind(vrf_name_, remote_vm_ip_, 32));
+
+    DeleteRoute(bgp_peer_, vrf_name_, remote_vm_ip_, 32);
+    client->WaitForIdle();
+    EXPECT_FALSE(RouteFind(vrf_name_, remote_vm_ip_, 32));
+}
+
 int main(int argc, char *argv[]) {
     ::testing::InitGoogleTest(&argc, argv);
     GETUSERARGS();
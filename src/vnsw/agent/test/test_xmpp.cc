@@ -40,9 +40,10 @@ public:
             boost::bind(&AgentBgpXmppPeerTest::ProcessChannelEvent, this, _1)) {
     }
 
-    virtual void ReceiveUpdate(const XmppStanza::XmppMessage *msg) {
+    virtual void ReceiveUpdate(const XmppStanza::XmppMessage *msg,
+                               std::string *stanza) {
         rx_count_++;
-        AgentXmppChannel::ReceiveUpdate(msg);
+        AgentXmppChannel::ReceiveUpdate(msg, stanza);
     }
 
     bool ProcessChannelEvent(xmps::PeerState state) {
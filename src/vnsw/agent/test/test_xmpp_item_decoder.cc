@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include <stdlib.h>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <pugixml/pugixml.hpp>
+
+#include "base/logging.h"
+#include "base/time_util.h"
+#include "controller/controller_item_decoder.h"
+#include "testing/gunit.h"
+#include "xml/xml_base.h"
+#include "xml/xml_pugi.h"
+#include "xmpp_unicast_types.h"
+
+using autogen::ItemType;
+using autogen::ItemsType;
+using autogen::NextHopType;
+using std::string;
+using std::vector;
+
+static const char *kTestData = "controller/src/vnsw/agent/testdata/";
+
+// Messages captured from a control-node, they are replayed by the
+// benchmark.
+static const char *kMessages[] = {
+    "xmpp_inet_update.xml",
+    "xmpp_inet6_update.xml",
+    "xmpp_inet_retract.xml",
+};
+
+class XmppItemDecoderTest : public ::testing::Test {
+protected:
+    static string ReadMessage(const string &name) {
+        std::ifstream file((string(kTestData) + name).c_str());
+        std::ostringstream message;
+        message << file.rdbuf();
+        return message.str();
+    }
+
+    // Parse the items of the message with the generated code, as was done
+    // before the streaming decoder.
+    static bool ParseDom(const string &message, vector<ItemType> *items) {
+        XmlPugi pugi;
+        if (pugi.LoadDoc(message) == -1)
+            return false;
+        pugi::xml_node node = pugi.FindNode("items");
+        if (pugi.IsNull(node))
+            return false;
+        std::auto_ptr<AutogenProperty> xparser(new AutogenProperty());
+        if (!ItemsType::XmlParseProperty(node, &xparser))
+            return false;
+        if (items)
+            *items = static_cast<ItemsType *>(xparser.get())->item;
+        return true;
+    }
+
+    static void ExpectNextHopEq(const NextHopType &expected,
+                                const NextHopType &nexthop) {
+        EXPECT_EQ(expected.af, nexthop.af);
+        EXPECT_EQ(expected.address, nexthop.address);
+        EXPECT_EQ(expected.mac, nexthop.mac);
+        EXPECT_EQ(expected.label, nexthop.label);
+        EXPECT_EQ(expected.vni, nexthop.vni);
+        EXPECT_EQ(expected.tunnel_encapsulation_list.tunnel_encapsulation,
+                  nexthop.tunnel_encapsulation_list.tunnel_encapsulation);
+        EXPECT_EQ(expected.virtual_network, nexthop.virtual_network);
+        EXPECT_EQ(expected.tag_list.tag, nexthop.tag_list.tag);
+    }
+
+    static void ExpectItemEq(const ItemType &expected, const ItemType &item) {
+        EXPECT_EQ(expected.entry.nlri.af, item.entry.nlri.af);
+        EXPECT_EQ(expected.entry.nlri.safi, item.entry.nlri.safi);
+        EXPECT_EQ(expected.entry.nlri.address, item.entry.nlri.address);
+        ASSERT_EQ(expected.entry.next_hops.next_hop.size(),
+                  item.entry.next_hops.next_hop.size());
+        for (size_t i = 0; i < item.entry.next_hops.next_hop.size(); ++i) {
+            ExpectNextHopEq(expected.entry.next_hops.next_hop[i],
+                            item.entry.next_hops.next_hop[i]);
+        }
+        EXPECT_EQ(expected.entry.version, item.entry.version);
+        EXPECT_EQ(expected.entry.virtual_network, item.entry.virtual_network);
+        EXPECT_EQ(expected.entry.sequence_number, item.entry.sequence_number);
+        EXPECT_EQ(expected.entry.security_group_list.security_group,
+                  item.entry.security_group_list.security_group);
+        EXPECT_EQ(expected.entry.community_tag_list.community_tag,
+                  item.entry.community_tag_list.community_tag);
+        EXPECT_EQ(expected.entry.local_preference,
+                  item.entry.local_preference);
+        EXPECT_EQ(expected.entry.med, item.entry.med);
+        EXPECT_EQ(expected.entry.mobility.seqno, item.entry.mobility.seqno);
+        EXPECT_EQ(expected.entry.mobility.sticky, item.entry.mobility.sticky);
+        EXPECT_EQ(expected.entry.load_balance.load_balance_decision,
+                  item.entry.load_balance.load_balance_decision);
+        EXPECT_EQ(expected.entry.load_balance.load_balance_fields.
+                  load_balance_field_list,
+                  item.entry.load_balance.load_balance_fields.
+                  load_balance_field_list);
+        EXPECT_EQ(expected.entry.sub_protocol, item.entry.sub_protocol);
+    }
+
+    // Decode all the items of the message with the streaming decoder.
+    static int Decode(string message, vector<ItemType> *items,
+                      vector<string> *retracts) {
+        ControllerInetItemDecoder decoder(&message[0], message.size());
+        if (!decoder.ReadItems())
+            return -1;
+        ItemType item;
+        int count = 0;
+        ControllerInetItemDecoder::Event event;
+        while ((event = decoder.Next(&item)) !=
+               ControllerInetItemDecoder::END) {
+            if (event == ControllerInetItemDecoder::DECODE_ERROR)
+                return -1;
+            if (event == ControllerInetItemDecoder::ITEM && items)
+                items->push_back(item);
+            if (event == ControllerInetItemDecoder::RETRACT && retracts)
+                retracts->push_back(decoder.id());
+            count++;
+        }
+        return count;
+    }
+};
+
+// The decoded items match the ones of the generated parser.
+TEST_F(XmppItemDecoderTest, Update) {
+    string message = ReadMessage("xmpp_inet_update.xml");
+    ASSERT_FALSE(message.empty());
+    vector<ItemType> expected;
+    ASSERT_TRUE(ParseDom(message, &expected));
+
+    string buf(message);
+    ControllerInetItemDecoder decoder(&buf[0], buf.size());
+    ASSERT_TRUE(decoder.ReadItems());
+    EXPECT_EQ(1, decoder.af());
+    EXPECT_EQ(1, decoder.safi());
+    EXPECT_STREQ("default-domain:admin:vn1:vn1", decoder.vrf_name());
+
+    vector<ItemType> items;
+    EXPECT_EQ(3, Decode(message, &items, NULL));
+    ASSERT_EQ(expected.size(), items.size());
+    for (size_t i = 0; i < items.size(); ++i) {
+        ExpectItemEq(expected[i], items[i]);
+    }
+    EXPECT_EQ(2U, items[1].entry.next_hops.next_hop.size());
+    EXPECT_EQ(7U, items[1].entry.mobility.seqno);
+    EXPECT_TRUE(items[1].entry.mobility.sticky);
+    EXPECT_EQ("field-hash", items[1].entry.load_balance.load_balance_decision);
+}
+
+TEST_F(XmppItemDecoderTest, Inet6Update) {
+    string message = ReadMessage("xmpp_inet6_update.xml");
+    vector<ItemType> expected;
+    ASSERT_TRUE(ParseDom(message, &expected));
+
+    string buf(message);
+    ControllerInetItemDecoder decoder(&buf[0], buf.size());
+    ASSERT_TRUE(decoder.ReadItems());
+    EXPECT_EQ(2, decoder.af());
+
+    vector<ItemType> items;
+    EXPECT_EQ(1, Decode(message, &items, NULL));
+    ASSERT_EQ(1U, items.size());
+    ExpectItemEq(expected[0], items[0]);
+}
+
+TEST_F(XmppItemDecoderTest, Retract) {
+    string message = ReadMessage("xmpp_inet_retract.xml");
+    vector<string> retracts;
+    EXPECT_EQ(3, Decode(message, NULL, &retracts));
+    ASSERT_EQ(3U, retracts.size());
+    EXPECT_EQ("1.1.1.1/32", retracts[0]);
+    EXPECT_EQ("1.1.1.2/32", retracts[1]);
+    EXPECT_EQ("2.2.2.0/24", retracts[2]);
+}
+
+TEST_F(XmppItemDecoderTest, Malformed) {
+    // Not a route update.
+    EXPECT_EQ(-1, Decode("<message><event/></message>", NULL, NULL));
+    EXPECT_EQ(-1, Decode("<message><event><items node=\"1\"/></event>"
+                         "</message>", NULL, NULL));
+    // Bad number.
+    EXPECT_EQ(-1, Decode("<message><event><items node=\"1/1/vrf\">"
+                         "<item id=\"1.1.1.1/32\"><entry><med>x</med>"
+                         "</entry></item></items></event></message>",
+                         NULL, NULL));
+    // Truncated.
+    EXPECT_EQ(-1, Decode("<message><event><items node=\"1/1/vrf\">"
+                         "<item id=\"1.1.1.1/32\"><entry>", NULL, NULL));
+    // Unknown elements are skipped.
+    EXPECT_EQ(1, Decode("<message><event><items node=\"1/1/vrf\">"
+                        "<foo><bar/></foo><item id=\"1.1.1.1/32\"><entry>"
+                        "<foo>1</foo></entry></item></items></event>"
+                        "</message>", NULL, NULL));
+}
+
+//
+// Replay the captured messages and compare the cost of the DOM and the
+// generated parser, which the agent used before, with the streaming
+// decoder. The XMPP layer still loads the DOM of every message, and the
+// agent copies the message to decode it, so both are included in the cost
+// of the decoder. The number of replays can be set with XMPP_REPLAY_COUNT.
+//
+TEST_F(XmppItemDecoderTest, ReplayBenchmark) {
+    int count = 1000;
+    if (getenv("XMPP_REPLAY_COUNT")) {
+        count = strtoul(getenv("XMPP_REPLAY_COUNT"), NULL, 0);
+    }
+    vector<string> messages;
+    for (size_t i = 0; i < sizeof(kMessages) / sizeof(kMessages[0]); ++i) {
+        messages.push_back(ReadMessage(kMessages[i]));
+    }
+
+    uint64_t start = ClockMonotonicUsec();
+    for (int n = 0; n < count; ++n) {
+        for (size_t i = 0; i < messages.size(); ++i) {
+            // Retracts have no items to parse.
+            if (messages[i].find("<item ") != string::npos) {
+                ASSERT_TRUE(ParseDom(messages[i], NULL));
+            }
+        }
+    }
+    uint64_t dom_usecs = ClockMonotonicUsec() - start;
+
+    start = ClockMonotonicUsec();
+    for (int n = 0; n < count; ++n) {
+        for (size_t i = 0; i < messages.size(); ++i) {
+            XmlPugi pugi;
+            ASSERT_NE(-1, pugi.LoadDoc(messages[i]));
+            ASSERT_LE(0, Decode(messages[i], NULL, NULL));
+        }
+    }
+    uint64_t decoder_usecs = ClockMonotonicUsec() - start;
+
+    std::cout << "Replayed " << count * messages.size() << " messages: "
+              << "dom and parser " << dom_usecs << " usecs, "
+              << "dom and decoder " << decoder_usecs << " usecs" << std::endl;
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    LoggingInit();
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "base/logging.h"
+#include "testing/gunit.h"
+#include <uve/vm_stat_reader.h>
+
+using std::string;
+
+static const char *kVmUuid = "6bd8a3b6-4c6d-4d55-9a22-2b6d0c1e1f01";
+static const char *kOtherUuid = "0f6a5bcb-1c45-4a4e-8a3e-6c4e0e7b1a02";
+
+// Builds a fake /proc and cgroup tree under a temporary directory.
+class VmStatReaderTest : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        char tmpl[] = "/tmp/vm_stat_reader_XXXXXX";
+        ASSERT_TRUE(mkdtemp(tmpl) != NULL);
+        root_ = tmpl;
+        clock_ticks_ = sysconf(_SC_CLK_TCK);
+        if (clock_ticks_ <= 0) {
+            clock_ticks_ = 100;
+        }
+    }
+
+    virtual void TearDown() {
+        string cmd = "rm -rf " + root_;
+        EXPECT_EQ(0, system(cmd.c_str()));
+    }
+
+    void WriteFile(const string &path, const string &contents) {
+        string full = root_ + "/" + path;
+        string cmd = "mkdir -p " + full.substr(0, full.rfind('/'));
+        ASSERT_EQ(0, system(cmd.c_str()));
+        std::ofstream file(full.c_str(), std::ios::binary);
+        file << contents;
+    }
+
+    static string Stat(const string &comm, char state, int utime, int stime) {
+        std::ostringstream stat;
+        stat << "1234 (" << comm << ") " << state
+             << " 1 1234 1234 0 -1 4202752 100 0 0 0 "
+             << utime << " " << stime << " 0 0 20 0 4 0 100 0 0";
+        return stat.str();
+    }
+
+    void AddProcess(uint32_t pid, const string &cmdline, char state,
+                    int utime, int stime) {
+        std::ostringstream dir;
+        dir << "proc/" << pid;
+        WriteFile(dir.str() + "/cmdline", cmdline);
+        WriteFile(dir.str() + "/stat",
+                  Stat(cmdline.c_str(), state, utime, stime));
+        WriteFile(dir.str() + "/status",
+                  "Name:\tqemu\nVmPeak:\t  4300000 kB\n"
+                  "VmSize:\t  4200000 kB\nVmRSS:\t   1048576 kB\n");
+    }
+
+    void AddThread(uint32_t pid, uint32_t tid, const string &comm,
+                   int utime, int stime) {
+        std::ostringstream dir;
+        dir << "proc/" << pid << "/task/" << tid;
+        WriteFile(dir.str() + "/comm", comm + "\n");
+        WriteFile(dir.str() + "/stat", Stat(comm, 'S', utime, stime));
+    }
+
+    static string KvmCmdline(const string &uuid) {
+        static const char kArgs[] =
+            "/usr/bin/qemu-system-x86_64\0-name\0instance-1\0-uuid";
+        return string(kArgs, sizeof(kArgs)) + uuid + string("\0", 1);
+    }
+
+    double Seconds(int ticks) const {
+        return static_cast<double>(ticks) / clock_ticks_;
+    }
+
+    string root_;
+    long clock_ticks_;
+};
+
+TEST_F(VmStatReaderTest, FindKvmPids) {
+    AddProcess(100, KvmCmdline(kVmUuid), 'S', 0, 0);
+    // Processes that aren't qemu are skipped even if they have the uuid in
+    // their arguments.
+    AddProcess(200, string("/bin/grep\0", 10) + kOtherUuid, 'S', 0, 0);
+    AddProcess(300, KvmCmdline(kOtherUuid), 'S', 0, 0);
+    WriteFile("proc/self/cmdline", KvmCmdline(kVmUuid));
+
+    VmStatReader reader(root_);
+    std::set<string> uuids;
+    uuids.insert(kVmUuid);
+    VmStatReader::PidMap pids;
+    reader.FindKvmPids(uuids, &pids);
+    EXPECT_EQ(1U, pids.size());
+    EXPECT_EQ(100U, pids[kVmUuid]);
+
+    uuids.insert(kOtherUuid);
+    pids.clear();
+    reader.FindKvmPids(uuids, &pids);
+    EXPECT_EQ(2U, pids.size());
+    EXPECT_EQ(300U, pids[kOtherUuid]);
+}
+
+TEST_F(VmStatReaderTest, ProcessStats) {
+    AddProcess(100, KvmCmdline(kVmUuid), 'S', 250, 50);
+    AddThread(100, 100, "qemu-system-x86", 10, 10);
+    AddThread(100, 102, "CPU 1/KVM", 60, 40);
+    AddThread(100, 101, "CPU 0/KVM", 120, 30);
+
+    VmStatReader reader(root_);
+    VmStatReader::ProcessStats stats;
+    EXPECT_TRUE(reader.ReadProcessStats(100, &stats));
+    EXPECT_EQ('S', stats.state);
+    EXPECT_DOUBLE_EQ(Seconds(300), stats.cpu_time);
+    EXPECT_EQ(4200000U, stats.virt_memory);
+    EXPECT_EQ(4300000U, stats.virt_memory_peak);
+    EXPECT_EQ(1048576U, stats.rss);
+    ASSERT_EQ(2U, stats.vcpu_time.size());
+    EXPECT_DOUBLE_EQ(Seconds(150), stats.vcpu_time[0]);
+    EXPECT_DOUBLE_EQ(Seconds(100), stats.vcpu_time[1]);
+
+    VmStatReader::ProcessStats missing;
+    EXPECT_FALSE(reader.ReadProcessStats(101, &missing));
+}
+
+// The command name in the stat file may contain spaces and parentheses.
+TEST_F(VmStatReaderTest, StatCommandName) {
+    WriteFile("proc/100/stat", Stat("qemu (x) y", 'T', 7, 3));
+    VmStatReader reader(root_);
+    VmStatReader::ProcessStats stats;
+    EXPECT_TRUE(reader.ReadProcessStats(100, &stats));
+    EXPECT_EQ('T', stats.state);
+    EXPECT_DOUBLE_EQ(Seconds(10), stats.cpu_time);
+    EXPECT_TRUE(stats.vcpu_time.empty());
+}
+
+TEST_F(VmStatReaderTest, Cgroup) {
+    const string cgroup = "docker/4b2c9f0e1a7d";
+    const string base = "sys/fs/cgroup/";
+    WriteFile(base + "cpuacct/" + cgroup + "/cpuacct.usage", "2500000000\n");
+    WriteFile(base + "cpuacct/" + cgroup + "/cgroup.procs", "4242\n4243\n");
+    WriteFile(base + "memory/" + cgroup + "/memory.stat",
+              "cache 1024\nrss 2048\nhierarchical_memory_limit 536870912\n");
+    WriteFile(base + "freezer/" + cgroup + "/freezer.state", "THAWED\n");
+
+    VmStatReader reader(root_);
+    double cpu_time = 0;
+    EXPECT_TRUE(reader.ReadCgroupCpuTime(cgroup, &cpu_time));
+    EXPECT_DOUBLE_EQ(2.5, cpu_time);
+    uint32_t limit = 0;
+    EXPECT_TRUE(reader.ReadCgroupMemoryLimit(cgroup, &limit));
+    EXPECT_EQ(524288U, limit);
+    EXPECT_EQ(4242U, reader.ReadCgroupPid(cgroup));
+    EXPECT_FALSE(reader.CgroupFrozen(cgroup));
+
+    WriteFile(base + "freezer/" + cgroup + "/freezer.state", "FROZEN\n");
+    EXPECT_TRUE(reader.CgroupFrozen(cgroup));
+
+    // The container doesn't exist anymore.
+    EXPECT_FALSE(reader.ReadCgroupCpuTime("docker/none", &cpu_time));
+    EXPECT_FALSE(reader.ReadCgroupMemoryLimit("docker/none", &limit));
+    EXPECT_EQ(0U, reader.ReadCgroupPid("docker/none"));
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    LoggingInit();
+    return RUN_ALL_TESTS();
+}
@@ -8,6 +8,7 @@
 #include <unistd.h>
 #include <uve/vm_stat.h>
 #include <uve/vm_stat_data.h>
+#include <uve/vm_stat_reader.h>
 #include <db/db.h>
 #include <db/db_entry.h>
 #include <db/db_table.h>
@@ -30,8 +31,8 @@ VmStat::VmStat(Agent *agent, const uuid &vm_uuid):
     prev_cpu_stat_(0), cpu_usage_(0),
     prev_cpu_snapshot_time_(0), prev_vcpu_snapshot_time_(0),
     input_(*(agent_->event_manager()->io_service())),
-    timer_(TimerManager::CreateTimer(*(agent_->event_manager())->io_service(),
-    "VmStatTimer")), marked_delete_(false), pid_(0), retry_(0), virtual_size_(0),
+    marked_delete_(false), exec_pending_(false), pid_(0), retry_(0),
+    virtual_size_(0),
     disk_size_(0), disk_name_(),
     vm_state_(VrouterAgentVmState::VROUTER_AGENT_VM_UNKNOWN),
     prev_vm_state_(VrouterAgentVmState::VROUTER_AGENT_VM_UNKNOWN),
@@ -39,7 +40,6 @@ VmStat::VmStat(Agent *agent, const uuid &vm_uuid):
 }
 
 VmStat::~VmStat() {
-    TimerManager::DeleteTimer(timer_);
 }
 
 void VmStat::ReadData(const boost::system::error_code &ec,
@@ -67,10 +67,16 @@ void VmStat::ReadData(const boost::system::error_code &ec,
 }
 
 void VmStat::ProcessData() {
+    exec_pending_ = false;
     if (!call_back_.empty())
         call_back_();
 }
 
+void VmStat::ClearData() {
+    data_.str(" ");
+    data_.clear();
+}
+
 void VmStat::ExecCmd(std::string cmd, DoneCb cb) {
     char *argv[4];
     char shell[80] = "/bin/sh";
@@ -117,12 +123,49 @@ void VmStat::ExecCmd(std::string cmd, DoneCb cb) {
         return;
     }
 
+    exec_pending_ = true;
     bzero(rx_buff_, sizeof(rx_buff_));
     async_read(input_, boost::asio::buffer(rx_buff_, kBufLen),
                boost::bind(&VmStat::ReadData, this, placeholders::error,
                            placeholders::bytes_transferred, cb));
 }
 
+void VmStat::UpdateCpuUsage(double cpu_stat) {
+    time_t now;
+    time(&now);
+    if (prev_cpu_snapshot_time_) {
+        cpu_usage_ = (cpu_stat - prev_cpu_stat_)/
+                     difftime(now, prev_cpu_snapshot_time_);
+        cpu_usage_ *= 100;
+    }
+
+    prev_cpu_stat_ = cpu_stat;
+    prev_cpu_snapshot_time_ = now;
+}
+
+void VmStat::UpdateVcpuUsage(const std::vector<double> &vcpu_usage) {
+    vcpu_usage_percent_.clear();
+    if (prev_vcpu_usage_.size() != vcpu_usage.size()) {
+        //In case a new VCPU get added
+        prev_vcpu_usage_ = vcpu_usage;
+    }
+
+    time_t now;
+    time(&now);
+    //Calculate VCPU usage
+    if (prev_vcpu_snapshot_time_) {
+        for (uint32_t i = 0; i < vcpu_usage.size(); i++) {
+            double cpu_usage = (vcpu_usage[i] - prev_vcpu_usage_[i])/
+                               difftime(now, prev_vcpu_snapshot_time_);
+            cpu_usage *= 100;
+            vcpu_usage_percent_.push_back(cpu_usage);
+        }
+    }
+
+    prev_vcpu_usage_ = vcpu_usage;
+    prev_vcpu_snapshot_time_ = now;
+}
+
 bool VmStat::BuildVmStatsMsg(VirtualMachineStats *uve) {
     uve->set_name(UuidToString(vm_uuid_));
 
@@ -197,25 +240,18 @@ void VmStat::SendVmCpuStats() {
     }
 }
 
-bool VmStat::TimerExpiry() {
-    return false;
-}
-
-void VmStat::StartTimer() {
-    timer_->Cancel();
-    timer_->Start(agent_->params()->vmi_vm_vn_uve_interval_msecs(),
-                  boost::bind(&VmStat::TimerExpiry, this));
+void VmStat::Start() {
 }
 
-void VmStat::Start() {
+void VmStat::Collect(const VmStatReader &reader,
+                     const std::map<std::string, uint32_t> &pids) {
 }
 
 void VmStat::Stop() {
     marked_delete_ = true;
-    if (timer_->running() || retry_ == kRetryCount) {
-        //If timer is fired, then we are in middle of
-        //vm stat collection, in such case dont delete the vm stat
-        //entry as asio may be using it
+    if (!exec_pending_) {
+        //If a command is running, asio is using the vm stat entry. It is
+        //deleted once the output of the command has been read.
         delete this;
     }
 }
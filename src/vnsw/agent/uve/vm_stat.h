@@ -5,15 +5,19 @@
 #ifndef vnsw_agent_vm_stat_h
 #define vnsw_agent_vm_stat_h
 
+#include <map>
+#include <string>
 #include <vector>
 #include <sandesh/common/vns_types.h>
 #include <virtual_machine_types.h>
 #include <boost/uuid/uuid_io.hpp>
-#include "base/timer.h"
 #include <cmn/agent_cmn.h>
 
 class VmStatData;
+class VmStatReader;
 
+// Stats of a VM or container. VmStatCollector calls Collect() for all the
+// instances once per interval.
 class VmStat {
 public:
     static const size_t kBufLen = 4098;
@@ -24,21 +28,29 @@ public:
     VmStat(Agent *agent, const boost::uuids::uuid &vm_uuid);
     virtual ~VmStat();
     bool marked_delete() const { return marked_delete_; }
+    const boost::uuids::uuid &vm_uuid() const { return vm_uuid_; }
 
     virtual void Start();
     void Stop();
     void ProcessData();
+
+    // Returns true if the pid of the instance is to be looked up in the next
+    // scan of /proc for qemu processes.
+    virtual bool PidLookupPending() const { return false; }
+    virtual void Collect(const VmStatReader &reader,
+                         const std::map<std::string, uint32_t> &pids);
 private:
     bool BuildVmStatsMsg(VirtualMachineStats *uve);
     bool BuildVmMsg(UveVirtualMachineAgent *uve);
     void ReadData(const boost::system::error_code &ec, size_t read_bytes,
                   DoneCb &cb);
-    virtual bool TimerExpiry();
 
 protected:
-    void StartTimer();
     void ExecCmd(std::string cmd, DoneCb cb);
     void SendVmCpuStats();
+    void UpdateCpuUsage(double cpu_stat);
+    void UpdateVcpuUsage(const std::vector<double> &vcpu_usage);
+    void ClearData();
 
     Agent *agent_;
     const boost::uuids::uuid vm_uuid_;
@@ -57,8 +69,9 @@ protected:
 #ifndef _WIN32
     boost::asio::posix::stream_descriptor input_;
 #endif
-    Timer *timer_;
     bool marked_delete_;
+    // A command is running, its output is read asynchronously.
+    bool exec_pending_;
     uint32_t pid_;
     uint32_t retry_;
     DoneCb call_back_;
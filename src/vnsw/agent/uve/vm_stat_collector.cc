@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include <algorithm>
+#include <base/time_util.h>
+#include <base/timer.h>
+#include <cmn/agent.h>
+#include <init/agent_param.h>
+#include <uve/agent_uve.h>
+#include <uve/uve_types.h>
+#include <uve/vm_stat.h>
+#include <uve/vm_stat_collector.h>
+#include <uve/vm_uve_table.h>
+
+VmStatCollector::VmStatCollector(Agent *agent)
+    : agent_(agent),
+      timer_(TimerManager::CreateTimer
+             (*(agent->event_manager())->io_service(), "VmStatTimer",
+              TaskScheduler::GetInstance()->GetTaskId("Agent::Uve"), 0)),
+      interval_(0), cycle_count_(0), pid_scan_count_(0),
+      last_cycle_usecs_(0), max_cycle_usecs_(0), total_cycle_usecs_(0) {
+}
+
+VmStatCollector::~VmStatCollector() {
+    timer_->Cancel();
+    TimerManager::DeleteTimer(timer_);
+}
+
+void VmStatCollector::StartTimer() {
+    if (!timer_->running()) {
+        interval_ = agent_->params()->vmi_vm_vn_uve_interval_msecs();
+        timer_->Start(interval_, boost::bind(&VmStatCollector::Run, this));
+    }
+}
+
+void VmStatCollector::Add(VmStat *stat) {
+    stats_.insert(stat);
+    StartTimer();
+}
+
+void VmStatCollector::Remove(VmStat *stat) {
+    stats_.erase(stat);
+}
+
+// Collect the stats of all the instances. The pids of the instances that
+// don't have one are looked up first, in a single scan of /proc.
+bool VmStatCollector::Run() {
+    if (stats_.empty()) {
+        return false;
+    }
+
+    uint64_t start = ClockMonotonicUsec();
+    std::set<std::string> uuids;
+    for (std::set<VmStat *>::const_iterator it = stats_.begin();
+         it != stats_.end(); ++it) {
+        if ((*it)->PidLookupPending()) {
+            uuids.insert(agent_->GetUuidStr((*it)->vm_uuid()));
+        }
+    }
+    VmStatReader::PidMap pids;
+    if (!uuids.empty()) {
+        reader_.FindKvmPids(uuids, &pids);
+        pid_scan_count_++;
+    }
+
+    for (std::set<VmStat *>::const_iterator it = stats_.begin();
+         it != stats_.end(); ++it) {
+        (*it)->Collect(reader_, pids);
+    }
+
+    last_cycle_usecs_ = ClockMonotonicUsec() - start;
+    max_cycle_usecs_ = std::max(max_cycle_usecs_, last_cycle_usecs_);
+    total_cycle_usecs_ += last_cycle_usecs_;
+    cycle_count_++;
+
+    uint32_t interval = agent_->params()->vmi_vm_vn_uve_interval_msecs();
+    if (interval != interval_) {
+        interval_ = interval;
+        timer_->Reschedule(interval_);
+    }
+    /* Return true to trigger auto-restart of timer */
+    return true;
+}
+
+void VmStatCollector::FillInfo(VmStatCollectorInfoResp *resp) const {
+    resp->set_instances(stats_.size());
+    resp->set_cycles(cycle_count_);
+    resp->set_pid_scans(pid_scan_count_);
+    resp->set_last_cycle_usecs(last_cycle_usecs_);
+    resp->set_max_cycle_usecs(max_cycle_usecs_);
+    resp->set_total_cycle_usecs(total_cycle_usecs_);
+}
+
+void VmStatCollectorInfoReq::HandleRequest() const {
+    VmStatCollectorInfoResp *resp = new VmStatCollectorInfoResp();
+    Agent *agent = Agent::GetInstance();
+    VmUveTable *table = static_cast<VmUveTable *>
+        (agent->uve()->vm_uve_table());
+    table->vm_stat_collector()->FillInfo(resp);
+    resp->set_context(context());
+    resp->Response();
+    return;
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#ifndef vnsw_agent_vm_stat_collector_h
+#define vnsw_agent_vm_stat_collector_h
+
+#include <set>
+#include <cmn/agent_cmn.h>
+#include <uve/vm_stat_reader.h>
+
+class Timer;
+class VmStat;
+class VmStatCollectorInfoResp;
+
+// Collects the stats of all the VMs and containers of the compute in one
+// pass per interval, reading /proc and the cgroup accounting directly. The
+// pids of the qemu processes are cached in the VmStat of each instance and
+// looked up in a single scan of /proc for all the instances that don't have
+// one yet.
+//
+// Runs in the Agent::Uve task, which excludes the DB tasks that add and
+// remove instances.
+class VmStatCollector {
+public:
+    explicit VmStatCollector(Agent *agent);
+    ~VmStatCollector();
+
+    void Add(VmStat *stat);
+    void Remove(VmStat *stat);
+    bool Run();
+
+    const VmStatReader &reader() const { return reader_; }
+    size_t size() const { return stats_.size(); }
+    void FillInfo(VmStatCollectorInfoResp *resp) const;
+
+private:
+    void StartTimer();
+
+    Agent *agent_;
+    VmStatReader reader_;
+    Timer *timer_;
+    uint32_t interval_;
+    std::set<VmStat *> stats_;
+
+    // Cost of the collection cycles.
+    uint64_t cycle_count_;
+    uint64_t pid_scan_count_;
+    uint64_t last_cycle_usecs_;
+    uint64_t max_cycle_usecs_;
+    uint64_t total_cycle_usecs_;
+    DISALLOW_COPY_AND_ASSIGN(VmStatCollector);
+};
+
+#endif // vnsw_agent_vm_stat_collector_h
@@ -8,6 +8,7 @@
 #include <unistd.h>
 #include <uve/vm_stat_docker.h>
 #include <uve/vm_stat_data.h>
+#include <uve/vm_stat_reader.h>
 #include <db/db.h>
 #include <db/db_entry.h>
 #include <db/db_table.h>
@@ -37,186 +38,48 @@ void VmStatDocker::Start() {
     GetContainerId();
 }
 
-void VmStatDocker::ReadCpuStat() {
-    double cpu_stat = 0;
-    std::string cpu_stat_str;
-    data_ >> cpu_stat_str;
-
-    if (!cpu_stat_str.empty()) {
-        //Convert string to double
-        stringstream ss(cpu_stat_str);
-        ss >> cpu_stat;
-        //Convert from Nanoseconds to seconds
-        cpu_stat = cpu_stat / kOneSecInNanoSecs;
-    }
-
-    time_t now;
-    time(&now);
-    if (prev_cpu_snapshot_time_) {
-        cpu_usage_ = (cpu_stat - prev_cpu_stat_)/
-                     difftime(now, prev_cpu_snapshot_time_);
-        cpu_usage_ *= 100;
-    }
-
-    prev_cpu_stat_ = cpu_stat;
-    prev_cpu_snapshot_time_ = now;
-
-    //Clear buffer
-    data_.str(" ");
-    data_.clear();
-
-    //Trigger a request to start Memory stat collection
-    GetMemoryQuota();
-}
-
-void VmStatDocker::ReadMemStat() {
-    if (pid_) {
-        std::ostringstream proc_file;
-        proc_file << "/proc/"<<pid_<<"/status";
-        std::ifstream file(proc_file.str().c_str());
-
-        bool vmsize = false;
-        bool rss = false;
-        bool peak = false;
-        std::string line;
-        while (std::getline(file, line)) {
-            if (line.find("VmSize") != std::string::npos) {
-                std::stringstream vm(line);
-                std::string tmp; vm >> tmp; vm >> virt_memory_;
-                vmsize = true;
-            }
-            if (line.find("VmRSS") != std::string::npos) {
-                std::stringstream vm(line);
-                std::string tmp;
-                vm >> tmp;
-                vm >> mem_usage_;
-                rss = true;
-            }
-            if (line.find("VmPeak") != std::string::npos) {
-                std::stringstream vm(line);
-                std::string tmp; vm >> tmp; vm >> virt_memory_peak_;
-                peak = true;
-            }
-            if (rss && vmsize && peak)
-                break;
-        }
-    }
-
-    data_.str(" ");
-    data_.clear();
-
-    SendVmCpuStats();
-    StartTimer();
-}
-
-void VmStatDocker::GetCpuStat() {
-    std::ostringstream cmd;
-    cmd << "cat /sys/fs/cgroup/cpuacct/docker/" << container_id_
-        << "/cpuacct.usage";
-    ExecCmd(cmd.str(), boost::bind(&VmStatDocker::ReadCpuStat, this));
-}
-
-void VmStatDocker::GetMemoryQuota() {
-    std::ostringstream cmd;
-    cmd << "cat /sys/fs/cgroup/memory/docker/" << container_id_
-        << "/memory.stat";
-    ExecCmd(cmd.str(), boost::bind(&VmStatDocker::ReadMemoryQuota, this));
-}
-
-void VmStatDocker::GetMemStat() {
-    ReadMemStat();
-}
-
-void VmStatDocker::GetPid() {
-    std::ostringstream cmd;
-    cmd << "docker inspect " << container_id_ << "| grep -A3 \\\"Paused\\\":";
-    ExecCmd(cmd.str(), boost::bind(&VmStatDocker::ReadPid, this));
-}
-
-void VmStatDocker::ReadPid() {
-    /* Expecting data_ to have the following content
-     *     "Paused": false,
-     *     "Pid": 24430,
-     *     "Restarting": false,
-     *     "Running": true,
-     */
-    string tmp, paused_str, pid_str, running_str;
-    while (data_ >> tmp) {
-        if (tmp.find("Paused") != std::string::npos) {
-            data_ >> paused_str;
-        }
-        if (tmp.find("Pid") != std::string::npos) {
-            data_ >> pid_str;
-        }
-        if (tmp.find("Running") != std::string::npos) {
-            data_ >> running_str;
-            break;
+void VmStatDocker::Collect(const VmStatReader &reader,
+                           const VmStatReader::PidMap &pids) {
+    if (container_id_.empty()) {
+        //Retry the lookup of the container-id
+        if (vm_uuid_ != nil_uuid() && !exec_pending_ && retry_ < kRetryCount) {
+            GetContainerId();
         }
+        return;
     }
 
-    //Remove the last character from 'pid_str'
-    if (pid_str.size() >= 2) {
-        pid_str.erase(pid_str.size() - 1);
-        //Convert string to uint32_t
-        stringstream ss(pid_str);
-        ss >> pid_;
-    }
-
-    vm_state_ = VrouterAgentVmState::VROUTER_AGENT_VM_UNKNOWN;
-    if (paused_str == "true,") {
-        vm_state_ = VrouterAgentVmState::VROUTER_AGENT_VM_PAUSED;
-    } else if (running_str == "false,") {
-        vm_state_ = VrouterAgentVmState::VROUTER_AGENT_VM_SHUTDOWN;
-    } else if (running_str == "true,") {
-        vm_state_ = VrouterAgentVmState::VROUTER_AGENT_VM_ACTIVE;
+    std::string cgroup = "docker/" + container_id_;
+    double cpu_stat = 0;
+    if (reader.ReadCgroupCpuTime(cgroup, &cpu_stat)) {
+        UpdateCpuUsage(cpu_stat);
     }
-    data_.str(" ");
-    data_.clear();
-    GetMemStat();
-}
-
-void VmStatDocker::ReadMemoryQuota() {
-    std::string tmp;
-    while (data_ >> tmp) {
-        if (tmp == "hierarchical_memory_limit") {
-            data_ >> vm_memory_quota_;
-            /* Convert the 'vm_memory_quota_' to KiB to make it consistent with
-               Kvm's 'vm_memory_quota_' */
-            vm_memory_quota_/= 1024;
-            break;
+    reader.ReadCgroupMemoryLimit(cgroup, &vm_memory_quota_);
+
+    pid_ = reader.ReadCgroupPid(cgroup);
+    VmStatReader::ProcessStats stats;
+    if (pid_ && reader.ReadProcessStats(pid_, &stats)) {
+        virt_memory_ = stats.virt_memory;
+        virt_memory_peak_ = stats.virt_memory_peak;
+        mem_usage_ = stats.rss;
+        if (reader.CgroupFrozen(cgroup)) {
+            vm_state_ = VrouterAgentVmState::VROUTER_AGENT_VM_PAUSED;
+        } else {
+            vm_state_ = VrouterAgentVmState::VROUTER_AGENT_VM_ACTIVE;
         }
-    }
-
-    data_.str(" ");
-    data_.clear();
-    GetPid();
-}
-
-bool VmStatDocker::TimerExpiry() {
-    if (container_id_.empty()) {
-        GetContainerId();
     } else {
-        //Get CPU and memory stats
-        GetCpuStat();
+        vm_state_ = VrouterAgentVmState::VROUTER_AGENT_VM_SHUTDOWN;
     }
-    return false;
+
+    SendVmCpuStats();
 }
 
 void VmStatDocker::ReadContainerId() {
     data_ >> container_id_;
     //Clear buffer
-    data_.str(" ");
-    data_.clear();
+    ClearData();
 
-    if (!container_id_.empty()) {
-        //Successfully read container-id, collect other data
-        GetCpuStat();
-    } else {
+    if (container_id_.empty()) {
         retry_++;
-        //Retry after timeout
-        if (retry_ < kRetryCount) {
-            StartTimer();
-        }
     }
 }
 
@@ -7,25 +7,19 @@
 
 #include "vm_stat.h"
 
+// The container id is looked up once with 'docker ps'. The stats are then
+// read from the cgroup of the container and from /proc.
 class VmStatDocker : public VmStat {
 public:
     VmStatDocker(Agent *agent, const boost::uuids::uuid &vm_uuid);
     ~VmStatDocker();
-    static const long kOneSecInNanoSecs = 1000000000;
 
     void Start();
+    virtual void Collect(const VmStatReader &reader,
+                         const std::map<std::string, uint32_t> &pids);
 private:
     void ReadContainerId();
     void GetContainerId();
-    void ReadCpuStat();
-    void GetCpuStat();
-    void ReadMemoryQuota();
-    void GetMemoryQuota();
-    void ReadMemStat();
-    void GetMemStat();
-    bool TimerExpiry();
-    void GetPid();
-    void ReadPid();
 
     std::string container_id_;
 
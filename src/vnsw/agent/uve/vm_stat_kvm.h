@@ -7,29 +7,30 @@
 
 #include "vm_stat.h"
 
+// Cpu, vcpu and memory stats of the qemu process are read from /proc. The
+// memory quota and the disk sizes are known only to libvirt, they are read
+// with virsh when the process is found and then every kLibvirtRefreshCycles
+// collection cycles.
 class VmStatKvm : public VmStat {
 public:
+    static const uint32_t kLibvirtRefreshCycles = 10;
+
     VmStatKvm(Agent *agent, const boost::uuids::uuid &vm_uuid);
     ~VmStatKvm();
 
-    void Start();
+    virtual bool PidLookupPending() const { return pid_ == 0; }
+    virtual void Collect(const VmStatReader &reader,
+                         const std::map<std::string, uint32_t> &pids);
 private:
-    void ReadCpuStat();
-    void ReadVcpuStat();
-    void ReadMemStat();
     void ReadDiskStat();
     void ReadDiskName();
-    void GetCpuStat();
-    void GetVcpuStat();
-    void GetMemStat();
     void GetDiskName();
     void GetDiskStat();
-    bool TimerExpiry();
-    void GetPid();
-    void ReadPid();
     void ReadMemoryQuota();
     void GetMemoryQuota();
 
+    uint32_t refresh_cycles_;
+
     DISALLOW_COPY_AND_ASSIGN(VmStatKvm);
 };
 #endif // vnsw_agent_vm_stat_kvm_h
@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include <dirent.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <uve/vm_stat_reader.h>
+
+using std::set;
+using std::string;
+using std::vector;
+
+VmStatReader::ProcessStats::ProcessStats()
+    : state(0), cpu_time(0), virt_memory(0), virt_memory_peak(0), rss(0) {
+}
+
+VmStatReader::VmStatReader(const string &root)
+    : root_(root), clock_ticks_(sysconf(_SC_CLK_TCK)) {
+    if (clock_ticks_ <= 0) {
+        clock_ticks_ = 100;
+    }
+}
+
+bool VmStatReader::ReadFile(const string &path, string *contents) const {
+    std::ifstream file(path.c_str());
+    if (!file) {
+        return false;
+    }
+    std::ostringstream data;
+    data << file.rdbuf();
+    *contents = data.str();
+    return true;
+}
+
+static bool IsPid(const char *name) {
+    if (*name == '\0') {
+        return false;
+    }
+    for (const char *c = name; *c; ++c) {
+        if (*c < '0' || *c > '9') {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Equivalent of 'ps -eo pid,cmd | grep <uuid>' for all the uuids at once,
+// keeping only the processes whose command is qemu or kvm.
+void VmStatReader::FindKvmPids(const set<string> &uuids, PidMap *pids) const {
+    if (uuids.empty()) {
+        return;
+    }
+    string proc = root_ + "/proc";
+    DIR *dir = opendir(proc.c_str());
+    if (dir == NULL) {
+        return;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (!IsPid(entry->d_name)) {
+            continue;
+        }
+        string cmdline;
+        if (!ReadFile(proc + "/" + entry->d_name + "/cmdline", &cmdline) ||
+            cmdline.empty()) {
+            continue;
+        }
+        // Arguments are separated by NUL characters, the first one is the
+        // command.
+        string command(cmdline.c_str());
+        if (command.find("qemu") == string::npos &&
+            command.find("kvm") == string::npos) {
+            continue;
+        }
+        std::replace(cmdline.begin(), cmdline.end(), '\0', ' ');
+        for (set<string>::const_iterator it = uuids.begin();
+             it != uuids.end(); ++it) {
+            if (cmdline.find(*it) != string::npos) {
+                (*pids)[*it] = strtoul(entry->d_name, NULL, 10);
+            }
+        }
+    }
+    closedir(dir);
+}
+
+// Read the state and the user and system times of a process or thread from
+// its stat file. The command name is in parentheses and may contain spaces,
+// so the fields are counted from the last parenthesis.
+bool VmStatReader::ReadTaskTime(const string &path, char *state,
+                                double *cpu_time) const {
+    string contents;
+    if (!ReadFile(path, &contents)) {
+        return false;
+    }
+    size_t pos = contents.rfind(')');
+    if (pos == string::npos) {
+        return false;
+    }
+    std::istringstream fields(contents.substr(pos + 1));
+    string field;
+    uint64_t utime = 0, stime = 0;
+    fields >> *state;
+    // utime and stime are the 14th and 15th fields, state is the 3rd.
+    for (int i = 4; i < 14; ++i) {
+        fields >> field;
+    }
+    fields >> utime >> stime;
+    if (fields.fail()) {
+        return false;
+    }
+    *cpu_time = static_cast<double>(utime + stime) / clock_ticks_;
+    return true;
+}
+
+// qemu names the vcpu threads 'CPU <index>/KVM'.
+void VmStatReader::ReadVcpuTime(uint32_t pid, vector<double> *vcpu_time) const {
+    std::ostringstream task;
+    task << root_ << "/proc/" << pid << "/task";
+    DIR *dir = opendir(task.str().c_str());
+    if (dir == NULL) {
+        return;
+    }
+    std::map<uint32_t, double> vcpus;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (!IsPid(entry->d_name)) {
+            continue;
+        }
+        string path = task.str() + "/" + entry->d_name;
+        string comm;
+        if (!ReadFile(path + "/comm", &comm) || comm.compare(0, 4, "CPU ")) {
+            continue;
+        }
+        size_t end = comm.find("/KVM");
+        if (end == string::npos) {
+            continue;
+        }
+        uint32_t index = strtoul(comm.c_str() + 4, NULL, 10);
+        char state;
+        double cpu_time;
+        if (ReadTaskTime(path + "/stat", &state, &cpu_time)) {
+            vcpus[index] = cpu_time;
+        }
+    }
+    closedir(dir);
+    for (std::map<uint32_t, double>::const_iterator it = vcpus.begin();
+         it != vcpus.end(); ++it) {
+        vcpu_time->push_back(it->second);
+    }
+}
+
+bool VmStatReader::ReadProcessStats(uint32_t pid, ProcessStats *stats) const {
+    std::ostringstream proc;
+    proc << root_ << "/proc/" << pid;
+    if (!ReadTaskTime(proc.str() + "/stat", &stats->state, &stats->cpu_time)) {
+        return false;
+    }
+
+    std::ifstream file((proc.str() + "/status").c_str());
+    string line;
+    while (std::getline(file, line)) {
+        std::istringstream vm(line);
+        string tmp;
+        if (line.compare(0, 7, "VmSize:") == 0) {
+            vm >> tmp >> stats->virt_memory;
+        } else if (line.compare(0, 6, "VmRSS:") == 0) {
+            vm >> tmp >> stats->rss;
+        } else if (line.compare(0, 7, "VmPeak:") == 0) {
+            vm >> tmp >> stats->virt_memory_peak;
+        }
+    }
+
+    ReadVcpuTime(pid, &stats->vcpu_time);
+    return true;
+}
+
+string VmStatReader::CgroupPath(const string &controller, const string &cgroup,
+                                const string &file) const {
+    return root_ + "/sys/fs/cgroup/" + controller + "/" + cgroup + "/" + file;
+}
+
+bool VmStatReader::ReadCgroupCpuTime(const string &cgroup,
+                                     double *seconds) const {
+    string contents;
+    if (!ReadFile(CgroupPath("cpuacct", cgroup, "cpuacct.usage"), &contents)) {
+        return false;
+    }
+    std::istringstream usage(contents);
+    uint64_t nsecs = 0;
+    usage >> nsecs;
+    if (usage.fail()) {
+        return false;
+    }
+    *seconds = static_cast<double>(nsecs) / kOneSecInNanoSecs;
+    return true;
+}
+
+bool VmStatReader::ReadCgroupMemoryLimit(const string &cgroup,
+                                         uint32_t *limit_kib) const {
+    std::ifstream file(CgroupPath("memory", cgroup, "memory.stat").c_str());
+    string tmp;
+    while (file >> tmp) {
+        if (tmp == "hierarchical_memory_limit") {
+            uint64_t limit = 0;
+            file >> limit;
+            *limit_kib = limit / 1024;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool VmStatReader::CgroupFrozen(const string &cgroup) const {
+    string contents;
+    if (!ReadFile(CgroupPath("freezer", cgroup, "freezer.state"), &contents)) {
+        return false;
+    }
+    return contents.compare(0, 6, "FROZEN") == 0;
+}
+
+uint32_t VmStatReader::ReadCgroupPid(const string &cgroup) const {
+    std::ifstream file(CgroupPath("cpuacct", cgroup, "cgroup.procs").c_str());
+    uint32_t pid = 0;
+    file >> pid;
+    return pid;
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#ifndef vnsw_agent_vm_stat_reader_h
+#define vnsw_agent_vm_stat_reader_h
+
+#include <stdint.h>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// Reads the accounting of VM and container processes from /proc and from
+// the cgroup file system. All paths are relative to a root directory, which
+// tests set to a fake tree.
+class VmStatReader {
+public:
+    static const long kOneSecInNanoSecs = 1000000000;
+
+    struct ProcessStats {
+        ProcessStats();
+
+        char state;                     // state field of /proc/<pid>/stat
+        double cpu_time;                // user and system time in seconds
+        uint32_t virt_memory;           // VmSize in KiB
+        uint32_t virt_memory_peak;      // VmPeak in KiB
+        uint32_t rss;                   // VmRSS in KiB
+        std::vector<double> vcpu_time;  // cpu time of each vcpu thread
+    };
+
+    // Instance uuid string to pid.
+    typedef std::map<std::string, uint32_t> PidMap;
+
+    explicit VmStatReader(const std::string &root = "");
+
+    // Find the qemu/kvm processes of the instances with the given uuids in a
+    // single pass over /proc.
+    void FindKvmPids(const std::set<std::string> &uuids, PidMap *pids) const;
+
+    // Returns false if the process doesn't exist anymore.
+    bool ReadProcessStats(uint32_t pid, ProcessStats *stats) const;
+
+    // cgroup is the path of the cgroup under the hierarchy of each
+    // controller, e.g. docker/<container-id>.
+    bool ReadCgroupCpuTime(const std::string &cgroup, double *seconds) const;
+    bool ReadCgroupMemoryLimit(const std::string &cgroup,
+                               uint32_t *limit_kib) const;
+    bool CgroupFrozen(const std::string &cgroup) const;
+    // Returns the first process of the cgroup, 0 if it has none.
+    uint32_t ReadCgroupPid(const std::string &cgroup) const;
+
+    const std::string &root() const { return root_; }
+
+private:
+    bool ReadFile(const std::string &path, std::string *contents) const;
+    bool ReadTaskTime(const std::string &path, char *state,
+                      double *cpu_time) const;
+    void ReadVcpuTime(uint32_t pid, std::vector<double> *vcpu_time) const;
+    std::string CgroupPath(const std::string &controller,
+                           const std::string &cgroup,
+                           const std::string &file) const;
+
+    std::string root_;
+    long clock_ticks_;
+};
+
+#endif // vnsw_agent_vm_stat_reader_h
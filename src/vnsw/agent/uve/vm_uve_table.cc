@@ -10,7 +10,8 @@
 #include <uve/vm_stat_docker.h>
 
 VmUveTable::VmUveTable(Agent *agent, uint32_t default_intvl)
-    : VmUveTableBase(agent, default_intvl) {
+    : VmUveTableBase(agent, default_intvl),
+      vm_stat_collector_(new VmStatCollector(agent)) {
     event_queue_.reset(new WorkQueue<VmStatData *>
             (TaskScheduler::GetInstance()->GetTaskId("Agent::Uve"), 0,
              boost::bind(&VmUveTable::Process, this, _1)));
@@ -64,12 +65,14 @@ void VmUveTable::VmStatCollectionStart(VmUveVmState *state, const VmEntry *vm) {
 
     if (stat) {
         stat->Start();
+        vm_stat_collector_->Add(stat);
         state->stat_ = stat;
     }
 }
 
 void VmUveTable::VmStatCollectionStop(VmUveVmState *state) {
     if (state->stat_) {
+        vm_stat_collector_->Remove(state->stat_);
         state->stat_->Stop();
         state->stat_ = NULL;
     }
@@ -10,6 +10,7 @@
 #include <uve/l4_port_bitmap.h>
 #include <pkt/flow_proto.h>
 #include <pkt/flow_table.h>
+#include <uve/vm_stat_collector.h>
 
 class VmUveTable : public VmUveTableBase {
 public:
@@ -21,6 +22,7 @@ public:
     bool Process(VmStatData *vm_stat_data);
     void SendVmStats(void);
     virtual void DispatchVmStatsMsg(const VirtualMachineStats &uve);
+    VmStatCollector *vm_stat_collector() { return vm_stat_collector_.get(); }
 protected:
     virtual void VmStatCollectionStart(VmUveVmState *state, const VmEntry *vm);
     virtual void VmStatCollectionStop(VmUveVmState *state);
@@ -30,6 +32,7 @@ private:
     virtual void SendVmDeleteMsg(const std::string &vm_config_name);
 
     boost::scoped_ptr<WorkQueue<VmStatData *> > event_queue_;
+    boost::scoped_ptr<VmStatCollector> vm_stat_collector_;
     DISALLOW_COPY_AND_ASSIGN(VmUveTable);
 };
 
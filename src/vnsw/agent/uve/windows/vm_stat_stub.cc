@@ -2,6 +2,8 @@
  * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
  */
 
+#include <uve/uve_types.h>
+#include <uve/vm_stat_collector.h>
 #include <uve/vm_stat_kvm.h>
 #include <uve/vm_stat_docker.h>
 
@@ -21,8 +23,8 @@ void VmStat::Stop() {
 void VmStat::ProcessData() {
 }
 
-bool VmStat::TimerExpiry() {
-    return false;
+void VmStat::Collect(const VmStatReader &reader,
+                     const std::map<std::string, uint32_t> &pids) {
 }
 
 VmStatKvm::VmStatKvm(Agent *agent, const boost::uuids::uuid &vm_uuid)
@@ -32,11 +34,8 @@ VmStatKvm::VmStatKvm(Agent *agent, const boost::uuids::uuid &vm_uuid)
 VmStatKvm::~VmStatKvm() {
 }
 
-void VmStatKvm::Start() {
-}
-
-bool VmStatKvm::TimerExpiry() {
-    return false;
+void VmStatKvm::Collect(const VmStatReader &reader,
+                        const std::map<std::string, uint32_t> &pids) {
 }
 
 VmStatDocker::VmStatDocker(Agent *agent, const boost::uuids::uuid &vm_uuid)
@@ -49,6 +48,34 @@ VmStatDocker::~VmStatDocker() {
 void VmStatDocker::Start() {
 }
 
-bool VmStatDocker::TimerExpiry() {
+void VmStatDocker::Collect(const VmStatReader &reader,
+                           const std::map<std::string, uint32_t> &pids) {
+}
+
+VmStatReader::VmStatReader(const std::string &root) : root_(root) {
+}
+
+VmStatCollector::VmStatCollector(Agent *agent) : agent_(agent) {
+}
+
+VmStatCollector::~VmStatCollector() {
+}
+
+void VmStatCollector::Add(VmStat *stat) {
+}
+
+void VmStatCollector::Remove(VmStat *stat) {
+}
+
+bool VmStatCollector::Run() {
     return false;
 }
+
+void VmStatCollector::FillInfo(VmStatCollectorInfoResp *resp) const {
+}
+
+void VmStatCollectorInfoReq::HandleRequest() const {
+    VmStatCollectorInfoResp *resp = new VmStatCollectorInfoResp();
+    resp->set_context(context());
+    resp->Response();
+}
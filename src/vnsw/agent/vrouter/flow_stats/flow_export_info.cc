@@ -6,7 +6,8 @@ FlowExportInfo::FlowExportInfo() :
     bytes_(0), packets_(0),
     delete_enqueue_time_(0), evict_enqueue_time_(0),
     gen_id_(0),
-    flow_handle_(FlowEntry::kInvalidFlowHandle) {
+    flow_handle_(FlowEntry::kInvalidFlowHandle), index_(kInvalidIndex),
+    in_ageing_(false), ageing_seq_(0), next_visit_time_(0), idle_count_(0) {
 }
 
 FlowExportInfo::FlowExportInfo(const FlowEntryPtr &fe) :
@@ -14,7 +15,8 @@ FlowExportInfo::FlowExportInfo(const FlowEntryPtr &fe) :
     bytes_(0), packets_(0),
     delete_enqueue_time_(0), evict_enqueue_time_(0),
     gen_id_(0),
-    flow_handle_(FlowEntry::kInvalidFlowHandle) {
+    flow_handle_(FlowEntry::kInvalidFlowHandle), index_(kInvalidIndex),
+    in_ageing_(false), ageing_seq_(0), next_visit_time_(0), idle_count_(0) {
 }
 
 FlowExportInfo::FlowExportInfo(const FlowEntryPtr &fe, uint64_t setup_time) :
@@ -23,7 +25,8 @@ FlowExportInfo::FlowExportInfo(const FlowEntryPtr &fe, uint64_t setup_time) :
     bytes_(0), packets_(0),
     delete_enqueue_time_(0), evict_enqueue_time_(0),
     gen_id_(0),
-    flow_handle_(FlowEntry::kInvalidFlowHandle) {
+    flow_handle_(FlowEntry::kInvalidFlowHandle), index_(kInvalidIndex),
+    in_ageing_(false), ageing_seq_(0), next_visit_time_(0), idle_count_(0) {
 }
 
 FlowEntry* FlowExportInfo::reverse_flow() const {
@@ -43,3 +46,48 @@ void FlowExportInfo::CopyFlowInfo(FlowEntry *fe) {
 void FlowExportInfo::ResetStats() {
     bytes_ = packets_ = 0;
 }
+
+FlowExportInfoArray::FlowExportInfoArray() : size_(0) {
+}
+
+FlowExportInfoArray::~FlowExportInfoArray() {
+    for (std::vector<FlowExportInfo *>::iterator it = blocks_.begin();
+         it != blocks_.end(); ++it) {
+        delete [] *it;
+    }
+}
+
+FlowExportInfo *FlowExportInfoArray::Alloc(const FlowExportInfo &info) {
+    if (free_list_.empty()) {
+        uint32_t base = capacity();
+        blocks_.push_back(new FlowExportInfo[kBlockSize]);
+        // Push in reverse so that lower indices are used first
+        for (uint32_t i = kBlockSize; i > 0; i--) {
+            free_list_.push_back(base + i - 1);
+        }
+    }
+    uint32_t index = free_list_.back();
+    free_list_.pop_back();
+    size_++;
+
+    FlowExportInfo *entry = At(index);
+    uint32_t seq = entry->ageing_seq();
+    *entry = info;
+    entry->set_index(index);
+    entry->set_in_ageing(false);
+    entry->set_ageing_seq(seq);
+    return entry;
+}
+
+void FlowExportInfoArray::Free(FlowExportInfo *info) {
+    assert(info->flow() != NULL);
+    uint32_t index = info->index();
+    // Retain sequence number so that stale references to the entry in
+    // ageing wheel are not mistaken for the next user of the entry
+    uint32_t seq = info->ageing_seq();
+    *info = FlowExportInfo();
+    info->set_index(index);
+    info->set_ageing_seq(seq);
+    free_list_.push_back(index);
+    size_--;
+}
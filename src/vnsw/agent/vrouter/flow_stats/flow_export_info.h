@@ -7,8 +7,10 @@
 #include <pkt/flow_entry.h>
 #include <filter/acl.h>
 
-class FlowExportInfo : public boost::intrusive::list_base_hook<> {
+class FlowExportInfo {
 public:
+    static const uint32_t kInvalidIndex = 0xFFFFFFFF;
+
     FlowExportInfo();
     FlowExportInfo(const FlowEntryPtr &fe, uint64_t setup_time);
     FlowExportInfo(const FlowEntryPtr &fe);
@@ -39,6 +41,18 @@ public:
     void CopyFlowInfo(FlowEntry *fe);
     void ResetStats();
 
+    // Ageing state maintained by FlowStatsCollector
+    uint32_t index() const { return index_; }
+    void set_index(uint32_t index) { index_ = index; }
+    bool in_ageing() const { return in_ageing_; }
+    void set_in_ageing(bool value) { in_ageing_ = value; }
+    uint32_t ageing_seq() const { return ageing_seq_; }
+    void set_ageing_seq(uint32_t value) { ageing_seq_ = value; }
+    uint64_t next_visit_time() const { return next_visit_time_; }
+    void set_next_visit_time(uint64_t time) { next_visit_time_ = time; }
+    uint8_t idle_count() const { return idle_count_; }
+    void set_idle_count(uint8_t value) { idle_count_ = value; }
+
 private:
     FlowEntryPtr flow_;
     uint64_t teardown_time_;
@@ -50,7 +64,45 @@ private:
     uint8_t gen_id_;
     uint32_t flow_handle_;
     boost::uuids::uuid uuid_;
+    // Index in FlowExportInfoArray
+    uint32_t index_;
+    bool in_ageing_;
+    // Incremented whenever flow is scheduled afresh in the ageing wheel.
+    // Wheel entries with older sequence number are ignored
+    uint32_t ageing_seq_;
+    // Monotonic time at which flow must be visited next for ageing
+    uint64_t next_visit_time_;
+    // Number of consecutive visits that found no change in stats
+    uint8_t idle_count_;
+};
+
+////////////////////////////////////////////////////////////////////////////
+// Array of FlowExportInfo entries. Entries are allocated in blocks of
+// kBlockSize so that the array can grow without moving entries. Pointers to
+// an entry remain valid till the entry is freed. Free entries have NULL
+// flow() and are reused before growing the array
+////////////////////////////////////////////////////////////////////////////
+class FlowExportInfoArray {
+public:
+    static const uint32_t kBlockSize = 1024;
+
+    FlowExportInfoArray();
+    ~FlowExportInfoArray();
+
+    FlowExportInfo *Alloc(const FlowExportInfo &info);
+    void Free(FlowExportInfo *info);
+    FlowExportInfo *At(uint32_t index) const {
+        return &blocks_[index / kBlockSize][index % kBlockSize];
+    }
+    // Number of entries allocated including free entries
+    uint32_t capacity() const { return blocks_.size() * kBlockSize; }
+    uint32_t size() const { return size_; }
+
+private:
+    std::vector<FlowExportInfo *> blocks_;
+    std::vector<uint32_t> free_list_;
+    uint32_t size_;
+    DISALLOW_COPY_AND_ASSIGN(FlowExportInfoArray);
 };
 
-typedef boost::intrusive::list<FlowExportInfo> FlowExportInfoList;
 #endif //  __AGENT_FLOW_EXPORT_INFO_H__
@@ -49,10 +49,11 @@ FlowStatsCollector::FlowStatsCollector(boost::asio::io_service &io, int intvl,
         task_id_(uve->agent()->task_scheduler()->GetTaskId
                  (kTaskFlowStatsCollector)),
         rand_gen_(boost::uuids::random_generator()),
-        flow_iteration_key_(NULL),
-        entries_to_visit_(0),
         flow_tcp_syn_age_time_(FlowTcpSynAgeTime),
-        retry_delete_(true),
+        ageing_count_(0), ageing_wheel_(kAgeingWheelSize),
+        wheel_tick_(GetWheelTick(ClockMonotonicUsec())),
+        wheel_pending_pos_(0), sweep_pending_(false), sweep_index_(0),
+        sweep_threshold_(kMinFlowsPerTimer), retry_delete_(true),
         request_queue_(agent_uve_->agent()->task_scheduler()->
                        GetTaskId(kTaskFlowStatsCollector),
                        instance_id,
@@ -67,6 +68,7 @@ FlowStatsCollector::FlowStatsCollector(boost::asio::io_service &io, int intvl,
         } else {
             flow_age_time_intvl_ = FlowAgeTime;
         }
+        wheel_age_time_ = flow_age_time_intvl_;
         deleted_ = false;
         request_queue_.set_name("Flow stats collector");
         request_queue_.set_measure_busy_time
@@ -75,9 +77,6 @@ FlowStatsCollector::FlowStatsCollector(boost::asio::io_service &io, int intvl,
             (boost::bind(&FlowStatsCollector::RequestHandlerEntry, this));
         request_queue_.SetExitCallback
             (boost::bind(&FlowStatsCollector::RequestHandlerExit, this, _1));
-        // Aging timer fires every kFlowStatsTimerInterval msec. Compute
-        // number of timer fires needed to scan complete table
-        timers_per_scan_ = TimersPerScan();
         InitDone();
 }
 
@@ -99,53 +98,88 @@ void FlowStatsCollector::Shutdown() {
     request_queue_.Shutdown();
 }
 
-// We want to scan the flow table every 25% of configured ageing time.
-// Compute number of timer fires needed to scan the flow-table once.
-uint32_t FlowStatsCollector::TimersPerScan() {
-    uint64_t scan_time_millisec;
-    /* Use Age Time itself as scan-time for flows */
+uint64_t FlowStatsCollector::GetWheelTick(uint64_t time) {
+    return time / (kFlowStatsTimerInterval * 1000);
+}
 
-    // Convert aging-time configured in micro-sec to millisecond
-    scan_time_millisec = flow_age_time_intvl_ / 1000;
+// Active flows are visited every kFlowScanTime % of configured ageing time
+uint64_t FlowStatsCollector::ScanInterval() const {
+    uint64_t interval = (flow_age_time_intvl_ * kFlowScanTime) / 100;
 
-    // Compute time in which we must scan the complete table to honor the
-    // kFlowScanTime
-    scan_time_millisec = (scan_time_millisec * kFlowScanTime) / 100;
+    // Enforce min value on scan-interval
+    if (interval < kFlowStatsTimerInterval * 1000) {
+        interval = kFlowStatsTimerInterval * 1000;
+    }
+    return interval;
+}
 
-    // Enforce min value on scan-time
-    if (scan_time_millisec < kFlowStatsTimerInterval) {
-        scan_time_millisec = kFlowStatsTimerInterval;
+// Compute monotonic time for next visit of flow. Active flows are visited
+// after the scan-interval. Idle flows are visited after exponentially
+// increasing intervals, but not later than the time when the flow can be
+// aged. Flows that can be aged already are not backed off, and flows with a
+// delete or evict request pending are visited again when the request can be
+// retried
+uint64_t FlowStatsCollector::NextVisitTime(FlowExportInfo *info,
+                                           uint64_t curr_time,
+                                           uint64_t mono_time, bool active) {
+    uint64_t interval = ScanInterval();
+    if (active) {
+        info->set_idle_count(0);
+        return mono_time + interval;
     }
 
-    // Number of timer fires needed to scan table once
-    return scan_time_millisec / kFlowStatsTimerInterval;
-}
+    uint64_t age_time = info->last_modified_time() + flow_age_time_intvl_;
+    if (age_time > curr_time) {
+        if (info->idle_count() < kMaxIdleBackoff) {
+            info->set_idle_count(info->idle_count() + 1);
+        }
+        interval <<= info->idle_count();
+        if ((age_time - curr_time) < interval) {
+            interval = age_time - curr_time;
+        }
+    }
 
-// Update entries_to_visit_ based on total flows
-// Timer fires every kFlowScanTime. Its possible that we may not have visited
-// all entries by the time next timer fires. So, keep accumulating the number
-// of entries to visit into entries_to_visit_
-//
-// A lower-bound and an upper-bound are enforced on entries_to_visit_
-void FlowStatsCollector::UpdateEntriesToVisit() {
-    // Compute number of flows to visit per scan-time
-    uint32_t count = flow_export_info_list_.size();
-    uint32_t entries = count / timers_per_scan_;
+    // Retry is done only once kFlowDeleteRetryTime has elapsed, allow one
+    // more timer interval for the granularity of the wheel
+    if (info->delete_enqueue_time() || info->evict_enqueue_time()) {
+        uint64_t retry = kFlowDeleteRetryTime + kFlowStatsTimerInterval * 1000;
+        if (retry < interval) {
+            interval = retry;
+        }
+    }
 
-    // Update number of entries to visit in flow.
-    // The scan for previous timer may still be in progress. So, accmulate
-    // number of entries to visit
-    entries_to_visit_ += entries;
+    if (interval < kFlowStatsTimerInterval * 1000) {
+        interval = kFlowStatsTimerInterval * 1000;
+    }
+    return mono_time + interval;
+}
 
-    // Cap number of entries to visit to 25% of table
-    if (entries_to_visit_ > ((count * kFlowScanTime)/100))
-        entries_to_visit_ = (count * kFlowScanTime)/100;
+// Add flow to ageing wheel to be visited at time
+void FlowStatsCollector::StartAgeing(FlowExportInfo *info, uint64_t time) {
+    assert(info->in_ageing() == false);
+    info->set_in_ageing(true);
+    info->set_idle_count(0);
+    ageing_count_++;
+    ScheduleAgeing(info, time);
+}
 
-    // Apply lower-limit
-    if (entries_to_visit_ < kMinFlowsPerTimer)
-        entries_to_visit_ = kMinFlowsPerTimer;
+// Remove flow from ageing. Entry in wheel is ignored since sequence number
+// does not match anymore
+void FlowStatsCollector::StopAgeing(FlowExportInfo *info) {
+    assert(info->in_ageing());
+    info->set_in_ageing(false);
+    info->set_ageing_seq(info->ageing_seq() + 1);
+    ageing_count_--;
+}
 
-    return;
+// Add a new entry for flow in the wheel. The slot being processed has been
+// removed from wheel already, so entries due earlier go to the next slot
+void FlowStatsCollector::ScheduleAgeing(FlowExportInfo *info, uint64_t time) {
+    info->set_ageing_seq(info->ageing_seq() + 1);
+    info->set_next_visit_time(time);
+    uint64_t tick = std::max(GetWheelTick(time), wheel_tick_);
+    ageing_wheel_[tick % kAgeingWheelSize].push_back
+        (AgeingWheelEntry(info->index(), info->ageing_seq()));
 }
 
 bool FlowStatsCollector::ShouldBeAged(FlowExportInfo *info,
@@ -449,7 +483,7 @@ void FlowStatsCollector::UpdateFlowStats(FlowExportInfo *info,
 }
 
 void FlowStatsCollector::FlowDeleteEnqueue(FlowExportInfo *info, uint64_t t) {
-    flows_aged_++;
+    cycle_stats_.flows_aged++;
     FlowEntry *fe = info->flow();
     agent_uve_->agent()->pkt()->get_flow_proto()->DeleteFlowRequest(fe);
     info->set_delete_enqueue_time(t);
@@ -465,7 +499,7 @@ void FlowStatsCollector::FlowDeleteEnqueue(FlowExportInfo *info, uint64_t t) {
 void FlowStatsCollector::FlowEvictEnqueue(FlowExportInfo *info, uint64_t t,
                                           uint32_t flow_handle,
                                           uint16_t gen_id) {
-    flows_evicted_++;
+    cycle_stats_.flows_evicted++;
     FlowEntry *fe = info->flow();
     agent_uve_->agent()->pkt()->get_flow_proto()->EvictFlowRequest
         (fe, flow_handle, gen_id, (gen_id + 1));
@@ -622,8 +656,7 @@ bool FlowStatsCollector::AgeFlow(KSyncFlowMemory *ksync_obj,
 }
 
 // Check if a flow is to be aged or evicted. Returns number of flows visited
-uint32_t FlowStatsCollector::ProcessFlow(FlowExportInfoList::iterator &it,
-                                         KSyncFlowMemory *ksync_obj,
+uint32_t FlowStatsCollector::ProcessFlow(KSyncFlowMemory *ksync_obj,
                                          FlowExportInfo *info,
                                          uint64_t curr_time) {
     uint32_t count = 1;
@@ -669,16 +702,12 @@ uint32_t FlowStatsCollector::ProcessFlow(FlowExportInfoList::iterator &it,
         // Flow evicted?
         if (EvictFlow(ksync_obj, k_flow, kinfo.flags, flow_handle, gen_id,
                       info, curr_time) == true) {
-            // If retry_delete_ enabled, dont change flow_export_info_list_
+            // If retry_delete_ enabled, dont remove flow from ageing
             if (retry_delete_ == true)
                 return count;
 
-            // We dont want to retry delete-events, remove flow from ageing list
-            assert(info->is_linked());
-            FlowExportInfoList::iterator flow_it =
-                flow_export_info_list_.iterator_to(*info);
-            flow_export_info_list_.erase(flow_it);
-
+            // We dont want to retry delete-events, remove flow from ageing
+            StopAgeing(info);
             return count;
         }
     }
@@ -688,82 +717,131 @@ uint32_t FlowStatsCollector::ProcessFlow(FlowExportInfoList::iterator &it,
     if (AgeFlow(ksync_obj, k_flow, k_stats, kinfo, info, curr_time) == false)
         return count;
 
-    // If retry_delete_ enabled, dont change flow_export_info_list_
+    // If retry_delete_ enabled, dont remove flow from ageing
     if (retry_delete_ == false)
         return count;
 
     // Flow aged, remove both forward and reverse flow
-    assert(info->is_linked());
-    FlowExportInfoList::iterator flow_it =
-        flow_export_info_list_.iterator_to(*info);
-    flow_export_info_list_.erase(flow_it);
+    StopAgeing(info);
 
     FlowEntry *rfe = info->reverse_flow();
     FlowExportInfo *rev_info = FindFlowExportInfo(rfe);
     if (rev_info) {
-        if (rev_info->is_linked()) {
-            FlowExportInfoList::iterator rev_flow_it =
-                flow_export_info_list_.iterator_to(*rev_info);
-            if (rev_flow_it == it) {
-                it++;
-            }
-            flow_export_info_list_.erase(rev_flow_it);
+        if (rev_info->in_ageing()) {
+            StopAgeing(rev_info);
         }
         count++;
     }
     return count;
 }
 
-uint32_t FlowStatsCollector::RunAgeing(uint32_t max_count) {
-    FlowExportInfoList::iterator it;
-    if (flow_iteration_key_ == NULL) {
-        it = flow_export_info_list_.begin();
+// Visit a flow and schedule next visit if its still being aged. An entry
+// popped from wheel is consumed and a new entry is added. Otherwise, the
+// existing entry is moved when it reaches its slot, unless the flow must
+// be visited earlier than the existing entry
+uint32_t FlowStatsCollector::VisitFlow(KSyncFlowMemory *ksync_obj,
+                                       FlowExportInfo *info,
+                                       uint64_t curr_time, uint64_t mono_time,
+                                       bool from_wheel) {
+    cycle_stats_.flows_visited++;
+    uint32_t count = ProcessFlow(ksync_obj, info, curr_time);
+    if (info->in_ageing() == false)
+        return count;
+
+    // Stats are updated with curr_time as modified time if they changed
+    bool active = (info->last_modified_time() == curr_time);
+    uint64_t next = NextVisitTime(info, curr_time, mono_time, active);
+    if (from_wheel || next < info->next_visit_time()) {
+        ScheduleAgeing(info, next);
     } else {
-        FlowEntryTree::iterator tree_it = flow_tree_.find(flow_iteration_key_);
-        // Flow to iterate next is not found. Force stop this iteration.
-        // We will continue from begining on next timer
-        if (tree_it == flow_tree_.end()) {
-            flow_iteration_key_ = NULL;
-            return entries_to_visit_;
-        }
-        it = flow_export_info_list_.iterator_to(tree_it->second);
+        info->set_next_visit_time(next);
+    }
+    return count;
+}
+
+// Visit all flows being aged, starting from sweep_index_
+uint32_t FlowStatsCollector::RunSweep(KSyncFlowMemory *ksync_obj,
+                                      uint32_t max_count, uint64_t curr_time,
+                                      uint64_t mono_time) {
+    uint32_t count = 0;
+    uint32_t capacity = flow_export_info_array_.capacity();
+    while (count < max_count && sweep_index_ < capacity) {
+        FlowExportInfo *info = flow_export_info_array_.At(sweep_index_);
+        sweep_index_++;
+        if (info->in_ageing() == false)
+            continue;
+        count += VisitFlow(ksync_obj, info, curr_time, mono_time, false);
+    }
+
+    if (sweep_index_ >= capacity) {
+        sweep_pending_ = false;
+        sweep_index_ = 0;
     }
+    return count;
+}
 
+// Visit flows in wheel slots that are due. Stale entries and entries moved
+// to other slots are counted as visits to bound the work done per task run
+uint32_t FlowStatsCollector::RunAgeing(uint32_t max_count) {
     KSyncFlowMemory *ksync_obj = agent_uve_->agent()->ksync()->
         ksync_flow_memory();
     uint64_t curr_time = GetCurrentTime();
+    uint64_t mono_time = ClockMonotonicUsec();
     uint32_t count = 0;
+
+    if (sweep_pending_) {
+        count += RunSweep(ksync_obj, max_count, curr_time, mono_time);
+    }
+
+    uint64_t target_tick = GetWheelTick(mono_time);
+    // No flows in wheel, skip to current tick
+    if (ageing_count_ == 0) {
+        wheel_pending_.clear();
+        wheel_pending_pos_ = 0;
+        wheel_tick_ = std::max(wheel_tick_, target_tick);
+        return count;
+    }
+
     while (count < max_count) {
-        if (it == flow_export_info_list_.end()) {
-            break;
+        if (wheel_pending_pos_ >= wheel_pending_.size()) {
+            wheel_pending_.clear();
+            wheel_pending_pos_ = 0;
+            if (wheel_tick_ > target_tick)
+                break;
+            wheel_pending_.swap
+                (ageing_wheel_[wheel_tick_ % kAgeingWheelSize]);
+            wheel_tick_++;
+            continue;
         }
 
-        FlowExportInfo *info = &(*it);
-        it++;
-        flows_visited_++;
-        count += ProcessFlow(it, ksync_obj, info, curr_time);
-    }
+        AgeingWheelEntry entry = wheel_pending_[wheel_pending_pos_++];
+        FlowExportInfo *info = flow_export_info_array_.At(entry.index);
+        if (info->in_ageing() == false || info->ageing_seq() != entry.seq) {
+            count++;
+            continue;
+        }
 
-    // Update iterator for next pass
-    if (it == flow_export_info_list_.end()) {
-        flow_iteration_key_ = NULL;
-    } else {
-        flow_iteration_key_ = it->flow();
+        // Flow was visited in a sweep or is due in a later rotation of wheel
+        uint64_t tick = GetWheelTick(info->next_visit_time());
+        if (tick >= wheel_tick_) {
+            ageing_wheel_[tick % kAgeingWheelSize].push_back(entry);
+            count++;
+            continue;
+        }
+
+        count += VisitFlow(ksync_obj, info, curr_time, mono_time, true);
     }
 
     return count;
 }
 
-// Timer fired for ageing. Update the number of entries to visit and start the
-// task if its already not ruuning
+// Timer fired for ageing. Start the task to visit flows that are due if its
+// already not running
 bool FlowStatsCollector::Run() {
-    if (flow_tree_.size() == 0) {
+    if (flow_index_map_.size() == 0) {
         return true;
      }
 
-    // Update number of entries to visit in flow.
-    UpdateEntriesToVisit();
-
     // Start task to scan the entries
     if (ageing_task_ == NULL) {
         ageing_task_starts_++;
@@ -773,15 +851,26 @@ bool FlowStatsCollector::Run() {
                 UTCUsecToString(ClockMonotonicUsec())
                 << " AgeingTasks Num " << ageing_task_starts_
                 << " Request count " << request_queue_.Length()
-                << " Tree size " << flow_tree_.size()
-                << " List size " << flow_export_info_list_.size()
-                << " flows visited " << flows_visited_
-                << " flows aged " << flows_aged_
-                << " flows evicted " << flows_evicted_);
+                << " Tree size " << flow_index_map_.size()
+                << " Ageing size " << ageing_count_
+                << " flows visited " << cycle_stats_.flows_visited
+                << " flows aged " << cycle_stats_.flows_aged
+                << " flows evicted " << cycle_stats_.flows_evicted
+                << " scan time " << cycle_stats_.scan_time);
+        }
+        last_cycle_stats_ = cycle_stats_;
+        cycle_stats_ = FlowAgeingCycleStats();
+
+        // Small tables are scanned completely on every timer. Flows in the
+        // wheel are also visited again when ageing time is changed, so that
+        // their visits are scheduled with the new ageing time
+        if ((ageing_count_ < sweep_threshold_ ||
+             wheel_age_time_ != flow_age_time_intvl_) &&
+            sweep_pending_ == false) {
+            wheel_age_time_ = flow_age_time_intvl_;
+            sweep_pending_ = true;
+            sweep_index_ = 0;
         }
-        flows_visited_ = 0;
-        flows_aged_ = 0;
-        flows_evicted_ = 0;
         ageing_task_ = new AgeingTask(this);
         agent_uve_->agent()->task_scheduler()->Enqueue(ageing_task_);
     }
@@ -789,16 +878,13 @@ bool FlowStatsCollector::Run() {
 }
 
 bool FlowStatsCollector::RunAgeingTask() {
+    uint64_t start = ClockMonotonicUsec();
     // Run ageing per task
     uint32_t count = RunAgeing(kFlowsPerTask);
-    // Update number of entries visited
-    if (count < entries_to_visit_)
-        entries_to_visit_ -= count;
-    else
-        entries_to_visit_ = 0;
-    // Done with task if we reach end of tree or count is exceeded
-    if (flow_iteration_key_ == NULL || entries_to_visit_ == 0) {
-        entries_to_visit_ = 0;
+    cycle_stats_.scan_time += ClockMonotonicUsec() - start;
+
+    // Done with task if all flows due are visited
+    if (count < kFlowsPerTask) {
         ageing_task_ = NULL;
         return true;
     }
@@ -859,14 +945,14 @@ bool FlowStatsCollector::RequestHandler(boost::shared_ptr<FlowExportReq> req) {
     }
 
     case FlowExportReq::DELETE_FLOW: {
-        FlowEntryTree::iterator it;
+        FlowIndexMap::iterator it;
         // Get the FlowExportInfo for flow
         if (FindFlowExportInfo(flow, it) == false)
             break;
 
         /* We don't export flows in TSN mode */
         if (agent_uve_->agent()->tsn_enabled() == false) {
-            FlowExportInfo *info = &it->second;
+            FlowExportInfo *info = flow_export_info_array_.At(it->second);
             /* While updating stats for evicted flows, we set the teardown_time
              * and export the flow. So delete handling for evicted flows need
              * not update stats and export flow */
@@ -901,28 +987,28 @@ bool FlowStatsCollector::RequestHandler(boost::shared_ptr<FlowExportReq> req) {
 
 FlowExportInfo *
 FlowStatsCollector::FindFlowExportInfo(const FlowEntry *fe) {
-    FlowEntryTree::iterator it = flow_tree_.find(fe);
-    if (it == flow_tree_.end()) {
+    FlowIndexMap::iterator it = flow_index_map_.find(fe);
+    if (it == flow_index_map_.end()) {
         return NULL;
     }
 
-    return &it->second;
+    return flow_export_info_array_.At(it->second);
 }
 
 const FlowExportInfo *
 FlowStatsCollector::FindFlowExportInfo(const FlowEntry *fe) const {
-    FlowEntryTree::const_iterator it = flow_tree_.find(fe);
-    if (it == flow_tree_.end()) {
+    FlowIndexMap::const_iterator it = flow_index_map_.find(fe);
+    if (it == flow_index_map_.end()) {
         return NULL;
     }
 
-    return &it->second;
+    return flow_export_info_array_.At(it->second);
 }
 
 bool FlowStatsCollector::FindFlowExportInfo(const FlowEntry *fe,
-                                            FlowEntryTree::iterator &it) {
-    it = flow_tree_.find(fe);
-    if (it == flow_tree_.end()) {
+                                            FlowIndexMap::iterator &it) {
+    it = flow_index_map_.find(fe);
+    if (it == flow_index_map_.end()) {
         return false;
     }
     return true;
@@ -970,10 +1056,10 @@ void FlowStatsCollector::AddFlow(FlowExportInfo info) {
      */
     FlowEntry* fe = info.flow();
     info.CopyFlowInfo(fe);
-    std::pair<FlowEntryTree::iterator, bool> ret =
-        flow_tree_.insert(make_pair(fe, info));
-    if (ret.second == false) {
-        FlowExportInfo &prev = ret.first->second;
+    FlowExportInfo *entry = NULL;
+    FlowIndexMap::iterator it = flow_index_map_.find(fe);
+    if (it != flow_index_map_.end()) {
+        FlowExportInfo &prev = *flow_export_info_array_.At(it->second);
         if (prev.uuid() != fe->uuid()) {
             /* Received ADD request for already added entry with a different
              * UUID. Because of state-compression of messages to
@@ -994,63 +1080,27 @@ void FlowStatsCollector::AddFlow(FlowExportInfo info) {
         prev.set_delete_enqueue_time(0);
         prev.set_evict_enqueue_time(0);
         prev.set_teardown_time(0);
+        entry = &prev;
     } else {
+        entry = flow_export_info_array_.Alloc(info);
+        flow_index_map_.insert(make_pair(fe, entry->index()));
         NewFlow(info.flow());
     }
-    if (ret.first->second.is_linked() == false) {
-        flow_export_info_list_.push_back(ret.first->second);
-    }
-}
-
-// The flow being deleted may be the first flow to visit in next ageing
-// iteration. Update the flow to visit next in such case
-void FlowStatsCollector::UpdateFlowIterationKey
-(const FlowEntry *del_flow, FlowEntryTree::iterator &tree_it) {
-    // Flow not found in tree is not a valid scenario. Lets be safe and
-    // restart walk here
-    if (tree_it == flow_tree_.end()) {
-        flow_iteration_key_ = NULL;
-    }
-
-    if (flow_iteration_key_ == NULL) {
-        return;
-    }
 
-    // The flow to visit next for ageing is being deleted. Update next flow to
-    // visit
-    FlowExportInfoList::iterator it =
-        flow_export_info_list_.iterator_to(tree_it->second);
-    ++it;
-
-    // If this is end of list, start from begining again
-    if (it == flow_export_info_list_.end())
-        it = flow_export_info_list_.begin();
-
-    if (it == flow_export_info_list_.end()) {
-        flow_iteration_key_ = NULL;
-    } else {
-        flow_iteration_key_ = it->flow();
+    // Visit new flows on next timer, so that short flows are deleted early
+    if (entry->in_ageing() == false) {
+        StartAgeing(entry,
+                    ClockMonotonicUsec() + kFlowStatsTimerInterval * 1000);
     }
 }
 
-void FlowStatsCollector::DeleteFlow(FlowEntryTree::iterator &it) {
-    // Update flow_iteration_key_ if flow being deleted is flow to visit in
-    // next ageing cycle
-    // Nothing to do if flow being deleted is not the next-iteration key
-    if (it->first == flow_iteration_key_) {
-        UpdateFlowIterationKey(it->first, it);
-    }
-
-    if (it == flow_tree_.end())
-        return;
-
-    if (it->second.is_linked()) {
-        FlowExportInfoList::iterator it1 =
-            flow_export_info_list_.iterator_to(it->second);
-        flow_export_info_list_.erase(it1);
+void FlowStatsCollector::DeleteFlow(FlowIndexMap::iterator &it) {
+    FlowExportInfo *info = flow_export_info_array_.At(it->second);
+    if (info->in_ageing()) {
+        StopAgeing(info);
     }
-
-    flow_tree_.erase(it);
+    flow_export_info_array_.Free(info);
+    flow_index_map_.erase(it);
 }
 
 void FlowStatsCollector::EvictedFlowStatsUpdate(const FlowEntryPtr &flow,
@@ -1124,16 +1174,17 @@ static void FlowExportInfoToSandesh(const FlowExportInfo &value,
 }
 
 void FlowStatsRecordsReq::HandleRequest() const {
-    FlowStatsCollector::FlowEntryTree::iterator it;
+    FlowStatsCollector::FlowIndexMap::iterator it;
     vector<FlowStatsRecord> list;
     FlowStatsRecordsResp *resp = new FlowStatsRecordsResp();
     for (int i = 0; i < FlowStatsCollectorObject::kMaxCollectors; i++) {
         FlowStatsCollector *col = Agent::GetInstance()->
             flow_stats_manager()->default_flow_stats_collector_obj()->
             GetCollector(i);
-        it = col->flow_tree_.begin();
-        while (it != col->flow_tree_.end()) {
-            const FlowExportInfo &value = it->second;
+        it = col->flow_index_map_.begin();
+        while (it != col->flow_index_map_.end()) {
+            const FlowExportInfo &value =
+                *col->flow_export_info_array_.At(it->second);
             ++it;
 
             SandeshFlowKey skey;
@@ -1243,7 +1294,7 @@ uint64_t FlowStatsCollectorObject::GetFlowAgeTime() const {
 
 bool FlowStatsCollectorObject::CanDelete() const {
     for (int i = 0; i < kMaxCollectors; i++) {
-        if (collectors[i]->flow_tree_.size() != 0 ||
+        if (collectors[i]->flow_index_map_.size() != 0 ||
             collectors[i]->request_queue_.IsQueueEmpty() == false) {
             return false;
         }
@@ -1287,3 +1338,10 @@ size_t FlowStatsCollectorObject::Size() const {
     }
     return size;
 }
+
+void FlowStatsCollectorObject::GetAgeingCycleStats
+    (FlowAgeingCycleStats *stats) const {
+    for (int i = 0; i < kMaxCollectors; i++) {
+        stats->Add(collectors[i]->last_cycle_stats());
+    }
+}
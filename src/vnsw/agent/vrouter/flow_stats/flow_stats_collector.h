@@ -6,6 +6,7 @@
 #define vnsw_agent_flow_stats_collector_h
 
 #include <boost/static_assert.hpp>
+#include <boost/unordered_map.hpp>
 #include <pkt/flow_table.h>
 #include <pkt/flow_mgmt_request.h>
 #include <cmn/agent_cmn.h>
@@ -25,6 +26,24 @@ class FlowStatsRecordsReq;
 class FetchFlowStatsRecord;
 class FlowStatsManager;
 
+// Cost of an ageing cycle
+struct FlowAgeingCycleStats {
+    FlowAgeingCycleStats() :
+        flows_visited(0), flows_aged(0), flows_evicted(0), scan_time(0) { }
+    void Add(const FlowAgeingCycleStats &rhs) {
+        flows_visited += rhs.flows_visited;
+        flows_aged += rhs.flows_aged;
+        flows_evicted += rhs.flows_evicted;
+        scan_time += rhs.scan_time;
+    }
+
+    uint32_t flows_visited;
+    uint32_t flows_aged;
+    uint32_t flows_evicted;
+    // Time spent in ageing task in usec
+    uint64_t scan_time;
+};
+
 struct KFlowData {
 public:
     uint16_t underlay_src_port;
@@ -38,26 +57,49 @@ public:
 //of kTaskFlowStatsCollector which has exclusion with "db::DBTable",
 //
 // The algorithm for ageing flows,
-// - The complete flow-table will be scanned every 25% of ageing time
-//   - An implication of this is, flow ageing will have accuracy of 25%
+// - Every flow being aged is scheduled to be visited at some time in future.
+//   The schedule is kept in a timing-wheel (ageing_wheel_) with one slot per
+//   kFlowStatsTimerInterval and kAgeingWheelSize slots
+// - On every visit of flow, stats are read from vrouter. The flow is deleted
+//   if idle for configured ageing time, else it's scheduled again
+//   - Flows whose stats changed since previous visit are visited again after
+//     the scan interval (kFlowScanTime % of ageing time). This retains the
+//     accuracy of stats exported for active flows
+//   - Flows whose stats did not change are visited after exponentially
+//     increasing intervals (upto kMaxIdleBackoff), but not later than the
+//     time at which they can be aged. Idle flows are typically visited once
+//     or twice before being aged instead of every scan interval
+//   - Flows with a delete or evict request pending are visited again after
+//     kFlowDeleteRetryTime to retry the request
+//   - New flows are visited on next timer so that short flows are deleted
+//     quickly
 // - Run timer every kFlowStatsTimerInterval msec (100 msec)
-// - Compute number of flow-entres to visit in kFlowStatsTimerInterval
-//   - This is subject to constraing that complete flow table must be scanned
-//     in 25% of ageing time
-// - On every timer expiry accumulate the number of entries to visit into
-//   entries_to_visit_ variable
-// - Start a task (Flow AgeingTask) to scan the flow-entries
+// - Start a task (Flow AgeingTask) to visit the flows in wheel slots that
+//   are due
 // - On every run of task, visit upto kFlowsPerTask entries
-//   If scan is not complete, continue the task
-//   On completion of scan, stop the task
+//   If there are more entries due, continue the task
+//   On visiting all entries due, stop the task
+//
+// Visiting all flows on every timer is cheap when the table is small. So, if
+// number of flows being aged is less than kMinFlowsPerTimer, the task
+// visits all flows in addition to the flows due in wheel. All flows are also
+// visited once when ageing time changes, to schedule them with the new time.
 //
-// On every visit of flow, check if flow is idle for configured ageing time and
-// delete the idle flows
+// Wheel entries are not removed when flow is deleted or scheduled again.
+// Instead, FlowExportInfo has a sequence number that is incremented on each
+// such change, and wheel entries with a different sequence number are
+// ignored. A wheel entry for a flow whose next visit is later than the slot
+// (because of an earlier visit or a visit more than one wheel rotation away)
+// is moved to the slot for the next visit.
 //
-// The flow_tree_ maintains flows sorted on flow pointer. This tree cannot be
-// used to scan flows for ageing since entries can be added/deleted between
-// ageing tasks. Alternatively, another list is maintained in the sequence
-// flows are added to flow ageing module.
+// FlowExportInfo entries are kept in FlowExportInfoArray and flow_index_map_
+// maps a flow to its index in the array. The wheel refers to entries by
+// index.
+//
+// Number of flows visited, aged and evicted, and the time spent in ageing
+// task is accumulated per ageing cycle (between two timer runs that start
+// the ageing task) and stats for the last cycle are available in
+// last_cycle_stats()
 class FlowStatsCollector : public StatsCollector {
 public:
     // Default ageing time
@@ -70,10 +112,14 @@ public:
     static const uint32_t kFlowScanTime = 25;
     // Flog ageing timer interval in milliseconds
     static const uint32_t kFlowStatsTimerInterval = 100;
-    // Minimum flows to visit per interval
+    // Visit all flows on every timer if flows being aged are less than this
     static const uint32_t kMinFlowsPerTimer = 3000;
     // Number of flows to visit per task
     static const uint32_t kFlowsPerTask = 256;
+    // Number of slots in ageing wheel
+    static const uint32_t kAgeingWheelSize = 1024;
+    // Maximum exponent for backoff of visits to idle flows
+    static const uint8_t kMaxIdleBackoff = 4;
 
     // Retry flow-delete after 5 second
     static const uint64_t kFlowDeleteRetryTime = (5 * 1000 * 1000);
@@ -81,7 +127,7 @@ public:
     static const uint32_t kDefaultFlowSamplingThreshold = 500;
     static const uint8_t  kMaxFlowMsgsPerSend = 16;
 
-    typedef std::map<const FlowEntry*, FlowExportInfo> FlowEntryTree;
+    typedef boost::unordered_map<const FlowEntry *, uint32_t> FlowIndexMap;
     typedef WorkQueue<boost::shared_ptr<FlowExportReq> > Queue;
 
     // Task in which the actual flow table scan happens. See description above
@@ -120,9 +166,8 @@ public:
     boost::uuids::uuid rand_gen();
     bool Run();
     bool RunAgeingTask();
-    uint32_t ProcessFlow(FlowExportInfoList::iterator &it,
-                         KSyncFlowMemory *ksync_obj,
-                         FlowExportInfo *info, uint64_t curr_time);
+    uint32_t ProcessFlow(KSyncFlowMemory *ksync_obj, FlowExportInfo *info,
+                         uint64_t curr_time);
     bool AgeFlow(KSyncFlowMemory *ksync_obj, const vr_flow_entry *k_flow,
                  const vr_flow_stats &k_stats, const KFlowData &kinfo,
                  FlowExportInfo *info, uint64_t curr_time);
@@ -146,12 +191,17 @@ public:
     void AddEvent(const FlowEntryPtr &flow);
     void DeleteEvent(const FlowEntryPtr &flow, const RevFlowDepParams &params);
 
-    bool FindFlowExportInfo(const FlowEntry *fe, FlowEntryTree::iterator &it);
+    bool FindFlowExportInfo(const FlowEntry *fe, FlowIndexMap::iterator &it);
     FlowExportInfo *FindFlowExportInfo(const FlowEntry *fe);
     const FlowExportInfo *FindFlowExportInfo(const FlowEntry *fe) const;
     static uint64_t GetFlowStats(const uint16_t &oflow_data, const uint32_t &data);
-    size_t Size() const { return flow_tree_.size(); }
-    size_t AgeTreeSize() const { return flow_export_info_list_.size(); }
+    size_t Size() const { return flow_index_map_.size(); }
+    size_t AgeTreeSize() const { return ageing_count_; }
+    const FlowAgeingCycleStats &last_cycle_stats() const {
+        return last_cycle_stats_;
+    }
+    // Tables with fewer flows than this are swept on every timer
+    void set_sweep_threshold(uint32_t count) { sweep_threshold_ = count; }
     void NewFlow(FlowEntry *flow);
     void set_deleted(bool val) {
         deleted_ = val;
@@ -173,9 +223,26 @@ public:
     friend class FlowStatsCollectorObject;
 
 private:
+    struct AgeingWheelEntry {
+        AgeingWheelEntry(uint32_t i, uint32_t s) : index(i), seq(s) { }
+        uint32_t index;
+        uint32_t seq;
+    };
+    typedef std::vector<AgeingWheelEntry> AgeingWheelSlot;
+
     static uint64_t GetCurrentTime();
-    uint32_t TimersPerScan();
-    void UpdateEntriesToVisit();
+    static uint64_t GetWheelTick(uint64_t time);
+    uint64_t ScanInterval() const;
+    void StartAgeing(FlowExportInfo *info, uint64_t time);
+    void StopAgeing(FlowExportInfo *info);
+    void ScheduleAgeing(FlowExportInfo *info, uint64_t time);
+    uint64_t NextVisitTime(FlowExportInfo *info, uint64_t curr_time,
+                           uint64_t mono_time, bool active);
+    uint32_t VisitFlow(KSyncFlowMemory *ksync_obj, FlowExportInfo *info,
+                       uint64_t curr_time, uint64_t mono_time,
+                       bool from_wheel);
+    uint32_t RunSweep(KSyncFlowMemory *ksync_obj, uint32_t max_count,
+                      uint64_t curr_time, uint64_t mono_time);
     void EvictedFlowStatsUpdate(const FlowEntryPtr &flow, uint32_t bytes,
                                 uint32_t packets, uint32_t oflow_bytes,
                                 const boost::uuids::uuid &u);
@@ -217,23 +284,33 @@ private:
     bool RequestHandlerEntry();
     void RequestHandlerExit(bool done);
     void AddFlow(FlowExportInfo info);
-    void DeleteFlow(FlowEntryTree::iterator &it);
-    void UpdateFlowIterationKey(const FlowEntry *del_flow,
-                                FlowEntryTree::iterator &tree_it);
+    void DeleteFlow(FlowIndexMap::iterator &it);
     void HandleFlowStatsUpdate(const FlowKey &key, uint32_t bytes,
                                uint32_t packets, uint32_t oflow_bytes);
 
     AgentUveBase *agent_uve_;
     int task_id_;
     boost::uuids::random_generator rand_gen_;
-    const FlowEntry* flow_iteration_key_;
     uint64_t flow_age_time_intvl_;
-    // Number of entries pending to be visited
-    uint32_t entries_to_visit_;
     uint64_t flow_tcp_syn_age_time_;
 
-    FlowEntryTree flow_tree_;
-    FlowExportInfoList flow_export_info_list_;
+    FlowExportInfoArray flow_export_info_array_;
+    FlowIndexMap flow_index_map_;
+    // Number of flows scheduled in ageing wheel
+    uint32_t ageing_count_;
+    std::vector<AgeingWheelSlot> ageing_wheel_;
+    // Next wheel tick to be processed
+    uint64_t wheel_tick_;
+    // Entries of the wheel slot being processed and position in them
+    AgeingWheelSlot wheel_pending_;
+    uint32_t wheel_pending_pos_;
+    // Set when all flows must be visited in current ageing cycle
+    bool sweep_pending_;
+    // Index in flow_export_info_array_ of next flow to visit in sweep
+    uint32_t sweep_index_;
+    uint32_t sweep_threshold_;
+    // Ageing time with which the flows in wheel were scheduled
+    uint64_t wheel_age_time_;
     // Flag to specify if flow-delete request event must be retried
     // If enabled
     //    Dont remove FlowExportInfo from list after generating delete event
@@ -251,19 +328,15 @@ private:
     FlowStatsManager *flow_stats_manager_;
     FlowStatsCollectorObject *parent_;
     AgeingTask *ageing_task_;
-    // Number of timer fires needed to scan the flow-table once
-    // This is based on ageing timer
-    uint32_t timers_per_scan_;
     // Cached UTC Time stamp
     // The timestamp is taken once on FlowStatsCollector::RequestHandlerEntry()
     // and used for all requests in current run
     uint64_t current_time_;
     uint64_t ageing_task_starts_;
 
-    // Per ageing-timer stats for debugging
-    uint32_t flows_visited_;
-    uint32_t flows_aged_;
-    uint32_t flows_evicted_;
+    // Per ageing-cycle stats
+    FlowAgeingCycleStats cycle_stats_;
+    FlowAgeingCycleStats last_cycle_stats_;
     DISALLOW_COPY_AND_ASSIGN(FlowStatsCollector);
 };
 
@@ -287,6 +360,7 @@ public:
     void UpdateAgeTimeInSeconds(uint32_t age_time);
     uint32_t GetAgeTimeInSeconds() const;
     size_t Size() const;
+    void GetAgeingCycleStats(FlowAgeingCycleStats *stats) const;
 private:
     FlowStatsCollectorPtr collectors[kMaxCollectors];
     DISALLOW_COPY_AND_ASSIGN(FlowStatsCollectorObject);
@@ -427,6 +427,12 @@ void ShowAgingConfig::HandleRequest() const {
         cfg.set_port(it->first.port);
         cfg.set_cache_timeout(it->second->GetAgeTimeInSeconds());
         cfg.set_stats_interval(0);
+        FlowAgeingCycleStats stats;
+        it->second->GetAgeingCycleStats(&stats);
+        cfg.set_flows_visited(stats.flows_visited);
+        cfg.set_flows_aged(stats.flows_aged);
+        cfg.set_flows_evicted(stats.flows_evicted);
+        cfg.set_scan_time(stats.scan_time);
         std::vector<AgingConfig> &list =
             const_cast<std::vector<AgingConfig>&>(
                     ((AgingConfigResponse *)resp)->get_aging_config_list());
@@ -274,26 +274,26 @@ bool SessionStatsCollector::RequestHandler(boost::shared_ptr<SessionStatsReq> re
 }
 
 bool SessionEndpointKey::IsLess(const SessionEndpointKey &rhs) const {
-    if (vmi_cfg_name != rhs.vmi_cfg_name) {
-        return vmi_cfg_name < rhs.vmi_cfg_name;
+    if (vmi_cfg_name_id != rhs.vmi_cfg_name_id) {
+        return vmi_cfg_name_id < rhs.vmi_cfg_name_id;
     }
-    if (local_vn != rhs.local_vn) {
-        return local_vn < rhs.local_vn;
+    if (local_vn_id != rhs.local_vn_id) {
+        return local_vn_id < rhs.local_vn_id;
     }
-    if (remote_vn != rhs.remote_vn) {
-        return remote_vn < rhs.remote_vn;
+    if (remote_vn_id != rhs.remote_vn_id) {
+        return remote_vn_id < rhs.remote_vn_id;
     }
-    if (local_tagset != rhs.local_tagset) {
-        return local_tagset < rhs.local_tagset;
+    if (local_tagset_id != rhs.local_tagset_id) {
+        return local_tagset_id < rhs.local_tagset_id;
     }
-    if (remote_tagset != rhs.remote_tagset) {
-        return remote_tagset < rhs.remote_tagset;
+    if (remote_tagset_id != rhs.remote_tagset_id) {
+        return remote_tagset_id < rhs.remote_tagset_id;
     }
-    if (remote_prefix != rhs.remote_prefix) {
-        return remote_prefix < rhs.remote_prefix;
+    if (remote_prefix_id != rhs.remote_prefix_id) {
+        return remote_prefix_id < rhs.remote_prefix_id;
     }
-    if (match_policy != rhs.match_policy) {
-        return match_policy < rhs.match_policy;
+    if (match_policy_id != rhs.match_policy_id) {
+        return match_policy_id < rhs.match_policy_id;
     }
     if (is_client_session != rhs.is_client_session) {
         return is_client_session < rhs.is_client_session;
@@ -302,25 +302,25 @@ bool SessionEndpointKey::IsLess(const SessionEndpointKey &rhs) const {
 }
 
 bool SessionEndpointKey::IsEqual(const SessionEndpointKey &rhs) const {
-    if (vmi_cfg_name != rhs.vmi_cfg_name) {
+    if (vmi_cfg_name_id != rhs.vmi_cfg_name_id) {
         return false;
     }
-    if (local_vn != rhs.local_vn) {
+    if (local_vn_id != rhs.local_vn_id) {
         return false;
     }
-    if (remote_vn != rhs.remote_vn) {
+    if (remote_vn_id != rhs.remote_vn_id) {
         return false;
     }
-    if (local_tagset != rhs.local_tagset) {
+    if (local_tagset_id != rhs.local_tagset_id) {
         return false;
     }
-    if (remote_tagset != rhs.remote_tagset) {
+    if (remote_tagset_id != rhs.remote_tagset_id) {
         return false;
     }
-    if (remote_prefix != rhs.remote_prefix) {
+    if (remote_prefix_id != rhs.remote_prefix_id) {
         return false;
     }
-    if (match_policy != rhs.match_policy) {
+    if (match_policy_id != rhs.match_policy_id) {
         return false;
     }
     if (is_client_session != rhs.is_client_session) {
@@ -333,13 +333,13 @@ bool SessionEndpointKey::IsEqual(const SessionEndpointKey &rhs) const {
 }
 
 void SessionEndpointKey::Reset() {
-    vmi_cfg_name = "";
-    local_vn = "";
-    remote_vn = "";
-    local_tagset.clear();
-    remote_tagset.clear();
-    remote_prefix = "";
-    match_policy = "";
+    vmi_cfg_name_id = 0;
+    local_vn_id = 0;
+    remote_vn_id = 0;
+    local_tagset_id = 0;
+    remote_tagset_id = 0;
+    remote_prefix_id = 0;
+    match_policy_id = 0;
     is_client_session = false;
     is_si = false;
 }
@@ -443,25 +443,16 @@ bool SessionStatsCollector::GetSessionKey(FlowEntry* fe,
     }
     const string &src_vn = fe->data().source_vn_match;
     const string &dst_vn = fe->data().dest_vn_match;
-
-    session_endpoint_key.vmi_cfg_name = vmi->cfg_name();
-    session_endpoint_key.local_tagset = fe->local_tagset();
-    session_endpoint_key.remote_tagset = fe->remote_tagset();
-    session_endpoint_key.remote_prefix = fe->RemotePrefix();
-    session_endpoint_key.match_policy = fe->fw_policy_name_uuid();
-    if (vmi->service_intf_type().empty()) {
-        session_endpoint_key.is_si = false;
-    } else {
-        session_endpoint_key.is_si= true;
-    }
+    const string *local_vn;
+    const string *remote_vn;
 
     if (fe->IsClientFlow()) {
         session_agg_key.local_ip = fe->key().src_addr;
         session_agg_key.server_port = fe->key().dst_port;
         session_key.remote_ip = fe->key().dst_addr;
         session_key.client_port = fe->key().src_port;
-        session_endpoint_key.local_vn = src_vn;
-        session_endpoint_key.remote_vn = dst_vn;
+        local_vn = &src_vn;
+        remote_vn = &dst_vn;
         session_endpoint_key.is_client_session = true;
     } else if (fe->IsServerFlow()) {
         /*
@@ -474,15 +465,15 @@ bool SessionStatsCollector::GetSessionKey(FlowEntry* fe,
             session_agg_key.server_port = fe->key().src_port;
             session_key.remote_ip = fe->key().dst_addr;
             session_key.client_port = fe->key().dst_port;
-            session_endpoint_key.local_vn = src_vn;
-            session_endpoint_key.remote_vn = dst_vn;
+            local_vn = &src_vn;
+            remote_vn = &dst_vn;
         } else {
             session_agg_key.local_ip = fe->key().dst_addr;
             session_agg_key.server_port = fe->key().dst_port;
             session_key.remote_ip = fe->key().src_addr;
             session_key.client_port = fe->key().src_port;
-            session_endpoint_key.local_vn = dst_vn;
-            session_endpoint_key.remote_vn = src_vn;
+            local_vn = &dst_vn;
+            remote_vn = &src_vn;
         }
         session_endpoint_key.is_client_session = false;
     } else {
@@ -490,9 +481,51 @@ bool SessionStatsCollector::GetSessionKey(FlowEntry* fe,
     }
     session_agg_key.proto = fe->key().protocol;
     session_key.uuid = fe->uuid();
+
+    /*
+     * Values are added to the dictionaries without a reference. The caller
+     * adds the references when the key is inserted in session_endpoint_map_
+     */
+    session_endpoint_key.vmi_cfg_name_id =
+        string_dictionary_.Locate(vmi->cfg_name());
+    session_endpoint_key.local_vn_id = string_dictionary_.Locate(*local_vn);
+    session_endpoint_key.remote_vn_id = string_dictionary_.Locate(*remote_vn);
+    session_endpoint_key.local_tagset_id =
+        tagset_dictionary_.Locate(fe->local_tagset());
+    session_endpoint_key.remote_tagset_id =
+        tagset_dictionary_.Locate(fe->remote_tagset());
+    session_endpoint_key.remote_prefix_id =
+        string_dictionary_.Locate(fe->RemotePrefix());
+    session_endpoint_key.match_policy_id =
+        string_dictionary_.Locate(fe->fw_policy_name_uuid());
+    if (vmi->service_intf_type().empty()) {
+        session_endpoint_key.is_si = false;
+    } else {
+        session_endpoint_key.is_si= true;
+    }
     return true;
 }
 
+void SessionStatsCollector::EndpointKeyAddRef(const SessionEndpointKey &key) {
+    string_dictionary_.AddRef(key.vmi_cfg_name_id);
+    string_dictionary_.AddRef(key.local_vn_id);
+    string_dictionary_.AddRef(key.remote_vn_id);
+    tagset_dictionary_.AddRef(key.local_tagset_id);
+    tagset_dictionary_.AddRef(key.remote_tagset_id);
+    string_dictionary_.AddRef(key.remote_prefix_id);
+    string_dictionary_.AddRef(key.match_policy_id);
+}
+
+void SessionStatsCollector::EndpointKeyRelease(const SessionEndpointKey &key) {
+    string_dictionary_.Release(key.vmi_cfg_name_id);
+    string_dictionary_.Release(key.local_vn_id);
+    string_dictionary_.Release(key.remote_vn_id);
+    tagset_dictionary_.Release(key.local_tagset_id);
+    tagset_dictionary_.Release(key.remote_tagset_id);
+    string_dictionary_.Release(key.remote_prefix_id);
+    string_dictionary_.Release(key.match_policy_id);
+}
+
 void SessionStatsCollector::UpdateSessionFlowStatsInfo(FlowEntry *fe,
     SessionFlowStatsInfo *session_flow) const {
     session_flow->flow = fe;
@@ -522,17 +555,21 @@ static void BuildTraceTagList(const TagList &slist, vector<string> *dlist) {
     }
 }
 
-static void TraceSession(const string &op, const SessionEndpointKey &ep,
-                         const SessionAggKey &agg, const SessionKey &session,
-                         bool rev_flow_params) {
+void SessionStatsCollector::TraceSession(const string &op,
+                                         const SessionEndpointKey &ep,
+                                         const SessionAggKey &agg,
+                                         const SessionKey &session,
+                                         bool rev_flow_params) const {
     SessionTraceInfo info;
-    info.vmi = ep.vmi_cfg_name;
-    info.local_vn = ep.local_vn;
-    info.remote_vn = ep.remote_vn;
-    BuildTraceTagList(ep.local_tagset, &info.local_tagset);
-    BuildTraceTagList(ep.remote_tagset, &info.remote_tagset);
-    info.remote_prefix = ep.remote_prefix;
-    info.match_policy = ep.match_policy;
+    info.vmi = string_dictionary_.Get(ep.vmi_cfg_name_id);
+    info.local_vn = string_dictionary_.Get(ep.local_vn_id);
+    info.remote_vn = string_dictionary_.Get(ep.remote_vn_id);
+    BuildTraceTagList(tagset_dictionary_.Get(ep.local_tagset_id),
+                      &info.local_tagset);
+    BuildTraceTagList(tagset_dictionary_.Get(ep.remote_tagset_id),
+                      &info.remote_tagset);
+    info.remote_prefix = string_dictionary_.Get(ep.remote_prefix_id);
+    info.match_policy = string_dictionary_.Get(ep.match_policy_id);
     info.is_si = ep.is_si;
     info.is_client = ep.is_client_session;
     info.local_ip = agg.local_ip.to_string();
@@ -547,11 +584,9 @@ static void TraceSession(const string &op, const SessionEndpointKey &ep,
 void SessionStatsCollector::AddSession(FlowEntry* fe, uint64_t setup_time) {
     SessionAggKey session_agg_key;
     SessionEndpointInfo::SessionAggMap::iterator session_agg_map_iter;
-    SessionPreAggInfo session_agg_info;
     SessionStatsInfo session;
     SessionKey session_key;
     SessionPreAggInfo::SessionMap::iterator session_map_iter;
-    SessionEndpointInfo  session_endpoint_info = {};
     SessionEndpointKey session_endpoint_key;
     SessionEndpointMap::iterator session_endpoint_map_iter;
     FlowEntry *fe_fwd = fe;
@@ -585,10 +620,8 @@ void SessionStatsCollector::AddSession(FlowEntry* fe, uint64_t setup_time) {
     if (flow_session_map_iter != flow_session_map_.end()) {
 
         FlowToSessionMap &flow_to_session_map = flow_session_map_iter->second;
-        FlowToSessionMap rhs_flow_to_session_map(session_key,
-                                                 session_agg_key,
-                                                 session_endpoint_key);
-        if (!(flow_to_session_map.IsEqual(rhs_flow_to_session_map))) {
+        if (!(flow_to_session_map.IsEqual(session_key, session_agg_key,
+                                          session_endpoint_key))) {
             DeleteSession(fe_fwd, flow_to_session_map.session_key().uuid,
                           GetCurrentTime(), NULL);
         }
@@ -601,40 +634,32 @@ void SessionStatsCollector::AddSession(FlowEntry* fe, uint64_t setup_time) {
     session_endpoint_map_iter = session_endpoint_map_.find(
                                             session_endpoint_key);
     if (session_endpoint_map_iter == session_endpoint_map_.end()) {
-        session_agg_info.session_map_.insert(make_pair(session_key, session));
-        session_endpoint_info.session_agg_map_.insert(
-                                make_pair(session_agg_key, session_agg_info));
-        session_endpoint_map_.insert(make_pair(session_endpoint_key,
-                                                session_endpoint_info));
-        AddFlowToSessionMap(fe_fwd, session_key, session_agg_key,
-                            session_endpoint_key);
+        session_endpoint_map_iter = session_endpoint_map_.insert(
+            make_pair(session_endpoint_key, SessionEndpointInfo())).first;
+        EndpointKeyAddRef(session_endpoint_key);
+    }
+
+    SessionEndpointInfo::SessionAggMap &session_agg_map =
+        session_endpoint_map_iter->second.session_agg_map_;
+    session_agg_map_iter = session_agg_map.find(session_agg_key);
+    if (session_agg_map_iter == session_agg_map.end()) {
+        session_agg_map_iter = session_agg_map.insert(
+            make_pair(session_agg_key, SessionPreAggInfo())).first;
+    }
+
+    SessionPreAggInfo::SessionMap &session_map =
+        session_agg_map_iter->second.session_map_;
+    session_map_iter = session_map.find(session_key);
+    if (session_map_iter == session_map.end()) {
+        session_map_iter = session_map.insert(
+            make_pair(session_key, session)).first;
+        AddFlowToSessionMap(fe_fwd, session_endpoint_map_iter,
+                            session_agg_map_iter, session_map_iter);
     } else {
-        session_agg_map_iter = session_endpoint_map_iter->
-                                        second.session_agg_map_.find(
-                                                        session_agg_key);
-        if (session_agg_map_iter ==
-                session_endpoint_map_iter->second.session_agg_map_.end()) {
-            session_agg_info.session_map_.insert(make_pair(session_key, session));
-            session_endpoint_map_iter->second.session_agg_map_.insert(
-                                make_pair(session_agg_key, session_agg_info));
-            AddFlowToSessionMap(fe_fwd, session_key, session_agg_key,
-                                session_endpoint_key);
-        } else {
-            session_map_iter =
-                session_agg_map_iter->second.session_map_.find(session_key);
-            if (session_map_iter ==
-                    session_agg_map_iter->second.session_map_.end()) {
-                session_agg_map_iter->second.session_map_.insert(
-                                        make_pair(session_key, session));
-                AddFlowToSessionMap(fe_fwd, session_key, session_agg_key,
-                                    session_endpoint_key);
-            } else {
-                /*
-                 * existing flow should match with the incoming add flow
-                 */
+        /*
+         * existing flow should match with the incoming add flow
+         */
         assert(session.fwd_flow.uuid == fe_fwd->uuid());
-            }
-        }
     }
 }
 
@@ -642,14 +667,7 @@ void SessionStatsCollector::DeleteSession(FlowEntry* fe,
                                           const boost::uuids::uuid &del_uuid,
                                           uint64_t teardown_time,
                                           const RevFlowDepParams *params) {
-    SessionAggKey session_agg_key;
-    SessionEndpointInfo::SessionAggMap::iterator session_agg_map_iter;
-    SessionPreAggInfo  session_agg_info;
-    SessionKey session_key;
     SessionPreAggInfo::SessionMap::iterator session_map_iter;
-    SessionEndpointInfo  session_endpoint_info;
-    SessionEndpointKey session_endpoint_key;
-    SessionEndpointMap::iterator session_endpoint_map_iter;
     bool read_flow = true;
 
     if (del_uuid != fe->uuid()) {
@@ -677,9 +695,7 @@ void SessionStatsCollector::DeleteSession(FlowEntry* fe,
             /* Reset params because they correspond to entry with UUID y */
             params = NULL;
         }
-        session_endpoint_key = flow_session_map_iter->second.session_endpoint_key();
-        session_agg_key = flow_session_map_iter->second.session_agg_key();
-        session_key = flow_session_map_iter->second.session_key();
+        session_map_iter = flow_session_map_iter->second.session_it();
     } else {
         return;
     }
@@ -692,41 +708,29 @@ void SessionStatsCollector::DeleteSession(FlowEntry* fe,
         params_valid = false;
     }
 
-    TraceSession("Del", session_endpoint_key, session_agg_key, session_key,
-                 params_valid);
-    session_endpoint_map_iter = session_endpoint_map_.find(
-                                            session_endpoint_key);
-    if (session_endpoint_map_iter != session_endpoint_map_.end()) {
-        session_agg_map_iter = session_endpoint_map_iter->
-                                        second.session_agg_map_.find(
-                                                        session_agg_key);
-        if (session_agg_map_iter !=
-                session_endpoint_map_iter->second.session_agg_map_.end()) {
-            session_map_iter =
-                session_agg_map_iter->second.session_map_.find(session_key);
-            if (session_map_iter !=
-                    session_agg_map_iter->second.session_map_.end()) {
-                /*
-                 * Process the stats collector
-                 */
-                session_map_iter->second.teardown_time = teardown_time;
-                session_map_iter->second.deleted = true;
-                /* Don't read stats for evicted flow, during delete */
-                if (!session_map_iter->second.evicted) {
-                    SessionStatsChangedUnlocked(session_map_iter,
-                        &session_map_iter->second.del_stats);
-                }
-                if (read_flow) {
-                    CopyFlowInfo(session_map_iter->second, params);
-                }
+    const FlowToSessionMap &flow_to_session_map = flow_session_map_iter->second;
+    TraceSession("Del", flow_to_session_map.session_endpoint_key(),
+                 flow_to_session_map.session_agg_key(),
+                 flow_to_session_map.session_key(), params_valid);
 
-                assert(session_map_iter->second.fwd_flow.flow.get() == fe);
-                DeleteFlowToSessionMap(fe);
-                session_map_iter->second.fwd_flow.flow = NULL;
-                session_map_iter->second.rev_flow.flow = NULL;
-            }
-        }
+    /*
+     * Process the stats collector
+     */
+    session_map_iter->second.teardown_time = teardown_time;
+    session_map_iter->second.deleted = true;
+    /* Don't read stats for evicted flow, during delete */
+    if (!session_map_iter->second.evicted) {
+        SessionStatsChangedUnlocked(session_map_iter,
+            &session_map_iter->second.del_stats);
+    }
+    if (read_flow) {
+        CopyFlowInfo(session_map_iter->second, params);
     }
+
+    assert(session_map_iter->second.fwd_flow.flow.get() == fe);
+    DeleteFlowToSessionMap(fe);
+    session_map_iter->second.fwd_flow.flow = NULL;
+    session_map_iter->second.rev_flow.flow = NULL;
 }
 
 void SessionStatsCollector::EvictedSessionStatsUpdate(const FlowEntryPtr &flow,
@@ -735,12 +739,6 @@ void SessionStatsCollector::EvictedSessionStatsUpdate(const FlowEntryPtr &flow,
                                                 uint32_t oflow_bytes,
                                                 const boost::uuids::uuid &u) {
     FlowSessionMap::iterator flow_session_map_iter;
-    SessionInfo session_info;
-    SessionIpPort session_key;
-    SessionAggInfo session_agg_info;
-    SessionIpPortProtocol session_agg_key;
-    SessionEndpointMap::iterator session_ep_map_iter;
-    SessionEndpointInfo::SessionAggMap::iterator session_agg_map_iter;
     SessionPreAggInfo::SessionMap::iterator session_map_iter;
 
     /* TODO: Evicted msg coming for reverse flow. We currently don't have
@@ -754,57 +752,39 @@ void SessionStatsCollector::EvictedSessionStatsUpdate(const FlowEntryPtr &flow,
         return;
     }
 
-    SessionEndpointKey session_db_ep_key = flow_session_map_iter->second.session_endpoint_key();
-    SessionAggKey session_db_agg_key = flow_session_map_iter->second.session_agg_key();
-    SessionKey session_db_key = flow_session_map_iter->second.session_key();
-
-    session_ep_map_iter = session_endpoint_map_.find(session_db_ep_key);
-    if (session_ep_map_iter != session_endpoint_map_.end()) {
-        session_agg_map_iter = session_ep_map_iter->
-                                        second.session_agg_map_.find(
-                                                        session_db_agg_key);
-        if (session_agg_map_iter !=
-                session_ep_map_iter->second.session_agg_map_.end()) {
-            session_map_iter =
-                session_agg_map_iter->second.session_map_.find(session_db_key);
-            if (session_map_iter !=
-                    session_agg_map_iter->second.session_map_.end()) {
-                /*
-                 * update the latest statistics
-                 */
-                SessionFlowStatsInfo &session_flow = session_map_iter->second.fwd_flow;
-                uint64_t k_bytes, total_bytes, diff_bytes = 0;
-                uint64_t k_packets, total_packets, diff_packets = 0;
-                k_bytes = FlowStatsCollector::GetFlowStats((oflow_bytes & 0xFFFF),
-                                                           bytes);
-                k_packets = FlowStatsCollector::GetFlowStats((oflow_bytes & 0xFFFF0000),
-                                                             packets);
-                total_bytes = GetUpdatedSessionFlowBytes(session_flow.total_bytes,
-                                                         k_bytes);
-                total_packets = GetUpdatedSessionFlowPackets(session_flow.total_packets,
-                                                             k_packets);
-                diff_bytes = total_bytes - session_flow.total_bytes;
-                diff_packets = total_packets - session_flow.total_packets;
-                session_flow.total_bytes = total_bytes;
-                session_flow.total_packets = total_packets;
-
-                SessionStatsParams &estats = session_map_iter->second.
-                    evict_stats;
-                session_map_iter->second.evicted = true;
-                estats.fwd_flow.valid = true;
-                estats.fwd_flow.diff_bytes = diff_bytes;
-                estats.fwd_flow.diff_packets = diff_packets;
-            }
-        }
-    }
+    session_map_iter = flow_session_map_iter->second.session_it();
+
+    /*
+     * update the latest statistics
+     */
+    SessionFlowStatsInfo &session_flow = session_map_iter->second.fwd_flow;
+    uint64_t k_bytes, total_bytes, diff_bytes = 0;
+    uint64_t k_packets, total_packets, diff_packets = 0;
+    k_bytes = FlowStatsCollector::GetFlowStats((oflow_bytes & 0xFFFF),
+                                               bytes);
+    k_packets = FlowStatsCollector::GetFlowStats((oflow_bytes & 0xFFFF0000),
+                                                 packets);
+    total_bytes = GetUpdatedSessionFlowBytes(session_flow.total_bytes,
+                                             k_bytes);
+    total_packets = GetUpdatedSessionFlowPackets(session_flow.total_packets,
+                                                 k_packets);
+    diff_bytes = total_bytes - session_flow.total_bytes;
+    diff_packets = total_packets - session_flow.total_packets;
+    session_flow.total_bytes = total_bytes;
+    session_flow.total_packets = total_packets;
+
+    SessionStatsParams &estats = session_map_iter->second.evict_stats;
+    session_map_iter->second.evicted = true;
+    estats.fwd_flow.valid = true;
+    estats.fwd_flow.diff_bytes = diff_bytes;
+    estats.fwd_flow.diff_packets = diff_packets;
 }
 
 void SessionStatsCollector::AddFlowToSessionMap(FlowEntry *fe,
-                                                SessionKey session_key,
-                                                SessionAggKey session_agg_key,
-                                                SessionEndpointKey session_endpoint_key) {
-    FlowToSessionMap flow_to_session_map(session_key, session_agg_key,
-                                         session_endpoint_key);
+        SessionEndpointMap::iterator ep_it,
+        SessionEndpointInfo::SessionAggMap::iterator agg_it,
+        SessionPreAggInfo::SessionMap::iterator session_it) {
+    FlowToSessionMap flow_to_session_map(ep_it, agg_it, session_it);
     std::pair<FlowSessionMap::iterator, bool> ret =
         flow_session_map_.insert(make_pair(fe, flow_to_session_map));
     if (ret.second == false) {
@@ -1739,20 +1719,25 @@ void SessionStatsCollector::FillSessionEndpoint(SessionEndpointMap::iterator it,
     string rid = agent_uve_->agent()->router_id().to_string();
     boost::system::error_code ec;
 
-    session_ep->set_vmi(it->first.vmi_cfg_name);
-    session_ep->set_vn(it->first.local_vn);
-    session_ep->set_remote_vn(it->first.remote_vn);
-    session_ep->set_is_client_session(it->first.is_client_session);
-    session_ep->set_is_si(it->first.is_si);
-    if (!it->first.remote_prefix.empty()) {
-        session_ep->set_remote_prefix(it->first.remote_prefix);
-    }
-    session_ep->set_security_policy_rule(it->first.match_policy);
-    if (it->first.local_tagset.size() > 0) {
-        FillSessionTags(it->first.local_tagset, session_ep);
-    }
-    if (it->first.remote_tagset.size() > 0) {
-        FillSessionRemoteTags(it->first.remote_tagset, session_ep);
+    const SessionEndpointKey &key = it->first;
+    session_ep->set_vmi(string_dictionary_.Get(key.vmi_cfg_name_id));
+    session_ep->set_vn(string_dictionary_.Get(key.local_vn_id));
+    session_ep->set_remote_vn(string_dictionary_.Get(key.remote_vn_id));
+    session_ep->set_is_client_session(key.is_client_session);
+    session_ep->set_is_si(key.is_si);
+    if (key.remote_prefix_id != 0) {
+        session_ep->set_remote_prefix(
+            string_dictionary_.Get(key.remote_prefix_id));
+    }
+    session_ep->set_security_policy_rule(
+        string_dictionary_.Get(key.match_policy_id));
+    if (key.local_tagset_id != 0) {
+        FillSessionTags(tagset_dictionary_.Get(key.local_tagset_id),
+                        session_ep);
+    }
+    if (key.remote_tagset_id != 0) {
+        FillSessionRemoteTags(tagset_dictionary_.Get(key.remote_tagset_id),
+                              session_ep);
     }
     session_ep->set_vrouter_ip(
                     boost::asio::ip::address::from_string(rid, ec));
@@ -1925,6 +1910,7 @@ uint32_t SessionStatsCollector::RunSessionEndpointStats(uint32_t max_count) {
             session_agg_iteration_key_.Reset();
             session_iteration_key_.Reset();
             if (prev->second.session_agg_map_.size() == 0) {
+                EndpointKeyRelease(prev->first);
                 session_endpoint_map_.erase(prev);
             }
         }
@@ -2137,14 +2123,17 @@ FlowEntry* SessionStatsReq::reverse_flow() const {
     return rflow;
 }
 
-bool FlowToSessionMap::IsEqual(FlowToSessionMap &rhs) {
-    if (!(session_key_.IsEqual(rhs.session_key()))) {
+bool FlowToSessionMap::IsEqual(const SessionKey &session_key,
+                               const SessionAggKey &session_agg_key,
+                               const SessionEndpointKey &session_endpoint_key)
+                               const {
+    if (!(session_it_->first.IsEqual(session_key))) {
         return false;
     }
-    if (!(session_agg_key_.IsEqual(rhs.session_agg_key()))) {
+    if (!(agg_it_->first.IsEqual(session_agg_key))) {
         return false;
     }
-    if (!(session_endpoint_key_.IsEqual(rhs.session_endpoint_key()))) {
+    if (!(ep_it_->first.IsEqual(session_endpoint_key))) {
         return false;
     }
     return true;
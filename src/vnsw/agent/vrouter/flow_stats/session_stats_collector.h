@@ -5,6 +5,7 @@
 #ifndef vnsw_agent_session_stats_collector_h
 #define vnsw_agent_session_stats_collector_h
 
+#include <boost/unordered_map.hpp>
 #include <vrouter/flow_stats/flow_stats_manager.h>
 // Forward declaration
 class FlowStatsManager;
@@ -20,15 +21,95 @@ do {\
     SessionStats##obj::TraceMsg(SessionStatsTraceBuf, __FILE__, __LINE__, __VA_ARGS__);\
 } while(0);
 
+// Dictionary of values referenced by session endpoint keys. Each distinct
+// value is stored once and keys carry its 32 bit id, so that the strings and
+// tag lists of an endpoint are not copied into every key and keys compare as
+// integers. Id 0 is reserved for the default (empty) value and is never
+// released. Other ids are reference counted by the endpoints using them and
+// reused once released.
+template <typename Value>
+class SessionDictionary {
+public:
+    SessionDictionary() : entries_(1, Entry()) {
+        entries_[0].value = &empty_;
+    }
+
+    // Return the id of value, adding it without a reference if not present
+    uint32_t Locate(const Value &value) {
+        if (value == empty_) {
+            return 0;
+        }
+        typename IdMap::iterator it = id_map_.find(value);
+        if (it != id_map_.end()) {
+            return it->second;
+        }
+        uint32_t id;
+        if (free_list_.empty()) {
+            id = entries_.size();
+            entries_.push_back(Entry());
+        } else {
+            id = free_list_.back();
+            free_list_.pop_back();
+        }
+        it = id_map_.insert(std::make_pair(value, id)).first;
+        entries_[id].value = &it->first;
+        entries_[id].refcount = 0;
+        return id;
+    }
+
+    void AddRef(uint32_t id) {
+        if (id != 0) {
+            entries_[id].refcount++;
+        }
+    }
+
+    void Release(uint32_t id) {
+        if (id == 0) {
+            return;
+        }
+        Entry &entry = entries_[id];
+        assert(entry.refcount != 0);
+        if (--entry.refcount != 0) {
+            return;
+        }
+        id_map_.erase(id_map_.find(*entry.value));
+        entry.value = NULL;
+        free_list_.push_back(id);
+    }
+
+    const Value &Get(uint32_t id) const { return *entries_[id].value; }
+    // Number of values stored, not counting the default value
+    size_t size() const { return id_map_.size(); }
+
+private:
+    struct Entry {
+        Entry() : value(NULL), refcount(0) { }
+        const Value *value;
+        uint32_t refcount;
+    };
+    typedef boost::unordered_map<Value, uint32_t> IdMap;
+
+    Value empty_;
+    IdMap id_map_;
+    std::vector<Entry> entries_;
+    std::vector<uint32_t> free_list_;
+    DISALLOW_COPY_AND_ASSIGN(SessionDictionary);
+};
+
+typedef SessionDictionary<std::string> SessionStringDictionary;
+typedef SessionDictionary<TagList> SessionTagListDictionary;
+
+// Key of a session endpoint. The strings and tag lists are ids in the
+// dictionaries of the SessionStatsCollector owning the endpoint.
 struct SessionEndpointKey {
 public:
-    std::string vmi_cfg_name;
-    std::string local_vn;
-    std::string remote_vn;
-    TagList local_tagset;
-    TagList remote_tagset;
-    std::string remote_prefix;
-    std::string match_policy;
+    uint32_t vmi_cfg_name_id;
+    uint32_t local_vn_id;
+    uint32_t remote_vn_id;
+    uint32_t local_tagset_id;
+    uint32_t remote_tagset_id;
+    uint32_t remote_prefix_id;
+    uint32_t match_policy_id;
     bool is_client_session;
     bool is_si;
     SessionEndpointKey() { Reset(); }
@@ -197,6 +278,13 @@ public:
     uint32_t instance_id() const { return instance_id_; }
     const Queue *queue() const { return &request_queue_; }
     size_t Size() const { return session_endpoint_map_.size(); }
+    size_t FlowSessionMapSize() const { return flow_session_map_.size(); }
+    const SessionStringDictionary &string_dictionary() const {
+        return string_dictionary_;
+    }
+    const SessionTagListDictionary &tagset_dictionary() const {
+        return tagset_dictionary_;
+    }
     friend class FlowStatsManager;
     friend class SessionStatsCollectorObject;
 protected:
@@ -278,9 +366,14 @@ private:
                        SessionKey    &session_key,
                        SessionEndpointKey &session_endpoint_key);
     void AddFlowToSessionMap(FlowEntry *fe,
-                             SessionKey session_key,
-                             SessionAggKey session_agg_key,
-                             SessionEndpointKey session_endpoint_key);
+                             SessionEndpointMap::iterator ep_it,
+                             SessionEndpointInfo::SessionAggMap::iterator agg_it,
+                             SessionPreAggInfo::SessionMap::iterator session_it);
+    void EndpointKeyAddRef(const SessionEndpointKey &key);
+    void EndpointKeyRelease(const SessionEndpointKey &key);
+    void TraceSession(const std::string &op, const SessionEndpointKey &ep,
+                      const SessionAggKey &agg, const SessionKey &session,
+                      bool rev_flow_params) const;
     void DeleteFlowToSessionMap(FlowEntry *fe);
     void Shutdown();
     void RegisterDBClients();
@@ -380,6 +473,8 @@ private:
     SessionEndpointKey session_ep_iteration_key_;
     SessionAggKey session_agg_iteration_key_;
     SessionKey session_iteration_key_;
+    SessionStringDictionary string_dictionary_;
+    SessionTagListDictionary tagset_dictionary_;
     SessionEndpointMap session_endpoint_map_;
     FlowSessionMap flow_session_map_;
     Queue request_queue_;
@@ -463,23 +558,32 @@ private:
     DISALLOW_COPY_AND_ASSIGN(SessionStatsReq);
 };
 
+// Session of a flow, referenced by iterators into the session maps. The
+// iterators stay valid while the flow is mapped, since a session is erased
+// only after it is deleted, and aggregates and endpoints only when empty.
 class FlowToSessionMap {
 public:
-    FlowToSessionMap(SessionKey &session_key,
-                     SessionAggKey &session_agg_key,
-                     SessionEndpointKey &session_endpoint_key) :
-        session_key_(session_key),
-        session_agg_key_(session_agg_key),
-        session_endpoint_key_(session_endpoint_key) {
+    FlowToSessionMap(
+        SessionStatsCollector::SessionEndpointMap::iterator ep_it,
+        SessionEndpointInfo::SessionAggMap::iterator agg_it,
+        SessionPreAggInfo::SessionMap::iterator session_it) :
+        ep_it_(ep_it), agg_it_(agg_it), session_it_(session_it) {
+    }
+    bool IsEqual(const SessionKey &session_key,
+                 const SessionAggKey &session_agg_key,
+                 const SessionEndpointKey &session_endpoint_key) const;
+    const SessionKey &session_key() const { return session_it_->first; }
+    const SessionAggKey &session_agg_key() const { return agg_it_->first; }
+    const SessionEndpointKey &session_endpoint_key() const {
+        return ep_it_->first;
+    }
+    SessionPreAggInfo::SessionMap::iterator session_it() const {
+        return session_it_;
     }
-    bool IsEqual(FlowToSessionMap &rhs);
-    SessionKey session_key() { return session_key_; }
-    SessionAggKey session_agg_key() { return session_agg_key_; }
-    SessionEndpointKey session_endpoint_key() { return session_endpoint_key_; }
 private:
-    SessionKey session_key_;
-    SessionAggKey session_agg_key_;
-    SessionEndpointKey session_endpoint_key_;
+    SessionStatsCollector::SessionEndpointMap::iterator ep_it_;
+    SessionEndpointInfo::SessionAggMap::iterator agg_it_;
+    SessionPreAggInfo::SessionMap::iterator session_it_;
 };
 
 struct SessionSloRuleEntry {
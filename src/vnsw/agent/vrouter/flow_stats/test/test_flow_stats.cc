@@ -274,6 +274,106 @@ TEST_F(FlowStatsTest, FlowAddVerify) {
     FlowTeardown();
 }
 
+//Verify that flows in small table are visited on every ageing cycle and the
+//cost of ageing cycle is reported
+TEST_F(FlowStatsTest, AgeingCycleStats) {
+    FlowSetup();
+    TestFlow flow[] = {
+        {
+            TestFlowPkt(Address::INET, "1.1.1.1", "1.1.1.2", 1, 0, 0, "vrf5",
+                        flow0->id()),
+            {
+                new VerifyVn("vn5", "vn5"),
+            }
+        }
+    };
+
+    CreateFlow(flow, 1);
+    client->WaitForIdle();
+    EXPECT_EQ(2U, flow_proto_->FlowCount());
+
+    FlowEntry *fe = flow[0].pkt_.FlowFetch();
+    EXPECT_TRUE(fe != NULL);
+    FlowStatsCollector *col = fe->fsc();
+    EXPECT_TRUE(col != NULL);
+    WAIT_FOR(5000, 1000, (col->AgeTreeSize() == 2));
+
+    //Both flows are visited in an ageing cycle, without being aged
+    util_.EnqueueFlowStatsCollectorTask();
+    client->WaitForIdle();
+    util_.EnqueueFlowStatsCollectorTask();
+    client->WaitForIdle();
+    WAIT_FOR(5000, 1000, (col->last_cycle_stats().flows_visited >= 2));
+    EXPECT_EQ(2U, col->AgeTreeSize());
+    EXPECT_EQ(2U, flow_proto_->FlowCount());
+
+    DeleteFlow(flow, 1);
+    client->WaitForIdle();
+    EXPECT_EQ(0U, flow_proto_->FlowCount());
+    WAIT_FOR(1000, 1000, (col->Size() == 0));
+    EXPECT_EQ(0U, col->AgeTreeSize());
+    FlowTeardown();
+}
+
+//Verify that flows in a table above the sweep threshold are visited from the
+//ageing wheel, are scheduled again when ageing time changes and are aged
+TEST_F(FlowStatsTest, AgeingWheel) {
+    FlowSetup();
+    FlowStatsCollectorObject *obj =
+        agent_->flow_stats_manager()->default_flow_stats_collector_obj();
+    uint64_t bkp_age_time = obj->GetFlowAgeTime();
+    for (int i = 0; i < FlowStatsCollectorObject::kMaxCollectors; i++) {
+        obj->GetCollector(i)->set_sweep_threshold(0);
+    }
+    TestFlow flow[] = {
+        {
+            TestFlowPkt(Address::INET, "1.1.1.1", "1.1.1.2", 1, 0, 0, "vrf5",
+                        flow0->id()),
+            {
+                new VerifyVn("vn5", "vn5"),
+            }
+        }
+    };
+
+    CreateFlow(flow, 1);
+    client->WaitForIdle();
+    EXPECT_EQ(2U, flow_proto_->FlowCount());
+
+    FlowEntry *fe = flow[0].pkt_.FlowFetch();
+    EXPECT_TRUE(fe != NULL);
+    FlowStatsCollector *col = fe->fsc();
+    EXPECT_TRUE(col != NULL);
+    WAIT_FOR(5000, 1000, (col->AgeTreeSize() == 2));
+
+    //New flows are visited from the wheel on next timer, without being aged
+    util_.EnqueueFlowStatsCollectorTask();
+    client->WaitForIdle();
+    util_.EnqueueFlowStatsCollectorTask();
+    client->WaitForIdle();
+    WAIT_FOR(5000, 1000, (col->last_cycle_stats().flows_visited >= 2));
+    EXPECT_EQ(2U, col->AgeTreeSize());
+    EXPECT_EQ(2U, flow_proto_->FlowCount());
+
+    //Flows are scheduled with the default ageing time. Reduce it to 1 second
+    //and verify that flows are aged without waiting for their old schedule
+    obj->SetFlowAgeTime(1000 * 1000);
+    for (int i = 0; i < 100 && flow_proto_->FlowCount() != 0; i++) {
+        usleep(100 * 1000);
+        util_.EnqueueFlowStatsCollectorTask();
+        client->WaitForIdle();
+    }
+    EXPECT_EQ(0U, flow_proto_->FlowCount());
+    WAIT_FOR(1000, 1000, (col->Size() == 0));
+    EXPECT_EQ(0U, col->AgeTreeSize());
+
+    obj->SetFlowAgeTime(bkp_age_time);
+    for (int i = 0; i < FlowStatsCollectorObject::kMaxCollectors; i++) {
+        obj->GetCollector(i)->set_sweep_threshold
+            (FlowStatsCollector::kMinFlowsPerTimer);
+    }
+    FlowTeardown();
+}
+
 int main(int argc, char *argv[]) {
     int ret;
     GETUSERARGS();
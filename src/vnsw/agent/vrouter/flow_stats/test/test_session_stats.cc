@@ -151,14 +151,21 @@ TEST_F(SessionStatsTest, FlowAddVerify) {
     SessionStatsCollector *ssc = ssc_obj->FlowToCollector(fe);
     EXPECT_TRUE(ssc != NULL);
     EXPECT_EQ(3U, ssc->Size());
+    // vmi, local and remote vn of the endpoints are interned once
+    EXPECT_TRUE(ssc->string_dictionary().size() > 0);
+    EXPECT_TRUE(ssc->string_dictionary().size() <= 6U);
 
     DeleteFlow(flow, 2);
     client->WaitForIdle();
+    EXPECT_EQ(0U, ssc->FlowSessionMapSize());
     FlowTeardown();
     EXPECT_EQ(0U, flow_proto_->FlowCount());
     EnqueueSessionTask();
     client->WaitForIdle();
     WAIT_FOR(1000, 500, (ssc->Size() == 0));
+    // Dictionary values are released along with the endpoints
+    EXPECT_EQ(0U, ssc->string_dictionary().size());
+    EXPECT_EQ(0U, ssc->tagset_dictionary().size());
 }
 
 TEST_F(SessionStatsTest, RemoteFlowAddVerify) {
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include "base/os.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "base/time_util.h"
+#include "testing/gunit.h"
+#include "test/test_cmn_util.h"
+#include "ksync/ksync_sock.h"
+
+#define ROUTE_COUNT (4 * 1000)
+
+//
+// Measure KSync throughput for a burst of route updates with bulk batching
+// disabled and enabled. KSyncSockTypeMap stands in for the kernel, so the
+// numbers are only relative, but the message and batch counts are exact
+// and are checked against the limits.
+//
+class TestKSyncBulk : public ::testing::Test {
+public:
+    virtual void SetUp() {
+        agent_ = Agent::GetInstance();
+        sock_ = KSyncSock::Get(0);
+        AddVrf("vrf1");
+        client->WaitForIdle();
+
+        boost::system::error_code ec;
+        bgp_peer_ = CreateBgpPeer(Ip4Address::from_string("0.0.0.1", ec),
+                                  "xmpp channel");
+        client->WaitForIdle();
+    }
+
+    virtual void TearDown() {
+        sock_->SetBulkLimits(KSyncSock::kMaxBulkMsgCountLimit,
+                             KSyncSock::kMaxBulkBatchSize);
+        DelVrf("vrf1");
+        client->WaitForIdle();
+        DeleteBgpPeer(bgp_peer_);
+        client->WaitForIdle();
+    }
+
+    Ip4Address RouteAddr(uint32_t i) {
+        return Ip4Address(Ip4Address::from_string("20.0.0.0").to_ulong() + i);
+    }
+
+    // Enqueue all route updates before waiting, so that KSync sees a backlog
+    uint64_t AddRoutes(uint32_t count) {
+        uint64_t start = ClockMonotonicUsec();
+        for (uint32_t i = 0; i < count; i++) {
+            Inet4TunnelRouteAdd(bgp_peer_, "vrf1", RouteAddr(i), 32,
+                                Ip4Address::from_string("10.10.10.2"),
+                                TunnelType::GREType(), 100 + i, "vn1",
+                                SecurityGroupList(), TagList(),
+                                PathPreference());
+        }
+        client->WaitForIdle();
+        return ClockMonotonicUsec() - start;
+    }
+
+    uint64_t DelRoutes(uint32_t count) {
+        uint64_t start = ClockMonotonicUsec();
+        for (uint32_t i = 0; i < count; i++) {
+            InetUnicastAgentRouteTable::DeleteReq(bgp_peer_, "vrf1",
+                                                  RouteAddr(i), 32, NULL);
+        }
+        client->WaitForIdle();
+        return ClockMonotonicUsec() - start;
+    }
+
+    void Run(const char *desc, uint32_t msg_count_limit,
+             uint32_t batch_limit) {
+        sock_->SetBulkLimits(msg_count_limit, batch_limit);
+        int tx_count = sock_->tx_count();
+        int tx_batch_count = sock_->tx_batch_count();
+
+        uint64_t add_time = AddRoutes(ROUTE_COUNT);
+        int add_tx = sock_->tx_count() - tx_count;
+        int add_batch = sock_->tx_batch_count() - tx_batch_count;
+        EXPECT_TRUE(RouteFind("vrf1", RouteAddr(ROUTE_COUNT - 1), 32));
+
+        tx_count = sock_->tx_count();
+        tx_batch_count = sock_->tx_batch_count();
+        uint64_t del_time = DelRoutes(ROUTE_COUNT);
+        int del_tx = sock_->tx_count() - tx_count;
+        int del_batch = sock_->tx_batch_count() - tx_batch_count;
+        EXPECT_FALSE(RouteFind("vrf1", RouteAddr(ROUTE_COUNT - 1), 32));
+
+        // A bulk message carries at most msg_count_limit routes
+        EXPECT_LE(ROUTE_COUNT / msg_count_limit, (uint32_t)add_tx);
+        EXPECT_LE(ROUTE_COUNT / msg_count_limit, (uint32_t)del_tx);
+        if (batch_limit == 1) {
+            // Every bulk message is sent on its own
+            EXPECT_EQ(add_tx, add_batch);
+            EXPECT_EQ(del_tx, del_batch);
+        } else {
+            // The backlog makes bulk messages go out together
+            EXPECT_LT(add_batch, add_tx);
+            EXPECT_LT(del_batch, del_tx);
+        }
+
+        std::cout << desc << ": " << ROUTE_COUNT << " routes" << std::endl
+            << "    Add    : " << add_time << " usec, " << add_tx
+            << " bulk messages in " << add_batch << " batches" << std::endl
+            << "    Delete : " << del_time << " usec, " << del_tx
+            << " bulk messages in " << del_batch << " batches" << std::endl;
+    }
+
+    Agent *agent_;
+    KSyncSock *sock_;
+    BgpPeer *bgp_peer_;
+};
+
+TEST_F(TestKSyncBulk, NoBatching) {
+    Run("Fixed bulk size, no batching", KSyncSock::kMaxBulkMsgCount, 1);
+}
+
+TEST_F(TestKSyncBulk, Batching) {
+    Run("Adaptive bulk size with batching", KSyncSock::kMaxBulkMsgCountLimit,
+        KSyncSock::kMaxBulkBatchSize);
+}
+
+int main(int argc, char **argv) {
+    GETUSERARGS();
+
+    client = TestInit(init_file, ksync_init);
+    int ret = RUN_ALL_TESTS();
+    TestShutdown();
+    delete client;
+    return ret;
+}
@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include "xml/xml_pull_parser.h"
+
+#include <string.h>
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/logging.h"
+#include "testing/gunit.h"
+
+using std::string;
+using std::vector;
+
+class XmlPullParserTest : public ::testing::Test {
+protected:
+    string FileRead(const string &filename) {
+        string content;
+        std::fstream file(filename.c_str(), std::fstream::in);
+        while (!file.eof()) {
+            char piece[256];
+            file.read(piece, sizeof(piece));
+            content.append(piece, file.gcount());
+        }
+        file.close();
+        return content;
+    }
+
+    // Parse str into a buffer owned by the fixture, which has to outlive
+    // the pointers returned by the parser.
+    XmlPullParser *Parse(const string &str) {
+        buf_.assign(str.begin(), str.end());
+        parser_.reset(new XmlPullParser(&buf_[0], buf_.size()));
+        return parser_.get();
+    }
+
+    vector<char> buf_;
+    std::auto_ptr<XmlPullParser> parser_;
+};
+
+TEST_F(XmlPullParserTest, Events) {
+    XmlPullParser *parser = Parse(
+        "<?xml version='1.0'?>\n"
+        "<a x='1' y=\"two\">\n"
+        "  <!-- comment -->\n"
+        "  <b>text</b>\n"
+        "  <c/>\n"
+        "</a>\n");
+
+    EXPECT_EQ(XmlPullParser::START_ELEMENT, parser->Next());
+    EXPECT_STREQ("a", parser->name());
+    EXPECT_EQ(1U, parser->depth());
+    EXPECT_EQ(2U, parser->attribute_count());
+    EXPECT_STREQ("x", parser->attribute_name(0));
+    EXPECT_STREQ("1", parser->attribute_value(0));
+    EXPECT_STREQ("two", parser->Attribute("y"));
+    EXPECT_TRUE(parser->Attribute("z") == NULL);
+
+    EXPECT_EQ(XmlPullParser::START_ELEMENT, parser->Next());
+    EXPECT_STREQ("b", parser->name());
+    EXPECT_EQ(2U, parser->depth());
+    EXPECT_EQ(0U, parser->attribute_count());
+    EXPECT_EQ(XmlPullParser::TEXT, parser->Next());
+    EXPECT_STREQ("text", parser->text());
+    EXPECT_EQ(XmlPullParser::END_ELEMENT, parser->Next());
+    EXPECT_STREQ("b", parser->name());
+    EXPECT_EQ(1U, parser->depth());
+
+    EXPECT_EQ(XmlPullParser::START_ELEMENT, parser->Next());
+    EXPECT_STREQ("c", parser->name());
+    EXPECT_EQ(XmlPullParser::END_ELEMENT, parser->Next());
+    EXPECT_STREQ("c", parser->name());
+
+    EXPECT_EQ(XmlPullParser::END_ELEMENT, parser->Next());
+    EXPECT_STREQ("a", parser->name());
+    EXPECT_EQ(0U, parser->depth());
+    EXPECT_EQ(XmlPullParser::END_DOCUMENT, parser->Next());
+    EXPECT_TRUE(parser->error() == NULL);
+}
+
+TEST_F(XmlPullParserTest, Entities) {
+    XmlPullParser *parser = Parse(
+        "<a v='&lt;&amp;&gt;'>x &quot;&apos; &#65;&#x42;&#xe9;"
+        "<![CDATA[<raw&>]]></a>");
+
+    EXPECT_EQ(XmlPullParser::START_ELEMENT, parser->Next());
+    EXPECT_STREQ("<&>", parser->Attribute("v"));
+    EXPECT_EQ(XmlPullParser::TEXT, parser->Next());
+    EXPECT_STREQ("x \"' AB\xC3\xA9", parser->text());
+    EXPECT_EQ(XmlPullParser::TEXT, parser->Next());
+    EXPECT_STREQ("<raw&>", parser->text());
+    EXPECT_EQ(XmlPullParser::END_ELEMENT, parser->Next());
+    EXPECT_EQ(XmlPullParser::END_DOCUMENT, parser->Next());
+}
+
+TEST_F(XmlPullParserTest, NextChild) {
+    XmlPullParser *parser = Parse(
+        "<items>"
+        "<item id='1'><value>one</value></item>"
+        "<other><item id='x'/></other>"
+        "<item id='2'><skip><value>no</value></skip><value>two</value></item>"
+        "</items>");
+
+    ASSERT_EQ(XmlPullParser::START_ELEMENT, parser->Next());
+    size_t depth = parser->depth();
+    vector<string> values;
+    while (parser->NextChild(depth)) {
+        if (strcmp(parser->name(), "item") != 0) {
+            EXPECT_TRUE(parser->SkipElement());
+            continue;
+        }
+        string id(parser->Attribute("id"));
+        size_t item_depth = parser->depth();
+        while (parser->NextChild(item_depth)) {
+            if (strcmp(parser->name(), "value") == 0) {
+                values.push_back(id + ":" + parser->ReadText());
+            } else {
+                EXPECT_TRUE(parser->SkipElement());
+            }
+        }
+    }
+    EXPECT_EQ(XmlPullParser::END_ELEMENT, parser->event());
+    EXPECT_EQ(0U, parser->depth());
+    ASSERT_EQ(2U, values.size());
+    EXPECT_EQ("1:one", values[0]);
+    EXPECT_EQ("2:two", values[1]);
+}
+
+TEST_F(XmlPullParserTest, Errors) {
+    const char *docs[] = {
+        "<a><b></a></b>",
+        "<a>",
+        "<a x=1></a>",
+        "<a x='1'y='2'></a>",
+        "<a>&bogus;</a>",
+        "<a>&#;</a>",
+        "<!DOCTYPE a><a/>",
+        "text<a/>",
+        "<a",
+    };
+    for (size_t idx = 0; idx < sizeof(docs) / sizeof(docs[0]); ++idx) {
+        XmlPullParser *parser = Parse(docs[idx]);
+        XmlPullParser::Event event;
+        do {
+            event = parser->Next();
+        } while (event != XmlPullParser::END_DOCUMENT &&
+                 event != XmlPullParser::PARSE_ERROR);
+        EXPECT_EQ(XmlPullParser::PARSE_ERROR, event) << docs[idx];
+        EXPECT_TRUE(parser->error() != NULL) << docs[idx];
+    }
+}
+
+TEST_F(XmlPullParserTest, MaxDepth) {
+    string doc;
+    for (size_t idx = 0; idx <= XmlPullParser::kMaxDepth; ++idx)
+        doc += "<a>";
+    XmlPullParser *parser = Parse(doc);
+    for (size_t idx = 0; idx < XmlPullParser::kMaxDepth; ++idx)
+        EXPECT_EQ(XmlPullParser::START_ELEMENT, parser->Next());
+    EXPECT_EQ(XmlPullParser::PARSE_ERROR, parser->Next());
+}
+
+//
+// Walk an xmpp publish stanza the way a route receive path would.
+//
+TEST_F(XmlPullParserTest, XmppPublish) {
+    XmlPullParser *parser =
+        Parse(FileRead("controller/src/xml/testdata/xmpp_l3_vpn.xml"));
+
+    ASSERT_EQ(XmlPullParser::START_ELEMENT, parser->Next());
+    EXPECT_STREQ("iq", parser->name());
+    EXPECT_STREQ("set", parser->Attribute("type"));
+    EXPECT_STREQ("01020304abcd@domain.org", parser->Attribute("from"));
+    EXPECT_STREQ("network-control.domain.org", parser->Attribute("to"));
+    EXPECT_STREQ("request1", parser->Attribute("id"));
+
+    ASSERT_TRUE(parser->NextChild(1));
+    EXPECT_STREQ("pubsub", parser->name());
+    ASSERT_TRUE(parser->NextChild(2));
+    EXPECT_STREQ("publish", parser->name());
+    EXPECT_STREQ("01020304abcd:vpn-ip-address/32", parser->Attribute("node"));
+    ASSERT_TRUE(parser->NextChild(3));
+    EXPECT_STREQ("item", parser->name());
+    ASSERT_TRUE(parser->NextChild(4));
+    EXPECT_STREQ("entry", parser->name());
+    ASSERT_TRUE(parser->NextChild(5));
+    EXPECT_STREQ("nlri", parser->name());
+    EXPECT_STREQ("1", parser->Attribute("af"));
+    EXPECT_STREQ("10.1.2.1/32", parser->ReadText());
+    ASSERT_TRUE(parser->NextChild(5));
+    EXPECT_STREQ("next-hop", parser->name());
+    EXPECT_TRUE(parser->SkipElement());
+    ASSERT_TRUE(parser->NextChild(5));
+    EXPECT_STREQ("version", parser->name());
+    EXPECT_STREQ("1", parser->Attribute("id"));
+    EXPECT_TRUE(parser->SkipElement());
+    ASSERT_TRUE(parser->NextChild(5));
+    EXPECT_STREQ("label", parser->name());
+    EXPECT_STREQ("10000", parser->ReadText());
+    EXPECT_FALSE(parser->NextChild(5));
+    EXPECT_FALSE(parser->NextChild(4));
+    EXPECT_FALSE(parser->NextChild(3));
+    EXPECT_FALSE(parser->NextChild(2));
+    EXPECT_FALSE(parser->NextChild(1));
+    EXPECT_EQ(0U, parser->depth());
+    EXPECT_EQ(XmlPullParser::END_DOCUMENT, parser->Next());
+}
+
+int main(int argc, char **argv) {
+    LoggingInit();
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
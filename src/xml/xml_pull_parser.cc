@@ -0,0 +1,427 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include "xml/xml_pull_parser.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+const size_t XmlPullParser::kMaxDepth;
+const size_t XmlPullParser::kMaxAttributes;
+
+static inline bool IsSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static inline bool IsNameChar(char c) {
+    return !IsSpace(c) && c != '>' && c != '/' && c != '=' && c != '<' &&
+        c != '"' && c != '\'' && c != '\0';
+}
+
+static bool IsBlank(const char *begin, const char *end) {
+    for (const char *p = begin; p < end; ++p) {
+        if (!IsSpace(*p))
+            return false;
+    }
+    return true;
+}
+
+static char *EncodeUtf8(unsigned long code, char *out) {
+    if (code < 0x80) {
+        *out++ = code;
+    } else if (code < 0x800) {
+        *out++ = 0xC0 | (code >> 6);
+        *out++ = 0x80 | (code & 0x3F);
+    } else if (code < 0x10000) {
+        *out++ = 0xE0 | (code >> 12);
+        *out++ = 0x80 | ((code >> 6) & 0x3F);
+        *out++ = 0x80 | (code & 0x3F);
+    } else {
+        *out++ = 0xF0 | (code >> 18);
+        *out++ = 0x80 | ((code >> 12) & 0x3F);
+        *out++ = 0x80 | ((code >> 6) & 0x3F);
+        *out++ = 0x80 | (code & 0x3F);
+    }
+    return out;
+}
+
+//
+// Decode entity references in [begin, end) in place. The decoded form of a
+// reference is never longer than the reference itself, so the output never
+// overtakes the input. Returns the end of the decoded data, or NULL if a
+// reference is malformed.
+//
+static char *DecodeEntities(char *begin, char *end) {
+    char *in = static_cast<char *>(memchr(begin, '&', end - begin));
+    if (!in)
+        return end;
+
+    char *out = in;
+    while (in < end) {
+        if (*in != '&') {
+            *out++ = *in++;
+            continue;
+        }
+        char *semi = static_cast<char *>(memchr(in, ';', end - in));
+        if (!semi)
+            return NULL;
+        const char *ref = in + 1;
+        size_t len = semi - ref;
+        if (len == 2 && strncmp(ref, "lt", 2) == 0) {
+            *out++ = '<';
+        } else if (len == 2 && strncmp(ref, "gt", 2) == 0) {
+            *out++ = '>';
+        } else if (len == 3 && strncmp(ref, "amp", 3) == 0) {
+            *out++ = '&';
+        } else if (len == 4 && strncmp(ref, "quot", 4) == 0) {
+            *out++ = '"';
+        } else if (len == 4 && strncmp(ref, "apos", 4) == 0) {
+            *out++ = '\'';
+        } else if (len >= 2 && ref[0] == '#') {
+            int base = 10;
+            const char *digits = ref + 1;
+            if (*digits == 'x') {
+                base = 16;
+                digits++;
+            }
+            if (digits == semi || !isxdigit(*digits))
+                return NULL;
+            char *endp;
+            unsigned long code = strtoul(digits, &endp, base);
+            if (endp != semi || code == 0 || code > 0x10FFFF)
+                return NULL;
+            out = EncodeUtf8(code, out);
+        } else {
+            return NULL;
+        }
+        in = semi + 1;
+    }
+    return out;
+}
+
+XmlPullParser::XmlPullParser(char *buf, size_t size)
+    : buf_(buf), cur_(buf), end_(buf + size), event_(END_DOCUMENT),
+      name_(""), text_(""), error_(NULL), at_markup_(false),
+      close_element_(false), depth_(0), attribute_count_(0) {
+    // Skip UTF-8 byte order mark.
+    if (size >= 3 && strncmp(buf, "\xEF\xBB\xBF", 3) == 0)
+        cur_ += 3;
+}
+
+XmlPullParser::Event XmlPullParser::Error(const char *error) {
+    error_ = error;
+    event_ = PARSE_ERROR;
+    return event_;
+}
+
+char *XmlPullParser::ScanName(char *p) const {
+    while (p < end_ && IsNameChar(*p))
+        ++p;
+    return p;
+}
+
+char *XmlPullParser::SkipSpace(char *p) const {
+    while (p < end_ && IsSpace(*p))
+        ++p;
+    return p;
+}
+
+bool XmlPullParser::SkipPast(const char *delimiter, size_t len) {
+    char *p = std::search(cur_, end_, delimiter, delimiter + len);
+    if (p == end_)
+        return false;
+    cur_ = p + len;
+    return true;
+}
+
+//
+// Parse a start tag with cur_ at the first character of the name. The
+// character following the name is overwritten with the terminator, so it
+// is saved in c and examined from there.
+//
+XmlPullParser::Event XmlPullParser::ParseStartElement() {
+    char *name = cur_;
+    char *p = ScanName(name);
+    if (p == name)
+        return Error("invalid element name");
+    if (p >= end_)
+        return Error("unexpected end of document");
+    char c = *p;
+    *p = '\0';
+
+    attribute_count_ = 0;
+    for (;;) {
+        bool space = false;
+        if (IsSpace(c)) {
+            p = SkipSpace(p + 1);
+            if (p >= end_)
+                return Error("unexpected end of document");
+            c = *p;
+            space = true;
+        }
+        if (c == '>') {
+            cur_ = p + 1;
+            break;
+        }
+        if (c == '/') {
+            if (p + 1 >= end_ || p[1] != '>')
+                return Error("expected '>'");
+            cur_ = p + 2;
+            close_element_ = true;
+            break;
+        }
+        if (!space)
+            return Error("expected whitespace before attribute");
+
+        char *attr = p;
+        p = ScanName(attr);
+        if (p == attr)
+            return Error("invalid attribute name");
+        if (p >= end_)
+            return Error("unexpected end of document");
+        c = *p;
+        *p = '\0';
+        if (IsSpace(c)) {
+            p = SkipSpace(p + 1);
+            if (p >= end_)
+                return Error("unexpected end of document");
+            c = *p;
+        }
+        if (c != '=')
+            return Error("expected '='");
+        p = SkipSpace(p + 1);
+        if (p >= end_ || (*p != '"' && *p != '\''))
+            return Error("expected quoted attribute value");
+
+        char *value = p + 1;
+        char *close = static_cast<char *>(memchr(value, *p, end_ - value));
+        if (!close)
+            return Error("unexpected end of document");
+        char *value_end = DecodeEntities(value, close);
+        if (!value_end)
+            return Error("invalid entity reference");
+        *value_end = '\0';
+
+        if (attribute_count_ == kMaxAttributes)
+            return Error("too many attributes");
+        attributes_[attribute_count_].name = attr;
+        attributes_[attribute_count_].value = value;
+        attribute_count_++;
+
+        p = close + 1;
+        if (p >= end_)
+            return Error("unexpected end of document");
+        c = *p;
+    }
+
+    if (depth_ == kMaxDepth)
+        return Error("element nesting too deep");
+    stack_[depth_++] = name;
+    name_ = name;
+    event_ = START_ELEMENT;
+    return event_;
+}
+
+//
+// Parse an end tag with cur_ at the '/'.
+//
+XmlPullParser::Event XmlPullParser::ParseEndElement() {
+    char *name = cur_ + 1;
+    char *p = ScanName(name);
+    if (p == name)
+        return Error("invalid element name");
+    if (p >= end_)
+        return Error("unexpected end of document");
+    char c = *p;
+    *p = '\0';
+    if (IsSpace(c)) {
+        p = SkipSpace(p + 1);
+        if (p >= end_)
+            return Error("unexpected end of document");
+        c = *p;
+    }
+    if (c != '>')
+        return Error("expected '>'");
+    cur_ = p + 1;
+
+    if (depth_ == 0 || strcmp(stack_[depth_ - 1], name) != 0)
+        return Error("mismatched end tag");
+    depth_--;
+    name_ = name;
+    attribute_count_ = 0;
+    event_ = END_ELEMENT;
+    return event_;
+}
+
+//
+// Parse a CDATA section with cur_ at the '!'.
+//
+XmlPullParser::Event XmlPullParser::ParseCData() {
+    static const char kCDataEnd[] = "]]>";
+    char *text = cur_ + 8;
+    char *p = std::search(text, end_, kCDataEnd, kCDataEnd + 3);
+    if (p == end_)
+        return Error("unexpected end of document");
+    *p = '\0';
+    cur_ = p + 3;
+    text_ = text;
+    event_ = TEXT;
+    return event_;
+}
+
+XmlPullParser::Event XmlPullParser::Next() {
+    if (event_ == PARSE_ERROR)
+        return event_;
+
+    if (close_element_) {
+        close_element_ = false;
+        depth_--;
+        attribute_count_ = 0;
+        event_ = END_ELEMENT;
+        return event_;
+    }
+
+    for (;;) {
+        // If the previous event was TEXT, the '<' that ended it has been
+        // overwritten and cur_ is already past it.
+        if (!at_markup_) {
+            if (cur_ >= end_) {
+                if (depth_ != 0)
+                    return Error("unexpected end of document");
+                event_ = END_DOCUMENT;
+                return event_;
+            }
+            if (*cur_ != '<') {
+                char *text = cur_;
+                char *lt =
+                    static_cast<char *>(memchr(text, '<', end_ - text));
+                if (!lt)
+                    lt = end_;
+                if (IsBlank(text, lt)) {
+                    cur_ = lt;
+                    continue;
+                }
+                if (depth_ == 0)
+                    return Error("text outside of element");
+                if (lt == end_)
+                    return Error("unexpected end of document");
+                char *text_end = DecodeEntities(text, lt);
+                if (!text_end)
+                    return Error("invalid entity reference");
+                *text_end = '\0';
+                cur_ = lt + 1;
+                at_markup_ = true;
+                text_ = text;
+                event_ = TEXT;
+                return event_;
+            }
+            cur_++;
+        }
+        at_markup_ = false;
+
+        if (cur_ >= end_)
+            return Error("unexpected end of document");
+        size_t avail = end_ - cur_;
+        if (*cur_ == '/')
+            return ParseEndElement();
+        if (*cur_ == '?') {
+            if (!SkipPast("?>", 2))
+                return Error("unexpected end of document");
+            continue;
+        }
+        if (*cur_ == '!') {
+            if (avail >= 3 && strncmp(cur_, "!--", 3) == 0) {
+                cur_ += 3;
+                if (!SkipPast("-->", 3))
+                    return Error("unexpected end of document");
+                continue;
+            }
+            if (avail >= 8 && strncmp(cur_, "![CDATA[", 8) == 0) {
+                if (depth_ == 0)
+                    return Error("text outside of element");
+                return ParseCData();
+            }
+            return Error("unsupported declaration");
+        }
+        return ParseStartElement();
+    }
+}
+
+bool XmlPullParser::NextChild(size_t depth) {
+    for (;;) {
+        switch (Next()) {
+        case START_ELEMENT:
+            if (depth_ == depth + 1)
+                return true;
+            break;
+        case END_ELEMENT:
+            if (depth_ < depth)
+                return false;
+            break;
+        case TEXT:
+            break;
+        case END_DOCUMENT:
+        case PARSE_ERROR:
+            return false;
+        }
+    }
+}
+
+bool XmlPullParser::SkipElement() {
+    if (event_ != START_ELEMENT)
+        return event_ != PARSE_ERROR;
+    size_t depth = depth_;
+    for (;;) {
+        switch (Next()) {
+        case END_ELEMENT:
+            if (depth_ < depth)
+                return true;
+            break;
+        case START_ELEMENT:
+        case TEXT:
+            break;
+        case END_DOCUMENT:
+        case PARSE_ERROR:
+            return false;
+        }
+    }
+}
+
+const char *XmlPullParser::ReadText() {
+    if (event_ != START_ELEMENT)
+        return NULL;
+    size_t depth = depth_;
+    const char *text = "";
+    bool found = false;
+    for (;;) {
+        switch (Next()) {
+        case TEXT:
+            if (!found && depth_ == depth) {
+                text = text_;
+                found = true;
+            }
+            break;
+        case END_ELEMENT:
+            if (depth_ < depth)
+                return text;
+            break;
+        case START_ELEMENT:
+            break;
+        case END_DOCUMENT:
+        case PARSE_ERROR:
+            return NULL;
+        }
+    }
+}
+
+const char *XmlPullParser::Attribute(const char *name) const {
+    for (size_t idx = 0; idx < attribute_count_; ++idx) {
+        if (strcmp(attributes_[idx].name, name) == 0)
+            return attributes_[idx].value;
+    }
+    return NULL;
+}
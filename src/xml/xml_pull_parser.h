@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#ifndef __XML_PULL_PARSER_H__
+#define __XML_PULL_PARSER_H__
+
+#include <stddef.h>
+
+#include "base/util.h"
+
+//
+// Streaming pull parser for XML documents.
+//
+// The parser works in-situ on a caller supplied buffer, such as a stanza in
+// the receive buffer of a session, and does not allocate memory. Element and
+// attribute names, attribute values and text are terminated and have their
+// entity references decoded in place, so the returned pointers refer to the
+// buffer and remain valid as long as the buffer does. The buffer contents are
+// modified and can not be parsed again.
+//
+// Next() returns one event at a time. Self-closing elements are reported as
+// a START_ELEMENT followed by an END_ELEMENT. Comments, processing
+// instructions and text consisting only of whitespace are skipped. CDATA
+// sections are reported as TEXT.
+//
+// The parser is non-validating. It checks that end tags match start tags,
+// but does not support DTDs and limits nesting depth and the number of
+// attributes of an element to fixed values, so that its state can be kept
+// in the object.
+//
+// Typical use to visit the children of an element:
+//
+//     size_t depth = parser.depth();
+//     while (parser.NextChild(depth)) {
+//         if (strcmp(parser.name(), "item") == 0) {
+//             ...
+//         } else {
+//             parser.SkipElement();
+//         }
+//     }
+//
+class XmlPullParser {
+public:
+    enum Event {
+        START_ELEMENT,
+        END_ELEMENT,
+        TEXT,
+        END_DOCUMENT,
+        PARSE_ERROR
+    };
+
+    static const size_t kMaxDepth = 32;
+    static const size_t kMaxAttributes = 16;
+
+    XmlPullParser(char *buf, size_t size);
+
+    // Advance to the next event.
+    Event Next();
+
+    // Advance to the next child element of the element at depth. Returns
+    // false at the end of that element or on error. Text is skipped.
+    bool NextChild(size_t depth);
+
+    // Skip the content of the current element, including its END_ELEMENT.
+    // Returns false on error.
+    bool SkipElement();
+
+    // Return the text of the current element and advance past its
+    // END_ELEMENT. Child elements are skipped and only the first text
+    // section is returned. Returns NULL on error.
+    const char *ReadText();
+
+    Event event() const { return event_; }
+
+    // Name of the element for START_ELEMENT and END_ELEMENT.
+    const char *name() const { return name_; }
+
+    // Text for TEXT.
+    const char *text() const { return text_; }
+
+    // Number of open elements, including the current one for START_ELEMENT.
+    size_t depth() const { return depth_; }
+
+    // Attributes of the element for START_ELEMENT.
+    size_t attribute_count() const { return attribute_count_; }
+    const char *attribute_name(size_t index) const {
+        return attributes_[index].name;
+    }
+    const char *attribute_value(size_t index) const {
+        return attributes_[index].value;
+    }
+    const char *Attribute(const char *name) const;
+
+    // Offset of the parser in the buffer.
+    size_t offset() const { return cur_ - buf_; }
+    const char *error() const { return error_; }
+
+private:
+    struct AttributeEntry {
+        const char *name;
+        const char *value;
+    };
+
+    Event Error(const char *error);
+    Event ParseStartElement();
+    Event ParseEndElement();
+    Event ParseCData();
+    bool SkipPast(const char *delimiter, size_t len);
+    char *ScanName(char *p) const;
+    char *SkipSpace(char *p) const;
+
+    char *buf_;
+    char *cur_;
+    char *end_;
+    Event event_;
+    const char *name_;
+    const char *text_;
+    const char *error_;
+    bool at_markup_;
+    bool close_element_;
+    size_t depth_;
+    size_t attribute_count_;
+    const char *stack_[kMaxDepth];
+    AttributeEntry attributes_[kMaxAttributes];
+
+    DISALLOW_COPY_AND_ASSIGN(XmlPullParser);
+};
+
+#endif  // __XML_PULL_PARSER_H__
@@ -4,7 +4,11 @@
 
 #include "xmpp/xmpp_channel.h"
 
+#include <boost/bind.hpp>
+
+using boost::asio::const_buffer;
 using std::string;
+using std::vector;
 
 namespace xmps {
 
@@ -28,3 +32,25 @@ string PeerIdToName(PeerId id) {
 }
 
 }
+
+bool XmppChannel::Send(const vector<const_buffer> &buffers, xmps::PeerId id,
+                       SendReadyCb cb) {
+    size_t size = 0;
+    for (vector<const_buffer>::const_iterator it = buffers.begin();
+         it != buffers.end(); ++it) {
+        size += boost::asio::buffer_size(*it);
+    }
+    string msg;
+    msg.reserve(size);
+    for (vector<const_buffer>::const_iterator it = buffers.begin();
+         it != buffers.end(); ++it) {
+        msg.append(boost::asio::buffer_cast<const char *>(*it),
+                   boost::asio::buffer_size(*it));
+    }
+    return Send(reinterpret_cast<const uint8_t *>(msg.data()), msg.size(),
+                &msg, id, cb);
+}
+
+void XmppChannel::RegisterStanzaReceive(xmps::PeerId id, StanzaReceiveCb cb) {
+    RegisterReceive(id, boost::bind(cb, _1, _2, static_cast<string *>(NULL)));
+}
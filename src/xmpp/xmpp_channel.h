@@ -5,6 +5,8 @@
 #ifndef __XMPP_CHANNEL_INTERFACE_H__
 #define __XMPP_CHANNEL_INTERFACE_H__
 
+#include <vector>
+#include <boost/asio/buffer.hpp>
 #include <boost/function.hpp>
 #include <boost/system/error_code.hpp>
 #include "xmpp/xmpp_proto.h"
@@ -36,6 +38,10 @@ public:
     typedef boost::function<
         void(const XmppStanza::XmppMessage *, xmps::PeerState state)
         > ReceiveCb;
+    typedef boost::function<
+        void(const XmppStanza::XmppMessage *, xmps::PeerState state,
+             std::string *stanza)
+        > StanzaReceiveCb;
     typedef boost::function<bool(const std::string &,
                                  int,
                                  int,
@@ -57,8 +63,18 @@ public:
                       SendReadyCb cb) {
         return Send(msg, msg_size, id, cb);
     }
+    // Send a message made of several fragments, e.g. a body shared by many
+    // channels around a per-channel header. The fragments are gathered into
+    // a single buffer unless the channel overrides this.
+    virtual bool Send(const std::vector<boost::asio::const_buffer> &buffers,
+                      xmps::PeerId id, SendReadyCb cb);
     virtual int GetTaskInstance() const = 0;
     virtual void RegisterReceive(xmps::PeerId, ReceiveCb) = 0;
+    // Receive chat messages along with their stanza, see keep_stanza in
+    // XmppChannelConfig. The receiver owns the stanza and may take it with
+    // swap. At most one receiver of a channel takes the stanza, it is NULL
+    // unless the channel overrides this.
+    virtual void RegisterStanzaReceive(xmps::PeerId id, StanzaReceiveCb cb);
     virtual void UnRegisterReceive(xmps::PeerId) = 0;
     virtual void RegisterReferer(xmps::PeerId) { }
     virtual void UnRegisterReferer(xmps::PeerId) { }
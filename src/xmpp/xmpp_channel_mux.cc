@@ -4,6 +4,7 @@
 
 #include "xmpp/xmpp_channel_mux.h"
 
+#include <boost/bind.hpp>
 #include <boost/foreach.hpp>
 
 #include "base/task_annotations.h"
@@ -85,11 +86,21 @@ void XmppChannelMux::RegisterReceive(xmps::PeerId id, ReceiveCb cb) {
     rxmap_.insert(make_pair(id, cb));
 }
 
+// The callback is also registered as a plain receiver, so that it counts as
+// one and receives messages without a stanza.
+void XmppChannelMux::RegisterStanzaReceive(xmps::PeerId id,
+                                           StanzaReceiveCb cb) {
+    assert(stanza_rxmap_.empty());
+    RegisterReceive(id, boost::bind(cb, _1, _2, static_cast<string *>(NULL)));
+    stanza_rxmap_.insert(make_pair(id, cb));
+}
+
 void XmppChannelMux::UnRegisterReceive(xmps::PeerId id) {
     ReceiveCbMap::iterator it = rxmap_.find(id);
     if (it != rxmap_.end()) {
         rxmap_.erase(it);
     }
+    stanza_rxmap_.erase(id);
 
     if (ReceiverCount())
         return;
@@ -178,13 +189,24 @@ inline bool MatchCallback(string to, xmps::PeerId peer) {
     return false;
 }
 
-void XmppChannelMux::ProcessXmppMessage(const XmppStanza::XmppMessage *msg) {
+//
+// The stanza, if any, is handed over to the stanza receiver only.
+//
+void XmppChannelMux::ProcessXmppMessage(const XmppStanza::XmppMessage *msg,
+                                        string *stanza) {
     last_received_ = UTCTimestamp();
     ReceiveCbMap::iterator iter = rxmap_.begin();
     for (; iter != rxmap_.end(); ++iter) {
         if (MatchCallback(msg->to, iter->first)) {
-            ReceiveCb cb = iter->second;
-            cb(msg, GetPeerState());
+            StanzaReceiveCbMap::iterator stanza_iter =
+                stanza_rxmap_.find(iter->first);
+            if (stanza && stanza_iter != stanza_rxmap_.end()) {
+                StanzaReceiveCb cb = stanza_iter->second;
+                cb(msg, GetPeerState(), stanza);
+            } else {
+                ReceiveCb cb = iter->second;
+                cb(msg, GetPeerState());
+            }
         }
     }
 }
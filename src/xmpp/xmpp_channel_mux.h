@@ -30,6 +30,7 @@ public:
     virtual void RegisterReferer(xmps::PeerId);
     virtual void UnRegisterReferer(xmps::PeerId);
     virtual void RegisterReceive(xmps::PeerId, ReceiveCb);
+    virtual void RegisterStanzaReceive(xmps::PeerId id, StanzaReceiveCb cb);
     virtual void UnRegisterReceive(xmps::PeerId);
     virtual void RegisterRxMessageTraceCallback(RxMessageTraceCb cb);
     virtual void RegisterTxMessageTraceCallback(TxMessageTraceCb cb);
@@ -60,7 +61,8 @@ public:
     virtual bool LastReceived(time_t duration) const;
     virtual bool LastSent(time_t duration) const;
 
-    virtual void ProcessXmppMessage(const XmppStanza::XmppMessage *msg);
+    virtual void ProcessXmppMessage(const XmppStanza::XmppMessage *msg,
+                                    std::string *stanza);
     void WriteReady(const boost::system::error_code &ec);
     virtual void UnRegisterWriteReady(xmps::PeerId id);
 
@@ -84,10 +86,12 @@ private:
 
     typedef std::map<xmps::PeerId, SendReadyCb> WriteReadyCbMap;
     typedef std::map<xmps::PeerId, ReceiveCb> ReceiveCbMap;
+    typedef std::map<xmps::PeerId, StanzaReceiveCb> StanzaReceiveCbMap;
     typedef std::set<xmps::PeerId> RefererSet;
 
     WriteReadyCbMap map_;
     ReceiveCbMap rxmap_;
+    StanzaReceiveCbMap stanza_rxmap_;
     SendReadyCb cb_;
     RefererSet referers_;
     XmppConnection *connection_;
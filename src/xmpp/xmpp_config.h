@@ -32,6 +32,8 @@ public:
     bool gr_helper_disable;
     uint8_t dscp_value;
     std::string xmlns;
+    // Keep the text of received chat messages in XmppChatMessage::stanza.
+    bool keep_stanza;
 
     int CompareTo(const XmppChannelConfig &rhs) const;
     static int const default_client_port = 5269;
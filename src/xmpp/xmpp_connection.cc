@@ -53,6 +53,7 @@ XmppConnection::XmppConnection(TcpServer *server,
       to_(config->ToAddr),
       auth_enabled_(config->auth_enabled),
       dscp_value_(config->dscp_value), xmlns_(config->xmlns),
+      keep_stanza_(config->keep_stanza),
       state_machine_(XmppObjectFactory::Create<XmppStateMachine>(
           this, config->ClientOnly(), config->auth_enabled)),
       mux_(XmppObjectFactory::Create<XmppChannelMux>(this)) {
@@ -629,14 +630,17 @@ error:
     return NULL;
 }
 
+// The stanza of the message, if kept, is released here and handed over to
+// the stanza receiver of the channel, see XmppChannel::RegisterStanzaReceive.
 int XmppConnection::ProcessXmppChatMessage(
-        const XmppStanza::XmppChatMessage *msg) {
-    mux_->ProcessXmppMessage(msg);
+        XmppStanza::XmppChatMessage *msg) {
+    string stanza(msg->ReleaseStanza());
+    mux_->ProcessXmppMessage(msg, &stanza);
     return 0;
 }
 
 int XmppConnection::ProcessXmppIqMessage(const XmppStanza::XmppMessage *msg) {
-    mux_->ProcessXmppMessage(msg);
+    mux_->ProcessXmppMessage(msg, NULL);
     return 0;
 }
 
@@ -984,5 +988,6 @@ void XmppConnection::SwapContents(XmppConnection *other) {
     swap(from_, other->from_);
     swap(xmlns_, other->xmlns_);
     swap(dscp_value_, other->dscp_value_);
+    swap(keep_stanza_, other->keep_stanza_);
     swap(disable_read_, other->disable_read_);
 }
@@ -99,7 +99,7 @@ public:
     int ProcessXmppIqMessage(const XmppStanza::XmppMessage *);
 
     // chat messages
-    int ProcessXmppChatMessage(const XmppStanza::XmppChatMessage *);
+    int ProcessXmppChatMessage(XmppStanza::XmppChatMessage *);
 
     void StartKeepAliveTimer();
     void StopKeepAliveTimer();
@@ -215,6 +215,7 @@ public:
     }
     uint8_t dscp_value() const { return dscp_value_; }
     int SetDscpValue(uint8_t value);
+    bool keep_stanza() const { return keep_stanza_; }
 
     void inc_connect_error();
     void inc_session_close();
@@ -266,6 +267,7 @@ private:
     bool auth_enabled_;
     uint8_t dscp_value_;
     std::string xmlns_;
+    bool keep_stanza_;
     mutable std::string uve_key_str_;
 
     boost::scoped_ptr<XmppStateMachine> state_machine_;
@@ -3,6 +3,8 @@
  */
 
 #include "xmpp/xmpp_proto.h"
+#include <string.h>
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <boost/algorithm/string/replace.hpp>
@@ -13,6 +15,8 @@
 #include "xmpp/xmpp_session.h"
 #include "xmpp/xmpp_str.h"
 
+#include "xml/xml_pull_parser.h"
+
 #include "sandesh/sandesh_trace.h"
 #include "sandesh/common/vns_types.h"
 #include "sandesh/common/vns_constants.h"
@@ -237,47 +241,53 @@ XmppStanza::XmppMessage *XmppProto::DecodeInternal(
     string iq(sXMPP_IQ_KEY);
 
     if (ts.find(sXMPP_IQ) != string::npos) {
-        string ts_tmp = ts;
-
-        if (impl->LoadDoc(ts) == -1) {
-            XMPP_WARNING(XmppIqMessageParseFail, connection->ToUVEKey(),
-                         XMPP_PEER_DIR_IN);
-            assert(false);
-            goto done;
+        auto_ptr<XmppStanza::XmppMessageIq> msg(
+            new XmppStanza::XmppMessageIq);
+        bool header = XmppProto::DecodeIqHeader(ts, msg.get());
+
+        // The document of a collection stanza is not used, the connection
+        // only merges its node into the preceding publish stanza.
+        if (!header || msg->action.compare("collection") != 0) {
+            if (impl->LoadDoc(ts) == -1) {
+                XMPP_WARNING(XmppIqMessageParseFail, connection->ToUVEKey(),
+                             XMPP_PEER_DIR_IN);
+                assert(false);
+                goto done;
+            }
         }
 
-        XmppStanza::XmppMessageIq *msg = new XmppStanza::XmppMessageIq;
-        impl->ReadNode(iq);
-        msg->to = XmppProto::GetTo(impl);
-        msg->from = XmppProto::GetFrom(impl);
-        msg->id = XmppProto::GetId(impl);
-        msg->iq_type = XmppProto::GetType(impl);
-        // action is subscribe,publish,collection
-        const char *action = XmppProto::GetAction(impl, msg->iq_type);
-        if (action) {
-            msg->action = action;
-        }
-        if (XmppProto::GetNode(impl, msg->action)) {
-            msg->node = XmppProto::GetNode(impl, msg->action);
-        }
-        //associate or dissociate collection node
-        if (msg->action.compare("collection") == 0) {
-            if (XmppProto::GetAsNode(impl)) {
-                msg->as_node = XmppProto::GetAsNode(impl);
-                msg->is_as_node = true;
-            } else if (XmppProto::GetDsNode(impl)) {
-                msg->as_node = XmppProto::GetDsNode(impl);
-                msg->is_as_node = false;
+        if (!header) {
+            impl->ReadNode(iq);
+            msg->to = XmppProto::GetTo(impl);
+            msg->from = XmppProto::GetFrom(impl);
+            msg->id = XmppProto::GetId(impl);
+            msg->iq_type = XmppProto::GetType(impl);
+            // action is subscribe,publish,collection
+            const char *action = XmppProto::GetAction(impl, msg->iq_type);
+            if (action) {
+                msg->action = action;
+            }
+            if (XmppProto::GetNode(impl, msg->action)) {
+                msg->node = XmppProto::GetNode(impl, msg->action);
+            }
+            //associate or dissociate collection node
+            if (msg->action.compare("collection") == 0) {
+                if (XmppProto::GetAsNode(impl)) {
+                    msg->as_node = XmppProto::GetAsNode(impl);
+                    msg->is_as_node = true;
+                } else if (XmppProto::GetDsNode(impl)) {
+                    msg->as_node = XmppProto::GetDsNode(impl);
+                    msg->is_as_node = false;
+                }
             }
         }
 
         msg->dom.reset(impl);
 
-        ret = msg;
-
         XMPP_UTDEBUG(XmppIqMessageProcess, connection->ToUVEKey(),
                      XMPP_PEER_DIR_IN, msg->node, msg->action, msg->from,
                      msg->to, msg->id, msg->iq_type);
+        ret = msg.release();
         goto done;
 
     } else if (ts.find(sXMPP_MESSAGE) != string::npos) {
@@ -287,8 +297,10 @@ XmppStanza::XmppMessage *XmppProto::DecodeInternal(
                          XMPP_PEER_DIR_IN);
             goto done;
         }
-        XmppStanza::XmppMessage *msg = new XmppStanza::XmppChatMessage(
-                                           STATE_NONE);
+        XmppStanza::XmppChatMessage *msg = new XmppStanza::XmppChatMessage(
+                                               STATE_NONE);
+        if (connection->keep_stanza())
+            msg->stanza = ts;
         impl->ReadNode(sXMPP_MESSAGE_KEY);
 
         msg->to = XmppProto::GetTo(impl);
@@ -505,3 +517,65 @@ const char *XmppProto::GetDsNode(XmlBase *doc) {
 
     return(NULL);
 }
+
+static const char *AttributeValue(const XmlPullParser &parser,
+                                  const char *name) {
+    const char *value = parser.Attribute(name);
+    return value ? value : "";
+}
+
+//
+// Decode the iq header with the pull parser instead of the DOM. The parser
+// works in place, so it is run on a copy of the start of the stanza on the
+// stack, which is large enough for the header of any stanza sent by the
+// agents and control-nodes.
+//
+// Returns false if the header does not fit in the copy or does not have
+// the usual layout, in which case the caller decodes it from the DOM.
+//
+bool XmppProto::DecodeIqHeader(const string &ts, XmppMessageIq *msg) {
+    static const size_t kMaxIqHeaderSize = 1024;
+
+    size_t start = ts.find(sXMPP_IQ);
+    char buf[kMaxIqHeaderSize];
+    size_t len = std::min(ts.size() - start, sizeof(buf));
+    memcpy(buf, ts.data() + start, len);
+
+    XmlPullParser parser(buf, len);
+    if (parser.Next() != XmlPullParser::START_ELEMENT ||
+        strcmp(parser.name(), sXMPP_IQ_KEY) != 0) {
+        return false;
+    }
+    msg->to = AttributeValue(parser, "to");
+    msg->from = AttributeValue(parser, "from");
+    msg->id = AttributeValue(parser, "id");
+    msg->iq_type = AttributeValue(parser, "type");
+    if (msg->iq_type.compare("set") != 0)
+        return true;
+
+    // action is subscribe,publish,collection
+    if (!parser.NextChild(1) || strcmp(parser.name(), "pubsub") != 0)
+        return false;
+    if (!parser.NextChild(2))
+        return false;
+    msg->action = parser.name();
+    msg->node = AttributeValue(parser, "node");
+    if (msg->action.compare("collection") != 0)
+        return true;
+
+    //associate or dissociate collection node
+    while (parser.NextChild(3)) {
+        if (strcmp(parser.name(), "associate") == 0) {
+            msg->as_node = AttributeValue(parser, "node");
+            msg->is_as_node = true;
+            return true;
+        } else if (strcmp(parser.name(), "dissociate") == 0) {
+            msg->as_node = AttributeValue(parser, "node");
+            msg->is_as_node = false;
+            return true;
+        }
+        if (!parser.SkipElement())
+            return false;
+    }
+    return parser.event() == XmlPullParser::END_ELEMENT;
+}
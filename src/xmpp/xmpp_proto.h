@@ -112,8 +112,17 @@ public:
             ERROR = 5
         };
 
+        // Take the message as received, leaving it empty. It is only kept
+        // if the channel is configured with keep_stanza.
+        std::string ReleaseStanza() {
+            std::string released;
+            released.swap(stanza);
+            return released;
+        }
+
         XmppMessageStateType state;
         XmppMessageSubtype stype;
+        std::string stanza;
     };
 
     struct XmppMessagePresence : public XmppMessage {
@@ -207,6 +216,7 @@ private:
     static const char *GetNode(XmlBase *doc, const std::string &str);
     static const char *GetAsNode(XmlBase *doc);
     static const char *GetDsNode(XmlBase *doc);
+    static bool DecodeIqHeader(const std::string &ts, XmppMessageIq *msg);
 
     static XmppStanza::XmppMessage *DecodeInternal(
             const XmppConnection *connection, const std::string &ts,
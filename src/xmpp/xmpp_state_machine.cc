@@ -124,12 +124,12 @@ struct EvTcpDeleteSession : sc::event<EvTcpDeleteSession> {
 
 struct EvXmppMessage : sc::event<EvXmppMessage> {
     explicit EvXmppMessage(XmppSession *session,
-        const XmppStanza::XmppMessage *msg) : session(session), msg(msg) { }
+        XmppStanza::XmppMessage *msg) : session(session), msg(msg) { }
     static const char *Name() {
         return "EvXmppMessage";
     }
     XmppSession *session;
-    const XmppStanza::XmppMessage *msg;
+    XmppStanza::XmppMessage *msg;
 };
 
 struct EvXmppOpen : public sc::event<EvXmppOpen> {
@@ -215,14 +215,16 @@ struct EvXmppKeepalive : sc::event<EvXmppKeepalive> {
 
 struct EvXmppMessageStanza : sc::event<EvXmppMessageStanza> {
     EvXmppMessageStanza(XmppSession *session,
-                         const XmppStanza::XmppMessage *msg) :
+                         XmppStanza::XmppMessage *msg) :
     session(session), msg(msg) {
     }
     static const char *Name() {
         return "EvXmppMessageStanza";
     }
     XmppSession *session;
-    boost::shared_ptr<const XmppStanza::XmppMessage> msg;
+    // Not const, the connection releases the stanza of the message when it
+    // is dispatched.
+    boost::shared_ptr<XmppStanza::XmppMessage> msg;
 };
 
 struct EvXmppIqStanza : sc::event<EvXmppIqStanza> {
@@ -984,7 +986,7 @@ struct XmppStreamEstablished :
         }
         state_machine->StartHoldTimer();
         state_machine->connection()->ProcessXmppChatMessage(
-            static_cast<const XmppStanza::XmppChatMessage *>(event.msg.get()));
+            static_cast<XmppStanza::XmppChatMessage *>(event.msg.get()));
         return discard_event();
     }
 
@@ -1439,13 +1441,13 @@ void XmppStateMachine::ProcessStreamHeaderMessage(XmppSession *session,
 }
 
 void XmppStateMachine::OnMessage(XmppSession *session,
-                                 const XmppStanza::XmppMessage *msg) {
+                                 XmppStanza::XmppMessage *msg) {
     if (!Enqueue(xmsm::EvXmppMessage(session, msg)))
         delete msg;
 }
 
 void XmppStateMachine::ProcessMessage(XmppSession *session,
-                                      const XmppStanza::XmppMessage *msg) {
+                                      XmppStanza::XmppMessage *msg) {
     // Bail if session is already reset and disassociated from the connection.
     if (!session->Connection()) {
         delete msg;
@@ -97,9 +97,8 @@ public:
     bool PassiveOpen(XmppSession *session);
 
     // Receive incoming message
-    void OnMessage(XmppSession *session, const XmppStanza::XmppMessage *msg);
-    void ProcessMessage(XmppSession *session,
-                        const XmppStanza::XmppMessage *msg);
+    void OnMessage(XmppSession *session, XmppStanza::XmppMessage *msg);
+    void ProcessMessage(XmppSession *session, XmppStanza::XmppMessage *msg);
 
     // Receive incoming ssl events
     //void OnEvent(XmppSession *session, xmsm::SslHandShakeResponse);